@@ -0,0 +1,852 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+/**
+ * Standalone benchmark harness for the pieces of the plugin that build without the engine, so they can be measured headless on Linux without an Unreal install:
+ * the packet validator and Open DIS decode of every PDU type the PDU Processor handles, the Open DIS encode of the same PDUs, the dead reckoning equations
+ * of every algorithm, and entity key hashing and lookups. Results are printed as DIS.Benchmark prints them and written to the same JSON schema.
+ * Not part of the plugin. UnrealBuildTool only builds directories with a Build.cs, so this one is built by hand:
+ *
+ *   g++ -std=c++14 -O2 -DNDEBUG \
+ *     -ISource/DISFuzz/Shim -ISource/DISRuntime/Public -ISource/ThirdParty/include \
+ *     Source/DISBenchmarkHarness/DISStandaloneBenchmarks.cpp Source/DISRuntime/Private/DISPacketValidator.cpp \
+ *     Source/ThirdParty/include/dis6/[A-Za-z]*.cpp Source/ThirdParty/include/utils/DataStream.cpp \
+ *     -o DISStandaloneBenchmarks
+ *   ./DISStandaloneBenchmarks [NameFilter] [Scale=1.0] [Json=<FilePath>]
+ *
+ * Result names match the engine benchmarks they stand in for, but each covers only the engine free part of it:
+ * - PDU.ToBytes.<Type> marshals an Open DIS PDU into bytes, without filling it from the Unreal struct first.
+ * - PDU.Process.<Type> validates and unmarshals a datagram into the Open DIS PDU, without converting it to the Unreal struct or broadcasting it.
+ * - DeadReckoning.<Algorithm> runs the position and orientation equations of DISDeadReckoningMath.h, taking the Euler angle path for orientation
+ *   as UDeadReckoning_BPFL::DeadReckoning does for PDUs without other parameters.
+ * - EntityKeys.<Key>Hash formats the same string GetTypeHash does but hashes it with std::hash in place of the engine's CRC.
+ * The JSON marks runs of this harness with an engine version starting with Standalone.
+ */
+
+#include "DISPacketValidator.h"
+#include "DISDeadReckoningMath.h"
+#include "DISEntityKeys.h"
+#include <dis6/EntityStatePdu.h>
+#include <dis6/EntityStateUpdatePdu.h>
+#include <dis6/FirePdu.h>
+#include <dis6/DetonationPdu.h>
+#include <dis6/RemoveEntityPdu.h>
+#include <dis6/StartResumePdu.h>
+#include <dis6/StopFreezePdu.h>
+#include <dis6/ElectromagneticEmissionsPdu.h>
+#include <utils/DataStream.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace DISStandaloneBenchmarks
+{
+	/**
+	 * Results of a single benchmark run, as FDISBenchmarkResult holds them.
+	 */
+	struct FResult
+	{
+		std::string Name;
+		int64 Operations = 0;
+		double Seconds = 0;
+		std::vector<std::pair<std::string, double>> Metrics;
+
+		FResult(const std::string& InName) : Name(InName) {}
+
+		double GetOperationsPerSecond() const { return Seconds > 0 ? Operations / Seconds : 0; }
+		double GetNanosecondsPerOperation() const { return Operations > 0 ? Seconds * 1e9 / Operations : 0; }
+		void AddMetric(const std::string& MetricName, double Value) { Metrics.emplace_back(MetricName, Value); }
+
+		std::string ToString() const
+		{
+			char buffer[512];
+			std::snprintf(buffer, sizeof(buffer), "%s: %lld ops in %.3f ms (%.0f ops/s, %.1f ns/op)", Name.c_str(), static_cast<long long>(Operations), Seconds * 1000., GetOperationsPerSecond(), GetNanosecondsPerOperation());
+			std::string resultString = buffer;
+			for (const std::pair<std::string, double>& metric : Metrics)
+			{
+				std::snprintf(buffer, sizeof(buffer), ", %s=%g", metric.first.c_str(), metric.second);
+				resultString += buffer;
+			}
+			return resultString;
+		}
+	};
+
+	struct FContext
+	{
+		//Multiplier applied to each benchmark's default problem size
+		double Scale = 1.;
+		std::vector<FResult> Results;
+
+		int32 Scaled(int32 DefaultCount) const { return std::max(1, static_cast<int32>(std::lround(DefaultCount * Scale))); }
+	};
+
+	template<typename FunctionType>
+	double TimeSeconds(FunctionType&& Function)
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		Function();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	//Keeps results the compiler could otherwise prove unused
+	volatile double Sink = 0;
+
+	const char* const PDUTypeNames[] = { "EntityState", "EntityStateUpdate", "Fire", "Detonation", "RemoveEntity", "StartResume", "StopFreeze", "ElectromagneticEmissions" };
+
+	DIS::EntityID MakeEntityID(int32 Site, int32 Application, int32 Entity)
+	{
+		DIS::EntityID entityID;
+		entityID.setSite(Site);
+		entityID.setApplication(Application);
+		entityID.setEntity(Entity);
+		return entityID;
+	}
+
+	/**
+	 * Every PDU the PDU Processor decodes, filled in the way the engine benchmarks fill them.
+	 */
+	struct FSamplePDUs
+	{
+		DIS::EntityStatePdu EntityState;
+		DIS::EntityStateUpdatePdu EntityStateUpdate;
+		DIS::FirePdu Fire;
+		DIS::DetonationPdu Detonation;
+		DIS::RemoveEntityPdu RemoveEntity;
+		DIS::StartResumePdu StartResume;
+		DIS::StopFreezePdu StopFreeze;
+		DIS::ElectromagneticEmissionsPdu ElectromagneticEmissions;
+
+		FSamplePDUs()
+		{
+			DIS::Vector3Double location;
+			location.setX(1112000.);
+			location.setY(-4842000.);
+			location.setZ(3985000.);
+			DIS::Vector3Float velocity;
+			velocity.setX(12.f);
+			velocity.setY(-3.f);
+			velocity.setZ(1.f);
+			DIS::Orientation orientation;
+			orientation.setPsi(1.2f);
+			orientation.setTheta(0.1f);
+			orientation.setPhi(-0.05f);
+
+			DIS::EntityType entityType;
+			entityType.setEntityKind(1);
+			entityType.setDomain(1);
+			entityType.setCountry(225);
+			entityType.setCategory(1);
+			entityType.setSubcategory(3);
+			entityType.setSpecific(1);
+
+			DIS::DeadReckoningParameter deadReckoningParameters;
+			deadReckoningParameters.setDeadReckoningAlgorithm(2);
+
+			DIS::Marking marking;
+			marking.setCharacterSet(1);
+			marking.setByStringCharacters("BENCHMARK");
+
+			std::vector<DIS::ArticulationParameter> articulationParameters(4);
+			for (int32 i = 0; i < 4; i++)
+			{
+				articulationParameters[i].setParameterType(4096 + i * 32 + 11);
+				articulationParameters[i].setParameterValue(0.5 * i);
+			}
+
+			const DIS::EntityID entityID = MakeEntityID(1, 1, 17);
+			const DIS::EntityID otherEntityID = MakeEntityID(1, 1, 2);
+			const DIS::EntityID managerID = MakeEntityID(1, 1, 0);
+			const DIS::EntityID allEntitiesID = MakeEntityID(65535, 65535, 65535);
+			DIS::EventID eventID;
+			eventID.setSite(1);
+			eventID.setApplication(1);
+			eventID.setEventNumber(1);
+			DIS::BurstDescriptor burstDescriptor;
+			burstDescriptor.setWarhead(1000);
+			burstDescriptor.setFuse(1000);
+			burstDescriptor.setQuantity(1);
+
+			EntityState.setExerciseID(1);
+			EntityState.setEntityID(entityID);
+			EntityState.setForceId(1);
+			EntityState.setEntityType(entityType);
+			EntityState.setEntityLocation(location);
+			EntityState.setEntityOrientation(orientation);
+			EntityState.setEntityLinearVelocity(velocity);
+			EntityState.setDeadReckoningParameters(deadReckoningParameters);
+			EntityState.setMarking(marking);
+			EntityState.setArticulationParameters(articulationParameters);
+
+			EntityStateUpdate.setExerciseID(1);
+			EntityStateUpdate.setEntityID(entityID);
+			EntityStateUpdate.setEntityLocation(location);
+			EntityStateUpdate.setEntityOrientation(orientation);
+			EntityStateUpdate.setEntityLinearVelocity(velocity);
+			EntityStateUpdate.setArticulationParameters(articulationParameters);
+
+			DIS::Vector3Float muzzleVelocity;
+			muzzleVelocity.setZ(800.f);
+			Fire.setExerciseID(1);
+			Fire.setFiringEntityID(entityID);
+			Fire.setTargetEntityID(otherEntityID);
+			Fire.setEventID(eventID);
+			Fire.setLocationInWorldCoordinates(location);
+			Fire.setVelocity(muzzleVelocity);
+			Fire.setRange(2000.f);
+			Fire.setBurstDescriptor(burstDescriptor);
+
+			Detonation.setExerciseID(1);
+			Detonation.setFiringEntityID(otherEntityID);
+			Detonation.setTargetEntityID(entityID);
+			Detonation.setEventID(eventID);
+			Detonation.setLocationInWorldCoordinates(location);
+			Detonation.setBurstDescriptor(burstDescriptor);
+			Detonation.setDetonationResult(1);
+
+			RemoveEntity.setExerciseID(1);
+			RemoveEntity.setOriginatingEntityID(managerID);
+			RemoveEntity.setReceivingEntityID(entityID);
+			RemoveEntity.setRequestID(1);
+
+			StartResume.setExerciseID(1);
+			StartResume.setOriginatingEntityID(managerID);
+			StartResume.setReceivingEntityID(allEntitiesID);
+			StartResume.setRequestID(1);
+
+			StopFreeze.setExerciseID(1);
+			StopFreeze.setOriginatingEntityID(managerID);
+			StopFreeze.setReceivingEntityID(allEntitiesID);
+			StopFreeze.setRequestID(1);
+
+			ElectromagneticEmissions.setExerciseID(1);
+			ElectromagneticEmissions.setEmittingEntityID(entityID);
+			ElectromagneticEmissions.setEventID(eventID);
+		}
+	};
+
+	/**
+	 * Encodes the PDU the way the ToBytes of its struct does once the Open DIS PDU is filled in.
+	 */
+	template<typename PDUType>
+	std::vector<uint8> ToBytes(const PDUType& PDU)
+	{
+		DIS::DataStream buffer(DIS::BIG);
+		PDU.marshal(buffer);
+
+		std::vector<uint8> bytes(buffer.size());
+		for (size_t i = 0; i < bytes.size(); i++)
+		{
+			bytes[i] = buffer[i];
+		}
+		return bytes;
+	}
+
+	template<typename PDUType>
+	void AddToBytesResult(FContext& Context, const char* Name, const PDUType& PDU, int32 Num)
+	{
+		int64 totalBytes = 0;
+		FResult result(std::string("PDU.ToBytes.") + Name);
+		result.Operations = Num;
+		result.Seconds = TimeSeconds([&]()
+		{
+			for (int32 i = 0; i < Num; i++)
+			{
+				totalBytes += ToBytes(PDU).size();
+			}
+		});
+		result.AddMetric("Bytes", static_cast<double>(totalBytes) / Num);
+		Context.Results.push_back(result);
+	}
+
+	void BenchmarkToBytes(FContext& Context)
+	{
+		const int32 num = Context.Scaled(100000);
+		const FSamplePDUs samples;
+		AddToBytesResult(Context, PDUTypeNames[0], samples.EntityState, num);
+		AddToBytesResult(Context, PDUTypeNames[1], samples.EntityStateUpdate, num);
+		AddToBytesResult(Context, PDUTypeNames[2], samples.Fire, num);
+		AddToBytesResult(Context, PDUTypeNames[3], samples.Detonation, num);
+		AddToBytesResult(Context, PDUTypeNames[4], samples.RemoveEntity, num);
+		AddToBytesResult(Context, PDUTypeNames[5], samples.StartResume, num);
+		AddToBytesResult(Context, PDUTypeNames[6], samples.StopFreeze, num);
+		AddToBytesResult(Context, PDUTypeNames[7], samples.ElectromagneticEmissions, num);
+	}
+
+	template<typename PDUType>
+	void Unmarshal(DIS::DataStream& Stream)
+	{
+		PDUType pdu;
+		pdu.unmarshal(Stream);
+		Sink = Sink + pdu.getLength();
+	}
+
+	/**
+	 * The decode half of UPDUProcessor::ProcessDISPacket. Returns false for datagrams the validator turns away.
+	 */
+	bool DecodeDISPacket(const std::vector<uint8>& Bytes)
+	{
+		if (FDISPacketValidator::Validate(Bytes.data(), static_cast<int32>(Bytes.size())) != EDISPacketRejectReason::None)
+		{
+			return false;
+		}
+
+		DIS::DataStream stream(reinterpret_cast<const char*>(Bytes.data()), Bytes.size(), DIS::BIG);
+		switch (Bytes[2])
+		{
+		case 1:
+			Unmarshal<DIS::EntityStatePdu>(stream);
+			break;
+		case 2:
+			Unmarshal<DIS::FirePdu>(stream);
+			break;
+		case 3:
+			Unmarshal<DIS::DetonationPdu>(stream);
+			break;
+		case 12:
+			Unmarshal<DIS::RemoveEntityPdu>(stream);
+			break;
+		case 13:
+			Unmarshal<DIS::StartResumePdu>(stream);
+			break;
+		case 14:
+			Unmarshal<DIS::StopFreezePdu>(stream);
+			break;
+		case 23:
+			Unmarshal<DIS::ElectromagneticEmissionsPdu>(stream);
+			break;
+		case 67:
+			Unmarshal<DIS::EntityStateUpdatePdu>(stream);
+			break;
+		default:
+			return false;
+		}
+		return true;
+	}
+
+	void BenchmarkProcessPDU(FContext& Context)
+	{
+		const int32 num = Context.Scaled(100000);
+		const FSamplePDUs samples;
+		const std::vector<uint8> encodedPDUs[] =
+		{
+			ToBytes(samples.EntityState), ToBytes(samples.EntityStateUpdate), ToBytes(samples.Fire), ToBytes(samples.Detonation),
+			ToBytes(samples.RemoveEntity), ToBytes(samples.StartResume), ToBytes(samples.StopFreeze), ToBytes(samples.ElectromagneticEmissions)
+		};
+
+		for (int32 type = 0; type < 8; type++)
+		{
+			const std::vector<uint8>& encodedPDU = encodedPDUs[type];
+			int64 numDecoded = 0;
+			FResult result(std::string("PDU.Process.") + PDUTypeNames[type]);
+			result.Operations = num;
+			result.Seconds = TimeSeconds([&]()
+			{
+				for (int32 i = 0; i < num; i++)
+				{
+					numDecoded += DecodeDISPacket(encodedPDU) ? 1 : 0;
+				}
+			});
+			result.AddMetric("Bytes", encodedPDU.size());
+			result.AddMetric("MegabytesPerSecond", result.Seconds > 0 ? encodedPDU.size() * static_cast<double>(num) / (1024. * 1024. * result.Seconds) : 0);
+			result.AddMetric("DecodedShare", static_cast<double>(numDecoded) / num);
+			Context.Results.push_back(result);
+		}
+
+		//Datagrams cut short on the wire, which have to be turned away without ever reaching Open DIS
+		std::vector<uint8> truncatedEntityState = encodedPDUs[0];
+		truncatedEntityState.resize(truncatedEntityState.size() / 2);
+		int64 numRejected = 0;
+		FResult truncatedResult("PDU.Process.TruncatedEntityState");
+		truncatedResult.Operations = num;
+		truncatedResult.Seconds = TimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				numRejected += DecodeDISPacket(truncatedEntityState) ? 0 : 1;
+			}
+		});
+		truncatedResult.AddMetric("Rejected", numRejected);
+		Context.Results.push_back(truncatedResult);
+	}
+
+	/**
+	 * The kinematic state of a sent Entity State PDU, in the units the dead reckoning equations take.
+	 */
+	struct FDeadReckoningSample
+	{
+		glm::dvec3 Location;
+		glm::dvec3 LinearVelocity;
+		glm::dvec3 LinearAcceleration;
+		glm::dvec3 AngularVelocity;
+		//Psi, Theta, Phi
+		glm::dvec3 Orientation;
+		double DeltaTime;
+	};
+
+	enum class EAlgorithm
+	{
+		FPW, RPW, RVW, FVW, FPB, RPB, RVB, FVB
+	};
+
+	const std::pair<EAlgorithm, const char*> Algorithms[] =
+	{
+		{ EAlgorithm::FPW, "FPW" }, { EAlgorithm::RPW, "RPW" }, { EAlgorithm::RVW, "RVW" }, { EAlgorithm::FVW, "FVW" },
+		{ EAlgorithm::FPB, "FPB" }, { EAlgorithm::RPB, "RPB" }, { EAlgorithm::RVB, "RVB" }, { EAlgorithm::FVB, "FVB" }
+	};
+
+	/**
+	 * The position and orientation UDeadReckoning_BPFL::DeadReckoning computes for the algorithm, summed into the sink.
+	 */
+	double DeadReckon(EAlgorithm Algorithm, const FDeadReckoningSample& Sample)
+	{
+		glm::dvec3 location;
+		glm::dvec3 orientation = Sample.Orientation;
+		switch (Algorithm)
+		{
+		case EAlgorithm::FPW:
+			location = DISDeadReckoningMath::CalculateDeadReckonedPosition(Sample.Location, Sample.LinearVelocity, glm::dvec3(0), Sample.DeltaTime);
+			break;
+		case EAlgorithm::FVW:
+			location = DISDeadReckoningMath::CalculateDeadReckonedPosition(Sample.Location, Sample.LinearVelocity, Sample.LinearAcceleration, Sample.DeltaTime);
+			break;
+		case EAlgorithm::RPW:
+		case EAlgorithm::RVW:
+			location = DISDeadReckoningMath::CalculateDeadReckonedPosition(Sample.Location, Sample.LinearVelocity,
+				Algorithm == EAlgorithm::RVW ? Sample.LinearAcceleration : glm::dvec3(0), Sample.DeltaTime);
+			DISDeadReckoningMath::CalculateDeadReckonedOrientation(Sample.Orientation.x, Sample.Orientation.y, Sample.Orientation.z, Sample.AngularVelocity, Sample.DeltaTime,
+				orientation.x, orientation.y, orientation.z);
+			break;
+		case EAlgorithm::FPB:
+		case EAlgorithm::FVB:
+			location = DISDeadReckoningMath::GetEntityBodyDeadReckonedPosition(Sample.Location, Sample.LinearVelocity, Sample.LinearAcceleration,
+				Algorithm == EAlgorithm::FVB ? Sample.AngularVelocity : glm::dvec3(0), Sample.Orientation, Sample.DeltaTime);
+			break;
+		case EAlgorithm::RPB:
+		case EAlgorithm::RVB:
+		{
+			//RPB takes no angular velocity, as in UDeadReckoning_BPFL::DeadReckoning
+			const glm::dvec3 angularVelocity = Algorithm == EAlgorithm::RVB ? Sample.AngularVelocity : glm::dvec3(0);
+			location = DISDeadReckoningMath::GetEntityBodyDeadReckonedPosition(Sample.Location, Sample.LinearVelocity, Sample.LinearAcceleration, angularVelocity, Sample.Orientation, Sample.DeltaTime);
+			DISDeadReckoningMath::CalculateDeadReckonedOrientation(Sample.Orientation.x, Sample.Orientation.y, Sample.Orientation.z, angularVelocity, Sample.DeltaTime,
+				orientation.x, orientation.y, orientation.z);
+			break;
+		}
+		}
+		return location.x + location.y + location.z + orientation.x + orientation.y + orientation.z;
+	}
+
+	glm::dvec3 RandomUnitVector(std::mt19937& RandomStream)
+	{
+		std::normal_distribution<double> normal;
+		const glm::dvec3 vector(normal(RandomStream), normal(RandomStream), normal(RandomStream));
+		const double length = glm::length(vector);
+		return length > 0 ? vector / length : glm::dvec3(1, 0, 0);
+	}
+
+	/**
+	 * Times dead reckoning Entity State PDUs a frame to a few seconds ahead with every algorithm that moves the entity.
+	 * Entities are somewhere between 60 degrees north and south, moving, turning, and accelerating.
+	 */
+	void BenchmarkDeadReckoning(FContext& Context)
+	{
+		const int32 num = Context.Scaled(100000);
+		std::mt19937 randomStream(47);
+		std::uniform_real_distribution<double> unit(0., 1.);
+		auto range = [&](double Min, double Max) { return Min + (Max - Min) * unit(randomStream); };
+
+		std::vector<FDeadReckoningSample> samples(num);
+		for (FDeadReckoningSample& sample : samples)
+		{
+			//WGS84 geodetic to ECEF
+			const double latitude = glm::radians(range(-60., 60.));
+			const double longitude = glm::radians(range(-180., 180.));
+			const double height = range(0., 1000.);
+			const double eSquared = 0.00669437999014;
+			const double primeVerticalRadius = 6378137. / std::sqrt(1 - eSquared * std::sin(latitude) * std::sin(latitude));
+			sample.Location = glm::dvec3((primeVerticalRadius + height) * std::cos(latitude) * std::cos(longitude), (primeVerticalRadius + height) * std::cos(latitude) * std::sin(longitude),
+				(primeVerticalRadius * (1 - eSquared) + height) * std::sin(latitude));
+
+			sample.Orientation = glm::dvec3(range(-glm::pi<double>(), glm::pi<double>()), range(-0.5, 0.5), range(-0.5, 0.5));
+			sample.LinearVelocity = RandomUnitVector(randomStream) * range(0., 30.);
+			sample.LinearAcceleration = RandomUnitVector(randomStream) * range(0., 3.);
+			sample.AngularVelocity = RandomUnitVector(randomStream) * range(0., 0.3);
+			sample.DeltaTime = range(1. / 120., 5.);
+		}
+
+		for (const std::pair<EAlgorithm, const char*>& algorithm : Algorithms)
+		{
+			double sum = 0;
+			FResult result(std::string("DeadReckoning.") + algorithm.second);
+			result.Operations = num;
+			result.Seconds = TimeSeconds([&]()
+			{
+				for (const FDeadReckoningSample& sample : samples)
+				{
+					sum += DeadReckon(algorithm.first, sample);
+				}
+			});
+			Sink = Sink + sum;
+			Context.Results.push_back(result);
+		}
+	}
+
+	struct FEntityID
+	{
+		int32 Site;
+		int32 Application;
+		int32 Entity;
+
+		bool operator==(const FEntityID& Other) const { return Site == Other.Site && Application == Other.Application && Entity == Other.Entity; }
+	};
+
+	struct FEntityType
+	{
+		int32 EntityKind;
+		int32 Domain;
+		int32 Country;
+		int32 Category;
+		int32 Subcategory;
+		int32 Specific;
+		int32 Extra;
+
+		bool operator==(const FEntityType& Other) const
+		{
+			return EntityKind == Other.EntityKind && Domain == Other.Domain && Country == Other.Country && Category == Other.Category
+				&& Subcategory == Other.Subcategory && Specific == Other.Specific && Extra == Other.Extra;
+		}
+	};
+
+	/**
+	 * The string GetTypeHash(FEntityID) formats, hashed with std::hash.
+	 */
+	uint32 GetTypeHash(const FEntityID& EntityID)
+	{
+		char buffer[32];
+		const int length = std::snprintf(buffer, sizeof(buffer), "%d:%d:%d", EntityID.Site, EntityID.Application, EntityID.Entity);
+		return static_cast<uint32>(std::hash<std::string>()(std::string(buffer, length)));
+	}
+
+	/**
+	 * The string GetTypeHash(FEntityType) formats, hashed with std::hash.
+	 */
+	uint32 GetTypeHash(const FEntityType& EntityType)
+	{
+		char buffer[64];
+		const int length = std::snprintf(buffer, sizeof(buffer), "%d.%d.%d.%d.%d.%d.%d", EntityType.EntityKind, EntityType.Domain, EntityType.Country,
+			EntityType.Category, EntityType.Subcategory, EntityType.Specific, EntityType.Extra);
+		return static_cast<uint32>(std::hash<std::string>()(std::string(buffer, length)));
+	}
+
+	uint64 ToUInt64(const FEntityID& EntityID)
+	{
+		return DISEntityKeys::PackEntityID(EntityID.Site, EntityID.Application, EntityID.Entity);
+	}
+
+	uint64 ToUInt64(const FEntityType& EntityType)
+	{
+		return DISEntityKeys::PackEntityType(EntityType.EntityKind, EntityType.Domain, EntityType.Country, EntityType.Category, EntityType.Subcategory, EntityType.Specific, EntityType.Extra);
+	}
+
+	struct FTypeHasher
+	{
+		template<typename KeyType>
+		size_t operator()(const KeyType& Key) const { return GetTypeHash(Key); }
+	};
+
+	template<typename KeyType>
+	void AddKeyResults(FContext& Context, const char* Name, const std::vector<KeyType>& Keys, const std::vector<KeyType>& Queries)
+	{
+		const int32 numQueries = static_cast<int32>(Queries.size());
+		std::unordered_map<KeyType, int32, FTypeHasher> map;
+		for (int32 i = 0; i < static_cast<int32>(Keys.size()); i++)
+		{
+			map.emplace(Keys[i], i);
+		}
+
+		std::vector<uint32> hashes(numQueries);
+		FResult hashResult(std::string("EntityKeys.") + Name + "Hash");
+		hashResult.Operations = numQueries;
+		hashResult.Seconds = TimeSeconds([&]()
+		{
+			for (int32 i = 0; i < numQueries; i++)
+			{
+				hashes[i] = GetTypeHash(Queries[i]);
+			}
+		});
+
+		//Distinct keys sharing a hash end up in the same bucket chain
+		std::unordered_set<uint32> distinctHashes;
+		for (const KeyType& key : Keys)
+		{
+			distinctHashes.insert(GetTypeHash(key));
+		}
+		hashResult.AddMetric("Keys", Keys.size());
+		hashResult.AddMetric("HashCollisions", static_cast<double>(Keys.size() - distinctHashes.size()));
+		Context.Results.push_back(hashResult);
+
+		int64 numFound = 0;
+		FResult findResult(std::string("EntityKeys.") + Name + "Find");
+		findResult.Operations = numQueries;
+		findResult.Seconds = TimeSeconds([&]()
+		{
+			for (const KeyType& query : Queries)
+			{
+				numFound += map.find(query) != map.end() ? 1 : 0;
+			}
+		});
+		findResult.AddMetric("HitRate", static_cast<double>(numFound) / std::max(1, numQueries));
+		Context.Results.push_back(findResult);
+
+		//The 64 bit keys the structs sort and compare by
+		uint64 packedSum = 0;
+		FResult packResult(std::string("EntityKeys.") + Name + "Pack");
+		packResult.Operations = numQueries;
+		packResult.Seconds = TimeSeconds([&]()
+		{
+			for (const KeyType& query : Queries)
+			{
+				packedSum += ToUInt64(query);
+			}
+		});
+		Sink = Sink + static_cast<double>(packedSum);
+		Context.Results.push_back(packResult);
+	}
+
+	/**
+	 * Times hashing entity IDs and entity types and looking them up in maps the size of a large exercise, as the Game Manager does for every PDU received.
+	 * One in ten lookups is for a key that is not in the map.
+	 */
+	void BenchmarkEntityKeys(FContext& Context)
+	{
+		const int32 numEntities = Context.Scaled(10000);
+		const int32 numQueries = Context.Scaled(1000000);
+		std::mt19937 randomStream(47);
+		auto randHelper = [&](int32 Max) { return static_cast<int32>(randomStream() % static_cast<uint32>(Max)); };
+
+		std::unordered_set<uint64> entityIDSet;
+		std::vector<FEntityID> entityIDs;
+		while (static_cast<int32>(entityIDs.size()) < numEntities)
+		{
+			const FEntityID entityID = { 1 + randHelper(10), 1 + randHelper(100), 1 + randHelper(65534) };
+			if (entityIDSet.insert(ToUInt64(entityID)).second)
+			{
+				entityIDs.push_back(entityID);
+			}
+		}
+
+		std::unordered_set<uint64> entityTypeSet;
+		std::vector<FEntityType> entityTypes;
+		for (int32 i = 0; i < 2000; i++)
+		{
+			const FEntityType entityType = { 1 + randHelper(3), 1 + randHelper(4), 225, 1 + randHelper(10), 1 + randHelper(10), randHelper(5), 0 };
+			if (entityTypeSet.insert(ToUInt64(entityType)).second)
+			{
+				entityTypes.push_back(entityType);
+			}
+		}
+
+		std::vector<FEntityID> entityIDQueries(numQueries);
+		std::vector<FEntityType> entityTypeQueries(numQueries);
+		for (int32 i = 0; i < numQueries; i++)
+		{
+			const bool miss = randHelper(10) == 0;
+			entityIDQueries[i] = miss ? FEntityID{ 11 + randHelper(10), 1, 1 } : entityIDs[randHelper(static_cast<int32>(entityIDs.size()))];
+			entityTypeQueries[i] = entityTypes[randHelper(static_cast<int32>(entityTypes.size()))];
+			if (miss)
+			{
+				entityTypeQueries[i].Extra = 1;
+			}
+		}
+
+		AddKeyResults(Context, "EntityID", entityIDs, entityIDQueries);
+		AddKeyResults(Context, "EntityType", entityTypes, entityTypeQueries);
+	}
+
+	/**
+	 * Registered under the names of the engine benchmarks they stand in for, so the same filters select them.
+	 */
+	const std::pair<const char*, void(*)(FContext&)> Benchmarks[] =
+	{
+		{ "DeadReckoning.Algorithms", &BenchmarkDeadReckoning },
+		{ "EntityKeys.Lookup", &BenchmarkEntityKeys },
+		{ "PDU.Process", &BenchmarkProcessPDU },
+		{ "PDU.ToBytes", &BenchmarkToBytes }
+	};
+
+	std::string ReadPluginVersion()
+	{
+		std::ifstream upluginFile("GRILLDISForUnreal.uplugin");
+		std::stringstream uplugin;
+		uplugin << upluginFile.rdbuf();
+		const std::string text = uplugin.str();
+
+		const size_t key = text.find("\"VersionName\"");
+		const size_t open = key == std::string::npos ? key : text.find('"', text.find(':', key) + 1);
+		const size_t close = open == std::string::npos ? open : text.find('"', open + 1);
+		return close == std::string::npos ? "Unknown" : text.substr(open + 1, close - open - 1);
+	}
+
+	std::string ReadCPUBrand()
+	{
+		std::ifstream cpuInfo("/proc/cpuinfo");
+		std::string line;
+		while (std::getline(cpuInfo, line))
+		{
+			if (line.compare(0, 10, "model name") == 0)
+			{
+				const size_t start = line.find_first_not_of(" \t", line.find(':') + 1);
+				return start == std::string::npos ? "" : line.substr(start);
+			}
+		}
+		return "Unknown";
+	}
+
+	std::string EscapeJson(const std::string& Text)
+	{
+		std::string escaped;
+		for (const char character : Text)
+		{
+			if (character == '"' || character == '\\')
+			{
+				escaped += '\\';
+			}
+			escaped += character;
+		}
+		return escaped;
+	}
+
+	std::string FormatJsonNumber(double Value)
+	{
+		if (!std::isfinite(Value))
+		{
+			return "0";
+		}
+		char buffer[32];
+		std::snprintf(buffer, sizeof(buffer), "%.17g", Value);
+		return buffer;
+	}
+
+	/**
+	 * Writes results in the schema of FDISBenchmarkRegistry::ToJson.
+	 */
+	std::string ToJson(const FContext& Context)
+	{
+		const std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+		const std::time_t nowSeconds = std::chrono::system_clock::to_time_t(now);
+		const int32 milliseconds = static_cast<int32>(std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000);
+		std::tm utc;
+		gmtime_r(&nowSeconds, &utc);
+		char timestamp[32];
+		std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &utc);
+		char timestampWithMilliseconds[40];
+		std::snprintf(timestampWithMilliseconds, sizeof(timestampWithMilliseconds), "%s.%03dZ", timestamp, milliseconds);
+
+#ifdef __OPTIMIZE__
+		const char* buildConfiguration = "Optimized";
+#else
+		const char* buildConfiguration = "Unoptimized";
+#endif
+
+		std::string json = "{\n";
+		json += "\t\"schemaVersion\": 1,\n";
+		json += "\t\"pluginVersion\": \"" + EscapeJson(ReadPluginVersion()) + "\",\n";
+		json += "\t\"engineVersion\": \"" + EscapeJson(std::string("Standalone ") + __VERSION__) + "\",\n";
+		json += "\t\"platform\": \"Linux\",\n";
+		json += std::string("\t\"buildConfiguration\": \"") + buildConfiguration + "\",\n";
+		json += "\t\"cpu\": \"" + EscapeJson(ReadCPUBrand()) + "\",\n";
+		json += "\t\"cores\": " + std::to_string(std::thread::hardware_concurrency()) + ",\n";
+		json += std::string("\t\"timestamp\": \"") + timestampWithMilliseconds + "\",\n";
+		json += "\t\"scale\": " + FormatJsonNumber(Context.Scale) + ",\n";
+		json += "\t\"geoReferencing\": false,\n";
+		json += "\t\"results\": [";
+
+		for (size_t resultIndex = 0; resultIndex < Context.Results.size(); resultIndex++)
+		{
+			const FResult& result = Context.Results[resultIndex];
+			json += resultIndex == 0 ? "\n" : ",\n";
+			json += "\t\t{\n";
+			json += "\t\t\t\"name\": \"" + EscapeJson(result.Name) + "\",\n";
+			json += "\t\t\t\"operations\": " + FormatJsonNumber(static_cast<double>(result.Operations)) + ",\n";
+			json += "\t\t\t\"seconds\": " + FormatJsonNumber(result.Seconds) + ",\n";
+			json += "\t\t\t\"operationsPerSecond\": " + FormatJsonNumber(result.GetOperationsPerSecond()) + ",\n";
+			json += "\t\t\t\"nanosecondsPerOperation\": " + FormatJsonNumber(result.GetNanosecondsPerOperation()) + ",\n";
+			json += "\t\t\t\"metrics\": {";
+			for (size_t metricIndex = 0; metricIndex < result.Metrics.size(); metricIndex++)
+			{
+				json += metricIndex == 0 ? "\n" : ",\n";
+				json += "\t\t\t\t\"" + EscapeJson(result.Metrics[metricIndex].first) + "\": " + FormatJsonNumber(result.Metrics[metricIndex].second);
+			}
+			json += result.Metrics.empty() ? "}\n" : "\n\t\t\t}\n";
+			json += "\t\t}";
+		}
+		json += Context.Results.empty() ? "]\n}\n" : "\n\t]\n}\n";
+		return json;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	using namespace DISStandaloneBenchmarks;
+
+	FContext context;
+	std::string filter;
+	std::string jsonPath;
+	for (int i = 1; i < Argc; i++)
+	{
+		const std::string arg = Argv[i];
+		if (arg.compare(0, 6, "Scale=") == 0)
+		{
+			context.Scale = std::atof(arg.c_str() + 6);
+		}
+		else if (arg.compare(0, 5, "Json=") == 0)
+		{
+			jsonPath = arg.substr(5);
+		}
+		else
+		{
+			filter = arg;
+		}
+	}
+
+	for (const std::pair<const char*, void(*)(FContext&)>& benchmark : Benchmarks)
+	{
+		if (!filter.empty() && std::string(benchmark.first).find(filter) == std::string::npos)
+		{
+			continue;
+		}
+
+		std::printf("Running %s...\n", benchmark.first);
+		std::fflush(stdout);
+		const size_t firstResultIndex = context.Results.size();
+		benchmark.second(context);
+		for (size_t resultIndex = firstResultIndex; resultIndex < context.Results.size(); resultIndex++)
+		{
+			std::printf("%s\n", context.Results[resultIndex].ToString().c_str());
+		}
+	}
+
+	if (!jsonPath.empty())
+	{
+		std::ofstream jsonFile(jsonPath);
+		jsonFile << ToJson(context);
+		if (!jsonFile)
+		{
+			std::fprintf(stderr, "Failed to write benchmark results to %s\n", jsonPath.c_str());
+			return 1;
+		}
+		std::printf("Wrote %d benchmark results to %s\n", static_cast<int>(context.Results.size()), jsonPath.c_str());
+	}
+	return 0;
+}
@@ -6,6 +6,7 @@
 #include "Misc/MessageDialog.h"
 #include "AssetTypeActions_Base.h"
 #include "DISEnumerationMappingsFactory.h"
+#include "DISTerrainElevationGridFactory.h"
 
 #include "ToolMenus.h"
 #include "LevelEditor.h"
@@ -24,6 +25,8 @@ void FDISEditorModule::StartupModule()
 	IAssetTools& AssetTools = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools").Get();
 	TSharedRef<IAssetTypeActions> ACT_UDISEnumerationMappingsDatabase = MakeShareable(new UDISEnumerationMappingsDatabase);
 	AssetTools.RegisterAssetTypeActions(ACT_UDISEnumerationMappingsDatabase);
+	TSharedRef<IAssetTypeActions> ACT_DISTerrainElevationGrid = MakeShareable(new FDISTerrainElevationGridAssetTypeActions);
+	AssetTools.RegisterAssetTypeActions(ACT_DISTerrainElevationGrid);
 }
 
 void FDISEditorModule::ShutdownModule()
@@ -0,0 +1,125 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISTerrainElevationGridBaker.h"
+#include "DISTerrainElevationGrid.h"
+#include "Async/ParallelFor.h"
+#include "CollisionQueryParams.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "Misc/ScopedSlowTask.h"
+
+DEFINE_LOG_CATEGORY(LogDISTerrainElevationGridBaker);
+
+#define LOCTEXT_NAMESPACE "FDISEditor"
+
+bool FDISTerrainElevationGridBaker::Bake(UDISTerrainElevationGrid* Grid, UWorld* World)
+{
+	if (!IsValid(Grid) || !IsValid(World))
+	{
+		UE_LOG(LogDISTerrainElevationGridBaker, Warning, TEXT("Invalid grid or world was passed to the terrain elevation grid baker."));
+		return false;
+	}
+
+	const FVector2D bakeSize = Grid->BakeAreaMax - Grid->BakeAreaMin;
+	const float spacing = Grid->BakeSampleSpacing;
+	const int32 tileResolution = Grid->BakeTileResolution;
+
+	if (bakeSize.X <= 0.f || bakeSize.Y <= 0.f || spacing <= 0.f || tileResolution <= 0)
+	{
+		UE_LOG(LogDISTerrainElevationGridBaker, Warning, TEXT("%s has an empty bake area or invalid sample settings. Nothing was baked."), *Grid->GetName());
+		return false;
+	}
+
+	const int32 numTilesX = FMath::DivideAndRoundUp(FMath::Max(1, FMath::CeilToInt(bakeSize.X / spacing)), tileResolution);
+	const int32 numTilesY = FMath::DivideAndRoundUp(FMath::Max(1, FMath::CeilToInt(bakeSize.Y / spacing)), tileResolution);
+	const int32 stride = tileResolution + 1;
+	const int32 samplesPerTile = stride * stride;
+	const int32 numTiles = numTilesX * numTilesY;
+
+	TArray<FDISTerrainElevationSample> allSamples;
+	allSamples.SetNum(numTiles * samplesPerTile);
+	TArray<EDISTerrainTileFlags> tileFlags;
+	tileFlags.Init(EDISTerrainTileFlags::None, numTiles);
+
+	const ECollisionChannel collisionChannel = UEngineTypes::ConvertToCollisionChannel(Grid->BakeCollisionChannel);
+	const FCollisionQueryParams queryParams(SCENE_QUERY_STAT(DISTerrainElevationGridBake), true);
+
+	FScopedSlowTask slowTask(numTilesY, FText::Format(LOCTEXT("DISTerrainElevationGridBaking", "Baking {0}..."), FText::FromString(Grid->GetName())));
+	slowTask.MakeDialog(true);
+
+	for (int32 tileY = 0; tileY < numTilesY; tileY++)
+	{
+		slowTask.EnterProgressFrame();
+		if (slowTask.ShouldCancel())
+		{
+			UE_LOG(LogDISTerrainElevationGridBaker, Log, TEXT("Baking %s was cancelled."), *Grid->GetName());
+			return false;
+		}
+
+		//Scene queries are read only so a row of tiles can be traced in parallel
+		ParallelFor(numTilesX, [&](int32 tileX)
+		{
+			const int32 tileIndex = tileY * numTilesX + tileX;
+			FDISTerrainElevationSample* tileSamples = allSamples.GetData() + tileIndex * samplesPerTile;
+			EDISTerrainTileFlags flags = EDISTerrainTileFlags::None;
+
+			for (int32 sampleY = 0; sampleY < stride; sampleY++)
+			{
+				for (int32 sampleX = 0; sampleX < stride; sampleX++)
+				{
+					const float x = Grid->BakeAreaMin.X + (tileX * tileResolution + sampleX) * spacing;
+					const float y = Grid->BakeAreaMin.Y + (tileY * tileResolution + sampleY) * spacing;
+
+					FHitResult hitResult;
+					if (!World->LineTraceSingleByChannel(hitResult, FVector(x, y, Grid->BakeTraceStartHeight), FVector(x, y, Grid->BakeTraceEndHeight), collisionChannel, queryParams))
+					{
+						continue;
+					}
+
+					FDISTerrainElevationSample& sample = tileSamples[sampleY * stride + sampleX];
+					sample.Height = hitResult.Location.Z;
+					sample.NormalX = static_cast<int8>(FMath::Clamp(FMath::RoundToInt(hitResult.ImpactNormal.X * 127.f), -127, 127));
+					sample.NormalY = static_cast<int8>(FMath::Clamp(FMath::RoundToInt(hitResult.ImpactNormal.Y * 127.f), -127, 127));
+					sample.NormalZ = static_cast<int8>(FMath::Clamp(FMath::RoundToInt(hitResult.ImpactNormal.Z * 127.f), -127, 127));
+					sample.IsValid = 1;
+
+					flags |= EDISTerrainTileFlags::HasSamples;
+
+					const UPrimitiveComponent* hitComponent = hitResult.Component.Get();
+					if (hitComponent && hitComponent->Mobility != EComponentMobility::Static)
+					{
+						flags |= EDISTerrainTileFlags::HasDynamicGeometry;
+					}
+				}
+			}
+
+			tileFlags[tileIndex] = flags;
+		});
+	}
+
+	//Only keep samples for tiles that hit something
+	TArray<FDISTerrainElevationSample> bakedSamples;
+	bakedSamples.Reserve(allSamples.Num());
+	int32 numDynamicTiles = 0;
+	for (int32 tileIndex = 0; tileIndex < numTiles; tileIndex++)
+	{
+		if (EnumHasAnyFlags(tileFlags[tileIndex], EDISTerrainTileFlags::HasSamples))
+		{
+			bakedSamples.Append(allSamples.GetData() + tileIndex * samplesPerTile, samplesPerTile);
+		}
+		if (EnumHasAnyFlags(tileFlags[tileIndex], EDISTerrainTileFlags::HasDynamicGeometry))
+		{
+			numDynamicTiles++;
+		}
+	}
+
+	Grid->Modify();
+	Grid->SetBakedData(Grid->BakeAreaMin, spacing, tileResolution, numTilesX, numTilesY, tileFlags, bakedSamples);
+	Grid->MarkPackageDirty();
+
+	UE_LOG(LogDISTerrainElevationGridBaker, Log, TEXT("Baked %s: %dx%d tiles, %d samples, %d dynamic tiles."), *Grid->GetName(), numTilesX, numTilesY, bakedSamples.Num(), numDynamicTiles);
+
+	return true;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,52 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+
+#include "DISTerrainElevationGridFactory.h"
+#include "DISTerrainElevationGridBaker.h"
+#include "Editor.h"
+#include "ToolMenuSection.h"
+
+#define LOCTEXT_NAMESPACE "FDISEditor"
+
+UDISTerrainElevationGridFactory::UDISTerrainElevationGridFactory()
+{
+	bCreateNew = true;
+	bEditAfterNew = true;
+	//Configure the class that this factory creates
+	SupportedClass = UDISTerrainElevationGrid::StaticClass();
+}
+
+UObject* UDISTerrainElevationGridFactory::FactoryCreateNew(UClass* InClass, UObject* InParent, FName InName, EObjectFlags Flags, UObject* Context, FFeedbackContext* Warn)
+{
+	//Create the editor asset
+	UDISTerrainElevationGrid* DISTerrainElevationGridAsset = NewObject<UDISTerrainElevationGrid>(InParent, InClass, InName, Flags);
+	return DISTerrainElevationGridAsset;
+}
+
+void FDISTerrainElevationGridAssetTypeActions::GetActions(const TArray<UObject*>& InObjects, FToolMenuSection& Section)
+{
+	TArray<TWeakObjectPtr<UDISTerrainElevationGrid>> grids = GetTypedWeakObjectPtrs<UDISTerrainElevationGrid>(InObjects);
+
+	Section.AddMenuEntry(
+		"DISTerrainElevationGrid_BakeFromCurrentLevel",
+		LOCTEXT("DISTerrainElevationGrid_BakeFromCurrentLevel", "Bake From Current Level"),
+		LOCTEXT("DISTerrainElevationGrid_BakeFromCurrentLevelTooltip", "Samples the ground collision of the currently open level into this elevation grid using its bake settings."),
+		FSlateIcon(),
+		FUIAction(FExecuteAction::CreateSP(this, &FDISTerrainElevationGridAssetTypeActions::ExecuteBakeFromCurrentLevel, grids))
+	);
+}
+
+void FDISTerrainElevationGridAssetTypeActions::ExecuteBakeFromCurrentLevel(TArray<TWeakObjectPtr<UDISTerrainElevationGrid>> Grids)
+{
+	UWorld* editorWorld = GEditor ? GEditor->GetEditorWorldContext().World() : nullptr;
+
+	for (TWeakObjectPtr<UDISTerrainElevationGrid> grid : Grids)
+	{
+		if (grid.IsValid())
+		{
+			FDISTerrainElevationGridBaker::Bake(grid.Get(), editorWorld);
+		}
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,24 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UDISTerrainElevationGrid;
+class UWorld;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDISTerrainElevationGridBaker, Log, All);
+
+/**
+ * Samples a level's ground collision into a DIS Terrain Elevation Grid.
+ */
+class DISEDITOR_API FDISTerrainElevationGridBaker
+{
+public:
+	/**
+	 * Traces straight down over the grid's bake area at its sample spacing and stores the resulting heights and normals.
+	 * Tiles where any hit belongs to a non-static component are flagged as dynamic so ground clamping falls back to traces over them.
+	 * Returns false if the bake was cancelled or the settings are invalid.
+	 */
+	static bool Bake(UDISTerrainElevationGrid* Grid, UWorld* World);
+};
@@ -0,0 +1,38 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Factories/Factory.h"
+#include "AssetTypeActions_Base.h"
+#include "DISTerrainElevationGrid.h"
+#include "DISTerrainElevationGridFactory.generated.h"
+
+/**
+ * Creates DIS Terrain Elevation Grid assets. Grids are baked from the currently open level through the asset's context menu.
+ */
+UCLASS()
+class DISEDITOR_API UDISTerrainElevationGridFactory : public UFactory
+{
+	GENERATED_BODY()
+
+public:
+	UDISTerrainElevationGridFactory();
+
+	/* Creates the asset inside the UE4 Editor */
+	virtual UObject* FactoryCreateNew(UClass* InClass, UObject* InParent, FName InName, EObjectFlags Flags, UObject* Context, FFeedbackContext* Warn) override;
+};
+
+class FDISTerrainElevationGridAssetTypeActions : public FAssetTypeActions_Base {
+public:
+	virtual FText GetName() const override { return FText::FromString("DIS Terrain Elevation Grid"); }
+	virtual uint32 GetCategories() override { return EAssetTypeCategories::Misc; }
+	virtual FColor GetTypeColor() const override { return FColor(127, 191, 63); }
+	virtual FText GetAssetDescription(const FAssetData& AssetData) const override { return FText::FromString("Pre-baked ground elevation and normals used by DIS Receive Components for trace-free ground clamping."); }
+	virtual UClass* GetSupportedClass() const override { return UDISTerrainElevationGrid::StaticClass(); }
+	virtual bool HasActions(const TArray<UObject*>& InObjects) const override { return true; }
+	virtual void GetActions(const TArray<UObject*>& InObjects, FToolMenuSection& Section) override;
+
+private:
+	void ExecuteBakeFromCurrentLevel(TArray<TWeakObjectPtr<UDISTerrainElevationGrid>> Grids);
+};
@@ -0,0 +1,119 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+/**
+ * libFuzzer target for the decode entry point of the PDU Processor: the packet validator followed by the Open DIS unmarshal of every PDU type it lets through.
+ * Any datagram that passes validation and then throws, reads past the length in its header, or trips a sanitizer is a crash.
+ * Not part of the plugin. UnrealBuildTool only builds directories with a Build.cs, so this one is built by hand on Linux with clang:
+ *
+ *   clang++ -std=c++14 -g -O1 -fsanitize=fuzzer,address,undefined \
+ *     -ISource/DISFuzz/Shim -ISource/DISRuntime/Public -ISource/ThirdParty/include \
+ *     Source/DISFuzz/DISPacketFuzzTarget.cpp Source/DISRuntime/Private/DISPacketValidator.cpp \
+ *     Source/ThirdParty/include/dis6/[A-Za-z]*.cpp Source/ThirdParty/include/utils/DataStream.cpp \
+ *     -o DISPacketFuzzer
+ *   ./DISPacketFuzzer -max_len=1500 DISPacketCorpus/
+ *
+ * Building with -DDIS_FUZZ_STANDALONE instead of -fsanitize=fuzzer gives a main that runs the target over files named on the command line, to replay crashes without libFuzzer.
+ */
+
+#include "DISPacketValidator.h"
+#include <dis6/EntityStatePdu.h>
+#include <dis6/EntityStateUpdatePdu.h>
+#include <dis6/FirePdu.h>
+#include <dis6/DetonationPdu.h>
+#include <dis6/RemoveEntityPdu.h>
+#include <dis6/StartResumePdu.h>
+#include <dis6/StopFreezePdu.h>
+#include <dis6/ElectromagneticEmissionsPdu.h>
+#include <utils/DataStream.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace DISPacketFuzzing
+{
+	template<typename PDUType>
+	void Unmarshal(DIS::DataStream& Stream)
+	{
+		PDUType pdu;
+		pdu.unmarshal(Stream);
+	}
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* Data, size_t Size)
+{
+	using namespace DISPacketFuzzing;
+
+	//Nothing larger arrives in a single UDP datagram
+	if (Size > 65535 || FDISPacketValidator::Validate(Data, static_cast<int32>(Size)) != EDISPacketRejectReason::None)
+	{
+		return 0;
+	}
+
+	DIS::DataStream stream(reinterpret_cast<const char*>(Data), Size, DIS::BIG);
+	switch (Data[2])
+	{
+	case 1:
+		Unmarshal<DIS::EntityStatePdu>(stream);
+		break;
+	case 2:
+		Unmarshal<DIS::FirePdu>(stream);
+		break;
+	case 3:
+		Unmarshal<DIS::DetonationPdu>(stream);
+		break;
+	case 12:
+		Unmarshal<DIS::RemoveEntityPdu>(stream);
+		break;
+	case 13:
+		Unmarshal<DIS::StartResumePdu>(stream);
+		break;
+	case 14:
+		Unmarshal<DIS::StopFreezePdu>(stream);
+		break;
+	case 23:
+		Unmarshal<DIS::ElectromagneticEmissionsPdu>(stream);
+		break;
+	case 67:
+		Unmarshal<DIS::EntityStateUpdatePdu>(stream);
+		break;
+	default:
+		//The validator passed a PDU type the PDU Processor does not decode
+		abort();
+	}
+
+	//The datagram is only checked up to the length in its header, so nothing past it may be read
+	const size_t pduBytes = (static_cast<size_t>(Data[8]) << 8) | Data[9];
+	if (stream.GetReadPos() > pduBytes)
+	{
+		abort();
+	}
+	return 0;
+}
+
+#ifdef DIS_FUZZ_STANDALONE
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		FILE* file = fopen(argv[i], "rb");
+		if (file == nullptr)
+		{
+			fprintf(stderr, "Could not open %s\n", argv[i]);
+			return 1;
+		}
+
+		std::vector<uint8_t> bytes;
+		uint8_t buffer[4096];
+		size_t numRead;
+		while ((numRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		{
+			bytes.insert(bytes.end(), buffer, buffer + numRead);
+		}
+		fclose(file);
+
+		LLVMFuzzerTestOneInput(bytes.data(), bytes.size());
+		printf("%s: %zu bytes ok\n", argv[i], bytes.size());
+	}
+	return 0;
+}
+#endif
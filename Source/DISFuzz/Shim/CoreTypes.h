@@ -0,0 +1,17 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+//Stands in for the engine's CoreTypes.h when the packet validator is built into the standalone fuzz target and benchmark harness
+#include <cstdint>
+
+typedef uint8_t uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef uint64_t uint64;
+typedef int8_t int8;
+typedef int16_t int16;
+typedef int32_t int32;
+typedef int64_t int64;
+
+#define DISRUNTIME_API
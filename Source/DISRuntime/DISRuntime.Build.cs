@@ -32,7 +32,8 @@ public class DISRuntime : ModuleRules
 				"Slate",
 				"CoreUObject",
 				"Engine",
-				"SlateCore"
+				"SlateCore",
+				"Json"
 			}
 			);
 		
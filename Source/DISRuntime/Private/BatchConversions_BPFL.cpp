@@ -0,0 +1,674 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+
+#include "BatchConversions_BPFL.h"
+#include "DIS_BPFL.h"
+#include "DISGeodeticSolvers.h"
+#include "DISGeoTransformCache.h"
+#include "DISQuaternionConversions.h"
+
+DEFINE_LOG_CATEGORY(LogBatchConversions_BPFL);
+
+namespace BatchConversions
+{
+	using DISGeodetic::EarthEquitorialRadiusMeters;
+	using DISGeodetic::EarthPolarRadiusMeters;
+	using DISGeodetic::ESquared;
+	constexpr double Flattening = 1 - EarthPolarRadiusMeters / EarthEquitorialRadiusMeters;
+	constexpr double DegreesToRadians = DOUBLE_PI / 180.;
+	constexpr double RadiansToDegrees = 180. / DOUBLE_PI;
+
+	/**
+	 * Builds the body to local rotation matrix for the given Z-Y-X Euler angles. Columns are the body axes expressed in the local frame.
+	 */
+	FORCEINLINE void EulerToMatrix(const double Yaw, const double Pitch, const double Roll, double (&OutMatrix)[3][3])
+	{
+		const double sy = FMath::Sin(Yaw), cy = FMath::Cos(Yaw);
+		const double sp = FMath::Sin(Pitch), cp = FMath::Cos(Pitch);
+		const double sr = FMath::Sin(Roll), cr = FMath::Cos(Roll);
+
+		OutMatrix[0][0] = cp * cy;
+		OutMatrix[0][1] = sr * sp * cy - cr * sy;
+		OutMatrix[0][2] = cr * sp * cy + sr * sy;
+		OutMatrix[1][0] = cp * sy;
+		OutMatrix[1][1] = sr * sp * sy + cr * cy;
+		OutMatrix[1][2] = cr * sp * sy - sr * cy;
+		OutMatrix[2][0] = -sp;
+		OutMatrix[2][1] = sr * cp;
+		OutMatrix[2][2] = cr * cp;
+	}
+
+	/**
+	 * Calculates the North, East, Down axes in ECEF at the given latitude/longitude in radians. Rows are North, East, Down.
+	 */
+	FORCEINLINE void NorthEastDownMatrix(const double LatitudeRadians, const double LongitudeRadians, double (&OutMatrix)[3][3])
+	{
+		const double sLat = FMath::Sin(LatitudeRadians), cLat = FMath::Cos(LatitudeRadians);
+		const double sLon = FMath::Sin(LongitudeRadians), cLon = FMath::Cos(LongitudeRadians);
+
+		OutMatrix[0][0] = -sLat * cLon;
+		OutMatrix[0][1] = -sLat * sLon;
+		OutMatrix[0][2] = cLat;
+		OutMatrix[1][0] = -sLon;
+		OutMatrix[1][1] = cLon;
+		OutMatrix[1][2] = 0;
+		OutMatrix[2][0] = -cLat * cLon;
+		OutMatrix[2][1] = -cLat * sLon;
+		OutMatrix[2][2] = -sLat;
+	}
+
+	template<typename... ViewTypes>
+	bool AllViewsHaveNum(const int32 Num, const ViewTypes&... Views)
+	{
+		bool allMatch = true;
+		for (const int32 viewNum : { Views.Num()... })
+		{
+			allMatch &= viewNum == Num;
+		}
+
+		if (!allMatch)
+		{
+			UE_LOG(LogBatchConversions_BPFL, Error, TEXT("Batch conversion was given arrays of mismatched lengths. Nothing was converted."));
+		}
+		return allMatch;
+	}
+}
+
+using namespace BatchConversions;
+
+void UBatchConversions_BPFL::CalculateLatLonHeightFromEcefXYZ(TArrayView<const double> EcefX, TArrayView<const double> EcefY, TArrayView<const double> EcefZ,
+	TArrayView<double> OutLatitudeDegrees, TArrayView<double> OutLongitudeDegrees, TArrayView<double> OutHeightMeters)
+{
+	const int32 num = EcefX.Num();
+	if (!AllViewsHaveNum(num, EcefY, EcefZ, OutLatitudeDegrees, OutLongitudeDegrees, OutHeightMeters))
+	{
+		return;
+	}
+
+	const double* RESTRICT x = EcefX.GetData();
+	const double* RESTRICT y = EcefY.GetData();
+	const double* RESTRICT z = EcefZ.GetData();
+	double* RESTRICT latitude = OutLatitudeDegrees.GetData();
+	double* RESTRICT longitude = OutLongitudeDegrees.GetData();
+	double* RESTRICT height = OutHeightMeters.GetData();
+
+	//Pick the solver once so each loop stays branch free on the solver choice
+	if (DISGeodetic::GetEcefToGeodeticSolver() == EEcefToGeodeticSolver::Heikkinen)
+	{
+		for (int32 i = 0; i < num; i++)
+		{
+			DISGeodetic::EcefToGeodeticHeikkinen(x[i], y[i], z[i], latitude[i], longitude[i], height[i]);
+			latitude[i] *= RadiansToDegrees;
+			longitude[i] *= RadiansToDegrees;
+		}
+	}
+	else
+	{
+		for (int32 i = 0; i < num; i++)
+		{
+			DISGeodetic::EcefToGeodeticOlson(x[i], y[i], z[i], latitude[i], longitude[i], height[i]);
+			latitude[i] *= RadiansToDegrees;
+			longitude[i] *= RadiansToDegrees;
+		}
+	}
+}
+
+void UBatchConversions_BPFL::CalculateEcefXYZFromLatLonHeight(TArrayView<const double> LatitudeDegrees, TArrayView<const double> LongitudeDegrees, TArrayView<const double> HeightMeters,
+	TArrayView<double> OutEcefX, TArrayView<double> OutEcefY, TArrayView<double> OutEcefZ)
+{
+	const int32 num = LatitudeDegrees.Num();
+	if (!AllViewsHaveNum(num, LongitudeDegrees, HeightMeters, OutEcefX, OutEcefY, OutEcefZ))
+	{
+		return;
+	}
+
+	const double* RESTRICT latitude = LatitudeDegrees.GetData();
+	const double* RESTRICT longitude = LongitudeDegrees.GetData();
+	const double* RESTRICT height = HeightMeters.GetData();
+	double* RESTRICT x = OutEcefX.GetData();
+	double* RESTRICT y = OutEcefY.GetData();
+	double* RESTRICT z = OutEcefZ.GetData();
+
+	for (int32 i = 0; i < num; i++)
+	{
+		const double latRadians = latitude[i] * DegreesToRadians;
+		const double lonRadians = longitude[i] * DegreesToRadians;
+		const double sLat = FMath::Sin(latRadians);
+		const double cLat = FMath::Cos(latRadians);
+		const double nLat = EarthEquitorialRadiusMeters / FMath::Sqrt(1 - ESquared * sLat * sLat);
+
+		x[i] = (nLat + height[i]) * cLat * FMath::Cos(lonRadians);
+		y[i] = (nLat + height[i]) * cLat * FMath::Sin(lonRadians);
+		z[i] = ((1 - Flattening) * (1 - Flattening) * nLat + height[i]) * sLat;
+	}
+}
+
+void UBatchConversions_BPFL::CalculateNorthEastDownVectorsFromLatLon(TArrayView<const double> LatitudeDegrees, TArrayView<const double> LongitudeDegrees, TArrayView<FNorthEastDown> OutNorthEastDownVectors)
+{
+	const int32 num = LatitudeDegrees.Num();
+	if (!AllViewsHaveNum(num, LongitudeDegrees, OutNorthEastDownVectors))
+	{
+		return;
+	}
+
+	for (int32 i = 0; i < num; i++)
+	{
+		double ned[3][3];
+		NorthEastDownMatrix(LatitudeDegrees[i] * DegreesToRadians, LongitudeDegrees[i] * DegreesToRadians, ned);
+
+		OutNorthEastDownVectors[i].NorthVector = FVector(ned[0][0], ned[0][1], ned[0][2]);
+		OutNorthEastDownVectors[i].EastVector = FVector(ned[1][0], ned[1][1], ned[1][2]);
+		OutNorthEastDownVectors[i].DownVector = FVector(ned[2][0], ned[2][1], ned[2][2]);
+	}
+}
+
+void UBatchConversions_BPFL::CalculatePsiThetaPhiRadiansFromHeadingPitchRollRadiansAtLatLon(TArrayView<const double> HeadingRadians, TArrayView<const double> PitchRadians, TArrayView<const double> RollRadians,
+	TArrayView<const double> LatitudeDegrees, TArrayView<const double> LongitudeDegrees,
+	TArrayView<double> OutPsiRadians, TArrayView<double> OutThetaRadians, TArrayView<double> OutPhiRadians)
+{
+	const int32 num = HeadingRadians.Num();
+	if (!AllViewsHaveNum(num, PitchRadians, RollRadians, LatitudeDegrees, LongitudeDegrees, OutPsiRadians, OutThetaRadians, OutPhiRadians))
+	{
+		return;
+	}
+
+	for (int32 i = 0; i < num; i++)
+	{
+		double ned[3][3];
+		double bodyToNed[3][3];
+		NorthEastDownMatrix(LatitudeDegrees[i] * DegreesToRadians, LongitudeDegrees[i] * DegreesToRadians, ned);
+		EulerToMatrix(HeadingRadians[i], PitchRadians[i], RollRadians[i], bodyToNed);
+
+		//Body axes in ECEF are the NED axes weighted by the body to NED matrix columns
+		double bodyToEcef[3][3];
+		for (int32 row = 0; row < 3; row++)
+		{
+			for (int32 column = 0; column < 3; column++)
+			{
+				bodyToEcef[row][column] = ned[0][row] * bodyToNed[0][column] + ned[1][row] * bodyToNed[1][column] + ned[2][row] * bodyToNed[2][column];
+			}
+		}
+
+		OutPsiRadians[i] = FMath::Atan2(bodyToEcef[1][0], bodyToEcef[0][0]);
+		OutThetaRadians[i] = FMath::Atan2(-bodyToEcef[2][0], FMath::Sqrt(bodyToEcef[0][0] * bodyToEcef[0][0] + bodyToEcef[1][0] * bodyToEcef[1][0]));
+		OutPhiRadians[i] = FMath::Atan2(bodyToEcef[2][1], bodyToEcef[2][2]);
+	}
+}
+
+void UBatchConversions_BPFL::CalculateHeadingPitchRollRadiansFromPsiThetaPhiRadiansAtLatLon(TArrayView<const double> PsiRadians, TArrayView<const double> ThetaRadians, TArrayView<const double> PhiRadians,
+	TArrayView<const double> LatitudeDegrees, TArrayView<const double> LongitudeDegrees,
+	TArrayView<double> OutHeadingRadians, TArrayView<double> OutPitchRadians, TArrayView<double> OutRollRadians)
+{
+	const int32 num = PsiRadians.Num();
+	if (!AllViewsHaveNum(num, ThetaRadians, PhiRadians, LatitudeDegrees, LongitudeDegrees, OutHeadingRadians, OutPitchRadians, OutRollRadians))
+	{
+		return;
+	}
+
+	for (int32 i = 0; i < num; i++)
+	{
+		double ned[3][3];
+		double bodyToEcef[3][3];
+		NorthEastDownMatrix(LatitudeDegrees[i] * DegreesToRadians, LongitudeDegrees[i] * DegreesToRadians, ned);
+		EulerToMatrix(PsiRadians[i], ThetaRadians[i], PhiRadians[i], bodyToEcef);
+
+		//Project the body axes onto the NED axes
+		double bodyToNed[3][3];
+		for (int32 row = 0; row < 3; row++)
+		{
+			for (int32 column = 0; column < 3; column++)
+			{
+				bodyToNed[row][column] = ned[row][0] * bodyToEcef[0][column] + ned[row][1] * bodyToEcef[1][column] + ned[row][2] * bodyToEcef[2][column];
+			}
+		}
+
+		OutHeadingRadians[i] = FMath::Atan2(bodyToNed[1][0], bodyToNed[0][0]);
+		OutPitchRadians[i] = FMath::Atan2(-bodyToNed[2][0], FMath::Sqrt(bodyToNed[0][0] * bodyToNed[0][0] + bodyToNed[1][0] * bodyToNed[1][0]));
+		OutRollRadians[i] = FMath::Atan2(bodyToNed[2][1], bodyToNed[2][2]);
+	}
+}
+
+void UBatchConversions_BPFL::GetEcefXYZFromUnrealLocations(TArrayView<const FVector> UnrealLocations, AGeoReferencingSystem* GeoReferencingSystem, TArrayView<double> OutEcefX, TArrayView<double> OutEcefY, TArrayView<double> OutEcefZ)
+{
+	const int32 num = UnrealLocations.Num();
+	if (!AllViewsHaveNum(num, OutEcefX, OutEcefY, OutEcefZ))
+	{
+		return;
+	}
+
+	if (!IsValid(GeoReferencingSystem))
+	{
+		UE_LOG(LogBatchConversions_BPFL, Warning, TEXT("Invalid GeoReference was passed to get EcefXYZ from. Returning ECEF XYZ of (0, 0, 0)."));
+		FMemory::Memzero(OutEcefX.GetData(), num * sizeof(double));
+		FMemory::Memzero(OutEcefY.GetData(), num * sizeof(double));
+		FMemory::Memzero(OutEcefZ.GetData(), num * sizeof(double));
+		return;
+	}
+
+	TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe> cache = FDISGeoTransformCache::Get(GeoReferencingSystem);
+
+	//A single transform covers the whole level, apply it directly
+	if (cache.IsValid() && cache->IsGloballyAffine())
+	{
+		const FDISGeoTransformTile& tile = cache->GetOriginTile();
+		for (int32 i = 0; i < num; i++)
+		{
+			const glm::dvec3 ecef = tile.EngineToEcef(glm::dvec3(UnrealLocations[i].X, UnrealLocations[i].Y, UnrealLocations[i].Z));
+			OutEcefX[i] = ecef.x;
+			OutEcefY[i] = ecef.y;
+			OutEcefZ[i] = ecef.z;
+		}
+		return;
+	}
+
+	for (int32 i = 0; i < num; i++)
+	{
+		FEarthCenteredEarthFixedDouble ecef;
+		if (cache.IsValid())
+		{
+			cache->EngineToEcef(UnrealLocations[i], ecef);
+		}
+		else
+		{
+			FDISGeoTransformCache::EngineToEcef(GeoReferencingSystem, UnrealLocations[i], ecef);
+		}
+		OutEcefX[i] = ecef.X;
+		OutEcefY[i] = ecef.Y;
+		OutEcefZ[i] = ecef.Z;
+	}
+}
+
+void UBatchConversions_BPFL::GetUnrealLocationsFromEcefXYZ(TArrayView<const double> EcefX, TArrayView<const double> EcefY, TArrayView<const double> EcefZ, AGeoReferencingSystem* GeoReferencingSystem, TArrayView<FVector> OutUnrealLocations)
+{
+	const int32 num = EcefX.Num();
+	if (!AllViewsHaveNum(num, EcefY, EcefZ, OutUnrealLocations))
+	{
+		return;
+	}
+
+	if (!IsValid(GeoReferencingSystem))
+	{
+		UE_LOG(LogBatchConversions_BPFL, Warning, TEXT("Invalid GeoReference was passed to get Unreal location from. Returning Unreal location of (0, 0, 0)."));
+		for (FVector& unrealLocation : OutUnrealLocations)
+		{
+			unrealLocation = FVector::ZeroVector;
+		}
+		return;
+	}
+
+	TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe> cache = FDISGeoTransformCache::Get(GeoReferencingSystem);
+
+	//A single transform covers the whole level, apply it directly
+	if (cache.IsValid() && cache->IsGloballyAffine())
+	{
+		const FDISGeoTransformTile& tile = cache->GetOriginTile();
+		for (int32 i = 0; i < num; i++)
+		{
+			const glm::dvec3 unrealLocation = tile.EcefToEngine(glm::dvec3(EcefX[i], EcefY[i], EcefZ[i]));
+			OutUnrealLocations[i] = FVector(unrealLocation.x, unrealLocation.y, unrealLocation.z);
+		}
+		return;
+	}
+
+	for (int32 i = 0; i < num; i++)
+	{
+		const FEarthCenteredEarthFixedDouble ecef(EcefX[i], EcefY[i], EcefZ[i]);
+		if (cache.IsValid())
+		{
+			cache->EcefToEngine(ecef, OutUnrealLocations[i]);
+		}
+		else
+		{
+			FDISGeoTransformCache::EcefToEngine(GeoReferencingSystem, ecef, OutUnrealLocations[i]);
+		}
+	}
+}
+
+void UBatchConversions_BPFL::GetUnrealQuatsFromPsiThetaPhiRadiansAtEcef(TArrayView<const double> PsiRadians, TArrayView<const double> ThetaRadians, TArrayView<const double> PhiRadians,
+	TArrayView<const double> EcefX, TArrayView<const double> EcefY, TArrayView<const double> EcefZ, AGeoReferencingSystem* GeoReferencingSystem, TArrayView<FQuat> OutUnrealQuats)
+{
+	const int32 num = PsiRadians.Num();
+	if (!AllViewsHaveNum(num, ThetaRadians, PhiRadians, EcefX, EcefY, EcefZ, OutUnrealQuats))
+	{
+		return;
+	}
+
+	if (!IsValid(GeoReferencingSystem))
+	{
+		UE_LOG(LogBatchConversions_BPFL, Warning, TEXT("Invalid GeoReference was passed to get Unreal rotation from. Returning identity rotations."));
+		for (FQuat& unrealQuat : OutUnrealQuats)
+		{
+			unrealQuat = FQuat::Identity;
+		}
+		return;
+	}
+
+	TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe> cache = FDISGeoTransformCache::Get(GeoReferencingSystem);
+
+	//The local frame is the same everywhere in the level, only the body rotation changes per element
+	if (cache.IsValid() && cache->HasConstantEcefToEngineRotation())
+	{
+		const glm::dquat ecefToEngine = cache->GetConstantEcefToEngineRotation();
+		for (int32 i = 0; i < num; i++)
+		{
+			OutUnrealQuats[i] = DISQuaternion::ToUnrealQuat(ecefToEngine, DISQuaternion::FromPsiThetaPhiRadians(PsiRadians[i], ThetaRadians[i], PhiRadians[i]));
+		}
+		return;
+	}
+
+	for (int32 i = 0; i < num; i++)
+	{
+		const FEarthCenteredEarthFixedDouble ecef(EcefX[i], EcefY[i], EcefZ[i]);
+		const glm::dquat ecefToEngine = cache.IsValid() ? cache->GetEcefToEngineRotationAtEcefLocation(ecef) : FDISGeoTransformCache::GetEcefToEngineRotationAtEcefLocation(GeoReferencingSystem, ecef);
+		OutUnrealQuats[i] = DISQuaternion::ToUnrealQuat(ecefToEngine, DISQuaternion::FromPsiThetaPhiRadians(PsiRadians[i], ThetaRadians[i], PhiRadians[i]));
+	}
+}
+
+void UBatchConversions_BPFL::GetPsiThetaPhiRadiansFromUnrealQuatsAtEcef(TArrayView<const FQuat> UnrealQuats, TArrayView<const double> EcefX, TArrayView<const double> EcefY, TArrayView<const double> EcefZ,
+	AGeoReferencingSystem* GeoReferencingSystem, TArrayView<double> OutPsiRadians, TArrayView<double> OutThetaRadians, TArrayView<double> OutPhiRadians)
+{
+	const int32 num = UnrealQuats.Num();
+	if (!AllViewsHaveNum(num, EcefX, EcefY, EcefZ, OutPsiRadians, OutThetaRadians, OutPhiRadians))
+	{
+		return;
+	}
+
+	if (!IsValid(GeoReferencingSystem))
+	{
+		UE_LOG(LogBatchConversions_BPFL, Warning, TEXT("Invalid GeoReference was passed to get Psi, Theta, Phi rotation from. Returning Psi, Theta, Phi of (0, 0, 0)."));
+		FMemory::Memzero(OutPsiRadians.GetData(), num * sizeof(double));
+		FMemory::Memzero(OutThetaRadians.GetData(), num * sizeof(double));
+		FMemory::Memzero(OutPhiRadians.GetData(), num * sizeof(double));
+		return;
+	}
+
+	TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe> cache = FDISGeoTransformCache::Get(GeoReferencingSystem);
+
+	if (cache.IsValid() && cache->HasConstantEcefToEngineRotation())
+	{
+		const glm::dquat ecefToEngine = cache->GetConstantEcefToEngineRotation();
+		for (int32 i = 0; i < num; i++)
+		{
+			DISQuaternion::ToPsiThetaPhiRadians(DISQuaternion::FromUnrealQuat(ecefToEngine, UnrealQuats[i]), OutPsiRadians[i], OutThetaRadians[i], OutPhiRadians[i]);
+		}
+		return;
+	}
+
+	for (int32 i = 0; i < num; i++)
+	{
+		const FEarthCenteredEarthFixedDouble ecef(EcefX[i], EcefY[i], EcefZ[i]);
+		const glm::dquat ecefToEngine = cache.IsValid() ? cache->GetEcefToEngineRotationAtEcefLocation(ecef) : FDISGeoTransformCache::GetEcefToEngineRotationAtEcefLocation(GeoReferencingSystem, ecef);
+		DISQuaternion::ToPsiThetaPhiRadians(DISQuaternion::FromUnrealQuat(ecefToEngine, UnrealQuats[i]), OutPsiRadians[i], OutThetaRadians[i], OutPhiRadians[i]);
+	}
+}
+
+void UBatchConversions_BPFL::GetPsiThetaPhiRadiansFromUnrealRotations(TArrayView<const FRotator> UnrealRotations, TArrayView<const FVector> UnrealLocations,
+	TArrayView<const double> EcefX, TArrayView<const double> EcefY, TArrayView<const double> EcefZ,
+	AGeoReferencingSystem* GeoReferencingSystem, TArrayView<double> OutPsiRadians, TArrayView<double> OutThetaRadians, TArrayView<double> OutPhiRadians)
+{
+	const int32 num = UnrealRotations.Num();
+	if (!AllViewsHaveNum(num, UnrealLocations, EcefX, EcefY, EcefZ, OutPsiRadians, OutThetaRadians, OutPhiRadians))
+	{
+		return;
+	}
+
+	if (!IsValid(GeoReferencingSystem))
+	{
+		UE_LOG(LogBatchConversions_BPFL, Warning, TEXT("Invalid GeoReference was passed to get Psi, Theta, Phi rotation from. Returning Psi, Theta, Phi of (0, 0, 0)."));
+		FMemory::Memzero(OutPsiRadians.GetData(), num * sizeof(double));
+		FMemory::Memzero(OutThetaRadians.GetData(), num * sizeof(double));
+		FMemory::Memzero(OutPhiRadians.GetData(), num * sizeof(double));
+		return;
+	}
+
+	if (UDIS_BPFL::UseQuaternionOrientation())
+	{
+		TArray<FQuat> unrealQuats;
+		unrealQuats.SetNumUninitialized(num);
+		for (int32 i = 0; i < num; i++)
+		{
+			unrealQuats[i] = UnrealRotations[i].Quaternion();
+		}
+		GetPsiThetaPhiRadiansFromUnrealQuatsAtEcef(unrealQuats, EcefX, EcefY, EcefZ, GeoReferencingSystem, OutPsiRadians, OutThetaRadians, OutPhiRadians);
+		return;
+	}
+
+	TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe> cache = FDISGeoTransformCache::Get(GeoReferencingSystem);
+	auto getNorthEastDown = [&](const FVector& UnrealLocation, FNorthEastDown& OutNorthEastDown)
+	{
+		if (cache.IsValid())
+		{
+			cache->GetNorthEastDownAtEngineLocation(UnrealLocation, OutNorthEastDown);
+		}
+		else
+		{
+			FDISGeoTransformCache::GetNorthEastDownAtEngineLocation(GeoReferencingSystem, UnrealLocation, OutNorthEastDown);
+		}
+	};
+
+	FNorthEastDown originNorthEastDown;
+	getNorthEastDown(FVector::ZeroVector, originNorthEastDown);
+
+	TArray<double> latitude, longitude, height, heading, pitch, roll;
+	latitude.SetNumUninitialized(num);
+	longitude.SetNumUninitialized(num);
+	height.SetNumUninitialized(num);
+	heading.SetNumUninitialized(num);
+	pitch.SetNumUninitialized(num);
+	roll.SetNumUninitialized(num);
+
+	CalculateLatLonHeightFromEcefXYZ(EcefX, EcefY, EcefZ, latitude, longitude, height);
+
+	//Same heading, pitch, roll as UDIS_BPFL::GetHeadingPitchRollFromUnrealRotation, converted to radians for the batch Psi, Theta, Phi conversion
+	for (int32 i = 0; i < num; i++)
+	{
+		FNorthEastDown northEastDown;
+		getNorthEastDown(UnrealLocations[i], northEastDown);
+
+		const double xAxisRotationAngle = FMath::Acos(FVector::DotProduct(northEastDown.EastVector, originNorthEastDown.EastVector));
+		const double yAxisRotationAngle = FMath::Acos(FVector::DotProduct(northEastDown.DownVector, originNorthEastDown.DownVector));
+		const double zAxisRotationAngle = FMath::Acos(FVector::DotProduct(northEastDown.NorthVector, originNorthEastDown.NorthVector));
+
+		roll[i] = (UnrealRotations[i].Roll - xAxisRotationAngle) * DegreesToRadians;
+		pitch[i] = (UnrealRotations[i].Pitch - yAxisRotationAngle) * DegreesToRadians;
+		heading[i] = (UnrealRotations[i].Yaw - zAxisRotationAngle + 90) * DegreesToRadians;
+	}
+
+	CalculatePsiThetaPhiRadiansFromHeadingPitchRollRadiansAtLatLon(heading, pitch, roll, latitude, longitude, OutPsiRadians, OutThetaRadians, OutPhiRadians);
+}
+
+void UBatchConversions_BPFL::CalculateLatLonHeightsFromEcefXYZs(const TArray<FEarthCenteredEarthFixedFloat>& EcefLocations, TArray<FLatLonHeightFloat>& OutLatLonHeightsDegreesMeters)
+{
+	const int32 num = EcefLocations.Num();
+	FDISVectorArrayDouble ecef, latLonHeight;
+	ecef.SetNumUninitialized(num);
+	latLonHeight.SetNumUninitialized(num);
+
+	for (int32 i = 0; i < num; i++)
+	{
+		ecef.X[i] = EcefLocations[i].X;
+		ecef.Y[i] = EcefLocations[i].Y;
+		ecef.Z[i] = EcefLocations[i].Z;
+	}
+
+	CalculateLatLonHeightFromEcefXYZ(ecef.X, ecef.Y, ecef.Z, latLonHeight.X, latLonHeight.Y, latLonHeight.Z);
+
+	OutLatLonHeightsDegreesMeters.SetNumUninitialized(num);
+	for (int32 i = 0; i < num; i++)
+	{
+		OutLatLonHeightsDegreesMeters[i] = FLatLonHeightFloat(latLonHeight.X[i], latLonHeight.Y[i], latLonHeight.Z[i]);
+	}
+}
+
+void UBatchConversions_BPFL::CalculateEcefXYZsFromLatLonHeights(const TArray<FLatLonHeightFloat>& LatLonHeightsDegreesMeters, TArray<FEarthCenteredEarthFixedFloat>& OutEcefLocations)
+{
+	const int32 num = LatLonHeightsDegreesMeters.Num();
+	FDISVectorArrayDouble latLonHeight, ecef;
+	latLonHeight.SetNumUninitialized(num);
+	ecef.SetNumUninitialized(num);
+
+	for (int32 i = 0; i < num; i++)
+	{
+		latLonHeight.X[i] = LatLonHeightsDegreesMeters[i].Latitude;
+		latLonHeight.Y[i] = LatLonHeightsDegreesMeters[i].Longitude;
+		latLonHeight.Z[i] = LatLonHeightsDegreesMeters[i].Height;
+	}
+
+	CalculateEcefXYZFromLatLonHeight(latLonHeight.X, latLonHeight.Y, latLonHeight.Z, ecef.X, ecef.Y, ecef.Z);
+
+	OutEcefLocations.SetNumUninitialized(num);
+	for (int32 i = 0; i < num; i++)
+	{
+		OutEcefLocations[i] = FEarthCenteredEarthFixedFloat(ecef.X[i], ecef.Y[i], ecef.Z[i]);
+	}
+}
+
+void UBatchConversions_BPFL::CalculateNorthEastDownVectorsFromLatLons(const TArray<FLatLonHeightFloat>& LatLonHeightsDegreesMeters, TArray<FNorthEastDown>& OutNorthEastDownVectors)
+{
+	const int32 num = LatLonHeightsDegreesMeters.Num();
+	TArray<double> latitudes, longitudes;
+	latitudes.SetNumUninitialized(num);
+	longitudes.SetNumUninitialized(num);
+
+	for (int32 i = 0; i < num; i++)
+	{
+		latitudes[i] = LatLonHeightsDegreesMeters[i].Latitude;
+		longitudes[i] = LatLonHeightsDegreesMeters[i].Longitude;
+	}
+
+	OutNorthEastDownVectors.SetNum(num);
+	CalculateNorthEastDownVectorsFromLatLon(latitudes, longitudes, OutNorthEastDownVectors);
+}
+
+void UBatchConversions_BPFL::CalculatePsiThetaPhisDegreesFromHeadingPitchRollsDegreesAtLatLons(const TArray<FHeadingPitchRoll>& HeadingPitchRollsDegrees, const TArray<FLatLonHeightFloat>& LatLonHeightsDegreesMeters, TArray<FPsiThetaPhi>& OutPsiThetaPhisDegrees)
+{
+	const int32 num = HeadingPitchRollsDegrees.Num();
+	OutPsiThetaPhisDegrees.Reset();
+	if (!AllViewsHaveNum(num, LatLonHeightsDegreesMeters))
+	{
+		return;
+	}
+
+	FDISVectorArrayDouble headingPitchRoll, latLon, psiThetaPhi;
+	headingPitchRoll.SetNumUninitialized(num);
+	latLon.SetNumUninitialized(num);
+	psiThetaPhi.SetNumUninitialized(num);
+
+	for (int32 i = 0; i < num; i++)
+	{
+		headingPitchRoll.X[i] = HeadingPitchRollsDegrees[i].Heading * DegreesToRadians;
+		headingPitchRoll.Y[i] = HeadingPitchRollsDegrees[i].Pitch * DegreesToRadians;
+		headingPitchRoll.Z[i] = HeadingPitchRollsDegrees[i].Roll * DegreesToRadians;
+		latLon.X[i] = LatLonHeightsDegreesMeters[i].Latitude;
+		latLon.Y[i] = LatLonHeightsDegreesMeters[i].Longitude;
+	}
+
+	CalculatePsiThetaPhiRadiansFromHeadingPitchRollRadiansAtLatLon(headingPitchRoll.X, headingPitchRoll.Y, headingPitchRoll.Z, latLon.X, latLon.Y, psiThetaPhi.X, psiThetaPhi.Y, psiThetaPhi.Z);
+
+	OutPsiThetaPhisDegrees.SetNumUninitialized(num);
+	for (int32 i = 0; i < num; i++)
+	{
+		OutPsiThetaPhisDegrees[i] = FPsiThetaPhi(psiThetaPhi.X[i] * RadiansToDegrees, psiThetaPhi.Y[i] * RadiansToDegrees, psiThetaPhi.Z[i] * RadiansToDegrees);
+	}
+}
+
+void UBatchConversions_BPFL::CalculateHeadingPitchRollsDegreesFromPsiThetaPhisDegreesAtLatLons(const TArray<FPsiThetaPhi>& PsiThetaPhisDegrees, const TArray<FLatLonHeightFloat>& LatLonHeightsDegreesMeters, TArray<FHeadingPitchRoll>& OutHeadingPitchRollsDegrees)
+{
+	const int32 num = PsiThetaPhisDegrees.Num();
+	OutHeadingPitchRollsDegrees.Reset();
+	if (!AllViewsHaveNum(num, LatLonHeightsDegreesMeters))
+	{
+		return;
+	}
+
+	FDISVectorArrayDouble psiThetaPhi, latLon, headingPitchRoll;
+	psiThetaPhi.SetNumUninitialized(num);
+	latLon.SetNumUninitialized(num);
+	headingPitchRoll.SetNumUninitialized(num);
+
+	for (int32 i = 0; i < num; i++)
+	{
+		psiThetaPhi.X[i] = PsiThetaPhisDegrees[i].Psi * DegreesToRadians;
+		psiThetaPhi.Y[i] = PsiThetaPhisDegrees[i].Theta * DegreesToRadians;
+		psiThetaPhi.Z[i] = PsiThetaPhisDegrees[i].Phi * DegreesToRadians;
+		latLon.X[i] = LatLonHeightsDegreesMeters[i].Latitude;
+		latLon.Y[i] = LatLonHeightsDegreesMeters[i].Longitude;
+	}
+
+	CalculateHeadingPitchRollRadiansFromPsiThetaPhiRadiansAtLatLon(psiThetaPhi.X, psiThetaPhi.Y, psiThetaPhi.Z, latLon.X, latLon.Y, headingPitchRoll.X, headingPitchRoll.Y, headingPitchRoll.Z);
+
+	OutHeadingPitchRollsDegrees.SetNumUninitialized(num);
+	for (int32 i = 0; i < num; i++)
+	{
+		OutHeadingPitchRollsDegrees[i] = FHeadingPitchRoll(headingPitchRoll.X[i] * RadiansToDegrees, headingPitchRoll.Y[i] * RadiansToDegrees, headingPitchRoll.Z[i] * RadiansToDegrees);
+	}
+}
+
+void UBatchConversions_BPFL::GetEcefXYZsFromUnrealLocations(const TArray<FVector>& UnrealLocations, AGeoReferencingSystem* GeoReferencingSystem, TArray<FEarthCenteredEarthFixedFloat>& OutEcefLocations)
+{
+	const int32 num = UnrealLocations.Num();
+	FDISVectorArrayDouble ecef;
+	ecef.SetNumUninitialized(num);
+
+	GetEcefXYZFromUnrealLocations(UnrealLocations, GeoReferencingSystem, ecef.X, ecef.Y, ecef.Z);
+
+	OutEcefLocations.SetNumUninitialized(num);
+	for (int32 i = 0; i < num; i++)
+	{
+		OutEcefLocations[i] = FEarthCenteredEarthFixedFloat(ecef.X[i], ecef.Y[i], ecef.Z[i]);
+	}
+}
+
+void UBatchConversions_BPFL::GetLatLonHeightsFromUnrealLocations(const TArray<FVector>& UnrealLocations, AGeoReferencingSystem* GeoReferencingSystem, TArray<FLatLonHeightFloat>& OutLatLonHeightsDegreesMeters)
+{
+	const int32 num = UnrealLocations.Num();
+	FDISVectorArrayDouble ecef, latLonHeight;
+	ecef.SetNumUninitialized(num);
+	latLonHeight.SetNumUninitialized(num);
+
+	GetEcefXYZFromUnrealLocations(UnrealLocations, GeoReferencingSystem, ecef.X, ecef.Y, ecef.Z);
+	CalculateLatLonHeightFromEcefXYZ(ecef.X, ecef.Y, ecef.Z, latLonHeight.X, latLonHeight.Y, latLonHeight.Z);
+
+	OutLatLonHeightsDegreesMeters.SetNumUninitialized(num);
+	for (int32 i = 0; i < num; i++)
+	{
+		OutLatLonHeightsDegreesMeters[i] = FLatLonHeightFloat(latLonHeight.X[i], latLonHeight.Y[i], latLonHeight.Z[i]);
+	}
+}
+
+void UBatchConversions_BPFL::GetUnrealLocationsFromEcefXYZs(const TArray<FEarthCenteredEarthFixedFloat>& EcefLocations, AGeoReferencingSystem* GeoReferencingSystem, TArray<FVector>& OutUnrealLocations)
+{
+	const int32 num = EcefLocations.Num();
+	FDISVectorArrayDouble ecef;
+	ecef.SetNumUninitialized(num);
+
+	for (int32 i = 0; i < num; i++)
+	{
+		ecef.X[i] = EcefLocations[i].X;
+		ecef.Y[i] = EcefLocations[i].Y;
+		ecef.Z[i] = EcefLocations[i].Z;
+	}
+
+	OutUnrealLocations.SetNumUninitialized(num);
+	GetUnrealLocationsFromEcefXYZ(ecef.X, ecef.Y, ecef.Z, GeoReferencingSystem, OutUnrealLocations);
+}
+
+void UBatchConversions_BPFL::GetUnrealLocationsFromLatLonHeights(const TArray<FLatLonHeightFloat>& LatLonHeightsDegreesMeters, AGeoReferencingSystem* GeoReferencingSystem, TArray<FVector>& OutUnrealLocations)
+{
+	const int32 num = LatLonHeightsDegreesMeters.Num();
+	FDISVectorArrayDouble latLonHeight, ecef;
+	latLonHeight.SetNumUninitialized(num);
+	ecef.SetNumUninitialized(num);
+
+	for (int32 i = 0; i < num; i++)
+	{
+		latLonHeight.X[i] = LatLonHeightsDegreesMeters[i].Latitude;
+		latLonHeight.Y[i] = LatLonHeightsDegreesMeters[i].Longitude;
+		latLonHeight.Z[i] = LatLonHeightsDegreesMeters[i].Height;
+	}
+
+	CalculateEcefXYZFromLatLonHeight(latLonHeight.X, latLonHeight.Y, latLonHeight.Z, ecef.X, ecef.Y, ecef.Z);
+
+	OutUnrealLocations.SetNumUninitialized(num);
+	GetUnrealLocationsFromEcefXYZ(ecef.X, ecef.Y, ecef.Z, GeoReferencingSystem, OutUnrealLocations);
+}
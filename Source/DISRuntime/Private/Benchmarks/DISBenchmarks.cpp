@@ -0,0 +1,212 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISBenchmarks.h"
+#include "GeoReferencingSystem.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/App.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+DEFINE_LOG_CATEGORY(LogDISBenchmarks);
+
+#if !UE_BUILD_SHIPPING
+FString FDISBenchmarkResult::ToString() const
+{
+	FString resultString = FString::Printf(TEXT("%s: %lld ops in %.3f ms (%.0f ops/s, %.1f ns/op)"), *Name, Operations, Seconds * 1000., GetOperationsPerSecond(), GetNanosecondsPerOperation());
+	for (const TPair<FString, double>& metric : Metrics)
+	{
+		resultString += FString::Printf(TEXT(", %s=%g"), *metric.Key, metric.Value);
+	}
+	return resultString;
+}
+
+TMap<FString, FDISBenchmarkFunction>& FDISBenchmarkRegistry::GetBenchmarks()
+{
+	static TMap<FString, FDISBenchmarkFunction> Benchmarks;
+	return Benchmarks;
+}
+
+void FDISBenchmarkRegistry::Register(const FString& Name, FDISBenchmarkFunction Function)
+{
+	GetBenchmarks().Add(Name, MoveTemp(Function));
+}
+
+TArray<FString> FDISBenchmarkRegistry::GetBenchmarkNames()
+{
+	TArray<FString> names;
+	GetBenchmarks().GetKeys(names);
+	names.Sort();
+	return names;
+}
+
+TArray<FDISBenchmarkResult> FDISBenchmarkRegistry::Run(const FString& Filter, FDISBenchmarkContext& Context)
+{
+	const int32 firstResultIndex = Context.Results.Num();
+
+	for (const FString& name : GetBenchmarkNames())
+	{
+		if (!Filter.IsEmpty() && !name.Contains(Filter))
+		{
+			continue;
+		}
+
+		UE_LOG(LogDISBenchmarks, Log, TEXT("Running %s..."), *name);
+		GetBenchmarks()[name](Context);
+	}
+
+	TArray<FDISBenchmarkResult> results;
+	for (int32 resultIndex = firstResultIndex; resultIndex < Context.Results.Num(); resultIndex++)
+	{
+		UE_LOG(LogDISBenchmarks, Display, TEXT("%s"), *Context.Results[resultIndex].ToString());
+		results.Add(Context.Results[resultIndex]);
+	}
+	return results;
+}
+
+FString FDISBenchmarkRegistry::ToJson(const TArray<FDISBenchmarkResult>& Results, const FDISBenchmarkContext& Context)
+{
+	TSharedRef<FJsonObject> root = MakeShared<FJsonObject>();
+	root->SetNumberField(TEXT("schemaVersion"), 1);
+
+	const TSharedPtr<IPlugin> plugin = IPluginManager::Get().FindPlugin(TEXT("GRILLDISForUnreal"));
+	root->SetStringField(TEXT("pluginVersion"), plugin.IsValid() ? plugin->GetDescriptor().VersionName : TEXT("Unknown"));
+	root->SetStringField(TEXT("engineVersion"), FEngineVersion::Current().ToString());
+	root->SetStringField(TEXT("platform"), ANSI_TO_TCHAR(FPlatformProperties::IniPlatformName()));
+	root->SetStringField(TEXT("buildConfiguration"), LexToString(FApp::GetBuildConfiguration()));
+	root->SetStringField(TEXT("cpu"), FPlatformMisc::GetCPUBrand().TrimStartAndEnd());
+	root->SetNumberField(TEXT("cores"), FPlatformMisc::NumberOfCores());
+	root->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+	root->SetNumberField(TEXT("scale"), Context.Scale);
+	root->SetBoolField(TEXT("geoReferencing"), Context.GeoReferencingSystem != nullptr);
+
+	TArray<TSharedPtr<FJsonValue>> resultValues;
+	for (const FDISBenchmarkResult& result : Results)
+	{
+		TSharedRef<FJsonObject> resultObject = MakeShared<FJsonObject>();
+		resultObject->SetStringField(TEXT("name"), result.Name);
+		resultObject->SetNumberField(TEXT("operations"), static_cast<double>(result.Operations));
+		resultObject->SetNumberField(TEXT("seconds"), result.Seconds);
+		resultObject->SetNumberField(TEXT("operationsPerSecond"), result.GetOperationsPerSecond());
+		resultObject->SetNumberField(TEXT("nanosecondsPerOperation"), result.GetNanosecondsPerOperation());
+
+		TSharedRef<FJsonObject> metricsObject = MakeShared<FJsonObject>();
+		for (const TPair<FString, double>& metric : result.Metrics)
+		{
+			metricsObject->SetNumberField(metric.Key, metric.Value);
+		}
+		resultObject->SetObjectField(TEXT("metrics"), metricsObject);
+		resultValues.Add(MakeShared<FJsonValueObject>(resultObject));
+	}
+	root->SetArrayField(TEXT("results"), resultValues);
+
+	FString json;
+	const TSharedRef<TJsonWriter<>> writer = TJsonWriterFactory<>::Create(&json);
+	FJsonSerializer::Serialize(root, writer);
+	return json;
+}
+
+bool FDISBenchmarkRegistry::SaveJson(const FString& FilePath, const TArray<FDISBenchmarkResult>& Results, const FDISBenchmarkContext& Context)
+{
+	if (!FFileHelper::SaveStringToFile(ToJson(Results, Context), *FilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		UE_LOG(LogDISBenchmarks, Error, TEXT("Failed to write benchmark results to %s"), *FilePath);
+		return false;
+	}
+
+	UE_LOG(LogDISBenchmarks, Display, TEXT("Wrote %d benchmark results to %s"), Results.Num(), *FilePath);
+	return true;
+}
+
+bool FDISBenchmarkRegistry::LoadJson(const FString& FilePath, TArray<FDISBenchmarkResult>& OutResults)
+{
+	FString json;
+	TSharedPtr<FJsonObject> root;
+	if (!FFileHelper::LoadFileToString(json, *FilePath) || !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(json), root) || !root.IsValid())
+	{
+		UE_LOG(LogDISBenchmarks, Error, TEXT("Failed to read benchmark results from %s"), *FilePath);
+		return false;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* resultValues;
+	if (!root->TryGetArrayField(TEXT("results"), resultValues))
+	{
+		UE_LOG(LogDISBenchmarks, Error, TEXT("%s holds no benchmark results"), *FilePath);
+		return false;
+	}
+
+	OutResults.Reset();
+	for (const TSharedPtr<FJsonValue>& resultValue : *resultValues)
+	{
+		const TSharedPtr<FJsonObject>* resultObject;
+		if (!resultValue->TryGetObject(resultObject))
+		{
+			continue;
+		}
+
+		FDISBenchmarkResult& result = OutResults.Emplace_GetRef((*resultObject)->GetStringField(TEXT("name")));
+		result.Operations = static_cast<int64>((*resultObject)->GetNumberField(TEXT("operations")));
+		result.Seconds = (*resultObject)->GetNumberField(TEXT("seconds"));
+
+		const TSharedPtr<FJsonObject>* metricsObject;
+		if ((*resultObject)->TryGetObjectField(TEXT("metrics"), metricsObject))
+		{
+			for (const TPair<FString, TSharedPtr<FJsonValue>>& metric : (*metricsObject)->Values)
+			{
+				result.AddMetric(metric.Key, metric.Value->AsNumber());
+			}
+		}
+	}
+	return true;
+}
+
+void FDISBenchmarkRegistry::LogComparison(const TArray<FDISBenchmarkResult>& Results, const TArray<FDISBenchmarkResult>& BaselineResults)
+{
+	for (const FDISBenchmarkResult& result : Results)
+	{
+		const FDISBenchmarkResult* baseline = BaselineResults.FindByPredicate([&result](const FDISBenchmarkResult& Other) { return Other.Name == result.Name; });
+		if (baseline == nullptr || baseline->GetNanosecondsPerOperation() <= 0)
+		{
+			UE_LOG(LogDISBenchmarks, Display, TEXT("%s: %.1f ns/op, not in baseline"), *result.Name, result.GetNanosecondsPerOperation());
+			continue;
+		}
+
+		//Positive when slower than the baseline
+		const double change = result.GetNanosecondsPerOperation() / baseline->GetNanosecondsPerOperation() - 1.;
+		UE_LOG(LogDISBenchmarks, Display, TEXT("%s: %.1f ns/op against %.1f ns/op, %+.1f%%"), *result.Name, result.GetNanosecondsPerOperation(), baseline->GetNanosecondsPerOperation(), change * 100.);
+	}
+}
+
+static void RunBenchmarksFromConsole(const TArray<FString>& Args, UWorld* World)
+{
+	FDISBenchmarkContext context;
+	context.World = World;
+	context.GeoReferencingSystem = World ? AGeoReferencingSystem::GetGeoReferencingSystem(World) : nullptr;
+
+	FString filter;
+	FString jsonPath;
+	for (const FString& arg : Args)
+	{
+		if (!FParse::Value(*arg, TEXT("Scale="), context.Scale) && !FParse::Value(*arg, TEXT("Json="), jsonPath))
+		{
+			filter = arg;
+		}
+	}
+
+	const TArray<FDISBenchmarkResult> results = FDISBenchmarkRegistry::Run(filter, context);
+	if (!jsonPath.IsEmpty())
+	{
+		FDISBenchmarkRegistry::SaveJson(jsonPath, results, context);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs DISBenchmarkCommand(
+	TEXT("DIS.Benchmark"),
+	TEXT("Runs the GRILL DIS benchmarks. Usage: DIS.Benchmark [NameFilter] [Scale=1.0] [Json=<FilePath>]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunBenchmarksFromConsole));
+
+#endif
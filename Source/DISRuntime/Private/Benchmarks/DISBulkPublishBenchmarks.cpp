@@ -0,0 +1,194 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISBenchmarks.h"
+#include "DISBulkPublisher.h"
+#include "DISGameManager.h"
+#include "UDPSubsystem.h"
+#include "GeoReferencingSystem.h"
+#include "EngineUtils.h"
+
+#if !UE_BUILD_SHIPPING
+namespace DISBulkPublishBenchmarks
+{
+	/**
+	 * Times frames of FDISBulkPublisher::Publish for 20,000 entities spread over a 100 km wide area, moving at up to 30 m/s and turning slowly.
+	 * The first frame publishes every entity for the first time and is timed separately from the steady state frames that follow,
+	 * where only threshold crossings and heartbeats are encoded. Emitting is a no-op so only the publisher is measured.
+	 */
+	void BenchmarkBulkPublish(FDISBenchmarkContext& Context)
+	{
+		AGeoReferencingSystem* geoReferencingSystem = Context.GeoReferencingSystem;
+		if (!IsValid(geoReferencingSystem))
+		{
+			UE_LOG(LogDISBenchmarks, Log, TEXT("Skipping Send.BulkPublish, no GeoReferencing System in the world."));
+			return;
+		}
+
+		const int32 num = Context.Scaled(20000);
+		const int32 numFrames = 30;
+		const float frameSeconds = 1.f / 30.f;
+		FRandomStream randomStream(20000);
+
+		TArray<FEntityID> entityIDs;
+		TArray<FEntityType> entityTypes;
+		TArray<FVector> unrealLocations;
+		TArray<FRotator> unrealRotations;
+		TArray<FVector> unrealVelocities;
+		TArray<float> yawRates;
+		entityIDs.SetNum(num);
+		entityTypes.SetNum(num);
+		unrealLocations.SetNumUninitialized(num);
+		unrealRotations.SetNumUninitialized(num);
+		unrealVelocities.SetNumUninitialized(num);
+		yawRates.SetNumUninitialized(num);
+
+		for (int32 i = 0; i < num; i++)
+		{
+			entityIDs[i].Site = 1;
+			entityIDs[i].Application = 1 + i / 65535;
+			entityIDs[i].Entity = 1 + i % 65535;
+			entityTypes[i].EntityKind = 3;
+			entityTypes[i].Domain = 1;
+			entityTypes[i].Country = 225;
+
+			unrealLocations[i] = FVector(randomStream.FRandRange(-5000000.f, 5000000.f), randomStream.FRandRange(-5000000.f, 5000000.f), 0.f);
+			unrealRotations[i] = FRotator(0, randomStream.FRandRange(-180.f, 180.f), 0);
+			unrealVelocities[i] = unrealRotations[i].Vector() * randomStream.FRandRange(0.f, 3000.f);
+			yawRates[i] = randomStream.FRandRange(-10.f, 10.f);
+		}
+
+		FDISBulkPublisher publisher;
+		const FDISBulkPublishSettings settings;
+		int64 numEmitted = 0;
+		auto emit = [&numEmitted](const TArray<uint8>& Bytes, EUDPSendPriority Priority, int64 MergeKey)
+		{
+			numEmitted++;
+		};
+
+		FDISBenchmarkResult firstFrame(TEXT("Send.BulkPublish.FirstFrame"));
+		firstFrame.Operations = num;
+		firstFrame.Seconds = DISTimeSeconds([&]()
+		{
+			publisher.Publish(entityIDs, entityTypes, unrealLocations, unrealRotations, unrealVelocities, 0, settings, 0, geoReferencingSystem, emit);
+		});
+
+		//Moving the entities is not timed
+		double steadySeconds = 0;
+		numEmitted = 0;
+		for (int32 frame = 1; frame <= numFrames; frame++)
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				unrealRotations[i].Yaw += yawRates[i] * frameSeconds;
+				unrealVelocities[i] = unrealRotations[i].Vector() * unrealVelocities[i].Size();
+				unrealLocations[i] += unrealVelocities[i] * frameSeconds;
+			}
+
+			steadySeconds += DISTimeSeconds([&]()
+			{
+				publisher.Publish(entityIDs, entityTypes, unrealLocations, unrealRotations, unrealVelocities, frame * frameSeconds, settings, 0, geoReferencingSystem, emit);
+			});
+		}
+
+		FDISBenchmarkResult steadyState(TEXT("Send.BulkPublish.SteadyState"));
+		steadyState.Operations = static_cast<int64>(num) * numFrames;
+		steadyState.Seconds = steadySeconds;
+		steadyState.AddMetric(TEXT("Entities"), num);
+		steadyState.AddMetric(TEXT("MillisecondsPerFrame"), steadySeconds * 1000 / numFrames);
+		steadyState.AddMetric(TEXT("PDUsPerFrame"), static_cast<double>(numEmitted) / numFrames);
+		firstFrame.AddMetric(TEXT("Entities"), num);
+
+		Context.Results.Add(firstFrame);
+		Context.Results.Add(steadyState);
+	}
+
+	FDISAutoRegisterBenchmark BulkPublishBenchmark(TEXT("Send.BulkPublish"), &BenchmarkBulkPublish);
+
+	/**
+	 * Times ADISGameManager::PublishEntityStates for a batch of 20,000 entities spread over a 100 km wide area, including emitting the PDUs through the UDP Subsystem.
+	 * Needs a playing world with a DIS Game Manager, and puts real Entity State PDUs on the send sockets. The entities use Site and Application 65534
+	 * and are stopped with StopPublishingEntities at the end, which sends their deactivations.
+	 * World time does not advance while a console command runs, so the batches after the first are of the same instant. Nothing is due in them
+	 * and they only run the threshold and heartbeat tests.
+	 */
+	void BenchmarkPublishEntityStates(FDISBenchmarkContext& Context)
+	{
+		ADISGameManager* gameManager = nullptr;
+		if (IsValid(Context.World))
+		{
+			TActorIterator<ADISGameManager> gameManagerIterator(Context.World);
+			gameManager = gameManagerIterator ? *gameManagerIterator : nullptr;
+		}
+
+		UGameInstance* gameInstance = IsValid(gameManager) ? gameManager->GetGameInstance() : nullptr;
+		if (!IsValid(gameInstance) || !IsValid(gameInstance->GetSubsystem<UUDPSubsystem>()) || !IsValid(Context.GeoReferencingSystem))
+		{
+			UE_LOG(LogDISBenchmarks, Log, TEXT("Skipping Send.PublishEntityStates, no playing world with a DIS Game Manager and a GeoReferencing System."));
+			return;
+		}
+
+		const int32 num = Context.Scaled(20000);
+		const int32 numBatches = 30;
+		FRandomStream randomStream(20000);
+
+		TArray<FEntityID> entityIDs;
+		TArray<FEntityType> entityTypes;
+		TArray<FVector> unrealLocations;
+		TArray<FRotator> unrealRotations;
+		TArray<FVector> unrealVelocities;
+		entityIDs.SetNum(num);
+		entityTypes.SetNum(num);
+		unrealLocations.SetNumUninitialized(num);
+		unrealRotations.SetNumUninitialized(num);
+		unrealVelocities.SetNumUninitialized(num);
+
+		for (int32 i = 0; i < num; i++)
+		{
+			entityIDs[i].Site = 65534;
+			entityIDs[i].Application = 65534 - i / 65535;
+			entityIDs[i].Entity = 1 + i % 65535;
+			entityTypes[i].EntityKind = 3;
+			entityTypes[i].Domain = 1;
+			entityTypes[i].Country = 225;
+
+			unrealLocations[i] = FVector(randomStream.FRandRange(-5000000.f, 5000000.f), randomStream.FRandRange(-5000000.f, 5000000.f), 0.f);
+			unrealRotations[i] = FRotator(0, randomStream.FRandRange(-180.f, 180.f), 0);
+			unrealVelocities[i] = unrealRotations[i].Vector() * randomStream.FRandRange(0.f, 3000.f);
+		}
+
+		int32 numFirstEmitted = 0;
+		FDISBenchmarkResult firstBatch(TEXT("Send.PublishEntityStates.FirstBatch"));
+		firstBatch.Operations = num;
+		firstBatch.Seconds = DISTimeSeconds([&]()
+		{
+			numFirstEmitted = gameManager->PublishEntityStates(entityIDs, entityTypes, unrealLocations, unrealRotations, unrealVelocities);
+		});
+
+		int64 numEmitted = 0;
+		FDISBenchmarkResult steadyState(TEXT("Send.PublishEntityStates.SteadyState"));
+		steadyState.Operations = static_cast<int64>(num) * numBatches;
+		steadyState.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 batch = 0; batch < numBatches; batch++)
+			{
+				numEmitted += gameManager->PublishEntityStates(entityIDs, entityTypes, unrealLocations, unrealRotations, unrealVelocities);
+			}
+		});
+
+		gameManager->StopPublishingEntities(entityIDs);
+
+		firstBatch.AddMetric(TEXT("Entities"), num);
+		firstBatch.AddMetric(TEXT("MillisecondsPerBatch"), firstBatch.Seconds * 1000);
+		firstBatch.AddMetric(TEXT("PDUsPerBatch"), numFirstEmitted);
+		steadyState.AddMetric(TEXT("Entities"), num);
+		steadyState.AddMetric(TEXT("MillisecondsPerBatch"), steadyState.Seconds * 1000 / numBatches);
+		steadyState.AddMetric(TEXT("PDUsPerBatch"), static_cast<double>(numEmitted) / numBatches);
+
+		Context.Results.Add(firstBatch);
+		Context.Results.Add(steadyState);
+	}
+
+	FDISAutoRegisterBenchmark PublishEntityStatesBenchmark(TEXT("Send.PublishEntityStates"), &BenchmarkPublishEntityStates);
+}
+
+#endif
@@ -0,0 +1,214 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISBenchmarks.h"
+#include "DISColumnarArchive.h"
+
+#if !UE_BUILD_SHIPPING
+namespace DISColumnarArchiveBenchmarks
+{
+	void WriteBigEndian(uint8* Bytes, const void* Value, int32 NumBytes)
+	{
+		const uint8* valueBytes = static_cast<const uint8*>(Value);
+		for (int32 i = 0; i < NumBytes; i++)
+		{
+			Bytes[i] = valueBytes[NumBytes - 1 - i];
+		}
+	}
+
+	void WriteFloats(uint8* Bytes, const FVector& Value)
+	{
+		const float values[3] = { Value.X, Value.Y, Value.Z };
+		for (int32 i = 0; i < 3; i++)
+		{
+			WriteBigEndian(Bytes + i * 4, &values[i], 4);
+		}
+	}
+
+	/**
+	 * Builds a capture of 1,000 ground entities driving around a point on the earth's surface, each sending an Entity State PDU about once a second
+	 * for two minutes, with one in twenty datagrams being some other PDU. Laid out as a capture log, record headers included.
+	 */
+	int64 BuildCorpus(int32 NumEntities, TArray<uint8>& OutCorpus)
+	{
+		const int32 numRounds = 120;
+		const int32 entityStateBytes = 144;
+		const FVector origin(1130000., -4830000., 3994000.);
+		const int64 startTicks = FDateTime(2022, 6, 1).GetTicks();
+		FRandomStream randomStream(45);
+
+		TArray<FVector> locations;
+		TArray<FVector> velocities;
+		TArray<float> headings;
+		locations.SetNumUninitialized(NumEntities);
+		velocities.SetNumUninitialized(NumEntities);
+		headings.SetNumUninitialized(NumEntities);
+		for (int32 i = 0; i < NumEntities; i++)
+		{
+			locations[i] = origin + FVector(randomStream.FRandRange(-20000.f, 20000.f), randomStream.FRandRange(-20000.f, 20000.f), randomStream.FRandRange(-200.f, 200.f));
+			headings[i] = randomStream.FRandRange(-PI, PI);
+			velocities[i] = FVector(FMath::Cos(headings[i]), FMath::Sin(headings[i]), 0) * randomStream.FRandRange(0.f, 15.f);
+		}
+
+		OutCorpus.Reset();
+		int64 numPackets = 0;
+		for (int32 round = 0; round < numRounds; round++)
+		{
+			for (int32 i = 0; i < NumEntities; i++)
+			{
+				const double seconds = round + static_cast<double>(i) / NumEntities;
+				FDISCaptureRecordHeader record;
+				record.TimestampTicks = startTicks + static_cast<int64>(seconds * ETimespan::TicksPerSecond);
+				record.SourceAddress = 0x0A000001 + i % 8;
+				record.SourcePort = 3000;
+				record.ReceiveSocketID = 0;
+				record.Reserved = 0;
+
+				headings[i] += randomStream.FRandRange(-0.05f, 0.05f);
+				velocities[i] = FVector(FMath::Cos(headings[i]), FMath::Sin(headings[i]), 0) * velocities[i].Size();
+				locations[i] += velocities[i];
+
+				const bool isEntityState = (numPackets % 20) != 19;
+				record.PayloadBytes = isEntityState ? entityStateBytes : 40 + randomStream.RandHelper(64);
+				uint8* bytes = OutCorpus.GetData() + OutCorpus.AddZeroed(sizeof(record) + record.PayloadBytes);
+				FMemory::Memcpy(bytes, &record, sizeof(record));
+				uint8* pdu = bytes + sizeof(record);
+				numPackets++;
+
+				//DIS relative timestamp, units of 2^-31 hours shifted up past the absolute bit
+				const uint32 pduTimestamp = static_cast<uint32>(FMath::Fmod(seconds, 3600.) / 3600. * 0x7FFFFFFF) << 1;
+				pdu[0] = 6;
+				pdu[1] = 1;
+				WriteBigEndian(pdu + 4, &pduTimestamp, 4);
+				const uint16 length = static_cast<uint16>(record.PayloadBytes);
+				WriteBigEndian(pdu + 8, &length, 2);
+
+				if (!isEntityState)
+				{
+					//Fire PDU sized datagram with changing contents
+					pdu[2] = 2;
+					pdu[3] = 2;
+					for (uint32 byte = 12; byte < record.PayloadBytes; byte++)
+					{
+						pdu[byte] = static_cast<uint8>(randomStream.RandHelper(256));
+					}
+					continue;
+				}
+
+				pdu[2] = 1;
+				pdu[3] = 1;
+				pdu[13] = 1;
+				pdu[15] = 1;
+				const uint16 entity = static_cast<uint16>(i + 1);
+				WriteBigEndian(pdu + 16, &entity, 2);
+				pdu[18] = 1;
+				pdu[20] = 1;
+				pdu[21] = 1;
+				pdu[23] = 225;
+				pdu[24] = 1;
+				pdu[25] = 1;
+				pdu[26] = 3;
+				WriteFloats(pdu + 36, velocities[i]);
+				for (int32 axis = 0; axis < 3; axis++)
+				{
+					const double location = locations[i][axis];
+					WriteBigEndian(pdu + 48 + axis * 8, &location, 8);
+				}
+				WriteFloats(pdu + 72, FVector(headings[i], 0.02f, 0.f));
+				pdu[86] = 0x01;
+				pdu[88] = 4;
+				pdu[128] = 1;
+				FMemory::Memcpy(pdu + 129, TCHAR_TO_ANSI(*FString::Printf(TEXT("UNIT%04d"), i % 10000)), 8);
+			}
+		}
+
+		return numPackets;
+	}
+
+	/**
+	 * Encodes and decodes the corpus with every codec and checks that the decoded datagrams match byte for byte.
+	 * Reports the compression ratio and the raw megabytes encoded and decoded per second.
+	 */
+	void BenchmarkColumnarArchive(FDISBenchmarkContext& Context)
+	{
+		TArray<uint8> corpus;
+		const int64 numPackets = BuildCorpus(Context.Scaled(1000), corpus);
+		const double corpusMegabytes = corpus.Num() / (1024. * 1024.);
+		const int32 blockRecords = 65536;
+
+		const TPair<EDISArchiveCodec, const TCHAR*> codecs[] =
+		{
+			{ EDISArchiveCodec::None, TEXT("None") },
+			{ EDISArchiveCodec::LZ4, TEXT("LZ4") },
+			{ EDISArchiveCodec::Zlib, TEXT("Zlib") }
+		};
+		for (const TPair<EDISArchiveCodec, const TCHAR*>& codec : codecs)
+		{
+			FDISColumnarBlockEncoder encoder;
+			TArray<TArray<uint8>> blocks;
+			const double encodeSeconds = DISTimeSeconds([&]()
+			{
+				int64 offset = 0;
+				FDISCaptureRecordHeader record;
+				while (offset < corpus.Num())
+				{
+					FMemory::Memcpy(&record, corpus.GetData() + offset, sizeof(record));
+					encoder.AddDatagram(record, TArrayView<const uint8>(corpus.GetData() + offset + sizeof(record), record.PayloadBytes));
+					offset += sizeof(record) + record.PayloadBytes;
+
+					if (encoder.GetNumRecords() == blockRecords || offset == corpus.Num())
+					{
+						encoder.FinishBlock(codec.Key, blocks.AddDefaulted_GetRef());
+					}
+				}
+			});
+
+			int64 archiveBytes = 0;
+			for (const TArray<uint8>& block : blocks)
+			{
+				archiveBytes += block.Num();
+			}
+
+			FDISColumnarBlockDecoder decoder;
+			TArray<TArray<uint8>> decodedBlocks;
+			decodedBlocks.SetNum(blocks.Num());
+			bool decoded = true;
+			const double decodeSeconds = DISTimeSeconds([&]()
+			{
+				for (int32 block = 0; block < blocks.Num(); block++)
+				{
+					decoded &= decoder.DecodeBlock(blocks[block], decodedBlocks[block]);
+				}
+			});
+
+			//Checking is not timed
+			int64 offset = 0;
+			bool matches = decoded;
+			for (const TArray<uint8>& decodedBlock : decodedBlocks)
+			{
+				matches = matches && offset + decodedBlock.Num() <= corpus.Num() && FMemory::Memcmp(corpus.GetData() + offset, decodedBlock.GetData(), decodedBlock.Num()) == 0;
+				offset += decodedBlock.Num();
+			}
+			matches = matches && offset == corpus.Num();
+
+			FDISBenchmarkResult encodeResult(FString::Printf(TEXT("Archive.Columnar.%s.Encode"), codec.Value));
+			encodeResult.Operations = numPackets;
+			encodeResult.Seconds = encodeSeconds;
+			encodeResult.AddMetric(TEXT("CompressionRatio"), archiveBytes > 0 ? static_cast<double>(corpus.Num()) / archiveBytes : 0);
+			encodeResult.AddMetric(TEXT("MegabytesPerSecond"), encodeSeconds > 0 ? corpusMegabytes / encodeSeconds : 0);
+			encodeResult.AddMetric(TEXT("CorpusMegabytes"), corpusMegabytes);
+
+			FDISBenchmarkResult decodeResult(FString::Printf(TEXT("Archive.Columnar.%s.Decode"), codec.Value));
+			decodeResult.Operations = numPackets;
+			decodeResult.Seconds = decodeSeconds;
+			decodeResult.AddMetric(TEXT("MegabytesPerSecond"), decodeSeconds > 0 ? corpusMegabytes / decodeSeconds : 0);
+			decodeResult.AddMetric(TEXT("ByteExact"), matches ? 1 : 0);
+
+			Context.Results.Add(encodeResult);
+			Context.Results.Add(decodeResult);
+		}
+	}
+
+	FDISAutoRegisterBenchmark ColumnarArchiveBenchmark(TEXT("Archive.Columnar"), &BenchmarkColumnarArchive);
+}
+
+#endif
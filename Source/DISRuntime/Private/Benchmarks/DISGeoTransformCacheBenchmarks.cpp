@@ -0,0 +1,159 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISBenchmarks.h"
+#include "DISGeoTransformCache.h"
+#include "GeoReferencingSystem.h"
+
+#if !UE_BUILD_SHIPPING
+namespace DISGeoTransformCacheBenchmarks
+{
+	double AngleBetween(const FVector& A, const FVector& B)
+	{
+		return FMath::Acos(FMath::Clamp<double>(FVector::DotProduct(A.GetSafeNormal(), B.GetSafeNormal()), -1., 1.));
+	}
+
+	/**
+	 * Times the cached engine <-> ECEF and North, East, Down conversions against the GeoReferencing System and reports the largest difference.
+	 * Points are spread over a 200 km wide area around the engine origin from -1 km to 20 km altitude.
+	 */
+	void BenchmarkGeoTransformCache(FDISBenchmarkContext& Context)
+	{
+		AGeoReferencingSystem* geoReferencingSystem = Context.GeoReferencingSystem;
+		if (!IsValid(geoReferencingSystem))
+		{
+			UE_LOG(LogDISBenchmarks, Log, TEXT("Skipping Geodetic.TransformCache, no GeoReferencing System in the world."));
+			return;
+		}
+
+		TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe> cache = FDISGeoTransformCache::Get(geoReferencingSystem);
+		if (!cache.IsValid())
+		{
+			UE_LOG(LogDISBenchmarks, Log, TEXT("Skipping Geodetic.TransformCache, the transform cache is disabled."));
+			return;
+		}
+
+		const int32 num = Context.Scaled(100000);
+		FRandomStream randomStream(1278);
+		TArray<FVector> unrealLocations;
+		unrealLocations.SetNumUninitialized(num);
+		for (int32 i = 0; i < num; i++)
+		{
+			unrealLocations[i] = FVector(randomStream.FRandRange(-10000000.f, 10000000.f), randomStream.FRandRange(-10000000.f, 10000000.f), randomStream.FRandRange(-100000.f, 2000000.f));
+		}
+
+		TArray<FEarthCenteredEarthFixedDouble> referenceEcef, cachedEcef;
+		referenceEcef.SetNumUninitialized(num);
+		cachedEcef.SetNumUninitialized(num);
+
+		FDISBenchmarkResult referenceEngineToEcef(TEXT("Geodetic.TransformCache.EngineToEcef.Reference"));
+		referenceEngineToEcef.Operations = num;
+		referenceEngineToEcef.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				FCartesianCoordinates ecef;
+				geoReferencingSystem->EngineToECEF(unrealLocations[i], ecef);
+				referenceEcef[i] = FEarthCenteredEarthFixedDouble(ecef.X, ecef.Y, ecef.Z);
+			}
+		});
+
+		FDISBenchmarkResult cachedEngineToEcef(TEXT("Geodetic.TransformCache.EngineToEcef.Cached"));
+		cachedEngineToEcef.Operations = num;
+		cachedEngineToEcef.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				cache->EngineToEcef(unrealLocations[i], cachedEcef[i]);
+			}
+		});
+
+		double maxEcefErrorMeters = 0;
+		for (int32 i = 0; i < num; i++)
+		{
+			maxEcefErrorMeters = FMath::Max(maxEcefErrorMeters, FVector(referenceEcef[i].X - cachedEcef[i].X, referenceEcef[i].Y - cachedEcef[i].Y, referenceEcef[i].Z - cachedEcef[i].Z).Size());
+		}
+		cachedEngineToEcef.AddMetric(TEXT("MaxErrorMeters"), maxEcefErrorMeters);
+		cachedEngineToEcef.AddMetric(TEXT("SpeedupVsReference"), referenceEngineToEcef.Seconds / FMath::Max(cachedEngineToEcef.Seconds, SMALL_NUMBER));
+		cachedEngineToEcef.AddMetric(TEXT("GloballyAffine"), cache->IsGloballyAffine() ? 1 : 0);
+		cachedEngineToEcef.AddMetric(TEXT("FlatEarthAffine"), cache->IsFlatEarthAffine() ? 1 : 0);
+		cachedEngineToEcef.AddMetric(TEXT("Tiles"), cache->GetNumTiles());
+
+		TArray<FVector> referenceUnreal, cachedUnreal;
+		referenceUnreal.SetNumUninitialized(num);
+		cachedUnreal.SetNumUninitialized(num);
+
+		FDISBenchmarkResult referenceEcefToEngine(TEXT("Geodetic.TransformCache.EcefToEngine.Reference"));
+		referenceEcefToEngine.Operations = num;
+		referenceEcefToEngine.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				geoReferencingSystem->ECEFToEngine(FCartesianCoordinates(referenceEcef[i].X, referenceEcef[i].Y, referenceEcef[i].Z), referenceUnreal[i]);
+			}
+		});
+
+		FDISBenchmarkResult cachedEcefToEngine(TEXT("Geodetic.TransformCache.EcefToEngine.Cached"));
+		cachedEcefToEngine.Operations = num;
+		cachedEcefToEngine.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				cache->EcefToEngine(referenceEcef[i], cachedUnreal[i]);
+			}
+		});
+
+		double maxUnrealErrorCentimeters = 0;
+		for (int32 i = 0; i < num; i++)
+		{
+			maxUnrealErrorCentimeters = FMath::Max(maxUnrealErrorCentimeters, static_cast<double>(FVector::Dist(referenceUnreal[i], cachedUnreal[i])));
+		}
+		cachedEcefToEngine.AddMetric(TEXT("MaxErrorCentimeters"), maxUnrealErrorCentimeters);
+		cachedEcefToEngine.AddMetric(TEXT("SpeedupVsReference"), referenceEcefToEngine.Seconds / FMath::Max(cachedEcefToEngine.Seconds, SMALL_NUMBER));
+
+		TArray<FNorthEastDown> referenceNorthEastDown, cachedNorthEastDown;
+		referenceNorthEastDown.SetNum(num);
+		cachedNorthEastDown.SetNum(num);
+
+		FDISBenchmarkResult referenceNorthEastDownResult(TEXT("Geodetic.TransformCache.NorthEastDown.Reference"));
+		referenceNorthEastDownResult.Operations = num;
+		referenceNorthEastDownResult.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				geoReferencingSystem->GetENUVectorsAtEngineLocation(unrealLocations[i], referenceNorthEastDown[i].EastVector, referenceNorthEastDown[i].NorthVector, referenceNorthEastDown[i].DownVector);
+				referenceNorthEastDown[i].DownVector *= -1;
+			}
+		});
+
+		FDISBenchmarkResult cachedNorthEastDownResult(TEXT("Geodetic.TransformCache.NorthEastDown.Cached"));
+		cachedNorthEastDownResult.Operations = num;
+		cachedNorthEastDownResult.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				cache->GetNorthEastDownAtEngineLocation(unrealLocations[i], cachedNorthEastDown[i]);
+			}
+		});
+
+		double maxNorthEastDownErrorRadians = 0;
+		for (int32 i = 0; i < num; i++)
+		{
+			maxNorthEastDownErrorRadians = FMath::Max(maxNorthEastDownErrorRadians, AngleBetween(referenceNorthEastDown[i].NorthVector, cachedNorthEastDown[i].NorthVector));
+			maxNorthEastDownErrorRadians = FMath::Max(maxNorthEastDownErrorRadians, AngleBetween(referenceNorthEastDown[i].EastVector, cachedNorthEastDown[i].EastVector));
+			maxNorthEastDownErrorRadians = FMath::Max(maxNorthEastDownErrorRadians, AngleBetween(referenceNorthEastDown[i].DownVector, cachedNorthEastDown[i].DownVector));
+		}
+		cachedNorthEastDownResult.AddMetric(TEXT("MaxErrorRadians"), maxNorthEastDownErrorRadians);
+		cachedNorthEastDownResult.AddMetric(TEXT("SpeedupVsReference"), referenceNorthEastDownResult.Seconds / FMath::Max(cachedNorthEastDownResult.Seconds, SMALL_NUMBER));
+
+		Context.Results.Add(referenceEngineToEcef);
+		Context.Results.Add(cachedEngineToEcef);
+		Context.Results.Add(referenceEcefToEngine);
+		Context.Results.Add(cachedEcefToEngine);
+		Context.Results.Add(referenceNorthEastDownResult);
+		Context.Results.Add(cachedNorthEastDownResult);
+	}
+
+	FDISAutoRegisterBenchmark GeoTransformCacheBenchmark(TEXT("Geodetic.TransformCache"), &BenchmarkGeoTransformCache);
+}
+
+#endif
@@ -0,0 +1,233 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISBenchmarks.h"
+#include "BatchConversions_BPFL.h"
+#include "DIS_BPFL.h"
+
+#if !UE_BUILD_SHIPPING
+namespace DISGeodeticBenchmarks
+{
+	/**
+	 * Fills the arrays with random points between -1 km and 100 km altitude covering the whole globe.
+	 */
+	void MakeRandomLatLonHeights(const int32 Num, FDISVectorArrayDouble& OutLatLonHeight, FDISVectorArrayDouble& OutEcef)
+	{
+		FRandomStream randomStream(1278);
+		OutLatLonHeight.SetNumUninitialized(Num);
+		OutEcef.SetNumUninitialized(Num);
+
+		for (int32 i = 0; i < Num; i++)
+		{
+			OutLatLonHeight.X[i] = randomStream.FRandRange(-90.f, 90.f);
+			OutLatLonHeight.Y[i] = randomStream.FRandRange(-180.f, 180.f);
+			OutLatLonHeight.Z[i] = randomStream.FRandRange(-1000.f, 100000.f);
+		}
+
+		UBatchConversions_BPFL::CalculateEcefXYZFromLatLonHeight(OutLatLonHeight.X, OutLatLonHeight.Y, OutLatLonHeight.Z, OutEcef.X, OutEcef.Y, OutEcef.Z);
+	}
+
+	double AngleDifferenceDegrees(const double A, const double B)
+	{
+		return FMath::Abs(FMath::Fmod(A - B + 540., 360.) - 180.);
+	}
+
+	void BenchmarkEcefToLatLonHeight(FDISBenchmarkContext& Context)
+	{
+		const int32 num = Context.Scaled(1000000);
+		FDISVectorArrayDouble latLonHeight, ecef, batchLatLonHeight;
+		MakeRandomLatLonHeights(num, latLonHeight, ecef);
+		batchLatLonHeight.SetNumUninitialized(num);
+
+		TArray<FLatLonHeightDouble> scalarLatLonHeight;
+		scalarLatLonHeight.SetNumUninitialized(num);
+
+		FDISBenchmarkResult scalarResult(TEXT("Geodetic.EcefToLatLonHeight.Scalar"));
+		scalarResult.Operations = num;
+		scalarResult.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				UDIS_BPFL::CalculateLatLonHeightFromEcefXYZ(FEarthCenteredEarthFixedDouble(ecef.X[i], ecef.Y[i], ecef.Z[i]), scalarLatLonHeight[i]);
+			}
+		});
+
+		FDISBenchmarkResult batchResult(TEXT("Geodetic.EcefToLatLonHeight.Batch"));
+		batchResult.Operations = num;
+		batchResult.Seconds = DISTimeSeconds([&]()
+		{
+			UBatchConversions_BPFL::CalculateLatLonHeightFromEcefXYZ(ecef.X, ecef.Y, ecef.Z, batchLatLonHeight.X, batchLatLonHeight.Y, batchLatLonHeight.Z);
+		});
+
+		double maxLatLonError = 0, maxHeightError = 0;
+		for (int32 i = 0; i < num; i++)
+		{
+			maxLatLonError = FMath::Max(maxLatLonError, FMath::Abs(batchLatLonHeight.X[i] - scalarLatLonHeight[i].Latitude));
+			maxLatLonError = FMath::Max(maxLatLonError, AngleDifferenceDegrees(batchLatLonHeight.Y[i], scalarLatLonHeight[i].Longitude));
+			maxHeightError = FMath::Max(maxHeightError, FMath::Abs(batchLatLonHeight.Z[i] - scalarLatLonHeight[i].Height));
+		}
+
+		batchResult.AddMetric(TEXT("MaxLatLonDifferenceVsScalarDegrees"), maxLatLonError);
+		batchResult.AddMetric(TEXT("MaxHeightDifferenceVsScalarMeters"), maxHeightError);
+		batchResult.AddMetric(TEXT("SpeedupVsScalar"), scalarResult.Seconds / FMath::Max(batchResult.Seconds, SMALL_NUMBER));
+
+		Context.Results.Add(scalarResult);
+		Context.Results.Add(batchResult);
+	}
+
+	void BenchmarkLatLonHeightToEcef(FDISBenchmarkContext& Context)
+	{
+		const int32 num = Context.Scaled(1000000);
+		FDISVectorArrayDouble latLonHeight, ecef, batchEcef;
+		MakeRandomLatLonHeights(num, latLonHeight, ecef);
+		batchEcef.SetNumUninitialized(num);
+
+		TArray<FEarthCenteredEarthFixedDouble> scalarEcef;
+		scalarEcef.SetNumUninitialized(num);
+
+		FDISBenchmarkResult scalarResult(TEXT("Geodetic.LatLonHeightToEcef.Scalar"));
+		scalarResult.Operations = num;
+		scalarResult.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				UDIS_BPFL::CalculateEcefXYZFromLatLonHeight(FLatLonHeightDouble(latLonHeight.X[i], latLonHeight.Y[i], latLonHeight.Z[i]), scalarEcef[i]);
+			}
+		});
+
+		FDISBenchmarkResult batchResult(TEXT("Geodetic.LatLonHeightToEcef.Batch"));
+		batchResult.Operations = num;
+		batchResult.Seconds = DISTimeSeconds([&]()
+		{
+			UBatchConversions_BPFL::CalculateEcefXYZFromLatLonHeight(latLonHeight.X, latLonHeight.Y, latLonHeight.Z, batchEcef.X, batchEcef.Y, batchEcef.Z);
+		});
+
+		double maxError = 0;
+		for (int32 i = 0; i < num; i++)
+		{
+			maxError = FMath::Max(maxError, FMath::Abs(batchEcef.X[i] - scalarEcef[i].X));
+			maxError = FMath::Max(maxError, FMath::Abs(batchEcef.Y[i] - scalarEcef[i].Y));
+			maxError = FMath::Max(maxError, FMath::Abs(batchEcef.Z[i] - scalarEcef[i].Z));
+		}
+
+		batchResult.AddMetric(TEXT("MaxDifferenceVsScalarMeters"), maxError);
+		batchResult.AddMetric(TEXT("SpeedupVsScalar"), scalarResult.Seconds / FMath::Max(batchResult.Seconds, SMALL_NUMBER));
+
+		Context.Results.Add(scalarResult);
+		Context.Results.Add(batchResult);
+	}
+
+	void BenchmarkPsiThetaPhiFromHeadingPitchRoll(FDISBenchmarkContext& Context)
+	{
+		//The scalar path is much slower, keep the default size smaller
+		const int32 num = Context.Scaled(100000);
+		FDISVectorArrayDouble latLonHeight, ecef, headingPitchRoll, psiThetaPhi;
+		MakeRandomLatLonHeights(num, latLonHeight, ecef);
+		headingPitchRoll.SetNumUninitialized(num);
+		psiThetaPhi.SetNumUninitialized(num);
+
+		FRandomStream randomStream(1278);
+		for (int32 i = 0; i < num; i++)
+		{
+			headingPitchRoll.X[i] = FMath::DegreesToRadians(randomStream.FRandRange(-180.f, 180.f));
+			headingPitchRoll.Y[i] = FMath::DegreesToRadians(randomStream.FRandRange(-85.f, 85.f));
+			headingPitchRoll.Z[i] = FMath::DegreesToRadians(randomStream.FRandRange(-180.f, 180.f));
+		}
+
+		TArray<FPsiThetaPhi> scalarPsiThetaPhi;
+		scalarPsiThetaPhi.SetNumUninitialized(num);
+
+		FDISBenchmarkResult scalarResult(TEXT("Geodetic.PsiThetaPhiFromHeadingPitchRoll.Scalar"));
+		scalarResult.Operations = num;
+		scalarResult.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				const FHeadingPitchRoll headingPitchRollRadians(headingPitchRoll.X[i], headingPitchRoll.Y[i], headingPitchRoll.Z[i]);
+				UDIS_BPFL::CalculatePsiThetaPhiRadiansFromHeadingPitchRollRadiansAtLatLon(headingPitchRollRadians, latLonHeight.X[i], latLonHeight.Y[i], scalarPsiThetaPhi[i]);
+			}
+		});
+
+		FDISBenchmarkResult batchResult(TEXT("Geodetic.PsiThetaPhiFromHeadingPitchRoll.Batch"));
+		batchResult.Operations = num;
+		batchResult.Seconds = DISTimeSeconds([&]()
+		{
+			UBatchConversions_BPFL::CalculatePsiThetaPhiRadiansFromHeadingPitchRollRadiansAtLatLon(headingPitchRoll.X, headingPitchRoll.Y, headingPitchRoll.Z,
+				latLonHeight.X, latLonHeight.Y, psiThetaPhi.X, psiThetaPhi.Y, psiThetaPhi.Z);
+		});
+
+		//The scalar path runs in single precision so differences of a few thousandths of a degree are expected
+		double maxError = 0;
+		for (int32 i = 0; i < num; i++)
+		{
+			maxError = FMath::Max(maxError, AngleDifferenceDegrees(FMath::RadiansToDegrees(psiThetaPhi.X[i]), FMath::RadiansToDegrees(scalarPsiThetaPhi[i].Psi)));
+			maxError = FMath::Max(maxError, AngleDifferenceDegrees(FMath::RadiansToDegrees(psiThetaPhi.Y[i]), FMath::RadiansToDegrees(scalarPsiThetaPhi[i].Theta)));
+			maxError = FMath::Max(maxError, AngleDifferenceDegrees(FMath::RadiansToDegrees(psiThetaPhi.Z[i]), FMath::RadiansToDegrees(scalarPsiThetaPhi[i].Phi)));
+		}
+
+		batchResult.AddMetric(TEXT("MaxDifferenceVsScalarDegrees"), maxError);
+		batchResult.AddMetric(TEXT("SpeedupVsScalar"), scalarResult.Seconds / FMath::Max(batchResult.Seconds, SMALL_NUMBER));
+
+		Context.Results.Add(scalarResult);
+		Context.Results.Add(batchResult);
+	}
+
+	void BenchmarkEngineToEcef(FDISBenchmarkContext& Context)
+	{
+		if (!IsValid(Context.GeoReferencingSystem))
+		{
+			UE_LOG(LogDISBenchmarks, Log, TEXT("Skipping Geodetic.EngineToEcef, no GeoReferencing System in the world."));
+			return;
+		}
+
+		const int32 num = Context.Scaled(100000);
+		FRandomStream randomStream(1278);
+		TArray<FVector> unrealLocations;
+		unrealLocations.SetNumUninitialized(num);
+		for (int32 i = 0; i < num; i++)
+		{
+			unrealLocations[i] = randomStream.VRand() * randomStream.FRandRange(0.f, 5000000.f);
+		}
+
+		FDISVectorArrayDouble batchEcef;
+		batchEcef.SetNumUninitialized(num);
+		TArray<FEarthCenteredEarthFixedFloat> scalarEcef;
+		scalarEcef.SetNumUninitialized(num);
+
+		FDISBenchmarkResult scalarResult(TEXT("Geodetic.EngineToEcef.Scalar"));
+		scalarResult.Operations = num;
+		scalarResult.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				UDIS_BPFL::GetEcefXYZFromUnrealLocation(unrealLocations[i], Context.GeoReferencingSystem, scalarEcef[i]);
+			}
+		});
+
+		FDISBenchmarkResult batchResult(TEXT("Geodetic.EngineToEcef.Batch"));
+		batchResult.Operations = num;
+		batchResult.Seconds = DISTimeSeconds([&]()
+		{
+			UBatchConversions_BPFL::GetEcefXYZFromUnrealLocations(unrealLocations, Context.GeoReferencingSystem, batchEcef.X, batchEcef.Y, batchEcef.Z);
+		});
+
+		//The scalar path returns single precision ECEF
+		double maxError = 0;
+		for (int32 i = 0; i < num; i++)
+		{
+			maxError = FMath::Max(maxError, FVector(batchEcef.X[i] - scalarEcef[i].X, batchEcef.Y[i] - scalarEcef[i].Y, batchEcef.Z[i] - scalarEcef[i].Z).GetAbsMax());
+		}
+
+		batchResult.AddMetric(TEXT("MaxDifferenceVsScalarMeters"), maxError);
+		batchResult.AddMetric(TEXT("SpeedupVsScalar"), scalarResult.Seconds / FMath::Max(batchResult.Seconds, SMALL_NUMBER));
+
+		Context.Results.Add(scalarResult);
+		Context.Results.Add(batchResult);
+	}
+
+	FDISAutoRegisterBenchmark EcefToLatLonHeightBenchmark(TEXT("Geodetic.EcefToLatLonHeight"), &BenchmarkEcefToLatLonHeight);
+	FDISAutoRegisterBenchmark LatLonHeightToEcefBenchmark(TEXT("Geodetic.LatLonHeightToEcef"), &BenchmarkLatLonHeightToEcef);
+	FDISAutoRegisterBenchmark PsiThetaPhiFromHeadingPitchRollBenchmark(TEXT("Geodetic.PsiThetaPhiFromHeadingPitchRoll"), &BenchmarkPsiThetaPhiFromHeadingPitchRoll);
+	FDISAutoRegisterBenchmark EngineToEcefBenchmark(TEXT("Geodetic.EngineToEcef"), &BenchmarkEngineToEcef);
+}
+
+#endif
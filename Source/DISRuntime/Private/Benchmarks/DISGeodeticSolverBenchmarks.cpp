@@ -0,0 +1,150 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISBenchmarks.h"
+#include "BatchConversions_BPFL.h"
+#include "DISGeodeticSolvers.h"
+#include "GeoReferencingSystem.h"
+
+#if !UE_BUILD_SHIPPING
+namespace DISGeodeticSolverBenchmarks
+{
+	struct FSolverErrors
+	{
+		double MaxHorizontalErrorMeters = 0;
+		double MaxHeightErrorMeters = 0;
+		double SumSquaredHorizontalErrorMeters = 0;
+		double SumSquaredHeightErrorMeters = 0;
+		int32 InvalidResults = 0;
+		int32 Count = 0;
+
+		void Add(const double TrueLatitudeRadians, const double TrueLongitudeRadians, const double TrueHeightMeters, const double LatitudeRadians, const double LongitudeRadians, const double HeightMeters)
+		{
+			Count++;
+			if (!FMath::IsFinite(LatitudeRadians) || !FMath::IsFinite(LongitudeRadians) || !FMath::IsFinite(HeightMeters))
+			{
+				InvalidResults++;
+				return;
+			}
+
+			//Longitude is meaningless on the polar axis and wraps at the antimeridian
+			const double lonDifference = FMath::Abs(FMath::Fmod(LongitudeRadians - TrueLongitudeRadians + 3 * DOUBLE_PI, 2 * DOUBLE_PI) - DOUBLE_PI);
+			const double northErrorMeters = (LatitudeRadians - TrueLatitudeRadians) * DISGeodetic::EarthEquitorialRadiusMeters;
+			const double eastErrorMeters = lonDifference * FMath::Cos(TrueLatitudeRadians) * DISGeodetic::EarthEquitorialRadiusMeters;
+			const double horizontalErrorSquared = northErrorMeters * northErrorMeters + eastErrorMeters * eastErrorMeters;
+			const double heightError = HeightMeters - TrueHeightMeters;
+
+			MaxHorizontalErrorMeters = FMath::Max(MaxHorizontalErrorMeters, FMath::Sqrt(horizontalErrorSquared));
+			MaxHeightErrorMeters = FMath::Max(MaxHeightErrorMeters, FMath::Abs(heightError));
+			SumSquaredHorizontalErrorMeters += horizontalErrorSquared;
+			SumSquaredHeightErrorMeters += heightError * heightError;
+		}
+
+		void AddMetrics(FDISBenchmarkResult& Result) const
+		{
+			const int32 validCount = FMath::Max(1, Count - InvalidResults);
+			Result.AddMetric(TEXT("MaxHorizontalErrorMeters"), MaxHorizontalErrorMeters);
+			Result.AddMetric(TEXT("RmsHorizontalErrorMeters"), FMath::Sqrt(SumSquaredHorizontalErrorMeters / validCount));
+			Result.AddMetric(TEXT("MaxHeightErrorMeters"), MaxHeightErrorMeters);
+			Result.AddMetric(TEXT("RmsHeightErrorMeters"), FMath::Sqrt(SumSquaredHeightErrorMeters / validCount));
+			Result.AddMetric(TEXT("InvalidResults"), InvalidResults);
+		}
+	};
+
+	/**
+	 * Compares every solver against known geodetic locations on a global grid from -1 km to 100 km altitude, including both poles.
+	 * The ECEF inputs are generated from the grid with the exact forward conversion so the grid values are the ground truth.
+	 */
+	void BenchmarkEcefToGeodeticSolvers(FDISBenchmarkContext& Context)
+	{
+		const int32 latitudeSteps = FMath::Max(2, Context.Scaled(181));
+		const int32 longitudeSteps = FMath::Max(2, Context.Scaled(360));
+		constexpr int32 HeightSteps = 21;
+		constexpr double MinHeightMeters = -1000;
+		constexpr double MaxHeightMeters = 100000;
+
+		FDISVectorArrayDouble truth, ecef;
+		truth.SetNumUninitialized(latitudeSteps * longitudeSteps * HeightSteps);
+		int32 index = 0;
+		for (int32 latIndex = 0; latIndex < latitudeSteps; latIndex++)
+		{
+			for (int32 lonIndex = 0; lonIndex < longitudeSteps; lonIndex++)
+			{
+				for (int32 heightIndex = 0; heightIndex < HeightSteps; heightIndex++)
+				{
+					truth.X[index] = -90. + 180. * latIndex / (latitudeSteps - 1);
+					truth.Y[index] = -180. + 360. * lonIndex / longitudeSteps;
+					truth.Z[index] = MinHeightMeters + (MaxHeightMeters - MinHeightMeters) * heightIndex / (HeightSteps - 1);
+					index++;
+				}
+			}
+		}
+		const int32 num = truth.Num();
+		ecef.SetNumUninitialized(num);
+		UBatchConversions_BPFL::CalculateEcefXYZFromLatLonHeight(truth.X, truth.Y, truth.Z, ecef.X, ecef.Y, ecef.Z);
+
+		for (double& latitude : truth.X)
+		{
+			latitude = FMath::DegreesToRadians(latitude);
+		}
+		for (double& longitude : truth.Y)
+		{
+			longitude = FMath::DegreesToRadians(longitude);
+		}
+
+		FDISVectorArrayDouble solved;
+		solved.SetNumUninitialized(num);
+
+		//Generic lambda so each solver is inlined into its own timing loop
+		auto runSolver = [&](const TCHAR* Name, auto&& Solve)
+		{
+			FDISBenchmarkResult result(FString::Printf(TEXT("Geodetic.EcefToGeodeticSolvers.%s"), Name));
+			result.Operations = num;
+			result.Seconds = DISTimeSeconds([&]()
+			{
+				for (int32 i = 0; i < num; i++)
+				{
+					Solve(i);
+				}
+			});
+
+			FSolverErrors errors;
+			for (int32 i = 0; i < num; i++)
+			{
+				errors.Add(truth.X[i], truth.Y[i], truth.Z[i], solved.X[i], solved.Y[i], solved.Z[i]);
+			}
+			errors.AddMetrics(result);
+			Context.Results.Add(result);
+		};
+
+		runSolver(TEXT("Heikkinen"), [&](int32 i)
+		{
+			DISGeodetic::EcefToGeodeticHeikkinen(ecef.X[i], ecef.Y[i], ecef.Z[i], solved.X[i], solved.Y[i], solved.Z[i]);
+		});
+
+		runSolver(TEXT("Olson"), [&](int32 i)
+		{
+			DISGeodetic::EcefToGeodeticOlson(ecef.X[i], ecef.Y[i], ecef.Z[i], solved.X[i], solved.Y[i], solved.Z[i]);
+		});
+
+		if (IsValid(Context.GeoReferencingSystem))
+		{
+			//Only meaningful when the GeoReferencing System's geographic CRS is WGS84
+			runSolver(TEXT("GeoReferencingSystem"), [&](int32 i)
+			{
+				FGeographicCoordinates geographicCoordinates;
+				Context.GeoReferencingSystem->ECEFToGeographic(FCartesianCoordinates(ecef.X[i], ecef.Y[i], ecef.Z[i]), geographicCoordinates);
+				solved.X[i] = FMath::DegreesToRadians(geographicCoordinates.Latitude);
+				solved.Y[i] = FMath::DegreesToRadians(geographicCoordinates.Longitude);
+				solved.Z[i] = geographicCoordinates.Altitude;
+			});
+		}
+		else
+		{
+			UE_LOG(LogDISBenchmarks, Log, TEXT("Skipping Geodetic.EcefToGeodeticSolvers.GeoReferencingSystem, no GeoReferencing System in the world."));
+		}
+	}
+
+	FDISAutoRegisterBenchmark EcefToGeodeticSolversBenchmark(TEXT("Geodetic.EcefToGeodeticSolvers"), &BenchmarkEcefToGeodeticSolvers);
+}
+
+#endif
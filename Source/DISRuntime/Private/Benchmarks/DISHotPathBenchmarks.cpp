@@ -0,0 +1,514 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISBenchmarks.h"
+#include "DIS_BPFL.h"
+#include "DeadReckoning_BPFL.h"
+#include "PDUProcessor.h"
+#include "GeoReferencingSystem.h"
+#include "Engine/GameInstance.h"
+#include "PDUs/EntityInfoFamily/GRILL_EntityStatePDU.h"
+#include "PDUs/EntityInfoFamily/GRILL_EntityStateUpdatePDU.h"
+#include "PDUs/WarfareFamily/GRILL_FirePDU.h"
+#include "PDUs/WarfareFamily/GRILL_DetonationPDU.h"
+#include "PDUs/SimManagementFamily/GRILL_RemoveEntityPDU.h"
+#include "PDUs/SimManagementFamily/GRILL_StartResumePDU.h"
+#include "PDUs/SimManagementFamily/GRILL_StopFreezePDU.h"
+#include "PDUs/DistributedEmissionsFamily/GRILL_ElectromagneticEmissionsPDU.h"
+
+#if !UE_BUILD_SHIPPING
+namespace DISHotPathBenchmarks
+{
+	const EDeadReckoningAlgorithm AllAlgorithms[] =
+	{
+		EDeadReckoningAlgorithm::Other, EDeadReckoningAlgorithm::Static,
+		EDeadReckoningAlgorithm::FPW, EDeadReckoningAlgorithm::RPW, EDeadReckoningAlgorithm::RVW, EDeadReckoningAlgorithm::FVW,
+		EDeadReckoningAlgorithm::FPB, EDeadReckoningAlgorithm::RPB, EDeadReckoningAlgorithm::RVB, EDeadReckoningAlgorithm::FVB
+	};
+
+	FString GetAlgorithmName(EDeadReckoningAlgorithm Algorithm)
+	{
+		return StaticEnum<EDeadReckoningAlgorithm>()->GetNameStringByValue(static_cast<int64>(Algorithm));
+	}
+
+	FEntityID MakeEntityID(int32 Site, int32 Application, int32 Entity)
+	{
+		FEntityID entityID;
+		entityID.Site = Site;
+		entityID.Application = Application;
+		entityID.Entity = Entity;
+		return entityID;
+	}
+
+	FEntityType MakeEntityType(FRandomStream& RandomStream)
+	{
+		FEntityType entityType;
+		entityType.EntityKind = 1 + RandomStream.RandHelper(3);
+		entityType.Domain = 1 + RandomStream.RandHelper(4);
+		entityType.Country = 225;
+		entityType.Category = 1 + RandomStream.RandHelper(10);
+		entityType.Subcategory = 1 + RandomStream.RandHelper(10);
+		entityType.Specific = RandomStream.RandHelper(5);
+		entityType.Extra = 0;
+		return entityType;
+	}
+
+	/**
+	 * An Entity State PDU somewhere between 60 degrees north and south, moving, turning, and accelerating, with its other dead reckoning parameters formed for the algorithm.
+	 */
+	FEntityStatePDU MakeEntityStatePDU(FRandomStream& RandomStream, EDeadReckoningAlgorithm Algorithm, int32 NumArticulations)
+	{
+		FEarthCenteredEarthFixedDouble ecef;
+		UDIS_BPFL::CalculateEcefXYZFromLatLonHeight(FLatLonHeightDouble(RandomStream.FRandRange(-60.f, 60.f), RandomStream.FRandRange(-180.f, 180.f), RandomStream.FRandRange(0.f, 1000.f)), ecef);
+
+		FEntityStatePDU entityStatePDU;
+		entityStatePDU.ExerciseID = 1;
+		entityStatePDU.EntityID = MakeEntityID(1, 1, 1 + RandomStream.RandHelper(65534));
+		entityStatePDU.ForceID = EForceID::Friendly;
+		entityStatePDU.EntityType = MakeEntityType(RandomStream);
+		entityStatePDU.EntityLocationDouble[0] = ecef.X;
+		entityStatePDU.EntityLocationDouble[1] = ecef.Y;
+		entityStatePDU.EntityLocationDouble[2] = ecef.Z;
+		entityStatePDU.EntityLocation = FVector(ecef.X, ecef.Y, ecef.Z);
+		entityStatePDU.EntityOrientation = FRotator(RandomStream.FRandRange(-0.5f, 0.5f), RandomStream.FRandRange(-PI, PI), RandomStream.FRandRange(-0.5f, 0.5f));
+		entityStatePDU.EntityLinearVelocity = RandomStream.VRand() * RandomStream.FRandRange(0.f, 30.f);
+		entityStatePDU.Marking = TEXT("BENCHMARK");
+		entityStatePDU.DeadReckoningParameters.DeadReckoningAlgorithm = Algorithm;
+		entityStatePDU.DeadReckoningParameters.EntityLinearAcceleration = RandomStream.VRand() * RandomStream.FRandRange(0.f, 3.f);
+		entityStatePDU.DeadReckoningParameters.EntityAngularVelocity = RandomStream.VRand() * RandomStream.FRandRange(0.f, 0.3f);
+		entityStatePDU.DeadReckoningParameters.OtherParameters = UDeadReckoning_BPFL::FormOtherParameters(Algorithm, entityStatePDU.EntityOrientation, entityStatePDU.EntityLocation);
+
+		for (int32 i = 0; i < NumArticulations; i++)
+		{
+			FArticulationParameters articulation;
+			articulation.ParameterType = 4096 + i * 32 + 11;
+			articulation.ParameterValue = RandomStream.FRandRange(-PI, PI);
+			entityStatePDU.ArticulationParameters.Add(articulation);
+		}
+		return entityStatePDU;
+	}
+
+	FFirePDU MakeFirePDU(const FEntityStatePDU& Shooter)
+	{
+		FFirePDU firePDU;
+		firePDU.ExerciseID = 1;
+		firePDU.FiringEntityID = Shooter.EntityID;
+		firePDU.TargetEntityID = MakeEntityID(1, 1, 2);
+		firePDU.EventID.Site = 1;
+		firePDU.EventID.Application = 1;
+		firePDU.EventID.EventNumber = 1;
+		firePDU.LocationDouble = Shooter.EntityLocationDouble;
+		firePDU.Location = Shooter.EntityLocation;
+		firePDU.Velocity = FVector(0.f, 0.f, 800.f);
+		firePDU.Range = 2000.f;
+		firePDU.BurstDescriptor.Warhead = 1000;
+		firePDU.BurstDescriptor.Fuse = 1000;
+		firePDU.BurstDescriptor.Quantity = 1;
+		return firePDU;
+	}
+
+	FDetonationPDU MakeDetonationPDU(const FEntityStatePDU& Target)
+	{
+		FDetonationPDU detonationPDU;
+		detonationPDU.ExerciseID = 1;
+		detonationPDU.FiringEntityID = MakeEntityID(1, 1, 2);
+		detonationPDU.TargetEntityID = Target.EntityID;
+		detonationPDU.EventID.Site = 1;
+		detonationPDU.EventID.Application = 1;
+		detonationPDU.EventID.EventNumber = 1;
+		detonationPDU.LocationDouble = Target.EntityLocationDouble;
+		detonationPDU.Location = Target.EntityLocation;
+		detonationPDU.BurstDescriptor.Warhead = 1000;
+		detonationPDU.BurstDescriptor.Fuse = 1000;
+		detonationPDU.BurstDescriptor.Quantity = 1;
+		detonationPDU.DetonationResult = EDetonationResult::EntityImpact;
+		return detonationPDU;
+	}
+
+	/**
+	 * Every PDU struct the plugin encodes and decodes, filled in the way a typical exercise would fill them.
+	 */
+	struct FSamplePDUs
+	{
+		FEntityStatePDU EntityState;
+		FEntityStateUpdatePDU EntityStateUpdate;
+		FFirePDU Fire;
+		FDetonationPDU Detonation;
+		FRemoveEntityPDU RemoveEntity;
+		FStartResumePDU StartResume;
+		FStopFreezePDU StopFreeze;
+		FElectromagneticEmissionsPDU ElectromagneticEmissions;
+
+		FSamplePDUs()
+		{
+			FRandomStream randomStream(47);
+			EntityState = MakeEntityStatePDU(randomStream, EDeadReckoningAlgorithm::FPW, 4);
+			EntityStateUpdate = EntityState.ToEntityStateUpdatePDU();
+			Fire = MakeFirePDU(EntityState);
+			Detonation = MakeDetonationPDU(EntityState);
+
+			RemoveEntity.ExerciseID = 1;
+			RemoveEntity.OriginatingEntityID = MakeEntityID(1, 1, 0);
+			RemoveEntity.ReceivingEntityID = EntityState.EntityID;
+			RemoveEntity.RequestID = 1;
+
+			StartResume.ExerciseID = 1;
+			StartResume.OriginatingEntityID = MakeEntityID(1, 1, 0);
+			StartResume.ReceivingEntityID = MakeEntityID(65535, 65535, 65535);
+			StartResume.RequestID = 1;
+
+			StopFreeze.ExerciseID = 1;
+			StopFreeze.OriginatingEntityID = MakeEntityID(1, 1, 0);
+			StopFreeze.ReceivingEntityID = MakeEntityID(65535, 65535, 65535);
+			StopFreeze.RequestID = 1;
+
+			ElectromagneticEmissions.ExerciseID = 1;
+			ElectromagneticEmissions.EmittingEntityID = EntityState.EntityID;
+			ElectromagneticEmissions.EventID.Site = 1;
+			ElectromagneticEmissions.EventID.Application = 1;
+			ElectromagneticEmissions.EventID.EventNumber = 1;
+		}
+	};
+
+	template<typename PDUType>
+	void AddToBytesResult(FDISBenchmarkContext& Context, const TCHAR* Name, PDUType& PDU, int32 Num)
+	{
+		int64 totalBytes = 0;
+		FDISBenchmarkResult result(FString::Printf(TEXT("PDU.ToBytes.%s"), Name));
+		result.Operations = Num;
+		result.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < Num; i++)
+			{
+				totalBytes += PDU.ToBytes().Num();
+			}
+		});
+		result.AddMetric(TEXT("Bytes"), static_cast<double>(totalBytes) / Num);
+		Context.Results.Add(result);
+	}
+
+	/**
+	 * Times encoding every PDU struct to bytes through OpenDIS.
+	 */
+	void BenchmarkToBytes(FDISBenchmarkContext& Context)
+	{
+		const int32 num = Context.Scaled(100000);
+		FSamplePDUs samples;
+		AddToBytesResult(Context, TEXT("EntityState"), samples.EntityState, num);
+		AddToBytesResult(Context, TEXT("EntityStateUpdate"), samples.EntityStateUpdate, num);
+		AddToBytesResult(Context, TEXT("Fire"), samples.Fire, num);
+		AddToBytesResult(Context, TEXT("Detonation"), samples.Detonation, num);
+		AddToBytesResult(Context, TEXT("RemoveEntity"), samples.RemoveEntity, num);
+		AddToBytesResult(Context, TEXT("StartResume"), samples.StartResume, num);
+		AddToBytesResult(Context, TEXT("StopFreeze"), samples.StopFreeze, num);
+		AddToBytesResult(Context, TEXT("ElectromagneticEmissions"), samples.ElectromagneticEmissions, num);
+	}
+
+	/**
+	 * Times the PDU Processor decoding each PDU type into its struct and broadcasting it, and turning away a truncated datagram.
+	 * The processor belongs to a game instance of its own so nothing is bound to its events, leaving only decoding and the broadcast timed.
+	 */
+	void BenchmarkProcessPDU(FDISBenchmarkContext& Context)
+	{
+		const int32 num = Context.Scaled(100000);
+		FSamplePDUs samples;
+		const TPair<const TCHAR*, TArray<uint8>> encodedPDUs[] =
+		{
+			{ TEXT("EntityState"), samples.EntityState.ToBytes() },
+			{ TEXT("EntityStateUpdate"), samples.EntityStateUpdate.ToBytes() },
+			{ TEXT("Fire"), samples.Fire.ToBytes() },
+			{ TEXT("Detonation"), samples.Detonation.ToBytes() },
+			{ TEXT("RemoveEntity"), samples.RemoveEntity.ToBytes() },
+			{ TEXT("StartResume"), samples.StartResume.ToBytes() },
+			{ TEXT("StopFreeze"), samples.StopFreeze.ToBytes() },
+			{ TEXT("ElectromagneticEmissions"), samples.ElectromagneticEmissions.ToBytes() }
+		};
+
+		UGameInstance* gameInstance = NewObject<UGameInstance>(GetTransientPackage());
+		UPDUProcessor* pduProcessor = NewObject<UPDUProcessor>(gameInstance);
+
+		for (const TPair<const TCHAR*, TArray<uint8>>& encodedPDU : encodedPDUs)
+		{
+			FDISBenchmarkResult result(FString::Printf(TEXT("PDU.Process.%s"), encodedPDU.Key));
+			result.Operations = num;
+			result.Seconds = DISTimeSeconds([&]()
+			{
+				for (int32 i = 0; i < num; i++)
+				{
+					pduProcessor->ProcessDISPacket(encodedPDU.Value);
+				}
+			});
+			result.AddMetric(TEXT("Bytes"), encodedPDU.Value.Num());
+			result.AddMetric(TEXT("MegabytesPerSecond"), result.Seconds > 0 ? encodedPDU.Value.Num() * static_cast<double>(num) / (1024. * 1024. * result.Seconds) : 0);
+			Context.Results.Add(result);
+		}
+
+		//Datagrams cut short on the wire, which have to be turned away without ever reaching Open DIS
+		TArray<uint8> truncatedEntityState = encodedPDUs[0].Value;
+		truncatedEntityState.SetNum(truncatedEntityState.Num() / 2);
+		pduProcessor->ResetRejectedPacketCounts();
+		FDISBenchmarkResult truncatedResult(TEXT("PDU.Process.TruncatedEntityState"));
+		truncatedResult.Operations = num;
+		truncatedResult.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				pduProcessor->ProcessDISPacket(truncatedEntityState);
+			}
+		});
+		truncatedResult.AddMetric(TEXT("Rejected"), pduProcessor->GetRejectedPacketCounts().LengthMismatch);
+		Context.Results.Add(truncatedResult);
+	}
+
+	/**
+	 * Times dead reckoning Entity State PDUs a frame to a few seconds ahead, and forming their other parameters, with every algorithm.
+	 */
+	void BenchmarkDeadReckoning(FDISBenchmarkContext& Context)
+	{
+		const int32 num = Context.Scaled(100000);
+		FRandomStream randomStream(47);
+		TArray<float> deltaTimes;
+		deltaTimes.SetNumUninitialized(num);
+		for (int32 i = 0; i < num; i++)
+		{
+			deltaTimes[i] = randomStream.FRandRange(1.f / 120.f, 5.f);
+		}
+
+		for (const EDeadReckoningAlgorithm algorithm : AllAlgorithms)
+		{
+			TArray<FEntityStatePDU> entityStatePDUs;
+			entityStatePDUs.Reserve(num);
+			for (int32 i = 0; i < num; i++)
+			{
+				entityStatePDUs.Add(MakeEntityStatePDU(randomStream, algorithm, 0));
+			}
+
+			int64 numDeadReckoned = 0;
+			FEntityStatePDU deadReckonedPDU;
+			FDISBenchmarkResult deadReckoningResult(FString::Printf(TEXT("DeadReckoning.%s"), *GetAlgorithmName(algorithm)));
+			deadReckoningResult.Operations = num;
+			deadReckoningResult.Seconds = DISTimeSeconds([&]()
+			{
+				for (int32 i = 0; i < num; i++)
+				{
+					numDeadReckoned += UDeadReckoning_BPFL::DeadReckoning(entityStatePDUs[i], deltaTimes[i], deadReckonedPDU) ? 1 : 0;
+				}
+			});
+			deadReckoningResult.AddMetric(TEXT("DeadReckonedShare"), static_cast<double>(numDeadReckoned) / num);
+			Context.Results.Add(deadReckoningResult);
+
+			int64 otherParameterBytes = 0;
+			FDISBenchmarkResult otherParametersResult(FString::Printf(TEXT("DeadReckoning.FormOtherParameters.%s"), *GetAlgorithmName(algorithm)));
+			otherParametersResult.Operations = num;
+			otherParametersResult.Seconds = DISTimeSeconds([&]()
+			{
+				for (int32 i = 0; i < num; i++)
+				{
+					otherParameterBytes += UDeadReckoning_BPFL::FormOtherParameters(algorithm, entityStatePDUs[i].EntityOrientation, entityStatePDUs[i].EntityLocation).Num();
+				}
+			});
+			otherParametersResult.AddMetric(TEXT("Bytes"), static_cast<double>(otherParameterBytes) / num);
+			Context.Results.Add(otherParametersResult);
+		}
+	}
+
+	/**
+	 * Times the DIS Blueprint Function Library conversions the receive and send components run for every entity that the Geodetic benchmarks do not already cover.
+	 * Conversions to and from Unreal coordinates are skipped without a GeoReferencing System.
+	 */
+	void BenchmarkConversions(FDISBenchmarkContext& Context)
+	{
+		const int32 num = Context.Scaled(100000);
+		FRandomStream randomStream(47);
+		TArray<FEntityStatePDU> entityStatePDUs;
+		TArray<FLatLonHeightFloat> latLonHeights;
+		TArray<FPsiThetaPhi> psiThetaPhis;
+		entityStatePDUs.Reserve(num);
+		latLonHeights.SetNum(num);
+		psiThetaPhis.SetNum(num);
+		for (int32 i = 0; i < num; i++)
+		{
+			entityStatePDUs.Add(MakeEntityStatePDU(randomStream, EDeadReckoningAlgorithm::FPW, 0));
+			const FEntityStatePDU& entityStatePDU = entityStatePDUs.Last();
+			UDIS_BPFL::CalculateLatLonHeightFromEcefXYZ(FEarthCenteredEarthFixedFloat(entityStatePDU.EntityLocation.X, entityStatePDU.EntityLocation.Y, entityStatePDU.EntityLocation.Z), latLonHeights[i]);
+			psiThetaPhis[i].Psi = entityStatePDU.EntityOrientation.Yaw;
+			psiThetaPhis[i].Theta = entityStatePDU.EntityOrientation.Pitch;
+			psiThetaPhis[i].Phi = entityStatePDU.EntityOrientation.Roll;
+		}
+
+		TArray<FLatLonHeightFloat> outLatLonHeights;
+		TArray<FNorthEastDown> outNorthEastDowns;
+		TArray<FHeadingPitchRoll> outHeadingPitchRolls;
+		outLatLonHeights.SetNum(num);
+		outNorthEastDowns.SetNum(num);
+		outHeadingPitchRolls.SetNum(num);
+
+		FDISBenchmarkResult latLonHeightResult(TEXT("Conversions.LatLonHeightFromEcefFloat"));
+		latLonHeightResult.Operations = num;
+		latLonHeightResult.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				const FVector& location = entityStatePDUs[i].EntityLocation;
+				UDIS_BPFL::CalculateLatLonHeightFromEcefXYZ(FEarthCenteredEarthFixedFloat(location.X, location.Y, location.Z), outLatLonHeights[i]);
+			}
+		});
+		Context.Results.Add(latLonHeightResult);
+
+		FDISBenchmarkResult northEastDownResult(TEXT("Conversions.NorthEastDownFromLatLon"));
+		northEastDownResult.Operations = num;
+		northEastDownResult.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				UDIS_BPFL::CalculateNorthEastDownVectorsFromLatLon(latLonHeights[i].Latitude, latLonHeights[i].Longitude, outNorthEastDowns[i]);
+			}
+		});
+		Context.Results.Add(northEastDownResult);
+
+		FDISBenchmarkResult headingPitchRollResult(TEXT("Conversions.HeadingPitchRollFromPsiThetaPhi"));
+		headingPitchRollResult.Operations = num;
+		headingPitchRollResult.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				UDIS_BPFL::CalculateHeadingPitchRollDegreesFromPsiThetaPhiRadiansAtLatLon(psiThetaPhis[i], latLonHeights[i].Latitude, latLonHeights[i].Longitude, outHeadingPitchRolls[i]);
+			}
+		});
+		Context.Results.Add(headingPitchRollResult);
+
+		AGeoReferencingSystem* geoReferencingSystem = Context.GeoReferencingSystem;
+		if (!IsValid(geoReferencingSystem))
+		{
+			UE_LOG(LogDISBenchmarks, Log, TEXT("Skipping the Unreal coordinate conversions, no GeoReferencing System in the world."));
+			return;
+		}
+
+		TArray<FVector> unrealLocations;
+		TArray<FRotator> unrealRotations;
+		unrealLocations.SetNumUninitialized(num);
+		unrealRotations.SetNumUninitialized(num);
+
+		FDISBenchmarkResult fromEntityStateResult(TEXT("Conversions.UnrealFromEntityState"));
+		fromEntityStateResult.Operations = num;
+		fromEntityStateResult.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				UDIS_BPFL::GetUnrealLocationAndOrientationFromEntityStatePdu(entityStatePDUs[i], geoReferencingSystem, unrealLocations[i], unrealRotations[i]);
+			}
+		});
+		Context.Results.Add(fromEntityStateResult);
+
+		TArray<FEarthCenteredEarthFixedFloat> outEcefs;
+		outEcefs.SetNum(num);
+		TArray<FPsiThetaPhi> outPsiThetaPhis;
+		outPsiThetaPhis.SetNum(num);
+
+		FDISBenchmarkResult toEntityStateResult(TEXT("Conversions.EcefAndPsiThetaPhiFromUnreal"));
+		toEntityStateResult.Operations = num;
+		toEntityStateResult.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				UDIS_BPFL::GetEcefXYZAndPsiThetaPhiRadiansFromUnreal(unrealRotations[i], unrealLocations[i], geoReferencingSystem, outEcefs[i], outPsiThetaPhis[i]);
+			}
+		});
+		Context.Results.Add(toEntityStateResult);
+	}
+
+	template<typename KeyType>
+	void AddKeyResults(FDISBenchmarkContext& Context, const TCHAR* Name, const TArray<KeyType>& Keys, const TArray<KeyType>& Queries)
+	{
+		TMap<KeyType, int32> map;
+		for (int32 i = 0; i < Keys.Num(); i++)
+		{
+			map.Add(Keys[i], i);
+		}
+
+		TArray<uint32> hashes;
+		hashes.SetNumUninitialized(Queries.Num());
+		FDISBenchmarkResult hashResult(FString::Printf(TEXT("EntityKeys.%sHash"), Name));
+		hashResult.Operations = Queries.Num();
+		hashResult.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < Queries.Num(); i++)
+			{
+				hashes[i] = GetTypeHash(Queries[i]);
+			}
+		});
+
+		//Distinct keys sharing a hash end up in the same bucket chain
+		TSet<uint32> distinctHashes;
+		for (const KeyType& key : Keys)
+		{
+			distinctHashes.Add(GetTypeHash(key));
+		}
+		hashResult.AddMetric(TEXT("Keys"), Keys.Num());
+		hashResult.AddMetric(TEXT("HashCollisions"), Keys.Num() - distinctHashes.Num());
+		Context.Results.Add(hashResult);
+
+		int64 numFound = 0;
+		FDISBenchmarkResult findResult(FString::Printf(TEXT("EntityKeys.%sFind"), Name));
+		findResult.Operations = Queries.Num();
+		findResult.Seconds = DISTimeSeconds([&]()
+		{
+			for (const KeyType& query : Queries)
+			{
+				numFound += map.Find(query) != nullptr ? 1 : 0;
+			}
+		});
+		findResult.AddMetric(TEXT("HitRate"), static_cast<double>(numFound) / FMath::Max(1, Queries.Num()));
+		Context.Results.Add(findResult);
+	}
+
+	/**
+	 * Times hashing entity IDs and entity types and looking them up in maps the size of a large exercise, as the Game Manager does for every PDU received.
+	 * One in ten lookups is for a key that is not in the map.
+	 */
+	void BenchmarkEntityKeys(FDISBenchmarkContext& Context)
+	{
+		const int32 numEntities = Context.Scaled(10000);
+		const int32 numQueries = Context.Scaled(1000000);
+		FRandomStream randomStream(47);
+
+		TSet<FEntityID> entityIDSet;
+		while (entityIDSet.Num() < numEntities)
+		{
+			entityIDSet.Add(MakeEntityID(1 + randomStream.RandHelper(10), 1 + randomStream.RandHelper(100), 1 + randomStream.RandHelper(65534)));
+		}
+		const TArray<FEntityID> entityIDs = entityIDSet.Array();
+
+		TSet<FEntityType> entityTypeSet;
+		for (int32 i = 0; i < 2000; i++)
+		{
+			entityTypeSet.Add(MakeEntityType(randomStream));
+		}
+		const TArray<FEntityType> entityTypes = entityTypeSet.Array();
+
+		TArray<FEntityID> entityIDQueries;
+		TArray<FEntityType> entityTypeQueries;
+		entityIDQueries.SetNum(numQueries);
+		entityTypeQueries.SetNum(numQueries);
+		for (int32 i = 0; i < numQueries; i++)
+		{
+			const bool miss = randomStream.RandHelper(10) == 0;
+			entityIDQueries[i] = miss ? MakeEntityID(11 + randomStream.RandHelper(10), 1, 1) : entityIDs[randomStream.RandHelper(entityIDs.Num())];
+			entityTypeQueries[i] = entityTypes[randomStream.RandHelper(entityTypes.Num())];
+			if (miss)
+			{
+				entityTypeQueries[i].Extra = 1;
+			}
+		}
+
+		AddKeyResults(Context, TEXT("EntityID"), entityIDs, entityIDQueries);
+		AddKeyResults(Context, TEXT("EntityType"), entityTypes, entityTypeQueries);
+	}
+
+	FDISAutoRegisterBenchmark ToBytesBenchmark(TEXT("PDU.ToBytes"), &BenchmarkToBytes);
+	FDISAutoRegisterBenchmark ProcessPDUBenchmark(TEXT("PDU.Process"), &BenchmarkProcessPDU);
+	FDISAutoRegisterBenchmark DeadReckoningBenchmark(TEXT("DeadReckoning.Algorithms"), &BenchmarkDeadReckoning);
+	FDISAutoRegisterBenchmark ConversionsBenchmark(TEXT("Conversions.BPFL"), &BenchmarkConversions);
+	FDISAutoRegisterBenchmark EntityKeysBenchmark(TEXT("EntityKeys.Lookup"), &BenchmarkEntityKeys);
+}
+
+#endif
@@ -0,0 +1,218 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISBenchmarks.h"
+#include "BatchConversions_BPFL.h"
+#include "DIS_BPFL.h"
+#include "DISGeoTransformCache.h"
+#include "DISQuaternionConversions.h"
+#include "GeoReferencingSystem.h"
+
+#if !UE_BUILD_SHIPPING
+namespace DISQuaternionBenchmarks
+{
+	/**
+	 * Ground truth Unreal rotation built by rotating the DIS body axes into North, East, Down at the entity location
+	 * and expressing them in the engine frame with the GeoReferencing System's own North, East, Down vectors.
+	 */
+	FQuat ReferenceUnrealQuat(AGeoReferencingSystem* GeoReferencingSystem, const FEarthCenteredEarthFixedDouble& Ecef, const double Psi, const double Theta, const double Phi)
+	{
+		FLatLonHeightDouble latLonHeight;
+		UDIS_BPFL::CalculateLatLonHeightFromEcefXYZ(Ecef, latLonHeight);
+		const glm::dmat3 ecefNorthEastDown = DISQuaternion::EcefNorthEastDown(FMath::DegreesToRadians(latLonHeight.Latitude), FMath::DegreesToRadians(latLonHeight.Longitude));
+		const glm::dmat3 bodyInNorthEastDown = glm::transpose(ecefNorthEastDown) * glm::mat3_cast(DISQuaternion::FromPsiThetaPhiRadians(Psi, Theta, Phi));
+
+		FVector east, north, up;
+		GeoReferencingSystem->GetENUVectorsAtECEFLocation(FCartesianCoordinates(Ecef.X, Ecef.Y, Ecef.Z), east, north, up);
+
+		auto toEngine = [&](const glm::dvec3& NorthEastDown)
+		{
+			return (north * NorthEastDown.x + east * NorthEastDown.y - up * NorthEastDown.z).GetSafeNormal();
+		};
+
+		//Actor Z is up, DIS body Z is down
+		return FMatrix(toEngine(bodyInNorthEastDown[0]), toEngine(bodyInNorthEastDown[1]), -toEngine(bodyInNorthEastDown[2]), FVector::ZeroVector).ToQuat();
+	}
+
+	struct FAngularErrors
+	{
+		double MaxDegrees = 0;
+		double SumDegrees = 0;
+		int32 Count = 0;
+
+		void Add(const FQuat& A, const FQuat& B)
+		{
+			const double errorDegrees = FMath::RadiansToDegrees(A.AngularDistance(B));
+			MaxDegrees = FMath::Max(MaxDegrees, errorDegrees);
+			SumDegrees += errorDegrees;
+			Count++;
+		}
+
+		void AddMetrics(FDISBenchmarkResult& Result) const
+		{
+			Result.AddMetric(TEXT("MaxAngularErrorDegrees"), MaxDegrees);
+			Result.AddMetric(TEXT("MeanAngularErrorDegrees"), SumDegrees / FMath::Max(1, Count));
+		}
+	};
+
+	/**
+	 * Times the heading, pitch, roll orientation path against the quaternion path in both directions and reports the angular error of each against
+	 * a ground truth built from the GeoReferencing System. Entities are spread over a 100 km wide area around the engine origin with random orientations.
+	 */
+	void BenchmarkQuaternionOrientation(FDISBenchmarkContext& Context)
+	{
+		AGeoReferencingSystem* geoReferencingSystem = Context.GeoReferencingSystem;
+		if (!IsValid(geoReferencingSystem))
+		{
+			UE_LOG(LogDISBenchmarks, Log, TEXT("Skipping Geodetic.QuaternionOrientation, no GeoReferencing System in the world."));
+			return;
+		}
+
+		const int32 num = Context.Scaled(20000);
+		FRandomStream randomStream(3141);
+
+		TArray<FVector> unrealLocations;
+		FDISVectorArrayDouble ecef, psiThetaPhi;
+		TArray<FLatLonHeightDouble> latLonHeights;
+		unrealLocations.SetNumUninitialized(num);
+		ecef.SetNumUninitialized(num);
+		psiThetaPhi.SetNumUninitialized(num);
+		latLonHeights.SetNumUninitialized(num);
+		for (int32 i = 0; i < num; i++)
+		{
+			unrealLocations[i] = FVector(randomStream.FRandRange(-5000000.f, 5000000.f), randomStream.FRandRange(-5000000.f, 5000000.f), randomStream.FRandRange(-10000.f, 1000000.f));
+
+			FEarthCenteredEarthFixedDouble entityEcef;
+			FDISGeoTransformCache::EngineToEcef(geoReferencingSystem, unrealLocations[i], entityEcef);
+			ecef.X[i] = entityEcef.X;
+			ecef.Y[i] = entityEcef.Y;
+			ecef.Z[i] = entityEcef.Z;
+			UDIS_BPFL::CalculateLatLonHeightFromEcefXYZ(entityEcef, latLonHeights[i]);
+
+			psiThetaPhi.X[i] = randomStream.FRandRange(-PI, PI);
+			psiThetaPhi.Y[i] = randomStream.FRandRange(-HALF_PI * 0.95f, HALF_PI * 0.95f);
+			psiThetaPhi.Z[i] = randomStream.FRandRange(-PI, PI);
+		}
+
+		TArray<FQuat> reference;
+		reference.SetNumUninitialized(num);
+		for (int32 i = 0; i < num; i++)
+		{
+			reference[i] = ReferenceUnrealQuat(geoReferencingSystem, FEarthCenteredEarthFixedDouble(ecef.X[i], ecef.Y[i], ecef.Z[i]), psiThetaPhi.X[i], psiThetaPhi.Y[i], psiThetaPhi.Z[i]);
+		}
+
+		//DIS to Unreal
+		TArray<FRotator> headingPitchRollRotators;
+		headingPitchRollRotators.SetNumUninitialized(num);
+		FDISBenchmarkResult headingPitchRollToUnreal(TEXT("Geodetic.QuaternionOrientation.ToUnreal.HeadingPitchRoll"));
+		headingPitchRollToUnreal.Operations = num;
+		headingPitchRollToUnreal.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				UDIS_BPFL::GetUnrealRotationFromPsiThetaPhiRadiansAtLatLon(FPsiThetaPhi(psiThetaPhi.X[i], psiThetaPhi.Y[i], psiThetaPhi.Z[i]), latLonHeights[i].Latitude, latLonHeights[i].Longitude,
+					geoReferencingSystem, headingPitchRollRotators[i]);
+			}
+		});
+
+		TArray<FQuat> quaternions;
+		quaternions.SetNumUninitialized(num);
+		FDISBenchmarkResult quaternionToUnreal(TEXT("Geodetic.QuaternionOrientation.ToUnreal.Quaternion"));
+		quaternionToUnreal.Operations = num;
+		quaternionToUnreal.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				UDIS_BPFL::GetUnrealQuatFromPsiThetaPhiRadiansAtEcef(FPsiThetaPhi(psiThetaPhi.X[i], psiThetaPhi.Y[i], psiThetaPhi.Z[i]), FEarthCenteredEarthFixedDouble(ecef.X[i], ecef.Y[i], ecef.Z[i]),
+					geoReferencingSystem, quaternions[i]);
+			}
+		});
+
+		TArray<FQuat> batchQuaternions;
+		batchQuaternions.SetNumUninitialized(num);
+		FDISBenchmarkResult batchQuaternionToUnreal(TEXT("Geodetic.QuaternionOrientation.ToUnreal.QuaternionBatch"));
+		batchQuaternionToUnreal.Operations = num;
+		batchQuaternionToUnreal.Seconds = DISTimeSeconds([&]()
+		{
+			UBatchConversions_BPFL::GetUnrealQuatsFromPsiThetaPhiRadiansAtEcef(psiThetaPhi.X, psiThetaPhi.Y, psiThetaPhi.Z, ecef.X, ecef.Y, ecef.Z, geoReferencingSystem, batchQuaternions);
+		});
+
+		FAngularErrors headingPitchRollErrors, quaternionErrors, batchQuaternionErrors;
+		for (int32 i = 0; i < num; i++)
+		{
+			headingPitchRollErrors.Add(reference[i], headingPitchRollRotators[i].Quaternion());
+			quaternionErrors.Add(reference[i], quaternions[i]);
+			batchQuaternionErrors.Add(reference[i], batchQuaternions[i]);
+		}
+		headingPitchRollErrors.AddMetrics(headingPitchRollToUnreal);
+		quaternionErrors.AddMetrics(quaternionToUnreal);
+		quaternionToUnreal.AddMetric(TEXT("SpeedupVsHeadingPitchRoll"), headingPitchRollToUnreal.Seconds / FMath::Max(quaternionToUnreal.Seconds, SMALL_NUMBER));
+		batchQuaternionErrors.AddMetrics(batchQuaternionToUnreal);
+		batchQuaternionToUnreal.AddMetric(TEXT("SpeedupVsHeadingPitchRoll"), headingPitchRollToUnreal.Seconds / FMath::Max(batchQuaternionToUnreal.Seconds, SMALL_NUMBER));
+
+		//Unreal to DIS, starting from the ground truth rotations. Errors compare the recovered body rotation with the original.
+		TArray<FPsiThetaPhi> headingPitchRollPsiThetaPhi;
+		headingPitchRollPsiThetaPhi.SetNumUninitialized(num);
+		FDISBenchmarkResult headingPitchRollFromUnreal(TEXT("Geodetic.QuaternionOrientation.FromUnreal.HeadingPitchRoll"));
+		headingPitchRollFromUnreal.Operations = num;
+		headingPitchRollFromUnreal.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				FHeadingPitchRoll headingPitchRollDegrees;
+				UDIS_BPFL::GetHeadingPitchRollFromUnrealRotation(reference[i].Rotator(), unrealLocations[i], geoReferencingSystem, headingPitchRollDegrees);
+				UDIS_BPFL::CalculatePsiThetaPhiRadiansFromHeadingPitchRollDegreesAtLatLon(headingPitchRollDegrees, latLonHeights[i].Latitude, latLonHeights[i].Longitude, headingPitchRollPsiThetaPhi[i]);
+			}
+		});
+
+		TArray<FPsiThetaPhi> quaternionPsiThetaPhi;
+		quaternionPsiThetaPhi.SetNumUninitialized(num);
+		FDISBenchmarkResult quaternionFromUnreal(TEXT("Geodetic.QuaternionOrientation.FromUnreal.Quaternion"));
+		quaternionFromUnreal.Operations = num;
+		quaternionFromUnreal.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 i = 0; i < num; i++)
+			{
+				UDIS_BPFL::GetPsiThetaPhiRadiansFromUnrealQuatAtEcef(reference[i], FEarthCenteredEarthFixedDouble(ecef.X[i], ecef.Y[i], ecef.Z[i]), geoReferencingSystem, quaternionPsiThetaPhi[i]);
+			}
+		});
+
+		FDISVectorArrayDouble batchPsiThetaPhi;
+		batchPsiThetaPhi.SetNumUninitialized(num);
+		FDISBenchmarkResult batchQuaternionFromUnreal(TEXT("Geodetic.QuaternionOrientation.FromUnreal.QuaternionBatch"));
+		batchQuaternionFromUnreal.Operations = num;
+		batchQuaternionFromUnreal.Seconds = DISTimeSeconds([&]()
+		{
+			UBatchConversions_BPFL::GetPsiThetaPhiRadiansFromUnrealQuatsAtEcef(reference, ecef.X, ecef.Y, ecef.Z, geoReferencingSystem, batchPsiThetaPhi.X, batchPsiThetaPhi.Y, batchPsiThetaPhi.Z);
+		});
+
+		auto toUnrealQuat = [](const glm::dquat& Rotation)
+		{
+			return FQuat(Rotation.x, Rotation.y, Rotation.z, Rotation.w);
+		};
+
+		FAngularErrors headingPitchRollRoundTrip, quaternionRoundTrip, batchQuaternionRoundTrip;
+		for (int32 i = 0; i < num; i++)
+		{
+			const FQuat body = toUnrealQuat(DISQuaternion::FromPsiThetaPhiRadians(psiThetaPhi.X[i], psiThetaPhi.Y[i], psiThetaPhi.Z[i]));
+			headingPitchRollRoundTrip.Add(body, toUnrealQuat(DISQuaternion::FromPsiThetaPhiRadians(headingPitchRollPsiThetaPhi[i].Psi, headingPitchRollPsiThetaPhi[i].Theta, headingPitchRollPsiThetaPhi[i].Phi)));
+			quaternionRoundTrip.Add(body, toUnrealQuat(DISQuaternion::FromPsiThetaPhiRadians(quaternionPsiThetaPhi[i].Psi, quaternionPsiThetaPhi[i].Theta, quaternionPsiThetaPhi[i].Phi)));
+			batchQuaternionRoundTrip.Add(body, toUnrealQuat(DISQuaternion::FromPsiThetaPhiRadians(batchPsiThetaPhi.X[i], batchPsiThetaPhi.Y[i], batchPsiThetaPhi.Z[i])));
+		}
+		headingPitchRollRoundTrip.AddMetrics(headingPitchRollFromUnreal);
+		quaternionRoundTrip.AddMetrics(quaternionFromUnreal);
+		quaternionFromUnreal.AddMetric(TEXT("SpeedupVsHeadingPitchRoll"), headingPitchRollFromUnreal.Seconds / FMath::Max(quaternionFromUnreal.Seconds, SMALL_NUMBER));
+		batchQuaternionRoundTrip.AddMetrics(batchQuaternionFromUnreal);
+		batchQuaternionFromUnreal.AddMetric(TEXT("SpeedupVsHeadingPitchRoll"), headingPitchRollFromUnreal.Seconds / FMath::Max(batchQuaternionFromUnreal.Seconds, SMALL_NUMBER));
+
+		Context.Results.Add(headingPitchRollToUnreal);
+		Context.Results.Add(quaternionToUnreal);
+		Context.Results.Add(batchQuaternionToUnreal);
+		Context.Results.Add(headingPitchRollFromUnreal);
+		Context.Results.Add(quaternionFromUnreal);
+		Context.Results.Add(batchQuaternionFromUnreal);
+	}
+
+	FDISAutoRegisterBenchmark QuaternionOrientationBenchmark(TEXT("Geodetic.QuaternionOrientation"), &BenchmarkQuaternionOrientation);
+}
+
+#endif
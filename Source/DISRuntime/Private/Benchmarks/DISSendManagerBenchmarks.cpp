@@ -0,0 +1,351 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISBenchmarks.h"
+#include "DISSendManager.h"
+#include "DISSendComponent.h"
+#include "DIS_BPFL.h"
+#include "DeadReckoning_BPFL.h"
+#include "DISGeoTransformCache.h"
+#include "GeoReferencingSystem.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "Components/SceneComponent.h"
+
+#if !UE_BUILD_SHIPPING
+namespace DISSendManagerBenchmarks
+{
+	/**
+	 * The threshold test a send component runs on its own tick, see UDISSendComponent::CheckDeadReckoningThreshold. Converts from scratch as if there were no kinematic snapshot to share.
+	 */
+	bool PerComponentThreshold(const FEntityStatePDU& SentPDU, const float DeltaTime, const FVector& UnrealLocation, const FRotator& UnrealRotation,
+		const float PositionThresholdMeters, const float OrientationThresholdDegrees, AGeoReferencingSystem* GeoReferencingSystem)
+	{
+		FEntityStatePDU deadReckonedPDU;
+		if (!UDeadReckoning_BPFL::DeadReckoning(SentPDU, DeltaTime, deadReckonedPDU))
+		{
+			return false;
+		}
+
+		FEarthCenteredEarthFixedFloat ecefLocation;
+		UDIS_BPFL::GetEcefXYZFromUnrealLocation(UnrealLocation, GeoReferencingSystem, ecefLocation);
+		if (FMath::Abs(ecefLocation.X - deadReckonedPDU.EntityLocationDouble[0]) > PositionThresholdMeters
+			|| FMath::Abs(ecefLocation.Y - deadReckonedPDU.EntityLocationDouble[1]) > PositionThresholdMeters
+			|| FMath::Abs(ecefLocation.Z - deadReckonedPDU.EntityLocationDouble[2]) > PositionThresholdMeters)
+		{
+			return true;
+		}
+
+		const FVector& angularVelocity = SentPDU.DeadReckoningParameters.EntityAngularVelocity;
+		const FQuat deadReckonedOrientation = UDeadReckoning_BPFL::GetEntityOrientationQuaternion(SentPDU.EntityOrientation.Yaw, SentPDU.EntityOrientation.Pitch, SentPDU.EntityOrientation.Roll)
+			* UDeadReckoning_BPFL::CreateDeadReckoningQuaternion(glm::dvec3(angularVelocity.X, angularVelocity.Y, angularVelocity.Z), DeltaTime);
+
+		FLatLonHeightFloat latLonHeightMeters;
+		FHeadingPitchRoll headingPitchRollDegrees;
+		FPsiThetaPhi psiThetaPhiRadians;
+		UDIS_BPFL::GetLatLonHeightFromUnrealLocation(UnrealLocation, GeoReferencingSystem, latLonHeightMeters);
+		UDIS_BPFL::GetHeadingPitchRollFromUnrealRotation(UnrealRotation, UnrealLocation, GeoReferencingSystem, headingPitchRollDegrees);
+		UDIS_BPFL::CalculatePsiThetaPhiRadiansFromHeadingPitchRollDegreesAtLatLon(headingPitchRollDegrees, latLonHeightMeters.Latitude, latLonHeightMeters.Longitude, psiThetaPhiRadians);
+		const FQuat actualOrientation = UDeadReckoning_BPFL::GetEntityOrientationQuaternion(psiThetaPhiRadians.Psi, psiThetaPhiRadians.Theta, psiThetaPhiRadians.Phi);
+
+		const double orientationThresholdEpsilon = 1 - FMath::Cos(FMath::DegreesToRadians(OrientationThresholdDegrees / 2));
+		return (1 - (actualOrientation | deadReckonedOrientation)) > orientationThresholdEpsilon;
+	}
+
+	/**
+	 * Times one frame of dead reckoning threshold tests for 5,000 local entities, once the way each send component does it on its own tick
+	 * and once as the send manager's batched pass. Entities use the world dead reckoning algorithms, are spread over a 100 km wide area,
+	 * and have drifted from their last sent state by enough that roughly half are due.
+	 * DecisionMismatches counts entities where the two disagree, which should only happen right at a threshold.
+	 */
+	void BenchmarkSendManager(FDISBenchmarkContext& Context)
+	{
+		AGeoReferencingSystem* geoReferencingSystem = Context.GeoReferencingSystem;
+		if (!IsValid(geoReferencingSystem))
+		{
+			UE_LOG(LogDISBenchmarks, Log, TEXT("Skipping Send.Manager, no GeoReferencing System in the world."));
+			return;
+		}
+
+		const int32 num = Context.Scaled(5000);
+		const int32 numFrames = 10;
+		const EDeadReckoningAlgorithm algorithms[] = { EDeadReckoningAlgorithm::Static, EDeadReckoningAlgorithm::FPW, EDeadReckoningAlgorithm::RPW, EDeadReckoningAlgorithm::FVW, EDeadReckoningAlgorithm::RVW };
+		FRandomStream randomStream(5000);
+
+		TArray<FEntityStatePDU> sentPDUs;
+		TArray<FVector> unrealLocations;
+		TArray<FRotator> unrealRotations;
+		TArray<float> deltaTimes;
+		sentPDUs.SetNum(num);
+		unrealLocations.SetNumUninitialized(num);
+		unrealRotations.SetNumUninitialized(num);
+		deltaTimes.SetNumUninitialized(num);
+		const float positionThresholdMeters = 1.f;
+		const float orientationThresholdDegrees = 3.f;
+
+		for (int32 i = 0; i < num; i++)
+		{
+			const FVector sentLocation(randomStream.FRandRange(-5000000.f, 5000000.f), randomStream.FRandRange(-5000000.f, 5000000.f), randomStream.FRandRange(0.f, 500000.f));
+			const FRotator sentRotation(randomStream.FRandRange(-60.f, 60.f), randomStream.FRandRange(-180.f, 180.f), randomStream.FRandRange(-60.f, 60.f));
+			//Unreal units per second
+			const FVector unrealVelocity = randomStream.VRand() * randomStream.FRandRange(0.f, 3000.f);
+
+			FEntityStatePDU& sentPDU = sentPDUs[i];
+			sentPDU.DeadReckoningParameters.DeadReckoningAlgorithm = algorithms[i % UE_ARRAY_COUNT(algorithms)];
+
+			FEarthCenteredEarthFixedDouble sentEcef, movedEcef;
+			FDISGeoTransformCache::EngineToEcef(geoReferencingSystem, sentLocation, sentEcef);
+			FDISGeoTransformCache::EngineToEcef(geoReferencingSystem, sentLocation + unrealVelocity, movedEcef);
+			sentPDU.EntityLocationDouble = { sentEcef.X, sentEcef.Y, sentEcef.Z };
+			sentPDU.EntityLocation = FVector(sentEcef.X, sentEcef.Y, sentEcef.Z);
+			sentPDU.EntityLinearVelocity = FVector(movedEcef.X - sentEcef.X, movedEcef.Y - sentEcef.Y, movedEcef.Z - sentEcef.Z);
+
+			FPsiThetaPhi psiThetaPhiRadians;
+			UDIS_BPFL::GetPsiThetaPhiRadiansFromUnrealRotation(sentRotation, sentLocation, geoReferencingSystem, psiThetaPhiRadians);
+			sentPDU.EntityOrientation = FRotator(psiThetaPhiRadians.Theta, psiThetaPhiRadians.Psi, psiThetaPhiRadians.Phi);
+
+			//Drift away from the dead reckoned state by up to a few times the thresholds
+			deltaTimes[i] = randomStream.FRandRange(0.f, 3.f);
+			unrealLocations[i] = sentLocation + unrealVelocity * deltaTimes[i] + randomStream.VRand() * randomStream.FRandRange(0.f, 200.f);
+			unrealRotations[i] = sentRotation + FRotator(0, randomStream.FRandRange(-4.f, 4.f), 0);
+		}
+
+		TArray<bool> perComponentDecisions;
+		perComponentDecisions.SetNumUninitialized(num);
+		FDISBenchmarkResult perComponent(TEXT("Send.Manager.PerComponent"));
+		perComponent.Operations = static_cast<int64>(num) * numFrames;
+		perComponent.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 frame = 0; frame < numFrames; frame++)
+			{
+				for (int32 i = 0; i < num; i++)
+				{
+					perComponentDecisions[i] = PerComponentThreshold(sentPDUs[i], deltaTimes[i], unrealLocations[i], unrealRotations[i], positionThresholdMeters, orientationThresholdDegrees, geoReferencingSystem);
+				}
+			}
+		});
+
+		//Includes gathering into the structure of arrays, which the manager does every frame
+		FDISSendThresholdBatch batch;
+		FDISBenchmarkResult batched(TEXT("Send.Manager.Batched"));
+		batched.Operations = static_cast<int64>(num) * numFrames;
+		batched.Seconds = DISTimeSeconds([&]()
+		{
+			for (int32 frame = 0; frame < numFrames; frame++)
+			{
+				batch.SetNumUninitialized(num);
+				for (int32 i = 0; i < num; i++)
+				{
+					batch.UnrealLocations[i] = unrealLocations[i];
+					batch.UnrealRotations[i] = unrealRotations[i];
+					batch.DeltaTimesSinceLastPDU[i] = deltaTimes[i];
+					batch.PositionThresholdsMeters[i] = positionThresholdMeters;
+					batch.OrientationThresholdsDegrees[i] = orientationThresholdDegrees;
+					batch.SetSentState(i, sentPDUs[i]);
+				}
+				UDISSendManager::EvaluateDeadReckoningThresholds(batch, geoReferencingSystem);
+			}
+		});
+
+		int32 numDue = 0;
+		int32 numMismatches = 0;
+		for (int32 i = 0; i < num; i++)
+		{
+			numDue += batch.OutsideThreshold[i] ? 1 : 0;
+			numMismatches += batch.OutsideThreshold[i] != perComponentDecisions[i] ? 1 : 0;
+		}
+
+		perComponent.AddMetric(TEXT("Entities"), num);
+		batched.AddMetric(TEXT("Entities"), num);
+		batched.AddMetric(TEXT("FractionDue"), static_cast<double>(numDue) / num);
+		batched.AddMetric(TEXT("DecisionMismatches"), numMismatches);
+		batched.AddMetric(TEXT("SpeedupVsPerComponent"), perComponent.Seconds / FMath::Max(batched.Seconds, SMALL_NUMBER));
+
+		Context.Results.Add(perComponent);
+		Context.Results.Add(batched);
+	}
+
+	FDISAutoRegisterBenchmark SendManagerBenchmark(TEXT("Send.Manager"), &BenchmarkSendManager);
+
+	/**
+	 * Times the send manager's whole per frame pass over 5,000 registered send components on actors spread over a 100 km wide area:
+	 * gathering the actor transforms, the heartbeat and batched threshold tests, and the bookkeeping of the entities that are not due.
+	 * Threshold check scheduling is turned off so every entity is evaluated every frame, the worst case for the pass.
+	 * The actors move exactly as their last sent PDU dead reckons, so nothing is due and no PDUs are formed. PDUsSent counts any that were.
+	 */
+	void BenchmarkSendManagerPass(FDISBenchmarkContext& Context)
+	{
+		UWorld* world = Context.World;
+		AGeoReferencingSystem* geoReferencingSystem = Context.GeoReferencingSystem;
+		if (!IsValid(world) || !IsValid(world->GetWorldSettings()) || !IsValid(geoReferencingSystem))
+		{
+			UE_LOG(LogDISBenchmarks, Log, TEXT("Skipping Send.ManagerPass, no world with a GeoReferencing System."));
+			return;
+		}
+
+		const int32 num = Context.Scaled(5000);
+		const int32 numFrames = 30;
+		const float frameSeconds = 1.f / 60.f;
+		FRandomStream randomStream(5000);
+
+		//Finds the GeoReferencing System through its world, so it needs an owner in the world
+		UDISSendManager* sendManager = NewObject<UDISSendManager>(world->GetWorldSettings());
+		sendManager->SpreadHeartbeats = false;
+
+		FActorSpawnParameters spawnParameters;
+		spawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		spawnParameters.ObjectFlags |= RF_Transient;
+
+		TArray<AActor*> actors;
+		TArray<UDISSendComponent*> sendComponents;
+		TArray<FVector> startLocations;
+		TArray<FVector> unrealVelocities;
+		actors.SetNumUninitialized(num);
+		sendComponents.SetNumUninitialized(num);
+		startLocations.SetNumUninitialized(num);
+		unrealVelocities.SetNumUninitialized(num);
+
+		for (int32 i = 0; i < num; i++)
+		{
+			startLocations[i] = FVector(randomStream.FRandRange(-5000000.f, 5000000.f), randomStream.FRandRange(-5000000.f, 5000000.f), randomStream.FRandRange(0.f, 500000.f));
+			const FRotator rotation(0, randomStream.FRandRange(-180.f, 180.f), 0);
+			//Unreal units per second
+			unrealVelocities[i] = rotation.Vector() * randomStream.FRandRange(0.f, 3000.f);
+
+			AActor* actor = world->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, spawnParameters);
+			USceneComponent* rootComponent = NewObject<USceneComponent>(actor);
+			actor->SetRootComponent(rootComponent);
+			rootComponent->RegisterComponent();
+			actor->SetActorLocationAndRotation(startLocations[i], rotation);
+			actors[i] = actor;
+
+			//Left unregistered so it never begins play, only the send manager drives it
+			UDISSendComponent* sendComponent = NewObject<UDISSendComponent>(actor);
+			sendComponent->EntityStatePDUSendingMode = EEntityStateSendingMode::EntityStatePDU;
+			sendComponent->DeadReckoningAlgorithm = EDeadReckoningAlgorithm::FPW;
+			sendComponent->ScheduleThresholdChecks = false;
+			sendComponent->DISHeartbeatSeconds = 3600;
+
+			FEarthCenteredEarthFixedDouble sentEcef, movedEcef;
+			FDISGeoTransformCache::EngineToEcef(geoReferencingSystem, startLocations[i], sentEcef);
+			FDISGeoTransformCache::EngineToEcef(geoReferencingSystem, startLocations[i] + unrealVelocities[i], movedEcef);
+			FPsiThetaPhi psiThetaPhiRadians;
+			UDIS_BPFL::GetPsiThetaPhiRadiansFromUnrealRotation(rotation, startLocations[i], geoReferencingSystem, psiThetaPhiRadians);
+
+			FEntityStatePDU& sentPDU = sendComponent->MostRecentEntityStatePDU;
+			sentPDU.DeadReckoningParameters.DeadReckoningAlgorithm = EDeadReckoningAlgorithm::FPW;
+			sentPDU.EntityLocationDouble = { sentEcef.X, sentEcef.Y, sentEcef.Z };
+			sentPDU.EntityLocation = FVector(sentEcef.X, sentEcef.Y, sentEcef.Z);
+			sentPDU.EntityLinearVelocity = FVector(movedEcef.X - sentEcef.X, movedEcef.Y - sentEcef.Y, movedEcef.Z - sentEcef.Z);
+			sentPDU.EntityOrientation = FRotator(psiThetaPhiRadians.Theta, psiThetaPhiRadians.Psi, psiThetaPhiRadians.Phi);
+
+			sendManager->RegisterSendComponent(sendComponent);
+			sendComponents[i] = sendComponent;
+		}
+
+		double passSeconds = 0;
+		for (int32 frame = 1; frame <= numFrames; frame++)
+		{
+			//Moving the actors is not timed
+			for (int32 i = 0; i < num; i++)
+			{
+				actors[i]->SetActorLocation(startLocations[i] + unrealVelocities[i] * (frame * frameSeconds));
+			}
+
+			passSeconds += DISTimeSeconds([&]()
+			{
+				sendManager->EvaluateSendComponents(frameSeconds);
+			});
+		}
+
+		//Sending replaces the last sent PDU with one formed at the actor's location
+		int32 numSent = 0;
+		for (int32 i = 0; i < num; i++)
+		{
+			FEarthCenteredEarthFixedDouble sentEcef;
+			FDISGeoTransformCache::EngineToEcef(geoReferencingSystem, startLocations[i], sentEcef);
+			numSent += sendComponents[i]->MostRecentEntityStatePDU.EntityLocationDouble[0] != sentEcef.X ? 1 : 0;
+		}
+
+		FDISBenchmarkResult result(TEXT("Send.ManagerPass"));
+		result.Operations = static_cast<int64>(num) * numFrames;
+		result.Seconds = passSeconds;
+		result.AddMetric(TEXT("Entities"), sendManager->GetNumRegisteredSendComponents());
+		result.AddMetric(TEXT("MillisecondsPerFrame"), passSeconds * 1000 / numFrames);
+		result.AddMetric(TEXT("PDUsSent"), numSent);
+		Context.Results.Add(result);
+
+		for (AActor* actor : actors)
+		{
+			actor->Destroy();
+		}
+		sendManager->MarkPendingKill();
+	}
+
+	FDISAutoRegisterBenchmark SendManagerPassBenchmark(TEXT("Send.ManagerPass"), &BenchmarkSendManagerPass);
+
+	/**
+	 * Checks that the observer distance scale of a send component with the default curve drops once a remote observer comes within range, and times the nearest observer search.
+	 * Adds 1,000 remote observers 100 km away, then one 500 m from the entity. ScaleChanged is 1 if the scale went from the far value down to the near one.
+	 */
+	void BenchmarkObserverThresholdScale(FDISBenchmarkContext& Context)
+	{
+		if (!IsValid(Context.World) || !IsValid(Context.World->GetWorldSettings()))
+		{
+			UE_LOG(LogDISBenchmarks, Log, TEXT("Skipping Send.ObserverScale, no world."));
+			return;
+		}
+
+		//The send manager stamps observer updates with the world time, so it needs an owner in the world
+		UDISSendManager* sendManager = NewObject<UDISSendManager>(Context.World->GetWorldSettings());
+		const FRuntimeFloatCurve& scaleCurve = GetDefault<UDISSendComponent>()->ObserverDistanceThresholdScale;
+		const FEarthCenteredEarthFixedDouble entityLocation(6378137.0, 0, 0);
+		const float scaleWithoutObservers = UDISSendComponent::EvaluateObserverThresholdScale(scaleCurve, *sendManager, entityLocation);
+
+		const int32 numFarObservers = Context.Scaled(1000);
+		FEntityStatePDU observerPDU;
+		observerPDU.EntityType.EntityKind = 1;
+		for (int32 i = 0; i < numFarObservers; i++)
+		{
+			observerPDU.EntityID.Entity = i + 1;
+			observerPDU.EntityLocationDouble = { entityLocation.X, entityLocation.Y + 100000.0, entityLocation.Z + i };
+			sendManager->UpdateRemoteObserver(observerPDU);
+		}
+		const float scaleWithFarObservers = UDISSendComponent::EvaluateObserverThresholdScale(scaleCurve, *sendManager, entityLocation);
+
+		observerPDU.EntityID.Entity = numFarObservers + 1;
+		observerPDU.EntityLocationDouble = { entityLocation.X, entityLocation.Y + 500.0, entityLocation.Z };
+		sendManager->UpdateRemoteObserver(observerPDU);
+
+		const int32 numEvaluations = 1000;
+		float scaleWithNearObserver = 0;
+		FDISBenchmarkResult result(TEXT("Send.ObserverScale"));
+		result.Seconds = DISTimeSeconds([&]()
+			{
+				for (int32 i = 0; i < numEvaluations; i++)
+				{
+					scaleWithNearObserver = UDISSendComponent::EvaluateObserverThresholdScale(scaleCurve, *sendManager, entityLocation);
+				}
+			});
+		result.Operations = numEvaluations;
+
+		const bool scaleChanged = scaleWithFarObservers > 1 && FMath::IsNearlyEqual(scaleWithNearObserver, 1.f);
+		if (!scaleChanged)
+		{
+			UE_LOG(LogDISBenchmarks, Error, TEXT("Send.ObserverScale: threshold scale did not drop when a remote observer came within range (%f without observers, %f with far observers, %f with a near observer)."),
+				scaleWithoutObservers, scaleWithFarObservers, scaleWithNearObserver);
+		}
+
+		result.AddMetric(TEXT("Observers"), sendManager->GetNumRemoteObservers());
+		result.AddMetric(TEXT("ScaleWithoutObservers"), scaleWithoutObservers);
+		result.AddMetric(TEXT("ScaleWithFarObservers"), scaleWithFarObservers);
+		result.AddMetric(TEXT("ScaleWithNearObserver"), scaleWithNearObserver);
+		result.AddMetric(TEXT("ScaleChanged"), scaleChanged ? 1 : 0);
+		Context.Results.Add(result);
+
+		sendManager->MarkPendingKill();
+	}
+
+	FDISAutoRegisterBenchmark ObserverThresholdScaleBenchmark(TEXT("Send.ObserverScale"), &BenchmarkObserverThresholdScale);
+}
+
+#endif
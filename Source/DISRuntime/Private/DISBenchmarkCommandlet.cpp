@@ -0,0 +1,66 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISBenchmarkCommandlet.h"
+#include "DISBenchmarks.h"
+#include "GeoReferencingSystem.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Misc/Paths.h"
+
+UDISBenchmarkCommandlet::UDISBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UDISBenchmarkCommandlet::Main(const FString& Params)
+{
+#if UE_BUILD_SHIPPING
+	UE_LOG(LogDISBenchmarks, Error, TEXT("The benchmark commandlet is not available in shipping builds."));
+	return 1;
+#else
+	FDISBenchmarkContext context;
+	FString filter;
+	FString jsonPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("DISBenchmarks"), FString::Printf(TEXT("DISBenchmarks-%s.json"), *FDateTime::Now().ToString()));
+	FString baselinePath;
+	FParse::Value(*Params, TEXT("Filter="), filter);
+	FParse::Value(*Params, TEXT("Scale="), context.Scale);
+	FParse::Value(*Params, TEXT("Json="), jsonPath);
+	FParse::Value(*Params, TEXT("Baseline="), baselinePath);
+
+	UWorld* world = nullptr;
+	if (!FParse::Param(*Params, TEXT("NoWorld")) && GEngine != nullptr)
+	{
+		world = UWorld::CreateWorld(EWorldType::Game, false, TEXT("DISBenchmarkWorld"));
+		GEngine->CreateNewWorldContext(EWorldType::Game).SetCurrentWorld(world);
+
+		AGeoReferencingSystem* geoReferencingSystem = world->SpawnActor<AGeoReferencingSystem>();
+		if (geoReferencingSystem != nullptr)
+		{
+			geoReferencingSystem->PlanetShape = EPlanetShape::RoundPlanet;
+			geoReferencingSystem->ApplySettings();
+		}
+		context.World = world;
+		context.GeoReferencingSystem = geoReferencingSystem;
+	}
+
+	const TArray<FDISBenchmarkResult> results = FDISBenchmarkRegistry::Run(filter, context);
+	const bool saved = FDISBenchmarkRegistry::SaveJson(jsonPath, results, context);
+
+	TArray<FDISBenchmarkResult> baselineResults;
+	if (!baselinePath.IsEmpty() && FDISBenchmarkRegistry::LoadJson(baselinePath, baselineResults))
+	{
+		FDISBenchmarkRegistry::LogComparison(results, baselineResults);
+	}
+
+	if (world != nullptr)
+	{
+		GEngine->DestroyWorldContext(world);
+		world->DestroyWorld(false);
+	}
+
+	return saved && results.Num() > 0 ? 0 : 1;
+#endif
+}
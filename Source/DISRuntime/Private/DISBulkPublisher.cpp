@@ -0,0 +1,371 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISBulkPublisher.h"
+#include "BatchConversions_BPFL.h"
+#include "DeadReckoning_BPFL.h"
+#include "DISGeoTransformCache.h"
+#include "GeoReferencingSystem.h"
+
+DEFINE_LOG_CATEGORY(LogDISBulkPublisher);
+
+namespace DISBulkPublisherEncoding
+{
+	//Byte offsets into an Entity State PDU, all fields are big endian
+	constexpr int32 AppearanceOffset = 84;
+	constexpr int32 DeactivatedAppearanceBit = 1 << 23;
+
+	void WriteUInt8(uint8* Bytes, int32& Offset, uint8 Value)
+	{
+		Bytes[Offset++] = Value;
+	}
+
+	void WriteUInt16(uint8* Bytes, int32& Offset, uint16 Value)
+	{
+		Bytes[Offset++] = static_cast<uint8>(Value >> 8);
+		Bytes[Offset++] = static_cast<uint8>(Value);
+	}
+
+	void WriteUInt32(uint8* Bytes, int32& Offset, uint32 Value)
+	{
+		Bytes[Offset++] = static_cast<uint8>(Value >> 24);
+		Bytes[Offset++] = static_cast<uint8>(Value >> 16);
+		Bytes[Offset++] = static_cast<uint8>(Value >> 8);
+		Bytes[Offset++] = static_cast<uint8>(Value);
+	}
+
+	void WriteFloat(uint8* Bytes, int32& Offset, float Value)
+	{
+		uint32 bits;
+		FMemory::Memcpy(&bits, &Value, sizeof(bits));
+		WriteUInt32(Bytes, Offset, bits);
+	}
+
+	void WriteDouble(uint8* Bytes, int32& Offset, double Value)
+	{
+		uint64 bits;
+		FMemory::Memcpy(&bits, &Value, sizeof(bits));
+		WriteUInt32(Bytes, Offset, static_cast<uint32>(bits >> 32));
+		WriteUInt32(Bytes, Offset, static_cast<uint32>(bits));
+	}
+
+	uint32 ReadUInt32(const uint8* Bytes, int32 Offset)
+	{
+		return (uint32(Bytes[Offset]) << 24) | (uint32(Bytes[Offset + 1]) << 16) | (uint32(Bytes[Offset + 2]) << 8) | uint32(Bytes[Offset + 3]);
+	}
+
+	/**
+	 * Writes an Entity State PDU with the FPW dead reckoning algorithm in the same layout as UPDUConversions_BPFL::ConvertEntityStatePDUToBytes.
+	 */
+	void EncodeEntityStatePDU(uint8* Bytes, uint8 ExerciseID, const FEntityID& EntityID, const FEntityType& EntityType, const FDISBulkPublishSettings& Settings,
+		const double EcefLocation[3], const FVector& EcefLinearVelocity, const float PsiThetaPhiRadians[3], const float HeadingPitchRollRadians[3])
+	{
+		int32 offset = 0;
+
+		//PDU header
+		WriteUInt8(Bytes, offset, 6);
+		WriteUInt8(Bytes, offset, ExerciseID);
+		WriteUInt8(Bytes, offset, static_cast<uint8>(EPDUType::EntityState));
+		WriteUInt8(Bytes, offset, 1);
+		WriteUInt32(Bytes, offset, 0);
+		WriteUInt16(Bytes, offset, FDISBulkPublisher::EntityStatePDUSize);
+		WriteUInt16(Bytes, offset, 0);
+
+		WriteUInt16(Bytes, offset, EntityID.Site);
+		WriteUInt16(Bytes, offset, EntityID.Application);
+		WriteUInt16(Bytes, offset, EntityID.Entity);
+		WriteUInt8(Bytes, offset, static_cast<uint8>(Settings.EntityForceID));
+		//No articulation parameters
+		WriteUInt8(Bytes, offset, 0);
+
+		WriteUInt8(Bytes, offset, EntityType.EntityKind);
+		WriteUInt8(Bytes, offset, EntityType.Domain);
+		WriteUInt16(Bytes, offset, EntityType.Country);
+		WriteUInt8(Bytes, offset, EntityType.Category);
+		WriteUInt8(Bytes, offset, EntityType.Subcategory);
+		WriteUInt8(Bytes, offset, EntityType.Specific);
+		WriteUInt8(Bytes, offset, EntityType.Extra);
+		//Alternative entity type is left empty
+		FMemory::Memzero(Bytes + offset, 8);
+		offset += 8;
+
+		WriteFloat(Bytes, offset, EcefLinearVelocity.X);
+		WriteFloat(Bytes, offset, EcefLinearVelocity.Y);
+		WriteFloat(Bytes, offset, EcefLinearVelocity.Z);
+		WriteDouble(Bytes, offset, EcefLocation[0]);
+		WriteDouble(Bytes, offset, EcefLocation[1]);
+		WriteDouble(Bytes, offset, EcefLocation[2]);
+		WriteFloat(Bytes, offset, PsiThetaPhiRadians[0]);
+		WriteFloat(Bytes, offset, PsiThetaPhiRadians[1]);
+		WriteFloat(Bytes, offset, PsiThetaPhiRadians[2]);
+		WriteUInt32(Bytes, offset, static_cast<uint32>(Settings.EntityAppearance));
+
+		//Dead reckoning parameters, other parameters hold the Heading, Pitch, Roll the same way as UDeadReckoning_BPFL::FormOtherParameters
+		WriteUInt8(Bytes, offset, static_cast<uint8>(EDeadReckoningAlgorithm::FPW));
+		WriteUInt8(Bytes, offset, 1);
+		WriteUInt16(Bytes, offset, 0);
+		WriteFloat(Bytes, offset, HeadingPitchRollRadians[0]);
+		WriteFloat(Bytes, offset, HeadingPitchRollRadians[1]);
+		WriteFloat(Bytes, offset, HeadingPitchRollRadians[2]);
+		//Linear acceleration and angular velocity are not used by FPW
+		FMemory::Memzero(Bytes + offset, 24);
+		offset += 24;
+
+		//Empty marking in the ASCII character set
+		WriteUInt8(Bytes, offset, 1);
+		FMemory::Memzero(Bytes + offset, 11);
+		offset += 11;
+
+		WriteUInt32(Bytes, offset, static_cast<uint32>(Settings.EntityCapabilities));
+
+		check(offset == FDISBulkPublisher::EntityStatePDUSize);
+	}
+
+	EUDPSendPriority GetThresholdSendPriority(const FDISBulkPublishSettings& Settings, double PositionErrorMeters, double OrientationErrorRadians)
+	{
+		//Same as UDISSendComponent::GetThresholdSendPriority
+		const bool largeError = PositionErrorMeters > Settings.DeadReckoningPositionThresholdMeters * Settings.HighPriorityThresholdMultiple
+			|| OrientationErrorRadians > FMath::DegreesToRadians(Settings.DeadReckoningOrientationThresholdDegrees) * Settings.HighPriorityThresholdMultiple;
+
+		return largeError ? EUDPSendPriority::High : EUDPSendPriority::Normal;
+	}
+}
+
+int64 FDISBulkPublisher::GetEntityKey(const FEntityID& EntityID)
+{
+	//Matches the merge key used by UDISSendComponent::EmitAppropriatePDU
+	return (int64(1) << 48) | (int64(EntityID.Site) << 32) | (int64(EntityID.Application) << 16) | int64(EntityID.Entity);
+}
+
+int32 FDISBulkPublisher::Publish(TArrayView<const FEntityID> EntityIDs, TArrayView<const FEntityType> EntityTypes, TArrayView<const FVector> UnrealLocations,
+	TArrayView<const FRotator> UnrealRotations, TArrayView<const FVector> UnrealVelocities, double NowSeconds, const FDISBulkPublishSettings& Settings,
+	uint8 ExerciseID, AGeoReferencingSystem* GeoReferencingSystem, TFunctionRef<void(const TArray<uint8>&, EUDPSendPriority, int64)> Emit)
+{
+	SCOPE_CYCLE_COUNTER(STAT_BulkPublish);
+
+	const int32 num = EntityIDs.Num();
+	if (EntityTypes.Num() != num || UnrealLocations.Num() != num || UnrealRotations.Num() != num || UnrealVelocities.Num() != num)
+	{
+		UE_LOG(LogDISBulkPublisher, Warning, TEXT("Bulk publish needs an entity type, location, rotation, and velocity for every entity ID. Nothing was published."));
+		return 0;
+	}
+	if (!IsValid(GeoReferencingSystem))
+	{
+		UE_LOG(LogDISBulkPublisher, Warning, TEXT("Bulk publish needs a GeoReferencing System in the world. Nothing was published."));
+		return 0;
+	}
+
+	//Gather the current and last sent state of every entity, entities seen for the first time are left out of the threshold test
+	Batch.SetNumUninitialized(num);
+	BatchPublishedIndices.SetNumUninitialized(num);
+	for (int32 i = 0; i < num; i++)
+	{
+		const int64 key = GetEntityKey(EntityIDs[i]);
+		const int32* existingIndex = PublishedIndices.Find(key);
+		const bool isNew = existingIndex == nullptr;
+
+		int32 publishedIndex;
+		if (isNew)
+		{
+			publishedIndex = Published.AddZeroed();
+			Published[publishedIndex].Key = key;
+			PublishedIndices.Add(key, publishedIndex);
+		}
+		else
+		{
+			publishedIndex = *existingIndex;
+		}
+		BatchPublishedIndices[i] = publishedIndex;
+
+		Batch.UnrealLocations[i] = UnrealLocations[i];
+		Batch.UnrealRotations[i] = UnrealRotations[i];
+		Batch.PositionThresholdsMeters[i] = Settings.DeadReckoningPositionThresholdMeters;
+		Batch.OrientationThresholdsDegrees[i] = Settings.DeadReckoningOrientationThresholdDegrees;
+		Batch.Batched[i] = !isNew;
+
+		//FPW has no acceleration or angular velocity to dead reckon with
+		Batch.SentLinearAccelerations.X[i] = 0;
+		Batch.SentLinearAccelerations.Y[i] = 0;
+		Batch.SentLinearAccelerations.Z[i] = 0;
+		Batch.SentAngularVelocities.X[i] = 0;
+		Batch.SentAngularVelocities.Y[i] = 0;
+		Batch.SentAngularVelocities.Z[i] = 0;
+
+		if (isNew)
+		{
+			Batch.DeltaTimesSinceLastPDU[i] = 0;
+			Batch.SentLocations.X[i] = 0;
+			Batch.SentLocations.Y[i] = 0;
+			Batch.SentLocations.Z[i] = 0;
+			Batch.SentLinearVelocities.X[i] = 0;
+			Batch.SentLinearVelocities.Y[i] = 0;
+			Batch.SentLinearVelocities.Z[i] = 0;
+			Batch.SentOrientations[i] = FQuat::Identity;
+			continue;
+		}
+
+		const FPublishedEntity& published = Published[publishedIndex];
+		Batch.DeltaTimesSinceLastPDU[i] = NowSeconds - published.LastSentSeconds;
+		Batch.SentLocations.X[i] = published.SentLocation[0];
+		Batch.SentLocations.Y[i] = published.SentLocation[1];
+		Batch.SentLocations.Z[i] = published.SentLocation[2];
+		Batch.SentLinearVelocities.X[i] = published.SentLinearVelocity[0];
+		Batch.SentLinearVelocities.Y[i] = published.SentLinearVelocity[1];
+		Batch.SentLinearVelocities.Z[i] = published.SentLinearVelocity[2];
+		Batch.SentOrientations[i] = published.SentOrientation;
+	}
+
+	UDISSendManager::EvaluateDeadReckoningThresholds(Batch, GeoReferencingSystem);
+
+	DueIndices.Reset();
+	DuePriorities.Reset();
+	for (int32 i = 0; i < num; i++)
+	{
+		if (!Batch.Batched[i])
+		{
+			DueIndices.Add(i);
+			DuePriorities.Add(EUDPSendPriority::High);
+		}
+		else if (Batch.OutsideThreshold[i])
+		{
+			DueIndices.Add(i);
+			DuePriorities.Add(DISBulkPublisherEncoding::GetThresholdSendPriority(Settings, Batch.PositionErrorsMeters[i], Batch.OrientationErrorsRadians[i]));
+		}
+		else if (Batch.DeltaTimesSinceLastPDU[i] >= Settings.DISHeartbeatSeconds)
+		{
+			//Heartbeats only restate the dead reckoned state
+			DueIndices.Add(i);
+			DuePriorities.Add(EUDPSendPriority::Low);
+		}
+	}
+
+	const int32 numDue = DueIndices.Num();
+	if (numDue == 0)
+	{
+		SET_DWORD_STAT(STAT_BulkPublishedEntities, Published.Num());
+		return 0;
+	}
+
+	//The FPW other parameters need the Heading, Pitch, Roll of the due entities
+	DueEcefLocations.SetNumUninitialized(numDue);
+	DuePsiThetaPhiRadians.SetNumUninitialized(numDue);
+	DueLatLonHeights.SetNumUninitialized(numDue);
+	DueHeadingPitchRollRadians.SetNumUninitialized(numDue);
+	for (int32 due = 0; due < numDue; due++)
+	{
+		const int32 i = DueIndices[due];
+		DueEcefLocations.X[due] = Batch.EcefLocations.X[i];
+		DueEcefLocations.Y[due] = Batch.EcefLocations.Y[i];
+		DueEcefLocations.Z[due] = Batch.EcefLocations.Z[i];
+		DuePsiThetaPhiRadians.X[due] = Batch.PsiThetaPhiRadians.X[i];
+		DuePsiThetaPhiRadians.Y[due] = Batch.PsiThetaPhiRadians.Y[i];
+		DuePsiThetaPhiRadians.Z[due] = Batch.PsiThetaPhiRadians.Z[i];
+	}
+	UBatchConversions_BPFL::CalculateLatLonHeightFromEcefXYZ(DueEcefLocations.X, DueEcefLocations.Y, DueEcefLocations.Z, DueLatLonHeights.X, DueLatLonHeights.Y, DueLatLonHeights.Z);
+	UBatchConversions_BPFL::CalculateHeadingPitchRollRadiansFromPsiThetaPhiRadiansAtLatLon(DuePsiThetaPhiRadians.X, DuePsiThetaPhiRadians.Y, DuePsiThetaPhiRadians.Z,
+		DueLatLonHeights.X, DueLatLonHeights.Y, DueHeadingPitchRollRadians.X, DueHeadingPitchRollRadians.Y, DueHeadingPitchRollRadians.Z);
+
+	//Read the cache once for the whole batch
+	TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe> geoTransformCache = FDISGeoTransformCache::Get(GeoReferencingSystem);
+
+	EncodedBytes.SetNumUninitialized(EntityStatePDUSize);
+	for (int32 due = 0; due < numDue; due++)
+	{
+		const int32 i = DueIndices[due];
+		FPublishedEntity& published = Published[BatchPublishedIndices[i]];
+
+		//ECEF velocity from where the entity will be one second from now
+		FEarthCenteredEarthFixedDouble aheadEcef;
+		if (geoTransformCache.IsValid())
+		{
+			geoTransformCache->EngineToEcef(UnrealLocations[i] + UnrealVelocities[i], aheadEcef);
+		}
+		else
+		{
+			FDISGeoTransformCache::EngineToEcef(GeoReferencingSystem, UnrealLocations[i] + UnrealVelocities[i], aheadEcef);
+		}
+		const FVector linearVelocity(aheadEcef.X - DueEcefLocations.X[due], aheadEcef.Y - DueEcefLocations.Y[due], aheadEcef.Z - DueEcefLocations.Z[due]);
+
+		const double ecefLocation[3] = { DueEcefLocations.X[due], DueEcefLocations.Y[due], DueEcefLocations.Z[due] };
+		const float psiThetaPhiRadians[3] = { static_cast<float>(DuePsiThetaPhiRadians.X[due]), static_cast<float>(DuePsiThetaPhiRadians.Y[due]), static_cast<float>(DuePsiThetaPhiRadians.Z[due]) };
+		const float headingPitchRollRadians[3] = { static_cast<float>(DueHeadingPitchRollRadians.X[due]), static_cast<float>(DueHeadingPitchRollRadians.Y[due]), static_cast<float>(DueHeadingPitchRollRadians.Z[due]) };
+
+		DISBulkPublisherEncoding::EncodeEntityStatePDU(EncodedBytes.GetData(), ExerciseID, EntityIDs[i], EntityTypes[i], Settings, ecefLocation, linearVelocity, psiThetaPhiRadians, headingPitchRollRadians);
+		Emit(EncodedBytes, DuePriorities[due], published.Key);
+
+		//Dead reckon from what receivers got, which carries the orientation as floats
+		published.LastSentSeconds = NowSeconds;
+		published.SentLocation[0] = ecefLocation[0];
+		published.SentLocation[1] = ecefLocation[1];
+		published.SentLocation[2] = ecefLocation[2];
+		published.SentLinearVelocity[0] = linearVelocity.X;
+		published.SentLinearVelocity[1] = linearVelocity.Y;
+		published.SentLinearVelocity[2] = linearVelocity.Z;
+		published.SentOrientation = UDeadReckoning_BPFL::GetEntityOrientationQuaternion(psiThetaPhiRadians[0], psiThetaPhiRadians[1], psiThetaPhiRadians[2]);
+		FMemory::Memcpy(published.SentBytes, EncodedBytes.GetData(), EntityStatePDUSize);
+	}
+
+	SET_DWORD_STAT(STAT_BulkPublishedEntities, Published.Num());
+	INC_DWORD_STAT_BY(STAT_BulkEntityStatePDUsSent, numDue);
+
+	return numDue;
+}
+
+int32 FDISBulkPublisher::Unpublish(TArrayView<const FEntityID> EntityIDs, TFunctionRef<void(const TArray<uint8>&, EUDPSendPriority, int64)> Emit)
+{
+	int32 numUnpublished = 0;
+	EncodedBytes.SetNumUninitialized(EntityStatePDUSize);
+
+	for (const FEntityID& entityID : EntityIDs)
+	{
+		const int64 key = GetEntityKey(entityID);
+		int32 publishedIndex;
+		if (!PublishedIndices.RemoveAndCopyValue(key, publishedIndex))
+		{
+			continue;
+		}
+
+		//Restate the last sent state with the deactivated appearance bit set
+		uint8* bytes = EncodedBytes.GetData();
+		FMemory::Memcpy(bytes, Published[publishedIndex].SentBytes, EntityStatePDUSize);
+		int32 appearanceOffset = DISBulkPublisherEncoding::AppearanceOffset;
+		const uint32 appearance = DISBulkPublisherEncoding::ReadUInt32(bytes, appearanceOffset) | DISBulkPublisherEncoding::DeactivatedAppearanceBit;
+		DISBulkPublisherEncoding::WriteUInt32(bytes, appearanceOffset, appearance);
+		Emit(EncodedBytes, EUDPSendPriority::High, key);
+
+		//Keep the published entities packed
+		Published.RemoveAtSwap(publishedIndex, 1, false);
+		if (publishedIndex < Published.Num())
+		{
+			PublishedIndices[Published[publishedIndex].Key] = publishedIndex;
+		}
+		numUnpublished++;
+	}
+
+	SET_DWORD_STAT(STAT_BulkPublishedEntities, Published.Num());
+
+	return numUnpublished;
+}
+
+int32 FDISBulkPublisher::UnpublishAll(TFunctionRef<void(const TArray<uint8>&, EUDPSendPriority, int64)> Emit)
+{
+	const int32 numUnpublished = Published.Num();
+	EncodedBytes.SetNumUninitialized(EntityStatePDUSize);
+
+	for (const FPublishedEntity& published : Published)
+	{
+		//Restate the last sent state with the deactivated appearance bit set
+		uint8* bytes = EncodedBytes.GetData();
+		FMemory::Memcpy(bytes, published.SentBytes, EntityStatePDUSize);
+		int32 appearanceOffset = DISBulkPublisherEncoding::AppearanceOffset;
+		const uint32 appearance = DISBulkPublisherEncoding::ReadUInt32(bytes, appearanceOffset) | DISBulkPublisherEncoding::DeactivatedAppearanceBit;
+		DISBulkPublisherEncoding::WriteUInt32(bytes, appearanceOffset, appearance);
+		Emit(EncodedBytes, EUDPSendPriority::High, published.Key);
+	}
+
+	Published.Reset();
+	PublishedIndices.Reset();
+
+	SET_DWORD_STAT(STAT_BulkPublishedEntities, 0);
+
+	return numUnpublished;
+}
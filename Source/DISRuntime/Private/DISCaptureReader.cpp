@@ -0,0 +1,226 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISCaptureReader.h"
+#include "Algo/BinarySearch.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+
+DEFINE_LOG_CATEGORY(LogDISCaptureReader);
+
+FDISCaptureReader::~FDISCaptureReader()
+{
+	Close();
+}
+
+bool FDISCaptureReader::Open(const FString& Directory, const FString& CaptureName)
+{
+	Close();
+
+	IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+	for (int32 segmentNumber = 0; ; segmentNumber++)
+	{
+		const FString segmentPath = DISCaptureLog::GetSegmentPath(Directory, CaptureName, segmentNumber, DISCaptureLog::SegmentExtension);
+		if (!platformFile.FileExists(*segmentPath))
+		{
+			break;
+		}
+
+		TUniquePtr<FSegment> segment = MakeUnique<FSegment>();
+		if (!OpenSegment(segmentPath, DISCaptureLog::GetSegmentPath(Directory, CaptureName, segmentNumber, DISCaptureLog::IndexExtension), *segment))
+		{
+			UE_LOG(LogDISCaptureReader, Warning, TEXT("Capture segment %s is not valid. Stopping the capture before it."), *segmentPath);
+			break;
+		}
+		Segments.Add(MoveTemp(segment));
+	}
+
+	if (Segments.Num() == 0)
+	{
+		UE_LOG(LogDISCaptureReader, Error, TEXT("Could not open capture %s in %s."), *CaptureName, *Directory);
+		return false;
+	}
+
+	//The end is found by walking the last segment on from its last index entry
+	FDISCaptureRecordHeader record;
+	TArrayView<const uint8> payload;
+	const FSegment& lastSegment = *Segments.Last();
+	Position.Segment = Segments.Num() - 1;
+	Position.Offset = lastSegment.Index.Num() > 0 ? lastSegment.Index.Last().FileOffset : sizeof(FDISCaptureFileHeader);
+	while (ReadNext(record, payload))
+	{
+		EndTicks = record.TimestampTicks;
+	}
+
+	Position = FPosition();
+	StartTicks = PeekNextTicks(StartTicks) ? StartTicks : 0;
+	EndTicks = FMath::Max(EndTicks, StartTicks);
+
+	return true;
+}
+
+void FDISCaptureReader::Close()
+{
+	for (TUniquePtr<FSegment>& segment : Segments)
+	{
+		//Regions have to be released before the file they map
+		delete segment->MappedRegion;
+		delete segment->MappedFile;
+	}
+	Segments.Reset();
+
+	Position = FPosition();
+	StartTicks = 0;
+	EndTicks = 0;
+}
+
+int64 FDISCaptureReader::GetTotalBytes() const
+{
+	int64 totalBytes = 0;
+	for (const TUniquePtr<FSegment>& segment : Segments)
+	{
+		totalBytes += segment->NumBytes;
+	}
+	return totalBytes;
+}
+
+bool FDISCaptureReader::OpenSegment(const FString& SegmentPath, const FString& IndexPath, FSegment& OutSegment)
+{
+	IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+	OutSegment.MappedFile = platformFile.OpenMapped(*SegmentPath);
+	if (OutSegment.MappedFile != nullptr && OutSegment.MappedFile->GetFileSize() > 0)
+	{
+		OutSegment.MappedRegion = OutSegment.MappedFile->MapRegion(0, OutSegment.MappedFile->GetFileSize());
+	}
+
+	if (OutSegment.MappedRegion != nullptr)
+	{
+		OutSegment.Data = OutSegment.MappedRegion->GetMappedPtr();
+		OutSegment.NumBytes = OutSegment.MappedRegion->GetMappedSize();
+	}
+	else if (FFileHelper::LoadFileToArray(OutSegment.LoadedBytes, *SegmentPath))
+	{
+		OutSegment.Data = OutSegment.LoadedBytes.GetData();
+		OutSegment.NumBytes = OutSegment.LoadedBytes.Num();
+	}
+
+	if (OutSegment.NumBytes < static_cast<int64>(sizeof(FDISCaptureFileHeader)))
+	{
+		return false;
+	}
+
+	FDISCaptureFileHeader segmentHeader;
+	FMemory::Memcpy(&segmentHeader, OutSegment.Data, sizeof(segmentHeader));
+	if (!segmentHeader.IsValid(DISCaptureLog::LogKind))
+	{
+		return false;
+	}
+
+	//A missing or damaged index only costs seek speed
+	TArray<uint8> indexBytes;
+	FDISCaptureFileHeader indexHeader;
+	if (FFileHelper::LoadFileToArray(indexBytes, *IndexPath, FILEREAD_Silent) && indexBytes.Num() >= static_cast<int32>(sizeof(FDISCaptureFileHeader)))
+	{
+		FMemory::Memcpy(&indexHeader, indexBytes.GetData(), sizeof(indexHeader));
+		if (indexHeader.IsValid(DISCaptureLog::IndexKind) && indexHeader.HeaderBytes <= static_cast<uint32>(indexBytes.Num()))
+		{
+			const int32 numEntries = (indexBytes.Num() - static_cast<int32>(indexHeader.HeaderBytes)) / sizeof(FDISCaptureIndexEntry);
+			OutSegment.Index.SetNumUninitialized(numEntries);
+			FMemory::Memcpy(OutSegment.Index.GetData(), indexBytes.GetData() + indexHeader.HeaderBytes, OutSegment.Index.Num() * sizeof(FDISCaptureIndexEntry));
+
+			//Drop entries pointing into the file header or past what made it into the segment
+			const int64 numBytes = OutSegment.NumBytes;
+			OutSegment.Index.RemoveAll([numBytes](const FDISCaptureIndexEntry& Entry)
+			{
+				return !DISCaptureLog::IsRecordOffsetInBounds(Entry.FileOffset, numBytes);
+			});
+		}
+	}
+
+	return true;
+}
+
+bool FDISCaptureReader::SkipToReadableRecord()
+{
+	while (Segments.IsValidIndex(Position.Segment))
+	{
+		const FSegment& segment = *Segments[Position.Segment];
+		if (DISCaptureLog::IsRecordOffsetInBounds(Position.Offset, segment.NumBytes))
+		{
+			FDISCaptureRecordHeader record;
+			FMemory::Memcpy(&record, segment.Data + Position.Offset, sizeof(record));
+			if (record.PayloadBytes <= segment.NumBytes - Position.Offset - static_cast<int64>(sizeof(FDISCaptureRecordHeader)))
+			{
+				return true;
+			}
+		}
+
+		Position.Segment++;
+		Position.Offset = sizeof(FDISCaptureFileHeader);
+	}
+
+	return false;
+}
+
+bool FDISCaptureReader::ReadNext(FDISCaptureRecordHeader& OutRecord, TArrayView<const uint8>& OutPayload)
+{
+	if (!SkipToReadableRecord())
+	{
+		return false;
+	}
+
+	const FSegment& segment = *Segments[Position.Segment];
+	FMemory::Memcpy(&OutRecord, segment.Data + Position.Offset, sizeof(OutRecord));
+	OutPayload = TArrayView<const uint8>(segment.Data + Position.Offset + sizeof(FDISCaptureRecordHeader), OutRecord.PayloadBytes);
+	Position.Offset += sizeof(FDISCaptureRecordHeader) + OutRecord.PayloadBytes;
+
+	return true;
+}
+
+bool FDISCaptureReader::PeekNextTicks(int64& OutTicks)
+{
+	if (!SkipToReadableRecord())
+	{
+		return false;
+	}
+
+	FMemory::Memcpy(&OutTicks, Segments[Position.Segment]->Data + Position.Offset, sizeof(OutTicks));
+	return true;
+}
+
+void FDISCaptureReader::SeekToTicks(int64 Ticks)
+{
+	Position = FPosition();
+	if (!IsOpen())
+	{
+		return;
+	}
+
+	//Start from the last segment whose first index entry is not after the time
+	for (int32 segmentIndex = Segments.Num() - 1; segmentIndex > 0; segmentIndex--)
+	{
+		const TArray<FDISCaptureIndexEntry>& segmentIndexEntries = Segments[segmentIndex]->Index;
+		if (segmentIndexEntries.Num() > 0 && segmentIndexEntries[0].TimestampTicks <= Ticks)
+		{
+			Position.Segment = segmentIndex;
+			break;
+		}
+	}
+
+	//Then from the last index entry in it that is not after the time
+	const TArray<FDISCaptureIndexEntry>& index = Segments[Position.Segment]->Index;
+	const int32 entryIndex = Algo::UpperBoundBy(index, Ticks, &FDISCaptureIndexEntry::TimestampTicks) - 1;
+	if (index.IsValidIndex(entryIndex))
+	{
+		Position.Offset = index[entryIndex].FileOffset;
+	}
+
+	int64 nextTicks;
+	while (PeekNextTicks(nextTicks) && nextTicks < Ticks)
+	{
+		FDISCaptureRecordHeader record;
+		TArrayView<const uint8> payload;
+		ReadNext(record, payload);
+	}
+}
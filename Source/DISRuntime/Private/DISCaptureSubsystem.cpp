@@ -0,0 +1,75 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISCaptureSubsystem.h"
+#include "DISCaptureWriter.h"
+#include "UDPSubsystem.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY(LogDISCapture);
+
+void UDISCaptureSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	//The UDP Subsystem has to outlive the capture tapping it
+	Collection.InitializeDependency(UUDPSubsystem::StaticClass());
+}
+
+void UDISCaptureSubsystem::Deinitialize()
+{
+	StopCapture();
+
+	Super::Deinitialize();
+}
+
+bool UDISCaptureSubsystem::StartCapture(const FString& CaptureName, FDISCaptureSettings Settings)
+{
+	StopCapture();
+
+	UUDPSubsystem* udpSubsystem = GetGameInstance()->GetSubsystem<UUDPSubsystem>();
+	if (!IsValid(udpSubsystem))
+	{
+		return false;
+	}
+
+	const FString directory = Settings.Directory.IsEmpty() ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("DISCaptures")) : Settings.Directory;
+	TSharedPtr<FDISCaptureWriter, ESPMode::ThreadSafe> writer = MakeShared<FDISCaptureWriter, ESPMode::ThreadSafe>(directory, CaptureName, Settings);
+	if (!writer->Open())
+	{
+		return false;
+	}
+
+	Writer = writer;
+	udpSubsystem->AddReceiveTap(Writer.ToSharedRef());
+
+	UE_LOG(LogDISCapture, Log, TEXT("Started capture %s in %s."), *CaptureName, *directory);
+
+	return true;
+}
+
+void UDISCaptureSubsystem::StopCapture()
+{
+	if (!Writer.IsValid())
+	{
+		return;
+	}
+
+	//Nothing can be captured once the tap is removed, so closing writes out everything received
+	UUDPSubsystem* udpSubsystem = GetGameInstance()->GetSubsystem<UUDPSubsystem>();
+	if (IsValid(udpSubsystem))
+	{
+		udpSubsystem->RemoveReceiveTap(Writer.ToSharedRef());
+	}
+	Writer->Close();
+
+	LastCaptureCounters = Writer->GetCounters();
+	Writer.Reset();
+
+	UE_LOG(LogDISCapture, Log, TEXT("Stopped capture. %lld packets written, %lld dropped, %lld bytes in %d segments."),
+		LastCaptureCounters.PacketsWritten, LastCaptureCounters.PacketsDropped, LastCaptureCounters.BytesWritten, LastCaptureCounters.SegmentsWritten);
+}
+
+FDISCaptureCounters UDISCaptureSubsystem::GetCaptureCounters() const
+{
+	return Writer.IsValid() ? Writer->GetCounters() : LastCaptureCounters;
+}
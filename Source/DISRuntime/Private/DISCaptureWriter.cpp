@@ -0,0 +1,450 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISCaptureWriter.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+
+namespace DISCaptureWriterPcap
+{
+	constexpr uint32 NanosecondMagic = 0xA1B23C4D;
+	//LINKTYPE_IPV4, packets start at the IPv4 header
+	constexpr uint32 LinkTypeIPv4 = 228;
+	constexpr int32 FileHeaderBytes = 24;
+	constexpr int32 RecordHeaderBytes = 16;
+	constexpr int32 IPv4HeaderBytes = 20;
+	constexpr int32 UDPHeaderBytes = 8;
+
+	inline void WriteBigEndian16(uint8* Bytes, uint16 Value)
+	{
+		Bytes[0] = static_cast<uint8>(Value >> 8);
+		Bytes[1] = static_cast<uint8>(Value);
+	}
+
+	inline void WriteBigEndian32(uint8* Bytes, uint32 Value)
+	{
+		Bytes[0] = static_cast<uint8>(Value >> 24);
+		Bytes[1] = static_cast<uint8>(Value >> 16);
+		Bytes[2] = static_cast<uint8>(Value >> 8);
+		Bytes[3] = static_cast<uint8>(Value);
+	}
+}
+
+FDISCaptureWriter::FDISCaptureWriter(const FString& InDirectory, const FString& InCaptureName, const FDISCaptureSettings& Settings)
+	: Directory(InDirectory)
+	, CaptureName(InCaptureName)
+	, Format(Settings.Format)
+{
+	BufferBytes = FMath::Max(Settings.BufferMegabytes, 1) * 1024 * 1024;
+	MaxSegmentBytes = static_cast<int64>(FMath::Max(Settings.MaxSegmentMegabytes, 1)) * 1024 * 1024;
+	IndexIntervalTicks = static_cast<int64>(FMath::Max(Settings.IndexIntervalSeconds, 0.01f) * ETimespan::TicksPerSecond);
+	FlushIntervalSeconds = FMath::Max(Settings.FlushIntervalSeconds, 0.01f);
+	KeyframeIntervalSeconds = Format == EDISCaptureFormat::CaptureLog ? FMath::Max(Settings.KeyframeIntervalSeconds, 0.0f) : 0.0f;
+
+	//Allocate every buffer up front so the receive threads never allocate
+	Buffers.SetNum(FMath::Max(Settings.NumBuffers, 2));
+	for (int32 i = 0; i < Buffers.Num(); i++)
+	{
+		Buffers[i].Bytes.SetNumUninitialized(BufferBytes);
+		Buffers[i].IndexEntries.Reserve(64);
+		FreeBuffers.Enqueue(i);
+	}
+}
+
+FDISCaptureWriter::~FDISCaptureWriter()
+{
+	Close();
+}
+
+bool FDISCaptureWriter::Open()
+{
+	if (!FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*Directory) || !OpenSegment(0))
+	{
+		UE_LOG(LogDISCapture, Error, TEXT("Could not create capture %s in %s."), *CaptureName, *Directory);
+		return false;
+	}
+
+	if (KeyframeIntervalSeconds > 0)
+	{
+		//The capture is still usable without keyframes, seeking is just slower
+		KeyframeWriter = MakeUnique<FDISKeyframeWriter>();
+		if (!KeyframeWriter->Open(DISCaptureLog::GetKeyframePath(Directory, CaptureName), KeyframeIntervalSeconds))
+		{
+			KeyframeWriter.Reset();
+		}
+	}
+
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FRunnableThread::Create(this, TEXT("DISCaptureWriter"), 0, TPri_AboveNormal);
+
+	return Thread != nullptr;
+}
+
+void FDISCaptureWriter::Close()
+{
+	if (Thread != nullptr)
+	{
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	if (WakeEvent != nullptr)
+	{
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		WakeEvent = nullptr;
+	}
+
+	CloseSegment();
+	KeyframeWriter.Reset();
+}
+
+FDISCaptureCounters FDISCaptureWriter::GetCounters() const
+{
+	FDISCaptureCounters counters;
+	counters.PacketsWritten = PacketsWritten.GetValue();
+	counters.PacketsDropped = PacketsDropped.GetValue();
+	counters.BytesWritten = BytesWritten.GetValue();
+	counters.SegmentsWritten = SegmentsWritten.GetValue();
+
+	return counters;
+}
+
+void FDISCaptureWriter::OnDatagramReceived(TArrayView<const uint8> Bytes, const FIPv4Endpoint& Sender, const FIPv4Endpoint& Receiver, int32 ReceiveSocketID)
+{
+	FDISCaptureRecordHeader record;
+	record.TimestampTicks = FDateTime::UtcNow().GetTicks();
+	record.PayloadBytes = Bytes.Num();
+	record.SourceAddress = Sender.Address.Value;
+	record.SourcePort = Sender.Port;
+	record.ReceiveSocketID = static_cast<uint16>(ReceiveSocketID);
+	record.Reserved = 0;
+
+	const int32 recordBytes = sizeof(FDISCaptureRecordHeader) + Bytes.Num();
+	if (recordBytes > BufferBytes)
+	{
+		PacketsDropped.Increment();
+		return;
+	}
+
+	FScopeLock lock(&ProducerLock);
+
+	if (Format == EDISCaptureFormat::Pcap && !ReceiveEndpoints.Contains(record.ReceiveSocketID))
+	{
+		ReceiveEndpoints.Add(record.ReceiveSocketID, Receiver);
+	}
+
+	if (CurrentBuffer != INDEX_NONE && Buffers[CurrentBuffer].NumBytes + recordBytes > BufferBytes)
+	{
+		FullBuffers.Enqueue(CurrentBuffer);
+		CurrentBuffer = INDEX_NONE;
+		WakeEvent->Trigger();
+	}
+
+	if (CurrentBuffer == INDEX_NONE)
+	{
+		int32 freeBuffer;
+		if (!FreeBuffers.Dequeue(freeBuffer))
+		{
+			//The writer has fallen behind by the whole pool
+			PacketsDropped.Increment();
+			return;
+		}
+
+		CurrentBuffer = freeBuffer;
+		Buffers[CurrentBuffer].FirstPacketSeconds = FPlatformTime::Seconds();
+	}
+
+	FCaptureBuffer& buffer = Buffers[CurrentBuffer];
+	if (record.TimestampTicks >= NextIndexTicks)
+	{
+		buffer.IndexEntries.Add({ record.TimestampTicks, buffer.NumBytes });
+		NextIndexTicks = record.TimestampTicks + IndexIntervalTicks;
+	}
+
+	FMemory::Memcpy(buffer.Bytes.GetData() + buffer.NumBytes, &record, sizeof(FDISCaptureRecordHeader));
+	FMemory::Memcpy(buffer.Bytes.GetData() + buffer.NumBytes + sizeof(FDISCaptureRecordHeader), Bytes.GetData(), Bytes.Num());
+	buffer.NumBytes += recordBytes;
+	buffer.NumPackets++;
+}
+
+uint32 FDISCaptureWriter::Run()
+{
+	const uint32 flushIntervalMilliseconds = static_cast<uint32>(FlushIntervalSeconds * 1000);
+
+	bool stopping = false;
+	while (!stopping)
+	{
+		//Read before draining so everything captured before the stop request is written on the last pass
+		stopping = StopRequested;
+		if (!stopping)
+		{
+			WakeEvent->Wait(flushIntervalMilliseconds);
+		}
+
+		HandOverCurrentBuffer(stopping);
+
+		int32 bufferIndex;
+		while (FullBuffers.Dequeue(bufferIndex))
+		{
+			FCaptureBuffer& buffer = Buffers[bufferIndex];
+			WriteBuffer(buffer);
+
+			buffer.NumBytes = 0;
+			buffer.NumPackets = 0;
+			buffer.IndexEntries.Reset();
+			FreeBuffers.Enqueue(bufferIndex);
+		}
+
+		if (SegmentFile != nullptr)
+		{
+			SegmentFile->Flush();
+		}
+		if (IndexFile != nullptr)
+		{
+			IndexFile->Flush();
+		}
+	}
+
+	return 0;
+}
+
+void FDISCaptureWriter::Stop()
+{
+	StopRequested = true;
+
+	if (WakeEvent != nullptr)
+	{
+		WakeEvent->Trigger();
+	}
+}
+
+void FDISCaptureWriter::HandOverCurrentBuffer(bool Force)
+{
+	FScopeLock lock(&ProducerLock);
+
+	if (CurrentBuffer != INDEX_NONE && Buffers[CurrentBuffer].NumBytes > 0
+		&& (Force || FPlatformTime::Seconds() - Buffers[CurrentBuffer].FirstPacketSeconds >= FlushIntervalSeconds))
+	{
+		FullBuffers.Enqueue(CurrentBuffer);
+		CurrentBuffer = INDEX_NONE;
+	}
+}
+
+void FDISCaptureWriter::WriteBuffer(FCaptureBuffer& Buffer)
+{
+	if (Buffer.NumBytes == 0)
+	{
+		return;
+	}
+
+	const uint8* writeData = Buffer.Bytes.GetData();
+	int64 writeBytes = Buffer.NumBytes;
+	if (Format == EDISCaptureFormat::Pcap)
+	{
+		ConvertBufferToPcap(Buffer);
+		writeData = PcapBytes.GetData();
+		writeBytes = PcapBytes.Num();
+	}
+
+	//Buffers only hold whole records, so segments always end on a record boundary
+	if (SegmentFile != nullptr && SegmentBytesWritten > SegmentHeaderBytes && SegmentBytesWritten + writeBytes > MaxSegmentBytes)
+	{
+		CloseSegment();
+		OpenSegment(SegmentNumber + 1);
+	}
+
+	if (SegmentFile == nullptr)
+	{
+		PacketsDropped.Add(Buffer.NumPackets);
+		return;
+	}
+
+	//Every segment's index starts at its first record
+	PendingIndexEntries.Reset();
+	if (Format == EDISCaptureFormat::CaptureLog)
+	{
+		if (SegmentBytesWritten == SegmentHeaderBytes)
+		{
+			FDISCaptureIndexEntry firstEntry;
+			FMemory::Memcpy(&firstEntry.TimestampTicks, Buffer.Bytes.GetData(), sizeof(firstEntry.TimestampTicks));
+			firstEntry.FileOffset = SegmentBytesWritten;
+			PendingIndexEntries.Add(firstEntry);
+		}
+		for (const FDISCaptureIndexEntry& entry : Buffer.IndexEntries)
+		{
+			if (PendingIndexEntries.Num() == 0 || SegmentBytesWritten + entry.FileOffset > PendingIndexEntries.Last().FileOffset)
+			{
+				PendingIndexEntries.Add({ entry.TimestampTicks, SegmentBytesWritten + entry.FileOffset });
+			}
+		}
+	}
+
+	if (!SegmentFile->Write(writeData, writeBytes))
+	{
+		if (!WriteErrorLogged)
+		{
+			UE_LOG(LogDISCapture, Error, TEXT("Failed to write to capture segment %d of %s. Packets are being dropped."), SegmentNumber, *CaptureName);
+			WriteErrorLogged = true;
+		}
+		PacketsDropped.Add(Buffer.NumPackets);
+		return;
+	}
+
+	if (IndexFile != nullptr && PendingIndexEntries.Num() > 0)
+	{
+		IndexFile->Write(reinterpret_cast<const uint8*>(PendingIndexEntries.GetData()), PendingIndexEntries.Num() * sizeof(FDISCaptureIndexEntry));
+	}
+
+	if (KeyframeWriter.IsValid())
+	{
+		AddBufferToKeyframes(Buffer, SegmentBytesWritten);
+	}
+
+	SegmentBytesWritten += writeBytes;
+	PacketsWritten.Add(Buffer.NumPackets);
+	BytesWritten.Add(writeBytes);
+}
+
+void FDISCaptureWriter::AddBufferToKeyframes(const FCaptureBuffer& Buffer, int64 SegmentOffset)
+{
+	FDISCaptureReader::FPosition position;
+	position.Segment = SegmentNumber;
+
+	int32 offset = 0;
+	FDISCaptureRecordHeader record;
+	while (offset + static_cast<int32>(sizeof(record)) <= Buffer.NumBytes)
+	{
+		FMemory::Memcpy(&record, Buffer.Bytes.GetData() + offset, sizeof(record));
+		position.Offset = SegmentOffset + offset;
+		KeyframeWriter->AddDatagram(record, TArrayView<const uint8>(Buffer.Bytes.GetData() + offset + sizeof(record), record.PayloadBytes), position);
+		offset += sizeof(record) + record.PayloadBytes;
+	}
+}
+
+void FDISCaptureWriter::ConvertBufferToPcap(const FCaptureBuffer& Buffer)
+{
+	static const int64 unixEpochTicks = FDateTime(1970, 1, 1).GetTicks();
+	constexpr int32 packetHeaderBytes = DISCaptureWriterPcap::IPv4HeaderBytes + DISCaptureWriterPcap::UDPHeaderBytes;
+
+	TMap<uint16, FIPv4Endpoint> receiveEndpoints;
+	{
+		FScopeLock lock(&ProducerLock);
+		receiveEndpoints = ReceiveEndpoints;
+	}
+
+	PcapBytes.Reset();
+	PcapBytes.Reserve(Buffer.NumBytes + Buffer.NumPackets * (DISCaptureWriterPcap::RecordHeaderBytes + packetHeaderBytes));
+
+	int32 offset = 0;
+	while (offset + static_cast<int32>(sizeof(FDISCaptureRecordHeader)) <= Buffer.NumBytes)
+	{
+		FDISCaptureRecordHeader record;
+		FMemory::Memcpy(&record, Buffer.Bytes.GetData() + offset, sizeof(record));
+		const uint8* payload = Buffer.Bytes.GetData() + offset + sizeof(record);
+		offset += sizeof(record) + record.PayloadBytes;
+
+		const FIPv4Endpoint* receiver = receiveEndpoints.Find(record.ReceiveSocketID);
+		const uint32 packetBytes = packetHeaderBytes + record.PayloadBytes;
+		const int64 sinceEpochTicks = record.TimestampTicks - unixEpochTicks;
+
+		//Record header in native byte order, matching the magic in the file header
+		uint8 headers[DISCaptureWriterPcap::RecordHeaderBytes + packetHeaderBytes] = {};
+		const uint32 recordHeader[4] = {
+			static_cast<uint32>(sinceEpochTicks / ETimespan::TicksPerSecond),
+			static_cast<uint32>(sinceEpochTicks % ETimespan::TicksPerSecond * ETimespan::NanosecondsPerTick),
+			packetBytes,
+			packetBytes };
+		FMemory::Memcpy(headers, recordHeader, sizeof(recordHeader));
+
+		uint8* ipHeader = headers + DISCaptureWriterPcap::RecordHeaderBytes;
+		ipHeader[0] = 0x45;
+		DISCaptureWriterPcap::WriteBigEndian16(ipHeader + 2, static_cast<uint16>(packetBytes));
+		//Don't fragment
+		DISCaptureWriterPcap::WriteBigEndian16(ipHeader + 6, 0x4000);
+		ipHeader[8] = 64;
+		ipHeader[9] = 17;
+		DISCaptureWriterPcap::WriteBigEndian32(ipHeader + 12, record.SourceAddress);
+		DISCaptureWriterPcap::WriteBigEndian32(ipHeader + 16, receiver != nullptr ? receiver->Address.Value : 0);
+
+		uint32 checksum = 0;
+		for (int32 i = 0; i < DISCaptureWriterPcap::IPv4HeaderBytes; i += 2)
+		{
+			checksum += (ipHeader[i] << 8) | ipHeader[i + 1];
+		}
+		checksum = (checksum & 0xFFFF) + (checksum >> 16);
+		checksum = (checksum & 0xFFFF) + (checksum >> 16);
+		DISCaptureWriterPcap::WriteBigEndian16(ipHeader + 10, static_cast<uint16>(~checksum));
+
+		//The UDP checksum is optional over IPv4 and left zero
+		uint8* udpHeader = ipHeader + DISCaptureWriterPcap::IPv4HeaderBytes;
+		DISCaptureWriterPcap::WriteBigEndian16(udpHeader, record.SourcePort);
+		DISCaptureWriterPcap::WriteBigEndian16(udpHeader + 2, receiver != nullptr ? receiver->Port : 0);
+		DISCaptureWriterPcap::WriteBigEndian16(udpHeader + 4, static_cast<uint16>(DISCaptureWriterPcap::UDPHeaderBytes + record.PayloadBytes));
+
+		PcapBytes.Append(headers, sizeof(headers));
+		PcapBytes.Append(payload, record.PayloadBytes);
+	}
+}
+
+bool FDISCaptureWriter::OpenSegment(int32 Segment)
+{
+	IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+	SegmentNumber = Segment;
+
+	if (Format == EDISCaptureFormat::Pcap)
+	{
+		SegmentFile = platformFile.OpenWrite(*DISCaptureLog::GetSegmentPath(Directory, CaptureName, Segment, DISCaptureLog::PcapExtension));
+		if (SegmentFile == nullptr)
+		{
+			UE_LOG(LogDISCapture, Error, TEXT("Failed to open capture segment %d of %s in %s."), Segment, *CaptureName, *Directory);
+			return false;
+		}
+
+		//Native byte order, readers tell from the magic
+		uint8 pcapHeader[DISCaptureWriterPcap::FileHeaderBytes] = {};
+		const uint32 magic = DISCaptureWriterPcap::NanosecondMagic;
+		const uint16 version[2] = { 2, 4 };
+		const uint32 snapLength = 262144;
+		const uint32 linkType = DISCaptureWriterPcap::LinkTypeIPv4;
+		FMemory::Memcpy(pcapHeader, &magic, sizeof(magic));
+		FMemory::Memcpy(pcapHeader + 4, version, sizeof(version));
+		FMemory::Memcpy(pcapHeader + 16, &snapLength, sizeof(snapLength));
+		FMemory::Memcpy(pcapHeader + 20, &linkType, sizeof(linkType));
+		SegmentFile->Write(pcapHeader, sizeof(pcapHeader));
+		SegmentHeaderBytes = sizeof(pcapHeader);
+	}
+	else
+	{
+		SegmentFile = platformFile.OpenWrite(*DISCaptureLog::GetSegmentPath(Directory, CaptureName, Segment, DISCaptureLog::SegmentExtension));
+		IndexFile = platformFile.OpenWrite(*DISCaptureLog::GetSegmentPath(Directory, CaptureName, Segment, DISCaptureLog::IndexExtension));
+
+		if (SegmentFile == nullptr || IndexFile == nullptr)
+		{
+			UE_LOG(LogDISCapture, Error, TEXT("Failed to open capture segment %d of %s in %s."), Segment, *CaptureName, *Directory);
+			CloseSegment();
+			return false;
+		}
+
+		const int64 createdTicks = FDateTime::UtcNow().GetTicks();
+		const FDISCaptureFileHeader segmentHeader = FDISCaptureFileHeader::Make(DISCaptureLog::LogKind, Segment, createdTicks);
+		const FDISCaptureFileHeader indexHeader = FDISCaptureFileHeader::Make(DISCaptureLog::IndexKind, Segment, createdTicks);
+		SegmentFile->Write(reinterpret_cast<const uint8*>(&segmentHeader), sizeof(segmentHeader));
+		IndexFile->Write(reinterpret_cast<const uint8*>(&indexHeader), sizeof(indexHeader));
+		SegmentHeaderBytes = sizeof(segmentHeader);
+	}
+
+	SegmentBytesWritten = SegmentHeaderBytes;
+	SegmentsWritten.Increment();
+
+	return true;
+}
+
+void FDISCaptureWriter::CloseSegment()
+{
+	delete SegmentFile;
+	SegmentFile = nullptr;
+	delete IndexFile;
+	IndexFile = nullptr;
+}
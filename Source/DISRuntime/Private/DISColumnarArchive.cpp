@@ -0,0 +1,855 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISColumnarArchive.h"
+#include "DISCaptureReader.h"
+#include "Algo/BinarySearch.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/Compression.h"
+
+DEFINE_LOG_CATEGORY(LogDISArchive);
+
+namespace DISColumnarEncoding
+{
+	constexpr uint8 EntityStateType = 1;
+	constexpr int32 PDUTypeOffset = 2;
+	constexpr int32 PDUTimestampOffset = 4;
+	constexpr int32 EntityIDOffset = 12;
+	constexpr int32 EntityIDBytes = 6;
+	//Entity State PDU without variable parameter records
+	constexpr int32 EntityStateBytes = 144;
+	//Keeps every size in a block within 32 bits
+	constexpr int64 MaxBlockRecordBytes = 64 * 1024 * 1024;
+	//Source address, port, receive socket, and reserved of the record header
+	constexpr int32 SourcesOffset = 12;
+	constexpr int32 SourcesBytes = 12;
+
+	//Previous Entity State PDU of an entity seen for the first time
+	const uint8 EmptyEntityState[EntityStateBytes] = {};
+
+	struct FFieldColumn
+	{
+		DISColumnarFormat::EColumn Column;
+		int32 Offset;
+		int32 Width;
+	};
+
+	//Every byte of an Entity State PDU except the entity ID and timestamp, which have their own columns
+	const FFieldColumn FieldColumns[] =
+	{
+		{ DISColumnarFormat::PDUHeader, 0, 4 },
+		{ DISColumnarFormat::PDULength, 8, 4 },
+		//Force ID, number of variable parameters, entity type, and alternative entity type
+		{ DISColumnarFormat::EntityInfo, 18, 18 },
+		{ DISColumnarFormat::Velocity, 36, 12 },
+		{ DISColumnarFormat::Location, 48, 24 },
+		{ DISColumnarFormat::Orientation, 72, 12 },
+		{ DISColumnarFormat::Appearance, 84, 4 },
+		{ DISColumnarFormat::DeadReckoning, 88, 40 },
+		//Marking and capabilities
+		{ DISColumnarFormat::Marking, 128, 16 }
+	};
+
+	/**
+	 * Width of the entries of a fixed width column, or 0 for a variable width one.
+	 */
+	int32 GetFixedWidth(int32 Column)
+	{
+		if (Column == DISColumnarFormat::Sources)
+		{
+			return SourcesBytes;
+		}
+		for (const FFieldColumn& fieldColumn : FieldColumns)
+		{
+			if (fieldColumn.Column == Column)
+			{
+				return fieldColumn.Width;
+			}
+		}
+		return 0;
+	}
+
+	FName GetCodecName(uint8 Codec)
+	{
+		switch (static_cast<EDISArchiveCodec>(Codec))
+		{
+		case EDISArchiveCodec::LZ4:
+			return NAME_LZ4;
+		case EDISArchiveCodec::Zlib:
+			return NAME_Zlib;
+		default:
+			return NAME_None;
+		}
+	}
+
+	inline uint32 ReadBigEndian32(const uint8* Bytes)
+	{
+		return (static_cast<uint32>(Bytes[0]) << 24) | (static_cast<uint32>(Bytes[1]) << 16) | (static_cast<uint32>(Bytes[2]) << 8) | Bytes[3];
+	}
+
+	inline void WriteBigEndian32(uint8* Bytes, uint32 Value)
+	{
+		Bytes[0] = static_cast<uint8>(Value >> 24);
+		Bytes[1] = static_cast<uint8>(Value >> 16);
+		Bytes[2] = static_cast<uint8>(Value >> 8);
+		Bytes[3] = static_cast<uint8>(Value);
+	}
+
+	inline uint64 ZigZagEncode(int64 Value)
+	{
+		return (static_cast<uint64>(Value) << 1) ^ static_cast<uint64>(Value >> 63);
+	}
+
+	inline int64 ZigZagDecode(uint64 Value)
+	{
+		return static_cast<int64>(Value >> 1) ^ -static_cast<int64>(Value & 1);
+	}
+
+	inline void WriteVarint(TArray<uint8>& Column, uint64 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Column.Add(static_cast<uint8>(Value) | 0x80);
+			Value >>= 7;
+		}
+		Column.Add(static_cast<uint8>(Value));
+	}
+
+	inline void AppendXor(TArray<uint8>& Column, const uint8* Bytes, const uint8* PreviousBytes, int32 NumBytes)
+	{
+		uint8* out = Column.GetData() + Column.AddUninitialized(NumBytes);
+		for (int32 i = 0; i < NumBytes; i++)
+		{
+			out[i] = Bytes[i] ^ PreviousBytes[i];
+		}
+	}
+
+	/**
+	 * Moves byte i of every entry of a fixed width column to row i, or back again when Untranspose is set.
+	 */
+	void Transpose(const TArray<uint8>& Column, int32 Width, bool Untranspose, TArray<uint8>& OutColumn)
+	{
+		const int32 numEntries = Column.Num() / Width;
+		OutColumn.SetNumUninitialized(Column.Num(), false);
+		const uint8* in = Column.GetData();
+		uint8* out = OutColumn.GetData();
+		for (int32 entry = 0; entry < numEntries; entry++)
+		{
+			for (int32 byte = 0; byte < Width; byte++)
+			{
+				if (Untranspose)
+				{
+					out[entry * Width + byte] = in[byte * numEntries + entry];
+				}
+				else
+				{
+					out[byte * numEntries + entry] = in[entry * Width + byte];
+				}
+			}
+		}
+	}
+
+	/**
+	 * Bounds checked reading from a decoded column.
+	 */
+	struct FColumnReader
+	{
+		const TArray<uint8>* Column = nullptr;
+		int32 Offset = 0;
+
+		explicit FColumnReader(const TArray<uint8>& InColumn) : Column(&InColumn) {}
+
+		const uint8* Take(int32 NumBytes)
+		{
+			if (NumBytes < 0 || Offset + NumBytes > Column->Num())
+			{
+				return nullptr;
+			}
+			const uint8* bytes = Column->GetData() + Offset;
+			Offset += NumBytes;
+			return bytes;
+		}
+
+		bool ReadVarint(uint64& OutValue)
+		{
+			OutValue = 0;
+			for (int32 shift = 0; shift < 64 && Offset < Column->Num(); shift += 7)
+			{
+				const uint8 byte = (*Column)[Offset++];
+				OutValue |= static_cast<uint64>(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+	};
+}
+
+void FDISColumnarBlockEncoder::Reset()
+{
+	for (TArray<uint8>& column : Columns)
+	{
+		column.Reset();
+	}
+	EntitySlots.Reset();
+	SlotPDUs.Reset();
+	NumRecords = 0;
+	RecordBytes = 0;
+}
+
+void FDISColumnarBlockEncoder::AddDatagram(const FDISCaptureRecordHeader& Record, TArrayView<const uint8> Payload)
+{
+	using namespace DISColumnarEncoding;
+
+	if (NumRecords == 0)
+	{
+		FirstTicks = Record.TimestampTicks;
+		FMemory::Memzero(PreviousRecord);
+		PreviousRecord.TimestampTicks = FirstTicks;
+	}
+
+	const uint8* pdu = Payload.GetData();
+	const bool isEntityState = Payload.Num() >= EntityStateBytes && pdu[PDUTypeOffset] == EntityStateType;
+	DISColumnarFormat::ERecordKind kind = DISColumnarFormat::RawDatagram;
+
+	if (isEntityState)
+	{
+		const uint8* id = pdu + EntityIDOffset;
+		const uint64 entityKey = (static_cast<uint64>(pdu[1]) << 48) | (static_cast<uint64>(id[0]) << 40) | (static_cast<uint64>(id[1]) << 32)
+			| (static_cast<uint64>(id[2]) << 24) | (static_cast<uint64>(id[3]) << 16) | (static_cast<uint64>(id[4]) << 8) | id[5];
+
+		const uint8* previous = EmptyEntityState;
+		int32 previousVariableBytes = 0;
+		int32 slot;
+		if (const int32* knownSlot = EntitySlots.Find(entityKey))
+		{
+			slot = *knownSlot;
+			kind = DISColumnarFormat::EntityState;
+			previous = SlotPDUs[slot].GetData();
+			previousVariableBytes = SlotPDUs[slot].Num() - EntityStateBytes;
+			WriteVarint(Columns[DISColumnarFormat::EntityRefs], slot);
+		}
+		else
+		{
+			slot = SlotPDUs.AddDefaulted();
+			kind = DISColumnarFormat::NewEntityState;
+			EntitySlots.Add(entityKey, slot);
+			Columns[DISColumnarFormat::EntityRefs].Append(id, EntityIDBytes);
+		}
+
+		const int32 timestampDelta = static_cast<int32>(ReadBigEndian32(pdu + PDUTimestampOffset) - ReadBigEndian32(previous + PDUTimestampOffset));
+		WriteVarint(Columns[DISColumnarFormat::PDUTimestamps], ZigZagEncode(timestampDelta));
+
+		for (const FFieldColumn& fieldColumn : FieldColumns)
+		{
+			AppendXor(Columns[fieldColumn.Column], pdu + fieldColumn.Offset, previous + fieldColumn.Offset, fieldColumn.Width);
+		}
+
+		const int32 variableBytes = Payload.Num() - EntityStateBytes;
+		if (variableBytes > 0)
+		{
+			if (variableBytes == previousVariableBytes)
+			{
+				AppendXor(Columns[DISColumnarFormat::Articulations], pdu + EntityStateBytes, previous + EntityStateBytes, variableBytes);
+			}
+			else
+			{
+				Columns[DISColumnarFormat::Articulations].Append(pdu + EntityStateBytes, variableBytes);
+			}
+		}
+
+		TArray<uint8>& slotPDU = SlotPDUs[slot];
+		slotPDU.SetNumUninitialized(Payload.Num(), false);
+		FMemory::Memcpy(slotPDU.GetData(), pdu, Payload.Num());
+	}
+	else
+	{
+		Columns[DISColumnarFormat::Raw].Append(pdu, Payload.Num());
+	}
+
+	TArray<uint8>& records = Columns[DISColumnarFormat::Records];
+	WriteVarint(records, ZigZagEncode(Record.TimestampTicks - PreviousRecord.TimestampTicks));
+	WriteVarint(records, Payload.Num());
+	records.Add(kind);
+
+	AppendXor(Columns[DISColumnarFormat::Sources], reinterpret_cast<const uint8*>(&Record) + SourcesOffset, reinterpret_cast<const uint8*>(&PreviousRecord) + SourcesOffset, SourcesBytes);
+
+	PreviousRecord = Record;
+	NumRecords++;
+	RecordBytes += sizeof(FDISCaptureRecordHeader) + Payload.Num();
+}
+
+void FDISColumnarBlockEncoder::FinishBlock(EDISArchiveCodec Codec, TArray<uint8>& OutBlock)
+{
+	using namespace DISColumnarEncoding;
+
+	const FName codecName = GetCodecName(static_cast<uint8>(Codec));
+	const int32 tableOffset = sizeof(FDISArchiveBlockHeader);
+	const int32 columnsOffset = tableOffset + DISColumnarFormat::NumColumns * sizeof(FDISArchiveColumnHeader);
+
+	OutBlock.Reset();
+	OutBlock.AddUninitialized(columnsOffset);
+
+	for (int32 columnIndex = 0; columnIndex < DISColumnarFormat::NumColumns; columnIndex++)
+	{
+		TArray<uint8>* column = &Columns[columnIndex];
+		const int32 width = GetFixedWidth(columnIndex);
+		if (width > 0)
+		{
+			Transpose(*column, width, false, TransposedBytes);
+			column = &TransposedBytes;
+		}
+
+		FDISArchiveColumnHeader columnHeader;
+		columnHeader.RawBytes = column->Num();
+		columnHeader.StoredBytes = column->Num();
+
+		//Columns that do not shrink, such as empty or already compressed ones, are stored as is
+		if (codecName != NAME_None && column->Num() > 0)
+		{
+			int32 compressedBytes = FCompression::CompressMemoryBound(codecName, column->Num());
+			CompressedBytes.SetNumUninitialized(compressedBytes, false);
+			if (FCompression::CompressMemory(codecName, CompressedBytes.GetData(), compressedBytes, column->GetData(), column->Num()) && compressedBytes < column->Num())
+			{
+				columnHeader.StoredBytes = compressedBytes;
+			}
+		}
+
+		if (columnHeader.StoredBytes < columnHeader.RawBytes)
+		{
+			OutBlock.Append(CompressedBytes.GetData(), columnHeader.StoredBytes);
+		}
+		else
+		{
+			OutBlock.Append(column->GetData(), column->Num());
+		}
+		FMemory::Memcpy(OutBlock.GetData() + tableOffset + columnIndex * sizeof(FDISArchiveColumnHeader), &columnHeader, sizeof(columnHeader));
+	}
+
+	FDISArchiveBlockHeader header;
+	header.FirstTicks = FirstTicks;
+	header.LastTicks = PreviousRecord.TimestampTicks;
+	header.NumRecords = NumRecords;
+	header.RecordBytes = static_cast<uint32>(RecordBytes);
+	header.StoredBytes = OutBlock.Num() - columnsOffset;
+	header.Codec = static_cast<uint8>(Codec);
+	header.NumColumns = DISColumnarFormat::NumColumns;
+	header.Reserved = 0;
+	FMemory::Memcpy(OutBlock.GetData(), &header, sizeof(header));
+
+	Reset();
+}
+
+bool FDISColumnarBlockDecoder::DecodeBlock(TArrayView<const uint8> Block, TArray<uint8>& OutRecords)
+{
+	using namespace DISColumnarEncoding;
+
+	FDISArchiveBlockHeader header;
+	const int32 tableOffset = sizeof(FDISArchiveBlockHeader);
+	const int32 columnsOffset = tableOffset + DISColumnarFormat::NumColumns * sizeof(FDISArchiveColumnHeader);
+	if (Block.Num() < columnsOffset)
+	{
+		return false;
+	}
+	FMemory::Memcpy(&header, Block.GetData(), sizeof(header));
+	if (header.NumColumns != DISColumnarFormat::NumColumns || header.Codec > static_cast<uint8>(EDISArchiveCodec::Zlib)
+		|| header.RecordBytes > MaxBlockRecordBytes + sizeof(FDISCaptureRecordHeader) + UINT16_MAX || columnsOffset + static_cast<int64>(header.StoredBytes) > Block.Num())
+	{
+		return false;
+	}
+
+	const FName codecName = GetCodecName(header.Codec);
+	int64 storedOffset = columnsOffset;
+	for (int32 columnIndex = 0; columnIndex < DISColumnarFormat::NumColumns; columnIndex++)
+	{
+		FDISArchiveColumnHeader columnHeader;
+		FMemory::Memcpy(&columnHeader, Block.GetData() + tableOffset + columnIndex * sizeof(FDISArchiveColumnHeader), sizeof(columnHeader));
+		if (storedOffset + columnHeader.StoredBytes > columnsOffset + static_cast<int64>(header.StoredBytes) || columnHeader.RawBytes > header.RecordBytes
+			|| columnHeader.StoredBytes > columnHeader.RawBytes)
+		{
+			return false;
+		}
+
+		TArray<uint8>& column = Columns[columnIndex];
+		column.SetNumUninitialized(columnHeader.RawBytes, false);
+		const uint8* stored = Block.GetData() + storedOffset;
+		if (columnHeader.StoredBytes == columnHeader.RawBytes)
+		{
+			FMemory::Memcpy(column.GetData(), stored, columnHeader.RawBytes);
+		}
+		else if (codecName == NAME_None || !FCompression::UncompressMemory(codecName, column.GetData(), columnHeader.RawBytes, stored, columnHeader.StoredBytes))
+		{
+			return false;
+		}
+		storedOffset += columnHeader.StoredBytes;
+
+		const int32 width = GetFixedWidth(columnIndex);
+		if (width > 0)
+		{
+			if (column.Num() % width != 0)
+			{
+				return false;
+			}
+			Transpose(column, width, true, TransposedBytes);
+			Swap(column, TransposedBytes);
+		}
+	}
+
+	FColumnReader records(Columns[DISColumnarFormat::Records]);
+	FColumnReader sources(Columns[DISColumnarFormat::Sources]);
+	FColumnReader raw(Columns[DISColumnarFormat::Raw]);
+	FColumnReader entityRefs(Columns[DISColumnarFormat::EntityRefs]);
+	FColumnReader pduTimestamps(Columns[DISColumnarFormat::PDUTimestamps]);
+	FColumnReader articulations(Columns[DISColumnarFormat::Articulations]);
+	TArray<FColumnReader, TInlineAllocator<UE_ARRAY_COUNT(FieldColumns)>> fields;
+	for (const FFieldColumn& fieldColumn : FieldColumns)
+	{
+		fields.Emplace(Columns[fieldColumn.Column]);
+	}
+
+	OutRecords.SetNumUninitialized(header.RecordBytes, false);
+	SlotPDUs.Reset();
+
+	FDISCaptureRecordHeader previousRecord;
+	FMemory::Memzero(previousRecord);
+	previousRecord.TimestampTicks = header.FirstTicks;
+	int64 outOffset = 0;
+
+	for (uint32 recordIndex = 0; recordIndex < header.NumRecords; recordIndex++)
+	{
+		uint64 ticksDelta;
+		uint64 payloadBytes;
+		if (!records.ReadVarint(ticksDelta) || !records.ReadVarint(payloadBytes)
+			|| outOffset + static_cast<int64>(sizeof(FDISCaptureRecordHeader)) + static_cast<int64>(payloadBytes) > OutRecords.Num())
+		{
+			return false;
+		}
+		const uint8* kind = records.Take(1);
+		const uint8* sourceBytes = sources.Take(SourcesBytes);
+		if (kind == nullptr || sourceBytes == nullptr)
+		{
+			return false;
+		}
+
+		FDISCaptureRecordHeader record = previousRecord;
+		record.TimestampTicks = previousRecord.TimestampTicks + ZigZagDecode(ticksDelta);
+		record.PayloadBytes = static_cast<uint32>(payloadBytes);
+		uint8* recordSources = reinterpret_cast<uint8*>(&record) + SourcesOffset;
+		for (int32 i = 0; i < SourcesBytes; i++)
+		{
+			recordSources[i] ^= sourceBytes[i];
+		}
+
+		uint8* pdu = OutRecords.GetData() + outOffset + sizeof(FDISCaptureRecordHeader);
+		const int32 numBytes = static_cast<int32>(payloadBytes);
+		if (*kind == DISColumnarFormat::RawDatagram)
+		{
+			const uint8* rawBytes = raw.Take(numBytes);
+			if (rawBytes == nullptr)
+			{
+				return false;
+			}
+			FMemory::Memcpy(pdu, rawBytes, numBytes);
+		}
+		else if (*kind == DISColumnarFormat::NewEntityState || *kind == DISColumnarFormat::EntityState)
+		{
+			if (numBytes < EntityStateBytes)
+			{
+				return false;
+			}
+
+			const uint8* previous = EmptyEntityState;
+			int32 previousVariableBytes = 0;
+			int32 slot;
+			if (*kind == DISColumnarFormat::NewEntityState)
+			{
+				const uint8* id = entityRefs.Take(EntityIDBytes);
+				if (id == nullptr)
+				{
+					return false;
+				}
+				slot = SlotPDUs.AddDefaulted();
+				FMemory::Memcpy(pdu + EntityIDOffset, id, EntityIDBytes);
+			}
+			else
+			{
+				uint64 knownSlot;
+				if (!entityRefs.ReadVarint(knownSlot) || knownSlot >= static_cast<uint64>(SlotPDUs.Num()))
+				{
+					return false;
+				}
+				slot = static_cast<int32>(knownSlot);
+				previous = SlotPDUs[slot].GetData();
+				previousVariableBytes = SlotPDUs[slot].Num() - EntityStateBytes;
+				FMemory::Memcpy(pdu + EntityIDOffset, previous + EntityIDOffset, EntityIDBytes);
+			}
+
+			uint64 timestampDelta;
+			if (!pduTimestamps.ReadVarint(timestampDelta))
+			{
+				return false;
+			}
+			WriteBigEndian32(pdu + PDUTimestampOffset, ReadBigEndian32(previous + PDUTimestampOffset) + static_cast<uint32>(ZigZagDecode(timestampDelta)));
+
+			for (int32 fieldIndex = 0; fieldIndex < fields.Num(); fieldIndex++)
+			{
+				const FFieldColumn& fieldColumn = FieldColumns[fieldIndex];
+				const uint8* fieldBytes = fields[fieldIndex].Take(fieldColumn.Width);
+				if (fieldBytes == nullptr)
+				{
+					return false;
+				}
+				for (int32 i = 0; i < fieldColumn.Width; i++)
+				{
+					pdu[fieldColumn.Offset + i] = fieldBytes[i] ^ previous[fieldColumn.Offset + i];
+				}
+			}
+
+			const int32 variableBytes = numBytes - EntityStateBytes;
+			if (variableBytes > 0)
+			{
+				const uint8* variableParameters = articulations.Take(variableBytes);
+				if (variableParameters == nullptr)
+				{
+					return false;
+				}
+				for (int32 i = 0; i < variableBytes; i++)
+				{
+					pdu[EntityStateBytes + i] = variableBytes == previousVariableBytes ? variableParameters[i] ^ previous[EntityStateBytes + i] : variableParameters[i];
+				}
+			}
+
+			TArray<uint8>& slotPDU = SlotPDUs[slot];
+			slotPDU.SetNumUninitialized(numBytes, false);
+			FMemory::Memcpy(slotPDU.GetData(), pdu, numBytes);
+		}
+		else
+		{
+			return false;
+		}
+
+		FMemory::Memcpy(OutRecords.GetData() + outOffset, &record, sizeof(record));
+		outOffset += sizeof(record) + numBytes;
+		previousRecord = record;
+	}
+
+	return outOffset == OutRecords.Num();
+}
+
+FDISColumnarArchiveWriter::~FDISColumnarArchiveWriter()
+{
+	Close();
+}
+
+bool FDISColumnarArchiveWriter::Open(const FString& FilePath, EDISArchiveCodec InCodec, int32 InBlockRecords)
+{
+	Close();
+
+	File = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*FilePath);
+	if (File == nullptr)
+	{
+		UE_LOG(LogDISArchive, Error, TEXT("Could not create archive %s."), *FilePath);
+		return false;
+	}
+
+	const FDISCaptureFileHeader fileHeader = FDISCaptureFileHeader::Make(DISCaptureLog::ArchiveKind, 0, FDateTime::UtcNow().GetTicks());
+	File->Write(reinterpret_cast<const uint8*>(&fileHeader), sizeof(fileHeader));
+
+	Codec = InCodec;
+	BlockRecords = FMath::Max(InBlockRecords, 1);
+	RecordBytes = 0;
+	ArchiveBytes = sizeof(fileHeader);
+	EncodeSeconds = 0;
+
+	return true;
+}
+
+void FDISColumnarArchiveWriter::Close()
+{
+	if (File == nullptr)
+	{
+		return;
+	}
+
+	WriteBlock();
+	delete File;
+	File = nullptr;
+}
+
+void FDISColumnarArchiveWriter::AddDatagram(const FDISCaptureRecordHeader& Record, TArrayView<const uint8> Payload)
+{
+	if (File == nullptr)
+	{
+		return;
+	}
+
+	const uint64 startCycles = FPlatformTime::Cycles64();
+	Encoder.AddDatagram(Record, Payload);
+	RecordBytes += sizeof(FDISCaptureRecordHeader) + Payload.Num();
+	EncodeSeconds += FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - startCycles);
+
+	if (Encoder.GetNumRecords() >= BlockRecords || Encoder.GetRecordBytes() >= DISColumnarEncoding::MaxBlockRecordBytes)
+	{
+		WriteBlock();
+	}
+}
+
+void FDISColumnarArchiveWriter::WriteBlock()
+{
+	if (Encoder.GetNumRecords() == 0)
+	{
+		return;
+	}
+
+	const uint64 startCycles = FPlatformTime::Cycles64();
+	Encoder.FinishBlock(Codec, BlockBytes);
+	EncodeSeconds += FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - startCycles);
+
+	File->Write(BlockBytes.GetData(), BlockBytes.Num());
+	ArchiveBytes += BlockBytes.Num();
+}
+
+bool FDISColumnarArchiveWriter::ArchiveCapture(const FString& Directory, const FString& CaptureName, const FString& ArchivePath, EDISArchiveCodec Codec, FDISArchiveStats& OutStats)
+{
+	OutStats = FDISArchiveStats();
+
+	FDISCaptureReader captureReader;
+	if (!captureReader.Open(Directory, CaptureName))
+	{
+		return false;
+	}
+
+	FDISColumnarArchiveWriter writer;
+	if (!writer.Open(ArchivePath, Codec))
+	{
+		return false;
+	}
+
+	FDISCaptureRecordHeader record;
+	TArrayView<const uint8> payload;
+	while (captureReader.ReadNext(record, payload))
+	{
+		writer.AddDatagram(record, payload);
+		OutStats.Packets++;
+	}
+	writer.Close();
+
+	const double megabyte = 1024. * 1024.;
+	OutStats.RawBytes = writer.GetRecordBytes();
+	OutStats.ArchiveBytes = writer.GetArchiveBytes();
+	OutStats.CompressionRatio = OutStats.ArchiveBytes > 0 ? static_cast<double>(OutStats.RawBytes) / OutStats.ArchiveBytes : 0;
+	OutStats.EncodeMegabytesPerSecond = writer.GetEncodeSeconds() > 0 ? OutStats.RawBytes / writer.GetEncodeSeconds() / megabyte : 0;
+
+	//Decode the archive again and compare every datagram with the capture
+	FDISColumnarArchiveReader archiveReader;
+	if (!archiveReader.Open(ArchivePath))
+	{
+		return false;
+	}
+
+	captureReader.Rewind();
+	int64 numCompared = 0;
+	uint64 decodeCycles = 0;
+	bool matches = true;
+	FDISCaptureRecordHeader archivedRecord;
+	TArrayView<const uint8> archivedPayload;
+	while (matches && captureReader.ReadNext(record, payload))
+	{
+		const uint64 startCycles = FPlatformTime::Cycles64();
+		const bool read = archiveReader.ReadNext(archivedRecord, archivedPayload);
+		decodeCycles += FPlatformTime::Cycles64() - startCycles;
+
+		matches = read && FMemory::Memcmp(&record, &archivedRecord, sizeof(record)) == 0 && payload.Num() == archivedPayload.Num()
+			&& FMemory::Memcmp(payload.GetData(), archivedPayload.GetData(), payload.Num()) == 0;
+		numCompared += matches ? 1 : 0;
+	}
+	matches = matches && !archiveReader.ReadNext(archivedRecord, archivedPayload);
+
+	const double decodeSeconds = FPlatformTime::ToSeconds64(decodeCycles);
+	OutStats.DecodeMegabytesPerSecond = decodeSeconds > 0 ? OutStats.RawBytes / decodeSeconds / megabyte : 0;
+	OutStats.Verified = matches;
+
+	if (matches)
+	{
+		UE_LOG(LogDISArchive, Display, TEXT("Archived %s to %s: %lld packets, %.1f MB to %.1f MB (%.1fx). Encoded at %.0f MB/s, decoded and verified at %.0f MB/s."),
+			*CaptureName, *ArchivePath, OutStats.Packets, OutStats.RawBytes / megabyte, OutStats.ArchiveBytes / megabyte, OutStats.CompressionRatio,
+			OutStats.EncodeMegabytesPerSecond, OutStats.DecodeMegabytesPerSecond);
+	}
+	else
+	{
+		UE_LOG(LogDISArchive, Error, TEXT("Archive %s does not match capture %s at packet %lld."), *ArchivePath, *CaptureName, numCompared);
+	}
+
+	return matches;
+}
+
+FDISColumnarArchiveReader::~FDISColumnarArchiveReader()
+{
+	Close();
+}
+
+bool FDISColumnarArchiveReader::Open(const FString& FilePath)
+{
+	Close();
+
+	File = FPlatformFileManager::Get().GetPlatformFile().OpenRead(*FilePath);
+	if (File == nullptr)
+	{
+		UE_LOG(LogDISArchive, Warning, TEXT("Could not open archive %s."), *FilePath);
+		return false;
+	}
+
+	FDISCaptureFileHeader fileHeader;
+	if (!File->Read(reinterpret_cast<uint8*>(&fileHeader), sizeof(fileHeader)) || !fileHeader.IsValid(DISCaptureLog::ArchiveKind))
+	{
+		UE_LOG(LogDISArchive, Warning, TEXT("%s is not a valid archive."), *FilePath);
+		Close();
+		return false;
+	}
+
+	//Only the block headers are read, a block cut short by a crash ends the archive
+	const int64 fileSize = File->Size();
+	int64 offset = fileHeader.HeaderBytes;
+	FBlock block;
+	while (offset + static_cast<int64>(sizeof(FDISArchiveBlockHeader)) <= fileSize && File->Seek(offset)
+		&& File->Read(reinterpret_cast<uint8*>(&block.Header), sizeof(FDISArchiveBlockHeader)))
+	{
+		const int64 blockBytes = sizeof(FDISArchiveBlockHeader) + block.Header.NumColumns * sizeof(FDISArchiveColumnHeader) + static_cast<int64>(block.Header.StoredBytes);
+		if (offset + blockBytes > fileSize)
+		{
+			break;
+		}
+
+		block.FileOffset = offset;
+		Blocks.Add(block);
+		offset += blockBytes;
+	}
+
+	if (Blocks.Num() == 0)
+	{
+		UE_LOG(LogDISArchive, Warning, TEXT("Archive %s has no blocks."), *FilePath);
+		Close();
+		return false;
+	}
+
+	Rewind();
+	return true;
+}
+
+void FDISColumnarArchiveReader::Close()
+{
+	delete File;
+	File = nullptr;
+	Blocks.Reset();
+	Records.Reset();
+	CurrentBlock = INDEX_NONE;
+	RecordOffset = 0;
+}
+
+bool FDISColumnarArchiveReader::LoadBlock(int32 Block)
+{
+	for (; Blocks.IsValidIndex(Block); Block++)
+	{
+		const FBlock& block = Blocks[Block];
+		const int64 blockBytes = sizeof(FDISArchiveBlockHeader) + block.Header.NumColumns * sizeof(FDISArchiveColumnHeader) + static_cast<int64>(block.Header.StoredBytes);
+		BlockBytes.SetNumUninitialized(static_cast<int32>(blockBytes), false);
+		if (File->Seek(block.FileOffset) && File->Read(BlockBytes.GetData(), blockBytes) && Decoder.DecodeBlock(BlockBytes, Records) && Records.Num() > 0)
+		{
+			CurrentBlock = Block;
+			RecordOffset = 0;
+			return true;
+		}
+
+		UE_LOG(LogDISArchive, Warning, TEXT("Skipping damaged archive block %d."), Block);
+	}
+
+	CurrentBlock = Blocks.Num();
+	Records.Reset();
+	RecordOffset = 0;
+	return false;
+}
+
+bool FDISColumnarArchiveReader::SkipToReadableRecord()
+{
+	if (RecordOffset + static_cast<int32>(sizeof(FDISCaptureRecordHeader)) <= Records.Num())
+	{
+		return true;
+	}
+
+	return LoadBlock(CurrentBlock + 1);
+}
+
+bool FDISColumnarArchiveReader::ReadNext(FDISCaptureRecordHeader& OutRecord, TArrayView<const uint8>& OutPayload)
+{
+	if (!SkipToReadableRecord())
+	{
+		return false;
+	}
+
+	//Decoded blocks only hold whole records
+	FMemory::Memcpy(&OutRecord, Records.GetData() + RecordOffset, sizeof(OutRecord));
+	OutPayload = TArrayView<const uint8>(Records.GetData() + RecordOffset + sizeof(OutRecord), OutRecord.PayloadBytes);
+	RecordOffset += sizeof(OutRecord) + OutRecord.PayloadBytes;
+
+	return true;
+}
+
+bool FDISColumnarArchiveReader::PeekNextTicks(int64& OutTicks)
+{
+	if (!SkipToReadableRecord())
+	{
+		return false;
+	}
+
+	FMemory::Memcpy(&OutTicks, Records.GetData() + RecordOffset, sizeof(OutTicks));
+	return true;
+}
+
+void FDISColumnarArchiveReader::SeekToTicks(int64 Ticks)
+{
+	if (!IsOpen())
+	{
+		return;
+	}
+
+	const int32 block = FMath::Max(Algo::UpperBoundBy(Blocks, Ticks, [](const FBlock& Block) { return Block.Header.FirstTicks; }) - 1, 0);
+	if (block == CurrentBlock)
+	{
+		RecordOffset = 0;
+	}
+	else
+	{
+		LoadBlock(block);
+	}
+
+	int64 nextTicks;
+	while (PeekNextTicks(nextTicks) && nextTicks < Ticks)
+	{
+		FDISCaptureRecordHeader record;
+		FMemory::Memcpy(&record, Records.GetData() + RecordOffset, sizeof(record));
+		RecordOffset += sizeof(record) + record.PayloadBytes;
+	}
+}
+
+void FDISColumnarArchiveReader::Rewind()
+{
+	if (CurrentBlock == 0)
+	{
+		RecordOffset = 0;
+	}
+	else
+	{
+		LoadBlock(0);
+	}
+}
+
+int64 FDISColumnarArchiveReader::GetStartTicks() const
+{
+	return Blocks.Num() > 0 ? Blocks[0].Header.FirstTicks : 0;
+}
+
+int64 FDISColumnarArchiveReader::GetEndTicks() const
+{
+	return Blocks.Num() > 0 ? Blocks.Last().Header.LastTicks : 0;
+}
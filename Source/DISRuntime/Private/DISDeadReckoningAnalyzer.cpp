@@ -0,0 +1,699 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISDeadReckoningAnalyzer.h"
+#include "DISSendComponent.h"
+#include "DISReplaySource.h"
+#include "DISPacketValidator.h"
+#include "DISQuaternionConversions.h"
+#include "DeadReckoning_BPFL.h"
+#include "DIS_BPFL.h"
+#include "Algo/StableSort.h"
+#include "Async/ParallelFor.h"
+#include "Containers/Ticker.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectIterator.h"
+#include <utils/DataStream.h>
+
+DEFINE_LOG_CATEGORY(LogDISDeadReckoningAnalyzer);
+
+#if !UE_BUILD_SHIPPING
+namespace DISDeadReckoningAnalysis
+{
+	const uint8 EntityStateType = 1;
+
+	/**
+	 * Totals of one configuration over one or more trajectories.
+	 */
+	struct FErrorSums
+	{
+		int64 NumPDUs = 0;
+		int64 NumThresholdPDUs = 0;
+		int64 NumTicks = 0;
+		double Seconds = 0;
+		double SumSquaredPositionError = 0;
+		double MaxPositionError = 0;
+		double SumSquaredOrientationError = 0;
+		double MaxOrientationError = 0;
+
+		void Add(const FErrorSums& Other)
+		{
+			NumPDUs += Other.NumPDUs;
+			NumThresholdPDUs += Other.NumThresholdPDUs;
+			NumTicks += Other.NumTicks;
+			Seconds += Other.Seconds;
+			SumSquaredPositionError += Other.SumSquaredPositionError;
+			MaxPositionError = FMath::Max(MaxPositionError, Other.MaxPositionError);
+			SumSquaredOrientationError += Other.SumSquaredOrientationError;
+			MaxOrientationError = FMath::Max(MaxOrientationError, Other.MaxOrientationError);
+		}
+	};
+
+	/**
+	 * A stretch of one trajectory without gaps, at the ticks of the simulated sender.
+	 */
+	struct FTickedSegment
+	{
+		int32 Group = 0;
+		TArray<FDISTruthSample> Ticks;
+	};
+
+	FString GetEntityTypeGroup(const FString& EntityType, int32 NumFields)
+	{
+		if (NumFields <= 0)
+		{
+			return TEXT("All");
+		}
+
+		TArray<FString> fields;
+		EntityType.ParseIntoArray(fields, TEXT(":"));
+		fields.SetNum(FMath::Min(fields.Num(), NumFields));
+		return FString::Join(fields, TEXT(":"));
+	}
+
+	FQuat GetOrientationQuaternion(const FPsiThetaPhi& PsiThetaPhiRadians)
+	{
+		return UDeadReckoning_BPFL::GetEntityOrientationQuaternion(PsiThetaPhiRadians.Psi, PsiThetaPhiRadians.Theta, PsiThetaPhiRadians.Phi);
+	}
+
+	FDISTruthSample Interpolate(const FDISTruthSample& From, const FDISTruthSample& To, double Seconds)
+	{
+		const double span = To.Seconds - From.Seconds;
+		const double alpha = span > 0 ? (Seconds - From.Seconds) / span : 1;
+
+		FDISTruthSample sample;
+		sample.Seconds = Seconds;
+		sample.EcefLocation.X = FMath::Lerp(From.EcefLocation.X, To.EcefLocation.X, alpha);
+		sample.EcefLocation.Y = FMath::Lerp(From.EcefLocation.Y, To.EcefLocation.Y, alpha);
+		sample.EcefLocation.Z = FMath::Lerp(From.EcefLocation.Z, To.EcefLocation.Z, alpha);
+
+		//Euler angles wrap, so the orientation is interpolated along the shortest rotation between the samples
+		const glm::dquat fromRotation = DISQuaternion::FromPsiThetaPhiRadians(From.PsiThetaPhiRadians.Psi, From.PsiThetaPhiRadians.Theta, From.PsiThetaPhiRadians.Phi);
+		const glm::dquat toRotation = DISQuaternion::FromPsiThetaPhiRadians(To.PsiThetaPhiRadians.Psi, To.PsiThetaPhiRadians.Theta, To.PsiThetaPhiRadians.Phi);
+		double psi, theta, phi;
+		DISQuaternion::ToPsiThetaPhiRadians(glm::slerp(fromRotation, toRotation, alpha), psi, theta, phi);
+		sample.PsiThetaPhiRadians = FPsiThetaPhi(psi, theta, phi);
+
+		return sample;
+	}
+
+	/**
+	 * Splits a trajectory at its gaps and resamples each stretch at the tick rate of the simulated sender.
+	 */
+	void TickTrajectory(const FDISTruthTrajectory& Trajectory, int32 Group, const FDISDeadReckoningSweepSettings& Settings, TArray<FTickedSegment>& OutSegments)
+	{
+		const TArray<FDISTruthSample>& samples = Trajectory.Samples;
+		int32 first = 0;
+		while (first < samples.Num())
+		{
+			int32 last = first;
+			while (last + 1 < samples.Num() && samples[last + 1].Seconds - samples[last].Seconds <= Settings.MaxSampleGapSeconds)
+			{
+				last++;
+			}
+
+			if (last > first)
+			{
+				FTickedSegment& segment = OutSegments.AddDefaulted_GetRef();
+				segment.Group = Group;
+
+				if (Settings.TickRateHertz <= 0)
+				{
+					segment.Ticks.Append(&samples[first], last - first + 1);
+				}
+				else
+				{
+					const double tickSeconds = 1. / Settings.TickRateHertz;
+					const int32 numTicks = FMath::FloorToInt((samples[last].Seconds - samples[first].Seconds) / tickSeconds) + 1;
+					segment.Ticks.Reserve(numTicks);
+
+					int32 next = first + 1;
+					for (int32 tick = 0; tick < numTicks; tick++)
+					{
+						const double seconds = samples[first].Seconds + tick * tickSeconds;
+						while (next < last && samples[next].Seconds < seconds)
+						{
+							next++;
+						}
+						segment.Ticks.Add(Interpolate(samples[next - 1], samples[next], seconds));
+					}
+				}
+			}
+
+			first = last + 1;
+		}
+	}
+
+	/**
+	 * Runs one configuration over one segment the way UDISSendComponent sends, with a receiver dead reckoning every PDU it sends.
+	 * Checks the thresholds every tick at their configured values and only sends a heartbeat once it is due. See FDISDeadReckoningAnalyzer for what is not modelled.
+	 */
+	void Simulate(const TArray<FDISTruthSample>& Ticks, const FDISDeadReckoningConfiguration& Configuration, float EntityStateCalculationRate, FErrorSums& OutSums)
+	{
+		if (Ticks.Num() < 2)
+		{
+			return;
+		}
+
+		//Estimates of the send component, which start at rest as it does
+		FVector angularVelocity = FVector::ZeroVector;
+		FVector ecefLinearVelocity = FVector::ZeroVector;
+		FVector ecefLinearAcceleration = FVector::ZeroVector;
+		FVector bodyLinearVelocity = FVector::ZeroVector;
+		FVector bodyLinearAcceleration = FVector::ZeroVector;
+		int32 lastCalculatedTick = 0;
+		double nextCalculationSeconds = Ticks[0].Seconds + EntityStateCalculationRate;
+
+		auto formEntityStatePDU = [&](const FDISTruthSample& Truth)
+		{
+			FEntityStatePDU entityStatePDU;
+			entityStatePDU.EntityLocation = FVector(Truth.EcefLocation.X, Truth.EcefLocation.Y, Truth.EcefLocation.Z);
+			entityStatePDU.EntityLocationDouble = { Truth.EcefLocation.X, Truth.EcefLocation.Y, Truth.EcefLocation.Z };
+			entityStatePDU.EntityOrientation = FRotator(Truth.PsiThetaPhiRadians.Theta, Truth.PsiThetaPhiRadians.Psi, Truth.PsiThetaPhiRadians.Phi);
+			UDISSendComponent::SetDeadReckoningParameters(entityStatePDU, Configuration.Algorithm, angularVelocity, ecefLinearVelocity, ecefLinearAcceleration, bodyLinearVelocity, bodyLinearAcceleration);
+			return entityStatePDU;
+		};
+
+		//Every send component sends its initial state on BeginPlay
+		FEntityStatePDU sentEntityStatePDU = formEntityStatePDU(Ticks[0]);
+		FEntityStatePDU deadReckonedEntityStatePDU;
+		float deltaTimeSinceLastPDU = 0;
+		OutSums.NumPDUs++;
+
+		for (int32 tick = 1; tick < Ticks.Num(); tick++)
+		{
+			const FDISTruthSample& truth = Ticks[tick];
+			const FQuat truthOrientation = GetOrientationQuaternion(truth.PsiThetaPhiRadians);
+			deltaTimeSinceLastPDU += static_cast<float>(truth.Seconds - Ticks[tick - 1].Seconds);
+
+			//The send decision of UDISSendComponent::SendEntityStatePDU
+			bool sendPDU = false;
+			if (UDeadReckoning_BPFL::DeadReckoning(sentEntityStatePDU, deltaTimeSinceLastPDU, deadReckonedEntityStatePDU)
+				&& (UDISSendComponent::IsPositionOutsideThreshold(deadReckonedEntityStatePDU, truth.EcefLocation, Configuration.PositionThresholdMeters)
+					|| UDISSendComponent::IsOrientationOutsideThreshold(sentEntityStatePDU, deltaTimeSinceLastPDU, truthOrientation, Configuration.OrientationThresholdDegrees)))
+			{
+				OutSums.NumThresholdPDUs++;
+				sendPDU = true;
+			}
+			else if (deltaTimeSinceLastPDU > Configuration.HeartbeatSeconds)
+			{
+				sendPDU = true;
+			}
+
+			if (sendPDU)
+			{
+				//Latency is not modelled, so the receiver is exact on the tick an update is sent
+				sentEntityStatePDU = formEntityStatePDU(truth);
+				deltaTimeSinceLastPDU = 0;
+				OutSums.NumPDUs++;
+			}
+			else
+			{
+				//Measured against what the receiver shows, so algorithms that do not rotate the entity are charged for it
+				const double xError = truth.EcefLocation.X - deadReckonedEntityStatePDU.EntityLocationDouble[0];
+				const double yError = truth.EcefLocation.Y - deadReckonedEntityStatePDU.EntityLocationDouble[1];
+				const double zError = truth.EcefLocation.Z - deadReckonedEntityStatePDU.EntityLocationDouble[2];
+				const double positionError = FMath::Sqrt(xError * xError + yError * yError + zError * zError);
+
+				const FRotator& deadReckonedOrientation = deadReckonedEntityStatePDU.EntityOrientation;
+				const double orientationError = truthOrientation.AngularDistance(
+					UDeadReckoning_BPFL::GetEntityOrientationQuaternion(deadReckonedOrientation.Yaw, deadReckonedOrientation.Pitch, deadReckonedOrientation.Roll));
+
+				OutSums.SumSquaredPositionError += positionError * positionError;
+				OutSums.MaxPositionError = FMath::Max(OutSums.MaxPositionError, positionError);
+				OutSums.SumSquaredOrientationError += orientationError * orientationError;
+				OutSums.MaxOrientationError = FMath::Max(OutSums.MaxOrientationError, orientationError);
+			}
+			OutSums.NumTicks++;
+
+			//UDISSendComponent::UpdateEntityStateCalculations runs on a timer, and timers fire after the tick groups, so a PDU sent this tick still carries the previous estimates
+			if (truth.Seconds >= nextCalculationSeconds)
+			{
+				const FDISTruthSample& lastCalculated = Ticks[lastCalculatedTick];
+				const double timeSinceLastCalc = truth.Seconds - lastCalculated.Seconds;
+
+				//The orientation quaternions are already in DIS body axes, so the axis flip from actor axes is not needed
+				angularVelocity = UDISSendComponent::CalculateAngularVelocityBetween(GetOrientationQuaternion(lastCalculated.PsiThetaPhiRadians), truthOrientation, timeSinceLastCalc);
+
+				//The trajectory is already in ECEF, so the velocity is the location difference without the conversion from engine axes
+				const FVector previousECEFLinearVelocity = ecefLinearVelocity;
+				ecefLinearVelocity = FVector((truth.EcefLocation.X - lastCalculated.EcefLocation.X) / timeSinceLastCalc, (truth.EcefLocation.Y - lastCalculated.EcefLocation.Y) / timeSinceLastCalc,
+					(truth.EcefLocation.Z - lastCalculated.EcefLocation.Z) / timeSinceLastCalc);
+				ecefLinearAcceleration = (ecefLinearVelocity - previousECEFLinearVelocity) / timeSinceLastCalc;
+
+				//The entity orientation matrix takes ECEF vectors into body axes. The previous velocity is taken into the body axes it was calculated in.
+				const glm::dmat3 worldToBody = UDeadReckoning_BPFL::GetEntityOrientationMatrix(truth.PsiThetaPhiRadians.Psi, truth.PsiThetaPhiRadians.Theta, truth.PsiThetaPhiRadians.Phi);
+				const glm::dmat3 previousWorldToBody = UDeadReckoning_BPFL::GetEntityOrientationMatrix(lastCalculated.PsiThetaPhiRadians.Psi, lastCalculated.PsiThetaPhiRadians.Theta,
+					lastCalculated.PsiThetaPhiRadians.Phi);
+				const glm::dvec3 dvecBodyVelocityVector = worldToBody * glm::dvec3(ecefLinearVelocity.X, ecefLinearVelocity.Y, ecefLinearVelocity.Z);
+				const glm::dvec3 previousBodyVelocityVector = previousWorldToBody * glm::dvec3(previousECEFLinearVelocity.X, previousECEFLinearVelocity.Y, previousECEFLinearVelocity.Z);
+
+				bodyLinearVelocity = FVector(dvecBodyVelocityVector.x, dvecBodyVelocityVector.y, dvecBodyVelocityVector.z);
+				bodyLinearAcceleration = UDISSendComponent::CalculateBodyLinearAccelerationBetween(bodyLinearVelocity,
+					FVector(previousBodyVelocityVector.x, previousBodyVelocityVector.y, previousBodyVelocityVector.z), angularVelocity, timeSinceLastCalc);
+
+				lastCalculatedTick = tick;
+				while (nextCalculationSeconds <= truth.Seconds)
+				{
+					nextCalculationSeconds += EntityStateCalculationRate;
+				}
+			}
+		}
+
+		OutSums.Seconds += Ticks.Last().Seconds - Ticks[0].Seconds;
+	}
+
+	void MarkParetoFront(TArrayView<FDISDeadReckoningTradeoff> Group, bool OnMaxError)
+	{
+		//Sorted by PDU rate and then by error, a configuration is on the front if it beats the error of every cheaper one
+		Group.Sort([OnMaxError](const FDISDeadReckoningTradeoff& A, const FDISDeadReckoningTradeoff& B)
+		{
+			if (A.PDUsPerSecond != B.PDUsPerSecond)
+			{
+				return A.PDUsPerSecond < B.PDUsPerSecond;
+			}
+			return OnMaxError ? A.MaxPositionErrorMeters < B.MaxPositionErrorMeters : A.RmsPositionErrorMeters < B.RmsPositionErrorMeters;
+		});
+
+		float bestError = MAX_flt;
+		for (FDISDeadReckoningTradeoff& result : Group)
+		{
+			const float error = OnMaxError ? result.MaxPositionErrorMeters : result.RmsPositionErrorMeters;
+			result.ParetoOptimal = error < bestError;
+			bestError = FMath::Min(bestError, error);
+		}
+	}
+
+	FString FormatEntityType(const FEntityType& EntityType)
+	{
+		return FString::Printf(TEXT("%d:%d:%d:%d:%d:%d:%d"), EntityType.EntityKind, EntityType.Domain, EntityType.Country, EntityType.Category, EntityType.Subcategory,
+			EntityType.Specific, EntityType.Extra);
+	}
+
+	template<typename ValueType>
+	void ParseList(const TCHAR* Params, const TCHAR* Key, TArray<ValueType>& InOutValues, TFunctionRef<bool(const FString&, ValueType&)> ParseValue)
+	{
+		FString listString;
+		if (!FParse::Value(Params, Key, listString, false))
+		{
+			return;
+		}
+
+		//-ExecCmds splits commands on commas, so values can be separated by plus signs as well
+		TArray<FString> valueStrings;
+		const TCHAR* delimiters[] = { TEXT(","), TEXT("+") };
+		listString.ParseIntoArray(valueStrings, delimiters, 2);
+
+		TArray<ValueType> values;
+		for (const FString& valueString : valueStrings)
+		{
+			ValueType value;
+			if (ParseValue(valueString, value))
+			{
+				values.Add(value);
+			}
+			else
+			{
+				UE_LOG(LogDISDeadReckoningAnalyzer, Warning, TEXT("Ignoring <%s> in %s"), *valueString, Key);
+			}
+		}
+
+		if (values.Num() > 0)
+		{
+			InOutValues = MoveTemp(values);
+		}
+	}
+}
+
+bool FDISDeadReckoningAnalyzer::LoadTrajectoriesFromCsv(const FString& FilePath, TArray<FDISTruthTrajectory>& OutTrajectories)
+{
+	TArray<FString> lines;
+	if (!FFileHelper::LoadFileToStringArray(lines, *FilePath))
+	{
+		UE_LOG(LogDISDeadReckoningAnalyzer, Error, TEXT("Could not read trajectories from %s"), *FilePath);
+		return false;
+	}
+
+	TMap<FString, int32> trajectoryIndices;
+	int32 numRows = 0;
+	TArray<FString> fields;
+	for (int32 lineIndex = 1; lineIndex < lines.Num(); lineIndex++)
+	{
+		lines[lineIndex].ParseIntoArray(fields, TEXT(","), false);
+		if (fields.Num() < 9)
+		{
+			continue;
+		}
+
+		const int32* existingIndex = trajectoryIndices.Find(fields[1]);
+		const int32 trajectoryIndex = existingIndex ? *existingIndex : trajectoryIndices.Add(fields[1], OutTrajectories.AddDefaulted());
+		FDISTruthTrajectory& trajectory = OutTrajectories[trajectoryIndex];
+		trajectory.Name = fields[1];
+		trajectory.EntityType = fields[2];
+
+		FDISTruthSample& sample = trajectory.Samples.AddDefaulted_GetRef();
+		sample.Seconds = FCString::Atod(*fields[0]);
+		sample.EcefLocation = FEarthCenteredEarthFixedDouble(FCString::Atod(*fields[3]), FCString::Atod(*fields[4]), FCString::Atod(*fields[5]));
+		sample.PsiThetaPhiRadians = FPsiThetaPhi(FCString::Atod(*fields[6]), FCString::Atod(*fields[7]), FCString::Atod(*fields[8]));
+		numRows++;
+	}
+
+	for (FDISTruthTrajectory& trajectory : OutTrajectories)
+	{
+		Algo::StableSortBy(trajectory.Samples, &FDISTruthSample::Seconds);
+	}
+
+	UE_LOG(LogDISDeadReckoningAnalyzer, Display, TEXT("Read %d samples of %d entities from %s"), numRows, trajectoryIndices.Num(), *FilePath);
+	return numRows > 0;
+}
+
+int32 FDISDeadReckoningAnalyzer::LoadTrajectoriesFromReplaySource(IDISReplaySource& Source, TArray<FDISTruthTrajectory>& OutTrajectories)
+{
+	using namespace DISDeadReckoningAnalysis;
+
+	Source.Rewind();
+	const int64 startTicks = Source.GetStartTicks();
+
+	TMap<uint64, int32> trajectoryIndices;
+	int32 numEntityStatePDUs = 0;
+	FDISCaptureRecordHeader record;
+	TArrayView<const uint8> payload;
+	while (Source.ReadNext(record, payload))
+	{
+		if (FDISPacketValidator::Validate(payload.GetData(), payload.Num()) != EDISPacketRejectReason::None || payload[2] != EntityStateType)
+		{
+			continue;
+		}
+
+		DIS::DataStream ds(reinterpret_cast<const char*>(payload.GetData()), payload.Num(), DIS::BIG);
+		DIS::EntityStatePdu receivedESPDU;
+		receivedESPDU.unmarshal(ds);
+
+		FEntityStatePDU entityStatePDU;
+		entityStatePDU.SetupFromOpenDIS(receivedESPDU);
+
+		const uint64 entityKey = entityStatePDU.EntityID.ToUInt64();
+		const int32* existingIndex = trajectoryIndices.Find(entityKey);
+		const int32 trajectoryIndex = existingIndex ? *existingIndex : trajectoryIndices.Add(entityKey, OutTrajectories.AddDefaulted());
+		FDISTruthTrajectory& trajectory = OutTrajectories[trajectoryIndex];
+		trajectory.Name = entityStatePDU.EntityID.ToString();
+		trajectory.EntityType = FormatEntityType(entityStatePDU.EntityType);
+
+		FDISTruthSample& sample = trajectory.Samples.AddDefaulted_GetRef();
+		sample.Seconds = static_cast<double>(record.TimestampTicks - startTicks) / ETimespan::TicksPerSecond;
+		sample.EcefLocation = FEarthCenteredEarthFixedDouble(entityStatePDU.EntityLocationDouble[0], entityStatePDU.EntityLocationDouble[1], entityStatePDU.EntityLocationDouble[2]);
+		sample.PsiThetaPhiRadians = FPsiThetaPhi(entityStatePDU.EntityOrientation.Yaw, entityStatePDU.EntityOrientation.Pitch, entityStatePDU.EntityOrientation.Roll);
+		numEntityStatePDUs++;
+	}
+
+	//Pcap files are not always in time order
+	for (FDISTruthTrajectory& trajectory : OutTrajectories)
+	{
+		Algo::StableSortBy(trajectory.Samples, &FDISTruthSample::Seconds);
+	}
+
+	UE_LOG(LogDISDeadReckoningAnalyzer, Display, TEXT("Read %d Entity State PDUs of %d entities"), numEntityStatePDUs, trajectoryIndices.Num());
+	return numEntityStatePDUs;
+}
+
+TArray<FDISDeadReckoningTradeoff> FDISDeadReckoningAnalyzer::RunSweep(const TArray<FDISTruthTrajectory>& Trajectories, const FDISDeadReckoningSweepSettings& Settings)
+{
+	using namespace DISDeadReckoningAnalysis;
+
+	TArray<FDISDeadReckoningConfiguration> configurations;
+	for (const EDeadReckoningAlgorithm algorithm : Settings.Algorithms)
+	{
+		for (const float positionThreshold : Settings.PositionThresholdsMeters)
+		{
+			for (const float orientationThreshold : Settings.OrientationThresholdsDegrees)
+			{
+				for (const float heartbeat : Settings.HeartbeatsSeconds)
+				{
+					FDISDeadReckoningConfiguration& configuration = configurations.AddDefaulted_GetRef();
+					configuration.Algorithm = algorithm;
+					configuration.PositionThresholdMeters = positionThreshold;
+					configuration.OrientationThresholdDegrees = orientationThreshold;
+					configuration.HeartbeatSeconds = heartbeat;
+				}
+			}
+		}
+	}
+
+	TArray<FString> groups;
+	TArray<int32> groupTrajectoryCounts;
+	TArray<FTickedSegment> segments;
+	for (const FDISTruthTrajectory& trajectory : Trajectories)
+	{
+		const int32 group = groups.AddUnique(GetEntityTypeGroup(trajectory.EntityType, Settings.EntityTypeFields));
+		groupTrajectoryCounts.SetNumZeroed(groups.Num());
+		groupTrajectoryCounts[group]++;
+		TickTrajectory(trajectory, group, Settings, segments);
+	}
+
+	TArray<FDISDeadReckoningTradeoff> results;
+	if (configurations.Num() == 0 || segments.Num() == 0)
+	{
+		UE_LOG(LogDISDeadReckoningAnalyzer, Warning, TEXT("Nothing to sweep: %d configurations over %d trajectory segments."), configurations.Num(), segments.Num());
+		return results;
+	}
+
+	//Every configuration of every segment is simulated independently, so the whole sweep is spread across the cores as one flat list of jobs
+	const double startSeconds = FPlatformTime::Seconds();
+	TArray<FErrorSums> segmentSums;
+	segmentSums.SetNum(configurations.Num() * segments.Num());
+	const float calculationRate = FMath::Max(Settings.EntityStateCalculationRate, 0.001f);
+	ParallelFor(segmentSums.Num(), [&](int32 Job)
+	{
+		Simulate(segments[Job % segments.Num()].Ticks, configurations[Job / segments.Num()], calculationRate, segmentSums[Job]);
+	});
+
+	TArray<FErrorSums> groupSums;
+	groupSums.SetNum(configurations.Num() * groups.Num());
+	for (int32 job = 0; job < segmentSums.Num(); job++)
+	{
+		groupSums[(job / segments.Num()) * groups.Num() + segments[job % segments.Num()].Group].Add(segmentSums[job]);
+	}
+
+	for (int32 group = 0; group < groups.Num(); group++)
+	{
+		const int32 firstResult = results.Num();
+		for (int32 configuration = 0; configuration < configurations.Num(); configuration++)
+		{
+			const FErrorSums& sums = groupSums[configuration * groups.Num() + group];
+			if (sums.Seconds <= 0)
+			{
+				continue;
+			}
+
+			//Rates are per entity, so the trajectories of a group are weighted by how long they were recorded for
+			FDISDeadReckoningTradeoff& result = results.AddDefaulted_GetRef();
+			result.EntityTypeGroup = groups[group];
+			result.Configuration = configurations[configuration];
+			result.NumTrajectories = groupTrajectoryCounts[group];
+			result.PDUsPerSecond = static_cast<float>(sums.NumPDUs / sums.Seconds);
+			result.ThresholdShare = static_cast<float>(sums.NumThresholdPDUs) / sums.NumPDUs;
+			result.RmsPositionErrorMeters = static_cast<float>(FMath::Sqrt(sums.SumSquaredPositionError / FMath::Max<int64>(sums.NumTicks, 1)));
+			result.MaxPositionErrorMeters = static_cast<float>(sums.MaxPositionError);
+			result.RmsOrientationErrorDegrees = static_cast<float>(FMath::RadiansToDegrees(FMath::Sqrt(sums.SumSquaredOrientationError / FMath::Max<int64>(sums.NumTicks, 1))));
+			result.MaxOrientationErrorDegrees = static_cast<float>(FMath::RadiansToDegrees(sums.MaxOrientationError));
+		}
+		MarkParetoFront(TArrayView<FDISDeadReckoningTradeoff>(results).Slice(firstResult, results.Num() - firstResult), Settings.ParetoOnMaxError);
+	}
+
+	UE_LOG(LogDISDeadReckoningAnalyzer, Display, TEXT("Simulated %d configurations over %d trajectory segments in %d groups in %.1f s."), configurations.Num(), segments.Num(), groups.Num(),
+		FPlatformTime::Seconds() - startSeconds);
+	return results;
+}
+
+FString FDISDeadReckoningAnalyzer::FormatParetoTables(const TArray<FDISDeadReckoningTradeoff>& Results)
+{
+	FString tables;
+	FString currentGroup;
+	for (int32 i = 0; i < Results.Num(); i++)
+	{
+		const FDISDeadReckoningTradeoff& result = Results[i];
+		if (i == 0 || result.EntityTypeGroup != currentGroup)
+		{
+			currentGroup = result.EntityTypeGroup;
+			tables += FString::Printf(TEXT("\nPareto front of %s (%d trajectories)\n"), *currentGroup, result.NumTrajectories);
+			tables += TEXT("Algorithm  Position m  Orientation deg  Heartbeat s   PDUs/s  Threshold %  RMS m     Max m     RMS deg  Max deg\n");
+		}
+
+		if (result.ParetoOptimal)
+		{
+			const FDISDeadReckoningConfiguration& configuration = result.Configuration;
+			tables += FString::Printf(TEXT("%-9s  %10.2f  %15.1f  %11.1f  %7.3f  %11.0f  %8.3f  %8.3f  %7.2f  %7.2f\n"),
+				*StaticEnum<EDeadReckoningAlgorithm>()->GetNameStringByValue(static_cast<int64>(configuration.Algorithm)), configuration.PositionThresholdMeters,
+				configuration.OrientationThresholdDegrees, configuration.HeartbeatSeconds, result.PDUsPerSecond, result.ThresholdShare * 100, result.RmsPositionErrorMeters,
+				result.MaxPositionErrorMeters, result.RmsOrientationErrorDegrees, result.MaxOrientationErrorDegrees);
+		}
+	}
+	return tables;
+}
+
+bool FDISDeadReckoningAnalyzer::SaveResultsToCsv(const TArray<FDISDeadReckoningTradeoff>& Results, const FString& FilePath)
+{
+	FString csv = TEXT("EntityTypeGroup,Algorithm,PositionThresholdMeters,OrientationThresholdDegrees,HeartbeatSeconds,Trajectories,PDUsPerSecond,ThresholdShare,RmsPositionErrorMeters,MaxPositionErrorMeters,RmsOrientationErrorDegrees,MaxOrientationErrorDegrees,ParetoOptimal\n");
+	for (const FDISDeadReckoningTradeoff& result : Results)
+	{
+		const FDISDeadReckoningConfiguration& configuration = result.Configuration;
+		csv += FString::Printf(TEXT("%s,%s,%g,%g,%g,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%d\n"), *result.EntityTypeGroup,
+			*StaticEnum<EDeadReckoningAlgorithm>()->GetNameStringByValue(static_cast<int64>(configuration.Algorithm)), configuration.PositionThresholdMeters,
+			configuration.OrientationThresholdDegrees, configuration.HeartbeatSeconds, result.NumTrajectories, result.PDUsPerSecond, result.ThresholdShare, result.RmsPositionErrorMeters,
+			result.MaxPositionErrorMeters, result.RmsOrientationErrorDegrees, result.MaxOrientationErrorDegrees, result.ParetoOptimal ? 1 : 0);
+	}
+
+	if (!FFileHelper::SaveStringToFile(csv, *FilePath))
+	{
+		UE_LOG(LogDISDeadReckoningAnalyzer, Error, TEXT("Could not write results to %s"), *FilePath);
+		return false;
+	}
+
+	UE_LOG(LogDISDeadReckoningAnalyzer, Display, TEXT("Wrote %d results to %s"), Results.Num(), *FilePath);
+	return true;
+}
+
+void FDISDeadReckoningAnalyzer::ParseSettings(const TCHAR* Params, FDISDeadReckoningSweepSettings& InOutSettings)
+{
+	using namespace DISDeadReckoningAnalysis;
+
+	ParseList<EDeadReckoningAlgorithm>(Params, TEXT("Algorithms="), InOutSettings.Algorithms, [](const FString& ValueString, EDeadReckoningAlgorithm& OutValue)
+	{
+		const int64 value = StaticEnum<EDeadReckoningAlgorithm>()->GetValueByNameString(ValueString);
+		OutValue = static_cast<EDeadReckoningAlgorithm>(value);
+		//Other leaves dead reckoning to the receiver, so there is nothing to simulate
+		return value != INDEX_NONE && OutValue != EDeadReckoningAlgorithm::Other;
+	});
+
+	auto parsePositive = [](const FString& ValueString, float& OutValue)
+	{
+		OutValue = FCString::Atof(*ValueString);
+		return OutValue > 0;
+	};
+	ParseList<float>(Params, TEXT("Positions="), InOutSettings.PositionThresholdsMeters, parsePositive);
+	ParseList<float>(Params, TEXT("Orientations="), InOutSettings.OrientationThresholdsDegrees, parsePositive);
+	ParseList<float>(Params, TEXT("Heartbeats="), InOutSettings.HeartbeatsSeconds, parsePositive);
+
+	FParse::Value(Params, TEXT("CalculationRate="), InOutSettings.EntityStateCalculationRate);
+	FParse::Value(Params, TEXT("TickRate="), InOutSettings.TickRateHertz);
+	FParse::Value(Params, TEXT("MaxGap="), InOutSettings.MaxSampleGapSeconds);
+	FParse::Value(Params, TEXT("TypeFields="), InOutSettings.EntityTypeFields);
+
+	FString paretoError;
+	if (FParse::Value(Params, TEXT("Pareto="), paretoError))
+	{
+		InOutSettings.ParetoOnMaxError = paretoError.Equals(TEXT("Max"), ESearchCase::IgnoreCase);
+	}
+}
+
+namespace DISDeadReckoningRecording
+{
+	TWeakObjectPtr<UWorld> RecordedWorld;
+	FDelegateHandle TickerHandle;
+	FString FilePath;
+	FString PendingRows;
+	double LastFlushSeconds = 0;
+	int64 NumRows = 0;
+
+	void Flush()
+	{
+		if (!PendingRows.IsEmpty())
+		{
+			FFileHelper::SaveStringToFile(PendingRows, *FilePath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+			PendingRows.Reset();
+		}
+	}
+
+	bool RecordFrame(float DeltaTime)
+	{
+		UWorld* world = RecordedWorld.Get();
+		if (world == nullptr)
+		{
+			Flush();
+			TickerHandle.Reset();
+			return false;
+		}
+
+		for (TObjectIterator<UDISSendComponent> it; it; ++it)
+		{
+			UDISSendComponent* sendComponent = *it;
+			if (sendComponent->GetWorld() != world || !sendComponent->HasBegunPlay())
+			{
+				continue;
+			}
+
+			const FDISKinematicSnapshot& snapshot = sendComponent->GetKinematicSnapshot();
+			if (!snapshot.GeoReferenced)
+			{
+				continue;
+			}
+
+			PendingRows += FString::Printf(TEXT("%.6f,%s,%s,%.4f,%.4f,%.4f,%.8f,%.8f,%.8f\n"), world->GetTimeSeconds(), *sendComponent->EntityID.ToString(),
+				*DISDeadReckoningAnalysis::FormatEntityType(sendComponent->EntityType), snapshot.EcefLocation.X, snapshot.EcefLocation.Y, snapshot.EcefLocation.Z,
+				snapshot.PsiThetaPhiRadians.Psi, snapshot.PsiThetaPhiRadians.Theta, snapshot.PsiThetaPhiRadians.Phi);
+			NumRows++;
+		}
+
+		if (FPlatformTime::Seconds() - LastFlushSeconds > 1)
+		{
+			Flush();
+			LastFlushSeconds = FPlatformTime::Seconds();
+		}
+		return true;
+	}
+
+	void Stop()
+	{
+		if (TickerHandle.IsValid())
+		{
+			FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+			TickerHandle.Reset();
+			Flush();
+			UE_LOG(LogDISDeadReckoningAnalyzer, Display, TEXT("Recorded %lld samples to %s"), NumRows, *FilePath);
+		}
+	}
+}
+
+static void RunDeadReckoningCommandFromConsole(const TArray<FString>& Args, UWorld* World)
+{
+	using namespace DISDeadReckoningRecording;
+
+	if (World == nullptr || Args.Num() == 0)
+	{
+		UE_LOG(LogDISDeadReckoningAnalyzer, Warning, TEXT("Usage: DIS.DeadReckoning Record [File=...] | Stop"));
+		return;
+	}
+
+	const FString& command = Args[0];
+	if (command.Equals(TEXT("Record"), ESearchCase::IgnoreCase))
+	{
+		Stop();
+
+		FilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("DISDeadReckoning"), FString::Printf(TEXT("DISTruth-%s.csv"), *FDateTime::Now().ToString()));
+		FParse::Value(*FString::Join(Args, TEXT(" ")), TEXT("File="), FilePath);
+		if (!FFileHelper::SaveStringToFile(TEXT("Seconds,Entity,EntityType,EcefX,EcefY,EcefZ,Psi,Theta,Phi\n"), *FilePath))
+		{
+			UE_LOG(LogDISDeadReckoningAnalyzer, Error, TEXT("Could not write trajectories to %s"), *FilePath);
+			return;
+		}
+
+		RecordedWorld = World;
+		NumRows = 0;
+		LastFlushSeconds = FPlatformTime::Seconds();
+		TickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&RecordFrame));
+		UE_LOG(LogDISDeadReckoningAnalyzer, Display, TEXT("Recording the trajectories of every DIS Send Component to %s"), *FilePath);
+	}
+	else if (command.Equals(TEXT("Stop"), ESearchCase::IgnoreCase))
+	{
+		Stop();
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs DISDeadReckoningCommand(
+	TEXT("DIS.DeadReckoning"),
+	TEXT("Records the trajectories of every DIS Send Component each frame, for the dead reckoning analyzer commandlet. Usage: DIS.DeadReckoning Record [File=...] | Stop"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunDeadReckoningCommandFromConsole));
+
+#endif
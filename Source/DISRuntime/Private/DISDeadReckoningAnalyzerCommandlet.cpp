@@ -0,0 +1,91 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISDeadReckoningAnalyzerCommandlet.h"
+#include "DISDeadReckoningAnalyzer.h"
+#include "DISCaptureReader.h"
+#include "DISPcapReader.h"
+#include "DISColumnarArchive.h"
+#include "DISReplaySubsystem.h"
+#include "Misc/Paths.h"
+
+UDISDeadReckoningAnalyzerCommandlet::UDISDeadReckoningAnalyzerCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UDISDeadReckoningAnalyzerCommandlet::Main(const FString& Params)
+{
+#if UE_BUILD_SHIPPING
+	UE_LOG(LogDISDeadReckoningAnalyzer, Error, TEXT("The dead reckoning analyzer commandlet is not available in shipping builds."));
+	return 1;
+#else
+	FDISDeadReckoningSweepSettings settings;
+	FDISDeadReckoningAnalyzer::ParseSettings(*Params, settings);
+
+	FString outputPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("DISDeadReckoning"), FString::Printf(TEXT("DISDeadReckoning-%s.csv"), *FDateTime::Now().ToString()));
+	FParse::Value(*Params, TEXT("Output="), outputPath);
+
+	TArray<FDISTruthTrajectory> trajectories;
+	FString csvPath;
+	if (FParse::Value(*Params, TEXT("Csv="), csvPath) && !FDISDeadReckoningAnalyzer::LoadTrajectoriesFromCsv(csvPath, trajectories))
+	{
+		return 1;
+	}
+
+	FString captureName;
+	if (FParse::Value(*Params, TEXT("Capture="), captureName))
+	{
+		FString directory;
+		FParse::Value(*Params, TEXT("Dir="), directory);
+		FDISCaptureReader captureReader;
+		if (!captureReader.Open(UDISReplaySubsystem::GetCaptureDirectory(directory), captureName))
+		{
+			UE_LOG(LogDISDeadReckoningAnalyzer, Error, TEXT("Could not open capture %s"), *captureName);
+			return 1;
+		}
+		FDISDeadReckoningAnalyzer::LoadTrajectoriesFromReplaySource(captureReader, trajectories);
+	}
+
+	FString pcapPath;
+	if (FParse::Value(*Params, TEXT("Pcap="), pcapPath))
+	{
+		FDISPcapReader pcapReader;
+		if (!pcapReader.Open(pcapPath, FDISPcapFilter()))
+		{
+			UE_LOG(LogDISDeadReckoningAnalyzer, Error, TEXT("Could not open pcap file %s"), *pcapPath);
+			return 1;
+		}
+		FDISDeadReckoningAnalyzer::LoadTrajectoriesFromReplaySource(pcapReader, trajectories);
+	}
+
+	FString archivePath;
+	if (FParse::Value(*Params, TEXT("Archive="), archivePath))
+	{
+		FDISColumnarArchiveReader archiveReader;
+		if (!archiveReader.Open(archivePath))
+		{
+			UE_LOG(LogDISDeadReckoningAnalyzer, Error, TEXT("Could not open archive %s"), *archivePath);
+			return 1;
+		}
+		FDISDeadReckoningAnalyzer::LoadTrajectoriesFromReplaySource(archiveReader, trajectories);
+	}
+
+	if (trajectories.Num() == 0)
+	{
+		UE_LOG(LogDISDeadReckoningAnalyzer, Error, TEXT("No trajectories to analyze. Give at least one of -Csv=, -Capture=, -Pcap=, or -Archive=."));
+		return 1;
+	}
+
+	const TArray<FDISDeadReckoningTradeoff> results = FDISDeadReckoningAnalyzer::RunSweep(trajectories, settings);
+	if (results.Num() == 0)
+	{
+		return 1;
+	}
+
+	UE_LOG(LogDISDeadReckoningAnalyzer, Display, TEXT("%s"), *FDISDeadReckoningAnalyzer::FormatParetoTables(results));
+	return FDISDeadReckoningAnalyzer::SaveResultsToCsv(results, outputPath) ? 0 : 1;
+#endif
+}
@@ -5,12 +5,16 @@
 #include "DIS_BPFL.h"
 #include "Engine/Engine.h"
 #include "PDUProcessor.h"
+#include "DISGeoTransformCache.h"
+#include "DISSendManager.h"
 
 DEFINE_LOG_CATEGORY(LogDISGameManager);
 
 ADISGameManager::ADISGameManager() 
 {
 	PrimaryActorTick.bCanEverTick = true;	
+
+	SendManager = CreateDefaultSubobject<UDISSendManager>(TEXT("DISSendManager"));
 }
 
 ADISGameManager* ADISGameManager::GetDISGameManager(UObject* WorldContextObject)
@@ -54,6 +58,12 @@ void ADISGameManager::BeginPlay()
 	GetGameInstance()->GetSubsystem<UPDUProcessor>()->OnElectromagneticEmissionsPDUProcessed.AddDynamic(this, &ADISGameManager::HandleElectromagneticEmissionsPDU);
 
 	GeoReferencingSystem = AGeoReferencingSystem::GetGeoReferencingSystem(Cast<UObject>(GetWorld()));
+	if (IsValid(GeoReferencingSystem))
+	{
+		FDISGeoTransformCache::SetConversionMode(GeoReferencingSystem, GeoReferencingConversionMode, ExerciseAreaRadiusMeters, FlatEarthMaxErrorMeters);
+		//Build the cache now so the accuracy check is logged at startup rather than on the first conversion
+		FDISGeoTransformCache::Get(GeoReferencingSystem);
+	}
 
 	//Auto connect sockets if needed
 	if (AutoConnectReceiveAddresses) 
@@ -99,6 +109,75 @@ void ADISGameManager::BeginPlay()
 	}
 }
 
+void ADISGameManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	//Remote simulations would otherwise keep bulk published entities until they time out
+	StopPublishingAllEntities();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+bool ADISGameManager::GetFlatEarthAffineError(float& PositionErrorMeters, float& OrientationErrorDegrees) const
+{
+	PositionErrorMeters = 0;
+	OrientationErrorDegrees = 0;
+
+	TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe> cache = FDISGeoTransformCache::Get(GeoReferencingSystem);
+	if (!cache.IsValid() || !cache->IsFlatEarthAffine())
+	{
+		return false;
+	}
+
+	PositionErrorMeters = cache->GetFlatEarthErrorMeters();
+	OrientationErrorDegrees = cache->GetFlatEarthErrorDegrees();
+	return true;
+}
+
+int32 ADISGameManager::PublishEntityStates(const TArray<FEntityID>& EntityIDs, const TArray<FEntityType>& EntityTypes, const TArray<FVector>& UnrealLocations,
+	const TArray<FRotator>& UnrealRotations, const TArray<FVector>& UnrealVelocities)
+{
+	UUDPSubsystem* udpSubsystem = GetGameInstance()->GetSubsystem<UUDPSubsystem>();
+	if (!IsValid(udpSubsystem))
+	{
+		return 0;
+	}
+
+	return BulkPublisher.Publish(EntityIDs, EntityTypes, UnrealLocations, UnrealRotations, UnrealVelocities, GetWorld()->GetTimeSeconds(), BulkPublishSettings,
+		static_cast<uint8>(ExerciseID), GeoReferencingSystem, [udpSubsystem](const TArray<uint8>& Bytes, EUDPSendPriority Priority, int64 MergeKey)
+	{
+		udpSubsystem->EmitBytesWithPriority(Bytes, Priority, MergeKey);
+	});
+}
+
+int32 ADISGameManager::StopPublishingEntities(const TArray<FEntityID>& EntityIDs)
+{
+	UUDPSubsystem* udpSubsystem = GetGameInstance()->GetSubsystem<UUDPSubsystem>();
+	if (!IsValid(udpSubsystem))
+	{
+		return 0;
+	}
+
+	return BulkPublisher.Unpublish(EntityIDs, [udpSubsystem](const TArray<uint8>& Bytes, EUDPSendPriority Priority, int64 MergeKey)
+	{
+		udpSubsystem->EmitBytesWithPriority(Bytes, Priority, MergeKey);
+	});
+}
+
+int32 ADISGameManager::StopPublishingAllEntities()
+{
+	UGameInstance* gameInstance = GetGameInstance();
+	UUDPSubsystem* udpSubsystem = IsValid(gameInstance) ? gameInstance->GetSubsystem<UUDPSubsystem>() : nullptr;
+	if (!IsValid(udpSubsystem))
+	{
+		return 0;
+	}
+
+	return BulkPublisher.UnpublishAll([udpSubsystem](const TArray<uint8>& Bytes, EUDPSendPriority Priority, int64 MergeKey)
+	{
+		udpSubsystem->EmitBytesWithPriority(Bytes, Priority, MergeKey);
+	});
+}
+
 void ADISGameManager::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
@@ -135,6 +214,11 @@ void ADISGameManager::HandleOnDISEntityDestroyed(AActor* DestroyedActor)
 	if (DISComponent != nullptr)
 	{
 		anyRemoved = RemoveDISEntityFromMap(DISComponent->EntityID);
+
+		if (IsValid(SendManager))
+		{
+			SendManager->RemoveRemoteObserver(DISComponent->EntityID);
+		}
 	}
 
 	if (!anyRemoved)
@@ -147,6 +231,12 @@ void ADISGameManager::HandleEntityStatePDU(FEntityStatePDU EntityStatePDUIn)
 {
 	if (EntityStatePDUIn.ExerciseID == ExerciseID)
 	{
+		//Remote entities are where the viewers of our entities are
+		if (IsValid(SendManager) && !(EntityStatePDUIn.EntityID.Site == SiteID && EntityStatePDUIn.EntityID.Application == ApplicationID))
+		{
+			SendManager->UpdateRemoteObserver(EntityStatePDUIn);
+		}
+
 		//Find associated actor in the DISActorMappings map -- If actor does not exist spawn one
 		auto associatedActor = RawDISActorMappings.find(EntityStatePDUIn.EntityID);
 		if (associatedActor != RawDISActorMappings.end())
@@ -179,6 +269,11 @@ void ADISGameManager::HandleEntityStateUpdatePDU(FEntityStateUpdatePDU EntitySta
 	{
 		// NOTE: Entity State Update PDUs do not contain an Entity Type, so we cannot spawn an entity from one
 
+		if (IsValid(SendManager))
+		{
+			SendManager->UpdateRemoteObserverLocation(EntityStateUpdatePDUIn.EntityID, EntityStateUpdatePDUIn.EntityLocationDouble);
+		}
+
 		//Get associated OpenDISComponent and relay information
 		UDISReceiveComponent* DISComponent = GetAssociatedDISComponent(EntityStateUpdatePDUIn.EntityID);
 
@@ -0,0 +1,666 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISGeoTransformCache.h"
+#include "DISGeodeticSolvers.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+
+DEFINE_LOG_CATEGORY(LogDISGeoTransformCache);
+
+static TAutoConsoleVariable<int32> CVarGeoTransformCache(
+	TEXT("DIS.Geodetic.TransformCache"),
+	1,
+	TEXT("Use cached ECEF <-> engine transforms instead of calling the GeoReferencing System on every conversion.\n")
+	TEXT(" 0: Disabled\n")
+	TEXT(" 1: Enabled (default)"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarGeoTransformCacheTileSizeMeters(
+	TEXT("DIS.Geodetic.TransformCache.TileSizeMeters"),
+	500.f,
+	TEXT("Edge length in meters of the tiles used when the level is not affine everywhere (flat planet levels)."),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarGeoTransformCacheMaxErrorMeters(
+	TEXT("DIS.Geodetic.TransformCache.MaxErrorMeters"),
+	0.01f,
+	TEXT("Largest allowed difference in meters between a cached transform and the GeoReferencing System. Tiles over this budget use the GeoReferencing System."),
+	ECVF_Default);
+
+namespace DISGeoTransformCache
+{
+	//Distance from the engine origin in centimeters at which the origin transform is probed to decide if it can be used everywhere
+	constexpr double GlobalValidationRadiusCentimeters = 100000000.;
+	//Largest allowed angle between cached and reference North, East, Down vectors
+	constexpr double MaxNorthEastDownErrorRadians = 1e-5;
+	//Tiles are dropped once this many have been built
+	constexpr int32 MaxTiles = 16384;
+	//Directions around the origin the flat earth transform is checked in
+	constexpr int32 FlatEarthProbeDirections = 16;
+
+	struct FConversionSettings
+	{
+		EGeoReferencingConversionMode Mode = EGeoReferencingConversionMode::Exact;
+		double ExerciseAreaRadiusMeters = 0;
+		double MaxErrorMeters = 0;
+	};
+
+	FCriticalSection CachesCriticalSection;
+	TMap<TWeakObjectPtr<AGeoReferencingSystem>, TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe>> Caches;
+	TMap<TWeakObjectPtr<AGeoReferencingSystem>, FConversionSettings> ConversionSettings;
+	//Bumped under CachesCriticalSection whenever a cache is built, replaced, or dropped, so threads know their snapshot is out of date
+	FThreadSafeCounter CachesVersion;
+
+	/**
+	 * The cache a thread last got, so repeated conversions on the same thread skip CachesCriticalSection.
+	 * Only trusted for the frame it was validated in and while CachesVersion is unchanged.
+	 */
+	struct FThreadCacheSnapshot
+	{
+		TWeakObjectPtr<AGeoReferencingSystem> GeoReferencingSystem;
+		TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe> Cache;
+		int32 Version = -1;
+		uint64 Frame = 0;
+	};
+	thread_local FThreadCacheSnapshot ThreadCacheSnapshot;
+
+	FORCEINLINE glm::dvec3 ToDVec3(const FVector& Vector)
+	{
+		return glm::dvec3(Vector.X, Vector.Y, Vector.Z);
+	}
+
+	FORCEINLINE glm::dvec3 ReferenceEngineToEcef(AGeoReferencingSystem* GeoReferencingSystem, const FVector& EngineLocation)
+	{
+		FCartesianCoordinates ecef;
+		GeoReferencingSystem->EngineToECEF(EngineLocation, ecef);
+		return glm::dvec3(ecef.X, ecef.Y, ecef.Z);
+	}
+
+	void ReferenceNorthEastDown(AGeoReferencingSystem* GeoReferencingSystem, const FVector& EngineLocation, FNorthEastDown& OutNorthEastDown)
+	{
+		GeoReferencingSystem->GetENUVectorsAtEngineLocation(EngineLocation, OutNorthEastDown.EastVector, OutNorthEastDown.NorthVector, OutNorthEastDown.DownVector);
+		OutNorthEastDown.DownVector *= -1;
+	}
+
+	double AngleBetween(const FVector& A, const FVector& B)
+	{
+		return FMath::Acos(FMath::Clamp<double>(FVector::DotProduct(A.GetSafeNormal(), B.GetSafeNormal()), -1., 1.));
+	}
+
+	double NorthEastDownError(const FNorthEastDown& A, const FNorthEastDown& B)
+	{
+		return FMath::Max3(AngleBetween(A.NorthVector, B.NorthVector), AngleBetween(A.EastVector, B.EastVector), AngleBetween(A.DownVector, B.DownVector));
+	}
+
+	glm::dquat EcefToEngineRotation(const FNorthEastDown& EngineNorthEastDown, const FEarthCenteredEarthFixedDouble& Ecef)
+	{
+		double latRadians, lonRadians, heightMeters;
+		DISGeodetic::EcefToGeodeticOlson(Ecef.X, Ecef.Y, Ecef.Z, latRadians, lonRadians, heightMeters);
+
+		const glm::dmat3 engineNorthEastDown(ToDVec3(EngineNorthEastDown.NorthVector.GetSafeNormal()), ToDVec3(EngineNorthEastDown.EastVector.GetSafeNormal()), ToDVec3(EngineNorthEastDown.DownVector.GetSafeNormal()));
+		return DISQuaternion::EcefToEngineFromNorthEastDown(engineNorthEastDown, DISQuaternion::EcefNorthEastDown(latRadians, lonRadians));
+	}
+}
+
+using namespace DISGeoTransformCache;
+
+FDISGeoTransformCache::FOriginSnapshot::FOriginSnapshot(AGeoReferencingSystem* GeoReferencingSystem)
+{
+	PlanetShape = GeoReferencingSystem->PlanetShape;
+	OriginAtPlanetCenter = GeoReferencingSystem->bOriginAtPlanetCenter;
+	OriginLocationInProjectedCRS = GeoReferencingSystem->bOriginLocationInProjectedCRS;
+	OriginLatitude = GeoReferencingSystem->OriginLatitude;
+	OriginLongitude = GeoReferencingSystem->OriginLongitude;
+	OriginAltitude = GeoReferencingSystem->OriginAltitude;
+	OriginProjectedCoordinatesEasting = GeoReferencingSystem->OriginProjectedCoordinatesEasting;
+	OriginProjectedCoordinatesNorthing = GeoReferencingSystem->OriginProjectedCoordinatesNorthing;
+	OriginProjectedCoordinatesUp = GeoReferencingSystem->OriginProjectedCoordinatesUp;
+	ProjectedCRS = GeoReferencingSystem->ProjectedCRS;
+	GeographicCRS = GeoReferencingSystem->GeographicCRS;
+
+	UWorld* world = GeoReferencingSystem->GetWorld();
+	WorldOriginLocation = world ? world->OriginLocation : FIntVector::ZeroValue;
+
+	TileSizeMeters = FMath::Max(1.f, CVarGeoTransformCacheTileSizeMeters.GetValueOnAnyThread());
+	MaxErrorMeters = CVarGeoTransformCacheMaxErrorMeters.GetValueOnAnyThread();
+
+	FScopeLock lock(&CachesCriticalSection);
+	if (const FConversionSettings* settings = ConversionSettings.Find(GeoReferencingSystem))
+	{
+		ConversionMode = settings->Mode;
+		ExerciseAreaRadiusMeters = settings->ExerciseAreaRadiusMeters;
+		FlatEarthMaxErrorMeters = settings->MaxErrorMeters;
+	}
+}
+
+bool FDISGeoTransformCache::FOriginSnapshot::operator==(const FOriginSnapshot& Other) const
+{
+	return PlanetShape == Other.PlanetShape
+		&& OriginAtPlanetCenter == Other.OriginAtPlanetCenter
+		&& OriginLocationInProjectedCRS == Other.OriginLocationInProjectedCRS
+		&& OriginLatitude == Other.OriginLatitude
+		&& OriginLongitude == Other.OriginLongitude
+		&& OriginAltitude == Other.OriginAltitude
+		&& OriginProjectedCoordinatesEasting == Other.OriginProjectedCoordinatesEasting
+		&& OriginProjectedCoordinatesNorthing == Other.OriginProjectedCoordinatesNorthing
+		&& OriginProjectedCoordinatesUp == Other.OriginProjectedCoordinatesUp
+		&& WorldOriginLocation == Other.WorldOriginLocation
+		&& TileSizeMeters == Other.TileSizeMeters
+		&& MaxErrorMeters == Other.MaxErrorMeters
+		&& ConversionMode == Other.ConversionMode
+		&& ExerciseAreaRadiusMeters == Other.ExerciseAreaRadiusMeters
+		&& FlatEarthMaxErrorMeters == Other.FlatEarthMaxErrorMeters
+		&& ProjectedCRS.Equals(Other.ProjectedCRS, ESearchCase::CaseSensitive)
+		&& GeographicCRS.Equals(Other.GeographicCRS, ESearchCase::CaseSensitive);
+}
+
+TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe> FDISGeoTransformCache::Get(AGeoReferencingSystem* GeoReferencingSystem)
+{
+	if (!IsValid(GeoReferencingSystem) || CVarGeoTransformCache.GetValueOnAnyThread() == 0)
+	{
+		return nullptr;
+	}
+
+	//Lock free when this thread already got the cache this frame and no cache has changed since
+	FThreadCacheSnapshot& threadSnapshot = ThreadCacheSnapshot;
+	if (threadSnapshot.Frame == GFrameCounter && threadSnapshot.Version == CachesVersion.GetValue() && threadSnapshot.GeoReferencingSystem.Get() == GeoReferencingSystem)
+	{
+		return threadSnapshot.Cache;
+	}
+
+	FScopeLock lock(&CachesCriticalSection);
+
+	TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe>* cache = Caches.Find(GeoReferencingSystem);
+
+	//Only compare the origin settings once per frame
+	if (cache && (*cache)->ValidatedFrame != GFrameCounter)
+	{
+		const FOriginSnapshot snapshot(GeoReferencingSystem);
+		if (snapshot == (*cache)->Snapshot)
+		{
+			(*cache)->ValidatedFrame = GFrameCounter;
+		}
+		else
+		{
+			UE_LOG(LogDISGeoTransformCache, Log, TEXT("GeoReferencing settings of %s changed. Rebuilding its transform cache."), *GeoReferencingSystem->GetName());
+			Caches.Remove(GeoReferencingSystem);
+			CachesVersion.Increment();
+			cache = nullptr;
+		}
+	}
+
+	if (!cache)
+	{
+		//Drop caches of GeoReferencing Systems that no longer exist
+		for (auto cacheIt = Caches.CreateIterator(); cacheIt; ++cacheIt)
+		{
+			if (!cacheIt.Key().IsValid())
+			{
+				cacheIt.RemoveCurrent();
+			}
+		}
+		for (auto settingsIt = ConversionSettings.CreateIterator(); settingsIt; ++settingsIt)
+		{
+			if (!settingsIt.Key().IsValid())
+			{
+				settingsIt.RemoveCurrent();
+			}
+		}
+
+		TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe> newCache = MakeShareable(new FDISGeoTransformCache(GeoReferencingSystem, FOriginSnapshot(GeoReferencingSystem)));
+		newCache->ValidatedFrame = GFrameCounter;
+		cache = &Caches.Add(GeoReferencingSystem, newCache);
+		CachesVersion.Increment();
+	}
+
+	threadSnapshot.GeoReferencingSystem = GeoReferencingSystem;
+	threadSnapshot.Cache = *cache;
+	threadSnapshot.Version = CachesVersion.GetValue();
+	threadSnapshot.Frame = GFrameCounter;
+
+	return *cache;
+}
+
+void FDISGeoTransformCache::Invalidate(AGeoReferencingSystem* GeoReferencingSystem)
+{
+	FScopeLock lock(&CachesCriticalSection);
+	Caches.Remove(GeoReferencingSystem);
+	CachesVersion.Increment();
+}
+
+void FDISGeoTransformCache::InvalidateAll()
+{
+	FScopeLock lock(&CachesCriticalSection);
+	Caches.Empty();
+	CachesVersion.Increment();
+}
+
+void FDISGeoTransformCache::SetConversionMode(AGeoReferencingSystem* GeoReferencingSystem, EGeoReferencingConversionMode Mode, double ExerciseAreaRadiusMeters, double MaxErrorMeters)
+{
+	if (!IsValid(GeoReferencingSystem))
+	{
+		return;
+	}
+
+	FScopeLock lock(&CachesCriticalSection);
+
+	FConversionSettings& settings = ConversionSettings.FindOrAdd(GeoReferencingSystem);
+	settings.Mode = Mode;
+	settings.ExerciseAreaRadiusMeters = FMath::Max(0., ExerciseAreaRadiusMeters);
+	settings.MaxErrorMeters = FMath::Max(0., MaxErrorMeters);
+
+	Caches.Remove(GeoReferencingSystem);
+	CachesVersion.Increment();
+}
+
+void FDISGeoTransformCache::EngineToEcef(AGeoReferencingSystem* GeoReferencingSystem, const FVector& EngineLocation, FEarthCenteredEarthFixedDouble& OutEcef)
+{
+	if (TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe> cache = Get(GeoReferencingSystem))
+	{
+		cache->EngineToEcef(EngineLocation, OutEcef);
+		return;
+	}
+
+	const glm::dvec3 ecef = ReferenceEngineToEcef(GeoReferencingSystem, EngineLocation);
+	OutEcef = FEarthCenteredEarthFixedDouble(ecef.x, ecef.y, ecef.z);
+}
+
+void FDISGeoTransformCache::EcefToEngine(AGeoReferencingSystem* GeoReferencingSystem, const FEarthCenteredEarthFixedDouble& Ecef, FVector& OutEngineLocation)
+{
+	if (TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe> cache = Get(GeoReferencingSystem))
+	{
+		cache->EcefToEngine(Ecef, OutEngineLocation);
+		return;
+	}
+
+	GeoReferencingSystem->ECEFToEngine(FCartesianCoordinates(Ecef.X, Ecef.Y, Ecef.Z), OutEngineLocation);
+}
+
+void FDISGeoTransformCache::GetNorthEastDownAtEngineLocation(AGeoReferencingSystem* GeoReferencingSystem, const FVector& EngineLocation, FNorthEastDown& OutNorthEastDown)
+{
+	if (TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe> cache = Get(GeoReferencingSystem))
+	{
+		cache->GetNorthEastDownAtEngineLocation(EngineLocation, OutNorthEastDown);
+		return;
+	}
+
+	ReferenceNorthEastDown(GeoReferencingSystem, EngineLocation, OutNorthEastDown);
+}
+
+void FDISGeoTransformCache::GetNorthEastDownAtEcefLocation(AGeoReferencingSystem* GeoReferencingSystem, const FEarthCenteredEarthFixedDouble& Ecef, FNorthEastDown& OutNorthEastDown)
+{
+	if (TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe> cache = Get(GeoReferencingSystem))
+	{
+		cache->GetNorthEastDownAtEcefLocation(Ecef, OutNorthEastDown);
+		return;
+	}
+
+	GeoReferencingSystem->GetENUVectorsAtECEFLocation(FCartesianCoordinates(Ecef.X, Ecef.Y, Ecef.Z), OutNorthEastDown.EastVector, OutNorthEastDown.NorthVector, OutNorthEastDown.DownVector);
+	OutNorthEastDown.DownVector *= -1;
+}
+
+glm::dquat FDISGeoTransformCache::GetEcefToEngineRotationAtEcefLocation(AGeoReferencingSystem* GeoReferencingSystem, const FEarthCenteredEarthFixedDouble& Ecef)
+{
+	if (TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe> cache = Get(GeoReferencingSystem))
+	{
+		return cache->GetEcefToEngineRotationAtEcefLocation(Ecef);
+	}
+
+	FNorthEastDown northEastDown;
+	GetNorthEastDownAtEcefLocation(GeoReferencingSystem, Ecef, northEastDown);
+	return EcefToEngineRotation(northEastDown, Ecef);
+}
+
+FDISGeoTransformCache::FDISGeoTransformCache(AGeoReferencingSystem* InGeoReferencingSystem, const FOriginSnapshot& InSnapshot)
+	: GeoReferencingSystem(InGeoReferencingSystem)
+	, Snapshot(InSnapshot)
+	, TileSizeCentimeters(InSnapshot.TileSizeMeters * 100.)
+{
+	FitTile(glm::dvec3(0.), TileSizeCentimeters / 2, OriginTile);
+
+	//Probe the origin transform far out from the origin. If it still matches, the level is affine (round planet) and no tiles are needed.
+	double globalErrorMeters = OriginTile.MaxErrorMeters;
+	for (int32 corner = 0; corner < 8; corner++)
+	{
+		const FVector probe(corner & 1 ? GlobalValidationRadiusCentimeters : -GlobalValidationRadiusCentimeters,
+			corner & 2 ? GlobalValidationRadiusCentimeters : -GlobalValidationRadiusCentimeters,
+			corner & 4 ? GlobalValidationRadiusCentimeters : -GlobalValidationRadiusCentimeters);
+		globalErrorMeters = FMath::Max(globalErrorMeters, glm::length(OriginTile.EngineToEcef(ToDVec3(probe)) - ReferenceEngineToEcef(InGeoReferencingSystem, probe)));
+	}
+	GloballyAffine = FMath::IsFinite(globalErrorMeters) && globalErrorMeters <= Snapshot.MaxErrorMeters;
+	MaxTileErrorMeters = GloballyAffine ? globalErrorMeters : OriginTile.MaxErrorMeters;
+
+	//Pick the cheapest North, East, Down method that matches the GeoReferencing System
+	ReferenceNorthEastDown(InGeoReferencingSystem, FVector::ZeroVector, OriginNorthEastDown);
+
+	const FVector northEastDownProbes[] = { FVector::ZeroVector, FVector(10000000, 0, 0), FVector(0, -10000000, 0), FVector(-7000000, 7000000, 5000000) };
+	double analyticErrorRadians = 0, constantErrorRadians = 0;
+	for (const FVector& probe : northEastDownProbes)
+	{
+		FNorthEastDown referenceNorthEastDown, analyticNorthEastDown;
+		ReferenceNorthEastDown(InGeoReferencingSystem, probe, referenceNorthEastDown);
+		CalculateNorthEastDownAtEcef(ReferenceEngineToEcef(InGeoReferencingSystem, probe), analyticNorthEastDown);
+		analyticErrorRadians = FMath::Max(analyticErrorRadians, NorthEastDownError(referenceNorthEastDown, analyticNorthEastDown));
+		constantErrorRadians = FMath::Max(constantErrorRadians, NorthEastDownError(referenceNorthEastDown, OriginNorthEastDown));
+	}
+
+	if (GloballyAffine && analyticErrorRadians <= MaxNorthEastDownErrorRadians)
+	{
+		NorthEastDownMode = ENorthEastDownMode::Analytic;
+	}
+	else if (constantErrorRadians <= MaxNorthEastDownErrorRadians)
+	{
+		NorthEastDownMode = ENorthEastDownMode::Constant;
+	}
+	else
+	{
+		NorthEastDownMode = ENorthEastDownMode::Reference;
+	}
+
+	//Analytic North, East, Down rotates every direction by the same normalized linear part, so the orientation frame is constant too
+	if (NorthEastDownMode == ENorthEastDownMode::Analytic)
+	{
+		glm::dmat3 rotation = OriginTile.EcefToEngineLinear;
+		for (int32 row = 0; row < 3; row++)
+		{
+			const double rowLength = glm::length(glm::dvec3(rotation[0][row], rotation[1][row], rotation[2][row]));
+			for (int32 column = 0; column < 3; column++)
+			{
+				rotation[column][row] /= (row == 1 ? -rowLength : rowLength);
+			}
+		}
+		ConstantEcefToEngineRotation = glm::normalize(glm::quat_cast(rotation));
+		ConstantEcefToEngineRotationValid = true;
+	}
+
+	UE_LOG(LogDISGeoTransformCache, Log, TEXT("Built transform cache for %s. Globally affine: %s (max error %g m). North, East, Down mode: %d (analytic error %g rad, constant error %g rad)."),
+		*InGeoReferencingSystem->GetName(), GloballyAffine ? TEXT("true") : TEXT("false"), globalErrorMeters, static_cast<int32>(NorthEastDownMode), analyticErrorRadians, constantErrorRadians);
+
+	ConfigureFlatEarthAffine(InGeoReferencingSystem);
+}
+
+void FDISGeoTransformCache::ConfigureFlatEarthAffine(AGeoReferencingSystem* InGeoReferencingSystem)
+{
+	if (Snapshot.ConversionMode == EGeoReferencingConversionMode::Exact)
+	{
+		return;
+	}
+
+	if (Snapshot.PlanetShape != EPlanetShape::FlatPlanet)
+	{
+		UE_LOG(LogDISGeoTransformCache, Log, TEXT("Flat earth affine conversions were requested for %s, but it is not a flat planet. Using exact conversions."), *InGeoReferencingSystem->GetName());
+		return;
+	}
+
+	FNorthEastDown originNorthEastDown;
+	ReferenceNorthEastDown(InGeoReferencingSystem, FVector::ZeroVector, originNorthEastDown);
+	const glm::dvec3 originEcef = ReferenceEngineToEcef(InGeoReferencingSystem, FVector::ZeroVector);
+	const glm::dquat originRotation = EcefToEngineRotation(originNorthEastDown, FEarthCenteredEarthFixedDouble(originEcef.x, originEcef.y, originEcef.z));
+
+	//Probe a ring at the edge of the exercise area, at the origin height and above it
+	const double radiusCentimeters = Snapshot.ExerciseAreaRadiusMeters * 100.;
+	double errorMeters = OriginTile.MaxErrorMeters;
+	double errorRadians = 0;
+	for (int32 direction = 0; direction < FlatEarthProbeDirections; direction++)
+	{
+		const double angle = 2 * DOUBLE_PI * direction / FlatEarthProbeDirections;
+		for (const double heightFraction : { 0., 0.1 })
+		{
+			const FVector probe(radiusCentimeters * FMath::Cos(angle), radiusCentimeters * FMath::Sin(angle), radiusCentimeters * heightFraction);
+			const glm::dvec3 referenceEcef = ReferenceEngineToEcef(InGeoReferencingSystem, probe);
+			errorMeters = FMath::Max(errorMeters, glm::length(OriginTile.EngineToEcef(ToDVec3(probe)) - referenceEcef));
+
+			FNorthEastDown referenceNorthEastDown;
+			ReferenceNorthEastDown(InGeoReferencingSystem, probe, referenceNorthEastDown);
+			const glm::dquat referenceRotation = EcefToEngineRotation(referenceNorthEastDown, FEarthCenteredEarthFixedDouble(referenceEcef.x, referenceEcef.y, referenceEcef.z));
+			errorRadians = FMath::Max(errorRadians, 2 * FMath::Acos(FMath::Min(1., FMath::Abs(glm::dot(originRotation, referenceRotation)))));
+		}
+	}
+	FlatEarthErrorMeters = errorMeters;
+	FlatEarthErrorDegrees = FMath::RadiansToDegrees(errorRadians);
+
+	const bool withinBudget = FMath::IsFinite(errorMeters) && errorMeters <= Snapshot.FlatEarthMaxErrorMeters;
+	if (!withinBudget)
+	{
+		UE_LOG(LogDISGeoTransformCache, Warning, TEXT("Flat earth affine conversions for %s exceed the error budget over the %g m exercise area: position error %g m (budget %g m), orientation error %g degrees.%s"),
+			*InGeoReferencingSystem->GetName(), Snapshot.ExerciseAreaRadiusMeters, FlatEarthErrorMeters, Snapshot.FlatEarthMaxErrorMeters, FlatEarthErrorDegrees,
+			Snapshot.ConversionMode == EGeoReferencingConversionMode::Automatic ? TEXT(" Using exact conversions.") : TEXT(""));
+
+		if (Snapshot.ConversionMode == EGeoReferencingConversionMode::Automatic)
+		{
+			return;
+		}
+	}
+
+	FlatEarthAffine = true;
+	GloballyAffine = true;
+	MaxTileErrorMeters = FlatEarthErrorMeters;
+	NorthEastDownMode = ENorthEastDownMode::Constant;
+	OriginNorthEastDown = originNorthEastDown;
+	ConstantEcefToEngineRotation = originRotation;
+	ConstantEcefToEngineRotationValid = true;
+
+	UE_LOG(LogDISGeoTransformCache, Log, TEXT("Using flat earth affine conversions for %s. Position error %g m, orientation error %g degrees over the %g m exercise area."),
+		*InGeoReferencingSystem->GetName(), FlatEarthErrorMeters, FlatEarthErrorDegrees, Snapshot.ExerciseAreaRadiusMeters);
+}
+
+void FDISGeoTransformCache::FitTile(const glm::dvec3& CenterEngineLocation, double HalfSizeCentimeters, FDISGeoTransformTile& OutTile) const
+{
+	INC_DWORD_STAT(STAT_GeoTransformCacheTilesBuilt);
+
+	AGeoReferencingSystem* geoReferencingSystem = GeoReferencingSystem.Get();
+	const FVector center(CenterEngineLocation.x, CenterEngineLocation.y, CenterEngineLocation.z);
+
+	//Secant fit across the tile. Engine locations are single precision, so use the rounded probe locations for the step size.
+	for (int32 axis = 0; axis < 3; axis++)
+	{
+		FVector plus = center;
+		FVector minus = center;
+		plus[axis] += HalfSizeCentimeters;
+		minus[axis] -= HalfSizeCentimeters;
+		OutTile.EngineToEcefLinear[axis] = (ReferenceEngineToEcef(geoReferencingSystem, plus) - ReferenceEngineToEcef(geoReferencingSystem, minus)) / (static_cast<double>(plus[axis]) - minus[axis]);
+	}
+	OutTile.EngineToEcefTranslation = ReferenceEngineToEcef(geoReferencingSystem, center) - OutTile.EngineToEcefLinear * ToDVec3(center);
+
+	OutTile.EcefToEngineLinear = glm::inverse(OutTile.EngineToEcefLinear);
+	OutTile.EcefToEngineTranslation = -(OutTile.EcefToEngineLinear * OutTile.EngineToEcefTranslation);
+
+	//Error is largest at the corners of the tile
+	OutTile.MaxErrorMeters = 0;
+	for (int32 corner = 0; corner < 8; corner++)
+	{
+		const FVector probe = center + FVector(corner & 1 ? HalfSizeCentimeters : -HalfSizeCentimeters,
+			corner & 2 ? HalfSizeCentimeters : -HalfSizeCentimeters,
+			corner & 4 ? HalfSizeCentimeters : -HalfSizeCentimeters);
+		OutTile.MaxErrorMeters = FMath::Max(OutTile.MaxErrorMeters, glm::length(OutTile.EngineToEcef(ToDVec3(probe)) - ReferenceEngineToEcef(geoReferencingSystem, probe)));
+	}
+	OutTile.WithinErrorBudget = FMath::IsFinite(OutTile.MaxErrorMeters) && OutTile.MaxErrorMeters <= Snapshot.MaxErrorMeters;
+}
+
+bool FDISGeoTransformCache::FindOrBuildTile(const glm::dvec3& EngineLocation, FDISGeoTransformTile& OutTile)
+{
+	if (GloballyAffine)
+	{
+		OutTile = OriginTile;
+		return true;
+	}
+
+	const FIntVector key(static_cast<int32>(FMath::FloorToDouble(EngineLocation.x / TileSizeCentimeters)),
+		static_cast<int32>(FMath::FloorToDouble(EngineLocation.y / TileSizeCentimeters)),
+		static_cast<int32>(FMath::FloorToDouble(EngineLocation.z / TileSizeCentimeters)));
+
+	{
+		FReadScopeLock readLock(TilesLock);
+		if (const FDISGeoTransformTile* tile = Tiles.Find(key))
+		{
+			OutTile = *tile;
+			return OutTile.WithinErrorBudget;
+		}
+	}
+
+	if (!GeoReferencingSystem.IsValid())
+	{
+		return false;
+	}
+
+	const glm::dvec3 tileCenter = (glm::dvec3(key.X, key.Y, key.Z) + 0.5) * TileSizeCentimeters;
+	FitTile(tileCenter, TileSizeCentimeters / 2, OutTile);
+
+	FWriteScopeLock writeLock(TilesLock);
+	if (Tiles.Num() >= MaxTiles)
+	{
+		UE_LOG(LogDISGeoTransformCache, Verbose, TEXT("Transform cache reached %d tiles, clearing it."), MaxTiles);
+		Tiles.Reset();
+	}
+	Tiles.Add(key, OutTile);
+	MaxTileErrorMeters = FMath::Max(MaxTileErrorMeters, OutTile.MaxErrorMeters);
+
+	return OutTile.WithinErrorBudget;
+}
+
+void FDISGeoTransformCache::EngineToEcef(const FVector& EngineLocation, FEarthCenteredEarthFixedDouble& OutEcef)
+{
+	const glm::dvec3 engineLocation = ToDVec3(EngineLocation);
+
+	FDISGeoTransformTile tile;
+	if (FindOrBuildTile(engineLocation, tile))
+	{
+		INC_DWORD_STAT(STAT_GeoTransformCacheHits);
+		const glm::dvec3 ecef = tile.EngineToEcef(engineLocation);
+		OutEcef = FEarthCenteredEarthFixedDouble(ecef.x, ecef.y, ecef.z);
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_GeoTransformCacheFallbacks);
+	AGeoReferencingSystem* geoReferencingSystem = GeoReferencingSystem.Get();
+	if (geoReferencingSystem)
+	{
+		const glm::dvec3 ecef = ReferenceEngineToEcef(geoReferencingSystem, EngineLocation);
+		OutEcef = FEarthCenteredEarthFixedDouble(ecef.x, ecef.y, ecef.z);
+	}
+}
+
+void FDISGeoTransformCache::EcefToEngine(const FEarthCenteredEarthFixedDouble& Ecef, FVector& OutEngineLocation)
+{
+	const glm::dvec3 ecef(Ecef.X, Ecef.Y, Ecef.Z);
+
+	//The origin transform is close enough to find the right tile
+	glm::dvec3 engineLocation = OriginTile.EcefToEngine(ecef);
+
+	FDISGeoTransformTile tile;
+	if (FindOrBuildTile(engineLocation, tile))
+	{
+		INC_DWORD_STAT(STAT_GeoTransformCacheHits);
+		engineLocation = tile.EcefToEngine(ecef);
+		OutEngineLocation = FVector(engineLocation.x, engineLocation.y, engineLocation.z);
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_GeoTransformCacheFallbacks);
+	if (AGeoReferencingSystem* geoReferencingSystem = GeoReferencingSystem.Get())
+	{
+		geoReferencingSystem->ECEFToEngine(FCartesianCoordinates(Ecef.X, Ecef.Y, Ecef.Z), OutEngineLocation);
+	}
+}
+
+void FDISGeoTransformCache::CalculateNorthEastDownAtEcef(const glm::dvec3& Ecef, FNorthEastDown& OutNorthEastDown) const
+{
+	double latRadians, lonRadians, heightMeters;
+	DISGeodetic::EcefToGeodeticOlson(Ecef.x, Ecef.y, Ecef.z, latRadians, lonRadians, heightMeters);
+
+	const double sLat = FMath::Sin(latRadians), cLat = FMath::Cos(latRadians);
+	const double sLon = FMath::Sin(lonRadians), cLon = FMath::Cos(lonRadians);
+
+	//Directions only need the linear part, normalize to remove the meters to centimeters scale
+	auto toEngine = [this](const glm::dvec3& EcefDirection)
+	{
+		const glm::dvec3 engineDirection = glm::normalize(OriginTile.EcefToEngineLinear * EcefDirection);
+		return FVector(engineDirection.x, engineDirection.y, engineDirection.z);
+	};
+
+	OutNorthEastDown.NorthVector = toEngine(glm::dvec3(-sLat * cLon, -sLat * sLon, cLat));
+	OutNorthEastDown.EastVector = toEngine(glm::dvec3(-sLon, cLon, 0));
+	OutNorthEastDown.DownVector = toEngine(glm::dvec3(-cLat * cLon, -cLat * sLon, -sLat));
+}
+
+void FDISGeoTransformCache::GetNorthEastDownAtEngineLocation(const FVector& EngineLocation, FNorthEastDown& OutNorthEastDown)
+{
+	switch (NorthEastDownMode)
+	{
+	case ENorthEastDownMode::Analytic:
+	{
+		INC_DWORD_STAT(STAT_GeoTransformCacheHits);
+		CalculateNorthEastDownAtEcef(OriginTile.EngineToEcef(ToDVec3(EngineLocation)), OutNorthEastDown);
+		break;
+	}
+	case ENorthEastDownMode::Constant:
+	{
+		INC_DWORD_STAT(STAT_GeoTransformCacheHits);
+		OutNorthEastDown = OriginNorthEastDown;
+		break;
+	}
+	default:
+	{
+		INC_DWORD_STAT(STAT_GeoTransformCacheFallbacks);
+		if (AGeoReferencingSystem* geoReferencingSystem = GeoReferencingSystem.Get())
+		{
+			ReferenceNorthEastDown(geoReferencingSystem, EngineLocation, OutNorthEastDown);
+		}
+		break;
+	}
+	}
+}
+
+void FDISGeoTransformCache::GetNorthEastDownAtEcefLocation(const FEarthCenteredEarthFixedDouble& Ecef, FNorthEastDown& OutNorthEastDown)
+{
+	switch (NorthEastDownMode)
+	{
+	case ENorthEastDownMode::Analytic:
+	{
+		INC_DWORD_STAT(STAT_GeoTransformCacheHits);
+		CalculateNorthEastDownAtEcef(glm::dvec3(Ecef.X, Ecef.Y, Ecef.Z), OutNorthEastDown);
+		break;
+	}
+	case ENorthEastDownMode::Constant:
+	{
+		INC_DWORD_STAT(STAT_GeoTransformCacheHits);
+		OutNorthEastDown = OriginNorthEastDown;
+		break;
+	}
+	default:
+	{
+		INC_DWORD_STAT(STAT_GeoTransformCacheFallbacks);
+		if (AGeoReferencingSystem* geoReferencingSystem = GeoReferencingSystem.Get())
+		{
+			geoReferencingSystem->GetENUVectorsAtECEFLocation(FCartesianCoordinates(Ecef.X, Ecef.Y, Ecef.Z), OutNorthEastDown.EastVector, OutNorthEastDown.NorthVector, OutNorthEastDown.DownVector);
+			OutNorthEastDown.DownVector *= -1;
+		}
+		break;
+	}
+	}
+}
+
+glm::dquat FDISGeoTransformCache::GetEcefToEngineRotationAtEcefLocation(const FEarthCenteredEarthFixedDouble& Ecef)
+{
+	if (HasConstantEcefToEngineRotation())
+	{
+		INC_DWORD_STAT(STAT_GeoTransformCacheHits);
+		return ConstantEcefToEngineRotation;
+	}
+
+	FNorthEastDown northEastDown;
+	GetNorthEastDownAtEcefLocation(Ecef, northEastDown);
+	return EcefToEngineRotation(northEastDown, Ecef);
+}
+
+double FDISGeoTransformCache::GetMaxErrorMeters() const
+{
+	FReadScopeLock readLock(TilesLock);
+	return MaxTileErrorMeters;
+}
+
+int32 FDISGeoTransformCache::GetNumTiles() const
+{
+	FReadScopeLock readLock(TilesLock);
+	return GloballyAffine ? 1 : Tiles.Num() + 1;
+}
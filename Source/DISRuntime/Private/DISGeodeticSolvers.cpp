@@ -0,0 +1,17 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISGeodeticSolvers.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<int32> CVarEcefToGeodeticSolver(
+	TEXT("DIS.Geodetic.EcefToGeodeticSolver"),
+	1,
+	TEXT("Solver used for ECEF to latitude/longitude/height conversions.\n")
+	TEXT(" 0: Heikkinen closed form\n")
+	TEXT(" 1: Olson non-iterative (default)"),
+	ECVF_Default);
+
+EEcefToGeodeticSolver DISGeodetic::GetEcefToGeodeticSolver()
+{
+	return CVarEcefToGeodeticSolver.GetValueOnAnyThread() == 0 ? EEcefToGeodeticSolver::Heikkinen : EEcefToGeodeticSolver::Olson;
+}
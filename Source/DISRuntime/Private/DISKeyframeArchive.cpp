@@ -0,0 +1,367 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISKeyframeArchive.h"
+#include "DISEnumsAndStructs.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+#include "HAL/PlatformFilemanager.h"
+
+DEFINE_LOG_CATEGORY(LogDISKeyframes);
+
+namespace DISKeyframeParsing
+{
+	constexpr int32 PDUHeaderBytes = 12;
+	constexpr int32 PDUTypeOffset = 2;
+	constexpr int32 EntityIDOffset = 12;
+	constexpr int32 EntityStateAppearanceOffset = 84;
+	constexpr int32 EntityStateUpdateAppearanceOffset = 68;
+	//Bit 23 of the entity appearance
+	constexpr uint32 DeactivatedAppearance = 1u << 23;
+
+	inline uint32 ReadBigEndian32(const uint8* Bytes)
+	{
+		return (static_cast<uint32>(Bytes[0]) << 24) | (static_cast<uint32>(Bytes[1]) << 16) | (static_cast<uint32>(Bytes[2]) << 8) | Bytes[3];
+	}
+
+	inline void WriteBigEndian32(uint8* Bytes, uint32 Value)
+	{
+		Bytes[0] = static_cast<uint8>(Value >> 24);
+		Bytes[1] = static_cast<uint8>(Value >> 16);
+		Bytes[2] = static_cast<uint8>(Value >> 8);
+		Bytes[3] = static_cast<uint8>(Value);
+	}
+
+	/**
+	 * Exercise, site, application, and entity of the PDU's entity ID.
+	 */
+	inline uint64 GetEntityKey(const uint8* PDU)
+	{
+		const uint8* id = PDU + EntityIDOffset;
+		return (static_cast<uint64>(PDU[1]) << 48) | (static_cast<uint64>(id[0]) << 40) | (static_cast<uint64>(id[1]) << 32)
+			| (static_cast<uint64>(id[2]) << 24) | (static_cast<uint64>(id[3]) << 16) | (static_cast<uint64>(id[4]) << 8) | id[5];
+	}
+}
+
+void FDISExerciseStateTracker::FKeptDatagram::Set(const FDISCaptureRecordHeader& InRecord, TArrayView<const uint8> Payload)
+{
+	Record = InRecord;
+	Bytes.SetNumUninitialized(Payload.Num(), false);
+	FMemory::Memcpy(Bytes.GetData(), Payload.GetData(), Payload.Num());
+}
+
+void FDISExerciseStateTracker::AddDatagram(const FDISCaptureRecordHeader& Record, TArrayView<const uint8> Payload)
+{
+	if (Payload.Num() < DISKeyframeParsing::PDUHeaderBytes)
+	{
+		return;
+	}
+
+	const uint8* pdu = Payload.GetData();
+	const EPDUType pduType = static_cast<EPDUType>(pdu[DISKeyframeParsing::PDUTypeOffset]);
+	switch (pduType)
+	{
+	case EPDUType::EntityState:
+	{
+		if (Payload.Num() < DISKeyframeParsing::EntityStateAppearanceOffset + 4)
+		{
+			return;
+		}
+
+		const uint64 entityKey = DISKeyframeParsing::GetEntityKey(pdu);
+		if (DISKeyframeParsing::ReadBigEndian32(pdu + DISKeyframeParsing::EntityStateAppearanceOffset) & DISKeyframeParsing::DeactivatedAppearance)
+		{
+			Entities.Remove(entityKey);
+			return;
+		}
+
+		FEntity& entity = Entities.FindOrAdd(entityKey);
+		entity.EntityState.Set(Record, Payload);
+		entity.HasEntityStateUpdate = false;
+		return;
+	}
+	case EPDUType::EntityStateUpdate:
+	{
+		if (Payload.Num() < DISKeyframeParsing::EntityStateUpdateAppearanceOffset + 4)
+		{
+			return;
+		}
+
+		//Updates only apply to entities an Entity State PDU has created
+		const uint64 entityKey = DISKeyframeParsing::GetEntityKey(pdu);
+		FEntity* entity = Entities.Find(entityKey);
+		if (entity == nullptr)
+		{
+			return;
+		}
+
+		if (DISKeyframeParsing::ReadBigEndian32(pdu + DISKeyframeParsing::EntityStateUpdateAppearanceOffset) & DISKeyframeParsing::DeactivatedAppearance)
+		{
+			Entities.Remove(entityKey);
+			return;
+		}
+
+		entity->EntityStateUpdate.Set(Record, Payload);
+		entity->HasEntityStateUpdate = true;
+		return;
+	}
+	case EPDUType::Start_Resume:
+	case EPDUType::Stop_Freeze:
+		SimulationManagement.FindOrAdd(static_cast<uint8>(pduType)).Set(Record, Payload);
+		return;
+	default:
+		return;
+	}
+}
+
+void FDISExerciseStateTracker::Reset()
+{
+	Entities.Reset();
+	SimulationManagement.Reset();
+}
+
+void FDISExerciseStateTracker::ForEachDatagram(TFunctionRef<void(const FDISCaptureRecordHeader&, TArrayView<const uint8>)> Function) const
+{
+	TArray<const FKeptDatagram*> datagrams;
+	datagrams.Reserve(Entities.Num() * 2 + SimulationManagement.Num());
+	for (const TPair<uint64, FEntity>& entity : Entities)
+	{
+		datagrams.Add(&entity.Value.EntityState);
+		if (entity.Value.HasEntityStateUpdate)
+		{
+			datagrams.Add(&entity.Value.EntityStateUpdate);
+		}
+	}
+	for (const TPair<uint8, FKeptDatagram>& simulationManagement : SimulationManagement)
+	{
+		datagrams.Add(&simulationManagement.Value);
+	}
+
+	Algo::StableSortBy(datagrams, [](const FKeptDatagram* Datagram) { return Datagram->Record.TimestampTicks; });
+
+	for (const FKeptDatagram* datagram : datagrams)
+	{
+		Function(datagram->Record, TArrayView<const uint8>(datagram->Bytes));
+	}
+}
+
+void FDISExerciseStateTracker::ForEachDeactivatedDatagram(const FDISExerciseStateTracker& Other, TFunctionRef<void(const FDISCaptureRecordHeader&, TArrayView<const uint8>)> Function) const
+{
+	TArray<uint8> datagram;
+	for (const TPair<uint64, FEntity>& entity : Entities)
+	{
+		if (Other.Entities.Contains(entity.Key))
+		{
+			continue;
+		}
+
+		datagram = entity.Value.EntityState.Bytes;
+		uint8* appearance = datagram.GetData() + DISKeyframeParsing::EntityStateAppearanceOffset;
+		DISKeyframeParsing::WriteBigEndian32(appearance, DISKeyframeParsing::ReadBigEndian32(appearance) | DISKeyframeParsing::DeactivatedAppearance);
+		Function(entity.Value.EntityState.Record, TArrayView<const uint8>(datagram));
+	}
+}
+
+void FDISExerciseStateTracker::AppendKeyframe(int64 Ticks, const FDISCaptureReader::FPosition& Position, TArray<uint8>& OutBytes) const
+{
+	const int32 headerOffset = OutBytes.AddZeroed(sizeof(FDISKeyframeHeader));
+
+	FDISKeyframeHeader header;
+	header.TimestampTicks = Ticks;
+	header.CaptureOffset = Position.Offset;
+	header.CaptureSegment = Position.Segment;
+	header.NumRecords = 0;
+
+	ForEachDatagram([&OutBytes, &header](const FDISCaptureRecordHeader& Record, TArrayView<const uint8> Payload)
+	{
+		FDISCaptureRecordHeader record = Record;
+		record.PayloadBytes = Payload.Num();
+		OutBytes.Append(reinterpret_cast<const uint8*>(&record), sizeof(record));
+		OutBytes.Append(Payload.GetData(), Payload.Num());
+		header.NumRecords++;
+	});
+
+	header.RecordBytes = OutBytes.Num() - headerOffset - static_cast<int32>(sizeof(FDISKeyframeHeader));
+	FMemory::Memcpy(OutBytes.GetData() + headerOffset, &header, sizeof(header));
+}
+
+FDISKeyframeWriter::~FDISKeyframeWriter()
+{
+	Close();
+}
+
+bool FDISKeyframeWriter::Open(const FString& FilePath, float IntervalSeconds)
+{
+	Close();
+
+	File = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*FilePath);
+	if (File == nullptr)
+	{
+		UE_LOG(LogDISKeyframes, Error, TEXT("Could not create keyframe archive %s."), *FilePath);
+		return false;
+	}
+
+	const FDISCaptureFileHeader fileHeader = FDISCaptureFileHeader::Make(DISCaptureLog::KeyframeKind, 0, FDateTime::UtcNow().GetTicks());
+	File->Write(reinterpret_cast<const uint8*>(&fileHeader), sizeof(fileHeader));
+
+	IntervalTicks = static_cast<int64>(FMath::Max(IntervalSeconds, 0.1f) * ETimespan::TicksPerSecond);
+	NextKeyframeTicks = 0;
+	NumKeyframesWritten = 0;
+	State.Reset();
+
+	return true;
+}
+
+void FDISKeyframeWriter::Close()
+{
+	delete File;
+	File = nullptr;
+	State.Reset();
+}
+
+void FDISKeyframeWriter::AddDatagram(const FDISCaptureRecordHeader& Record, TArrayView<const uint8> Payload, const FDISCaptureReader::FPosition& Position)
+{
+	if (File == nullptr)
+	{
+		return;
+	}
+
+	//The keyframe holds everything before this datagram, so replay can pick up at it
+	if (Record.TimestampTicks >= NextKeyframeTicks)
+	{
+		if (!State.IsEmpty())
+		{
+			KeyframeBytes.Reset();
+			State.AppendKeyframe(Record.TimestampTicks, Position, KeyframeBytes);
+			File->Write(KeyframeBytes.GetData(), KeyframeBytes.Num());
+			NumKeyframesWritten++;
+		}
+		NextKeyframeTicks = Record.TimestampTicks + IntervalTicks;
+	}
+
+	State.AddDatagram(Record, Payload);
+}
+
+FDISKeyframeArchive::~FDISKeyframeArchive()
+{
+	Close();
+}
+
+bool FDISKeyframeArchive::Open(const FString& Directory, const FString& CaptureName)
+{
+	Close();
+
+	const FString filePath = DISCaptureLog::GetKeyframePath(Directory, CaptureName);
+	File = FPlatformFileManager::Get().GetPlatformFile().OpenRead(*filePath);
+	if (File == nullptr)
+	{
+		return false;
+	}
+
+	FDISCaptureFileHeader fileHeader;
+	if (!File->Read(reinterpret_cast<uint8*>(&fileHeader), sizeof(fileHeader)) || !fileHeader.IsValid(DISCaptureLog::KeyframeKind))
+	{
+		UE_LOG(LogDISKeyframes, Warning, TEXT("%s is not a valid keyframe archive."), *filePath);
+		Close();
+		return false;
+	}
+
+	//Only the headers are read, a keyframe cut short by a crash ends the archive
+	const int64 fileSize = File->Size();
+	int64 offset = fileHeader.HeaderBytes;
+	FKeyframe keyframe;
+	while (offset + static_cast<int64>(sizeof(FDISKeyframeHeader)) <= fileSize && File->Seek(offset)
+		&& File->Read(reinterpret_cast<uint8*>(&keyframe.Header), sizeof(FDISKeyframeHeader)))
+	{
+		keyframe.RecordsOffset = offset + sizeof(FDISKeyframeHeader);
+		if (keyframe.Header.RecordBytes < 0 || keyframe.RecordsOffset + keyframe.Header.RecordBytes > fileSize)
+		{
+			break;
+		}
+
+		//Segment sizes are only known to the capture reader, which moves on to the next segment from an offset past the end
+		if (keyframe.Header.CaptureSegment >= 0 && keyframe.Header.CaptureOffset >= static_cast<int64>(sizeof(FDISCaptureFileHeader)))
+		{
+			Keyframes.Add(keyframe);
+		}
+		offset = keyframe.RecordsOffset + keyframe.Header.RecordBytes;
+	}
+
+	UE_LOG(LogDISKeyframes, Log, TEXT("Opened keyframe archive %s with %d keyframes."), *filePath, Keyframes.Num());
+
+	return true;
+}
+
+void FDISKeyframeArchive::Close()
+{
+	delete File;
+	File = nullptr;
+	Keyframes.Reset();
+	KeyframeBytes.Empty();
+}
+
+bool FDISKeyframeArchive::LoadKeyframe(int64 Ticks, FDISExerciseStateTracker& OutState, FDISCaptureReader::FPosition& OutPosition, int64& OutKeyframeTicks)
+{
+	const int32 keyframeIndex = Algo::UpperBoundBy(Keyframes, Ticks, [](const FKeyframe& Keyframe) { return Keyframe.Header.TimestampTicks; }) - 1;
+	if (File == nullptr || !Keyframes.IsValidIndex(keyframeIndex))
+	{
+		return false;
+	}
+
+	const FKeyframe& keyframe = Keyframes[keyframeIndex];
+	KeyframeBytes.SetNumUninitialized(keyframe.Header.RecordBytes, false);
+	if (!File->Seek(keyframe.RecordsOffset) || !File->Read(KeyframeBytes.GetData(), KeyframeBytes.Num()))
+	{
+		return false;
+	}
+
+	OutState.Reset();
+	int64 offset = 0;
+	FDISCaptureRecordHeader record;
+	while (offset + static_cast<int64>(sizeof(record)) <= KeyframeBytes.Num())
+	{
+		FMemory::Memcpy(&record, KeyframeBytes.GetData() + offset, sizeof(record));
+		offset += sizeof(record);
+		if (offset + record.PayloadBytes > KeyframeBytes.Num())
+		{
+			break;
+		}
+
+		OutState.AddDatagram(record, TArrayView<const uint8>(KeyframeBytes.GetData() + offset, record.PayloadBytes));
+		offset += record.PayloadBytes;
+	}
+
+	OutPosition.Segment = keyframe.Header.CaptureSegment;
+	OutPosition.Offset = keyframe.Header.CaptureOffset;
+	OutKeyframeTicks = keyframe.Header.TimestampTicks;
+
+	return true;
+}
+
+bool FDISKeyframeArchive::BuildFromCapture(const FString& Directory, const FString& CaptureName, float IntervalSeconds)
+{
+	FDISCaptureReader reader;
+	if (!reader.Open(Directory, CaptureName))
+	{
+		return false;
+	}
+
+	FDISKeyframeWriter writer;
+	if (!writer.Open(DISCaptureLog::GetKeyframePath(Directory, CaptureName), IntervalSeconds))
+	{
+		return false;
+	}
+
+	const double startSeconds = FPlatformTime::Seconds();
+	FDISCaptureRecordHeader record;
+	TArrayView<const uint8> payload;
+	FDISCaptureReader::FPosition position = reader.GetPosition();
+	while (reader.ReadNext(record, payload))
+	{
+		writer.AddDatagram(record, payload, position);
+		position = reader.GetPosition();
+	}
+
+	UE_LOG(LogDISKeyframes, Log, TEXT("Built %d keyframes for capture %s in %.2f s."), writer.GetNumKeyframesWritten(), *CaptureName, FPlatformTime::Seconds() - startSeconds);
+
+	return true;
+}
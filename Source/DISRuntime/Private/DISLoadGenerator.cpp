@@ -0,0 +1,597 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISLoadGenerator.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/IConsoleManager.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "Common/UdpSocketBuilder.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "PDUs/EntityInfoFamily/GRILL_EntityStatePDU.h"
+#include "PDUs/WarfareFamily/GRILL_FirePDU.h"
+#include "PDUs/WarfareFamily/GRILL_DetonationPDU.h"
+#include "PDUs/DistributedEmissionsFamily/GRILL_ElectromagneticEmissionsPDU.h"
+
+DEFINE_LOG_CATEGORY(LogDISLoadGenerator);
+
+#if !UE_BUILD_SHIPPING
+namespace DISLoadGeneration
+{
+	//Equatorial radius of WGS84. Entities drive on a plane tangent to the earth where the equator meets the prime meridian, so east is ECEF Y and north is ECEF Z
+	const double EarthRadiusMeters = 6378137.;
+
+	//Byte offsets of the fields rewritten on every update
+	const int32 TimestampOffset = 4;
+	const int32 LengthOffset = 8;
+	const int32 EntityStateVelocityOffset = 36;
+	const int32 EntityStateLocationOffset = 48;
+	const int32 EntityStateOrientationOffset = 72;
+	const int32 EntityStateAppearanceOffset = 84;
+	const int32 EntityStateArticulationsOffset = 144;
+	const int32 EntityStateUpdateVelocityOffset = 20;
+	const int32 EntityStateUpdateLocationOffset = 32;
+	const int32 EntityStateUpdateOrientationOffset = 56;
+	const int32 EntityStateUpdateArticulationsOffset = 72;
+	const int32 ArticulationBytes = 16;
+
+	void WriteBigEndian(uint8* Bytes, const void* Value, int32 NumBytes)
+	{
+		const uint8* valueBytes = static_cast<const uint8*>(Value);
+		for (int32 i = 0; i < NumBytes; i++)
+		{
+			Bytes[i] = valueBytes[NumBytes - 1 - i];
+		}
+	}
+
+	void WriteFloats(uint8* Bytes, const FVector& Value)
+	{
+		const float values[3] = { Value.X, Value.Y, Value.Z };
+		for (int32 i = 0; i < 3; i++)
+		{
+			WriteBigEndian(Bytes + i * 4, &values[i], 4);
+		}
+	}
+
+	void WriteDoubles(uint8* Bytes, const FVector& Value)
+	{
+		//Locations are a few thousand kilometers from the earth's center, so they are rebuilt from the double origin rather than kept in float
+		const double values[3] = { EarthRadiusMeters + Value.X, Value.Y, Value.Z };
+		for (int32 i = 0; i < 3; i++)
+		{
+			WriteBigEndian(Bytes + i * 8, &values[i], 8);
+		}
+	}
+
+	/**
+	 * DIS relative timestamp: units of 2^-31 hours past the hour, shifted up past the absolute bit.
+	 */
+	void WriteTimestamp(TArray<uint8>& Bytes, double SecondsPastHour)
+	{
+		const uint32 timestamp = static_cast<uint32>(FMath::Fmod(SecondsPastHour, 3600.) / 3600. * 0x7FFFFFFF) << 1;
+		WriteBigEndian(Bytes.GetData() + TimestampOffset, &timestamp, 4);
+	}
+
+	/**
+	 * The PDU structs only hold a byte of length, so the length field is filled in from the encoded size.
+	 */
+	void WriteLength(TArray<uint8>& Bytes)
+	{
+		const uint16 length = static_cast<uint16>(Bytes.Num());
+		WriteBigEndian(Bytes.GetData() + LengthOffset, &length, 2);
+	}
+
+	/**
+	 * DIS Euler angles of an entity driving level along the given heading, measured clockwise from north.
+	 */
+	FVector GetOrientation(float Heading)
+	{
+		//Body axes in ECEF at the origin, where down is -X
+		const FVector forward(0.f, FMath::Sin(Heading), FMath::Cos(Heading));
+		const FVector right(0.f, FMath::Cos(Heading), -FMath::Sin(Heading));
+		const FVector down(-1.f, 0.f, 0.f);
+
+		const float psi = FMath::Atan2(forward.Y, forward.X);
+		const float theta = FMath::Asin(FMath::Clamp(-forward.Z, -1.f, 1.f));
+		const float phi = FMath::Atan2(right.Z, down.Z);
+		return FVector(psi, theta, phi);
+	}
+
+	FEntityType MakeEntityType(int32 Kind, int32 Domain, int32 Category, int32 Subcategory, int32 Specific)
+	{
+		FEntityType entityType;
+		entityType.EntityKind = Kind;
+		entityType.Domain = Domain;
+		entityType.Country = 225;
+		entityType.Category = Category;
+		entityType.Subcategory = Subcategory;
+		entityType.Specific = Specific;
+		entityType.Extra = 0;
+		return entityType;
+	}
+}
+
+FDISLoadGenerator::FDISLoadGenerator(const FDISLoadGeneratorSettings& InSettings)
+	: Settings(InSettings)
+	, RandomStream(InSettings.Seed)
+{
+	Settings.NumEntities = FMath::Clamp(Settings.NumEntities, 1, 65534);
+	Settings.NumArticulations = FMath::Clamp(Settings.NumArticulations, 0, 32);
+	Settings.TargetPacketsPerSecond = FMath::Max(Settings.TargetPacketsPerSecond, 1.f);
+}
+
+FDISLoadGenerator::~FDISLoadGenerator()
+{
+	StopAndWait();
+}
+
+bool FDISLoadGenerator::Start()
+{
+	if (Thread != nullptr)
+	{
+		return false;
+	}
+
+	FIPv4Address address;
+	if (!FIPv4Address::Parse(Settings.Address, address))
+	{
+		UE_LOG(LogDISLoadGenerator, Error, TEXT("Load generator address is invalid <%s>"), *Settings.Address);
+		return false;
+	}
+
+	//Blocking sends, so a generator asked for more than the network stack takes is held back by it rather than dropping packets on the floor
+	FUdpSocketBuilder socketBuilder = FUdpSocketBuilder(TEXT("DISLoadGenerator")).AsReusable().WithSendBufferSize(Settings.SendBufferBytes);
+	if (address.IsMulticastAddress())
+	{
+		socketBuilder.WithMulticastLoopback().WithMulticastTtl(1);
+	}
+	Socket = socketBuilder.Build();
+	if (Socket == nullptr)
+	{
+		UE_LOG(LogDISLoadGenerator, Error, TEXT("Failed to open load generator socket for <%s:%d>"), *Settings.Address, Settings.Port);
+		return false;
+	}
+	Destination = FIPv4Endpoint(address, static_cast<uint16>(Settings.Port)).ToInternetAddr();
+
+	const FDateTime now = FDateTime::UtcNow();
+	StartSecondsPastHour = now.GetMinute() * 60. + now.GetSecond() + now.GetMillisecond() / 1000.;
+	StartSeconds = FPlatformTime::Seconds();
+
+	Entities.SetNum(Settings.NumEntities);
+	for (FSimulatedEntity& entity : Entities)
+	{
+		SpawnEntity(entity);
+	}
+
+	UE_LOG(LogDISLoadGenerator, Display, TEXT("Generating %.0f packets/s from %d entities to <%s:%d>"), Settings.TargetPacketsPerSecond, Settings.NumEntities, *Settings.Address, Settings.Port);
+
+	Thread = FRunnableThread::Create(this, TEXT("DISLoadGenerator"), 0, TPri_AboveNormal);
+	return Thread != nullptr;
+}
+
+void FDISLoadGenerator::StopAndWait()
+{
+	if (Thread != nullptr)
+	{
+		Stop();
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	if (Socket != nullptr)
+	{
+		Socket->Close();
+		ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Socket);
+		Socket = nullptr;
+	}
+}
+
+void FDISLoadGenerator::Stop()
+{
+	StopRequested = true;
+}
+
+FDISLoadGeneratorStats FDISLoadGenerator::GetStats() const
+{
+	FDISLoadGeneratorStats stats;
+	stats.Running = IsRunning();
+	stats.TargetPacketsPerSecond = Settings.TargetPacketsPerSecond;
+	if (StartSeconds <= 0)
+	{
+		return stats;
+	}
+
+	stats.ElapsedSeconds = static_cast<float>((Finished ? EndSeconds : FPlatformTime::Seconds()) - StartSeconds);
+	stats.PacketsSent = PacketsSent.GetValue();
+	stats.BytesSent = BytesSent.GetValue();
+	stats.SendFailures = SendFailures.GetValue();
+	stats.EntitiesChurned = EntitiesChurned.GetValue();
+	stats.RecentPacketsPerSecond = static_cast<float>(RecentPacketsPerSecond.GetValue());
+	if (stats.ElapsedSeconds > 0)
+	{
+		stats.AchievedPacketsPerSecond = stats.PacketsSent / stats.ElapsedSeconds;
+		stats.AchievedMegabitsPerSecond = stats.BytesSent * 8 / (stats.ElapsedSeconds * 1000000.f);
+	}
+	return stats;
+}
+
+uint32 FDISLoadGenerator::Run()
+{
+	const float otherShare = Settings.FireShare + Settings.DetonationShare + Settings.EmissionsShare;
+	const double target = Settings.TargetPacketsPerSecond;
+	//A generator that falls behind sends at most 10 ms worth of packets at a time so that it keeps checking for churn and stop requests
+	const int64 maxBurst = FMath::Max<int64>(1, static_cast<int64>(target * 0.01));
+
+	int64 packetsScheduled = 0;
+	int64 entitiesChurned = 0;
+	int32 nextUpdate = 0;
+	double rateWindowStart = StartSeconds;
+	int64 rateWindowPackets = 0;
+
+	while (!StopRequested)
+	{
+		const double now = FPlatformTime::Seconds();
+		const double elapsed = now - StartSeconds;
+		if (Settings.DurationSeconds > 0 && elapsed >= Settings.DurationSeconds)
+		{
+			break;
+		}
+
+		if (now - rateWindowStart >= 1.)
+		{
+			const int64 packetsSent = PacketsSent.GetValue();
+			RecentPacketsPerSecond.Set(static_cast<int64>((packetsSent - rateWindowPackets) / (now - rateWindowStart)));
+			rateWindowStart = now;
+			rateWindowPackets = packetsSent;
+		}
+
+		const int64 churnDue = static_cast<int64>(elapsed * Settings.ChurnPerSecond);
+		for (; entitiesChurned < churnDue; entitiesChurned++)
+		{
+			FSimulatedEntity& entity = Entities[RandomStream.RandHelper(Entities.Num())];
+			if (RandomStream.FRand() >= Settings.TimeoutShare)
+			{
+				SendDeactivation(entity);
+			}
+			SpawnEntity(entity);
+			EntitiesChurned.Increment();
+		}
+
+		const int64 packetsDue = FMath::Min(static_cast<int64>(elapsed * target) - packetsScheduled, maxBurst);
+		if (packetsDue <= 0)
+		{
+			//Sleep until the next packet is due, yielding instead when it is close since sleeps overshoot by up to a millisecond
+			const double secondsToNext = (packetsScheduled + 1) / target - elapsed;
+			FPlatformProcess::Sleep(secondsToNext > 0.002 ? static_cast<float>(secondsToNext - 0.001) : 0.f);
+			continue;
+		}
+
+		for (int64 i = 0; i < packetsDue; i++)
+		{
+			const float roll = RandomStream.FRand();
+			if (roll < Settings.FireShare)
+			{
+				SendFire(elapsed);
+			}
+			else if (roll < Settings.FireShare + Settings.DetonationShare)
+			{
+				SendDetonation(elapsed);
+			}
+			else if (roll < otherShare)
+			{
+				SendEmissions(elapsed);
+			}
+			else
+			{
+				//Entities are updated in turn, so each is updated at the same rate
+				SendEntityUpdate(Entities[nextUpdate], elapsed);
+				nextUpdate = (nextUpdate + 1) % Entities.Num();
+			}
+		}
+		packetsScheduled += packetsDue;
+	}
+
+	//Leave receivers with no entities to time out
+	for (FSimulatedEntity& entity : Entities)
+	{
+		SendDeactivation(entity);
+	}
+
+	EndSeconds = FPlatformTime::Seconds();
+	Finished = true;
+
+	const FDISLoadGeneratorStats stats = GetStats();
+	UE_LOG(LogDISLoadGenerator, Display, TEXT("Load generator stopped after %.1f s. %lld packets (%.0f packets/s of %.0f targeted, %.1f Mbit/s), %lld send failures, %lld entities churned."),
+		stats.ElapsedSeconds, stats.PacketsSent, stats.AchievedPacketsPerSecond, stats.TargetPacketsPerSecond, stats.AchievedMegabitsPerSecond, stats.SendFailures, stats.EntitiesChurned);
+	return 0;
+}
+
+void FDISLoadGenerator::SpawnEntity(FSimulatedEntity& OutEntity)
+{
+	OutEntity.EntityID.Site = Settings.SiteID;
+	OutEntity.EntityID.Application = Settings.ApplicationID;
+	OutEntity.EntityID.Entity = NextEntityNumber;
+	NextEntityNumber = NextEntityNumber % 65534 + 1;
+
+	const float area = Settings.AreaMeters;
+	OutEntity.Center = FVector2D(RandomStream.FRandRange(-area, area), RandomStream.FRandRange(-area, area));
+	OutEntity.Radius = RandomStream.FRandRange(0.05f, 0.25f) * area;
+	OutEntity.Phase = RandomStream.FRandRange(-PI, PI);
+	OutEntity.AngularSpeed = Settings.SpeedMetersPerSecond / OutEntity.Radius * (RandomStream.FRand() < 0.5f ? -1. : 1.);
+	OutEntity.SentEntityState = false;
+
+	FEntityStatePDU entityStatePDU;
+	entityStatePDU.ExerciseID = static_cast<uint8>(Settings.ExerciseID);
+	entityStatePDU.EntityID = OutEntity.EntityID;
+	entityStatePDU.ForceID = EForceID::Friendly;
+	entityStatePDU.EntityType = DISLoadGeneration::MakeEntityType(1, 1, 1, 1, 3);
+	entityStatePDU.Marking = FString::Printf(TEXT("LOAD%05d"), OutEntity.EntityID.Entity);
+	entityStatePDU.DeadReckoningParameters.DeadReckoningAlgorithm = Settings.DeadReckoningAlgorithm;
+	for (int32 i = 0; i < Settings.NumArticulations; i++)
+	{
+		//Azimuth of turret i + 1
+		FArticulationParameters articulation;
+		articulation.ParameterType = 4096 + i * 32 + 11;
+		entityStatePDU.ArticulationParameters.Add(articulation);
+	}
+
+	OutEntity.EntityState = entityStatePDU.ToBytes();
+	OutEntity.EntityStateUpdate = entityStatePDU.ToEntityStateUpdatePDU().ToBytes();
+	DISLoadGeneration::WriteLength(OutEntity.EntityState);
+	DISLoadGeneration::WriteLength(OutEntity.EntityStateUpdate);
+}
+
+void FDISLoadGenerator::GetEntityMotion(const FSimulatedEntity& Entity, double Seconds, FVector& OutLocation, FVector& OutVelocity, float& OutHeading) const
+{
+	const double angle = Entity.Phase + Entity.AngularSpeed * Seconds;
+	const double east = Entity.Center.X + Entity.Radius * FMath::Cos(angle);
+	const double north = Entity.Center.Y + Entity.Radius * FMath::Sin(angle);
+	const double eastVelocity = -Entity.Radius * Entity.AngularSpeed * FMath::Sin(angle);
+	const double northVelocity = Entity.Radius * Entity.AngularSpeed * FMath::Cos(angle);
+
+	//Up, east, north, as offsets from the origin in ECEF
+	OutLocation = FVector(0.f, east, north);
+	OutVelocity = FVector(0.f, eastVelocity, northVelocity);
+	OutHeading = static_cast<float>(FMath::Atan2(eastVelocity, northVelocity));
+}
+
+void FDISLoadGenerator::SendEntityUpdate(FSimulatedEntity& Entity, double Seconds)
+{
+	using namespace DISLoadGeneration;
+
+	FVector location;
+	FVector velocity;
+	float heading;
+	GetEntityMotion(Entity, Seconds, location, velocity, heading);
+	const FVector orientation = GetOrientation(heading);
+
+	//Receivers need an Entity State PDU before an update means anything
+	const bool sendUpdate = Entity.SentEntityState && RandomStream.FRand() < Settings.EntityStateUpdateShare;
+	TArray<uint8>& bytes = sendUpdate ? Entity.EntityStateUpdate : Entity.EntityState;
+	const int32 articulationsOffset = sendUpdate ? EntityStateUpdateArticulationsOffset : EntityStateArticulationsOffset;
+
+	WriteTimestamp(bytes, StartSecondsPastHour + Seconds);
+	WriteFloats(bytes.GetData() + (sendUpdate ? EntityStateUpdateVelocityOffset : EntityStateVelocityOffset), velocity);
+	WriteDoubles(bytes.GetData() + (sendUpdate ? EntityStateUpdateLocationOffset : EntityStateLocationOffset), location);
+	WriteFloats(bytes.GetData() + (sendUpdate ? EntityStateUpdateOrientationOffset : EntityStateOrientationOffset), orientation);
+
+	for (int32 i = 0; i < Settings.NumArticulations && articulationsOffset + (i + 1) * ArticulationBytes <= bytes.Num(); i++)
+	{
+		uint8* articulation = bytes.GetData() + articulationsOffset + i * ArticulationBytes;
+		const double value = FMath::Fmod(Seconds * 0.5 + i, 2. * PI);
+		articulation[1]++;
+		WriteBigEndian(articulation + 8, &value, 8);
+	}
+
+	Entity.SentEntityState |= !sendUpdate;
+	Send(bytes);
+}
+
+void FDISLoadGenerator::SendDeactivation(FSimulatedEntity& Entity)
+{
+	if (!Entity.SentEntityState)
+	{
+		return;
+	}
+
+	//Last Entity State PDU sent, with the deactivated bit of the appearance set
+	TArray<uint8> bytes = Entity.EntityState;
+	DISLoadGeneration::WriteTimestamp(bytes, StartSecondsPastHour + FPlatformTime::Seconds() - StartSeconds);
+	bytes[DISLoadGeneration::EntityStateAppearanceOffset + 1] |= 0x80;
+	Send(bytes);
+}
+
+void FDISLoadGenerator::SendFire(double Seconds)
+{
+	const FSimulatedEntity& shooter = Entities[RandomStream.RandHelper(Entities.Num())];
+	const FSimulatedEntity& target = Entities[RandomStream.RandHelper(Entities.Num())];
+	FVector location;
+	FVector velocity;
+	float heading;
+	GetEntityMotion(shooter, Seconds, location, velocity, heading);
+
+	FFirePDU firePDU;
+	firePDU.ExerciseID = static_cast<uint8>(Settings.ExerciseID);
+	firePDU.FiringEntityID = shooter.EntityID;
+	firePDU.TargetEntityID = target.EntityID;
+	firePDU.EventID.Site = Settings.SiteID;
+	firePDU.EventID.Application = Settings.ApplicationID;
+	firePDU.EventID.EventNumber = NextEventNumber;
+	NextEventNumber = NextEventNumber % 65535 + 1;
+	firePDU.LocationDouble[0] = DISLoadGeneration::EarthRadiusMeters + location.X;
+	firePDU.LocationDouble[1] = location.Y;
+	firePDU.LocationDouble[2] = location.Z;
+	firePDU.Location = FVector(firePDU.LocationDouble[0], firePDU.LocationDouble[1], firePDU.LocationDouble[2]);
+	firePDU.Velocity = FVector(0.f, FMath::Sin(heading), FMath::Cos(heading)) * 800.f;
+	firePDU.Range = 2000.f;
+	firePDU.BurstDescriptor.EntityType = DISLoadGeneration::MakeEntityType(2, 9, 2, 1, 0);
+	firePDU.BurstDescriptor.Warhead = 1000;
+	firePDU.BurstDescriptor.Fuse = 1000;
+	firePDU.BurstDescriptor.Quantity = 1;
+
+	TArray<uint8> bytes = firePDU.ToBytes();
+	DISLoadGeneration::WriteTimestamp(bytes, StartSecondsPastHour + Seconds);
+	DISLoadGeneration::WriteLength(bytes);
+	Send(bytes);
+}
+
+void FDISLoadGenerator::SendDetonation(double Seconds)
+{
+	const FSimulatedEntity& target = Entities[RandomStream.RandHelper(Entities.Num())];
+	FVector location;
+	FVector velocity;
+	float heading;
+	GetEntityMotion(target, Seconds, location, velocity, heading);
+
+	FDetonationPDU detonationPDU;
+	detonationPDU.ExerciseID = static_cast<uint8>(Settings.ExerciseID);
+	detonationPDU.FiringEntityID = Entities[RandomStream.RandHelper(Entities.Num())].EntityID;
+	detonationPDU.TargetEntityID = target.EntityID;
+	detonationPDU.EventID.Site = Settings.SiteID;
+	detonationPDU.EventID.Application = Settings.ApplicationID;
+	detonationPDU.EventID.EventNumber = NextEventNumber;
+	NextEventNumber = NextEventNumber % 65535 + 1;
+	detonationPDU.LocationDouble[0] = DISLoadGeneration::EarthRadiusMeters + location.X;
+	detonationPDU.LocationDouble[1] = location.Y;
+	detonationPDU.LocationDouble[2] = location.Z;
+	detonationPDU.Location = FVector(detonationPDU.LocationDouble[0], detonationPDU.LocationDouble[1], detonationPDU.LocationDouble[2]);
+	detonationPDU.BurstDescriptor.EntityType = DISLoadGeneration::MakeEntityType(2, 9, 2, 1, 0);
+	detonationPDU.BurstDescriptor.Warhead = 1000;
+	detonationPDU.BurstDescriptor.Fuse = 1000;
+	detonationPDU.BurstDescriptor.Quantity = 1;
+	detonationPDU.DetonationResult = EDetonationResult::EntityImpact;
+
+	TArray<uint8> bytes = detonationPDU.ToBytes();
+	DISLoadGeneration::WriteTimestamp(bytes, StartSecondsPastHour + Seconds);
+	DISLoadGeneration::WriteLength(bytes);
+	Send(bytes);
+}
+
+void FDISLoadGenerator::SendEmissions(double Seconds)
+{
+	FElectromagneticEmissionsPDU emissionsPDU;
+	emissionsPDU.ExerciseID = static_cast<uint8>(Settings.ExerciseID);
+	emissionsPDU.EmittingEntityID = Entities[RandomStream.RandHelper(Entities.Num())].EntityID;
+	emissionsPDU.EventID.Site = Settings.SiteID;
+	emissionsPDU.EventID.Application = Settings.ApplicationID;
+	emissionsPDU.EventID.EventNumber = NextEventNumber;
+	NextEventNumber = NextEventNumber % 65535 + 1;
+	emissionsPDU.StateUpdateIndicator = 0;
+
+	TArray<uint8> bytes = emissionsPDU.ToBytes();
+	DISLoadGeneration::WriteTimestamp(bytes, StartSecondsPastHour + Seconds);
+	DISLoadGeneration::WriteLength(bytes);
+	Send(bytes);
+}
+
+bool FDISLoadGenerator::Send(const TArray<uint8>& Bytes)
+{
+	int32 bytesSent = 0;
+	if (!Socket->SendTo(Bytes.GetData(), Bytes.Num(), bytesSent, *Destination) || bytesSent != Bytes.Num())
+	{
+		SendFailures.Increment();
+		return false;
+	}
+
+	PacketsSent.Increment();
+	BytesSent.Add(bytesSent);
+	return true;
+}
+
+void FDISLoadGenerator::ParseSettings(const TCHAR* Params, FDISLoadGeneratorSettings& InOutSettings)
+{
+	FParse::Value(Params, TEXT("Address="), InOutSettings.Address);
+	FParse::Value(Params, TEXT("Port="), InOutSettings.Port);
+	FParse::Value(Params, TEXT("Exercise="), InOutSettings.ExerciseID);
+	FParse::Value(Params, TEXT("Site="), InOutSettings.SiteID);
+	FParse::Value(Params, TEXT("Application="), InOutSettings.ApplicationID);
+	FParse::Value(Params, TEXT("Entities="), InOutSettings.NumEntities);
+	FParse::Value(Params, TEXT("Rate="), InOutSettings.TargetPacketsPerSecond);
+	FParse::Value(Params, TEXT("Duration="), InOutSettings.DurationSeconds);
+	FParse::Value(Params, TEXT("Articulations="), InOutSettings.NumArticulations);
+	FParse::Value(Params, TEXT("ESU="), InOutSettings.EntityStateUpdateShare);
+	FParse::Value(Params, TEXT("Fire="), InOutSettings.FireShare);
+	FParse::Value(Params, TEXT("Detonation="), InOutSettings.DetonationShare);
+	FParse::Value(Params, TEXT("Emissions="), InOutSettings.EmissionsShare);
+	FParse::Value(Params, TEXT("Churn="), InOutSettings.ChurnPerSecond);
+	FParse::Value(Params, TEXT("Timeout="), InOutSettings.TimeoutShare);
+	FParse::Value(Params, TEXT("Area="), InOutSettings.AreaMeters);
+	FParse::Value(Params, TEXT("Speed="), InOutSettings.SpeedMetersPerSecond);
+	FParse::Value(Params, TEXT("Seed="), InOutSettings.Seed);
+	FParse::Value(Params, TEXT("SendBuffer="), InOutSettings.SendBufferBytes);
+
+	FString deadReckoning;
+	if (FParse::Value(Params, TEXT("DR="), deadReckoning))
+	{
+		const int64 value = StaticEnum<EDeadReckoningAlgorithm>()->GetValueByNameString(deadReckoning);
+		if (value != INDEX_NONE)
+		{
+			InOutSettings.DeadReckoningAlgorithm = static_cast<EDeadReckoningAlgorithm>(value);
+		}
+		else
+		{
+			UE_LOG(LogDISLoadGenerator, Warning, TEXT("Unknown dead reckoning algorithm <%s>, keeping %s"), *deadReckoning,
+				*StaticEnum<EDeadReckoningAlgorithm>()->GetNameStringByValue(static_cast<int64>(InOutSettings.DeadReckoningAlgorithm)));
+		}
+	}
+}
+
+namespace DISLoadGeneratorConsole
+{
+	TUniquePtr<FDISLoadGenerator> Generator;
+
+	void LogStats()
+	{
+		if (!Generator.IsValid())
+		{
+			UE_LOG(LogDISLoadGenerator, Display, TEXT("No load generator has been started."));
+			return;
+		}
+
+		const FDISLoadGeneratorStats stats = Generator->GetStats();
+		UE_LOG(LogDISLoadGenerator, Display, TEXT("Load generator %s at %.1f s. %lld packets, %.0f packets/s of %.0f targeted (%.0f over the last second), %.1f Mbit/s, %lld send failures, %lld entities churned."),
+			stats.Running ? TEXT("running") : TEXT("stopped"), stats.ElapsedSeconds, stats.PacketsSent, stats.AchievedPacketsPerSecond, stats.TargetPacketsPerSecond,
+			stats.RecentPacketsPerSecond, stats.AchievedMegabitsPerSecond, stats.SendFailures, stats.EntitiesChurned);
+	}
+
+	void RunLoadGeneratorCommandFromConsole(const TArray<FString>& Args, UWorld* World)
+	{
+		const FString command = Args.Num() > 0 ? Args[0] : TEXT("Stats");
+		if (command.Equals(TEXT("Start"), ESearchCase::IgnoreCase))
+		{
+			Generator.Reset();
+
+			FDISLoadGeneratorSettings settings;
+			FDISLoadGenerator::ParseSettings(*FString::Join(Args, TEXT(" ")), settings);
+			Generator = MakeUnique<FDISLoadGenerator>(settings);
+			if (!Generator->Start())
+			{
+				Generator.Reset();
+			}
+		}
+		else if (command.Equals(TEXT("Stop"), ESearchCase::IgnoreCase))
+		{
+			if (Generator.IsValid())
+			{
+				Generator->StopAndWait();
+			}
+			LogStats();
+		}
+		else
+		{
+			LogStats();
+		}
+	}
+
+	static FAutoConsoleCommandWithWorldAndArgs DISLoadGeneratorCommand(
+		TEXT("DIS.LoadGen"),
+		TEXT("Sends synthetic DIS traffic for load testing. Usage: DIS.LoadGen Start [Entities=1000] [Rate=5000] [Address=127.0.0.1] [Port=3000] [Duration=0] [DR=FPW] [Articulations=0] [ESU=0] [Fire=0.01] [Detonation=0.01] [Emissions=0] [Churn=0] [Timeout=0] [Seed=46] | Stop | Stats"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunLoadGeneratorCommandFromConsole));
+}
+
+void FDISLoadGenerator::StopConsoleGenerator()
+{
+	DISLoadGeneratorConsole::Generator.Reset();
+}
+
+#endif
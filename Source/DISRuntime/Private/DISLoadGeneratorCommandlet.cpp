@@ -0,0 +1,50 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISLoadGeneratorCommandlet.h"
+#include "DISLoadGenerator.h"
+
+UDISLoadGeneratorCommandlet::UDISLoadGeneratorCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UDISLoadGeneratorCommandlet::Main(const FString& Params)
+{
+#if UE_BUILD_SHIPPING
+	UE_LOG(LogDISLoadGenerator, Error, TEXT("The load generator commandlet is not available in shipping builds."));
+	return 1;
+#else
+	//Run for a minute unless told otherwise, as a commandlet cannot be stopped from the console
+	FDISLoadGeneratorSettings settings;
+	settings.DurationSeconds = 60;
+	FDISLoadGenerator::ParseSettings(*Params, settings);
+	if (settings.DurationSeconds <= 0)
+	{
+		UE_LOG(LogDISLoadGenerator, Error, TEXT("The load generator commandlet needs a duration greater than zero."));
+		return 1;
+	}
+
+	FDISLoadGenerator generator(settings);
+	if (!generator.Start())
+	{
+		return 1;
+	}
+
+	while (generator.IsRunning())
+	{
+		FPlatformProcess::Sleep(1.f);
+
+		const FDISLoadGeneratorStats stats = generator.GetStats();
+		UE_LOG(LogDISLoadGenerator, Display, TEXT("%.0f s: %.0f packets/s (%.0f over the last second) of %.0f targeted, %.1f Mbit/s, %lld send failures."),
+			stats.ElapsedSeconds, stats.AchievedPacketsPerSecond, stats.RecentPacketsPerSecond, stats.TargetPacketsPerSecond, stats.AchievedMegabitsPerSecond, stats.SendFailures);
+	}
+	generator.StopAndWait();
+
+	//Report a shortfall of more than a percent as a failure so scripted runs notice a generator that could not keep up
+	const FDISLoadGeneratorStats stats = generator.GetStats();
+	return stats.AchievedPacketsPerSecond >= stats.TargetPacketsPerSecond * 0.99f ? 0 : 2;
+#endif
+}
@@ -0,0 +1,130 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISPacketValidator.h"
+
+namespace DISPacketValidation
+{
+	//DIS 6 PDU header
+	const int32 HeaderBytes = 12;
+	const int32 PDUTypeOffset = 2;
+	const int32 LengthOffset = 8;
+
+	//PDU types decoded by the PDU Processor, from SISO-REF-010-2015 Annex A
+	const uint8 EntityStateType = 1;
+	const uint8 FireType = 2;
+	const uint8 DetonationType = 3;
+	const uint8 RemoveEntityType = 12;
+	const uint8 StartResumeType = 13;
+	const uint8 StopFreezeType = 14;
+	const uint8 ElectromagneticEmissionsType = 23;
+	const uint8 EntityStateUpdateType = 67;
+
+	//Sizes of the fixed fields of each PDU, header included, and where their record counts sit
+	const int32 EntityStateBytes = 144;
+	const int32 EntityStateArticulationCountOffset = 19;
+	const int32 FireBytes = 96;
+	const int32 DetonationBytes = 104;
+	const int32 DetonationArticulationCountOffset = 101;
+	const int32 RemoveEntityBytes = 28;
+	const int32 StartResumeBytes = 44;
+	const int32 StopFreezeBytes = 40;
+	const int32 EntityStateUpdateBytes = 72;
+	const int32 EntityStateUpdateArticulationCountOffset = 19;
+	const int32 ArticulationBytes = 16;
+
+	const int32 EmissionsBytes = 28;
+	const int32 EmissionsSystemCountOffset = 25;
+	const int32 EmissionSystemBytes = 20;
+	const int32 EmissionSystemBeamCountOffset = 1;
+	const int32 EmissionBeamBytes = 52;
+	const int32 EmissionBeamTargetCountOffset = 45;
+	const int32 TrackJamTargetBytes = 8;
+
+	//Open DIS holds the Entity State PDU articulation count in a signed char, so larger counts come out negative and their articulations are silently dropped
+	const int32 MaxEntityStateArticulations = 127;
+
+	EDISPacketRejectReason ValidateArticulations(const uint8* Bytes, int32 PDUBytes, int32 FixedBytes, int32 CountOffset)
+	{
+		if (PDUBytes < FixedBytes)
+		{
+			return EDISPacketRejectReason::TooShortForPDU;
+		}
+		return FixedBytes + Bytes[CountOffset] * ArticulationBytes > PDUBytes ? EDISPacketRejectReason::RecordsOverrun : EDISPacketRejectReason::None;
+	}
+
+	EDISPacketRejectReason ValidateEmissions(const uint8* Bytes, int32 PDUBytes)
+	{
+		if (PDUBytes < EmissionsBytes)
+		{
+			return EDISPacketRejectReason::TooShortForPDU;
+		}
+
+		//Every record is at least as long as its fixed fields, so the walk ends within a few thousand records however the counts are set
+		int32 offset = EmissionsBytes;
+		const int32 numSystems = Bytes[EmissionsSystemCountOffset];
+		for (int32 system = 0; system < numSystems; system++)
+		{
+			if (offset + EmissionSystemBytes > PDUBytes)
+			{
+				return EDISPacketRejectReason::RecordsOverrun;
+			}
+			const int32 numBeams = Bytes[offset + EmissionSystemBeamCountOffset];
+			offset += EmissionSystemBytes;
+
+			for (int32 beam = 0; beam < numBeams; beam++)
+			{
+				if (offset + EmissionBeamBytes > PDUBytes)
+				{
+					return EDISPacketRejectReason::RecordsOverrun;
+				}
+				offset += EmissionBeamBytes + Bytes[offset + EmissionBeamTargetCountOffset] * TrackJamTargetBytes;
+			}
+		}
+		return offset > PDUBytes ? EDISPacketRejectReason::RecordsOverrun : EDISPacketRejectReason::None;
+	}
+}
+
+EDISPacketRejectReason FDISPacketValidator::Validate(const uint8* Bytes, int32 NumBytes)
+{
+	using namespace DISPacketValidation;
+
+	if (Bytes == nullptr || NumBytes < HeaderBytes)
+	{
+		return EDISPacketRejectReason::TooShortForHeader;
+	}
+
+	const int32 pduBytes = (Bytes[LengthOffset] << 8) | Bytes[LengthOffset + 1];
+	if (pduBytes < HeaderBytes || pduBytes > NumBytes)
+	{
+		return EDISPacketRejectReason::LengthMismatch;
+	}
+
+	switch (Bytes[PDUTypeOffset])
+	{
+	case EntityStateType:
+	{
+		const EDISPacketRejectReason reason = ValidateArticulations(Bytes, pduBytes, EntityStateBytes, EntityStateArticulationCountOffset);
+		if (reason == EDISPacketRejectReason::None && Bytes[EntityStateArticulationCountOffset] > MaxEntityStateArticulations)
+		{
+			return EDISPacketRejectReason::TooManyRecords;
+		}
+		return reason;
+	}
+	case FireType:
+		return pduBytes < FireBytes ? EDISPacketRejectReason::TooShortForPDU : EDISPacketRejectReason::None;
+	case DetonationType:
+		return ValidateArticulations(Bytes, pduBytes, DetonationBytes, DetonationArticulationCountOffset);
+	case RemoveEntityType:
+		return pduBytes < RemoveEntityBytes ? EDISPacketRejectReason::TooShortForPDU : EDISPacketRejectReason::None;
+	case StartResumeType:
+		return pduBytes < StartResumeBytes ? EDISPacketRejectReason::TooShortForPDU : EDISPacketRejectReason::None;
+	case StopFreezeType:
+		return pduBytes < StopFreezeBytes ? EDISPacketRejectReason::TooShortForPDU : EDISPacketRejectReason::None;
+	case ElectromagneticEmissionsType:
+		return ValidateEmissions(Bytes, pduBytes);
+	case EntityStateUpdateType:
+		return ValidateArticulations(Bytes, pduBytes, EntityStateUpdateBytes, EntityStateUpdateArticulationCountOffset);
+	default:
+		return EDISPacketRejectReason::UnsupportedPDUType;
+	}
+}
@@ -0,0 +1,621 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISPcapReader.h"
+#include "Algo/BinarySearch.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Interfaces/IPv4/IPv4Address.h"
+
+DEFINE_LOG_CATEGORY(LogDISPcap);
+
+namespace DISPcapFormat
+{
+	constexpr uint32 PcapMicroseconds = 0xA1B2C3D4;
+	constexpr uint32 PcapMicrosecondsSwapped = 0xD4C3B2A1;
+	constexpr uint32 PcapNanoseconds = 0xA1B23C4D;
+	constexpr uint32 PcapNanosecondsSwapped = 0x4D3CB2A1;
+	constexpr int64 PcapFileHeaderBytes = 24;
+	constexpr int64 PcapRecordHeaderBytes = 16;
+
+	constexpr uint32 SectionHeaderBlock = 0x0A0D0D0A;
+	constexpr uint32 InterfaceDescriptionBlock = 1;
+	constexpr uint32 EnhancedPacketBlock = 6;
+	constexpr uint32 ByteOrderMagic = 0x1A2B3C4D;
+	constexpr uint32 ByteOrderMagicSwapped = 0x4D3C2B1A;
+	constexpr uint16 TimestampResolutionOption = 9;
+
+	//Anything larger is taken as damage rather than a real record
+	constexpr uint32 MaxRecordBytes = 16 * 1024 * 1024;
+
+	constexpr uint16 EtherTypeIPv4 = 0x0800;
+	constexpr uint16 EtherTypeVLAN = 0x8100;
+	constexpr uint16 EtherTypeQinQ = 0x88A8;
+	constexpr uint8 ProtocolUDP = 17;
+
+	inline uint16 ReadBigEndian16(const uint8* Bytes)
+	{
+		return static_cast<uint16>((Bytes[0] << 8) | Bytes[1]);
+	}
+
+	inline uint32 ReadBigEndian32(const uint8* Bytes)
+	{
+		return (static_cast<uint32>(Bytes[0]) << 24) | (static_cast<uint32>(Bytes[1]) << 16) | (static_cast<uint32>(Bytes[2]) << 8) | Bytes[3];
+	}
+}
+
+FDISPcapReader::FFileWindow::~FFileWindow()
+{
+	Close();
+}
+
+bool FDISPcapReader::FFileWindow::Open(const FString& FilePath)
+{
+	Close();
+
+	IPlatformFile& platformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const int64 fileSize = platformFile.FileSize(*FilePath);
+	if (fileSize <= 0)
+	{
+		return false;
+	}
+
+	MappedFile = platformFile.OpenMapped(*FilePath);
+	if (MappedFile == nullptr)
+	{
+		File = platformFile.OpenRead(*FilePath);
+		if (File == nullptr)
+		{
+			return false;
+		}
+	}
+
+	FileSize = fileSize;
+	return true;
+}
+
+void FDISPcapReader::FFileWindow::Close()
+{
+	//Regions have to be released before the file they map
+	delete MappedRegion;
+	MappedRegion = nullptr;
+	delete MappedFile;
+	MappedFile = nullptr;
+	delete File;
+	File = nullptr;
+
+	ReadBytes.Empty();
+	FileSize = 0;
+	ViewOffset = 0;
+	ViewBytes = 0;
+	ViewData = nullptr;
+}
+
+const uint8* FDISPcapReader::FFileWindow::Get(int64 Offset, int64 NumBytes)
+{
+	if (Offset < 0 || NumBytes < 0 || Offset + NumBytes > FileSize)
+	{
+		return nullptr;
+	}
+
+	if (ViewData != nullptr && Offset >= ViewOffset && Offset + NumBytes <= ViewOffset + ViewBytes)
+	{
+		return ViewData + (Offset - ViewOffset);
+	}
+
+	//Move the window to start just before the requested bytes
+	const int64 newOffset = Offset & ~static_cast<int64>(64 * 1024 - 1);
+	const int64 newBytes = FMath::Min(FMath::Max(WindowBytes, Offset + NumBytes - newOffset), FileSize - newOffset);
+
+	delete MappedRegion;
+	MappedRegion = nullptr;
+	ViewData = nullptr;
+
+	if (MappedFile != nullptr)
+	{
+		MappedRegion = MappedFile->MapRegion(newOffset, newBytes);
+		if (MappedRegion != nullptr)
+		{
+			ViewData = MappedRegion->GetMappedPtr();
+			ViewBytes = MappedRegion->GetMappedSize();
+		}
+	}
+	else if (File != nullptr)
+	{
+		ReadBytes.SetNumUninitialized(static_cast<int32>(newBytes), false);
+		if (File->Seek(newOffset) && File->Read(ReadBytes.GetData(), newBytes))
+		{
+			ViewData = ReadBytes.GetData();
+			ViewBytes = newBytes;
+		}
+	}
+
+	if (ViewData == nullptr)
+	{
+		return nullptr;
+	}
+
+	ViewOffset = newOffset;
+	return ViewData + (Offset - ViewOffset);
+}
+
+FDISPcapReader::~FDISPcapReader()
+{
+	Close();
+}
+
+bool FDISPcapReader::Open(const FString& FilePath, const FDISPcapFilter& Filter)
+{
+	Close();
+
+	if (!Window.Open(FilePath))
+	{
+		UE_LOG(LogDISPcap, Error, TEXT("Could not open %s."), *FilePath);
+		return false;
+	}
+
+	for (const int32 port : Filter.Ports)
+	{
+		Ports.Add(static_cast<uint16>(FMath::Clamp(port, 0, 65535)));
+	}
+	for (const FString& addressString : Filter.Addresses)
+	{
+		FIPv4Address address;
+		if (FIPv4Address::Parse(addressString, address))
+		{
+			Addresses.Add(address.Value);
+		}
+		else
+		{
+			UE_LOG(LogDISPcap, Warning, TEXT("Ignoring filter address %s, it is not an IPv4 address."), *addressString);
+		}
+	}
+
+	const uint8* fileHeader = Window.Get(0, DISPcapFormat::PcapFileHeaderBytes);
+	uint32 magic = 0;
+	if (fileHeader != nullptr)
+	{
+		FMemory::Memcpy(&magic, fileHeader, sizeof(magic));
+	}
+
+	if (magic == DISPcapFormat::SectionHeaderBlock)
+	{
+		//The byte order is set by the section header block itself
+		FirstState.PcapNg = true;
+		FirstState.Offset = 0;
+	}
+	else if (magic == DISPcapFormat::PcapMicroseconds || magic == DISPcapFormat::PcapMicrosecondsSwapped
+		|| magic == DISPcapFormat::PcapNanoseconds || magic == DISPcapFormat::PcapNanosecondsSwapped)
+	{
+		FirstState.PcapNg = false;
+		FirstState.Swapped = magic == DISPcapFormat::PcapMicrosecondsSwapped || magic == DISPcapFormat::PcapNanosecondsSwapped;
+		FirstState.Offset = DISPcapFormat::PcapFileHeaderBytes;
+
+		FInterface pcapInterface;
+		//The upper bits can hold the FCS length
+		pcapInterface.LinkType = Read32(fileHeader + 20, FirstState.Swapped) & 0x0FFFFFFF;
+		pcapInterface.ResolutionExponent = magic == DISPcapFormat::PcapNanoseconds || magic == DISPcapFormat::PcapNanosecondsSwapped ? 9 : 6;
+		FirstState.Interfaces.Add(pcapInterface);
+	}
+	else
+	{
+		UE_LOG(LogDISPcap, Error, TEXT("%s is not a pcap or pcapng file."), *FilePath);
+		Close();
+		return false;
+	}
+
+	//Scan once for the time span and seek points
+	const double scanStartSeconds = FPlatformTime::Seconds();
+	CountingPackets = true;
+	FParseState scanState = FirstState;
+	FDISCaptureRecordHeader record;
+	int64 payloadOffset;
+	int64 packetOffset;
+	int64 nextSeekPointTicks = MIN_int64;
+	while (ParseNextPacket(scanState, record, payloadOffset, packetOffset))
+	{
+		if (NumMatchingPackets == 1)
+		{
+			StartTicks = record.TimestampTicks;
+			EndTicks = record.TimestampTicks;
+		}
+		EndTicks = FMath::Max(EndTicks, record.TimestampTicks);
+
+		if (record.TimestampTicks >= nextSeekPointTicks)
+		{
+			FParseState seekPoint = scanState;
+			seekPoint.Offset = packetOffset;
+			SeekPoints.Emplace(record.TimestampTicks, MoveTemp(seekPoint));
+			nextSeekPointTicks = record.TimestampTicks + ETimespan::TicksPerSecond;
+		}
+	}
+	CountingPackets = false;
+
+	UE_LOG(LogDISPcap, Log, TEXT("Scanned %s in %.2f s. %lld UDP datagrams match the filter, %lld packets were skipped, and %lld fragmented datagrams were skipped."),
+		*FilePath, FPlatformTime::Seconds() - scanStartSeconds, NumMatchingPackets, NumSkippedPackets, NumFragmentedPackets);
+
+	Rewind();
+	return true;
+}
+
+void FDISPcapReader::Close()
+{
+	Window.Close();
+	Ports.Reset();
+	Addresses.Reset();
+	FirstState = FParseState();
+	State = FParseState();
+	HasPending = false;
+	SeekPoints.Reset();
+	StartTicks = 0;
+	EndTicks = 0;
+	NumMatchingPackets = 0;
+	NumSkippedPackets = 0;
+	NumFragmentedPackets = 0;
+}
+
+uint16 FDISPcapReader::Read16(const uint8* Bytes, bool Swapped)
+{
+	uint16 value;
+	FMemory::Memcpy(&value, Bytes, sizeof(value));
+	return Swapped ? BYTESWAP_ORDER16(value) : value;
+}
+
+uint32 FDISPcapReader::Read32(const uint8* Bytes, bool Swapped)
+{
+	uint32 value;
+	FMemory::Memcpy(&value, Bytes, sizeof(value));
+	return Swapped ? BYTESWAP_ORDER32(value) : value;
+}
+
+int64 FDISPcapReader::TimestampToTicks(const FInterface& Interface, uint64 Timestamp)
+{
+	static const int64 unixEpochTicks = FDateTime(1970, 1, 1).GetTicks();
+
+	int64 seconds;
+	int64 fractionTicks;
+	if (Interface.BinaryResolution)
+	{
+		const uint32 exponent = FMath::Min<uint32>(Interface.ResolutionExponent, 63);
+		seconds = static_cast<int64>(Timestamp >> exponent);
+		fractionTicks = static_cast<int64>(static_cast<double>(Timestamp & ((1ull << exponent) - 1)) / static_cast<double>(1ull << exponent) * ETimespan::TicksPerSecond);
+	}
+	else
+	{
+		uint64 unitsPerSecond = 1;
+		for (uint8 i = 0; i < FMath::Min<uint8>(Interface.ResolutionExponent, 19); i++)
+		{
+			unitsPerSecond *= 10;
+		}
+		seconds = static_cast<int64>(Timestamp / unitsPerSecond);
+		const uint64 fraction = Timestamp % unitsPerSecond;
+		fractionTicks = unitsPerSecond <= ETimespan::TicksPerSecond ? static_cast<int64>(fraction * (ETimespan::TicksPerSecond / unitsPerSecond))
+			: static_cast<int64>(fraction / (unitsPerSecond / ETimespan::TicksPerSecond));
+	}
+
+	return unixEpochTicks + seconds * ETimespan::TicksPerSecond + fractionTicks;
+}
+
+FDISPcapReader::EFrameResult FDISPcapReader::ParseFrame(const FInterface& Interface, const uint8* Frame, uint32 CapturedBytes, FDISCaptureRecordHeader& OutRecord, uint32& OutPayloadOffset) const
+{
+	uint32 ipOffset = 0;
+	switch (Interface.LinkType)
+	{
+	//Ethernet
+	case 1:
+	{
+		if (CapturedBytes < 14)
+		{
+			return EFrameResult::Skipped;
+		}
+		ipOffset = 14;
+		uint16 etherType = DISPcapFormat::ReadBigEndian16(Frame + 12);
+		while ((etherType == DISPcapFormat::EtherTypeVLAN || etherType == DISPcapFormat::EtherTypeQinQ) && CapturedBytes >= ipOffset + 4)
+		{
+			etherType = DISPcapFormat::ReadBigEndian16(Frame + ipOffset + 2);
+			ipOffset += 4;
+		}
+		if (etherType != DISPcapFormat::EtherTypeIPv4)
+		{
+			return EFrameResult::Skipped;
+		}
+		break;
+	}
+	//Linux cooked
+	case 113:
+	{
+		if (CapturedBytes < 16 || DISPcapFormat::ReadBigEndian16(Frame + 14) != DISPcapFormat::EtherTypeIPv4)
+		{
+			return EFrameResult::Skipped;
+		}
+		ipOffset = 16;
+		break;
+	}
+	//Linux cooked v2
+	case 276:
+	{
+		if (CapturedBytes < 20 || DISPcapFormat::ReadBigEndian16(Frame) != DISPcapFormat::EtherTypeIPv4)
+		{
+			return EFrameResult::Skipped;
+		}
+		ipOffset = 20;
+		break;
+	}
+	//BSD loopback, with the address family in the byte order of the capturing host
+	case 0:
+	{
+		if (CapturedBytes < 4 || !((Frame[0] == 2 && Frame[3] == 0) || (Frame[0] == 0 && Frame[3] == 2)))
+		{
+			return EFrameResult::Skipped;
+		}
+		ipOffset = 4;
+		break;
+	}
+	//OpenBSD loopback
+	case 108:
+	{
+		if (CapturedBytes < 4 || DISPcapFormat::ReadBigEndian32(Frame) != 2)
+		{
+			return EFrameResult::Skipped;
+		}
+		ipOffset = 4;
+		break;
+	}
+	//Raw IP
+	case 12:
+	case 14:
+	case 101:
+	case 228:
+		ipOffset = 0;
+		break;
+	default:
+		return EFrameResult::Skipped;
+	}
+
+	if (CapturedBytes < ipOffset + 20)
+	{
+		return EFrameResult::Skipped;
+	}
+	const uint8* ipHeader = Frame + ipOffset;
+	const uint32 ipHeaderBytes = (ipHeader[0] & 0x0F) * 4;
+	if ((ipHeader[0] >> 4) != 4 || ipHeaderBytes < 20 || ipHeader[9] != DISPcapFormat::ProtocolUDP)
+	{
+		return EFrameResult::Skipped;
+	}
+	//More fragments flag or a fragment offset
+	if ((DISPcapFormat::ReadBigEndian16(ipHeader + 6) & 0x3FFF) != 0)
+	{
+		return EFrameResult::Fragmented;
+	}
+
+	const uint32 udpOffset = ipOffset + ipHeaderBytes;
+	if (CapturedBytes < udpOffset + 8)
+	{
+		return EFrameResult::Skipped;
+	}
+	const uint8* udpHeader = Frame + udpOffset;
+	const uint32 udpBytes = DISPcapFormat::ReadBigEndian16(udpHeader + 4);
+	//Datagrams cut short by the snapshot length are not replayed
+	if (udpBytes < 8 || udpOffset + udpBytes > CapturedBytes)
+	{
+		return EFrameResult::Skipped;
+	}
+
+	const uint32 destinationAddress = DISPcapFormat::ReadBigEndian32(ipHeader + 16);
+	const uint16 destinationPort = DISPcapFormat::ReadBigEndian16(udpHeader + 2);
+	if ((Ports.Num() > 0 && !Ports.Contains(destinationPort)) || (Addresses.Num() > 0 && !Addresses.Contains(destinationAddress)))
+	{
+		return EFrameResult::Skipped;
+	}
+
+	OutRecord.PayloadBytes = udpBytes - 8;
+	OutRecord.SourceAddress = DISPcapFormat::ReadBigEndian32(ipHeader + 12);
+	OutRecord.SourcePort = DISPcapFormat::ReadBigEndian16(udpHeader);
+	OutRecord.ReceiveSocketID = 0;
+	OutRecord.Reserved = 0;
+	OutPayloadOffset = udpOffset + 8;
+
+	return EFrameResult::Matched;
+}
+
+bool FDISPcapReader::ParseNextPacket(FParseState& InOutState, FDISCaptureRecordHeader& OutRecord, int64& OutPayloadOffset, int64& OutPacketOffset)
+{
+	for (;;)
+	{
+		const int64 packetOffset = InOutState.Offset;
+		const uint8* frame = nullptr;
+		uint32 capturedBytes = 0;
+		int64 frameOffset = 0;
+		uint64 timestamp = 0;
+		const FInterface* frameInterface = nullptr;
+
+		if (!InOutState.PcapNg)
+		{
+			const uint8* recordHeader = Window.Get(packetOffset, DISPcapFormat::PcapRecordHeaderBytes);
+			if (recordHeader == nullptr)
+			{
+				return false;
+			}
+
+			const uint32 seconds = Read32(recordHeader, InOutState.Swapped);
+			const uint32 fraction = Read32(recordHeader + 4, InOutState.Swapped);
+			capturedBytes = Read32(recordHeader + 8, InOutState.Swapped);
+			if (capturedBytes > DISPcapFormat::MaxRecordBytes)
+			{
+				UE_LOG(LogDISPcap, Warning, TEXT("Damaged pcap record at offset %lld. Stopping there."), packetOffset);
+				return false;
+			}
+
+			frameInterface = &InOutState.Interfaces[0];
+			timestamp = static_cast<uint64>(seconds) * (frameInterface->ResolutionExponent == 9 ? 1000000000ull : 1000000ull) + fraction;
+			frameOffset = packetOffset + DISPcapFormat::PcapRecordHeaderBytes;
+			InOutState.Offset = frameOffset + capturedBytes;
+		}
+		else
+		{
+			const uint8* blockHeader = Window.Get(packetOffset, 12);
+			if (blockHeader == nullptr)
+			{
+				return false;
+			}
+
+			const uint32 blockType = Read32(blockHeader, InOutState.Swapped);
+			if (blockType == DISPcapFormat::SectionHeaderBlock)
+			{
+				//Each section sets its own byte order and interfaces
+				uint32 byteOrderMagic;
+				FMemory::Memcpy(&byteOrderMagic, blockHeader + 8, sizeof(byteOrderMagic));
+				if (byteOrderMagic != DISPcapFormat::ByteOrderMagic && byteOrderMagic != DISPcapFormat::ByteOrderMagicSwapped)
+				{
+					UE_LOG(LogDISPcap, Warning, TEXT("Damaged pcapng section at offset %lld. Stopping there."), packetOffset);
+					return false;
+				}
+				InOutState.Swapped = byteOrderMagic == DISPcapFormat::ByteOrderMagicSwapped;
+				InOutState.Interfaces.Reset();
+			}
+
+			const uint32 blockBytes = Read32(blockHeader + 4, InOutState.Swapped);
+			const uint8* block = blockBytes >= 12 && blockBytes % 4 == 0 && blockBytes <= DISPcapFormat::MaxRecordBytes ? Window.Get(packetOffset, blockBytes) : nullptr;
+			if (block == nullptr)
+			{
+				if (packetOffset + 12 < Window.GetFileSize())
+				{
+					UE_LOG(LogDISPcap, Warning, TEXT("Damaged or truncated pcapng block at offset %lld. Stopping there."), packetOffset);
+				}
+				return false;
+			}
+			InOutState.Offset = packetOffset + blockBytes;
+
+			if (blockType == DISPcapFormat::InterfaceDescriptionBlock && blockBytes >= 20)
+			{
+				FInterface blockInterface;
+				blockInterface.LinkType = Read16(block + 8, InOutState.Swapped);
+
+				uint32 optionOffset = 16;
+				while (optionOffset + 4 <= blockBytes - 4)
+				{
+					const uint16 optionCode = Read16(block + optionOffset, InOutState.Swapped);
+					const uint16 optionBytes = Read16(block + optionOffset + 2, InOutState.Swapped);
+					if (optionCode == 0)
+					{
+						break;
+					}
+					if (optionCode == DISPcapFormat::TimestampResolutionOption && optionBytes >= 1 && optionOffset + 5 <= blockBytes - 4)
+					{
+						blockInterface.BinaryResolution = (block[optionOffset + 4] & 0x80) != 0;
+						blockInterface.ResolutionExponent = block[optionOffset + 4] & 0x7F;
+					}
+					optionOffset += 4 + Align(optionBytes, 4);
+				}
+
+				InOutState.Interfaces.Add(blockInterface);
+				continue;
+			}
+
+			if (blockType != DISPcapFormat::EnhancedPacketBlock || blockBytes < 32)
+			{
+				continue;
+			}
+
+			const uint32 interfaceID = Read32(block + 8, InOutState.Swapped);
+			capturedBytes = Read32(block + 20, InOutState.Swapped);
+			if (!InOutState.Interfaces.IsValidIndex(interfaceID) || 28 + capturedBytes > blockBytes - 4)
+			{
+				continue;
+			}
+
+			frameInterface = &InOutState.Interfaces[interfaceID];
+			timestamp = (static_cast<uint64>(Read32(block + 12, InOutState.Swapped)) << 32) | Read32(block + 16, InOutState.Swapped);
+			frameOffset = packetOffset + 28;
+		}
+
+		frame = Window.Get(frameOffset, capturedBytes);
+		if (frame == nullptr)
+		{
+			//Truncated by the end of the file
+			return false;
+		}
+
+		uint32 payloadOffset;
+		const EFrameResult result = ParseFrame(*frameInterface, frame, capturedBytes, OutRecord, payloadOffset);
+		if (result == EFrameResult::Matched)
+		{
+			OutRecord.TimestampTicks = TimestampToTicks(*frameInterface, timestamp);
+			OutPayloadOffset = frameOffset + payloadOffset;
+			OutPacketOffset = packetOffset;
+			NumMatchingPackets += CountingPackets ? 1 : 0;
+			return true;
+		}
+
+		if (CountingPackets)
+		{
+			(result == EFrameResult::Fragmented ? NumFragmentedPackets : NumSkippedPackets)++;
+		}
+	}
+}
+
+bool FDISPcapReader::ParsePending()
+{
+	if (!HasPending)
+	{
+		int64 packetOffset;
+		HasPending = ParseNextPacket(State, PendingRecord, PendingPayloadOffset, packetOffset);
+	}
+
+	return HasPending;
+}
+
+bool FDISPcapReader::ReadNext(FDISCaptureRecordHeader& OutRecord, TArrayView<const uint8>& OutPayload)
+{
+	if (!ParsePending())
+	{
+		return false;
+	}
+	HasPending = false;
+
+	const uint8* payload = PendingRecord.PayloadBytes > 0 ? Window.Get(PendingPayloadOffset, PendingRecord.PayloadBytes) : nullptr;
+	if (PendingRecord.PayloadBytes > 0 && payload == nullptr)
+	{
+		return false;
+	}
+
+	OutRecord = PendingRecord;
+	OutPayload = TArrayView<const uint8>(payload, PendingRecord.PayloadBytes);
+	return true;
+}
+
+bool FDISPcapReader::PeekNextTicks(int64& OutTicks)
+{
+	if (!ParsePending())
+	{
+		return false;
+	}
+
+	OutTicks = PendingRecord.TimestampTicks;
+	return true;
+}
+
+void FDISPcapReader::Rewind()
+{
+	State = FirstState;
+	HasPending = false;
+}
+
+void FDISPcapReader::SeekToTicks(int64 Ticks)
+{
+	const int32 seekPointIndex = Algo::UpperBoundBy(SeekPoints, Ticks, [](const TPair<int64, FParseState>& SeekPoint) { return SeekPoint.Key; }) - 1;
+	if (SeekPoints.IsValidIndex(seekPointIndex))
+	{
+		State = SeekPoints[seekPointIndex].Value;
+		HasPending = false;
+	}
+	else
+	{
+		Rewind();
+	}
+
+	int64 nextTicks;
+	while (PeekNextTicks(nextTicks) && nextTicks < Ticks)
+	{
+		HasPending = false;
+	}
+}
@@ -4,6 +4,8 @@
 
 #include "DeadReckoning_BPFL.h"
 #include "DISGameManager.h"
+#include "DISTerrainElevationGrid.h"
+#include "DISGeoTransformCache.h"
 #include "CollisionQueryParams.h"
 #include "Camera/PlayerCameraManager.h"
 #include "Engine/World.h"
@@ -12,6 +14,9 @@
 
 DEFINE_LOG_CATEGORY(LogDISReceiveComponent);
 
+//Frames to wait on an async ground clamp trace before issuing another one
+static constexpr uint64 GroundClampTraceTimeoutFrames = 10;
+
 // Sets default values for this component's properties
 UDISReceiveComponent::UDISReceiveComponent()
 {
@@ -221,63 +226,163 @@ bool UDISReceiveComponent::GroundClamping_Implementation()
 	{
 		SCOPE_CYCLE_COUNTER(STAT_GroundClamping);
 
-		//Set clamp direction using the North East Down down vector
-		FVector clampDirection = FVector::DownVector;
+		//Get the location the object is supposed to be at according to the most recent dead reckoning update.
+		FVector actorLocation;
+		UDIS_BPFL::GetUnrealLocationFromEntityStatePdu(MostRecentDeadReckonedEntityStatePDU, GeoReferencingSystem, actorLocation);
+
+		//Prefer the baked elevation grid when the entity is over a static tile of it
+		float gridHeight;
+		FVector gridNormal;
+		if (IsValid(GroundClampingElevationGrid) && GroundClampingElevationGrid->SampleElevation(actorLocation, gridHeight, gridNormal))
+		{
+			INC_DWORD_STAT(STAT_GroundClampGridLookups);
+
+			HasGroundClampHit = true;
+			GroundClampUpDirection = FVector::UpVector;
+			GroundClampTraceOrigin = actorLocation;
+			GroundClampHitLocation = FVector(actorLocation.X, actorLocation.Y, gridHeight);
+			GroundClampHitNormal = gridNormal;
+			ApplyGroundClamp(actorLocation);
 
-		FVector eastVector = FVector::RightVector;
-		FVector northVector = FVector::ForwardVector;
-		FCartesianCoordinates ecefCartCoords = FCartesianCoordinates(MostRecentDeadReckonedEntityStatePDU.EntityLocationDouble[0],
-			MostRecentDeadReckonedEntityStatePDU.EntityLocationDouble[1], MostRecentDeadReckonedEntityStatePDU.EntityLocationDouble[2]);
+			return true;
+		}
 
-		if (IsValid(GeoReferencingSystem))
+		//Async results are handed back on the next frame, so give up on one that has taken much longer in case it was dropped
+		if (GroundClampTracePending && GFrameCounter - PendingGroundClampTraceFrame > GroundClampTraceTimeoutFrames)
 		{
-			GeoReferencingSystem->GetENUVectorsAtECEFLocation(ecefCartCoords, eastVector, northVector, clampDirection);
+			GroundClampTracePending = false;
 		}
-		else
+
+		//Only trace again if the entity has moved far enough along the ground since the last trace
+		bool reuseCachedHit = false;
+		if (HasGroundClampHit)
 		{
-			UE_LOG(LogDISReceiveComponent, Warning, TEXT("Invalid GeoReferencing variable in DISComponent. Error in calculating East, North, Down vectors for Ground Clamp location. Utilizing default East, North, Down vectors for calculation."));
+			FVector traceOffset = actorLocation - GroundClampTraceOrigin;
+			traceOffset -= GroundClampUpDirection * FVector::DotProduct(traceOffset, GroundClampUpDirection);
+			reuseCachedHit = traceOffset.SizeSquared() <= FMath::Square(GroundClampingRetraceDistance);
 		}
 
-		clampDirection *= -1;
+		if (reuseCachedHit)
+		{
+			INC_DWORD_STAT(STAT_GroundClampTracesReused);
+		}
+		else if (!GroundClampTracePending)
+		{
+			IssueGroundClampTrace(actorLocation);
+		}
 
-		//Get the location the object is supposed to be at according to the most recent dead reckoning update.
-		FVector actorLocation;
-		UDIS_BPFL::GetUnrealLocationFromEntityStatePdu(MostRecentDeadReckonedEntityStatePDU, GeoReferencingSystem, actorLocation);
+		if (HasGroundClampHit)
+		{
+			ApplyGroundClamp(actorLocation);
+		}
 
-		FHitResult lineTraceHitResult;
-		FVector endLocation = (clampDirection * 100000) + actorLocation;
-		FVector aboveActorStartLocation = (clampDirection * -100000) + actorLocation;
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
 
-		FCollisionQueryParams queryParams = FCollisionQueryParams(FName("Ground Clamping"), false, GetOwner());
-		//Find colliding point above/below the actor
-		if (GetWorld()->LineTraceSingleByChannel(lineTraceHitResult, aboveActorStartLocation, endLocation, UEngineTypes::ConvertToCollisionChannel(GoundClampingCollisionChannel), queryParams))
-		{
-			FVector clampLocation = lineTraceHitResult.Location;
-			//Calculate what the new forward and right vectors should be based on the impact normal
-			FVector newForward = FVector::CrossProduct(GetOwner()->GetActorRightVector(), lineTraceHitResult.ImpactNormal);
-			FVector newRight = FVector::CrossProduct(lineTraceHitResult.ImpactNormal, newForward);
+void UDISReceiveComponent::IssueGroundClampTrace(FVector const& ActorLocation)
+{
+	INC_DWORD_STAT(STAT_GroundClampTracesIssued);
 
-			FRotator clampRotation = UKismetMathLibrary::MakeRotationFromAxes(newForward, newRight, lineTraceHitResult.ImpactNormal);
+	//Set clamp direction using the East North Up up vector
+	FVector upVector = FVector::UpVector;
+	const FEarthCenteredEarthFixedDouble ecef(MostRecentDeadReckonedEntityStatePDU.EntityLocationDouble[0],
+		MostRecentDeadReckonedEntityStatePDU.EntityLocationDouble[1], MostRecentDeadReckonedEntityStatePDU.EntityLocationDouble[2]);
 
-			//Create clamp transform and broadcast
-			FTransform clampTransform = FTransform(clampRotation, clampLocation);
-			TArray<FTransform> allClampTransforms;
-			allClampTransforms.Add(clampTransform);
+	if (IsValid(GeoReferencingSystem))
+	{
+		FNorthEastDown northEastDown;
+		FDISGeoTransformCache::GetNorthEastDownAtEcefLocation(GeoReferencingSystem, ecef, northEastDown);
+		upVector = -northEastDown.DownVector;
+	}
+	else
+	{
+		UE_LOG(LogDISReceiveComponent, Warning, TEXT("Invalid GeoReferencing variable in DISComponent. Error in calculating the up vector for Ground Clamp location. Utilizing the world up vector for calculation."));
+	}
 
-			if (ApplyToOwner)
-			{
-				GetOwner()->SetActorLocationAndRotation(clampLocation, clampRotation);
-			}
+	FVector endLocation = (upVector * -100000) + ActorLocation;
+	FVector aboveActorStartLocation = (upVector * 100000) + ActorLocation;
 
-			OnGroundClampingUpdate.Broadcast(allClampTransforms);
+	FCollisionQueryParams queryParams = FCollisionQueryParams(FName("Ground Clamping"), false, GetOwner());
+	ECollisionChannel collisionChannel = UEngineTypes::ConvertToCollisionChannel(GoundClampingCollisionChannel);
+
+	if (UseAsyncGroundClampingTraces)
+	{
+		if (!GroundClampTraceDelegate.IsBound())
+		{
+			GroundClampTraceDelegate.BindUObject(this, &UDISReceiveComponent::OnGroundClampTraceCompleted);
 		}
 
-		return true;
+		//Results get handed back on the next frame, keep using the previous clamp result and its up direction until then
+		PendingGroundClampTraceOrigin = ActorLocation;
+		PendingGroundClampUpDirection = upVector;
+		PendingGroundClampTraceFrame = GFrameCounter;
+		GroundClampTracePending = true;
+		PendingGroundClampTraceHandle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, aboveActorStartLocation, endLocation, collisionChannel, queryParams, FCollisionResponseParams::DefaultResponseParam, &GroundClampTraceDelegate);
+		return;
 	}
-	else
+
+	//Find colliding point above/below the actor
+	FHitResult lineTraceHitResult;
+	HasGroundClampHit = GetWorld()->LineTraceSingleByChannel(lineTraceHitResult, aboveActorStartLocation, endLocation, collisionChannel, queryParams);
+	GroundClampUpDirection = upVector;
+	GroundClampTraceOrigin = ActorLocation;
+	GroundClampHitLocation = lineTraceHitResult.Location;
+	GroundClampHitNormal = lineTraceHitResult.ImpactNormal;
+}
+
+void UDISReceiveComponent::OnGroundClampTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	//Ignore results of traces that timed out and were replaced by a newer one
+	if (!GroundClampTracePending || TraceHandle != PendingGroundClampTraceHandle)
 	{
-		return false;
+		return;
 	}
+
+	GroundClampTracePending = false;
+
+	const FHitResult* blockingHit = TraceDatum.OutHits.FindByPredicate([](const FHitResult& Hit) { return Hit.bBlockingHit; });
+	HasGroundClampHit = blockingHit != nullptr;
+	GroundClampTraceOrigin = PendingGroundClampTraceOrigin;
+	GroundClampUpDirection = PendingGroundClampUpDirection;
+
+	if (HasGroundClampHit)
+	{
+		GroundClampHitLocation = blockingHit->Location;
+		GroundClampHitNormal = blockingHit->ImpactNormal;
+	}
+}
+
+void UDISReceiveComponent::ApplyGroundClamp(FVector const& ActorLocation)
+{
+	//Slide the actor along the up vector onto the plane of the cached hit so small movements stay on the ground without a new trace
+	FVector clampLocation = GroundClampHitLocation;
+	const float upDotNormal = FVector::DotProduct(GroundClampUpDirection, GroundClampHitNormal);
+	if (!FMath::IsNearlyZero(upDotNormal))
+	{
+		clampLocation = ActorLocation - GroundClampUpDirection * (FVector::DotProduct(ActorLocation - GroundClampHitLocation, GroundClampHitNormal) / upDotNormal);
+	}
+
+	//Calculate what the new forward and right vectors should be based on the impact normal
+	FVector newForward = FVector::CrossProduct(GetOwner()->GetActorRightVector(), GroundClampHitNormal);
+	FVector newRight = FVector::CrossProduct(GroundClampHitNormal, newForward);
+
+	FRotator clampRotation = UKismetMathLibrary::MakeRotationFromAxes(newForward, newRight, GroundClampHitNormal);
+
+	//Create clamp transform and broadcast
+	GroundClampTransforms.Reset();
+	GroundClampTransforms.Emplace(clampRotation, clampLocation);
+
+	if (ApplyToOwner)
+	{
+		GetOwner()->SetActorLocationAndRotation(clampLocation, clampRotation);
+	}
+
+	OnGroundClampingUpdate.Broadcast(GroundClampTransforms);
 }
 
 FEntityStatePDU UDISReceiveComponent::SmoothDeadReckoning(FEntityStatePDU DeadReckonPDUToSmooth)
@@ -0,0 +1,553 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISReplaySubsystem.h"
+#include "DISCaptureReader.h"
+#include "PDUProcessor.h"
+#include "UDPSubsystem.h"
+#include "Interfaces/IPv4/IPv4Address.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+#include "Engine/GameInstance.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY(LogDISReplay);
+
+void UDISReplaySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Collection.InitializeDependency(UPDUProcessor::StaticClass());
+	Collection.InitializeDependency(UUDPSubsystem::StaticClass());
+	Super::Initialize(Collection);
+
+	PDUProcessor = GetGameInstance()->GetSubsystem<UPDUProcessor>();
+	UDPSubsystem = GetGameInstance()->GetSubsystem<UUDPSubsystem>();
+}
+
+void UDISReplaySubsystem::Deinitialize()
+{
+	StopReplay();
+
+	Super::Deinitialize();
+}
+
+ETickableTickType UDISReplaySubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+FString UDISReplaySubsystem::GetCaptureDirectory(const FString& Directory)
+{
+	return Directory.IsEmpty() ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("DISCaptures")) : Directory;
+}
+
+bool UDISReplaySubsystem::StartReplay(const FString& CaptureName, FDISReplaySettings Settings)
+{
+	StopReplay();
+
+	const FString directory = GetCaptureDirectory(Settings.Directory);
+	TUniquePtr<FDISCaptureReader> captureReader = MakeUnique<FDISCaptureReader>();
+	if (!captureReader->Open(directory, CaptureName))
+	{
+		return false;
+	}
+
+	CaptureReader = captureReader.Get();
+	if (!Keyframes.Open(directory, CaptureName))
+	{
+		UE_LOG(LogDISReplay, Log, TEXT("Capture %s has no keyframes, seeking will not rebuild the exercise state."), *CaptureName);
+	}
+
+	BeginReplay(MoveTemp(captureReader), Settings, CaptureName);
+	return true;
+}
+
+bool UDISReplaySubsystem::StartPcapReplay(const FString& FilePath, FDISPcapFilter Filter, FDISReplaySettings Settings)
+{
+	StopReplay();
+
+	TUniquePtr<FDISPcapReader> pcapReader = MakeUnique<FDISPcapReader>();
+	if (!pcapReader->Open(FilePath, Filter))
+	{
+		return false;
+	}
+
+	BeginReplay(MoveTemp(pcapReader), Settings, FilePath);
+	return true;
+}
+
+bool UDISReplaySubsystem::StartArchiveReplay(const FString& FilePath, FDISReplaySettings Settings)
+{
+	StopReplay();
+
+	TUniquePtr<FDISColumnarArchiveReader> archiveReader = MakeUnique<FDISColumnarArchiveReader>();
+	if (!archiveReader->Open(FilePath))
+	{
+		return false;
+	}
+
+	BeginReplay(MoveTemp(archiveReader), Settings, FilePath);
+	return true;
+}
+
+void UDISReplaySubsystem::BeginReplay(TUniquePtr<IDISReplaySource> InSource, const FDISReplaySettings& Settings, const FString& SourceName)
+{
+	Source = MoveTemp(InSource);
+
+	ReplaySettings = Settings;
+	ReplaySettings.PlaybackRate = FMath::Max(ReplaySettings.PlaybackRate, 0.01f);
+	ReplaySettings.FrameBudgetMilliseconds = FMath::Max(ReplaySettings.FrameBudgetMilliseconds, 0.1f);
+
+	Paused = Settings.StartPaused;
+	Finished = false;
+	CurrentTicks = Source->GetStartTicks();
+	PacketsReplayed = 0;
+	BytesReplayed = 0;
+	PlayingWallSeconds = 0;
+	ReplayedCaptureSeconds = 0;
+	InjectSeconds = 0;
+	LastSeekMilliseconds = 0;
+	ReplayedState.Reset();
+	AnchorClock();
+
+	UE_LOG(LogDISReplay, Log, TEXT("Replaying %s, %.1f seconds."), *SourceName, static_cast<double>(Source->GetEndTicks() - Source->GetStartTicks()) / ETimespan::TicksPerSecond);
+}
+
+void UDISReplaySubsystem::StopReplay()
+{
+	if (!Source.IsValid())
+	{
+		return;
+	}
+
+	const FDISReplayStats stats = GetReplayStats();
+	UE_LOG(LogDISReplay, Log, TEXT("Stopped replay at %.1f of %.1f seconds. %lld packets replayed at %.2fx, %.0f packets/s decoded."),
+		stats.CurrentSeconds, stats.DurationSeconds, stats.PacketsReplayed, stats.AchievedRate, stats.DecodePacketsPerSecond);
+
+	Source.Reset();
+	CaptureReader = nullptr;
+	Keyframes.Close();
+	ReplayedState.Reset();
+	Paused = false;
+	Finished = false;
+}
+
+void UDISReplaySubsystem::PauseReplay()
+{
+	Paused = true;
+}
+
+void UDISReplaySubsystem::ResumeReplay()
+{
+	if (!Source.IsValid() || Finished)
+	{
+		return;
+	}
+
+	Paused = false;
+	AnchorClock();
+}
+
+int32 UDISReplaySubsystem::StepReplay(int32 NumPackets)
+{
+	if (!Source.IsValid() || Finished)
+	{
+		return 0;
+	}
+
+	Paused = true;
+
+	const double injectStartSeconds = FPlatformTime::Seconds();
+	int32 numStepped = 0;
+	FDISCaptureRecordHeader record;
+	while (numStepped < NumPackets && ReplayNextPacket(record))
+	{
+		CurrentTicks = record.TimestampTicks;
+		PacketsReplayed++;
+		BytesReplayed += record.PayloadBytes;
+		numStepped++;
+	}
+	InjectSeconds += FPlatformTime::Seconds() - injectStartSeconds;
+	INC_DWORD_STAT_BY(STAT_ReplayedPackets, numStepped);
+
+	int64 nextTicks;
+	if (!Source->PeekNextTicks(nextTicks))
+	{
+		FinishReplay();
+	}
+
+	return numStepped;
+}
+
+void UDISReplaySubsystem::SeekReplay(float SecondsFromStart)
+{
+	if (!Source.IsValid())
+	{
+		return;
+	}
+
+	const double seekStartSeconds = FPlatformTime::Seconds();
+	const int64 seekTicks = Source->GetStartTicks() + static_cast<int64>(FMath::Max(SecondsFromStart, 0.f) * ETimespan::TicksPerSecond);
+	if (CaptureReader != nullptr && Keyframes.IsOpen())
+	{
+		SeekWithKeyframes(seekTicks);
+	}
+	else
+	{
+		Source->SeekToTicks(seekTicks);
+	}
+	CurrentTicks = FMath::Clamp(seekTicks, Source->GetStartTicks(), Source->GetEndTicks());
+	Finished = false;
+	AnchorClock();
+
+	LastSeekMilliseconds = (FPlatformTime::Seconds() - seekStartSeconds) * 1000.;
+	UE_LOG(LogDISReplay, Log, TEXT("Sought to %.1f s in %.2f ms."), static_cast<double>(CurrentTicks - Source->GetStartTicks()) / ETimespan::TicksPerSecond, LastSeekMilliseconds);
+}
+
+void UDISReplaySubsystem::SeekWithKeyframes(int64 SeekTicks)
+{
+	FDISExerciseStateTracker keyframeState;
+	FDISCaptureReader::FPosition keyframePosition;
+	int64 keyframeTicks;
+	if (!Keyframes.LoadKeyframe(SeekTicks, keyframeState, keyframePosition, keyframeTicks))
+	{
+		//Before the first keyframe the exercise starts out empty
+		keyframeTicks = Source->GetStartTicks();
+		keyframePosition = FDISCaptureReader::FPosition();
+	}
+
+	//Seeking forward short of the next keyframe just carries on from the current position
+	if (SeekTicks < CurrentTicks || keyframeTicks > CurrentTicks)
+	{
+		auto injectDatagram = [this](const FDISCaptureRecordHeader& Record, TArrayView<const uint8> Payload)
+		{
+			InjectDatagram(Record, Payload, ReplaySettings.Target);
+		};
+		ReplayedState.ForEachDeactivatedDatagram(keyframeState, injectDatagram);
+		keyframeState.ForEachDatagram(injectDatagram);
+
+		ReplayedState = MoveTemp(keyframeState);
+		CaptureReader->SetPosition(keyframePosition);
+	}
+
+	FDISCaptureRecordHeader record;
+	int64 nextTicks;
+	while (Source->PeekNextTicks(nextTicks) && nextTicks < SeekTicks)
+	{
+		ReplayNextPacket(record);
+	}
+}
+
+void UDISReplaySubsystem::SetPlaybackRate(float PlaybackRate, bool AsFastAsPossible)
+{
+	ReplaySettings.PlaybackRate = FMath::Max(PlaybackRate, 0.01f);
+	ReplaySettings.AsFastAsPossible = AsFastAsPossible;
+	AnchorClock();
+}
+
+void UDISReplaySubsystem::AnchorClock()
+{
+	AnchorTicks = CurrentTicks;
+	AnchorWallSeconds = FPlatformTime::Seconds();
+	LastTickWallSeconds = AnchorWallSeconds;
+}
+
+void UDISReplaySubsystem::FinishReplay()
+{
+	//Kept open so the replay can be sought back into
+	Finished = true;
+	Paused = true;
+	CurrentTicks = Source->GetEndTicks();
+
+	const FDISReplayStats stats = GetReplayStats();
+	UE_LOG(LogDISReplay, Log, TEXT("Finished replay. %lld packets replayed at %.2fx, %.0f packets/s and %.1f MB/s decoded."),
+		stats.PacketsReplayed, stats.AchievedRate, stats.DecodePacketsPerSecond, stats.DecodeMegabytesPerSecond);
+
+	OnReplayFinished.Broadcast();
+}
+
+bool UDISReplaySubsystem::InjectNextPacket(IDISReplaySource& InSource, EDISReplayTarget Target, FDISCaptureRecordHeader& OutRecord)
+{
+	TArrayView<const uint8> payload;
+	if (!InSource.ReadNext(OutRecord, payload))
+	{
+		return false;
+	}
+
+	InjectDatagram(OutRecord, payload, Target);
+	return true;
+}
+
+bool UDISReplaySubsystem::ReplayNextPacket(FDISCaptureRecordHeader& OutRecord)
+{
+	TArrayView<const uint8> payload;
+	if (!Source->ReadNext(OutRecord, payload))
+	{
+		return false;
+	}
+
+	if (Keyframes.IsOpen())
+	{
+		ReplayedState.AddDatagram(OutRecord, payload);
+	}
+	InjectDatagram(OutRecord, payload, ReplaySettings.Target);
+	return true;
+}
+
+void UDISReplaySubsystem::InjectDatagram(const FDISCaptureRecordHeader& Record, TArrayView<const uint8> Payload, EDISReplayTarget Target)
+{
+	PacketBytes.SetNumUninitialized(Payload.Num(), false);
+	FMemory::Memcpy(PacketBytes.GetData(), Payload.GetData(), Payload.Num());
+
+	if (Target == EDISReplayTarget::ReceivedBytes)
+	{
+		if (IsValid(UDPSubsystem))
+		{
+			UDPSubsystem->OnReceivedBytes.Broadcast(PacketBytes, FIPv4Address(Record.SourceAddress).ToString());
+		}
+	}
+	else if (IsValid(PDUProcessor))
+	{
+		PDUProcessor->ProcessDISPacket(PacketBytes);
+	}
+}
+
+void UDISReplaySubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ReplayTick);
+
+	const double nowSeconds = FPlatformTime::Seconds();
+	const double budgetEndSeconds = nowSeconds + ReplaySettings.FrameBudgetMilliseconds / 1000.;
+	PlayingWallSeconds += nowSeconds - LastTickWallSeconds;
+	LastTickWallSeconds = nowSeconds;
+
+	const int64 startTicks = CurrentTicks;
+	const int64 targetTicks = ReplaySettings.AsFastAsPossible ? MAX_int64
+		: AnchorTicks + static_cast<int64>((nowSeconds - AnchorWallSeconds) * ReplaySettings.PlaybackRate * ETimespan::TicksPerSecond);
+
+	int32 numInjected = 0;
+	bool reachedTarget = false;
+	bool reachedEnd = false;
+	FDISCaptureRecordHeader record;
+	int64 nextTicks;
+	for (;;)
+	{
+		if (!Source->PeekNextTicks(nextTicks))
+		{
+			reachedEnd = true;
+			break;
+		}
+		if (nextTicks > targetTicks)
+		{
+			reachedTarget = true;
+			break;
+		}
+		//Checking the clock every datagram would cost more than decoding small ones
+		if ((numInjected & 63) == 63 && FPlatformTime::Seconds() >= budgetEndSeconds)
+		{
+			break;
+		}
+
+		ReplayNextPacket(record);
+		CurrentTicks = record.TimestampTicks;
+		PacketsReplayed++;
+		BytesReplayed += record.PayloadBytes;
+		numInjected++;
+	}
+
+	InjectSeconds += FPlatformTime::Seconds() - nowSeconds;
+	INC_DWORD_STAT_BY(STAT_ReplayedPackets, numInjected);
+
+	//Quiet stretches of the capture still count as replayed once the clock has passed them
+	if (reachedTarget)
+	{
+		CurrentTicks = FMath::Max(CurrentTicks, FMath::Min(targetTicks, Source->GetEndTicks()));
+	}
+	ReplayedCaptureSeconds += static_cast<double>(CurrentTicks - startTicks) / ETimespan::TicksPerSecond;
+
+	if (reachedEnd)
+	{
+		FinishReplay();
+	}
+}
+
+FDISReplayStats UDISReplaySubsystem::GetReplayStats() const
+{
+	FDISReplayStats stats;
+	if (!Source.IsValid())
+	{
+		return stats;
+	}
+
+	stats.CurrentSeconds = static_cast<double>(CurrentTicks - Source->GetStartTicks()) / ETimespan::TicksPerSecond;
+	stats.DurationSeconds = static_cast<double>(Source->GetEndTicks() - Source->GetStartTicks()) / ETimespan::TicksPerSecond;
+	stats.PacketsReplayed = PacketsReplayed;
+	stats.BytesReplayed = BytesReplayed;
+	stats.AchievedRate = PlayingWallSeconds > 0 ? ReplayedCaptureSeconds / PlayingWallSeconds : 0;
+	stats.PacketsPerSecond = PlayingWallSeconds > 0 ? PacketsReplayed / PlayingWallSeconds : 0;
+	stats.DecodePacketsPerSecond = InjectSeconds > 0 ? PacketsReplayed / InjectSeconds : 0;
+	stats.DecodeMegabytesPerSecond = InjectSeconds > 0 ? BytesReplayed / InjectSeconds / (1024. * 1024.) : 0;
+	stats.LastSeekMilliseconds = LastSeekMilliseconds;
+	stats.Finished = Finished;
+
+	return stats;
+}
+
+FDISReplayStats UDISReplaySubsystem::RunDecodeBenchmark(const FString& CaptureName, const FString& Directory, int32 Passes)
+{
+	FDISReplayStats stats;
+
+	FDISCaptureReader benchmarkReader;
+	if (!benchmarkReader.Open(GetCaptureDirectory(Directory), CaptureName))
+	{
+		return stats;
+	}
+
+	const double startSeconds = FPlatformTime::Seconds();
+	FDISCaptureRecordHeader record;
+	for (int32 pass = 0; pass < FMath::Max(Passes, 1); pass++)
+	{
+		benchmarkReader.Rewind();
+		while (InjectNextPacket(benchmarkReader, EDISReplayTarget::PDUProcessor, record))
+		{
+			stats.PacketsReplayed++;
+			stats.BytesReplayed += record.PayloadBytes;
+		}
+	}
+	const double elapsedSeconds = FPlatformTime::Seconds() - startSeconds;
+
+	stats.DurationSeconds = static_cast<double>(benchmarkReader.GetEndTicks() - benchmarkReader.GetStartTicks()) / ETimespan::TicksPerSecond;
+	stats.CurrentSeconds = stats.DurationSeconds;
+	stats.AchievedRate = elapsedSeconds > 0 ? stats.DurationSeconds * FMath::Max(Passes, 1) / elapsedSeconds : 0;
+	stats.PacketsPerSecond = elapsedSeconds > 0 ? stats.PacketsReplayed / elapsedSeconds : 0;
+	stats.DecodePacketsPerSecond = stats.PacketsPerSecond;
+	stats.DecodeMegabytesPerSecond = elapsedSeconds > 0 ? stats.BytesReplayed / elapsedSeconds / (1024. * 1024.) : 0;
+	stats.Finished = true;
+
+	UE_LOG(LogDISReplay, Display, TEXT("Decode benchmark of %s: %lld packets, %lld bytes in %.3f s. %.0f packets/s, %.1f MB/s, %.1fx real time."),
+		*CaptureName, stats.PacketsReplayed, stats.BytesReplayed, elapsedSeconds, stats.DecodePacketsPerSecond, stats.DecodeMegabytesPerSecond, stats.AchievedRate);
+
+	return stats;
+}
+
+bool UDISReplaySubsystem::BuildKeyframes(const FString& CaptureName, const FString& Directory, float IntervalSeconds)
+{
+	return FDISKeyframeArchive::BuildFromCapture(GetCaptureDirectory(Directory), CaptureName, IntervalSeconds);
+}
+
+FDISArchiveStats UDISReplaySubsystem::ArchiveCapture(const FString& CaptureName, const FString& Directory, EDISArchiveCodec Codec)
+{
+	const FString directory = GetCaptureDirectory(Directory);
+	FDISArchiveStats stats;
+	FDISColumnarArchiveWriter::ArchiveCapture(directory, CaptureName, FPaths::Combine(directory, CaptureName + DISCaptureLog::ArchiveExtension), Codec, stats);
+	return stats;
+}
+
+static void RunReplayCommandFromConsole(const TArray<FString>& Args, UWorld* World)
+{
+	UGameInstance* gameInstance = World ? World->GetGameInstance() : nullptr;
+	UDISReplaySubsystem* replaySubsystem = gameInstance ? gameInstance->GetSubsystem<UDISReplaySubsystem>() : nullptr;
+	if (replaySubsystem == nullptr || Args.Num() == 0)
+	{
+		UE_LOG(LogDISReplay, Warning, TEXT("Usage: DIS.Replay Start <CaptureName> [Rate=1.0|Rate=Max] [Dir=...] | Pcap <FilePath> [Rate=1.0|Rate=Max] [Ports=3000,...] [Groups=239.1.2.3,...] | Stop | Pause | Resume | Step [N] | Seek <Seconds> | Rate <N|Max> | Stats | Benchmark <CaptureName> [Passes=1] [Dir=...] | BuildKeyframes <CaptureName> [Interval=10] [Dir=...] | Archive <CaptureName> [Codec=LZ4|Zlib|None] [Dir=...] | PlayArchive <FilePath> [Rate=1.0|Rate=Max]"));
+		return;
+	}
+
+	const FString& command = Args[0];
+	const FString argument = Args.Num() > 1 ? Args[1] : FString();
+
+	FDISReplaySettings settings;
+	FString rateString;
+	int32 passes = 1;
+	float keyframeInterval = 10.0f;
+	FString codecString;
+	FDISPcapFilter pcapFilter;
+	for (int32 i = 2; i < Args.Num(); i++)
+	{
+		FParse::Value(*Args[i], TEXT("Dir="), settings.Directory);
+		FParse::Value(*Args[i], TEXT("Rate="), rateString);
+		FParse::Value(*Args[i], TEXT("Passes="), passes);
+		FParse::Value(*Args[i], TEXT("Interval="), keyframeInterval);
+		FParse::Value(*Args[i], TEXT("Codec="), codecString);
+
+		FString listString;
+		if (FParse::Value(*Args[i], TEXT("Ports="), listString, false))
+		{
+			TArray<FString> portStrings;
+			listString.ParseIntoArray(portStrings, TEXT(","));
+			for (const FString& portString : portStrings)
+			{
+				pcapFilter.Ports.Add(FCString::Atoi(*portString));
+			}
+		}
+		if (FParse::Value(*Args[i], TEXT("Groups="), listString, false))
+		{
+			listString.ParseIntoArray(pcapFilter.Addresses, TEXT(","));
+		}
+	}
+	if (command.Equals(TEXT("Rate"), ESearchCase::IgnoreCase))
+	{
+		rateString = argument;
+	}
+	settings.AsFastAsPossible = rateString.Equals(TEXT("Max"), ESearchCase::IgnoreCase);
+	settings.PlaybackRate = rateString.IsEmpty() || settings.AsFastAsPossible ? 1.0f : FCString::Atof(*rateString);
+
+	if (command.Equals(TEXT("Start"), ESearchCase::IgnoreCase))
+	{
+		replaySubsystem->StartReplay(argument, settings);
+	}
+	else if (command.Equals(TEXT("Pcap"), ESearchCase::IgnoreCase))
+	{
+		replaySubsystem->StartPcapReplay(argument, pcapFilter, settings);
+	}
+	else if (command.Equals(TEXT("Stop"), ESearchCase::IgnoreCase))
+	{
+		replaySubsystem->StopReplay();
+	}
+	else if (command.Equals(TEXT("Pause"), ESearchCase::IgnoreCase))
+	{
+		replaySubsystem->PauseReplay();
+	}
+	else if (command.Equals(TEXT("Resume"), ESearchCase::IgnoreCase))
+	{
+		replaySubsystem->ResumeReplay();
+	}
+	else if (command.Equals(TEXT("Step"), ESearchCase::IgnoreCase))
+	{
+		replaySubsystem->StepReplay(argument.IsEmpty() ? 1 : FCString::Atoi(*argument));
+	}
+	else if (command.Equals(TEXT("Seek"), ESearchCase::IgnoreCase))
+	{
+		replaySubsystem->SeekReplay(FCString::Atof(*argument));
+	}
+	else if (command.Equals(TEXT("Rate"), ESearchCase::IgnoreCase))
+	{
+		replaySubsystem->SetPlaybackRate(settings.PlaybackRate, settings.AsFastAsPossible);
+	}
+	else if (command.Equals(TEXT("Benchmark"), ESearchCase::IgnoreCase))
+	{
+		replaySubsystem->RunDecodeBenchmark(argument, settings.Directory, passes);
+	}
+	else if (command.Equals(TEXT("BuildKeyframes"), ESearchCase::IgnoreCase))
+	{
+		replaySubsystem->BuildKeyframes(argument, settings.Directory, keyframeInterval);
+	}
+	else if (command.Equals(TEXT("Archive"), ESearchCase::IgnoreCase))
+	{
+		const EDISArchiveCodec codec = codecString.Equals(TEXT("Zlib"), ESearchCase::IgnoreCase) ? EDISArchiveCodec::Zlib
+			: codecString.Equals(TEXT("None"), ESearchCase::IgnoreCase) ? EDISArchiveCodec::None : EDISArchiveCodec::LZ4;
+		replaySubsystem->ArchiveCapture(argument, settings.Directory, codec);
+	}
+	else if (command.Equals(TEXT("PlayArchive"), ESearchCase::IgnoreCase))
+	{
+		replaySubsystem->StartArchiveReplay(argument, settings);
+	}
+
+	const FDISReplayStats stats = replaySubsystem->GetReplayStats();
+	UE_LOG(LogDISReplay, Display, TEXT("Replay at %.1f of %.1f s%s. %lld packets, %.2fx achieved, %.0f packets/s, %.0f packets/s and %.1f MB/s decoded."),
+		stats.CurrentSeconds, stats.DurationSeconds, replaySubsystem->IsReplayPaused() ? TEXT(" (paused)") : TEXT(""), stats.PacketsReplayed,
+		stats.AchievedRate, stats.PacketsPerSecond, stats.DecodePacketsPerSecond, stats.DecodeMegabytesPerSecond);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs DISReplayCommand(
+	TEXT("DIS.Replay"),
+	TEXT("Controls replay of DIS capture logs. Usage: DIS.Replay Start <CaptureName> [Rate=1.0|Rate=Max] [Dir=...] | Pcap <FilePath> [Rate=1.0|Rate=Max] [Ports=3000,...] [Groups=239.1.2.3,...] | Stop | Pause | Resume | Step [N] | Seek <Seconds> | Rate <N|Max> | Stats | Benchmark <CaptureName> [Passes=1] [Dir=...] | BuildKeyframes <CaptureName> [Interval=10] [Dir=...] | Archive <CaptureName> [Codec=LZ4|Zlib|None] [Dir=...] | PlayArchive <FilePath> [Rate=1.0|Rate=Max]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunReplayCommandFromConsole));
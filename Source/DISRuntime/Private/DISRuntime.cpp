@@ -2,6 +2,7 @@
 
 #include "DISRuntime.h"
 #include "Interfaces/IPluginManager.h"
+#include "DISLoadGenerator.h"
 
 #define LOCTEXT_NAMESPACE "FDISRuntime"
 
@@ -24,6 +25,11 @@ void FDISRuntimeModule::ShutdownModule()
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
 
+#if !UE_BUILD_SHIPPING
+	//Stop sending before the socket subsystem goes away
+	FDISLoadGenerator::StopConsoleGenerator();
+#endif
+
 	//Free the loaded OpenDIS6 DLL
 	FPlatformProcess::FreeDllHandle(DLLHandle);
 }
@@ -4,19 +4,57 @@
 #include "DISSendComponent.h"
 
 #include "DISGameManager.h"
+#include "DISSendManager.h"
+#include "DISGeoTransformCache.h"
 #include "DeadReckoning_BPFL.h"
 #include "PDUConversions_BPFL.h"
 #include "Kismet/GameplayStatics.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "Engine/World.h"
+#include "CoreGlobals.h"
 
 DEFINE_LOG_CATEGORY(LogDISSendComponent);
 
+namespace DISSendComponentScheduling
+{
+	//Fraction of the predicted time to wait before checking, leaves headroom for the acceleration bounds being exceeded
+	constexpr double SafetyFactor = 0.8;
+	//Half-life of the observed peak accelerations
+	constexpr double PeakDecayHalfLifeSeconds = 2.;
+
+	/**
+	 * Earliest time an error growing no faster than Error + Rate * t + 0.5 * Acceleration * t^2 can reach Threshold.
+	 */
+	double TimeToThreshold(const double Error, const double Rate, const double Acceleration, const double Threshold)
+	{
+		const double remaining = Threshold - Error;
+		if (remaining <= 0)
+		{
+			return 0;
+		}
+		if (Acceleration > 0)
+		{
+			return (FMath::Sqrt(Rate * Rate + 2 * Acceleration * remaining) - Rate) / Acceleration;
+		}
+		if (Rate > 0)
+		{
+			return remaining / Rate;
+		}
+		return BIG_NUMBER;
+	}
+}
+
 // Sets default values for this component's properties
 UDISSendComponent::UDISSendComponent()
 {
 	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
 	// off to improve performance if you don't need them.
 	PrimaryComponentTick.bCanEverTick = true;
+
+	//Full accuracy near remote observers, ten times the thresholds and heartbeat once every observer is 50 km away
+	FRichCurve* observerScaleCurve = ObserverDistanceThresholdScale.GetRichCurve();
+	observerScaleCurve->AddKey(1000.f, 1.f);
+	observerScaleCurve->AddKey(50000.f, 10.f);
 }
 
 void UDISSendComponent::BeginPlay()
@@ -33,6 +71,8 @@ void UDISSendComponent::BeginPlay()
 	LastCalculatedUnrealLocation = GetOwner()->GetActorLocation();
 	LastCalculatedUnrealRotation = GetOwner()->GetActorRotation();
 
+	UpdateObserverThresholdScale();
+
 	TimeOfLastParametersCalculation = GetOwner()->GetGameTimeSinceCreation();
 
 	//Form Entity State PDU packets
@@ -45,7 +85,28 @@ void UDISSendComponent::BeginPlay()
 		UDPSubsystem->EmitBytes(UPDUConversions_BPFL::ConvertEntityStatePDUToBytes(MostRecentEntityStatePDU));
 	}
 
-	GetWorld()->GetTimerManager().SetTimer(UpdateEntityStateCalculationsHandle, this, &UDISSendComponent::UpdateEntityStateCalculations, EntityStateCalculationRate, true);
+	//Spread the heartbeats and calculations of entities spawned together over their periods so they do not go out in bursts
+	float phaseFraction = 0;
+	if (IsValid(DISGameManager) && IsValid(DISGameManager->SendManager))
+	{
+		phaseFraction = DISGameManager->SendManager->AssignPhaseFraction();
+	}
+	HeartbeatPhaseOffsetSeconds = phaseFraction * DISHeartbeatSeconds;
+
+	GetWorld()->GetTimerManager().SetTimer(UpdateEntityStateCalculationsHandle, this, &UDISSendComponent::UpdateEntityStateCalculations, EntityStateCalculationRate, true, EntityStateCalculationRate * (1 - phaseFraction));
+
+	//Wake scheduled threshold checks on movement that can not be predicted
+	LastTransformUpdateLocation = GetOwner()->GetActorLocation();
+	if (IsValid(GetOwner()->GetRootComponent()))
+	{
+		GetOwner()->GetRootComponent()->TransformUpdated.AddUObject(this, &UDISSendComponent::HandleOwnerTransformUpdated);
+	}
+
+	//Let the send manager evaluate this entity alongside the others instead of ticking on its own
+	if (IsValid(DISGameManager) && IsValid(DISGameManager->SendManager) && DISGameManager->SendManager->RegisterSendComponent(this))
+	{
+		SendManager = DISGameManager->SendManager;
+	}
 }
 
 void UDISSendComponent::UpdateEntityStateCalculations()
@@ -53,6 +114,7 @@ void UDISSendComponent::UpdateEntityStateCalculations()
 	double deltaTime = GetOwner()->GetGameTimeSinceCreation() - TimeOfLastParametersCalculation;
 
 	//Update previous velocity, rotation, and location regardless of if an Entity State PDU was sent out.		
+	const FVector previousAngularVelocity = LastCalculatedAngularVelocity;
 	LastCalculatedAngularVelocity = CalculateAngularVelocity();
 
 	CalculateECEFLinearVelocityAndAcceleration(LastCalculatedECEFLinearVelocity, LastCalculatedECEFLinearAcceleration);
@@ -62,12 +124,21 @@ void UDISSendComponent::UpdateEntityStateCalculations()
 	{
 		//Divide location offset by 100 to convert to meters
 		LastCalculatedUnrealLinearVelocity = (GetOwner()->GetActorLocation() - LastCalculatedUnrealLocation) / (deltaTime * 100);
+
+		//Track decaying peaks of the accelerations to bound the dead reckoning error when scheduling threshold checks
+		const float peakDecay = FMath::Pow(0.5f, static_cast<float>(deltaTime / DISSendComponentScheduling::PeakDecayHalfLifeSeconds));
+		ObservedPeakAccelerationMetersPerSecondSquared = FMath::Max(LastCalculatedECEFLinearAcceleration.Size(), ObservedPeakAccelerationMetersPerSecondSquared * peakDecay);
+		ObservedPeakAngularAccelerationRadiansPerSecondSquared = FMath::Max(static_cast<float>((LastCalculatedAngularVelocity - previousAngularVelocity).Size() / deltaTime),
+			ObservedPeakAngularAccelerationRadiansPerSecondSquared * peakDecay);
 	}
 
 	LastCalculatedUnrealLocation = GetOwner()->GetActorLocation();
 	LastCalculatedUnrealRotation = GetOwner()->GetActorRotation();
 
 	TimeOfLastParametersCalculation = GetOwner()->GetGameTimeSinceCreation();
+
+	//Follow remote observers as they and this entity move
+	UpdateObserverThresholdScale();
 }
 
 // Called every frame
@@ -108,55 +179,97 @@ void UDISSendComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 	//Ensure the Update Send Entity State Calculations timer is cleared by using the timer handle
 	GetWorld()->GetTimerManager().ClearTimer(UpdateEntityStateCalculationsHandle);
 
+	if (IsValid(GetOwner()->GetRootComponent()))
+	{
+		GetOwner()->GetRootComponent()->TransformUpdated.RemoveAll(this);
+	}
+
+	//The deactivation PDU supersedes any pending state change
+	if (PostActorTickHandle.IsValid())
+	{
+		FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+		PostActorTickHandle.Reset();
+	}
+	StateChangePending = false;
+
 	Super::EndPlay(EndPlayReason);
+
+	if (SendManager.IsValid())
+	{
+		SendManager->UnregisterSendComponent(this);
+		SendManager.Reset();
+	}
 }
 
-void UDISSendComponent::SetEntityCapabilities(int32 NewEntityCapabilities)
+void UDISSendComponent::SetEntityCapabilities(int32 NewEntityCapabilities, bool SendImmediately)
 {
 	//If the new entity capabilities differ, send out a new ESPDU
 	if (EntityStatePDUSendingMode == EEntityStateSendingMode::EntityStatePDU && NewEntityCapabilities != EntityCapabilities && NewEntityCapabilities >= 0)
 	{
 		EntityCapabilities = NewEntityCapabilities;
 
-		MostRecentEntityStatePDU = FormEntityStatePDU();
-		MostRecentDeadReckonedEntityStatePDU = MostRecentEntityStatePDU;
-
-		if (IsValid(UDPSubsystem))
-		{
-			UDPSubsystem->EmitBytes(UPDUConversions_BPFL::ConvertEntityStatePDUToBytes(MostRecentEntityStatePDU));
-		}
+		MarkStateChanged(SendImmediately);
 	}
 }
 
-void UDISSendComponent::SetEntityAppearance(int32 NewEntityAppearance)
+void UDISSendComponent::SetEntityAppearance(int32 NewEntityAppearance, bool SendImmediately)
 {
 	//If the new appearance differs, send out a new ESPDU
 	if (NewEntityAppearance != EntityAppearance && NewEntityAppearance >= 0)
 	{
 		EntityAppearance = NewEntityAppearance;
 
-		MostRecentEntityStatePDU = FormEntityStatePDU();
-		MostRecentDeadReckonedEntityStatePDU = MostRecentEntityStatePDU;
-
-		EmitAppropriatePDU(MostRecentEntityStatePDU);
+		MarkStateChanged(SendImmediately);
 	}
 }
 
-void UDISSendComponent::SetDeadReckoningAlgorithm(EDeadReckoningAlgorithm NewDeadReckoningAlgorithm)
+void UDISSendComponent::SetDeadReckoningAlgorithm(EDeadReckoningAlgorithm NewDeadReckoningAlgorithm, bool SendImmediately)
 {
 	//If the dead reckoning algorithm differs and is in the appropriate range, send out a new ESPDU
 	if (EntityStatePDUSendingMode == EEntityStateSendingMode::EntityStatePDU && NewDeadReckoningAlgorithm != DeadReckoningAlgorithm)
 	{
 		DeadReckoningAlgorithm = NewDeadReckoningAlgorithm;
 
-		MostRecentEntityStatePDU = FormEntityStatePDU();
-		MostRecentDeadReckonedEntityStatePDU = MostRecentEntityStatePDU;
+		MarkStateChanged(SendImmediately);
+	}
+}
 
-		if (IsValid(UDPSubsystem))
-		{
-			UDPSubsystem->EmitBytes(UPDUConversions_BPFL::ConvertEntityStatePDUToBytes(MostRecentEntityStatePDU));
-		}
+void UDISSendComponent::MarkStateChanged(bool SendImmediately)
+{
+	INC_DWORD_STAT(STAT_StateChanges);
+	StateChangePending = true;
+
+	if (SendImmediately)
+	{
+		EmitPendingStateChange();
 	}
+	else if (!PostActorTickHandle.IsValid())
+	{
+		//Changes made during the rest of the frame go out together once every actor has ticked
+		PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UDISSendComponent::HandleWorldPostActorTick);
+	}
+}
+
+void UDISSendComponent::EmitPendingStateChange()
+{
+	if (StateChangePending)
+	{
+		INC_DWORD_STAT(STAT_StateChangePDUsSent);
+		EmitEntityStatePDU(EUDPSendPriority::High);
+	}
+}
+
+void UDISSendComponent::HandleWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World != GetWorld())
+	{
+		return;
+	}
+
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	PostActorTickHandle.Reset();
+
+	EmitPendingStateChange();
 }
 
 FEntityStatePDU UDISSendComponent::FormEntityStatePDU()
@@ -170,8 +283,6 @@ FEntityStatePDU UDISSendComponent::FormEntityStatePDU()
 	newEntityStatePDU.Capabilities = EntityCapabilities;
 	newEntityStatePDU.EntityAppearance = EntityAppearance;
 
-	newEntityStatePDU.DeadReckoningParameters.DeadReckoningAlgorithm = DeadReckoningAlgorithm;
-
 	if (IsValid(DISGameManager))
 	{
 		newEntityStatePDU.ExerciseID = DISGameManager->ExerciseID;
@@ -182,50 +293,48 @@ FEntityStatePDU UDISSendComponent::FormEntityStatePDU()
 	}
 
 	//Set all geospatial values
-	if (IsValid(GeoReferencingSystem))
+	const FDISKinematicSnapshot& snapshot = GetKinematicSnapshot();
+	if (snapshot.GeoReferenced)
 	{
-		//Calculate the position of the entity in ECEF
-		FEarthCenteredEarthFixedFloat ecefLocation;
-		UDIS_BPFL::GetEcefXYZFromUnrealLocation(GetOwner()->GetActorLocation(), GeoReferencingSystem, ecefLocation);
-
-		newEntityStatePDU.EntityLocation = FVector(ecefLocation.X, ecefLocation.Y, ecefLocation.Z);
-		newEntityStatePDU.EntityLocationDouble = { ecefLocation.X, ecefLocation.Y, ecefLocation.Z };
+		newEntityStatePDU.EntityLocation = FVector(snapshot.EcefLocation.X, snapshot.EcefLocation.Y, snapshot.EcefLocation.Z);
+		newEntityStatePDU.EntityLocationDouble = { snapshot.EcefLocation.X, snapshot.EcefLocation.Y, snapshot.EcefLocation.Z };
 
-		//Calculate the orientation of the entity in Psi, Theta, Phi
-		FLatLonHeightFloat latLonHeightMeters;
-		FHeadingPitchRoll headingPitchRollDegrees;
-		FPsiThetaPhi psiThetaPhiRadians;
-		UDIS_BPFL::GetLatLonHeightFromUnrealLocation(GetOwner()->GetActorLocation(), GeoReferencingSystem, latLonHeightMeters);
-		UDIS_BPFL::GetHeadingPitchRollFromUnrealRotation(GetOwner()->GetActorRotation(), GetOwner()->GetActorLocation(), GeoReferencingSystem, headingPitchRollDegrees);
-		UDIS_BPFL::CalculatePsiThetaPhiRadiansFromHeadingPitchRollDegreesAtLatLon(headingPitchRollDegrees, latLonHeightMeters.Latitude, latLonHeightMeters.Longitude, psiThetaPhiRadians);
-
-		newEntityStatePDU.EntityOrientation = FRotator(psiThetaPhiRadians.Theta, psiThetaPhiRadians.Psi, psiThetaPhiRadians.Phi);
+		newEntityStatePDU.EntityOrientation = FRotator(snapshot.PsiThetaPhiRadians.Theta, snapshot.PsiThetaPhiRadians.Psi, snapshot.PsiThetaPhiRadians.Phi);
 	}
 	else
 	{
 		UE_LOG(LogDISSendComponent, Warning, TEXT("Invalid GeoReference. Please make sure one is in the world."));
 	}
 
+	SetDeadReckoningParameters(newEntityStatePDU, DeadReckoningAlgorithm, LastCalculatedAngularVelocity, LastCalculatedECEFLinearVelocity, LastCalculatedECEFLinearAcceleration,
+		LastCalculatedBodyLinearVelocity, LastCalculatedBodyLinearAcceleration);
+
+	return newEntityStatePDU;
+}
+
+void UDISSendComponent::SetDeadReckoningParameters(FEntityStatePDU& EntityStatePDU, EDeadReckoningAlgorithm Algorithm, const FVector& AngularVelocity, const FVector& ECEFLinearVelocity,
+	const FVector& ECEFLinearAcceleration, const FVector& BodyLinearVelocity, const FVector& BodyLinearAcceleration)
+{
+	EntityStatePDU.DeadReckoningParameters.DeadReckoningAlgorithm = Algorithm;
+
 	//Calculate the angular velocity of the entity
-	newEntityStatePDU.DeadReckoningParameters.EntityAngularVelocity = LastCalculatedAngularVelocity;
+	EntityStatePDU.DeadReckoningParameters.EntityAngularVelocity = AngularVelocity;
 
 	//Apply the appropriate linear velocity and acceleration based on Dead Reckoning algorithm being used
-	if (DeadReckoningAlgorithm == EDeadReckoningAlgorithm::Static || DeadReckoningAlgorithm == EDeadReckoningAlgorithm::FPW || DeadReckoningAlgorithm == EDeadReckoningAlgorithm::RPW
-		|| DeadReckoningAlgorithm == EDeadReckoningAlgorithm::RVW || DeadReckoningAlgorithm == EDeadReckoningAlgorithm::FVW)
+	if (Algorithm == EDeadReckoningAlgorithm::Static || Algorithm == EDeadReckoningAlgorithm::FPW || Algorithm == EDeadReckoningAlgorithm::RPW
+		|| Algorithm == EDeadReckoningAlgorithm::RVW || Algorithm == EDeadReckoningAlgorithm::FVW)
 	{
-		newEntityStatePDU.EntityLinearVelocity = LastCalculatedECEFLinearVelocity;
-		newEntityStatePDU.DeadReckoningParameters.EntityLinearAcceleration = LastCalculatedECEFLinearAcceleration;
+		EntityStatePDU.EntityLinearVelocity = ECEFLinearVelocity;
+		EntityStatePDU.DeadReckoningParameters.EntityLinearAcceleration = ECEFLinearAcceleration;
 	}
-	else if (DeadReckoningAlgorithm == EDeadReckoningAlgorithm::FPB || DeadReckoningAlgorithm == EDeadReckoningAlgorithm::RPB || DeadReckoningAlgorithm == EDeadReckoningAlgorithm::RVB
-		|| DeadReckoningAlgorithm == EDeadReckoningAlgorithm::FVB)
+	else if (Algorithm == EDeadReckoningAlgorithm::FPB || Algorithm == EDeadReckoningAlgorithm::RPB || Algorithm == EDeadReckoningAlgorithm::RVB
+		|| Algorithm == EDeadReckoningAlgorithm::FVB)
 	{
-		newEntityStatePDU.EntityLinearVelocity = LastCalculatedBodyLinearVelocity;
-		newEntityStatePDU.DeadReckoningParameters.EntityLinearAcceleration = LastCalculatedBodyLinearAcceleration;
+		EntityStatePDU.EntityLinearVelocity = BodyLinearVelocity;
+		EntityStatePDU.DeadReckoningParameters.EntityLinearAcceleration = BodyLinearAcceleration;
 	}
 
-	newEntityStatePDU.DeadReckoningParameters.OtherParameters = UDeadReckoning_BPFL::FormOtherParameters(DeadReckoningAlgorithm, newEntityStatePDU.EntityOrientation, newEntityStatePDU.EntityLocation);
-
-	return newEntityStatePDU;
+	EntityStatePDU.DeadReckoningParameters.OtherParameters = UDeadReckoning_BPFL::FormOtherParameters(Algorithm, EntityStatePDU.EntityOrientation, EntityStatePDU.EntityLocation);
 }
 
 bool UDISSendComponent::CheckDeadReckoningThreshold()
@@ -234,17 +343,8 @@ bool UDISSendComponent::CheckDeadReckoningThreshold()
 
 	if (UDeadReckoning_BPFL::DeadReckoning(MostRecentEntityStatePDU, DeltaTimeSinceLastPDU, MostRecentDeadReckonedEntityStatePDU))
 	{
-		//Get the actual position of the entity
-		FEarthCenteredEarthFixedFloat ecefLocation;
-		UDIS_BPFL::GetEcefXYZFromUnrealLocation(GetOwner()->GetActorLocation(), GeoReferencingSystem, ecefLocation);
-
-		//Get the position difference along each axis. Values should be in ECEF.
-		bool xPosOutsideThreshold = abs(ecefLocation.X - MostRecentDeadReckonedEntityStatePDU.EntityLocationDouble[0]) > DeadReckoningPositionThresholdMeters;
-		bool yPosOutsideThreshold = abs(ecefLocation.Y - MostRecentDeadReckonedEntityStatePDU.EntityLocationDouble[1]) > DeadReckoningPositionThresholdMeters;
-		bool zPosOutsideThreshold = abs(ecefLocation.Z - MostRecentDeadReckonedEntityStatePDU.EntityLocationDouble[2]) > DeadReckoningPositionThresholdMeters;
-
 		//Check if the position difference is beyond the position threshold in any axis
-		if (xPosOutsideThreshold || yPosOutsideThreshold || zPosOutsideThreshold || CheckOrientationQuaternionThreshold())
+		if (IsPositionOutsideThreshold(MostRecentDeadReckonedEntityStatePDU, GetKinematicSnapshot().EcefLocation, GetScaledPositionThresholdMeters()) || CheckOrientationQuaternionThreshold())
 		{
 			outsideThreshold = true;
 		}
@@ -253,49 +353,46 @@ bool UDISSendComponent::CheckDeadReckoningThreshold()
 	return outsideThreshold;
 }
 
+bool UDISSendComponent::IsPositionOutsideThreshold(const FEntityStatePDU& DeadReckonedEntityStatePDU, const FEarthCenteredEarthFixedDouble& ActualEcefLocation, float PositionThresholdMeters)
+{
+	//Get the position difference along each axis. Values should be in ECEF.
+	bool xPosOutsideThreshold = abs(ActualEcefLocation.X - DeadReckonedEntityStatePDU.EntityLocationDouble[0]) > PositionThresholdMeters;
+	bool yPosOutsideThreshold = abs(ActualEcefLocation.Y - DeadReckonedEntityStatePDU.EntityLocationDouble[1]) > PositionThresholdMeters;
+	bool zPosOutsideThreshold = abs(ActualEcefLocation.Z - DeadReckonedEntityStatePDU.EntityLocationDouble[2]) > PositionThresholdMeters;
+
+	return xPosOutsideThreshold || yPosOutsideThreshold || zPosOutsideThreshold;
+}
+
 bool UDISSendComponent::CheckOrientationQuaternionThreshold()
 {
-	bool outsideThreshold = false;
+	const FDISKinematicSnapshot& snapshot = GetKinematicSnapshot();
+	if (!snapshot.GeoReferenced)
+	{
+		UE_LOG(LogDISSendComponent, Warning, TEXT("Invalid GeoReference. Please make sure one is in the world."));
+		return false;
+	}
 
-	glm::dvec3 AngularVelocityVector = glm::dvec3(MostRecentEntityStatePDU.DeadReckoningParameters.EntityAngularVelocity.X,
-		MostRecentEntityStatePDU.DeadReckoningParameters.EntityAngularVelocity.Y, MostRecentEntityStatePDU.DeadReckoningParameters.EntityAngularVelocity.Z);
+	return IsOrientationOutsideThreshold(MostRecentEntityStatePDU, DeltaTimeSinceLastPDU, snapshot.EntityOrientationQuaternion, GetScaledOrientationThresholdDegrees());
+}
+
+bool UDISSendComponent::IsOrientationOutsideThreshold(const FEntityStatePDU& SentEntityStatePDU, float DeltaTimeSinceSent, const FQuat& ActualOrientationQuaternion, float OrientationThresholdDegrees)
+{
+	glm::dvec3 AngularVelocityVector = glm::dvec3(SentEntityStatePDU.DeadReckoningParameters.EntityAngularVelocity.X,
+		SentEntityStatePDU.DeadReckoningParameters.EntityAngularVelocity.Y, SentEntityStatePDU.DeadReckoningParameters.EntityAngularVelocity.Z);
 
 	//Get the entity orientation quaternion
-	FQuat entityOrientationQuaternion = UDeadReckoning_BPFL::GetEntityOrientationQuaternion(MostRecentEntityStatePDU.EntityOrientation.Yaw, MostRecentEntityStatePDU.EntityOrientation.Pitch, MostRecentEntityStatePDU.EntityOrientation.Roll);
+	FQuat entityOrientationQuaternion = UDeadReckoning_BPFL::GetEntityOrientationQuaternion(SentEntityStatePDU.EntityOrientation.Yaw, SentEntityStatePDU.EntityOrientation.Pitch, SentEntityStatePDU.EntityOrientation.Roll);
 	//Get the entity dead reckoning quaternion
-	FQuat deadReckoningQuaternion = UDeadReckoning_BPFL::CreateDeadReckoningQuaternion(AngularVelocityVector, DeltaTimeSinceLastPDU);
+	FQuat deadReckoningQuaternion = UDeadReckoning_BPFL::CreateDeadReckoningQuaternion(AngularVelocityVector, DeltaTimeSinceSent);
 	//Calculate the new orientation quaternion
 	FQuat DR_OrientationQuaternion = entityOrientationQuaternion * deadReckoningQuaternion;
 
-	FQuat actualOrientationQuaternion;
-
-	if (IsValid(GeoReferencingSystem))
-	{
-		//Calculate the orientation of the entity in Psi, Theta, Phi
-		FLatLonHeightFloat latLonHeightMeters;
-		FHeadingPitchRoll headingPitchRollDegrees;
-		FPsiThetaPhi psiThetaPhiRadians;
-
-		UDIS_BPFL::GetLatLonHeightFromUnrealLocation(GetOwner()->GetActorLocation(), GeoReferencingSystem, latLonHeightMeters);
-		UDIS_BPFL::GetHeadingPitchRollFromUnrealRotation(GetOwner()->GetActorRotation(), GetOwner()->GetActorLocation(), GeoReferencingSystem, headingPitchRollDegrees);
-		UDIS_BPFL::CalculatePsiThetaPhiRadiansFromHeadingPitchRollDegreesAtLatLon(headingPitchRollDegrees, latLonHeightMeters.Latitude, latLonHeightMeters.Longitude, psiThetaPhiRadians);
-		// Get the entity's current orientation quaternion
-		actualOrientationQuaternion = UDeadReckoning_BPFL::GetEntityOrientationQuaternion(psiThetaPhiRadians.Psi, psiThetaPhiRadians.Theta, psiThetaPhiRadians.Phi);
-	}
-	else
-	{
-		UE_LOG(LogDISSendComponent, Warning, TEXT("Invalid GeoReference. Please make sure one is in the world."));
-		return false;
-	}
-
-	float quaternionDotProduct = actualOrientationQuaternion.operator|(DR_OrientationQuaternion);
+	float quaternionDotProduct = ActualOrientationQuaternion.operator|(DR_OrientationQuaternion);
 
-	double OrientationQuaternionThresholdEpsilon = 1 - FMath::Cos(FMath::DegreesToRadians(DeadReckoningOrientationThresholdDegrees / 2));
+	double OrientationQuaternionThresholdEpsilon = 1 - FMath::Cos(FMath::DegreesToRadians(OrientationThresholdDegrees / 2));
 
 	//Check if outside of threshold -- 1 is chosen so that left hand side will be 0 if rotations do not differ
-	outsideThreshold = (1 - quaternionDotProduct) > OrientationQuaternionThresholdEpsilon;
-
-	return outsideThreshold;
+	return (1 - quaternionDotProduct) > OrientationQuaternionThresholdEpsilon;
 }
 
 bool UDISSendComponent::CheckOrientationMatrixThreshold()
@@ -314,16 +411,10 @@ bool UDISSendComponent::CheckOrientationMatrixThreshold()
 
 	glm::dmat3 ActualOrientationMatrix;
 
-	if (IsValid(GeoReferencingSystem))
+	const FDISKinematicSnapshot& snapshot = GetKinematicSnapshot();
+	if (snapshot.GeoReferenced)
 	{
-		//Calculate the orientation of the entity in Psi, Theta, Phi
-		FLatLonHeightFloat latLonHeightMeters;
-		FHeadingPitchRoll headingPitchRollDegrees;
-		FPsiThetaPhi psiThetaPhiRadians;
-
-		UDIS_BPFL::GetLatLonHeightFromUnrealLocation(GetOwner()->GetActorLocation(), GeoReferencingSystem, latLonHeightMeters);
-		UDIS_BPFL::GetHeadingPitchRollFromUnrealRotation(GetOwner()->GetActorRotation(), GetOwner()->GetActorLocation(), GeoReferencingSystem, headingPitchRollDegrees);
-		UDIS_BPFL::CalculatePsiThetaPhiRadiansFromHeadingPitchRollDegreesAtLatLon(headingPitchRollDegrees, latLonHeightMeters.Latitude, latLonHeightMeters.Longitude, psiThetaPhiRadians);
+		const FPsiThetaPhi& psiThetaPhiRadians = snapshot.PsiThetaPhiRadians;
 		// Get the entity's current orientation matrix
 		ActualOrientationMatrix = UDeadReckoning_BPFL::GetEntityOrientationMatrix(psiThetaPhiRadians.Psi, psiThetaPhiRadians.Theta, psiThetaPhiRadians.Phi);
 	}
@@ -337,7 +428,7 @@ bool UDISSendComponent::CheckOrientationMatrixThreshold()
 	auto rotDiffMatrix = glm::transpose(DR_OrientationMatrix) * ActualOrientationMatrix;
 	float rotDiffTrace = rotDiffMatrix[0][0] + rotDiffMatrix[1][1] + rotDiffMatrix[2][2];
 
-	double OrientationMatrixThresholdDelta = 2 - 2 * FMath::Cos(FMath::DegreesToRadians(DeadReckoningOrientationThresholdDegrees));
+	double OrientationMatrixThresholdDelta = 2 - 2 * FMath::Cos(FMath::DegreesToRadians(GetScaledOrientationThresholdDegrees()));
 
 	//Check if outside of threshold -- 3 is chosen so that left hand side will be 0 if rotations do not differ (that is if the rotDiffMatrix was an identity matrix)
 	outsideThreshold = (3 - rotDiffTrace) > OrientationMatrixThresholdDelta;
@@ -349,21 +440,212 @@ bool UDISSendComponent::SendEntityStatePDU()
 {
 	bool sentUpdate = false;
 
-	//Verify a new Entity State or Entity State Update PDU should be sent
-	if ((EntityStatePDUSendingMode == EEntityStateSendingMode::EntityStatePDU || EntityStatePDUSendingMode == EEntityStateSendingMode::EntityStateUpdatePDU) && (DeltaTimeSinceLastPDU > DISHeartbeatSeconds || CheckDeadReckoningThreshold()))
+	if (EntityStatePDUSendingMode != EEntityStateSendingMode::EntityStatePDU && EntityStatePDUSendingMode != EEntityStateSendingMode::EntityStateUpdatePDU)
 	{
-		MostRecentEntityStatePDU = FormEntityStatePDU();
-		MostRecentDeadReckonedEntityStatePDU = MostRecentEntityStatePDU;
-
-		EmitAppropriatePDU(MostRecentEntityStatePDU);
+		return sentUpdate;
+	}
 
+	//Verify a new Entity State or Entity State Update PDU should be sent. Thresholds can not be exceeded before the scheduled check.
+	const bool thresholdCheckDue = DeltaTimeSinceLastPDU >= NextThresholdCheckSeconds;
+	if (thresholdCheckDue && CheckDeadReckoningThreshold())
+	{
+		double positionErrorMeters, orientationErrorRadians;
+		MeasureDeadReckoningError(positionErrorMeters, orientationErrorRadians);
+		EmitEntityStatePDU(GetThresholdSendPriority(positionErrorMeters, orientationErrorRadians));
 		sentUpdate = true;
-		DeltaTimeSinceLastPDU = 0;
+	}
+	else if (IsHeartbeatDue())
+	{
+		//Heartbeats only restate the dead reckoned state
+		EmitEntityStatePDU(EUDPSendPriority::Low);
+		sentUpdate = true;
+	}
+	else if (thresholdCheckDue)
+	{
+		ScheduleNextThresholdCheck();
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_ThresholdChecksSkipped);
 	}
 
 	return sentUpdate;
 }
 
+void UDISSendComponent::EmitEntityStatePDU(EUDPSendPriority Priority)
+{
+	//The PDU carries any pending appearance, capability, or dead reckoning algorithm change, which can not wait for bandwidth
+	if (StateChangePending)
+	{
+		StateChangePending = false;
+		Priority = EUDPSendPriority::High;
+	}
+
+	MostRecentEntityStatePDU = FormEntityStatePDU();
+	MostRecentDeadReckonedEntityStatePDU = MostRecentEntityStatePDU;
+
+	EmitAppropriatePDU(MostRecentEntityStatePDU, Priority);
+
+	DeltaTimeSinceLastPDU = 0;
+	HeartbeatPhaseOffsetSeconds = 0;
+	ScheduleNextThresholdCheck(0, 0);
+}
+
+bool UDISSendComponent::IsHeartbeatDue(float LookaheadSeconds) const
+{
+	return DeltaTimeSinceLastPDU + LookaheadSeconds > GetScaledHeartbeatSeconds() - HeartbeatPhaseOffsetSeconds;
+}
+
+void UDISSendComponent::ScheduleNextThresholdCheck(double PositionErrorMeters, double OrientationErrorRadians)
+{
+	const EDeadReckoningAlgorithm algorithm = MostRecentEntityStatePDU.DeadReckoningParameters.DeadReckoningAlgorithm;
+	const bool hasAcceleration = algorithm == EDeadReckoningAlgorithm::RVW || algorithm == EDeadReckoningAlgorithm::FVW;
+	const bool hasVelocity = hasAcceleration || algorithm == EDeadReckoningAlgorithm::FPW || algorithm == EDeadReckoningAlgorithm::RPW;
+
+	//Body algorithms dead reckon in a rotating frame the bounds below do not cover, so check them every tick
+	if (!ScheduleThresholdChecks || !(hasVelocity || algorithm == EDeadReckoningAlgorithm::Static))
+	{
+		NextThresholdCheckSeconds = 0;
+		return;
+	}
+
+	const double elapsedSeconds = DeltaTimeSinceLastPDU;
+
+	//The actual acceleration differs from the dead reckoned one by at most the bound plus whatever acceleration was sent
+	const double accelerationBound = FMath::Max(ObservedPeakAccelerationMetersPerSecondSquared, MinimumAccelerationBoundMetersPerSecondSquared)
+		+ (hasAcceleration ? MostRecentEntityStatePDU.DeadReckoningParameters.EntityLinearAcceleration.Size() : 0);
+	//Sent velocities are averaged over the calculation interval, so they may already be off by one interval of acceleration
+	const double velocityErrorBound = hasVelocity ? accelerationBound * (EntityStateCalculationRate + elapsedSeconds)
+		: LastCalculatedECEFLinearVelocity.Size() + accelerationBound * EntityStateCalculationRate;
+
+	const double angularAccelerationBound = FMath::Max(ObservedPeakAngularAccelerationRadiansPerSecondSquared, MinimumAngularAccelerationBoundRadiansPerSecondSquared);
+	const double angularVelocityErrorBound = angularAccelerationBound * (EntityStateCalculationRate + elapsedSeconds);
+
+	const double positionSeconds = DISSendComponentScheduling::TimeToThreshold(PositionErrorMeters, velocityErrorBound, accelerationBound, GetScaledPositionThresholdMeters());
+	const double orientationSeconds = DISSendComponentScheduling::TimeToThreshold(OrientationErrorRadians, angularVelocityErrorBound, angularAccelerationBound,
+		FMath::DegreesToRadians(GetScaledOrientationThresholdDegrees()));
+
+	//Heartbeats are sent regardless, no need to look past them
+	NextThresholdCheckSeconds = static_cast<float>(FMath::Min<double>(elapsedSeconds + DISSendComponentScheduling::SafetyFactor * FMath::Min(positionSeconds, orientationSeconds), GetScaledHeartbeatSeconds()));
+}
+
+void UDISSendComponent::ScheduleNextThresholdCheck()
+{
+	double positionErrorMeters, orientationErrorRadians;
+	if (!MeasureDeadReckoningError(positionErrorMeters, orientationErrorRadians))
+	{
+		NextThresholdCheckSeconds = 0;
+		return;
+	}
+
+	ScheduleNextThresholdCheck(positionErrorMeters, orientationErrorRadians);
+}
+
+bool UDISSendComponent::MeasureDeadReckoningError(double& OutPositionErrorMeters, double& OutOrientationErrorRadians)
+{
+	OutPositionErrorMeters = 0;
+	OutOrientationErrorRadians = 0;
+
+	const FDISKinematicSnapshot& snapshot = GetKinematicSnapshot();
+	if (!snapshot.GeoReferenced)
+	{
+		return false;
+	}
+
+	const double xError = snapshot.EcefLocation.X - MostRecentDeadReckonedEntityStatePDU.EntityLocationDouble[0];
+	const double yError = snapshot.EcefLocation.Y - MostRecentDeadReckonedEntityStatePDU.EntityLocationDouble[1];
+	const double zError = snapshot.EcefLocation.Z - MostRecentDeadReckonedEntityStatePDU.EntityLocationDouble[2];
+	OutPositionErrorMeters = FMath::Sqrt(xError * xError + yError * yError + zError * zError);
+
+	const FVector& angularVelocity = MostRecentEntityStatePDU.DeadReckoningParameters.EntityAngularVelocity;
+	const FQuat deadReckonedOrientation = UDeadReckoning_BPFL::GetEntityOrientationQuaternion(MostRecentEntityStatePDU.EntityOrientation.Yaw, MostRecentEntityStatePDU.EntityOrientation.Pitch, MostRecentEntityStatePDU.EntityOrientation.Roll)
+		* UDeadReckoning_BPFL::CreateDeadReckoningQuaternion(glm::dvec3(angularVelocity.X, angularVelocity.Y, angularVelocity.Z), DeltaTimeSinceLastPDU);
+	OutOrientationErrorRadians = snapshot.EntityOrientationQuaternion.AngularDistance(deadReckonedOrientation);
+
+	return true;
+}
+
+float UDISSendComponent::GetScaledHeartbeatSeconds() const
+{
+	const float scaledHeartbeatSeconds = DISHeartbeatSeconds * ObserverThresholdScale;
+	if (ObserverThresholdScale <= 1)
+	{
+		return scaledHeartbeatSeconds;
+	}
+
+	//Remote simulations time out entities that go quiet for too long
+	return FMath::Min(scaledHeartbeatSeconds, FMath::Max(MaximumScaledHeartbeatSeconds, DISHeartbeatSeconds));
+}
+
+FEntityStatePDU UDISSendComponent::GetCurrentDeadReckonedEntityStatePDU() const
+{
+	FEntityStatePDU deadReckonedEntityStatePDU = MostRecentEntityStatePDU;
+	UDeadReckoning_BPFL::DeadReckoning(MostRecentEntityStatePDU, DeltaTimeSinceLastPDU, deadReckonedEntityStatePDU);
+
+	return deadReckonedEntityStatePDU;
+}
+
+void UDISSendComponent::UpdateObserverThresholdScale()
+{
+	const float previousScale = ObserverThresholdScale;
+	ObserverThresholdScale = 1;
+
+	//Observers are tracked whether or not this component is registered with the send manager
+	if (!ScaleThresholdsByObserverDistance || !IsValid(DISGameManager) || !IsValid(DISGameManager->SendManager))
+	{
+		return;
+	}
+
+	const FDISKinematicSnapshot& snapshot = GetKinematicSnapshot();
+	if (!snapshot.GeoReferenced)
+	{
+		return;
+	}
+
+	ObserverThresholdScale = EvaluateObserverThresholdScale(ObserverDistanceThresholdScale, *DISGameManager->SendManager, snapshot.EcefLocation);
+
+	//A threshold check scheduled against the looser thresholds may be too late for an observer that has come closer
+	if (ObserverThresholdScale < previousScale)
+	{
+		NextThresholdCheckSeconds = 0;
+	}
+}
+
+float UDISSendComponent::EvaluateObserverThresholdScale(const FRuntimeFloatCurve& ScaleCurve, const UDISSendManager& SendManager, const FEarthCenteredEarthFixedDouble& EcefLocation)
+{
+	//With no remote observers the scale beyond the last key applies
+	double nearestObserverDistanceMeters;
+	if (!SendManager.GetNearestRemoteObserverDistanceMeters(EcefLocation, nearestObserverDistanceMeters))
+	{
+		nearestObserverDistanceMeters = TNumericLimits<float>::Max();
+	}
+
+	return FMath::Max(ScaleCurve.GetRichCurveConst()->Eval(static_cast<float>(nearestObserverDistanceMeters), 1.f), KINDA_SMALL_NUMBER);
+}
+
+EUDPSendPriority UDISSendComponent::GetThresholdSendPriority(double PositionErrorMeters, double OrientationErrorRadians) const
+{
+	//Receivers need updates far past a threshold most, small overshoots can wait for bandwidth
+	const bool largeError = PositionErrorMeters > GetScaledPositionThresholdMeters() * HighPriorityThresholdMultiple
+		|| OrientationErrorRadians > FMath::DegreesToRadians(GetScaledOrientationThresholdDegrees()) * HighPriorityThresholdMultiple;
+
+	return largeError ? EUDPSendPriority::High : EUDPSendPriority::Normal;
+}
+
+void UDISSendComponent::HandleOwnerTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	const FVector location = UpdatedComponent->GetComponentLocation();
+
+	//Convert the position threshold to centimeters
+	const float jumpThreshold = GetScaledPositionThresholdMeters() * 100;
+	if (Teleport != ETeleportType::None || FVector::DistSquared(location, LastTransformUpdateLocation) > jumpThreshold * jumpThreshold)
+	{
+		NextThresholdCheckSeconds = 0;
+	}
+
+	LastTransformUpdateLocation = location;
+}
+
 void UDISSendComponent::CalculateECEFLinearVelocityAndAcceleration(FVector& ECEFLinearVelocity, FVector& ECEFLinearAcceleration)
 {
 	double timeSinceLastCalc = GetOwner()->GetGameTimeSinceCreation() - TimeOfLastParametersCalculation;
@@ -375,16 +657,14 @@ void UDISSendComponent::CalculateECEFLinearVelocityAndAcceleration(FVector& ECEF
 		//Divide location offset by 100 to convert to meters
 		FVector curUnrealLinearVelocity = (curLoc - LastCalculatedUnrealLocation) / (timeSinceLastCalc * 100);
 
-		FEarthCenteredEarthFixedFloat originECEF;
+		const FEarthCenteredEarthFixedDouble& originECEF = GetKinematicSnapshot().OriginEcefLocation;
 		FEarthCenteredEarthFixedFloat curLinVelECEF;
-		FEarthCenteredEarthFixedFloat oldLinVelECEF;
-		UDIS_BPFL::GetEcefXYZFromUnrealLocation(FVector::ZeroVector, GeoReferencingSystem, originECEF);
 		UDIS_BPFL::GetEcefXYZFromUnrealLocation(curUnrealLinearVelocity * 100, GeoReferencingSystem, curLinVelECEF);
-		UDIS_BPFL::GetEcefXYZFromUnrealLocation(LastCalculatedUnrealLinearVelocity * 100, GeoReferencingSystem, oldLinVelECEF);
 
+		//The previous velocity was converted to ECEF when it was calculated. Read it first, as the output may be LastCalculatedECEFLinearVelocity itself.
+		const FVector prevECEFLinearVelocity = LastCalculatedECEFLinearVelocity;
 		//Convert linear velocity vectors to be in ECEF coordinates --- UE origin may not be Earth center and may lie rotated on Earth
 		ECEFLinearVelocity = FVector(curLinVelECEF.X - originECEF.X, curLinVelECEF.Y - originECEF.Y, curLinVelECEF.Z - originECEF.Z);
-		FVector prevECEFLinearVelocity = FVector(oldLinVelECEF.X - originECEF.X, oldLinVelECEF.Y - originECEF.Y, oldLinVelECEF.Z - originECEF.Z);
 		ECEFLinearAcceleration = (ECEFLinearVelocity - prevECEFLinearVelocity) / timeSinceLastCalc;
 	}
 	else
@@ -409,16 +689,7 @@ void UDISSendComponent::CalculateBodyLinearVelocityAndAcceleration(FVector Angul
 		//Convert linear velocity vectors to be in body space --- Use inverse UE rotations to convert vectors into appropriate DIS body space
 		BodyLinearVelocity = UKismetMathLibrary::GreaterGreater_VectorRotator(curUnrealLinearVelocity, GetOwner()->GetActorRotation().GetInverse()) * FVector(1, 1, -1);
 		FVector prevVelBodySpace = UKismetMathLibrary::GreaterGreater_VectorRotator(LastCalculatedUnrealLinearVelocity, LastCalculatedUnrealRotation.GetInverse()) * FVector(1, 1, -1);
-		BodyLinearAcceleration = (BodyLinearVelocity - prevVelBodySpace) / timeSinceLastCalc;
-
-		//Calculate the centripetal acceleration in body space
-		glm::dvec3 dvecAngularVelocity = glm::dvec3(AngularVelocity.X, AngularVelocity.Y, AngularVelocity.Z);
-		glm::dmat3x3 SkewMatrix = UDIS_BPFL::CreateNCrossXMatrix(dvecAngularVelocity);
-		glm::dvec3 dvecBodyVelocityVector = glm::dvec3(BodyLinearVelocity.X, BodyLinearVelocity.Y, BodyLinearVelocity.Z);
-		glm::dvec3 dvecCentripetalAcceleration = (SkewMatrix * dvecBodyVelocityVector);
-
-		//Add in body centripetal acceleration. Will get removed by the body dead reckoning algorithm
-		BodyLinearAcceleration += FVector(dvecCentripetalAcceleration.x, dvecCentripetalAcceleration.y, dvecCentripetalAcceleration.z);
+		BodyLinearAcceleration = CalculateBodyLinearAccelerationBetween(BodyLinearVelocity, prevVelBodySpace, AngularVelocity, timeSinceLastCalc);
 	}
 	else
 	{
@@ -435,45 +706,117 @@ FVector UDISSendComponent::CalculateAngularVelocity()
 
 	if (timeSinceLastCalc > 0)
 	{
-		//Convert the rotators to quaternions
-		FQuat oldQuat = LastCalculatedUnrealRotation.Quaternion();
-		FQuat newQuat = GetOwner()->GetActorRotation().Quaternion();
-		oldQuat.Normalize();
-		newQuat.Normalize();
+		angularVelocity = CalculateAngularVelocityBetween(LastCalculatedUnrealRotation.Quaternion(), GetOwner()->GetActorRotation().Quaternion(), timeSinceLastCalc);
+		//Invert X and Y axis
+		angularVelocity *= FVector(-1, -1, 1);
+	}
 
-		//Get the rotational difference between the quaternions -- Gives back direction of rotation too
-		FQuat rotDiff = oldQuat.Inverse() * newQuat;
+	return angularVelocity;
+}
 
-		//If negative, flip it
-		if (rotDiff.W < 0)
-		{
-			rotDiff = rotDiff.Inverse();
-			rotDiff.W *= -1;
-		}
+FVector UDISSendComponent::CalculateAngularVelocityBetween(FQuat PreviousQuat, FQuat CurrentQuat, double DeltaSeconds)
+{
+	PreviousQuat.Normalize();
+	CurrentQuat.Normalize();
 
-		FVector rotationAxis;
-		float rotationAngle;
-		rotDiff.ToAxisAndAngle(rotationAxis, rotationAngle);
+	//Get the rotational difference between the quaternions -- Gives back direction of rotation too
+	FQuat rotDiff = PreviousQuat.Inverse() * CurrentQuat;
 
-		angularVelocity = (rotationAngle * rotationAxis) / timeSinceLastCalc;
-		//Invert X and Y axis
-		angularVelocity *= FVector(-1, -1, 1);
+	//If negative, flip it
+	if (rotDiff.W < 0)
+	{
+		rotDiff = rotDiff.Inverse();
+		rotDiff.W *= -1;
 	}
 
-	return angularVelocity;
+	FVector rotationAxis;
+	float rotationAngle;
+	rotDiff.ToAxisAndAngle(rotationAxis, rotationAngle);
+
+	return (rotationAngle * rotationAxis) / DeltaSeconds;
+}
+
+FVector UDISSendComponent::CalculateBodyLinearAccelerationBetween(const FVector& BodyLinearVelocity, const FVector& PreviousBodyLinearVelocity, const FVector& AngularVelocity, double DeltaSeconds)
+{
+	FVector bodyLinearAcceleration = (BodyLinearVelocity - PreviousBodyLinearVelocity) / DeltaSeconds;
+
+	//Calculate the centripetal acceleration in body space
+	glm::dvec3 dvecAngularVelocity = glm::dvec3(AngularVelocity.X, AngularVelocity.Y, AngularVelocity.Z);
+	glm::dmat3x3 SkewMatrix = UDIS_BPFL::CreateNCrossXMatrix(dvecAngularVelocity);
+	glm::dvec3 dvecBodyVelocityVector = glm::dvec3(BodyLinearVelocity.X, BodyLinearVelocity.Y, BodyLinearVelocity.Z);
+	glm::dvec3 dvecCentripetalAcceleration = (SkewMatrix * dvecBodyVelocityVector);
+
+	//Add in body centripetal acceleration. Will get removed by the body dead reckoning algorithm
+	bodyLinearAcceleration += FVector(dvecCentripetalAcceleration.x, dvecCentripetalAcceleration.y, dvecCentripetalAcceleration.z);
+
+	return bodyLinearAcceleration;
+}
+
+const FDISKinematicSnapshot& UDISSendComponent::GetKinematicSnapshot()
+{
+	const FVector unrealLocation = GetOwner()->GetActorLocation();
+	const FQuat unrealQuat = GetOwner()->GetActorQuat();
+
+	//Reuse this frame's snapshot unless the actor has been moved since
+	if (KinematicSnapshot.FrameNumber == GFrameCounter && KinematicSnapshot.UnrealLocation == unrealLocation && KinematicSnapshot.UnrealQuat.Equals(unrealQuat, 0.f)
+		&& KinematicSnapshot.GeoReferenced == IsValid(GeoReferencingSystem))
+	{
+		INC_DWORD_STAT(STAT_KinematicSnapshotsReused);
+		return KinematicSnapshot;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_UpdateKinematicSnapshot);
+	INC_DWORD_STAT(STAT_KinematicSnapshotsCalculated);
+
+	KinematicSnapshot.FrameNumber = GFrameCounter;
+	KinematicSnapshot.UnrealLocation = unrealLocation;
+	KinematicSnapshot.UnrealQuat = unrealQuat;
+	KinematicSnapshot.UnrealRotation = GetOwner()->GetActorRotation();
+	KinematicSnapshot.GeoReferenced = IsValid(GeoReferencingSystem);
+
+	if (!KinematicSnapshot.GeoReferenced)
+	{
+		KinematicSnapshot.EcefLocation = FEarthCenteredEarthFixedDouble();
+		KinematicSnapshot.OriginEcefLocation = FEarthCenteredEarthFixedDouble();
+		return KinematicSnapshot;
+	}
+
+	FDISGeoTransformCache::EngineToEcef(GeoReferencingSystem, unrealLocation, KinematicSnapshot.EcefLocation);
+	FDISGeoTransformCache::EngineToEcef(GeoReferencingSystem, FVector::ZeroVector, KinematicSnapshot.OriginEcefLocation);
+	UDIS_BPFL::CalculateLatLonHeightFromEcefXYZ(KinematicSnapshot.EcefLocation, KinematicSnapshot.LatLonHeightDegreesMeters);
+	UDIS_BPFL::GetHeadingPitchRollFromUnrealRotation(KinematicSnapshot.UnrealRotation, unrealLocation, GeoReferencingSystem, KinematicSnapshot.HeadingPitchRollDegrees);
+
+	//Same path as UDIS_BPFL::GetPsiThetaPhiRadiansFromUnrealRotation, reusing the location conversions above
+	if (UDIS_BPFL::UseQuaternionOrientation())
+	{
+		UDIS_BPFL::GetPsiThetaPhiRadiansFromUnrealQuatAtEcef(unrealQuat, KinematicSnapshot.EcefLocation, GeoReferencingSystem, KinematicSnapshot.PsiThetaPhiRadians);
+	}
+	else
+	{
+		UDIS_BPFL::CalculatePsiThetaPhiRadiansFromHeadingPitchRollDegreesAtLatLon(KinematicSnapshot.HeadingPitchRollDegrees, KinematicSnapshot.LatLonHeightDegreesMeters.Latitude,
+			KinematicSnapshot.LatLonHeightDegreesMeters.Longitude, KinematicSnapshot.PsiThetaPhiRadians);
+	}
+
+	KinematicSnapshot.EntityOrientationQuaternion = UDeadReckoning_BPFL::GetEntityOrientationQuaternion(KinematicSnapshot.PsiThetaPhiRadians.Psi,
+		KinematicSnapshot.PsiThetaPhiRadians.Theta, KinematicSnapshot.PsiThetaPhiRadians.Phi);
+
+	return KinematicSnapshot;
 }
 
-bool UDISSendComponent::EmitAppropriatePDU(FEntityStatePDU pduToSend)
+bool UDISSendComponent::EmitAppropriatePDU(FEntityStatePDU pduToSend, EUDPSendPriority Priority)
 {
 	bool successful = false;
+	//Deferred updates of this entity are replaced by newer ones
+	const int64 mergeKey = (int64(1) << 48) | (int64(pduToSend.EntityID.Site) << 32) | (int64(pduToSend.EntityID.Application) << 16) | int64(pduToSend.EntityID.Entity);
+
 	//Send out the appropriate PDU
 	if (IsValid(UDPSubsystem) && EntityStatePDUSendingMode == EEntityStateSendingMode::EntityStatePDU)
 	{
-		successful = UDPSubsystem->EmitBytes(UPDUConversions_BPFL::ConvertEntityStatePDUToBytes(pduToSend));
+		successful = UDPSubsystem->EmitBytesWithPriority(UPDUConversions_BPFL::ConvertEntityStatePDUToBytes(pduToSend), Priority, mergeKey);
 	}
 	else if (IsValid(UDPSubsystem) && EntityStatePDUSendingMode == EEntityStateSendingMode::EntityStateUpdatePDU)
 	{
-		successful = UDPSubsystem->EmitBytes(UPDUConversions_BPFL::ConvertEntityStateUpdatePDUToBytes(pduToSend.ToEntityStateUpdatePDU()));
+		successful = UDPSubsystem->EmitBytesWithPriority(UPDUConversions_BPFL::ConvertEntityStateUpdatePDUToBytes(pduToSend.ToEntityStateUpdatePDU()), Priority, mergeKey);
 	}
 
 	return successful;
@@ -0,0 +1,449 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISSendManager.h"
+#include "DISSendComponent.h"
+#include "DeadReckoning_BPFL.h"
+#include "DISQuaternionConversions.h"
+#include "GeoReferencingSystem.h"
+
+DEFINE_LOG_CATEGORY(LogDISSendManager);
+
+void FDISSendThresholdBatch::SetNumUninitialized(int32 NewNum)
+{
+	UnrealLocations.SetNumUninitialized(NewNum);
+	UnrealRotations.SetNumUninitialized(NewNum);
+	DeltaTimesSinceLastPDU.SetNumUninitialized(NewNum);
+	PositionThresholdsMeters.SetNumUninitialized(NewNum);
+	OrientationThresholdsDegrees.SetNumUninitialized(NewNum);
+
+	Batched.SetNumUninitialized(NewNum);
+	SentLocations.SetNumUninitialized(NewNum);
+	SentLinearVelocities.SetNumUninitialized(NewNum);
+	SentLinearAccelerations.SetNumUninitialized(NewNum);
+	SentAngularVelocities.SetNumUninitialized(NewNum);
+	SentOrientations.SetNumUninitialized(NewNum);
+
+	EcefLocations.SetNumUninitialized(NewNum);
+	PsiThetaPhiRadians.SetNumUninitialized(NewNum);
+	DeadReckonedLocations.SetNumUninitialized(NewNum);
+	DeadReckonedOrientations.SetNumUninitialized(NewNum);
+	OutsideThreshold.SetNumUninitialized(NewNum);
+	PositionErrorsMeters.SetNumUninitialized(NewNum);
+	OrientationErrorsRadians.SetNumUninitialized(NewNum);
+}
+
+void FDISSendThresholdBatch::SetSentState(int32 Index, const FEntityStatePDU& EntityStatePDU)
+{
+	const EDeadReckoningAlgorithm algorithm = EntityStatePDU.DeadReckoningParameters.DeadReckoningAlgorithm;
+	const bool hasAcceleration = algorithm == EDeadReckoningAlgorithm::RVW || algorithm == EDeadReckoningAlgorithm::FVW;
+	const bool hasVelocity = hasAcceleration || algorithm == EDeadReckoningAlgorithm::FPW || algorithm == EDeadReckoningAlgorithm::RPW;
+
+	//Frozen entities are never dead reckoned, UDeadReckoning_BPFL::DeadReckoning handles them along with the body algorithms
+	Batched[Index] = !EntityStatePDU.EntityAppearance.IsFrozen && (hasVelocity || algorithm == EDeadReckoningAlgorithm::Static);
+
+	SentLocations.X[Index] = EntityStatePDU.EntityLocationDouble[0];
+	SentLocations.Y[Index] = EntityStatePDU.EntityLocationDouble[1];
+	SentLocations.Z[Index] = EntityStatePDU.EntityLocationDouble[2];
+
+	const FVector velocity = hasVelocity ? EntityStatePDU.EntityLinearVelocity : FVector::ZeroVector;
+	SentLinearVelocities.X[Index] = velocity.X;
+	SentLinearVelocities.Y[Index] = velocity.Y;
+	SentLinearVelocities.Z[Index] = velocity.Z;
+
+	const FVector acceleration = hasAcceleration ? EntityStatePDU.DeadReckoningParameters.EntityLinearAcceleration : FVector::ZeroVector;
+	SentLinearAccelerations.X[Index] = acceleration.X;
+	SentLinearAccelerations.Y[Index] = acceleration.Y;
+	SentLinearAccelerations.Z[Index] = acceleration.Z;
+
+	SentAngularVelocities.X[Index] = EntityStatePDU.DeadReckoningParameters.EntityAngularVelocity.X;
+	SentAngularVelocities.Y[Index] = EntityStatePDU.DeadReckoningParameters.EntityAngularVelocity.Y;
+	SentAngularVelocities.Z[Index] = EntityStatePDU.DeadReckoningParameters.EntityAngularVelocity.Z;
+
+	SentOrientations[Index] = UDeadReckoning_BPFL::GetEntityOrientationQuaternion(EntityStatePDU.EntityOrientation.Yaw, EntityStatePDU.EntityOrientation.Pitch, EntityStatePDU.EntityOrientation.Roll);
+}
+
+UDISSendManager::UDISSendManager()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	//Evaluate after the entities have moved for the frame
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+
+	//Platforms and life forms
+	ObserverEntityKinds = { 1, 3 };
+}
+
+void UDISSendManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	GeoReferencingSystem = AGeoReferencingSystem::GetGeoReferencingSystem(Cast<UObject>(GetWorld()));
+}
+
+bool UDISSendManager::RegisterSendComponent(UDISSendComponent* SendComponent)
+{
+	if (!UseSendManager || !IsValid(SendComponent))
+	{
+		return false;
+	}
+
+	SendComponents.AddUnique(SendComponent);
+	SendComponent->SetComponentTickEnabled(false);
+
+	return true;
+}
+
+float UDISSendManager::AssignPhaseFraction()
+{
+	if (!SpreadHeartbeats)
+	{
+		return 0;
+	}
+
+	const float phaseFraction = NextPhaseFraction;
+	NextPhaseFraction = FMath::Frac(NextPhaseFraction + 0.618033988749895f);
+
+	return phaseFraction;
+}
+
+void UDISSendManager::UnregisterSendComponent(UDISSendComponent* SendComponent)
+{
+	if (SendComponents.RemoveSwap(SendComponent) > 0 && IsValid(SendComponent) && SendComponent->HasBegunPlay())
+	{
+		//Hand sending back to the component
+		SendComponent->SetComponentTickEnabled(true);
+	}
+}
+
+void UDISSendManager::UpdateRemoteObserver(const FEntityStatePDU& EntityStatePDU)
+{
+	if (EntityStatePDU.EntityAppearance.IsDeactivated || !ObserverEntityKinds.Contains(EntityStatePDU.EntityType.EntityKind))
+	{
+		RemoveRemoteObserver(EntityStatePDU.EntityID);
+		return;
+	}
+
+	if (!ObserverIndices.Contains(EntityStatePDU.EntityID))
+	{
+		ObserverIndices.Add(EntityStatePDU.EntityID, ObserverIDs.Num());
+		ObserverIDs.Add(EntityStatePDU.EntityID);
+		ObserverLocations.X.Add(0);
+		ObserverLocations.Y.Add(0);
+		ObserverLocations.Z.Add(0);
+		ObserverLastUpdateSeconds.Add(0);
+		SET_DWORD_STAT(STAT_RemoteObservers, ObserverIDs.Num());
+	}
+
+	UpdateRemoteObserverLocation(EntityStatePDU.EntityID, EntityStatePDU.EntityLocationDouble);
+}
+
+void UDISSendManager::UpdateRemoteObserverLocation(const FEntityID& EntityID, const TArray<double>& EcefLocation)
+{
+	const int32* observerIndex = ObserverIndices.Find(EntityID);
+	if (observerIndex == nullptr || EcefLocation.Num() < 3)
+	{
+		return;
+	}
+
+	ObserverLocations.X[*observerIndex] = EcefLocation[0];
+	ObserverLocations.Y[*observerIndex] = EcefLocation[1];
+	ObserverLocations.Z[*observerIndex] = EcefLocation[2];
+	ObserverLastUpdateSeconds[*observerIndex] = GetWorld()->GetTimeSeconds();
+}
+
+void UDISSendManager::RemoveRemoteObserver(const FEntityID& EntityID)
+{
+	if (const int32* observerIndex = ObserverIndices.Find(EntityID))
+	{
+		RemoveRemoteObserverAt(*observerIndex);
+	}
+}
+
+void UDISSendManager::RemoveRemoteObserverAt(int32 Index)
+{
+	ObserverIndices.Remove(ObserverIDs[Index]);
+
+	//Keep the arrays packed by moving the last observer into the gap
+	ObserverIDs.RemoveAtSwap(Index, 1, false);
+	ObserverLocations.X.RemoveAtSwap(Index, 1, false);
+	ObserverLocations.Y.RemoveAtSwap(Index, 1, false);
+	ObserverLocations.Z.RemoveAtSwap(Index, 1, false);
+	ObserverLastUpdateSeconds.RemoveAtSwap(Index, 1, false);
+	if (Index < ObserverIDs.Num())
+	{
+		ObserverIndices[ObserverIDs[Index]] = Index;
+	}
+
+	SET_DWORD_STAT(STAT_RemoteObservers, ObserverIDs.Num());
+}
+
+void UDISSendManager::RemoveStaleRemoteObservers()
+{
+	const float staleSeconds = GetWorld()->GetTimeSeconds() - ObserverTimeoutSeconds;
+	for (int32 i = ObserverIDs.Num() - 1; i >= 0; i--)
+	{
+		if (ObserverLastUpdateSeconds[i] < staleSeconds)
+		{
+			RemoveRemoteObserverAt(i);
+		}
+	}
+}
+
+bool UDISSendManager::GetNearestRemoteObserverDistanceMeters(const FEarthCenteredEarthFixedDouble& EcefLocation, double& OutDistanceMeters) const
+{
+	const int32 num = ObserverIDs.Num();
+	if (num == 0)
+	{
+		return false;
+	}
+
+	const double* observersX = ObserverLocations.X.GetData();
+	const double* observersY = ObserverLocations.Y.GetData();
+	const double* observersZ = ObserverLocations.Z.GetData();
+	double nearestDistanceSquared = TNumericLimits<double>::Max();
+	for (int32 i = 0; i < num; i++)
+	{
+		const double x = observersX[i] - EcefLocation.X;
+		const double y = observersY[i] - EcefLocation.Y;
+		const double z = observersZ[i] - EcefLocation.Z;
+		nearestDistanceSquared = FMath::Min(nearestDistanceSquared, x * x + y * y + z * z);
+	}
+
+	OutDistanceMeters = FMath::Sqrt(nearestDistanceSquared);
+	return true;
+}
+
+void UDISSendManager::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	EvaluateSendComponents(DeltaTime);
+}
+
+void UDISSendManager::EvaluateSendComponents(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_EvaluateSendComponents);
+
+	RemoveStaleRemoteObservers();
+
+	SendComponents.RemoveAllSwap([](const TWeakObjectPtr<UDISSendComponent>& SendComponent) { return !SendComponent.IsValid(); });
+	SET_DWORD_STAT(STAT_RegisteredSendComponents, SendComponents.Num());
+
+	//Gather the components that send Entity State PDUs and are due a heartbeat or threshold check
+	PassComponents.Reset();
+	EarlyHeartbeatCandidates.Reset();
+	const bool smoothingHeartbeats = TargetEntityStatePDUsPerFrame > 0;
+	int32 numSkipped = 0;
+	for (const TWeakObjectPtr<UDISSendComponent>& weakSendComponent : SendComponents)
+	{
+		UDISSendComponent* sendComponent = weakSendComponent.Get();
+		sendComponent->DeltaTimeSinceLastPDU += DeltaTime;
+
+		if ((sendComponent->EntityStatePDUSendingMode == EEntityStateSendingMode::EntityStatePDU || sendComponent->EntityStatePDUSendingMode == EEntityStateSendingMode::EntityStateUpdatePDU)
+			&& IsValid(sendComponent->GetOwner()))
+		{
+			if (sendComponent->DeltaTimeSinceLastPDU >= sendComponent->NextThresholdCheckSeconds || sendComponent->IsHeartbeatDue())
+			{
+				PassComponents.Add(sendComponent);
+			}
+			else
+			{
+				numSkipped++;
+
+				if (smoothingHeartbeats && sendComponent->IsHeartbeatDue(HeartbeatLookaheadSeconds))
+				{
+					EarlyHeartbeatCandidates.Add(sendComponent);
+				}
+			}
+		}
+	}
+	INC_DWORD_STAT_BY(STAT_ThresholdChecksSkipped, numSkipped);
+
+	const int32 num = PassComponents.Num();
+	if (num == 0)
+	{
+		INC_DWORD_STAT_BY(STAT_EntityStatePDUsSent, SendEarlyHeartbeats(DeltaTime, 0));
+		return;
+	}
+
+	//Read each actor transform once
+	ThresholdBatch.SetNumUninitialized(num);
+	HeartbeatDue.SetNumUninitialized(num);
+	for (int32 i = 0; i < num; i++)
+	{
+		const UDISSendComponent* sendComponent = PassComponents[i];
+		const AActor* owner = sendComponent->GetOwner();
+
+		ThresholdBatch.UnrealLocations[i] = owner->GetActorLocation();
+		ThresholdBatch.UnrealRotations[i] = owner->GetActorRotation();
+		ThresholdBatch.DeltaTimesSinceLastPDU[i] = sendComponent->DeltaTimeSinceLastPDU;
+		ThresholdBatch.PositionThresholdsMeters[i] = sendComponent->GetScaledPositionThresholdMeters();
+		ThresholdBatch.OrientationThresholdsDegrees[i] = sendComponent->GetScaledOrientationThresholdDegrees();
+		ThresholdBatch.SetSentState(i, sendComponent->MostRecentEntityStatePDU);
+
+		HeartbeatDue[i] = sendComponent->IsHeartbeatDue();
+	}
+
+	if (!IsValid(GeoReferencingSystem))
+	{
+		GeoReferencingSystem = AGeoReferencingSystem::GetGeoReferencingSystem(Cast<UObject>(GetWorld()));
+	}
+
+	//Without a GeoReference only heartbeats are sent
+	const bool thresholdsEvaluated = IsValid(GeoReferencingSystem);
+	if (thresholdsEvaluated)
+	{
+		EvaluateDeadReckoningThresholds(ThresholdBatch, GeoReferencingSystem);
+	}
+
+	//Form and emit only the PDUs that are due
+	int32 numSent = 0;
+	for (int32 i = 0; i < num; i++)
+	{
+		UDISSendComponent* sendComponent = PassComponents[i];
+		bool sendUpdate = HeartbeatDue[i];
+		//Heartbeats only restate the dead reckoned state
+		EUDPSendPriority priority = EUDPSendPriority::Low;
+
+		if (!sendUpdate && thresholdsEvaluated)
+		{
+			if (ThresholdBatch.Batched[i])
+			{
+				sendUpdate = ThresholdBatch.OutsideThreshold[i];
+				priority = sendComponent->GetThresholdSendPriority(ThresholdBatch.PositionErrorsMeters[i], ThresholdBatch.OrientationErrorsRadians[i]);
+
+				//Keep the dead reckoned PDU in step with what CheckDeadReckoningThreshold would have produced
+				FEntityStatePDU& deadReckonedPDU = sendComponent->MostRecentDeadReckonedEntityStatePDU;
+				deadReckonedPDU.EntityLocationDouble[0] = ThresholdBatch.DeadReckonedLocations.X[i];
+				deadReckonedPDU.EntityLocationDouble[1] = ThresholdBatch.DeadReckonedLocations.Y[i];
+				deadReckonedPDU.EntityLocationDouble[2] = ThresholdBatch.DeadReckonedLocations.Z[i];
+				deadReckonedPDU.EntityLocation = FVector(ThresholdBatch.DeadReckonedLocations.X[i], ThresholdBatch.DeadReckonedLocations.Y[i], ThresholdBatch.DeadReckonedLocations.Z[i]);
+				deadReckonedPDU.EntityLinearVelocity = sendComponent->MostRecentEntityStatePDU.EntityLinearVelocity
+					+ sendComponent->MostRecentEntityStatePDU.DeadReckoningParameters.EntityLinearAcceleration * ThresholdBatch.DeltaTimesSinceLastPDU[i];
+
+				const FQuat& deadReckonedOrientation = ThresholdBatch.DeadReckonedOrientations[i];
+				double psiRadians, thetaRadians, phiRadians;
+				DISQuaternion::ToPsiThetaPhiRadians(glm::dquat(deadReckonedOrientation.W, deadReckonedOrientation.X, deadReckonedOrientation.Y, deadReckonedOrientation.Z), psiRadians, thetaRadians, phiRadians);
+				deadReckonedPDU.EntityOrientation = FRotator(thetaRadians, psiRadians, phiRadians);
+			}
+			else
+			{
+				sendUpdate = sendComponent->CheckDeadReckoningThreshold();
+				if (sendUpdate)
+				{
+					double positionErrorMeters, orientationErrorRadians;
+					sendComponent->MeasureDeadReckoningError(positionErrorMeters, orientationErrorRadians);
+					priority = sendComponent->GetThresholdSendPriority(positionErrorMeters, orientationErrorRadians);
+				}
+			}
+
+			if (!sendUpdate)
+			{
+				if (ThresholdBatch.Batched[i])
+				{
+					sendComponent->ScheduleNextThresholdCheck(ThresholdBatch.PositionErrorsMeters[i], ThresholdBatch.OrientationErrorsRadians[i]);
+				}
+				else
+				{
+					sendComponent->ScheduleNextThresholdCheck();
+				}
+			}
+		}
+
+		if (sendUpdate)
+		{
+			sendComponent->EmitEntityStatePDU(priority);
+			numSent++;
+		}
+		else if (smoothingHeartbeats && sendComponent->IsHeartbeatDue(HeartbeatLookaheadSeconds))
+		{
+			EarlyHeartbeatCandidates.Add(sendComponent);
+		}
+	}
+
+	numSent += SendEarlyHeartbeats(DeltaTime, numSent);
+
+	INC_DWORD_STAT_BY(STAT_EntityStatePDUsSent, numSent);
+}
+
+int32 UDISSendManager::SendEarlyHeartbeats(float DeltaTime, int32 NumSentThisFrame)
+{
+	const int32 budget = TargetEntityStatePDUsPerFrame - NumSentThisFrame;
+	if (budget <= 0 || EarlyHeartbeatCandidates.Num() == 0 || DeltaTime <= 0)
+	{
+		return 0;
+	}
+
+	//Drain the heartbeats coming due at an even rate over the lookahead window rather than all in the frames they fall due
+	const int32 framesInWindow = FMath::Max(1, FMath::FloorToInt(HeartbeatLookaheadSeconds / DeltaTime));
+	const int32 numToSend = FMath::Min(budget, FMath::DivideAndRoundUp(EarlyHeartbeatCandidates.Num(), framesInWindow));
+
+	//Closest deadlines first
+	EarlyHeartbeatCandidates.Sort([](const UDISSendComponent& A, const UDISSendComponent& B)
+	{
+		return (A.GetScaledHeartbeatSeconds() - A.HeartbeatPhaseOffsetSeconds - A.DeltaTimeSinceLastPDU) < (B.GetScaledHeartbeatSeconds() - B.HeartbeatPhaseOffsetSeconds - B.DeltaTimeSinceLastPDU);
+	});
+
+	for (int32 i = 0; i < numToSend; i++)
+	{
+		EarlyHeartbeatCandidates[i]->EmitEntityStatePDU(EUDPSendPriority::Low);
+	}
+
+	INC_DWORD_STAT_BY(STAT_EarlyHeartbeatsSent, numToSend);
+
+	return numToSend;
+}
+
+void UDISSendManager::EvaluateDeadReckoningThresholds(FDISSendThresholdBatch& Batch, AGeoReferencingSystem* InGeoReferencingSystem)
+{
+	SCOPE_CYCLE_COUNTER(STAT_EvaluateDeadReckoningThresholds);
+
+	const int32 num = Batch.Num();
+
+	//Actual positions and orientations of every entity
+	UBatchConversions_BPFL::GetEcefXYZFromUnrealLocations(Batch.UnrealLocations, InGeoReferencingSystem, Batch.EcefLocations.X, Batch.EcefLocations.Y, Batch.EcefLocations.Z);
+	UBatchConversions_BPFL::GetPsiThetaPhiRadiansFromUnrealRotations(Batch.UnrealRotations, Batch.UnrealLocations, Batch.EcefLocations.X, Batch.EcefLocations.Y, Batch.EcefLocations.Z,
+		InGeoReferencingSystem, Batch.PsiThetaPhiRadians.X, Batch.PsiThetaPhiRadians.Y, Batch.PsiThetaPhiRadians.Z);
+
+	//Dead reckoned positions, velocity and acceleration are zero for the algorithms that do not use them
+	for (int32 i = 0; i < num; i++)
+	{
+		const double deltaTime = Batch.DeltaTimesSinceLastPDU[i];
+		const double halfDeltaTimeSquared = 0.5 * deltaTime * deltaTime;
+
+		Batch.DeadReckonedLocations.X[i] = Batch.SentLocations.X[i] + Batch.SentLinearVelocities.X[i] * deltaTime + Batch.SentLinearAccelerations.X[i] * halfDeltaTimeSquared;
+		Batch.DeadReckonedLocations.Y[i] = Batch.SentLocations.Y[i] + Batch.SentLinearVelocities.Y[i] * deltaTime + Batch.SentLinearAccelerations.Y[i] * halfDeltaTimeSquared;
+		Batch.DeadReckonedLocations.Z[i] = Batch.SentLocations.Z[i] + Batch.SentLinearVelocities.Z[i] * deltaTime + Batch.SentLinearAccelerations.Z[i] * halfDeltaTimeSquared;
+	}
+
+	for (int32 i = 0; i < num; i++)
+	{
+		if (!Batch.Batched[i])
+		{
+			Batch.OutsideThreshold[i] = false;
+			Batch.PositionErrorsMeters[i] = 0;
+			Batch.OrientationErrorsRadians[i] = 0;
+			continue;
+		}
+
+		const double positionThreshold = Batch.PositionThresholdsMeters[i];
+		const bool positionOutsideThreshold = FMath::Abs(Batch.EcefLocations.X[i] - Batch.DeadReckonedLocations.X[i]) > positionThreshold
+			|| FMath::Abs(Batch.EcefLocations.Y[i] - Batch.DeadReckonedLocations.Y[i]) > positionThreshold
+			|| FMath::Abs(Batch.EcefLocations.Z[i] - Batch.DeadReckonedLocations.Z[i]) > positionThreshold;
+
+		//Same quaternion test as UDISSendComponent::CheckOrientationQuaternionThreshold
+		const glm::dvec3 angularVelocity(Batch.SentAngularVelocities.X[i], Batch.SentAngularVelocities.Y[i], Batch.SentAngularVelocities.Z[i]);
+		Batch.DeadReckonedOrientations[i] = Batch.SentOrientations[i] * UDeadReckoning_BPFL::CreateDeadReckoningQuaternion(angularVelocity, Batch.DeltaTimesSinceLastPDU[i]);
+		const FQuat actualOrientation = UDeadReckoning_BPFL::GetEntityOrientationQuaternion(Batch.PsiThetaPhiRadians.X[i], Batch.PsiThetaPhiRadians.Y[i], Batch.PsiThetaPhiRadians.Z[i]);
+
+		const double orientationThresholdEpsilon = 1 - FMath::Cos(FMath::DegreesToRadians(Batch.OrientationThresholdsDegrees[i] / 2));
+		const bool orientationOutsideThreshold = (1 - (actualOrientation | Batch.DeadReckonedOrientations[i])) > orientationThresholdEpsilon;
+
+		Batch.OutsideThreshold[i] = positionOutsideThreshold || orientationOutsideThreshold;
+
+		const double xError = Batch.EcefLocations.X[i] - Batch.DeadReckonedLocations.X[i];
+		const double yError = Batch.EcefLocations.Y[i] - Batch.DeadReckonedLocations.Y[i];
+		const double zError = Batch.EcefLocations.Z[i] - Batch.DeadReckonedLocations.Z[i];
+		Batch.PositionErrorsMeters[i] = FMath::Sqrt(xError * xError + yError * yError + zError * zError);
+		Batch.OrientationErrorsRadians[i] = actualOrientation.AngularDistance(Batch.DeadReckonedOrientations[i]);
+	}
+}
@@ -0,0 +1,655 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISSoakTestSubsystem.h"
+#include "DISGameManager.h"
+#include "UDPSubsystem.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "Engine/GameInstance.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if PLATFORM_LINUX
+#include <stdio.h>
+#endif
+
+DEFINE_LOG_CATEGORY(LogDISSoak);
+
+#if !UE_BUILD_SHIPPING
+/**
+ * Counts every datagram the receive sockets take in, to compare against what the load generator sent.
+ */
+class FDISSoakReceiveCounter : public IUDPReceiveTap
+{
+public:
+	virtual void OnDatagramReceived(TArrayView<const uint8> Bytes, const FIPv4Endpoint& Sender, const FIPv4Endpoint& Receiver, int32 ReceiveSocketID) override
+	{
+		Datagrams.Increment();
+	}
+
+	int64 GetDatagrams() const { return Datagrams.GetValue(); }
+
+private:
+	FThreadSafeCounter64 Datagrams;
+};
+
+namespace DISSoakTest
+{
+	/**
+	 * Least squares slope of a sampled series against elapsed time, over the samples from First on.
+	 */
+	double FitSlope(const TArray<FDISSoakSample>& Samples, int32 First, TFunctionRef<double(const FDISSoakSample&)> Value)
+	{
+		const int32 numSamples = Samples.Num() - First;
+		if (numSamples < 2)
+		{
+			return 0;
+		}
+
+		double meanTime = 0;
+		double meanValue = 0;
+		for (int32 i = First; i < Samples.Num(); i++)
+		{
+			meanTime += Samples[i].ElapsedSeconds;
+			meanValue += Value(Samples[i]);
+		}
+		meanTime /= numSamples;
+		meanValue /= numSamples;
+
+		double covariance = 0;
+		double variance = 0;
+		for (int32 i = First; i < Samples.Num(); i++)
+		{
+			const double time = Samples[i].ElapsedSeconds - meanTime;
+			covariance += time * (Value(Samples[i]) - meanValue);
+			variance += time * time;
+		}
+		return variance > 0 ? covariance / variance : 0;
+	}
+
+	void AddFailure(FDISSoakResult& Result, const FString& Reason)
+	{
+		Result.FailureReason += Result.FailureReason.IsEmpty() ? Reason : TEXT("; ") + Reason;
+		Result.Passed = false;
+	}
+}
+
+bool UDISSoakTestSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return Super::ShouldCreateSubsystem(Outer);
+}
+
+void UDISSoakTestSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	//The UDP Subsystem has to outlive the receive counter tapping it
+	Collection.InitializeDependency(UUDPSubsystem::StaticClass());
+
+	Super::Initialize(Collection);
+}
+
+void UDISSoakTestSubsystem::Deinitialize()
+{
+	//Shutting down mid run is not a finished run, so nothing is evaluated
+	if (Generator.IsValid())
+	{
+		Generator->StopAndWait();
+		Generator.Reset();
+	}
+
+	UUDPSubsystem* udpSubsystem = GetGameInstance()->GetSubsystem<UUDPSubsystem>();
+	if (ReceiveCounter.IsValid() && IsValid(udpSubsystem))
+	{
+		udpSubsystem->RemoveReceiveTap(ReceiveCounter.ToSharedRef());
+	}
+	ReceiveCounter.Reset();
+
+	Super::Deinitialize();
+}
+
+ETickableTickType UDISSoakTestSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UDISSoakTestSubsystem::IsSoaking() const
+{
+	return Generator.IsValid();
+}
+
+bool UDISSoakTestSubsystem::StartSoak(FDISSoakSettings InSettings)
+{
+	if (Generator.IsValid())
+	{
+		StopSoak();
+	}
+
+	UUDPSubsystem* udpSubsystem = GetGameInstance()->GetSubsystem<UUDPSubsystem>();
+	if (!IsValid(udpSubsystem))
+	{
+		return false;
+	}
+
+	Settings = InSettings;
+	Settings.SampleIntervalSeconds = FMath::Max(Settings.SampleIntervalSeconds, 0.1f);
+	Settings.SweepEntityCounts.RemoveAll([](int32 Count) { return Count <= 0; });
+	Settings.SweepEntityCounts.Sort();
+	Samples.Reset();
+	Result = FDISSoakResult();
+	GameManager.Reset();
+
+	const FString directory = Settings.Directory.IsEmpty() ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("DISSoak")) : Settings.Directory;
+	FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*directory);
+	SamplesFile = FPaths::Combine(directory, FString::Printf(TEXT("%s-%s.csv"), Settings.SweepEntityCounts.Num() > 0 ? TEXT("Sweep") : TEXT("Soak"), *FDateTime::Now().ToString()));
+	FFileHelper::SaveStringToFile(TEXT("ElapsedSeconds,GeneratedEntities,FrameMilliseconds,MaxFrameMilliseconds,ResidentMegabytes,ActorCount,EntityMapSize,PendingGameThreadDatagrams,DatagramsSent,DatagramsReceived,DatagramsDropped,ReceiveBufferErrors\n"), *SamplesFile);
+
+	ReceiveCounter = MakeShared<FDISSoakReceiveCounter, ESPMode::ThreadSafe>();
+	udpSubsystem->AddReceiveTap(ReceiveCounter.ToSharedRef());
+
+	StartSeconds = FPlatformTime::Seconds();
+	LastTickSeconds = 0;
+	NextSampleSeconds = StartSeconds + Settings.SampleIntervalSeconds;
+	StartReceiveBufferErrors = ReadReceiveBufferErrors();
+	IntervalFrameSeconds = 0;
+	IntervalMaxFrameSeconds = 0;
+	IntervalFrames = 0;
+	FinishedStepsDatagramsSent = 0;
+	StepIndex = Settings.SweepEntityCounts.Num() > 0 ? 0 : INDEX_NONE;
+
+	if (!StartGenerator(StepIndex))
+	{
+		udpSubsystem->RemoveReceiveTap(ReceiveCounter.ToSharedRef());
+		ReceiveCounter.Reset();
+		return false;
+	}
+
+	UE_LOG(LogDISSoak, Display, TEXT("Started %s, writing samples to %s."), StepIndex == INDEX_NONE ? *FString::Printf(TEXT("%.0f s soak"), Settings.DurationSeconds)
+		: *FString::Printf(TEXT("sweep over %d entity counts"), Settings.SweepEntityCounts.Num()), *SamplesFile);
+	return true;
+}
+
+bool UDISSoakTestSubsystem::StartGenerator(int32 InStepIndex)
+{
+	FDISLoadGeneratorSettings traffic = Settings.Traffic;
+	traffic.DurationSeconds = 0;
+	if (InStepIndex != INDEX_NONE)
+	{
+		//Entity updates only get the share of the packet rate the other PDUs leave over
+		const float otherShare = FMath::Min(traffic.FireShare + traffic.DetonationShare + traffic.EmissionsShare, 0.9f);
+		traffic.NumEntities = Settings.SweepEntityCounts[InStepIndex];
+		traffic.TargetPacketsPerSecond = traffic.NumEntities * Settings.SweepUpdatesPerEntityPerSecond / (1.f - otherShare);
+		//Every step gets its own application ID, so entities of the last step that have not been removed yet are not updated by this one
+		traffic.ApplicationID = (Settings.Traffic.ApplicationID + InStepIndex) % 65536;
+
+		StepStartSeconds = FPlatformTime::Seconds();
+		StepFirstSample = Samples.Num();
+	}
+
+	Generator = MakeUnique<FDISLoadGenerator>(traffic);
+	if (!Generator->Start())
+	{
+		Generator.Reset();
+		return false;
+	}
+	return true;
+}
+
+void UDISSoakTestSubsystem::StopSoak()
+{
+	if (Generator.IsValid())
+	{
+		Finish();
+	}
+}
+
+void UDISSoakTestSubsystem::Tick(float DeltaTime)
+{
+	const double now = FPlatformTime::Seconds();
+	if (LastTickSeconds > 0)
+	{
+		const double frameSeconds = FMath::Max(now - LastTickSeconds - FApp::GetIdleTime(), 0.);
+		IntervalFrameSeconds += frameSeconds;
+		IntervalMaxFrameSeconds = FMath::Max(IntervalMaxFrameSeconds, frameSeconds);
+		IntervalFrames++;
+	}
+	LastTickSeconds = now;
+
+	if (now >= NextSampleSeconds)
+	{
+		TakeSample();
+		//A hitch longer than the interval is folded into one sample rather than followed by a burst of empty ones
+		NextSampleSeconds = FMath::Max(NextSampleSeconds + Settings.SampleIntervalSeconds, now);
+	}
+
+	if (StepIndex != INDEX_NONE)
+	{
+		if (now - StepStartSeconds >= Settings.SweepStepSeconds)
+		{
+			FinishStep();
+		}
+	}
+	else if (now - StartSeconds >= Settings.DurationSeconds)
+	{
+		Finish();
+	}
+}
+
+void UDISSoakTestSubsystem::TakeSample()
+{
+	const FDISLoadGeneratorStats generatorStats = Generator->GetStats();
+
+	FDISSoakSample sample;
+	sample.ElapsedSeconds = static_cast<float>(FPlatformTime::Seconds() - StartSeconds);
+	sample.GeneratedEntities = Generator->GetSettings().NumEntities;
+	sample.FrameMilliseconds = IntervalFrames > 0 ? static_cast<float>(IntervalFrameSeconds / IntervalFrames * 1000.) : 0;
+	sample.MaxFrameMilliseconds = static_cast<float>(IntervalMaxFrameSeconds * 1000.);
+	sample.ResidentMegabytes = static_cast<float>(FPlatformMemory::GetStats().UsedPhysical / (1024. * 1024.));
+
+	UWorld* world = GetGameInstance()->GetWorld();
+	if (IsValid(world))
+	{
+		sample.ActorCount = world->GetActorCount();
+
+		//Found without Get DIS Game Manager, which logs an error every sample for worlds without one
+		if (!GameManager.IsValid())
+		{
+			TActorIterator<ADISGameManager> gameManagerIterator(world);
+			GameManager = gameManagerIterator ? *gameManagerIterator : nullptr;
+		}
+	}
+	sample.EntityMapSize = GameManager.IsValid() ? GameManager->GetNumDISEntities() : 0;
+
+	UUDPSubsystem* udpSubsystem = GetGameInstance()->GetSubsystem<UUDPSubsystem>();
+	sample.PendingGameThreadDatagrams = IsValid(udpSubsystem) ? udpSubsystem->GetNumPendingGameThreadDatagrams() : 0;
+	sample.DatagramsSent = FinishedStepsDatagramsSent + generatorStats.PacketsSent;
+	sample.DatagramsReceived = ReceiveCounter->GetDatagrams();
+	sample.DatagramsDropped = FMath::Max<int64>(sample.DatagramsSent - sample.DatagramsReceived, 0);
+
+	const int64 receiveBufferErrors = ReadReceiveBufferErrors();
+	sample.ReceiveBufferErrors = receiveBufferErrors >= 0 && StartReceiveBufferErrors >= 0 ? receiveBufferErrors - StartReceiveBufferErrors : -1;
+
+	Samples.Add(sample);
+	WriteSample(sample);
+
+	IntervalFrameSeconds = 0;
+	IntervalMaxFrameSeconds = 0;
+	IntervalFrames = 0;
+
+	UE_LOG(LogDISSoak, Log, TEXT("%.0f s: %d entities generated, %.2f ms frames (%.2f max), %.1f MB, %d actors, %d mapped entities, %d pending, %lld sent, %lld dropped."),
+		sample.ElapsedSeconds, sample.GeneratedEntities, sample.FrameMilliseconds, sample.MaxFrameMilliseconds, sample.ResidentMegabytes,
+		sample.ActorCount, sample.EntityMapSize, sample.PendingGameThreadDatagrams, sample.DatagramsSent, sample.DatagramsDropped);
+}
+
+void UDISSoakTestSubsystem::WriteSample(const FDISSoakSample& Sample) const
+{
+	const FString line = FString::Printf(TEXT("%.3f,%d,%.3f,%.3f,%.2f,%d,%d,%d,%lld,%lld,%lld,%lld\n"),
+		Sample.ElapsedSeconds, Sample.GeneratedEntities, Sample.FrameMilliseconds, Sample.MaxFrameMilliseconds, Sample.ResidentMegabytes,
+		Sample.ActorCount, Sample.EntityMapSize, Sample.PendingGameThreadDatagrams, Sample.DatagramsSent, Sample.DatagramsReceived, Sample.DatagramsDropped, Sample.ReceiveBufferErrors);
+	FFileHelper::SaveStringToFile(line, *SamplesFile, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
+
+void UDISSoakTestSubsystem::FinishStep()
+{
+	FDISSweepStep step;
+	step.Entities = Settings.SweepEntityCounts[StepIndex];
+	step.PacketsPerSecond = Generator->GetStats().AchievedPacketsPerSecond;
+
+	//Only the last three quarters of the step are measured, once the entities have spawned
+	const float measureFromSeconds = static_cast<float>(StepStartSeconds - StartSeconds + Settings.SweepStepSeconds * 0.25f);
+	int32 firstMeasured = Samples.Num();
+	for (int32 i = StepFirstSample; i < Samples.Num(); i++)
+	{
+		if (Samples[i].ElapsedSeconds >= measureFromSeconds)
+		{
+			firstMeasured = i;
+			break;
+		}
+	}
+
+	const int32 numMeasured = Samples.Num() - firstMeasured;
+	if (numMeasured > 0)
+	{
+		for (int32 i = firstMeasured; i < Samples.Num(); i++)
+		{
+			step.FrameMilliseconds += Samples[i].FrameMilliseconds / numMeasured;
+			step.MaxFrameMilliseconds = FMath::Max(step.MaxFrameMilliseconds, Samples[i].MaxFrameMilliseconds);
+			step.ResidentMegabytes = FMath::Max(step.ResidentMegabytes, Samples[i].ResidentMegabytes);
+		}
+
+		const FDISSoakSample& first = Samples[firstMeasured];
+		const FDISSoakSample& last = Samples.Last();
+		const int64 sent = last.DatagramsSent - first.DatagramsSent;
+		step.DroppedShare = sent > 0 ? FMath::Max(static_cast<float>(last.DatagramsDropped - first.DatagramsDropped) / sent, 0.f) : 0;
+	}
+	else
+	{
+		UE_LOG(LogDISSoak, Warning, TEXT("No samples measured at %d entities, the sample interval is too long for the step time."), step.Entities);
+	}
+
+	Result.SweepSteps.Add(step);
+	UE_LOG(LogDISSoak, Display, TEXT("%d entities at %.0f packets/s: %.2f ms frames (%.2f max), %.1f MB, %.3f%% dropped."),
+		step.Entities, step.PacketsPerSecond, step.FrameMilliseconds, step.MaxFrameMilliseconds, step.ResidentMegabytes, step.DroppedShare * 100.f);
+
+	//Stopping deactivates the step's entities, so they are counted as sent before the next step starts
+	Generator->StopAndWait();
+	FinishedStepsDatagramsSent += Generator->GetStats().PacketsSent;
+
+	StepIndex++;
+	if (StepIndex >= Settings.SweepEntityCounts.Num() || !StartGenerator(StepIndex))
+	{
+		Finish();
+	}
+}
+
+void UDISSoakTestSubsystem::Finish()
+{
+	if (Generator.IsValid())
+	{
+		if (Generator->IsRunning() && IntervalFrames > 0)
+		{
+			TakeSample();
+		}
+		Generator->StopAndWait();
+		Generator.Reset();
+	}
+
+	UUDPSubsystem* udpSubsystem = GetGameInstance()->GetSubsystem<UUDPSubsystem>();
+	if (ReceiveCounter.IsValid() && IsValid(udpSubsystem))
+	{
+		udpSubsystem->RemoveReceiveTap(ReceiveCounter.ToSharedRef());
+	}
+	ReceiveCounter.Reset();
+
+	Result.Passed = true;
+	Result.SamplesFile = SamplesFile;
+	if (Settings.SweepEntityCounts.Num() > 0)
+	{
+		EvaluateSweep();
+	}
+	else
+	{
+		EvaluateSoak();
+	}
+
+	if (Result.Passed)
+	{
+		UE_LOG(LogDISSoak, Display, TEXT("Passed. Samples written to %s."), *SamplesFile);
+	}
+	else
+	{
+		UE_LOG(LogDISSoak, Error, TEXT("Failed: %s. Samples written to %s."), *Result.FailureReason, *SamplesFile);
+	}
+
+	OnSoakFinished.Broadcast(Result);
+
+	if (Settings.ExitWhenFinished)
+	{
+		FPlatformMisc::RequestExitWithStatus(false, Result.Passed ? 0 : 1);
+	}
+}
+
+void UDISSoakTestSubsystem::EvaluateSoak()
+{
+	if (Samples.Num() == 0)
+	{
+		DISSoakTest::AddFailure(Result, TEXT("no samples were taken"));
+		return;
+	}
+
+	int32 firstAfterWarmup = Samples.Num();
+	for (int32 i = 0; i < Samples.Num(); i++)
+	{
+		if (Samples[i].ElapsedSeconds >= Settings.WarmupSeconds)
+		{
+			firstAfterWarmup = i;
+			break;
+		}
+	}
+
+	const FDISSoakSample& last = Samples.Last();
+	Result.DroppedShare = last.DatagramsSent > 0 ? static_cast<float>(last.DatagramsDropped) / last.DatagramsSent : 0;
+	if (Result.DroppedShare > Settings.MaxDroppedShare)
+	{
+		DISSoakTest::AddFailure(Result, FString::Printf(TEXT("%.3f%% of datagrams dropped, more than %.3f%%"), Result.DroppedShare * 100.f, Settings.MaxDroppedShare * 100.f));
+	}
+
+	if (Samples.Num() - firstAfterWarmup < 3)
+	{
+		UE_LOG(LogDISSoak, Warning, TEXT("Only %d samples after warmup, drift not checked."), Samples.Num() - firstAfterWarmup);
+		return;
+	}
+
+	//Growth is taken from the fitted trend so that a single spike at either end of the soak does not decide it
+	const double trendSeconds = last.ElapsedSeconds - Samples[firstAfterWarmup].ElapsedSeconds;
+	Result.MemoryGrowthMegabytes = static_cast<float>(DISSoakTest::FitSlope(Samples, firstAfterWarmup, [](const FDISSoakSample& Sample) { return Sample.ResidentMegabytes; }) * trendSeconds);
+	Result.FrameTimeGrowthMilliseconds = static_cast<float>(DISSoakTest::FitSlope(Samples, firstAfterWarmup, [](const FDISSoakSample& Sample) { return Sample.FrameMilliseconds; }) * trendSeconds);
+
+	UE_LOG(LogDISSoak, Display, TEXT("After warmup memory grew %.1f MB and frame time %.3f ms over %.0f s. %.3f%% of datagrams dropped."),
+		Result.MemoryGrowthMegabytes, Result.FrameTimeGrowthMilliseconds, trendSeconds, Result.DroppedShare * 100.f);
+
+	if (Settings.MaxMemoryGrowthMegabytes > 0 && Result.MemoryGrowthMegabytes > Settings.MaxMemoryGrowthMegabytes)
+	{
+		DISSoakTest::AddFailure(Result, FString::Printf(TEXT("memory grew %.1f MB, more than %.1f MB"), Result.MemoryGrowthMegabytes, Settings.MaxMemoryGrowthMegabytes));
+	}
+	if (Settings.MaxFrameTimeGrowthMilliseconds > 0 && Result.FrameTimeGrowthMilliseconds > Settings.MaxFrameTimeGrowthMilliseconds)
+	{
+		DISSoakTest::AddFailure(Result, FString::Printf(TEXT("frame time grew %.3f ms, more than %.3f ms"), Result.FrameTimeGrowthMilliseconds, Settings.MaxFrameTimeGrowthMilliseconds));
+	}
+}
+
+void UDISSoakTestSubsystem::EvaluateSweep()
+{
+	TArray<FDISSweepStep>& steps = Result.SweepSteps;
+	if (steps.Num() == 0)
+	{
+		DISSoakTest::AddFailure(Result, TEXT("no sweep steps finished"));
+		return;
+	}
+
+	//Cost of the first entities added, which later steps are measured against. Noise can make it look free, in which case the mean cost per entity stands in
+	float baselineMicroseconds = 0;
+	for (int32 i = 1; i < steps.Num(); i++)
+	{
+		const int32 addedEntities = steps[i].Entities - steps[i - 1].Entities;
+		steps[i].MarginalMicrosecondsPerEntity = addedEntities > 0 ? (steps[i].FrameMilliseconds - steps[i - 1].FrameMilliseconds) * 1000.f / addedEntities : 0;
+	}
+	if (steps.Num() > 1)
+	{
+		baselineMicroseconds = steps[1].MarginalMicrosecondsPerEntity > 0 ? steps[1].MarginalMicrosecondsPerEntity : steps[1].FrameMilliseconds * 1000.f / FMath::Max(steps[1].Entities, 1);
+	}
+
+	Result.KneeEntities = steps.Last().Entities;
+	FString kneeReason;
+	for (int32 i = 0; i < steps.Num() && kneeReason.IsEmpty(); i++)
+	{
+		const FDISSweepStep& step = steps[i];
+		if (step.FrameMilliseconds > Settings.FrameBudgetMilliseconds)
+		{
+			kneeReason = FString::Printf(TEXT("%.2f ms frames at %d entities, over the %.2f ms budget"), step.FrameMilliseconds, step.Entities, Settings.FrameBudgetMilliseconds);
+		}
+		else if (step.DroppedShare > Settings.MaxDroppedShare)
+		{
+			kneeReason = FString::Printf(TEXT("%.3f%% of datagrams dropped at %d entities"), step.DroppedShare * 100.f, step.Entities);
+		}
+		else if (i >= 2 && step.MarginalMicrosecondsPerEntity > Settings.KneeFactor * baselineMicroseconds)
+		{
+			kneeReason = FString::Printf(TEXT("%.2f us per added entity at %d entities, %.1fx the %.2f us of the first added"),
+				step.MarginalMicrosecondsPerEntity, step.Entities, step.MarginalMicrosecondsPerEntity / baselineMicroseconds, baselineMicroseconds);
+		}
+
+		if (!kneeReason.IsEmpty())
+		{
+			Result.KneeEntities = i > 0 ? steps[i - 1].Entities : 0;
+		}
+	}
+
+	for (const FDISSweepStep& step : steps)
+	{
+		UE_LOG(LogDISSoak, Display, TEXT("%8d entities %10.0f packets/s %8.2f ms %8.2f ms max %8.1f MB %8.3f%% dropped %8.2f us/entity"),
+			step.Entities, step.PacketsPerSecond, step.FrameMilliseconds, step.MaxFrameMilliseconds, step.ResidentMegabytes, step.DroppedShare * 100.f, step.MarginalMicrosecondsPerEntity);
+	}
+
+	if (kneeReason.IsEmpty())
+	{
+		UE_LOG(LogDISSoak, Display, TEXT("No knee found up to %d entities."), Result.KneeEntities);
+	}
+	else
+	{
+		UE_LOG(LogDISSoak, Display, TEXT("Knee after %d entities: %s."), Result.KneeEntities, *kneeReason);
+	}
+
+	if (Result.KneeEntities == 0)
+	{
+		DISSoakTest::AddFailure(Result, FString::Printf(TEXT("already past the knee at the first step, %s"), *kneeReason));
+	}
+}
+
+int64 UDISSoakTestSubsystem::ReadReceiveBufferErrors()
+{
+#if PLATFORM_LINUX
+	//proc files report a size of zero, so they are read a line at a time rather than through the file manager
+	FILE* file = fopen("/proc/net/snmp", "r");
+	if (file == nullptr)
+	{
+		return -1;
+	}
+
+	//The Udp section is a line of field names followed by a line of values
+	TArray<FString> names;
+	TArray<FString> values;
+	char line[1024];
+	while (fgets(line, sizeof(line), file) != nullptr)
+	{
+		if (FCStringAnsi::Strncmp(line, "Udp:", 4) == 0)
+		{
+			FString(ANSI_TO_TCHAR(line)).ParseIntoArrayWS(names.Num() == 0 ? names : values);
+			if (values.Num() > 0)
+			{
+				break;
+			}
+		}
+	}
+	fclose(file);
+
+	const int32 index = names.IndexOfByKey(TEXT("RcvbufErrors"));
+	return index != INDEX_NONE && values.IsValidIndex(index) ? FCString::Atoi64(*values[index]) : -1;
+#else
+	return -1;
+#endif
+}
+
+static void RunSoakCommandFromConsole(const TArray<FString>& Args, UWorld* World)
+{
+	UGameInstance* gameInstance = World ? World->GetGameInstance() : nullptr;
+	UDISSoakTestSubsystem* soakSubsystem = gameInstance ? gameInstance->GetSubsystem<UDISSoakTestSubsystem>() : nullptr;
+	if (soakSubsystem == nullptr || Args.Num() == 0)
+	{
+		UE_LOG(LogDISSoak, Warning, TEXT("Usage: DIS.Soak Start [Duration=3600] [Sample=10] [Warmup=120] [MaxMemoryGrowth=256] [MaxFrameGrowth=2] [MaxDropped=0.001] [Sweep=500+1000+2000] [Step=60] [UpdatesPerEntity=5] [Budget=16.6] [Knee=3] [Dir=...] [Exit] [DIS.LoadGen settings] | Stop | Stats"));
+		return;
+	}
+
+	const FString& command = Args[0];
+	if (command.Equals(TEXT("Start"), ESearchCase::IgnoreCase))
+	{
+		FDISSoakSettings settings;
+		FString params;
+		for (int32 i = 1; i < Args.Num(); i++)
+		{
+			params += Args[i] + TEXT(" ");
+			settings.ExitWhenFinished |= Args[i].Equals(TEXT("Exit"), ESearchCase::IgnoreCase);
+		}
+		FDISLoadGenerator::ParseSettings(*params, settings.Traffic);
+
+		FParse::Value(*params, TEXT("Duration="), settings.DurationSeconds);
+		FParse::Value(*params, TEXT("Sample="), settings.SampleIntervalSeconds);
+		FParse::Value(*params, TEXT("Warmup="), settings.WarmupSeconds);
+		FParse::Value(*params, TEXT("MaxMemoryGrowth="), settings.MaxMemoryGrowthMegabytes);
+		FParse::Value(*params, TEXT("MaxFrameGrowth="), settings.MaxFrameTimeGrowthMilliseconds);
+		FParse::Value(*params, TEXT("MaxDropped="), settings.MaxDroppedShare);
+		FParse::Value(*params, TEXT("Step="), settings.SweepStepSeconds);
+		FParse::Value(*params, TEXT("UpdatesPerEntity="), settings.SweepUpdatesPerEntityPerSecond);
+		FParse::Value(*params, TEXT("Budget="), settings.FrameBudgetMilliseconds);
+		FParse::Value(*params, TEXT("Knee="), settings.KneeFactor);
+		FParse::Value(*params, TEXT("Dir="), settings.Directory);
+
+		//-ExecCmds splits commands on commas, so entity counts can be separated by plus signs as well
+		FString sweepString;
+		if (FParse::Value(*params, TEXT("Sweep="), sweepString, false))
+		{
+			TArray<FString> countStrings;
+			const TCHAR* delimiters[] = { TEXT(","), TEXT("+") };
+			sweepString.ParseIntoArray(countStrings, delimiters, 2);
+			for (const FString& countString : countStrings)
+			{
+				settings.SweepEntityCounts.Add(FCString::Atoi(*countString));
+			}
+		}
+
+		soakSubsystem->StartSoak(settings);
+	}
+	else if (command.Equals(TEXT("Stop"), ESearchCase::IgnoreCase))
+	{
+		soakSubsystem->StopSoak();
+	}
+	else if (command.Equals(TEXT("Stats"), ESearchCase::IgnoreCase))
+	{
+		const TArray<FDISSoakSample> samples = soakSubsystem->GetSamples();
+		if (samples.Num() > 0)
+		{
+			const FDISSoakSample& sample = samples.Last();
+			UE_LOG(LogDISSoak, Display, TEXT("%s at %.0f s: %d entities generated, %.2f ms frames, %.1f MB, %d actors, %d mapped entities, %d pending, %lld of %lld datagrams dropped."),
+				soakSubsystem->IsSoaking() ? TEXT("Running") : TEXT("Finished"), sample.ElapsedSeconds, sample.GeneratedEntities, sample.FrameMilliseconds, sample.ResidentMegabytes,
+				sample.ActorCount, sample.EntityMapSize, sample.PendingGameThreadDatagrams, sample.DatagramsDropped, sample.DatagramsSent);
+		}
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs DISSoakCommand(
+	TEXT("DIS.Soak"),
+	TEXT("Soaks the plugin with generated DIS traffic on loopback and checks for drift, or sweeps entity counts to find the scaling knee. Usage: DIS.Soak Start [Duration=3600] [Sample=10] [Warmup=120] [MaxMemoryGrowth=256] [MaxFrameGrowth=2] [MaxDropped=0.001] [Sweep=500+1000+2000] [Step=60] [UpdatesPerEntity=5] [Budget=16.6] [Knee=3] [Dir=...] [Exit] [DIS.LoadGen settings] | Stop | Stats"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&RunSoakCommandFromConsole));
+
+#else
+
+bool UDISSoakTestSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return false;
+}
+
+void UDISSoakTestSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+}
+
+void UDISSoakTestSubsystem::Deinitialize()
+{
+	Super::Deinitialize();
+}
+
+ETickableTickType UDISSoakTestSubsystem::GetTickableTickType() const
+{
+	return ETickableTickType::Never;
+}
+
+void UDISSoakTestSubsystem::Tick(float DeltaTime)
+{
+}
+
+bool UDISSoakTestSubsystem::StartSoak(FDISSoakSettings InSettings)
+{
+	UE_LOG(LogDISSoak, Error, TEXT("Soak tests are not available in shipping builds."));
+	return false;
+}
+
+void UDISSoakTestSubsystem::StopSoak()
+{
+}
+
+bool UDISSoakTestSubsystem::IsSoaking() const
+{
+	return false;
+}
+
+#endif
@@ -0,0 +1,173 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "DISTerrainElevationGrid.h"
+
+DEFINE_LOG_CATEGORY(LogDISTerrainElevationGrid);
+
+static_assert(sizeof(FDISTerrainElevationSample) == 8, "Baked elevation samples are stored as raw bulk data and must stay tightly packed.");
+
+void UDISTerrainElevationGrid::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	//Bulk data can not be saved, cooked, or replaced while GetSamples holds its read lock. It is locked again on the next GetSamples.
+	ReleaseSamples();
+
+	Ar << TileFlags;
+	Ar << TileSampleOffsets;
+	SampleBulkData.Serialize(Ar, this);
+}
+
+void UDISTerrainElevationGrid::BeginDestroy()
+{
+	ReleaseSamples();
+
+	Super::BeginDestroy();
+}
+
+void UDISTerrainElevationGrid::SetBakedData(FVector2D InGridOrigin, float InGridSpacing, int32 InTileResolution, int32 InNumTilesX, int32 InNumTilesY,
+	TArray<EDISTerrainTileFlags> const& InTileFlags, TArray<FDISTerrainElevationSample> const& InSamples)
+{
+	ReleaseSamples();
+
+	GridOrigin = InGridOrigin;
+	GridSpacing = InGridSpacing;
+	TileResolution = InTileResolution;
+	NumTilesX = InNumTilesX;
+	NumTilesY = InNumTilesY;
+	NumDynamicTiles = 0;
+
+	const int32 samplesPerTile = GetSamplesPerTile();
+	int32 nextSampleOffset = 0;
+
+	TileFlags.SetNumUninitialized(InTileFlags.Num());
+	TileSampleOffsets.SetNumUninitialized(InTileFlags.Num());
+	for (int32 tileIndex = 0; tileIndex < InTileFlags.Num(); tileIndex++)
+	{
+		TileFlags[tileIndex] = static_cast<uint8>(InTileFlags[tileIndex]);
+
+		if (EnumHasAnyFlags(InTileFlags[tileIndex], EDISTerrainTileFlags::HasDynamicGeometry))
+		{
+			NumDynamicTiles++;
+		}
+
+		if (EnumHasAnyFlags(InTileFlags[tileIndex], EDISTerrainTileFlags::HasSamples))
+		{
+			TileSampleOffsets[tileIndex] = nextSampleOffset;
+			nextSampleOffset += samplesPerTile;
+		}
+		else
+		{
+			TileSampleOffsets[tileIndex] = INDEX_NONE;
+		}
+	}
+
+	if (nextSampleOffset != InSamples.Num())
+	{
+		UE_LOG(LogDISTerrainElevationGrid, Error, TEXT("%s was given %d samples but its tiles require %d. Discarding baked data."), *GetName(), InSamples.Num(), nextSampleOffset);
+		TileFlags.Reset();
+		TileSampleOffsets.Reset();
+		NumTilesX = 0;
+		NumTilesY = 0;
+		return;
+	}
+
+	const int64 payloadSize = static_cast<int64>(InSamples.Num()) * sizeof(FDISTerrainElevationSample);
+	SampleBulkData.Lock(LOCK_READ_WRITE);
+	void* payload = SampleBulkData.Realloc(payloadSize);
+	FMemory::Memcpy(payload, InSamples.GetData(), payloadSize);
+	SampleBulkData.Unlock();
+
+	//Keep the payload out of the export so it can be memory mapped in cooked builds
+	SampleBulkData.SetBulkDataFlags(BULKDATA_Force_NOT_InlinePayload | BULKDATA_MemoryMappedPayload);
+}
+
+bool UDISTerrainElevationGrid::SampleElevation(FVector const& EngineLocation, float& OutHeight, FVector& OutNormal) const
+{
+	if (TileResolution <= 0 || GridSpacing <= 0.f)
+	{
+		return false;
+	}
+
+	const float gridX = (EngineLocation.X - GridOrigin.X) / GridSpacing;
+	const float gridY = (EngineLocation.Y - GridOrigin.Y) / GridSpacing;
+	const int32 numCellsX = NumTilesX * TileResolution;
+	const int32 numCellsY = NumTilesY * TileResolution;
+
+	if (gridX < 0.f || gridY < 0.f || gridX > numCellsX || gridY > numCellsY)
+	{
+		return false;
+	}
+
+	//Clamp so that locations on the far edge use the last cell
+	const int32 cellX = FMath::Min(FMath::FloorToInt(gridX), numCellsX - 1);
+	const int32 cellY = FMath::Min(FMath::FloorToInt(gridY), numCellsY - 1);
+	const int32 tileX = cellX / TileResolution;
+	const int32 tileY = cellY / TileResolution;
+	const int32 tileIndex = tileY * NumTilesX + tileX;
+
+	if (!TileFlags.IsValidIndex(tileIndex))
+	{
+		return false;
+	}
+
+	const EDISTerrainTileFlags tileFlags = static_cast<EDISTerrainTileFlags>(TileFlags[tileIndex]);
+	if (!EnumHasAnyFlags(tileFlags, EDISTerrainTileFlags::HasSamples) || EnumHasAnyFlags(tileFlags, EDISTerrainTileFlags::HasDynamicGeometry))
+	{
+		return false;
+	}
+
+	const FDISTerrainElevationSample* samples = GetSamples();
+	if (samples == nullptr)
+	{
+		return false;
+	}
+
+	const int32 stride = TileResolution + 1;
+	const int32 localX = cellX - tileX * TileResolution;
+	const int32 localY = cellY - tileY * TileResolution;
+	const FDISTerrainElevationSample* tileSamples = samples + TileSampleOffsets[tileIndex];
+
+	const FDISTerrainElevationSample& s00 = tileSamples[localY * stride + localX];
+	const FDISTerrainElevationSample& s10 = tileSamples[localY * stride + localX + 1];
+	const FDISTerrainElevationSample& s01 = tileSamples[(localY + 1) * stride + localX];
+	const FDISTerrainElevationSample& s11 = tileSamples[(localY + 1) * stride + localX + 1];
+
+	if (!(s00.IsValid && s10.IsValid && s01.IsValid && s11.IsValid))
+	{
+		return false;
+	}
+
+	const float alphaX = gridX - cellX;
+	const float alphaY = gridY - cellY;
+
+	OutHeight = FMath::BiLerp(s00.Height, s10.Height, s01.Height, s11.Height, alphaX, alphaY);
+
+	auto unpackNormal = [](const FDISTerrainElevationSample& Sample)
+	{
+		return FVector(Sample.NormalX, Sample.NormalY, Sample.NormalZ);
+	};
+	OutNormal = FMath::BiLerp(unpackNormal(s00), unpackNormal(s10), unpackNormal(s01), unpackNormal(s11), alphaX, alphaY).GetSafeNormal(SMALL_NUMBER, FVector::UpVector);
+
+	return true;
+}
+
+const FDISTerrainElevationSample* UDISTerrainElevationGrid::GetSamples() const
+{
+	if (LockedSamples == nullptr && SampleBulkData.GetBulkDataSize() > 0)
+	{
+		//Kept locked for the lifetime of the asset, the payload is read only after baking
+		LockedSamples = static_cast<const FDISTerrainElevationSample*>(SampleBulkData.LockReadOnly());
+	}
+
+	return LockedSamples;
+}
+
+void UDISTerrainElevationGrid::ReleaseSamples()
+{
+	if (LockedSamples != nullptr)
+	{
+		SampleBulkData.Unlock();
+		LockedSamples = nullptr;
+	}
+}
@@ -3,38 +3,39 @@
 
 #include "DIS_BPFL.h"
 #include "DISGameManager.h"
+#include "DISGeodeticSolvers.h"
+#include "DISGeoTransformCache.h"
+#include "DISQuaternionConversions.h"
+#include "HAL/IConsoleManager.h"
 
 DEFINE_LOG_CATEGORY(LogDIS_BPFL);
 
-void UDIS_BPFL::CalculateLatLonHeightFromEcefXYZ(const FEarthCenteredEarthFixedDouble Ecef, FLatLonHeightDouble& OutLatLonHeightDegreesMeters)
-{
-	constexpr double earthEquitorialRadiusMeters = 6378137;
-	constexpr double earthPolarRadiusMeters = 6356752.3142;
-
-	const double earthEquitorialRadiusMetersSquared = FMath::Square(earthEquitorialRadiusMeters);
-	const double earthPolarRadiusMetersSquared = FMath::Square(earthPolarRadiusMeters);
+static TAutoConsoleVariable<int32> CVarQuaternionOrientation(
+	TEXT("DIS.Geodetic.QuaternionOrientation"),
+	0,
+	TEXT("Convert between DIS Psi, Theta, Phi and Unreal rotations by composing quaternions instead of going through heading, pitch, roll.\n")
+	TEXT("The quaternion path also accounts for the curvature of the Earth between the world origin and the entity, so results differ slightly from the heading, pitch, roll path.\n")
+	TEXT(" 0: Heading, pitch, roll (default)\n")
+	TEXT(" 1: Quaternion"),
+	ECVF_Default);
 
-	double eSquared = (earthEquitorialRadiusMetersSquared - earthPolarRadiusMetersSquared) / earthEquitorialRadiusMetersSquared;
-	double ePrimeSquared = (earthEquitorialRadiusMetersSquared - earthPolarRadiusMetersSquared) / earthPolarRadiusMetersSquared;
-
-	double p = FMath::Sqrt(FMath::Square(Ecef.X) + FMath::Square(Ecef.Y));
-	double F = 54 * earthPolarRadiusMetersSquared * FMath::Square(Ecef.Z);
-	double G = FMath::Square(p) + (1 - eSquared) * FMath::Square(Ecef.Z) - eSquared * (earthEquitorialRadiusMetersSquared - earthPolarRadiusMetersSquared);
-	double c = (FMath::Square(eSquared) * F * FMath::Square(p)) / FMath::Pow(G, 3);
+bool UDIS_BPFL::UseQuaternionOrientation()
+{
+	return CVarQuaternionOrientation.GetValueOnAnyThread() != 0;
+}
 
-	double s = FMath::Pow(1 + c + FMath::Sqrt(FMath::Square(c) + 2 * c), 1. / 3.);
-	double k = s + 1 + 1 / s;
-	double P = F / (3 * FMath::Square(k) * FMath::Square(G));
-	double Q = FMath::Sqrt(1 + 2 * FMath::Square(eSquared) * P);
+void UDIS_BPFL::CalculateLatLonHeightFromEcefXYZ(const FEarthCenteredEarthFixedDouble Ecef, FLatLonHeightDouble& OutLatLonHeightDegreesMeters)
+{
+	CalculateLatLonHeightFromEcefXYZ(Ecef, DISGeodetic::GetEcefToGeodeticSolver(), OutLatLonHeightDegreesMeters);
+}
 
-	double rNot = (-P * eSquared * p) / (1 + Q) + FMath::Sqrt(1. / 2. * earthEquitorialRadiusMetersSquared * (1 + 1 / Q) - (P * (1 - eSquared) * FMath::Square(Ecef.Z)) / (Q * (1 + Q)) - 1. / 2. * P * FMath::Square(p));
-	double U = FMath::Sqrt(FMath::Square(p - eSquared * rNot) + FMath::Square(Ecef.Z));
-	double V = FMath::Sqrt(FMath::Square(p - eSquared * rNot) + (1 - eSquared) * FMath::Square(Ecef.Z));
-	double zNot = (earthPolarRadiusMetersSquared * Ecef.Z) / (earthEquitorialRadiusMeters * V);
+void UDIS_BPFL::CalculateLatLonHeightFromEcefXYZ(const FEarthCenteredEarthFixedDouble Ecef, const EEcefToGeodeticSolver Solver, FLatLonHeightDouble& OutLatLonHeightDegreesMeters)
+{
+	double latRadians, lonRadians;
+	DISGeodetic::EcefToGeodetic(Solver, Ecef.X, Ecef.Y, Ecef.Z, latRadians, lonRadians, OutLatLonHeightDegreesMeters.Height);
 
-	OutLatLonHeightDegreesMeters.Height = U * (1 - earthPolarRadiusMetersSquared / (earthEquitorialRadiusMeters * V));
-	OutLatLonHeightDegreesMeters.Latitude = glm::degrees(FMath::Atan((Ecef.Z + ePrimeSquared * zNot) / p));
-	OutLatLonHeightDegreesMeters.Longitude = glm::degrees(FMath::Atan2(Ecef.Y, Ecef.X));
+	OutLatLonHeightDegreesMeters.Latitude = glm::degrees(latRadians);
+	OutLatLonHeightDegreesMeters.Longitude = glm::degrees(lonRadians);
 }
 
 void UDIS_BPFL::CalculateLatLonHeightFromEcefXYZ(const FEarthCenteredEarthFixedFloat ECEF, FLatLonHeightFloat& OutLatLonHeightDegreesMeters)
@@ -332,12 +333,12 @@ void UDIS_BPFL::GetEcefXYZFromUnrealLocation(const FVector UnrealLocation, AGeoR
 		return;
 	}
 
-	FCartesianCoordinates cartCoords;
-	GeoReferencingSystem->EngineToECEF(UnrealLocation, cartCoords);
+	FEarthCenteredEarthFixedDouble ecefDouble;
+	FDISGeoTransformCache::EngineToEcef(GeoReferencingSystem, UnrealLocation, ecefDouble);
 
-	ECEF.X = cartCoords.X;
-	ECEF.Y = cartCoords.Y;
-	ECEF.Z = cartCoords.Z;
+	ECEF.X = ecefDouble.X;
+	ECEF.Y = ecefDouble.Y;
+	ECEF.Z = ecefDouble.Z;
 }
 
 void UDIS_BPFL::GetLatLonHeightFromUnrealLocation(const FVector UnrealLocation, AGeoReferencingSystem* GeoReferencingSystem, FLatLonHeightFloat& LatLonHeightDegreesMeters)
@@ -349,10 +350,8 @@ void UDIS_BPFL::GetLatLonHeightFromUnrealLocation(const FVector UnrealLocation,
 		return;
 	}
 
-	FCartesianCoordinates cartCoords;
-	GeoReferencingSystem->EngineToECEF(UnrealLocation, cartCoords);
-
-	FEarthCenteredEarthFixedDouble ecefDouble = FEarthCenteredEarthFixedDouble(cartCoords.X, cartCoords.Y, cartCoords.Z);
+	FEarthCenteredEarthFixedDouble ecefDouble;
+	FDISGeoTransformCache::EngineToEcef(GeoReferencingSystem, UnrealLocation, ecefDouble);
 	FLatLonHeightDouble llhDouble;
 	CalculateLatLonHeightFromEcefXYZ(ecefDouble, llhDouble);
 
@@ -424,8 +423,7 @@ void UDIS_BPFL::GetUnrealRotationFromPsiThetaPhiRadiansAtLatLon(const FPsiThetaP
 
 	//Get NED of the world origin
 	FNorthEastDown originNorthEastDown;
-	GeoReferencingSystem->GetENUVectorsAtEngineLocation(FVector(0, 0, 0), originNorthEastDown.EastVector, originNorthEastDown.NorthVector, originNorthEastDown.DownVector);
-	originNorthEastDown.DownVector *= -1;
+	FDISGeoTransformCache::GetNorthEastDownAtEngineLocation(GeoReferencingSystem, FVector(0, 0, 0), originNorthEastDown);
 
 	// Get the rotational difference between calculated NED and Unreal origin NED
 	const auto XAxisRotationAngle = FVector::DotProduct(NorthEastDownVectors.EastVector, originNorthEastDown.EastVector);
@@ -481,9 +479,7 @@ void UDIS_BPFL::GetUnrealLocationFromEcefXYZ(const FEarthCenteredEarthFixedDoubl
 		return;
 	}
 
-	FCartesianCoordinates cartCoords = FCartesianCoordinates(EcefXYZ.X, EcefXYZ.Y, EcefXYZ.Z);
-
-	GeoReferencingSystem->ECEFToEngine(cartCoords, UnrealLocation);
+	FDISGeoTransformCache::EcefToEngine(GeoReferencingSystem, EcefXYZ, UnrealLocation);
 }
 
 void UDIS_BPFL::GetUnrealRotationFromEntityStatePdu(const FEntityStatePDU EntityStatePdu, AGeoReferencingSystem* GeoReferencingSystem, FRotator& UnrealRotation)
@@ -499,12 +495,51 @@ void UDIS_BPFL::GetUnrealRotationFromEntityStatePdu(const FEntityStatePDU Entity
 
 	FEarthCenteredEarthFixedDouble ecefDouble = FEarthCenteredEarthFixedDouble(EntityStatePdu.EntityLocationDouble[0], EntityStatePdu.EntityLocationDouble[1], EntityStatePdu.EntityLocationDouble[2]);
 
+	if (UseQuaternionOrientation())
+	{
+		FQuat unrealQuat;
+		GetUnrealQuatFromPsiThetaPhiRadiansAtEcef(PsiThetaPhiRadians, ecefDouble, GeoReferencingSystem, unrealQuat);
+		UnrealRotation = unrealQuat.Rotator();
+		return;
+	}
+
 	FLatLonHeightDouble LatLonHeightDouble;
 	CalculateLatLonHeightFromEcefXYZ(ecefDouble, LatLonHeightDouble);
 
 	GetUnrealRotationFromPsiThetaPhiRadiansAtLatLon(PsiThetaPhiRadians, LatLonHeightDouble.Latitude, LatLonHeightDouble.Longitude, GeoReferencingSystem, UnrealRotation);
 }
 
+void UDIS_BPFL::GetUnrealQuatFromPsiThetaPhiRadiansAtEcef(const FPsiThetaPhi PsiThetaPhiRadians, const FEarthCenteredEarthFixedDouble Ecef, AGeoReferencingSystem* GeoReferencingSystem, FQuat& UnrealQuat)
+{
+	if (!IsValid(GeoReferencingSystem))
+	{
+		UnrealQuat = FQuat::Identity;
+		UE_LOG(LogDIS_BPFL, Warning, TEXT("Invalid GeoReference was passed to get Unreal rotation from. Returning identity rotation."));
+		return;
+	}
+
+	const glm::dquat ecefToEngine = FDISGeoTransformCache::GetEcefToEngineRotationAtEcefLocation(GeoReferencingSystem, Ecef);
+	UnrealQuat = DISQuaternion::ToUnrealQuat(ecefToEngine, DISQuaternion::FromPsiThetaPhiRadians(PsiThetaPhiRadians.Psi, PsiThetaPhiRadians.Theta, PsiThetaPhiRadians.Phi));
+}
+
+void UDIS_BPFL::GetPsiThetaPhiRadiansFromUnrealQuatAtEcef(const FQuat UnrealQuat, const FEarthCenteredEarthFixedDouble Ecef, AGeoReferencingSystem* GeoReferencingSystem, FPsiThetaPhi& PsiThetaPhiRadians)
+{
+	if (!IsValid(GeoReferencingSystem))
+	{
+		PsiThetaPhiRadians = FPsiThetaPhi();
+		UE_LOG(LogDIS_BPFL, Warning, TEXT("Invalid GeoReference was passed to get Psi, Theta, Phi rotation from. Returning Psi, Theta, Phi of (0, 0, 0)."));
+		return;
+	}
+
+	const glm::dquat ecefToEngine = FDISGeoTransformCache::GetEcefToEngineRotationAtEcefLocation(GeoReferencingSystem, Ecef);
+
+	double psi, theta, phi;
+	DISQuaternion::ToPsiThetaPhiRadians(DISQuaternion::FromUnrealQuat(ecefToEngine, UnrealQuat), psi, theta, phi);
+	PsiThetaPhiRadians.Psi = psi;
+	PsiThetaPhiRadians.Theta = theta;
+	PsiThetaPhiRadians.Phi = phi;
+}
+
 void UDIS_BPFL::GetUnrealLocationFromEntityStatePdu(const FEntityStatePDU EntityStatePdu, AGeoReferencingSystem* GeoReferencingSystem, FVector& UnrealLocation)
 {
 	if (!IsValid(GeoReferencingSystem))
@@ -516,9 +551,7 @@ void UDIS_BPFL::GetUnrealLocationFromEntityStatePdu(const FEntityStatePDU Entity
 
 	FEarthCenteredEarthFixedDouble ecefDouble = FEarthCenteredEarthFixedDouble(EntityStatePdu.EntityLocationDouble[0], EntityStatePdu.EntityLocationDouble[1], EntityStatePdu.EntityLocationDouble[2]);
 
-	FCartesianCoordinates cartCoords = FCartesianCoordinates(ecefDouble.X, ecefDouble.Y, ecefDouble.Z);
-
-	GeoReferencingSystem->ECEFToEngine(cartCoords, UnrealLocation);
+	FDISGeoTransformCache::EcefToEngine(GeoReferencingSystem, ecefDouble, UnrealLocation);
 }
 
 void UDIS_BPFL::GetUnrealLocationAndOrientationFromEntityStatePdu(const FEntityStatePDU EntityStatePdu, AGeoReferencingSystem* GeoReferencingSystem, FVector& UnrealLocation, FRotator& UnrealRotation)
@@ -545,8 +578,7 @@ void UDIS_BPFL::GetNorthEastDownVectorsFromUnrealLocation(const FVector UnrealLo
 		return;
 	}
 
-	GeoReferencingSystem->GetENUVectorsAtEngineLocation(UnrealLocation, NorthEastDownVectors.EastVector, NorthEastDownVectors.NorthVector, NorthEastDownVectors.DownVector);
-	NorthEastDownVectors.DownVector *= -1;
+	FDISGeoTransformCache::GetNorthEastDownAtEngineLocation(GeoReferencingSystem, UnrealLocation, NorthEastDownVectors);
 }
 
 void UDIS_BPFL::GetEastNorthUpVectorsFromUnrealLocation(const FVector UnrealLocation, AGeoReferencingSystem* GeoReferencingSystem, FEastNorthUp& EastNorthUpVectors)
@@ -570,8 +602,7 @@ void UDIS_BPFL::GetHeadingPitchRollFromUnrealRotation(const FRotator UnrealRotat
 
 	//Get NED of the world origin
 	FNorthEastDown OriginNorthEastDown;
-	GeoReferencingSystem->GetENUVectorsAtEngineLocation(FVector(0, 0, 0), OriginNorthEastDown.EastVector, OriginNorthEastDown.NorthVector, OriginNorthEastDown.DownVector);
-	OriginNorthEastDown.DownVector *= -1;
+	FDISGeoTransformCache::GetNorthEastDownAtEngineLocation(GeoReferencingSystem, FVector(0, 0, 0), OriginNorthEastDown);
 
 	// Get the rotational difference between calculated NED and Unreal origin NED
 	const auto XAxisRotationAngle = FMath::Acos(FVector::DotProduct(NorthEastDownVectors.EastVector, OriginNorthEastDown.EastVector));
@@ -586,6 +617,16 @@ void UDIS_BPFL::GetHeadingPitchRollFromUnrealRotation(const FRotator UnrealRotat
 
 void UDIS_BPFL::GetPsiThetaPhiDegreesFromUnrealRotation(const FRotator UnrealRotation, const FVector UnrealLocation, AGeoReferencingSystem* GeoReferencingSystem, FPsiThetaPhi& PsiThetaPhiDegrees)
 {
+	if (UseQuaternionOrientation())
+	{
+		FPsiThetaPhi psiThetaPhiRadians;
+		GetPsiThetaPhiRadiansFromUnrealRotation(UnrealRotation, UnrealLocation, GeoReferencingSystem, psiThetaPhiRadians);
+		PsiThetaPhiDegrees.Psi = FMath::RadiansToDegrees(psiThetaPhiRadians.Psi);
+		PsiThetaPhiDegrees.Theta = FMath::RadiansToDegrees(psiThetaPhiRadians.Theta);
+		PsiThetaPhiDegrees.Phi = FMath::RadiansToDegrees(psiThetaPhiRadians.Phi);
+		return;
+	}
+
 	FHeadingPitchRoll headingPitchRollDegrees;
 	FLatLonHeightFloat latLonHeightDegrees;
 	GetHeadingPitchRollFromUnrealRotation(UnrealRotation, UnrealLocation, GeoReferencingSystem, headingPitchRollDegrees);
@@ -596,6 +637,14 @@ void UDIS_BPFL::GetPsiThetaPhiDegreesFromUnrealRotation(const FRotator UnrealRot
 
 void UDIS_BPFL::GetPsiThetaPhiRadiansFromUnrealRotation(const FRotator UnrealRotation, const FVector UnrealLocation, AGeoReferencingSystem* GeoReferencingSystem, FPsiThetaPhi& PsiThetaPhiRadians)
 {
+	if (UseQuaternionOrientation() && IsValid(GeoReferencingSystem))
+	{
+		FEarthCenteredEarthFixedDouble ecef;
+		FDISGeoTransformCache::EngineToEcef(GeoReferencingSystem, UnrealLocation, ecef);
+		GetPsiThetaPhiRadiansFromUnrealQuatAtEcef(UnrealRotation.Quaternion(), ecef, GeoReferencingSystem, PsiThetaPhiRadians);
+		return;
+	}
+
 	FHeadingPitchRoll headingPitchRollDegrees;
 	FLatLonHeightFloat latLonHeightDegrees;
 	GetHeadingPitchRollFromUnrealRotation(UnrealRotation, UnrealLocation, GeoReferencingSystem, headingPitchRollDegrees);
@@ -2,9 +2,10 @@
 
 
 #include "DeadReckoning_BPFL.h"
+#include "DISDeadReckoningMath.h"
 #include "Algo/Reverse.h"
 
-const double UDeadReckoning_BPFL::MIN_ROTATION_RATE = 0.2 * glm::pi<double>() / 180;  // minimum significant rate = 1deg/5sec
+const double UDeadReckoning_BPFL::MIN_ROTATION_RATE = DISDeadReckoningMath::MinRotationRate;
 
 bool UDeadReckoning_BPFL::IsMachineLittleEndian()
 {
@@ -227,29 +228,12 @@ bool UDeadReckoning_BPFL::GetLocalQuaternionAngles(TArray<uint8> OtherDeadReckon
 glm::dvec3 UDeadReckoning_BPFL::CalculateDeadReckonedPosition(const glm::dvec3 PositionVector, const glm::dvec3 VelocityVector,
 	const glm::dvec3 AccelerationVector, const double DeltaTime)
 {
-	return PositionVector + (VelocityVector * DeltaTime) + (0.5 * AccelerationVector * FMath::Square(DeltaTime));
+	return DISDeadReckoningMath::CalculateDeadReckonedPosition(PositionVector, VelocityVector, AccelerationVector, DeltaTime);
 }
 
 glm::dmat3 UDeadReckoning_BPFL::CreateDeadReckoningMatrix(glm::dvec3 AngularVelocityVector, double DeltaTime)
 {
-	double AngularVelocityMagnitude = glm::length(AngularVelocityVector);
-	if (AngularVelocityMagnitude == 0)
-	{
-		AngularVelocityMagnitude = 1e-5;
-		AngularVelocityVector += glm::dvec3(1e-5);
-	}
-
-	const auto AngularVelocityMatrix = glm::dmat3(AngularVelocityVector, glm::dvec3(0), glm::dvec3(0));
-	const auto AngularVelocity = AngularVelocityMatrix * glm::transpose(AngularVelocityMatrix);
-
-	const auto CosOmega = glm::cos(AngularVelocityMagnitude * DeltaTime);
-	const auto SinOmega = glm::sin(AngularVelocityMagnitude * DeltaTime);
-
-	glm::dmat3 DeadReckoningMatrix = (((1 - CosOmega) / glm::pow(AngularVelocityMagnitude, 2)) * AngularVelocity) +
-		(CosOmega * glm::dmat3(1)) -
-		(SinOmega / AngularVelocityMagnitude * UDIS_BPFL::CreateNCrossXMatrix(AngularVelocityVector));
-
-	return DeadReckoningMatrix;
+	return DISDeadReckoningMath::CreateDeadReckoningMatrix(AngularVelocityVector, DeltaTime);
 }
 
 FQuat UDeadReckoning_BPFL::CreateDeadReckoningQuaternion(glm::dvec3 AngularVelocityVector, double DeltaTime)
@@ -276,19 +260,7 @@ FQuat UDeadReckoning_BPFL::CreateDeadReckoningQuaternion(glm::dvec3 AngularVeloc
 
 glm::dmat3 UDeadReckoning_BPFL::GetEntityOrientationMatrix(const double PsiRadians, const double ThetaRadians, const double PhiRadians)
 {
-	//Trig orientations
-	const auto CosPsi = glm::cos(PsiRadians);
-	const auto SinPsi = glm::sin(PsiRadians);
-	const auto CosTheta = glm::cos(ThetaRadians);
-	const auto SinTheta = glm::sin(ThetaRadians);
-	const auto CosPhi = glm::cos(PhiRadians);
-	const auto SinPhi = glm::sin(PhiRadians);
-
-	const auto HeadingRotationMatrix = glm::dmat3(CosPsi, -SinPsi, 0, SinPsi, CosPsi, 0, 0, 0, 1);
-	const auto PitchRotationMatrix = glm::dmat3(CosTheta, 0, SinTheta, 0, 1, 0, -SinTheta, 0, CosTheta);
-	const auto RollRotationMatrix = glm::dmat3(1, 0, 0, 0, CosPhi, -SinPhi, 0, SinPhi, CosPhi);
-
-	return RollRotationMatrix * PitchRotationMatrix * HeadingRotationMatrix;
+	return DISDeadReckoningMath::GetEntityOrientationMatrix(PsiRadians, ThetaRadians, PhiRadians);
 }
 
 FQuat UDeadReckoning_BPFL::GetEntityOrientationQuaternion(double PsiRadians, double ThetaRadians, double PhiRadians)
@@ -313,61 +285,12 @@ FQuat UDeadReckoning_BPFL::GetEntityOrientationQuaternion(double PsiRadians, dou
 void UDeadReckoning_BPFL::CalculateDeadReckonedOrientation(const double PsiRadians, const double ThetaRadians, const double PhiRadians,
 	const glm::dvec3 AngularVelocityVector, const float DeltaTime, double& OutPsiRadians, double& OutThetaRadians, double& OutPhiRadians)
 {
-	// Get the entity's current orientation matrix
-	auto OrientationMatrix = GetEntityOrientationMatrix(PsiRadians, ThetaRadians, PhiRadians);
-
-	// Get the change in rotation for this time step
-	const auto DeadReckoningMatrix = CreateDeadReckoningMatrix(AngularVelocityVector, DeltaTime);
-
-	// Calculate the new orientation matrix
-	OrientationMatrix = DeadReckoningMatrix * OrientationMatrix;
-
-	// Extract Euler angles from orientation matrix
-	OutThetaRadians = glm::asin(-OrientationMatrix[2][0]);
-
-	// Special case for |Theta| = pi/2
-	double CosThetaRadians = 1e-5;
-	if (abs(OutThetaRadians) != glm::pi<double>() / 2)
-	{
-		CosThetaRadians = glm::cos(OutThetaRadians);
-	}
-	OutPsiRadians = glm::acos(FMath::Clamp(OrientationMatrix[0][0] / CosThetaRadians, -1.0, 1.0)) * (abs(OrientationMatrix[1][0]) / OrientationMatrix[1][0]);
-	OutPhiRadians = glm::acos(FMath::Clamp(OrientationMatrix[2][2] / CosThetaRadians, -1.0, 1.0)) * (abs(OrientationMatrix[2][1]) / OrientationMatrix[2][1]);
+	DISDeadReckoningMath::CalculateDeadReckonedOrientation(PsiRadians, ThetaRadians, PhiRadians, AngularVelocityVector, DeltaTime, OutPsiRadians, OutThetaRadians, OutPhiRadians);
 }
 
 glm::dvec3 UDeadReckoning_BPFL::GetEntityBodyDeadReckonedPosition(const glm::dvec3 InitialPositionVector, const glm::dvec3 BodyVelocityVector, const glm::dvec3 BodyLinearAccelerationVector, const glm::dvec3 BodyAngularVelocityVector, const glm::dvec3 EntityOrientation, const double DeltaTime)
 {
-	const auto SkewMatrix = UDIS_BPFL::CreateNCrossXMatrix(BodyAngularVelocityVector);
-	const auto BodyAccelerationVector = BodyLinearAccelerationVector - (SkewMatrix * BodyVelocityVector);
-
-	// Get the entity's current orientation matrix
-	const auto OrientationMatrix = GetEntityOrientationMatrix(EntityOrientation.x, EntityOrientation.y, EntityOrientation.z);
-	const auto InverseInitialOrientationMatrix = glm::transpose(OrientationMatrix);
-
-	// Calculate R1
-	const auto OmegaMatrix = glm::dmat3x3(BodyAngularVelocityVector, glm::dvec3(0), glm::dvec3(0)) * glm::transpose(glm::dmat3x3(BodyAngularVelocityVector, glm::dvec3(0), glm::dvec3(0)));
-	double AngularVelocityMagnitude = glm::length(BodyAngularVelocityVector);
-
-	glm::dmat3 R1 = glm::dmat3();
-	glm::dmat3 R2 = glm::dmat3();
-
-	if (AngularVelocityMagnitude < MIN_ROTATION_RATE)
-	{
-		R1 = glm::dmat3(1) * DeltaTime;
-		R2 = glm::dmat3(1) * (glm::pow(DeltaTime, 2) / 2);
-	}
-	else
-	{
-		R1 = (((AngularVelocityMagnitude * DeltaTime - glm::sin(AngularVelocityMagnitude * DeltaTime)) / glm::pow(AngularVelocityMagnitude, 3)) * OmegaMatrix) +
-			(glm::sin(AngularVelocityMagnitude * DeltaTime) / AngularVelocityMagnitude * glm::dmat3(1)) +
-			(((1 - glm::cos(AngularVelocityMagnitude * DeltaTime)) / glm::pow(AngularVelocityMagnitude, 2)) * SkewMatrix);
-
-		R2 = ((((0.5 * glm::pow(AngularVelocityMagnitude, 2) * glm::pow(DeltaTime, 2)) - (glm::cos(AngularVelocityMagnitude * DeltaTime)) - (AngularVelocityMagnitude * DeltaTime * glm::sin(AngularVelocityMagnitude * DeltaTime)) + (1)) / glm::pow(AngularVelocityMagnitude, 4)) * OmegaMatrix) +
-			(((glm::cos(AngularVelocityMagnitude * DeltaTime)) + (AngularVelocityMagnitude * DeltaTime * glm::sin(AngularVelocityMagnitude * DeltaTime)) - (1)) / (glm::pow(AngularVelocityMagnitude, 2)) * glm::dmat3(1)) +
-			((((glm::sin(AngularVelocityMagnitude * DeltaTime)) - (AngularVelocityMagnitude * DeltaTime * glm::cos(AngularVelocityMagnitude * DeltaTime))) / (glm::pow(AngularVelocityMagnitude, 3))) * SkewMatrix);
-	}
-
-	return InitialPositionVector + InverseInitialOrientationMatrix * ((R1 * BodyVelocityVector) + (R2 * BodyAccelerationVector));
+	return DISDeadReckoningMath::GetEntityBodyDeadReckonedPosition(InitialPositionVector, BodyVelocityVector, BodyLinearAccelerationVector, BodyAngularVelocityVector, EntityOrientation, DeltaTime);
 }
 
 bool UDeadReckoning_BPFL::DeadReckoning(FEntityStatePDU EntityPDUToDeadReckon, float DeltaTime, FEntityStatePDU& DeadReckonedEntityPDU)
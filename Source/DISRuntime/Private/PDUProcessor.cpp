@@ -3,6 +3,8 @@
 #include "PDUProcessor.h"
 #include "UDPSubsystem.h"
 
+DEFINE_LOG_CATEGORY(LogPDUProcessor);
+
 void UPDUProcessor::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Collection.InitializeDependency(UUDPSubsystem::StaticClass());
@@ -27,8 +29,11 @@ void UPDUProcessor::ProcessDISPacket(const TArray<uint8>& InData)
 	SCOPE_CYCLE_COUNTER(STAT_ProcessDISPacket);
 	int bytesArrayLength = InData.Num();
 
-	if (bytesArrayLength < 1)
+	//Open DIS throws on datagrams shorter than their PDU, so anything that would not unmarshal cleanly is turned away here
+	const EDISPacketRejectReason rejectReason = FDISPacketValidator::Validate(InData.GetData(), bytesArrayLength);
+	if (rejectReason != EDISPacketRejectReason::None)
 	{
+		RejectPacket(rejectReason, bytesArrayLength);
 		return;
 	}
 
@@ -136,4 +141,43 @@ void UPDUProcessor::ProcessDISPacket(const TArray<uint8>& InData)
 		return;
 	}
 	}
-}
\ No newline at end of file
+}
+
+void UPDUProcessor::RejectPacket(EDISPacketRejectReason Reason, int32 NumBytes)
+{
+	int64& count = RejectedPacketCounts[static_cast<int32>(Reason)];
+	count++;
+
+	if (Reason == EDISPacketRejectReason::UnsupportedPDUType)
+	{
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_MalformedPackets);
+	if (count == 1)
+	{
+		const TCHAR* reasonName = Reason == EDISPacketRejectReason::TooShortForHeader ? TEXT("shorter than a PDU header")
+			: Reason == EDISPacketRejectReason::LengthMismatch ? TEXT("header length does not match the datagram")
+			: Reason == EDISPacketRejectReason::TooShortForPDU ? TEXT("shorter than its PDU type")
+			: Reason == EDISPacketRejectReason::RecordsOverrun ? TEXT("record counts run past its length")
+			: TEXT("more records than can be decoded");
+		UE_LOG(LogPDUProcessor, Warning, TEXT("Rejected a malformed DIS datagram of %d bytes, %s. Further datagrams rejected for this reason are only counted."), NumBytes, reasonName);
+	}
+}
+
+FDISRejectedPacketCounts UPDUProcessor::GetRejectedPacketCounts() const
+{
+	FDISRejectedPacketCounts counts;
+	counts.TooShortForHeader = RejectedPacketCounts[static_cast<int32>(EDISPacketRejectReason::TooShortForHeader)];
+	counts.LengthMismatch = RejectedPacketCounts[static_cast<int32>(EDISPacketRejectReason::LengthMismatch)];
+	counts.TooShortForPDU = RejectedPacketCounts[static_cast<int32>(EDISPacketRejectReason::TooShortForPDU)];
+	counts.RecordsOverrun = RejectedPacketCounts[static_cast<int32>(EDISPacketRejectReason::RecordsOverrun)];
+	counts.TooManyRecords = RejectedPacketCounts[static_cast<int32>(EDISPacketRejectReason::TooManyRecords)];
+	counts.UnsupportedPDUType = RejectedPacketCounts[static_cast<int32>(EDISPacketRejectReason::UnsupportedPDUType)];
+	return counts;
+}
+
+void UPDUProcessor::ResetRejectedPacketCounts()
+{
+	FMemory::Memzero(RejectedPacketCounts);
+}
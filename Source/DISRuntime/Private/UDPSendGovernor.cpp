@@ -0,0 +1,156 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#include "UDPSendGovernor.h"
+
+FUDPSendGovernor::FUDPSendGovernor(double MaxBytesPerSecond, double MaxPacketsPerSecond, double BurstSeconds, double NowSeconds)
+	: BytesPerSecond(MaxBytesPerSecond)
+	, PacketsPerSecond(MaxPacketsPerSecond)
+	, LastRefillSeconds(NowSeconds)
+{
+	//Always allow at least one packet to build up so the budget can not stall
+	ByteCapacity = FMath::Max(BytesPerSecond * BurstSeconds, 1500.);
+	PacketCapacity = FMath::Max(PacketsPerSecond * BurstSeconds, 1.);
+	ByteTokens = ByteCapacity;
+	PacketTokens = PacketCapacity;
+}
+
+void FUDPSendGovernor::Refill(double NowSeconds)
+{
+	const double elapsedSeconds = FMath::Max(NowSeconds - LastRefillSeconds, 0.);
+	LastRefillSeconds = NowSeconds;
+
+	ByteTokens = FMath::Min(ByteTokens + BytesPerSecond * elapsedSeconds, ByteCapacity);
+	PacketTokens = FMath::Min(PacketTokens + PacketsPerSecond * elapsedSeconds, PacketCapacity);
+}
+
+bool FUDPSendGovernor::CanSendNow(int32 NumBytes) const
+{
+	if (Deferred.Num() > 0)
+	{
+		return false;
+	}
+
+	const bool bytesAvailable = BytesPerSecond <= 0 || ByteTokens >= FMath::Min<double>(NumBytes, ByteCapacity);
+	const bool packetsAvailable = PacketsPerSecond <= 0 || PacketTokens >= 1;
+
+	return bytesAvailable && packetsAvailable;
+}
+
+void FUDPSendGovernor::Consume(int32 NumBytes)
+{
+	if (BytesPerSecond > 0)
+	{
+		ByteTokens -= NumBytes;
+	}
+	if (PacketsPerSecond > 0)
+	{
+		PacketTokens -= 1;
+	}
+}
+
+FUDPSendGovernor::EDeferResult FUDPSendGovernor::Defer(const TArray<uint8>& Bytes, EUDPSendPriority Priority, int64 MergeKey)
+{
+	//Only the newest bytes per key are worth sending. Keep the queue position and the most urgent priority of the merged bytes.
+	if (MergeKey != 0)
+	{
+		if (const int32* existingIndex = MergeIndex.Find(MergeKey))
+		{
+			FDeferredSend& existing = Deferred[*existingIndex];
+			existing.Bytes = Bytes;
+			existing.Priority = FMath::Max(existing.Priority, Priority);
+			return EDeferResult::Merged;
+		}
+	}
+
+	EDeferResult result = EDeferResult::Queued;
+
+	if (Deferred.Num() >= MaxDeferred)
+	{
+		//Make room by dropping the least important, oldest bytes unless the new bytes are less important still
+		int32 dropIndex = 0;
+		for (int32 i = 1; i < Deferred.Num(); i++)
+		{
+			if (Deferred[i].Priority < Deferred[dropIndex].Priority)
+			{
+				dropIndex = i;
+			}
+		}
+
+		if (Deferred[dropIndex].Priority > Priority)
+		{
+			return EDeferResult::Dropped;
+		}
+
+		Deferred.RemoveAt(dropIndex);
+		RebuildMergeIndex();
+		result = EDeferResult::Dropped;
+	}
+
+	if (MergeKey != 0)
+	{
+		MergeIndex.Add(MergeKey, Deferred.Num());
+	}
+	Deferred.Add({ Bytes, Priority, MergeKey, NextSequence++ });
+
+	return result;
+}
+
+bool FUDPSendGovernor::RemoveDeferred(int64 MergeKey)
+{
+	const int32* existingIndex = MergeKey != 0 ? MergeIndex.Find(MergeKey) : nullptr;
+	if (existingIndex == nullptr)
+	{
+		return false;
+	}
+
+	Deferred.RemoveAt(*existingIndex);
+	RebuildMergeIndex();
+
+	return true;
+}
+
+int32 FUDPSendGovernor::Flush(TFunctionRef<void(const TArray<uint8>&)> Send)
+{
+	if (Deferred.Num() == 0)
+	{
+		return 0;
+	}
+
+	//Highest priority first, oldest first within a priority
+	Deferred.Sort([](const FDeferredSend& A, const FDeferredSend& B)
+	{
+		return A.Priority != B.Priority ? A.Priority > B.Priority : A.Sequence < B.Sequence;
+	});
+
+	int32 numSent = 0;
+	for (; numSent < Deferred.Num(); numSent++)
+	{
+		const int32 numBytes = Deferred[numSent].Bytes.Num();
+		const bool bytesAvailable = BytesPerSecond <= 0 || ByteTokens >= FMath::Min<double>(numBytes, ByteCapacity);
+		const bool packetsAvailable = PacketsPerSecond <= 0 || PacketTokens >= 1;
+		if (!bytesAvailable || !packetsAvailable)
+		{
+			break;
+		}
+
+		Send(Deferred[numSent].Bytes);
+		Consume(numBytes);
+	}
+
+	Deferred.RemoveAt(0, numSent, false);
+	RebuildMergeIndex();
+
+	return numSent;
+}
+
+void FUDPSendGovernor::RebuildMergeIndex()
+{
+	MergeIndex.Reset();
+	for (int32 i = 0; i < Deferred.Num(); i++)
+	{
+		if (Deferred[i].MergeKey != 0)
+		{
+			MergeIndex.Add(Deferred[i].MergeKey, i);
+		}
+	}
+}
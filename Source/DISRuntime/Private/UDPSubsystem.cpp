@@ -14,10 +14,14 @@ void UUDPSubsystem::Initialize(FSubsystemCollectionBase& Collection)
 	bool canBindAll = false;
 	TSharedRef<FInternetAddr> Sender = SocketSubsystem->GetLocalHostAddr(*GLog, canBindAll);
 	LocalIPAddress = Sender->ToString(false);
+
+	FlushDeferredBytesHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UUDPSubsystem::FlushDeferredBytes));
 }
 
 void UUDPSubsystem::Deinitialize()
 {
+	FTicker::GetCoreTicker().RemoveTicker(FlushDeferredBytesHandle);
+
 	CloseAllSendSockets();
 	CloseAllReceiveSockets();
 
@@ -64,17 +68,11 @@ bool UUDPSubsystem::OpenReceiveSocket(FReceiveSocketSettings SocketSettings, int
 	FString ThreadName = FString::Printf(TEXT("UDP RECEIVER-FUDPWrapper"));
 	FUdpSocketReceiver* UDPReceiver = new FUdpSocketReceiver(ReceiverSocket, ThreadWaitTime, *ThreadName);
 
-	UDPReceiver->OnDataReceived().BindLambda([this, SocketSettings](const FArrayReaderPtr& DataPtr, const FIPv4Endpoint& Endpoint)
+	const int32 receiveSocketID = TotalReceiveSocketIterator;
+	const FIPv4Endpoint receiveEndpoint(Addr, PortToListenOn);
+	UDPReceiver->OnDataReceived().BindLambda([this, SocketSettings, receiveSocketID, receiveEndpoint](const FArrayReaderPtr& DataPtr, const FIPv4Endpoint& Endpoint)
 	{
 		SCOPE_CYCLE_COUNTER(STAT_ReceiveBytes);
-		if (!OnReceivedBytes.IsBound())
-		{
-			return;
-		}
-
-		TArray<uint8> Data;
-		Data.AddUninitialized(DataPtr->TotalSize());
-		DataPtr->Serialize(Data.GetData(), DataPtr->TotalSize());
 
 		FString SenderIp = Endpoint.Address.ToString();
 
@@ -84,11 +82,32 @@ bool UUDPSubsystem::OpenReceiveSocket(FReceiveSocketSettings SocketSettings, int
 			return;
 		}
 
+		//Taps see the datagram in place on this thread, before any copy to the game thread
+		{
+			FRWScopeLock tapsLock(ReceiveTapsLock, SLT_ReadOnly);
+			for (const TSharedRef<IUDPReceiveTap, ESPMode::ThreadSafe>& tap : ReceiveTaps)
+			{
+				tap->OnDatagramReceived(TArrayView<const uint8>(DataPtr->GetData(), DataPtr->Num()), Endpoint, receiveEndpoint, receiveSocketID);
+			}
+		}
+
+		if (!OnReceivedBytes.IsBound())
+		{
+			return;
+		}
+
+		TArray<uint8> Data;
+		Data.AddUninitialized(DataPtr->TotalSize());
+		DataPtr->Serialize(Data.GetData(), DataPtr->TotalSize());
+
 		if (SocketSettings.bReceiveDataOnGameThread)
 		{
 			//Copy data to receiving thread via lambda capture
+			PendingGameThreadDatagrams.Increment();
 			AsyncTask(ENamedThreads::GameThread, [this, Data, SenderIp]()
 			{
+				PendingGameThreadDatagrams.Decrement();
+
 				//double check we're still bound on this thread
 				if (OnReceivedBytes.IsBound())
 				{
@@ -111,12 +130,25 @@ bool UUDPSubsystem::OpenReceiveSocket(FReceiveSocketSettings SocketSettings, int
 
 	//Add new receive socket info to map and increase iterator
 	AllReceiveSockets.Add(TotalReceiveSocketIterator, FReceiveSocketMapValue(ReceiverSocket, UDPReceiver));
-	ReceiveSocketID = TotalSendSocketIterator;
+	ReceiveSocketID = TotalReceiveSocketIterator;
 	TotalReceiveSocketIterator++;
 
 	return true;
 }
 
+void UUDPSubsystem::AddReceiveTap(const TSharedRef<IUDPReceiveTap, ESPMode::ThreadSafe>& Tap)
+{
+	FRWScopeLock tapsLock(ReceiveTapsLock, SLT_Write);
+	ReceiveTaps.AddUnique(Tap);
+}
+
+void UUDPSubsystem::RemoveReceiveTap(const TSharedRef<IUDPReceiveTap, ESPMode::ThreadSafe>& Tap)
+{
+	//Waits for any receive thread still inside the tap
+	FRWScopeLock tapsLock(ReceiveTapsLock, SLT_Write);
+	ReceiveTaps.Remove(Tap);
+}
+
 bool UUDPSubsystem::CloseReceiveSocket(int32 ReceiveSocketIdToClose)
 {
 	bool bDidCloseCorrectly = true;
@@ -212,6 +244,11 @@ bool UUDPSubsystem::OpenSendSocket(FSendSocketSettings SocketSettings, int32& Se
 		OnSendSocketOpened.Broadcast(TotalSendSocketIterator, LocalIp, LocalPort, IpToSendOn, PortToSendOn);
 	}
 
+	if (SocketSettings.MaxBytesPerSecond > 0 || SocketSettings.MaxPacketsPerSecond > 0)
+	{
+		SendGovernors.Add(TotalSendSocketIterator, FUDPSendGovernor(SocketSettings.MaxBytesPerSecond, SocketSettings.MaxPacketsPerSecond, SocketSettings.BurstSeconds, FPlatformTime::Seconds()));
+	}
+
 	//Add new send socket info to map and increase iterator
 	AllSendSockets.Add(TotalSendSocketIterator, SenderSocket);
 	SendSocketID = TotalSendSocketIterator;
@@ -262,15 +299,22 @@ bool UUDPSubsystem::CloseSendSocket(int32 SendSocketIdToClose)
 		}
 
 		AllSendSockets.Remove(SendSocketIdToClose);
+		SendGovernors.Remove(SendSocketIdToClose);
 	}
 
 	return bDidCloseCorrectly;
 }
 
 bool UUDPSubsystem::EmitBytes(const TArray<uint8>& Bytes)
+{
+	return EmitBytesWithPriority(Bytes, EUDPSendPriority::High);
+}
+
+bool UUDPSubsystem::EmitBytesWithPriority(const TArray<uint8>& Bytes, EUDPSendPriority Priority, int64 MergeKey)
 {
 	SCOPE_CYCLE_COUNTER(STAT_SendBytes);
 	bool bDidSendCorrectly = true;
+	const double NowSeconds = FPlatformTime::Seconds();
 
 	for (const TPair<int32, FSocket*>& pair : AllSendSockets) 
 	{
@@ -278,6 +322,38 @@ bool UUDPSubsystem::EmitBytes(const TArray<uint8>& Bytes)
 
 		if (SendSocket && SendSocket->GetConnectionState() == SCS_Connected)
 		{
+			FUDPSendGovernor* Governor = SendGovernors.Find(pair.Key);
+			if (Governor)
+			{
+				Governor->Refill(NowSeconds);
+
+				//Hold back lower priority bytes while the socket is over budget
+				if (Priority != EUDPSendPriority::High && !Governor->CanSendNow(Bytes.Num()))
+				{
+					switch (Governor->Defer(Bytes, Priority, MergeKey))
+					{
+					case FUDPSendGovernor::EDeferResult::Queued:
+						INC_DWORD_STAT(STAT_SendsDeferred);
+						break;
+					case FUDPSendGovernor::EDeferResult::Merged:
+						INC_DWORD_STAT(STAT_SendsMerged);
+						break;
+					case FUDPSendGovernor::EDeferResult::Dropped:
+						INC_DWORD_STAT(STAT_SendsDropped);
+						break;
+					}
+					continue;
+				}
+
+				Governor->Consume(Bytes.Num());
+
+				//Older bytes still queued for the same key would arrive after these and undo them, such as a heartbeat after a deactivation
+				if (Governor->RemoveDeferred(MergeKey))
+				{
+					INC_DWORD_STAT(STAT_SendsMerged);
+				}
+			}
+
 			int32 BytesSent = 0;
 			bDidSendCorrectly = bDidSendCorrectly && SendSocket->Send(Bytes.GetData(), Bytes.Num(), BytesSent);
 		}
@@ -285,6 +361,35 @@ bool UUDPSubsystem::EmitBytes(const TArray<uint8>& Bytes)
 	return bDidSendCorrectly;
 }
 
+bool UUDPSubsystem::FlushDeferredBytes(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FlushDeferredBytes);
+	const double NowSeconds = FPlatformTime::Seconds();
+	int32 NumQueued = 0;
+
+	for (TPair<int32, FUDPSendGovernor>& pair : SendGovernors)
+	{
+		FSocket** SendSocket = AllSendSockets.Find(pair.Key);
+		if (!SendSocket || !*SendSocket || (*SendSocket)->GetConnectionState() != SCS_Connected)
+		{
+			continue;
+		}
+
+		pair.Value.Refill(NowSeconds);
+		pair.Value.Flush([SendSocket](const TArray<uint8>& Bytes)
+		{
+			int32 BytesSent = 0;
+			(*SendSocket)->Send(Bytes.GetData(), Bytes.Num(), BytesSent);
+		});
+		NumQueued += pair.Value.NumDeferred();
+	}
+
+	SET_DWORD_STAT(STAT_DeferredSendsQueued, NumQueued);
+
+	//Keep ticking
+	return true;
+}
+
 bool UUDPSubsystem::CloseAllReceiveSockets()
 {
 	bool allClosedSuccessfully = true;
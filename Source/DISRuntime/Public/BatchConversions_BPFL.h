@@ -0,0 +1,197 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DISEnumsAndStructs.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "GeoReferencingSystem.h"
+#include "BatchConversions_BPFL.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogBatchConversions_BPFL, Log, All);
+
+/**
+ * Three double precision component arrays (structure of arrays). Used to pass batches of ECEF locations,
+ * latitude/longitude/height triples, or Euler angles to the batch conversion functions.
+ */
+struct DISRUNTIME_API FDISVectorArrayDouble
+{
+	TArray<double> X;
+	TArray<double> Y;
+	TArray<double> Z;
+
+	int32 Num() const { return X.Num(); }
+
+	void SetNumUninitialized(int32 NewNum)
+	{
+		X.SetNumUninitialized(NewNum);
+		Y.SetNumUninitialized(NewNum);
+		Z.SetNumUninitialized(NewNum);
+	}
+
+	void Reset()
+	{
+		X.Reset();
+		Y.Reset();
+		Z.Reset();
+	}
+};
+
+/**
+ * Array in/array out versions of the DIS_BPFL unit conversions.
+ *
+ * Native functions take double precision structure of arrays views and run tight loops without per element virtual calls, allocations, or lookups.
+ * The loops are scalar. There are no hand written AVX2 or NEON kernels, and since every conversion calls trigonometric functions and the geodetic solvers
+ * branch per element, compilers do not vectorize them either. The gain over DIS_BPFL comes from the layout and from skipping the per element overhead.
+ * Blueprint functions convert whole arrays in a single node.
+ */
+UCLASS()
+class DISRUNTIME_API UBatchConversions_BPFL : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * Converts DIS X, Y, Z coordinates (ECEF) to latitude in degrees, longitude in degrees, and height in meters for every element
+	 * using the solver selected by the DIS.Geodetic.EcefToGeodeticSolver console variable.
+	 * All views must be the same length.
+	 */
+	static void CalculateLatLonHeightFromEcefXYZ(TArrayView<const double> EcefX, TArrayView<const double> EcefY, TArrayView<const double> EcefZ,
+		TArrayView<double> OutLatitudeDegrees, TArrayView<double> OutLongitudeDegrees, TArrayView<double> OutHeightMeters);
+
+	/**
+	 * Converts latitude in degrees, longitude in degrees, and height in meters to DIS X, Y, Z coordinates (ECEF) for every element.
+	 * All views must be the same length.
+	 */
+	static void CalculateEcefXYZFromLatLonHeight(TArrayView<const double> LatitudeDegrees, TArrayView<const double> LongitudeDegrees, TArrayView<const double> HeightMeters,
+		TArrayView<double> OutEcefX, TArrayView<double> OutEcefY, TArrayView<double> OutEcefZ);
+
+	/**
+	 * Calculates the North, East, Down vectors in ECEF for every latitude and longitude given in degrees.
+	 */
+	static void CalculateNorthEastDownVectorsFromLatLon(TArrayView<const double> LatitudeDegrees, TArrayView<const double> LongitudeDegrees, TArrayView<FNorthEastDown> OutNorthEastDownVectors);
+
+	/**
+	 * Converts Heading, Pitch, Roll rotations in radians at the given latitudes/longitudes in degrees to Psi, Theta, Phi rotations in radians.
+	 */
+	static void CalculatePsiThetaPhiRadiansFromHeadingPitchRollRadiansAtLatLon(TArrayView<const double> HeadingRadians, TArrayView<const double> PitchRadians, TArrayView<const double> RollRadians,
+		TArrayView<const double> LatitudeDegrees, TArrayView<const double> LongitudeDegrees,
+		TArrayView<double> OutPsiRadians, TArrayView<double> OutThetaRadians, TArrayView<double> OutPhiRadians);
+
+	/**
+	 * Converts Psi, Theta, Phi rotations in radians at the given latitudes/longitudes in degrees to Heading, Pitch, Roll rotations in radians.
+	 */
+	static void CalculateHeadingPitchRollRadiansFromPsiThetaPhiRadiansAtLatLon(TArrayView<const double> PsiRadians, TArrayView<const double> ThetaRadians, TArrayView<const double> PhiRadians,
+		TArrayView<const double> LatitudeDegrees, TArrayView<const double> LongitudeDegrees,
+		TArrayView<double> OutHeadingRadians, TArrayView<double> OutPitchRadians, TArrayView<double> OutRollRadians);
+
+	/**
+	 * Converts Unreal locations to ECEF in double precision.
+	 */
+	static void GetEcefXYZFromUnrealLocations(TArrayView<const FVector> UnrealLocations, AGeoReferencingSystem* GeoReferencingSystem, TArrayView<double> OutEcefX, TArrayView<double> OutEcefY, TArrayView<double> OutEcefZ);
+
+	/**
+	 * Converts double precision ECEF locations to Unreal locations.
+	 */
+	static void GetUnrealLocationsFromEcefXYZ(TArrayView<const double> EcefX, TArrayView<const double> EcefY, TArrayView<const double> EcefZ, AGeoReferencingSystem* GeoReferencingSystem, TArrayView<FVector> OutUnrealLocations);
+
+	/**
+	 * Converts Psi, Theta, Phi rotations in radians at the given ECEF locations to Unreal rotations by composing quaternions.
+	 * See UDIS_BPFL::GetUnrealQuatFromPsiThetaPhiRadiansAtEcef.
+	 */
+	static void GetUnrealQuatsFromPsiThetaPhiRadiansAtEcef(TArrayView<const double> PsiRadians, TArrayView<const double> ThetaRadians, TArrayView<const double> PhiRadians,
+		TArrayView<const double> EcefX, TArrayView<const double> EcefY, TArrayView<const double> EcefZ, AGeoReferencingSystem* GeoReferencingSystem, TArrayView<FQuat> OutUnrealQuats);
+
+	/**
+	 * Converts Unreal rotations at the given ECEF locations to Psi, Theta, Phi rotations in radians by composing quaternions.
+	 * See UDIS_BPFL::GetPsiThetaPhiRadiansFromUnrealQuatAtEcef.
+	 */
+	static void GetPsiThetaPhiRadiansFromUnrealQuatsAtEcef(TArrayView<const FQuat> UnrealQuats, TArrayView<const double> EcefX, TArrayView<const double> EcefY, TArrayView<const double> EcefZ,
+		AGeoReferencingSystem* GeoReferencingSystem, TArrayView<double> OutPsiRadians, TArrayView<double> OutThetaRadians, TArrayView<double> OutPhiRadians);
+
+	/**
+	 * Converts Unreal rotations at the given Unreal locations to Psi, Theta, Phi rotations in radians. EcefX/Y/Z must hold the same locations already converted to ECEF.
+	 * Follows the same heading, pitch, roll or quaternion path as UDIS_BPFL::GetPsiThetaPhiRadiansFromUnrealRotation.
+	 */
+	static void GetPsiThetaPhiRadiansFromUnrealRotations(TArrayView<const FRotator> UnrealRotations, TArrayView<const FVector> UnrealLocations,
+		TArrayView<const double> EcefX, TArrayView<const double> EcefY, TArrayView<const double> EcefZ,
+		AGeoReferencingSystem* GeoReferencingSystem, TArrayView<double> OutPsiRadians, TArrayView<double> OutThetaRadians, TArrayView<double> OutPhiRadians);
+
+	/**
+	 * Converts an array of DIS X, Y, Z coordinates (ECEF) to latitude, longitude, and height.
+	 * @param EcefLocations The ECEF locations
+	 * @param OutLatLonHeightsDegreesMeters The converted latitudes in degrees, longitudes in degrees, and heights in meters
+	 */
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Unit Conversions|Batch")
+		static void CalculateLatLonHeightsFromEcefXYZs(const TArray<FEarthCenteredEarthFixedFloat>& EcefLocations, TArray<FLatLonHeightFloat>& OutLatLonHeightsDegreesMeters);
+
+	/**
+	 * Converts an array of latitude, longitude, and height locations to DIS X, Y, Z coordinates (ECEF).
+	 * @param LatLonHeightsDegreesMeters The latitudes in degrees, longitudes in degrees, and heights in meters
+	 * @param OutEcefLocations The converted ECEF locations
+	 */
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Unit Conversions|Batch")
+		static void CalculateEcefXYZsFromLatLonHeights(const TArray<FLatLonHeightFloat>& LatLonHeightsDegreesMeters, TArray<FEarthCenteredEarthFixedFloat>& OutEcefLocations);
+
+	/**
+	 * Calculates the North, East, Down vectors for an array of latitude and longitude locations.
+	 * @param LatLonHeightsDegreesMeters The latitudes in degrees and longitudes in degrees. Heights are ignored.
+	 * @param OutNorthEastDownVectors The North, East, Down vectors of each location
+	 */
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Unit Conversions|Batch")
+		static void CalculateNorthEastDownVectorsFromLatLons(const TArray<FLatLonHeightFloat>& LatLonHeightsDegreesMeters, TArray<FNorthEastDown>& OutNorthEastDownVectors);
+
+	/**
+	 * Converts an array of Heading, Pitch, Roll rotations in degrees to Psi, Theta, Phi rotations in degrees at the matching latitude and longitude.
+	 * @param HeadingPitchRollsDegrees The Heading, Pitch, Roll rotations in degrees
+	 * @param LatLonHeightsDegreesMeters The locations of each rotation. Must be the same length as HeadingPitchRollsDegrees.
+	 * @param OutPsiThetaPhisDegrees The converted Psi, Theta, Phi rotations in degrees
+	 */
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Unit Conversions|Batch")
+		static void CalculatePsiThetaPhisDegreesFromHeadingPitchRollsDegreesAtLatLons(const TArray<FHeadingPitchRoll>& HeadingPitchRollsDegrees, const TArray<FLatLonHeightFloat>& LatLonHeightsDegreesMeters, TArray<FPsiThetaPhi>& OutPsiThetaPhisDegrees);
+
+	/**
+	 * Converts an array of Psi, Theta, Phi rotations in degrees to Heading, Pitch, Roll rotations in degrees at the matching latitude and longitude.
+	 * @param PsiThetaPhisDegrees The Psi, Theta, Phi rotations in degrees
+	 * @param LatLonHeightsDegreesMeters The locations of each rotation. Must be the same length as PsiThetaPhisDegrees.
+	 * @param OutHeadingPitchRollsDegrees The converted Heading, Pitch, Roll rotations in degrees
+	 */
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Unit Conversions|Batch")
+		static void CalculateHeadingPitchRollsDegreesFromPsiThetaPhisDegreesAtLatLons(const TArray<FPsiThetaPhi>& PsiThetaPhisDegrees, const TArray<FLatLonHeightFloat>& LatLonHeightsDegreesMeters, TArray<FHeadingPitchRoll>& OutHeadingPitchRollsDegrees);
+
+	/**
+	 * Calculate the ECEF locations of an array of Unreal locations.
+	 * @param UnrealLocations The Unreal locations to convert to ECEF.
+	 * @param GeoReferencingSystem The GeoReferencing Subsystem reference.
+	 * @param OutEcefLocations The ECEF locations of the given Unreal locations.
+	 */
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Unit Conversions|Batch")
+		static void GetEcefXYZsFromUnrealLocations(const TArray<FVector>& UnrealLocations, AGeoReferencingSystem* GeoReferencingSystem, TArray<FEarthCenteredEarthFixedFloat>& OutEcefLocations);
+
+	/**
+	 * Calculate the latitude, longitude, and height of an array of Unreal locations.
+	 * @param UnrealLocations The Unreal locations to convert.
+	 * @param GeoReferencingSystem The GeoReferencing Subsystem reference.
+	 * @param OutLatLonHeightsDegreesMeters The latitudes in degrees, longitudes in degrees, and heights in meters of the given Unreal locations.
+	 */
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Unit Conversions|Batch")
+		static void GetLatLonHeightsFromUnrealLocations(const TArray<FVector>& UnrealLocations, AGeoReferencingSystem* GeoReferencingSystem, TArray<FLatLonHeightFloat>& OutLatLonHeightsDegreesMeters);
+
+	/**
+	 * Get the Unreal locations of an array of ECEF locations.
+	 * @param EcefLocations The ECEF locations to convert.
+	 * @param GeoReferencingSystem The GeoReferencing Subsystem reference.
+	 * @param OutUnrealLocations The Unreal locations of the given ECEF locations.
+	 */
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Unit Conversions|Batch")
+		static void GetUnrealLocationsFromEcefXYZs(const TArray<FEarthCenteredEarthFixedFloat>& EcefLocations, AGeoReferencingSystem* GeoReferencingSystem, TArray<FVector>& OutUnrealLocations);
+
+	/**
+	 * Get the Unreal locations of an array of latitude, longitude, and height locations.
+	 * @param LatLonHeightsDegreesMeters The LLH locations to convert.
+	 * @param GeoReferencingSystem The GeoReferencing Subsystem reference.
+	 * @param OutUnrealLocations The Unreal locations of the given LLH locations.
+	 */
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Unit Conversions|Batch")
+		static void GetUnrealLocationsFromLatLonHeights(const TArray<FLatLonHeightFloat>& LatLonHeightsDegreesMeters, AGeoReferencingSystem* GeoReferencingSystem, TArray<FVector>& OutUnrealLocations);
+};
@@ -0,0 +1,23 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DISBenchmarkCommandlet.generated.h"
+
+/**
+ * Runs the plugin benchmarks headless and writes the results to JSON.
+ * A world holding a GeoReferencing System with default settings is created for the benchmarks that need one, unless -NoWorld is given.
+ * Usage: UE4Editor-Cmd <Project> -run=DISBenchmark [-Filter=PDU.] [-Scale=1.0] [-Json=<FilePath>] [-Baseline=<FilePath>] [-NoWorld]
+ */
+UCLASS()
+class UDISBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDISBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
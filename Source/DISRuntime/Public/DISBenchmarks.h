@@ -0,0 +1,105 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AGeoReferencingSystem;
+class UWorld;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDISBenchmarks, Log, All);
+
+//Benchmarks are a development tool and are compiled out of shipping builds
+#if !UE_BUILD_SHIPPING
+/**
+ * Results of a single benchmark run. Metrics hold any additional named values the benchmark reports (errors, ratios, sizes).
+ */
+struct DISRUNTIME_API FDISBenchmarkResult
+{
+	FString Name;
+	int64 Operations = 0;
+	double Seconds = 0;
+	TArray<TPair<FString, double>> Metrics;
+
+	FDISBenchmarkResult() = default;
+	FDISBenchmarkResult(const FString& InName) : Name(InName) {}
+
+	double GetOperationsPerSecond() const { return Seconds > 0 ? Operations / Seconds : 0; }
+	double GetNanosecondsPerOperation() const { return Operations > 0 ? Seconds * 1e9 / Operations : 0; }
+	void AddMetric(const FString& MetricName, double Value) { Metrics.Emplace(MetricName, Value); }
+	FString ToString() const;
+};
+
+/**
+ * Information passed to every benchmark. GeoReferencingSystem may be null when running without a world,
+ * benchmarks that require it should skip themselves in that case.
+ */
+struct DISRUNTIME_API FDISBenchmarkContext
+{
+	UWorld* World = nullptr;
+	AGeoReferencingSystem* GeoReferencingSystem = nullptr;
+	//Multiplier applied to each benchmark's default problem size
+	float Scale = 1.f;
+	TArray<FDISBenchmarkResult> Results;
+
+	int32 Scaled(int32 DefaultCount) const { return FMath::Max(1, FMath::RoundToInt(DefaultCount * Scale)); }
+};
+
+typedef TFunction<void(FDISBenchmarkContext&)> FDISBenchmarkFunction;
+
+/**
+ * Returns how long the given function took to run in seconds.
+ */
+template<typename FunctionType>
+double DISTimeSeconds(FunctionType&& Function)
+{
+	const double startSeconds = FPlatformTime::Seconds();
+	Function();
+	return FPlatformTime::Seconds() - startSeconds;
+}
+
+/**
+ * Registry of all plugin benchmarks. Benchmarks register themselves at module load through FDISAutoRegisterBenchmark
+ * and can be run through the DIS.Benchmark console command.
+ */
+class DISRUNTIME_API FDISBenchmarkRegistry
+{
+public:
+	static void Register(const FString& Name, FDISBenchmarkFunction Function);
+
+	/**
+	 * Runs every benchmark whose name contains Filter (all benchmarks if empty) and returns the collected results.
+	 */
+	static TArray<FDISBenchmarkResult> Run(const FString& Filter, FDISBenchmarkContext& Context);
+
+	static TArray<FString> GetBenchmarkNames();
+
+	/**
+	 * Writes results as JSON along with the plugin version, engine version, platform, and CPU they were measured on, so runs of different releases can be compared.
+	 */
+	static FString ToJson(const TArray<FDISBenchmarkResult>& Results, const FDISBenchmarkContext& Context);
+	static bool SaveJson(const FString& FilePath, const TArray<FDISBenchmarkResult>& Results, const FDISBenchmarkContext& Context);
+
+	/**
+	 * Reads back results written by SaveJson. Returns false if the file could not be read or parsed.
+	 */
+	static bool LoadJson(const FString& FilePath, TArray<FDISBenchmarkResult>& OutResults);
+
+	/**
+	 * Logs how the nanoseconds per operation of every result changed against the baseline result of the same name.
+	 */
+	static void LogComparison(const TArray<FDISBenchmarkResult>& Results, const TArray<FDISBenchmarkResult>& BaselineResults);
+
+private:
+	static TMap<FString, FDISBenchmarkFunction>& GetBenchmarks();
+};
+
+struct FDISAutoRegisterBenchmark
+{
+	FDISAutoRegisterBenchmark(const TCHAR* Name, FDISBenchmarkFunction Function)
+	{
+		FDISBenchmarkRegistry::Register(Name, MoveTemp(Function));
+	}
+};
+
+#endif
@@ -0,0 +1,134 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DISEnumsAndStructs.h"
+#include "DISSendManager.h"
+#include "UDPSendGovernor.h"
+#include "DISBulkPublisher.generated.h"
+
+//Forward declarations
+class AGeoReferencingSystem;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDISBulkPublisher, Log, All);
+
+DECLARE_CYCLE_STAT(TEXT("BulkPublish"), STAT_BulkPublish, STATGROUP_DISSendManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("BulkPublishedEntities"), STAT_BulkPublishedEntities, STATGROUP_DISSendManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("BulkEntityStatePDUsSent"), STAT_BulkEntityStatePDUsSent, STATGROUP_DISSendManager);
+
+/**
+ * Settings shared by every entity published through the bulk publish API.
+ */
+USTRUCT(BlueprintType)
+struct DISRUNTIME_API FDISBulkPublishSettings
+{
+	GENERATED_BODY()
+
+	/**
+	 * The Force ID of the published entities.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Game Manager|Bulk Publish")
+		EForceID EntityForceID = EForceID::Other;
+	/**
+	 * The appearance of the published entities. Int representation of a collection of appearance fields.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Game Manager|Bulk Publish", Meta = (UIMin = 0, ClampMin = 0))
+		int32 EntityAppearance = 0;
+	/**
+	 * The DIS Capabilities of the published entities.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Game Manager|Bulk Publish", Meta = (UIMin = 0, ClampMin = 0))
+		int32 EntityCapabilities = 0;
+	/**
+	 * How often an Entity State PDU is sent for an entity that stays within its dead reckoning thresholds.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Game Manager|Bulk Publish", Meta = (UIMin = 0, ClampMin = 0))
+		float DISHeartbeatSeconds = 5.0f;
+	/**
+	 * The position threshold to use for dead reckoning. If the dead reckoning position deviates more than this value away from the actual position in any axis, a new Entity State PDU will be sent.
+	 * This value should be in meters.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Game Manager|Bulk Publish", Meta = (UIMin = 0, ClampMin = 0))
+		float DeadReckoningPositionThresholdMeters = 1;
+	/**
+	 * The orientation threshold to use for dead reckoning. If the dead reckoning orientation deviates more than this value away from the actual orientation, a new Entity State PDU will be sent.
+	 * This value should be in degrees.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Game Manager|Bulk Publish", Meta = (UIMin = 0, ClampMin = 0))
+		float DeadReckoningOrientationThresholdDegrees = 3;
+	/**
+	 * How many times past its threshold the dead reckoning error has to be for an update to be sent as high priority.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Game Manager|Bulk Publish", Meta = (UIMin = 1, ClampMin = 1))
+		float HighPriorityThresholdMultiple = 2;
+};
+
+/**
+ * Publishes Entity State PDUs for local entities that have no actor, such as crowd or AI agents.
+ *
+ * Each call takes the current state of every published entity as arrays, runs the same dead reckoning threshold test as the send manager
+ * over all of them in one batch, and encodes and emits only the Entity State PDUs that are due: entities seen for the first time,
+ * threshold crossings, and heartbeats. Entities are dead reckoned with FPW and keep being tracked until they are unpublished.
+ */
+class DISRUNTIME_API FDISBulkPublisher
+{
+public:
+	//Size in bytes of an encoded Entity State PDU without articulation parameters
+	static constexpr int32 EntityStatePDUSize = 144;
+
+	/**
+	 * Emits the Entity State PDUs that are due for the given entities. All views must be the same length and entity IDs should be unique.
+	 * Returns the number of PDUs emitted.
+	 * @param UnrealVelocities - Velocities in Unreal units per second.
+	 * @param NowSeconds - The current time, used for heartbeats and dead reckoning.
+	 * @param Emit - Called with the bytes, priority, and merge key of every PDU to send.
+	 */
+	int32 Publish(TArrayView<const FEntityID> EntityIDs, TArrayView<const FEntityType> EntityTypes, TArrayView<const FVector> UnrealLocations,
+		TArrayView<const FRotator> UnrealRotations, TArrayView<const FVector> UnrealVelocities, double NowSeconds, const FDISBulkPublishSettings& Settings,
+		uint8 ExerciseID, AGeoReferencingSystem* GeoReferencingSystem, TFunctionRef<void(const TArray<uint8>&, EUDPSendPriority, int64)> Emit);
+
+	/**
+	 * Stops publishing the given entities, emitting a final Entity State PDU with the deactivated appearance bit set for each one that was published.
+	 * Returns the number of entities unpublished.
+	 */
+	int32 Unpublish(TArrayView<const FEntityID> EntityIDs, TFunctionRef<void(const TArray<uint8>&, EUDPSendPriority, int64)> Emit);
+	/**
+	 * Stops publishing every entity, emitting a final deactivated Entity State PDU for each as Unpublish does.
+	 * Returns the number of entities unpublished.
+	 */
+	int32 UnpublishAll(TFunctionRef<void(const TArray<uint8>&, EUDPSendPriority, int64)> Emit);
+
+	int32 NumPublished() const { return Published.Num(); }
+
+	/**
+	 * Key identifying an entity, also used to merge deferred sends of the same entity on the send sockets.
+	 */
+	static int64 GetEntityKey(const FEntityID& EntityID);
+
+private:
+	struct FPublishedEntity
+	{
+		int64 Key;
+		double LastSentSeconds;
+		double SentLocation[3];
+		double SentLinearVelocity[3];
+		FQuat SentOrientation;
+		//The most recently emitted PDU, reused to unpublish
+		uint8 SentBytes[EntityStatePDUSize];
+	};
+
+	TArray<FPublishedEntity> Published;
+	TMap<int64, int32> PublishedIndices;
+
+	//Reused between calls so publishing does not allocate once warmed up
+	FDISSendThresholdBatch Batch;
+	TArray<int32> BatchPublishedIndices;
+	TArray<int32> DueIndices;
+	TArray<EUDPSendPriority> DuePriorities;
+	FDISVectorArrayDouble DueEcefLocations;
+	FDISVectorArrayDouble DuePsiThetaPhiRadians;
+	FDISVectorArrayDouble DueLatLonHeights;
+	FDISVectorArrayDouble DueHeadingPitchRollRadians;
+	TArray<uint8> EncodedBytes;
+};
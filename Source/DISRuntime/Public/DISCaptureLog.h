@@ -0,0 +1,137 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+
+/**
+ * On disk format of DIS capture logs.
+ *
+ * A capture is a series of append-only segment files named <CaptureName>_<Segment>.discap. Each starts with an FDISCaptureFileHeader followed by
+ * packet records, an FDISCaptureRecordHeader followed by the datagram bytes, in the order they were received. Records never span segments.
+ * Every segment has a sparse time index next to it named <CaptureName>_<Segment>.discapidx: an FDISCaptureFileHeader followed by FDISCaptureIndexEntry
+ * entries in time order, one for the first record of the segment and one for the first record at least the index interval after the previous entry.
+ * The index only speeds up seeking, a segment can always be read without it.
+ * A capture can also have a keyframe archive named <CaptureName>.diskey: an FDISCaptureFileHeader followed by keyframes, each an FDISKeyframeHeader
+ * followed by packet records holding the latest state of every entity and simulation management at that time, see DISKeyframeArchive.h.
+ * Captures can be compacted for long term storage into a columnar archive named <CaptureName>.disarc, see DISColumnarArchive.h.
+ * All values are little endian.
+ */
+namespace DISCaptureLog
+{
+	constexpr uint32 Version = 1;
+	constexpr int32 SegmentDigits = 4;
+
+	constexpr const TCHAR* SegmentExtension = TEXT(".discap");
+	constexpr const TCHAR* IndexExtension = TEXT(".discapidx");
+	constexpr const TCHAR* PcapExtension = TEXT(".pcap");
+	constexpr const TCHAR* KeyframeExtension = TEXT(".diskey");
+	constexpr const TCHAR* ArchiveExtension = TEXT(".disarc");
+
+	//Last byte of the magic of each kind of file
+	constexpr uint8 LogKind = 'L';
+	constexpr uint8 IndexKind = 'I';
+	constexpr uint8 KeyframeKind = 'K';
+	constexpr uint8 ArchiveKind = 'A';
+
+	/**
+	 * Returns the path of the given segment of a capture.
+	 */
+	inline FString GetSegmentPath(const FString& Directory, const FString& CaptureName, int32 Segment, const TCHAR* Extension)
+	{
+		return FPaths::Combine(Directory, FString::Printf(TEXT("%s_%0*d%s"), *CaptureName, SegmentDigits, Segment, Extension));
+	}
+
+	/**
+	 * Returns the path of the keyframe archive of a capture.
+	 */
+	inline FString GetKeyframePath(const FString& Directory, const FString& CaptureName)
+	{
+		return FPaths::Combine(Directory, CaptureName + KeyframeExtension);
+	}
+}
+
+#if !PLATFORM_LITTLE_ENDIAN
+#error DIS capture logs are written in native byte order and only supported on little endian platforms
+#endif
+
+struct FDISCaptureFileHeader
+{
+	//"DISCAP" then 0x00 then the kind of file
+	uint8 Magic[8];
+	uint32 Version;
+	uint32 HeaderBytes;
+	//UTC FDateTime ticks when the segment was created
+	int64 CreatedTicks;
+	uint32 Segment;
+	uint32 Reserved;
+
+	static FDISCaptureFileHeader Make(uint8 Kind, int32 Segment, int64 CreatedTicks)
+	{
+		FDISCaptureFileHeader header;
+		FMemory::Memcpy(header.Magic, "DISCAP", 6);
+		header.Magic[6] = 0;
+		header.Magic[7] = Kind;
+		header.Version = DISCaptureLog::Version;
+		header.HeaderBytes = sizeof(FDISCaptureFileHeader);
+		header.CreatedTicks = CreatedTicks;
+		header.Segment = Segment;
+		header.Reserved = 0;
+		return header;
+	}
+
+	bool IsValid(uint8 Kind) const
+	{
+		return FMemory::Memcmp(Magic, "DISCAP", 6) == 0 && Magic[6] == 0 && Magic[7] == Kind
+			&& Version == DISCaptureLog::Version && HeaderBytes >= sizeof(FDISCaptureFileHeader);
+	}
+};
+static_assert(sizeof(FDISCaptureFileHeader) == 32, "Capture file header layout changed");
+
+struct FDISCaptureRecordHeader
+{
+	//UTC FDateTime ticks when the datagram was received
+	int64 TimestampTicks;
+	uint32 PayloadBytes;
+	//IPv4 address of the sender in host byte order
+	uint32 SourceAddress;
+	uint16 SourcePort;
+	uint16 ReceiveSocketID;
+	uint32 Reserved;
+};
+static_assert(sizeof(FDISCaptureRecordHeader) == 24, "Capture record header layout changed");
+
+struct FDISCaptureIndexEntry
+{
+	int64 TimestampTicks;
+	//Offset of the record from the start of the segment file
+	int64 FileOffset;
+};
+static_assert(sizeof(FDISCaptureIndexEntry) == 16, "Capture index entry layout changed");
+
+struct FDISKeyframeHeader
+{
+	//UTC FDateTime ticks the keyframe describes the exercise at
+	int64 TimestampTicks;
+	//Position in the capture of the first record after the keyframe
+	int64 CaptureOffset;
+	int32 CaptureSegment;
+	uint32 NumRecords;
+	//Bytes of packet records following this header
+	int64 RecordBytes;
+};
+static_assert(sizeof(FDISKeyframeHeader) == 32, "Keyframe header layout changed");
+
+namespace DISCaptureLog
+{
+	/**
+	 * Returns whether a record header at the given offset lies after the file header and within a segment of the given size.
+	 * Offsets read from index and keyframe files are checked with this before the segment is read at them.
+	 */
+	inline bool IsRecordOffsetInBounds(int64 Offset, int64 SegmentBytes)
+	{
+		return Offset >= static_cast<int64>(sizeof(FDISCaptureFileHeader)) && Offset <= SegmentBytes - static_cast<int64>(sizeof(FDISCaptureRecordHeader));
+	}
+}
@@ -0,0 +1,90 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DISCaptureLog.h"
+#include "DISReplaySource.h"
+
+//Forward declarations
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDISCaptureReader, Log, All);
+
+/**
+ * Reads back a capture log written by the Capture Subsystem, see DISCaptureLog.h for the format.
+ *
+ * Segments are memory mapped where the platform supports it and loaded whole otherwise, so records are read in place without copying.
+ * A segment cut short by a crash is read up to its last whole record.
+ */
+class DISRUNTIME_API FDISCaptureReader : public IDISReplaySource
+{
+public:
+	/**
+	 * Position of a record in the capture.
+	 */
+	struct FPosition
+	{
+		int32 Segment = 0;
+		int64 Offset = sizeof(FDISCaptureFileHeader);
+	};
+
+	FDISCaptureReader() = default;
+	virtual ~FDISCaptureReader();
+
+	FDISCaptureReader(const FDISCaptureReader&) = delete;
+	FDISCaptureReader& operator=(const FDISCaptureReader&) = delete;
+
+	/**
+	 * Opens every segment of a capture and moves to its first record. Returns false if no valid segment was found.
+	 * @param Directory - Directory the capture was written to.
+	 * @param CaptureName - Name the segment files of the capture start with.
+	 */
+	bool Open(const FString& Directory, const FString& CaptureName);
+	void Close();
+
+	bool IsOpen() const { return Segments.Num() > 0; }
+	int32 GetNumSegments() const { return Segments.Num(); }
+	int64 GetTotalBytes() const;
+
+	// Begin IDISReplaySource
+	virtual bool ReadNext(FDISCaptureRecordHeader& OutRecord, TArrayView<const uint8>& OutPayload) override;
+	virtual bool PeekNextTicks(int64& OutTicks) override;
+	/**
+	 * Uses the segment indexes to skip ahead.
+	 */
+	virtual void SeekToTicks(int64 Ticks) override;
+	virtual void Rewind() override { Position = FPosition(); }
+	virtual int64 GetStartTicks() const override { return StartTicks; }
+	virtual int64 GetEndTicks() const override { return EndTicks; }
+	// End IDISReplaySource
+
+	FPosition GetPosition() const { return Position; }
+	void SetPosition(const FPosition& InPosition) { Position = InPosition; }
+
+private:
+	struct FSegment
+	{
+		IMappedFileHandle* MappedFile = nullptr;
+		IMappedFileRegion* MappedRegion = nullptr;
+		//Used when the platform cannot map the segment
+		TArray<uint8> LoadedBytes;
+
+		const uint8* Data = nullptr;
+		int64 NumBytes = 0;
+		TArray<FDISCaptureIndexEntry> Index;
+	};
+
+	bool OpenSegment(const FString& SegmentPath, const FString& IndexPath, FSegment& OutSegment);
+	/**
+	 * Moves to the next segment when the current one has no whole record left. Returns false at the end of the capture.
+	 */
+	bool SkipToReadableRecord();
+
+	//Held by pointer so the views handed out stay put when the array grows
+	TArray<TUniquePtr<FSegment>> Segments;
+	FPosition Position;
+	int64 StartTicks = 0;
+	int64 EndTicks = 0;
+};
@@ -0,0 +1,125 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "DISCaptureSubsystem.generated.h"
+
+//Forward declarations
+class FDISCaptureWriter;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDISCapture, Log, All);
+
+UENUM(BlueprintType)
+enum class EDISCaptureFormat : uint8
+{
+	//Indexed capture log that can be replayed and sought by the Replay Subsystem, see DISCaptureLog.h
+	CaptureLog,
+	//Classic pcap with synthesized IPv4 and UDP headers that Wireshark and tcpdump can read
+	Pcap
+};
+
+USTRUCT(BlueprintType)
+struct FDISCaptureSettings
+{
+	GENERATED_BODY()
+
+	/** File format to write the capture in. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Capture Subsystem|Structs")
+		EDISCaptureFormat Format = EDISCaptureFormat::CaptureLog;
+
+	/** Directory to write the capture to. Defaults to Saved/DISCaptures when empty. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Capture Subsystem|Structs")
+		FString Directory;
+
+	/** Size of each preallocated buffer that received datagrams are copied into before being written. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Capture Subsystem|Structs", Meta = (UIMin = 1, ClampMin = 1))
+		int32 BufferMegabytes = 4;
+
+	/** Number of preallocated buffers. Datagrams are dropped only when every buffer is waiting to be written. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Capture Subsystem|Structs", Meta = (UIMin = 2, ClampMin = 2))
+		int32 NumBuffers = 32;
+
+	/** Size at which the log moves on to a new segment file. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Capture Subsystem|Structs", Meta = (UIMin = 1, ClampMin = 1))
+		int32 MaxSegmentMegabytes = 1024;
+
+	/** Time between entries in the sparse time index used for seeking. Pcap captures have no index. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Capture Subsystem|Structs", Meta = (UIMin = 0.01, ClampMin = 0.01))
+		float IndexIntervalSeconds = 1.0f;
+
+	/** Longest time a received datagram waits in a partly filled buffer before it is written. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Capture Subsystem|Structs", Meta = (UIMin = 0.01, ClampMin = 0.01))
+		float FlushIntervalSeconds = 0.5f;
+
+	/** Capture time between keyframes of the exercise state written next to capture logs for fast seeking in replays. Set to 0 to write no keyframes. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Capture Subsystem|Structs", Meta = (UIMin = 0, ClampMin = 0))
+		float KeyframeIntervalSeconds = 10.0f;
+};
+
+USTRUCT(BlueprintType)
+struct FDISCaptureCounters
+{
+	GENERATED_BODY()
+
+	/** Datagrams written to the log. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Capture Subsystem|Structs")
+		int64 PacketsWritten = 0;
+
+	/** Datagrams dropped because every buffer was full or the log could not be written. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Capture Subsystem|Structs")
+		int64 PacketsDropped = 0;
+
+	/** Bytes written to the log, including record headers. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Capture Subsystem|Structs")
+		int64 BytesWritten = 0;
+
+	/** Segment files started. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Capture Subsystem|Structs")
+		int32 SegmentsWritten = 0;
+};
+
+/**
+ * Records every datagram received by the UDP Subsystem to an indexed capture log for after action review, see DISCaptureLog.h for the format.
+ * Datagrams are copied into preallocated buffers on the receive threads and written by a dedicated writer thread, so the game thread is never involved.
+ */
+UCLASS()
+class DISRUNTIME_API UDISCaptureSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Begin USubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End USubsystem
+
+	/**
+	 * Starts capturing every received datagram. Stops any capture already running.
+	 * Returns whether or not the capture was started.
+	 * @param CaptureName - Name the segment files of the capture start with.
+	 * @param Settings - The buffering, segmenting, and indexing settings to use.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Capture Subsystem")
+		bool StartCapture(const FString& CaptureName, FDISCaptureSettings Settings);
+
+	/**
+	 * Stops capturing and writes out every datagram received before the call.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Capture Subsystem")
+		void StopCapture();
+
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Capture Subsystem")
+		bool IsCapturing() const { return Writer.IsValid(); }
+
+	/**
+	 * Returns the written and dropped counts of the running capture, or of the last capture once stopped.
+	 */
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Capture Subsystem")
+		FDISCaptureCounters GetCaptureCounters() const;
+
+private:
+	TSharedPtr<FDISCaptureWriter, ESPMode::ThreadSafe> Writer;
+	FDISCaptureCounters LastCaptureCounters;
+};
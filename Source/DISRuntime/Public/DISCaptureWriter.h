@@ -0,0 +1,122 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "Containers/Queue.h"
+#include "DISCaptureLog.h"
+#include "DISKeyframeArchive.h"
+#include "DISCaptureSubsystem.h"
+#include "UDPSubsystem.h"
+
+//Forward declarations
+class FRunnableThread;
+class FEvent;
+class IFileHandle;
+
+/**
+ * Writes received datagrams to a segmented capture log.
+ *
+ * Receive threads copy each datagram into the current buffer from a preallocated pool. Full buffers, and partly filled ones older than the flush interval,
+ * are handed to the writer thread, which appends them to the current segment and its index and returns them to the pool.
+ * A datagram is only dropped when no buffer is free, so the pool size sets how long a stall of the disk can be ridden out.
+ * Pcap captures are buffered the same way and converted to pcap records on the writer thread.
+ * Capture logs also get a keyframe archive, written on the writer thread from the records as they are written.
+ */
+class DISRUNTIME_API FDISCaptureWriter : public FRunnable, public IUDPReceiveTap
+{
+public:
+	FDISCaptureWriter(const FString& InDirectory, const FString& InCaptureName, const FDISCaptureSettings& Settings);
+	virtual ~FDISCaptureWriter();
+
+	/**
+	 * Opens the first segment and starts the writer thread. Returns false if the segment could not be created.
+	 */
+	bool Open();
+	/**
+	 * Writes everything captured so far and stops the writer thread. No more datagrams may be captured once called.
+	 */
+	void Close();
+
+	FDISCaptureCounters GetCounters() const;
+
+	// Begin IUDPReceiveTap
+	virtual void OnDatagramReceived(TArrayView<const uint8> Bytes, const FIPv4Endpoint& Sender, const FIPv4Endpoint& Receiver, int32 ReceiveSocketID) override;
+	// End IUDPReceiveTap
+
+	// Begin FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End FRunnable
+
+private:
+	struct FCaptureBuffer
+	{
+		TArray<uint8> Bytes;
+		int32 NumBytes = 0;
+		int32 NumPackets = 0;
+		double FirstPacketSeconds = 0;
+		//Index entries with offsets from the start of the buffer
+		TArray<FDISCaptureIndexEntry> IndexEntries;
+	};
+
+	/**
+	 * Queues the partly filled current buffer for writing if it is older than the flush interval, or always when Force is set.
+	 */
+	void HandOverCurrentBuffer(bool Force);
+	void WriteBuffer(FCaptureBuffer& Buffer);
+	/**
+	 * Rewrites the records of a buffer as pcap records with IPv4 and UDP headers into PcapBytes.
+	 */
+	void ConvertBufferToPcap(const FCaptureBuffer& Buffer);
+	/**
+	 * Feeds the records of a buffer just written at the given segment offset to the keyframe writer.
+	 */
+	void AddBufferToKeyframes(const FCaptureBuffer& Buffer, int64 SegmentOffset);
+	bool OpenSegment(int32 Segment);
+	void CloseSegment();
+
+	FString Directory;
+	FString CaptureName;
+	EDISCaptureFormat Format;
+	int32 BufferBytes;
+	int64 MaxSegmentBytes;
+	int64 IndexIntervalTicks;
+	double FlushIntervalSeconds;
+	float KeyframeIntervalSeconds;
+
+	//Receive thread side, guarded by ProducerLock
+	FCriticalSection ProducerLock;
+	int32 CurrentBuffer = INDEX_NONE;
+	int64 NextIndexTicks = 0;
+	//Address and port of each receive socket, for the synthesized headers of pcap captures
+	TMap<uint16, FIPv4Endpoint> ReceiveEndpoints;
+
+	TArray<FCaptureBuffer> Buffers;
+	TQueue<int32, EQueueMode::Mpsc> FreeBuffers;
+	TQueue<int32, EQueueMode::Mpsc> FullBuffers;
+
+	//Writer thread side
+	IFileHandle* SegmentFile = nullptr;
+	IFileHandle* IndexFile = nullptr;
+	int32 SegmentNumber = -1;
+	int64 SegmentBytesWritten = 0;
+	int64 SegmentHeaderBytes = 0;
+	TArray<uint8> PcapBytes;
+	TArray<FDISCaptureIndexEntry> PendingIndexEntries;
+	TUniquePtr<FDISKeyframeWriter> KeyframeWriter;
+	bool WriteErrorLogged = false;
+
+	FRunnableThread* Thread = nullptr;
+	FEvent* WakeEvent = nullptr;
+	FThreadSafeBool StopRequested;
+
+	FThreadSafeCounter64 PacketsWritten;
+	FThreadSafeCounter64 PacketsDropped;
+	FThreadSafeCounter64 BytesWritten;
+	FThreadSafeCounter SegmentsWritten;
+};
@@ -0,0 +1,284 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DISCaptureLog.h"
+#include "DISReplaySource.h"
+#include "DISColumnarArchive.generated.h"
+
+//Forward declarations
+class IFileHandle;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDISArchive, Log, All);
+
+UENUM(BlueprintType)
+enum class EDISArchiveCodec : uint8
+{
+	//Columns are stored as encoded, for measuring the column encoding alone
+	None,
+	//Fast to compress and very fast to decompress
+	LZ4,
+	//Smaller than LZ4 but several times slower to compress and decompress
+	Zlib
+};
+
+USTRUCT(BlueprintType)
+struct FDISArchiveStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Replay Subsystem|Structs")
+		int64 Packets = 0;
+
+	/** Size of the datagrams in capture log layout, record headers included. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Replay Subsystem|Structs")
+		int64 RawBytes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Replay Subsystem|Structs")
+		int64 ArchiveBytes = 0;
+
+	/** Raw bytes per archive byte. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Replay Subsystem|Structs")
+		float CompressionRatio = 0;
+
+	/** Raw megabytes encoded and compressed per second. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Replay Subsystem|Structs")
+		float EncodeMegabytesPerSecond = 0;
+
+	/** Raw megabytes decompressed and decoded per second. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Replay Subsystem|Structs")
+		float DecodeMegabytesPerSecond = 0;
+
+	/** True when every decoded datagram matched the original byte for byte. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Replay Subsystem|Structs")
+		bool Verified = false;
+};
+
+/**
+ * On disk format of columnar archives.
+ *
+ * An archive is an FDISCaptureFileHeader followed by blocks. Each block is an FDISArchiveBlockHeader, a table of NumColumns FDISArchiveColumnHeader entries,
+ * and the stored columns one after the other. A block holds up to a few tens of thousands of datagrams and decodes on its own, so archives can be sought block by block.
+ *
+ * Entity State PDUs are split into one column per group of fields. Every field is XORed with the same field of the entity's previous Entity State PDU in the block,
+ * and the PDU timestamp is delta encoded, so fields that did not change become runs of zeros. Fixed width columns are then transposed so that the bytes of equal
+ * significance of every entry lie together before the column is compressed. Any other datagram is stored as is in the raw column.
+ * Decoding rebuilds every datagram and its record header byte for byte.
+ */
+namespace DISColumnarFormat
+{
+	enum EColumn : int32
+	{
+		//Per record: zigzag varint timestamp delta, varint payload size, and kind
+		Records,
+		//Per record: source address, port, receive socket, and reserved, XORed with the previous record's
+		Sources,
+		//Datagrams that are not Entity State PDUs
+		Raw,
+		//Per Entity State PDU: varint slot of a known entity, or the entity ID of a new one
+		EntityRefs,
+		//Per Entity State PDU: zigzag varint delta of the PDU timestamp
+		PDUTimestamps,
+		//Fields of the Entity State PDU, XORed with the entity's previous ones
+		PDUHeader,
+		PDULength,
+		EntityInfo,
+		Velocity,
+		Location,
+		Orientation,
+		Appearance,
+		DeadReckoning,
+		Marking,
+		//Variable parameter records, XORed with the previous ones when there are as many, stored as is otherwise
+		Articulations,
+		NumColumns
+	};
+
+	enum ERecordKind : uint8
+	{
+		RawDatagram,
+		NewEntityState,
+		EntityState
+	};
+}
+
+struct FDISArchiveBlockHeader
+{
+	//UTC FDateTime ticks of the first and last datagram in the block
+	int64 FirstTicks;
+	int64 LastTicks;
+	uint32 NumRecords;
+	//Size of the block's datagrams in capture log layout, record headers included
+	uint32 RecordBytes;
+	//Size of the stored columns following the column table
+	uint32 StoredBytes;
+	//EDISArchiveCodec
+	uint8 Codec;
+	uint8 NumColumns;
+	uint16 Reserved;
+};
+static_assert(sizeof(FDISArchiveBlockHeader) == 32, "Archive block header layout changed");
+
+struct FDISArchiveColumnHeader
+{
+	uint32 RawBytes;
+	//Equal to RawBytes when the column is stored uncompressed
+	uint32 StoredBytes;
+};
+static_assert(sizeof(FDISArchiveColumnHeader) == 8, "Archive column header layout changed");
+
+/**
+ * Splits datagrams into the columns of one archive block.
+ */
+class DISRUNTIME_API FDISColumnarBlockEncoder
+{
+public:
+	void AddDatagram(const FDISCaptureRecordHeader& Record, TArrayView<const uint8> Payload);
+
+	int32 GetNumRecords() const { return NumRecords; }
+	int64 GetRecordBytes() const { return RecordBytes; }
+
+	/**
+	 * Compresses the columns into a block, header included, and starts a new block.
+	 */
+	void FinishBlock(EDISArchiveCodec Codec, TArray<uint8>& OutBlock);
+
+private:
+	void Reset();
+
+	TArray<uint8> Columns[DISColumnarFormat::NumColumns];
+	//Previous Entity State PDU of every entity in the block, in the order they were first seen
+	TMap<uint64, int32> EntitySlots;
+	TArray<TArray<uint8>> SlotPDUs;
+
+	FDISCaptureRecordHeader PreviousRecord;
+	int32 NumRecords = 0;
+	int64 RecordBytes = 0;
+	int64 FirstTicks = 0;
+	TArray<uint8> TransposedBytes;
+	TArray<uint8> CompressedBytes;
+};
+
+/**
+ * Rebuilds the datagrams of an archive block.
+ */
+class DISRUNTIME_API FDISColumnarBlockDecoder
+{
+public:
+	/**
+	 * Decodes a block, header included, into records in capture log layout. Returns false if the block is damaged.
+	 */
+	bool DecodeBlock(TArrayView<const uint8> Block, TArray<uint8>& OutRecords);
+
+private:
+	TArray<uint8> Columns[DISColumnarFormat::NumColumns];
+	TArray<TArray<uint8>> SlotPDUs;
+	TArray<uint8> TransposedBytes;
+};
+
+/**
+ * Writes datagrams to a columnar archive.
+ */
+class DISRUNTIME_API FDISColumnarArchiveWriter
+{
+public:
+	~FDISColumnarArchiveWriter();
+
+	/**
+	 * @param FilePath - The archive to create, replacing any already there.
+	 * @param InCodec - Compression applied to every column.
+	 * @param InBlockRecords - Datagrams per block. Larger blocks compress better but seek coarser.
+	 */
+	bool Open(const FString& FilePath, EDISArchiveCodec InCodec, int32 InBlockRecords = 65536);
+	/**
+	 * Writes the last block and closes the archive.
+	 */
+	void Close();
+	bool IsOpen() const { return File != nullptr; }
+
+	void AddDatagram(const FDISCaptureRecordHeader& Record, TArrayView<const uint8> Payload);
+
+	int64 GetRecordBytes() const { return RecordBytes; }
+	int64 GetArchiveBytes() const { return ArchiveBytes; }
+	/**
+	 * Time spent encoding and compressing, not counting writing to disk.
+	 */
+	double GetEncodeSeconds() const { return EncodeSeconds; }
+
+	/**
+	 * Compacts a capture log into an archive, then decodes the archive and checks every datagram against the capture.
+	 * @param Directory - Directory the capture was written to.
+	 * @param CaptureName - Name the segment files of the capture start with.
+	 * @param ArchivePath - The archive to create.
+	 * @param Codec - Compression applied to every column.
+	 */
+	static bool ArchiveCapture(const FString& Directory, const FString& CaptureName, const FString& ArchivePath, EDISArchiveCodec Codec, FDISArchiveStats& OutStats);
+
+private:
+	void WriteBlock();
+
+	IFileHandle* File = nullptr;
+	EDISArchiveCodec Codec = EDISArchiveCodec::LZ4;
+	int32 BlockRecords = 65536;
+	FDISColumnarBlockEncoder Encoder;
+	TArray<uint8> BlockBytes;
+
+	int64 RecordBytes = 0;
+	int64 ArchiveBytes = 0;
+	double EncodeSeconds = 0;
+};
+
+/**
+ * Reads a columnar archive back for replay, decoding one block at a time.
+ */
+class DISRUNTIME_API FDISColumnarArchiveReader : public IDISReplaySource
+{
+public:
+	FDISColumnarArchiveReader() = default;
+	virtual ~FDISColumnarArchiveReader();
+
+	FDISColumnarArchiveReader(const FDISColumnarArchiveReader&) = delete;
+	FDISColumnarArchiveReader& operator=(const FDISColumnarArchiveReader&) = delete;
+
+	/**
+	 * Opens an archive and reads its block headers. Returns false if it could not be read or has no blocks.
+	 */
+	bool Open(const FString& FilePath);
+	void Close();
+	bool IsOpen() const { return File != nullptr; }
+
+	// Begin IDISReplaySource
+	virtual bool ReadNext(FDISCaptureRecordHeader& OutRecord, TArrayView<const uint8>& OutPayload) override;
+	virtual bool PeekNextTicks(int64& OutTicks) override;
+	virtual void SeekToTicks(int64 Ticks) override;
+	virtual void Rewind() override;
+	virtual int64 GetStartTicks() const override;
+	virtual int64 GetEndTicks() const override;
+	// End IDISReplaySource
+
+private:
+	struct FBlock
+	{
+		FDISArchiveBlockHeader Header;
+		int64 FileOffset;
+	};
+
+	/**
+	 * Loads blocks from the given one on until one decodes with records left in it. Returns false at the end of the archive.
+	 */
+	bool LoadBlock(int32 Block);
+	/**
+	 * Moves to the next block when the current one has been read. Returns false at the end of the archive.
+	 */
+	bool SkipToReadableRecord();
+
+	IFileHandle* File = nullptr;
+	TArray<FBlock> Blocks;
+	FDISColumnarBlockDecoder Decoder;
+	TArray<uint8> BlockBytes;
+
+	int32 CurrentBlock = INDEX_NONE;
+	TArray<uint8> Records;
+	int32 RecordOffset = 0;
+};
@@ -0,0 +1,194 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DISEnumsAndStructs.h"
+#include "DISDeadReckoningAnalyzer.generated.h"
+
+//Forward declarations
+class IDISReplaySource;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDISDeadReckoningAnalyzer, Log, All);
+
+//The analyzer is a development tool and is compiled out of shipping builds, leaving only its settings and results
+#if !UE_BUILD_SHIPPING
+/**
+ * The actual state of an entity at one moment, in the frames Entity State PDUs use.
+ */
+struct FDISTruthSample
+{
+	double Seconds = 0;
+	FEarthCenteredEarthFixedDouble EcefLocation;
+	FPsiThetaPhi PsiThetaPhiRadians;
+};
+
+/**
+ * The recorded path of one entity, with samples in increasing time order.
+ */
+struct FDISTruthTrajectory
+{
+	//Entity ID or actor name the samples were recorded from
+	FString Name;
+	//Entity type as Kind:Domain:Country:Category:Subcategory:Specific:Extra
+	FString EntityType;
+	TArray<FDISTruthSample> Samples;
+};
+
+#endif
+
+USTRUCT(BlueprintType)
+struct FDISDeadReckoningSweepSettings
+{
+	GENERATED_BODY()
+
+	/** Dead reckoning algorithms to try. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		TArray<EDeadReckoningAlgorithm> Algorithms = { EDeadReckoningAlgorithm::Static, EDeadReckoningAlgorithm::FPW, EDeadReckoningAlgorithm::RPW, EDeadReckoningAlgorithm::RVW,
+			EDeadReckoningAlgorithm::FVW, EDeadReckoningAlgorithm::FPB, EDeadReckoningAlgorithm::RPB, EDeadReckoningAlgorithm::RVB, EDeadReckoningAlgorithm::FVB };
+
+	/** Values of DeadReckoningPositionThresholdMeters to try. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		TArray<float> PositionThresholdsMeters = { 0.1f, 0.25f, 0.5f, 1, 2, 5 };
+
+	/** Values of DeadReckoningOrientationThresholdDegrees to try. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		TArray<float> OrientationThresholdsDegrees = { 3 };
+
+	/** Values of DISHeartbeatSeconds to try. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		TArray<float> HeartbeatsSeconds = { 5 };
+
+	/** EntityStateCalculationRate of the simulated send components. Velocities and accelerations are finite differences over this interval, as in the send component. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs", Meta = (ClampMin = 0.001))
+		float EntityStateCalculationRate = 0.1f;
+
+	/** Frame rate of the simulated sender. Trajectories are resampled to it, interpolating between their samples. Zero or less ticks on the recorded samples instead. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		float TickRateHertz = 60;
+
+	/** Trajectories are split where samples are further apart than this, so that an entity dropping out of a capture is not interpolated across. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs", Meta = (ClampMin = 0.01))
+		float MaxSampleGapSeconds = 10;
+
+	/** Number of entity type fields trajectories are grouped by, from 0 for a single group up to 7 for the full entity type. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs", Meta = (ClampMin = 0, ClampMax = 7))
+		int32 EntityTypeFields = 7;
+
+	/** Builds the Pareto fronts on the max position error instead of the RMS position error. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		bool ParetoOnMaxError = false;
+};
+
+USTRUCT(BlueprintType)
+struct FDISDeadReckoningConfiguration
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		EDeadReckoningAlgorithm Algorithm = EDeadReckoningAlgorithm::FPW;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		float PositionThresholdMeters = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		float OrientationThresholdDegrees = 3;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		float HeartbeatSeconds = 5;
+};
+
+/**
+ * How one configuration did across every trajectory of an entity type group.
+ * Errors are those of a receiver dead reckoning the sent PDUs with no latency, sampled on every tick of the simulated sender.
+ */
+USTRUCT(BlueprintType)
+struct FDISDeadReckoningTradeoff
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		FString EntityTypeGroup;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		FDISDeadReckoningConfiguration Configuration;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		int32 NumTrajectories = 0;
+
+	/** Entity State PDUs sent per second per entity, initial PDUs included. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		float PDUsPerSecond = 0;
+
+	/** Share of the PDUs that were sent for leaving a threshold rather than for the heartbeat. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		float ThresholdShare = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		float RmsPositionErrorMeters = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		float MaxPositionErrorMeters = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		float RmsOrientationErrorDegrees = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		float MaxOrientationErrorDegrees = 0;
+
+	/** No other configuration of the group sends fewer PDUs without a larger position error. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Dead Reckoning Analyzer|Structs")
+		bool ParetoOptimal = false;
+};
+
+#if !UE_BUILD_SHIPPING
+/**
+ * Replays recorded truth trajectories through the send decision of UDISSendComponent and the UDeadReckoning_BPFL algorithms,
+ * to find which algorithm, thresholds, and heartbeat give the fewest Entity State PDUs for an acceptable dead reckoning error.
+ * The threshold tests, dead reckoning parameters, angular velocity, and body acceleration estimates are the send component's static functions.
+ * The linear velocities are finite differences of the ECEF trajectory rather than of the actor location converted from engine axes.
+ * It is a model of the plain send decision, and does not model:
+ * - Scheduled threshold checks. Thresholds are checked on every tick, which can send slightly earlier than a check scheduled from the observed peak accelerations.
+ * - Early heartbeats. Heartbeats are sent once DISHeartbeatSeconds has passed, not brought forward into the send manager's lookahead or spread by phase.
+ * - Observer distance scaling. Thresholds and heartbeats are never scaled.
+ * - Send priorities and bandwidth budgets, latency, or packet loss. Every PDU reaches the receiver on the tick it is sent.
+ */
+class DISRUNTIME_API FDISDeadReckoningAnalyzer
+{
+public:
+	/**
+	 * Loads trajectories from a CSV file with a Seconds,Entity,EntityType,EcefX,EcefY,EcefZ,Psi,Theta,Phi header, as written by DIS.DeadReckoning Record.
+	 * Rows may be in any order. Returns false if the file could not be read or has no rows.
+	 */
+	static bool LoadTrajectoriesFromCsv(const FString& FilePath, TArray<FDISTruthTrajectory>& OutTrajectories);
+
+	/**
+	 * Loads the location and orientation of every Entity State PDU in a capture, pcap file, or archive as the trajectories of their entities.
+	 * Captured PDUs only make good truth if they were sent at a high fixed rate, such as with thresholds of zero, as the trajectories are interpolated between them.
+	 * Returns the number of Entity State PDUs read.
+	 */
+	static int32 LoadTrajectoriesFromReplaySource(IDISReplaySource& Source, TArray<FDISTruthTrajectory>& OutTrajectories);
+
+	/**
+	 * Simulates every combination of the swept settings on every trajectory, spread across all cores, and marks the Pareto front of each entity type group.
+	 * Results are ordered by group and then by PDUs per second.
+	 */
+	static TArray<FDISDeadReckoningTradeoff> RunSweep(const TArray<FDISTruthTrajectory>& Trajectories, const FDISDeadReckoningSweepSettings& Settings);
+
+	/**
+	 * Formats the Pareto front of every entity type group as a table for the log.
+	 */
+	static FString FormatParetoTables(const TArray<FDISDeadReckoningTradeoff>& Results);
+
+	/**
+	 * Writes every result as CSV, with the Pareto front flagged. Returns false if the file could not be written.
+	 */
+	static bool SaveResultsToCsv(const TArray<FDISDeadReckoningTradeoff>& Results, const FString& FilePath);
+
+	/**
+	 * Parses sweep settings from key=value pairs, with lists separated by +, such as Algorithms=FPW+RVW Thresholds=0.5+1+2 Heartbeats=5+10.
+	 */
+	static void ParseSettings(const TCHAR* Params, FDISDeadReckoningSweepSettings& InOutSettings);
+};
+
+#endif
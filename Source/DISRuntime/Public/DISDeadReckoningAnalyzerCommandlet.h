@@ -0,0 +1,25 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DISDeadReckoningAnalyzerCommandlet.generated.h"
+
+/**
+ * Sweeps dead reckoning algorithms, thresholds, and heartbeats over recorded trajectories and reports the PDU rate against the dead reckoning error of each.
+ * Trajectories come from a CSV written by DIS.DeadReckoning Record, a capture, a pcap file, or an archive. Any combination may be given.
+ * Usage: UE4Editor-Cmd.exe <Project> -run=DISDeadReckoningAnalyzer [-Csv=<FilePath>] [-Capture=<CaptureName> [-Dir=...]] [-Pcap=<FilePath>] [-Archive=<FilePath>]
+ *        [-Algorithms=FPW+RVW+...] [-Positions=0.1+0.5+1] [-Orientations=3] [-Heartbeats=5] [-CalculationRate=0.1] [-TickRate=60] [-MaxGap=10] [-TypeFields=7]
+ *        [-Pareto=RMS|Max] [-Output=<FilePath>]
+ */
+UCLASS()
+class UDISDeadReckoningAnalyzerCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDISDeadReckoningAnalyzerCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
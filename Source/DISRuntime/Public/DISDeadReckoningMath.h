@@ -0,0 +1,119 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+//Only glm, so the dead reckoning math can also be built into the standalone benchmark harness
+#include "glm/glm.hpp"
+#include "glm/gtc/constants.hpp"
+
+/**
+ * Inline dead reckoning equations of IEEE 1278.1 Annex E shared by the Dead Reckoning BPFL and the standalone benchmark harness.
+ * Positions are ECEF meters, velocities meters per second, and orientations Psi, Theta, Phi radians.
+ */
+namespace DISDeadReckoningMath
+{
+	//Minimum significant rate = 1deg/5sec
+	constexpr double MinRotationRate = 0.2 * 3.14159265358979323846 / 180;
+
+	/**
+	 * Returns the skew symmetric matrix that forms the cross product with N.
+	 */
+	inline glm::dmat3 CreateNCrossXMatrix(const glm::dvec3& NVector)
+	{
+		return glm::dmat3(0, NVector.z, -NVector.y, -NVector.z, 0, NVector.x, NVector.y, -NVector.x, 0);
+	}
+
+	inline glm::dvec3 CalculateDeadReckonedPosition(const glm::dvec3& PositionVector, const glm::dvec3& VelocityVector, const glm::dvec3& AccelerationVector, double DeltaTime)
+	{
+		return PositionVector + (VelocityVector * DeltaTime) + (0.5 * AccelerationVector * (DeltaTime * DeltaTime));
+	}
+
+	inline glm::dmat3 CreateDeadReckoningMatrix(glm::dvec3 AngularVelocityVector, double DeltaTime)
+	{
+		double angularVelocityMagnitude = glm::length(AngularVelocityVector);
+		if (angularVelocityMagnitude == 0)
+		{
+			angularVelocityMagnitude = 1e-5;
+			AngularVelocityVector += glm::dvec3(1e-5);
+		}
+
+		const glm::dmat3 angularVelocityMatrix = glm::dmat3(AngularVelocityVector, glm::dvec3(0), glm::dvec3(0));
+		const glm::dmat3 angularVelocity = angularVelocityMatrix * glm::transpose(angularVelocityMatrix);
+
+		const double cosOmega = glm::cos(angularVelocityMagnitude * DeltaTime);
+		const double sinOmega = glm::sin(angularVelocityMagnitude * DeltaTime);
+
+		return (((1 - cosOmega) / (angularVelocityMagnitude * angularVelocityMagnitude)) * angularVelocity) +
+			(cosOmega * glm::dmat3(1)) -
+			(sinOmega / angularVelocityMagnitude * CreateNCrossXMatrix(AngularVelocityVector));
+	}
+
+	inline glm::dmat3 GetEntityOrientationMatrix(double PsiRadians, double ThetaRadians, double PhiRadians)
+	{
+		const double cosPsi = glm::cos(PsiRadians);
+		const double sinPsi = glm::sin(PsiRadians);
+		const double cosTheta = glm::cos(ThetaRadians);
+		const double sinTheta = glm::sin(ThetaRadians);
+		const double cosPhi = glm::cos(PhiRadians);
+		const double sinPhi = glm::sin(PhiRadians);
+
+		const glm::dmat3 headingRotationMatrix = glm::dmat3(cosPsi, -sinPsi, 0, sinPsi, cosPsi, 0, 0, 0, 1);
+		const glm::dmat3 pitchRotationMatrix = glm::dmat3(cosTheta, 0, sinTheta, 0, 1, 0, -sinTheta, 0, cosTheta);
+		const glm::dmat3 rollRotationMatrix = glm::dmat3(1, 0, 0, 0, cosPhi, -sinPhi, 0, sinPhi, cosPhi);
+
+		return rollRotationMatrix * pitchRotationMatrix * headingRotationMatrix;
+	}
+
+	inline void CalculateDeadReckonedOrientation(double PsiRadians, double ThetaRadians, double PhiRadians, const glm::dvec3& AngularVelocityVector, double DeltaTime,
+		double& OutPsiRadians, double& OutThetaRadians, double& OutPhiRadians)
+	{
+		const glm::dmat3 orientationMatrix = CreateDeadReckoningMatrix(AngularVelocityVector, DeltaTime) * GetEntityOrientationMatrix(PsiRadians, ThetaRadians, PhiRadians);
+
+		OutThetaRadians = glm::asin(-orientationMatrix[2][0]);
+
+		//Special case for |Theta| = pi/2
+		double cosThetaRadians = 1e-5;
+		if (glm::abs(OutThetaRadians) != glm::half_pi<double>())
+		{
+			cosThetaRadians = glm::cos(OutThetaRadians);
+		}
+		OutPsiRadians = glm::acos(glm::clamp(orientationMatrix[0][0] / cosThetaRadians, -1.0, 1.0)) * (glm::abs(orientationMatrix[1][0]) / orientationMatrix[1][0]);
+		OutPhiRadians = glm::acos(glm::clamp(orientationMatrix[2][2] / cosThetaRadians, -1.0, 1.0)) * (glm::abs(orientationMatrix[2][1]) / orientationMatrix[2][1]);
+	}
+
+	/**
+	 * Dead reckons a position with the body axis velocity, acceleration, and angular velocity of the body algorithms.
+	 * @param EntityOrientation - Psi, Theta, Phi radians of the entity when the velocities were sent.
+	 */
+	inline glm::dvec3 GetEntityBodyDeadReckonedPosition(const glm::dvec3& InitialPositionVector, const glm::dvec3& BodyVelocityVector, const glm::dvec3& BodyLinearAccelerationVector,
+		const glm::dvec3& BodyAngularVelocityVector, const glm::dvec3& EntityOrientation, double DeltaTime)
+	{
+		const glm::dmat3 skewMatrix = CreateNCrossXMatrix(BodyAngularVelocityVector);
+		const glm::dvec3 bodyAccelerationVector = BodyLinearAccelerationVector - (skewMatrix * BodyVelocityVector);
+
+		const glm::dmat3 inverseInitialOrientationMatrix = glm::transpose(GetEntityOrientationMatrix(EntityOrientation.x, EntityOrientation.y, EntityOrientation.z));
+
+		const glm::dmat3 omegaMatrix = glm::dmat3(BodyAngularVelocityVector, glm::dvec3(0), glm::dvec3(0)) * glm::transpose(glm::dmat3(BodyAngularVelocityVector, glm::dvec3(0), glm::dvec3(0)));
+		const double w = glm::length(BodyAngularVelocityVector);
+
+		glm::dmat3 r1;
+		glm::dmat3 r2;
+		if (w < MinRotationRate)
+		{
+			r1 = glm::dmat3(1) * DeltaTime;
+			r2 = glm::dmat3(1) * (DeltaTime * DeltaTime / 2);
+		}
+		else
+		{
+			const double wt = w * DeltaTime;
+			const double sinWt = glm::sin(wt);
+			const double cosWt = glm::cos(wt);
+			const double w2 = w * w;
+
+			r1 = ((wt - sinWt) / (w2 * w) * omegaMatrix) + (sinWt / w * glm::dmat3(1)) + ((1 - cosWt) / w2 * skewMatrix);
+			r2 = ((0.5 * wt * wt - cosWt - wt * sinWt + 1) / (w2 * w2) * omegaMatrix) + ((cosWt + wt * sinWt - 1) / w2 * glm::dmat3(1)) + ((sinWt - wt * cosWt) / (w2 * w) * skewMatrix);
+		}
+
+		return InitialPositionVector + inverseInitialOrientationMatrix * ((r1 * BodyVelocityVector) + (r2 * bodyAccelerationVector));
+	}
+}
@@ -0,0 +1,26 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+//Only the core integer types, so the key packing can also be built into the standalone benchmark harness
+#include "CoreTypes.h"
+
+/**
+ * Packs entity IDs and entity types into the 64 bit keys that FEntityID and FEntityType sort and compare by.
+ */
+namespace DISEntityKeys
+{
+	inline uint64 PackEntityID(int32 Site, int32 Application, int32 Entity)
+	{
+		return (static_cast<uint64>(Site) << 32) | (static_cast<uint64>(Application) << 16) | static_cast<uint64>(Entity);
+	}
+
+	/**
+	 * Each field keeps its low byte only, so wildcards of -1 pack as 255.
+	 */
+	inline uint64 PackEntityType(int32 EntityKind, int32 Domain, int32 Country, int32 Category, int32 Subcategory, int32 Specific, int32 Extra)
+	{
+		return ((static_cast<uint64>(Extra) & 0xFF) << 0) | ((static_cast<uint64>(Specific) & 0xFF) << 8) | ((static_cast<uint64>(Subcategory) & 0xFF) << 16) |
+			((static_cast<uint64>(Category) & 0xFF) << 24) | ((static_cast<uint64>(Country) & 0xFF) << 32) | ((static_cast<uint64>(Domain) & 0xFF) << 48) | ((static_cast<uint64>(EntityKind) & 0xFF) << 56);
+	}
+}
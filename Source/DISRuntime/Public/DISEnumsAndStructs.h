@@ -17,6 +17,7 @@
 
 #include "Kismet/KismetStringLibrary.h"
 #include "CoreMinimal.h"
+#include "DISEntityKeys.h"
 #include "DISEnumsAndStructs.generated.h"
 
 UENUM(BlueprintType)
@@ -43,6 +44,21 @@ enum class EGroundClampingMode : uint8
 	AlwaysGroundClamp			UMETA(Tooltip = "Always ground clamp this entity.")
 };
 
+UENUM(BlueprintType)
+enum class EEcefToGeodeticSolver : uint8
+{
+	Heikkinen	UMETA(Tooltip = "Heikkinen's closed form solution. Original solver used by the plugin."),
+	Olson		UMETA(Tooltip = "Olson's non-iterative solution. Faster than Heikkinen and valid at the poles.")
+};
+
+UENUM(BlueprintType)
+enum class EGeoReferencingConversionMode : uint8
+{
+	Exact			UMETA(Tooltip = "Match the GeoReferencing System everywhere. Flat planet levels are split into error checked tiles."),
+	FlatEarthAffine	UMETA(Tooltip = "Flat planet levels use a single ECEF to Unreal transform and constant North, East, Down fit at the origin. Warns if the exercise area exceeds the error budget."),
+	Automatic		UMETA(Tooltip = "Use Flat Earth Affine on flat planet levels when the exercise area is within the error budget, otherwise Exact.")
+};
+
 UENUM(BlueprintType)
 enum class EDeadReckoningAlgorithm : uint8
 {
@@ -608,7 +624,7 @@ struct FEntityID
 
 	uint64 ToUInt64() const
 	{
-		return (static_cast<uint64>(Site)<< 32) | (static_cast<uint64>(Application)<< 16) | (static_cast<uint64>(Entity));
+		return DISEntityKeys::PackEntityID(Site, Application, Entity);
 	}
 };
 
@@ -818,10 +834,7 @@ struct FEntityType
 
 	uint64 ToUInt64() const
 	{
-		const uint64 BitString = ((static_cast<uint64>(Extra) & 0xFF) << 0) | ((static_cast<uint64>(Specific) & 0xFF) << 8) | ((static_cast<uint64>(Subcategory) & 0xFF) << 16) |
-			((static_cast<uint64>(Category) & 0xFF) << 24) | ((static_cast<uint64>(Country) & 0xFF) << 32) | ((static_cast<uint64>(Domain) & 0xFF) << 48) | ((static_cast<uint64>(EntityKind) & 0xFF) << 56);
-		
-		return BitString;
+		return DISEntityKeys::PackEntityType(EntityKind, Domain, Country, Category, Subcategory, Specific, Extra);
 	}
 
 	FString ToBitString() const
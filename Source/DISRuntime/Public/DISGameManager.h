@@ -9,11 +9,13 @@
 #include "PDUMasterInclude.h"
 #include "DISClassEnumMappings.h"
 #include "UDPSubsystem.h"
+#include "DISBulkPublisher.h"
 #include "GameFramework/Info.h"
 #include "DISGameManager.generated.h"
 
 //Forward declarations
 class UDISReceiveComponent;
+class UDISSendManager;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogDISGameManager, Log, All);
 
@@ -175,8 +177,75 @@ public:
 		Meta = (DisplayName = "Application ID", Tooltip = "The Application ID of this application instance. Valid Application IDs range from 0 to 65535.", UIMin = 0, UIMax = 65535, ClampMin = 0, ClampMax = 65535))
 		int32 ApplicationID = 0;
 
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "GRILL DIS|Game Manager|GeoReferencing",
+		Meta = (Tooltip = "How the plugin converts between ECEF and Unreal coordinates on flat planet levels.\n\nFlat Earth Affine uses a single transform and North, East, Down fit at the origin for the whole level, which is faster but loses accuracy away from the origin."))
+		EGeoReferencingConversionMode GeoReferencingConversionMode = EGeoReferencingConversionMode::Exact;
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "GRILL DIS|Game Manager|GeoReferencing",
+		Meta = (Tooltip = "Horizontal distance in meters from the origin that DIS entities are expected to stay within. The flat earth transform is checked out to this distance.", ClampMin = 0, UIMin = 0,
+			EditCondition = "GeoReferencingConversionMode != EGeoReferencingConversionMode::Exact"))
+		float ExerciseAreaRadiusMeters = 10000.f;
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "GRILL DIS|Game Manager|GeoReferencing",
+		Meta = (Tooltip = "Largest position error in meters allowed over the exercise area. Flat Earth Affine warns when it is exceeded, Automatic falls back to Exact.", ClampMin = 0, UIMin = 0,
+			EditCondition = "GeoReferencingConversionMode != EGeoReferencingConversionMode::Exact"))
+		float FlatEarthMaxErrorMeters = 10.f;
+
+	/**
+	 * Returns the number of DIS entities that currently have an actor.
+	 */
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Game Manager")
+		int32 GetNumDISEntities() const { return DISActorMappings.Num(); }
+
+	/**
+	 * Returns whether the flat earth affine transform is in use, along with its error at the edge of the exercise area as measured against the GeoReferencing System.
+	 * @param PositionErrorMeters - The largest position error over the exercise area.
+	 * @param OrientationErrorDegrees - The largest North, East, Down orientation error over the exercise area.
+	 */
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Game Manager")
+		bool GetFlatEarthAffineError(float& PositionErrorMeters, float& OrientationErrorDegrees) const;
+
+	/**
+	 * Evaluates the dead reckoning thresholds of every DIS Send Component in one batched pass per frame.
+	 */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "GRILL DIS|Game Manager")
+		UDISSendManager* SendManager;
+
+	/**
+	 * Settings shared by every entity published with PublishEntityStates.
+	 */
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GRILL DIS|Game Manager|Bulk Publish")
+		FDISBulkPublishSettings BulkPublishSettings;
+
+	/**
+	 * Publishes Entity State PDUs for local entities that have no actor or DIS Send Component, such as crowd or AI agents.
+	 * Call once per frame with the current state of every entity. Runs the dead reckoning threshold and heartbeat tests over all of them in one batch
+	 * and only emits the PDUs that are due. Entities keep being tracked until StopPublishingEntities is called for them.
+	 * Returns the number of Entity State PDUs emitted.
+	 * @param EntityIDs - The unique Entity ID of every entity.
+	 * @param EntityTypes - The Entity Type of every entity.
+	 * @param UnrealLocations - The location of every entity in Unreal units.
+	 * @param UnrealRotations - The rotation of every entity.
+	 * @param UnrealVelocities - The velocity of every entity in Unreal units per second.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Game Manager|Bulk Publish")
+		int32 PublishEntityStates(const TArray<FEntityID>& EntityIDs, const TArray<FEntityType>& EntityTypes, const TArray<FVector>& UnrealLocations,
+			const TArray<FRotator>& UnrealRotations, const TArray<FVector>& UnrealVelocities);
+	/**
+	 * Stops publishing the given entities, sending a final Entity State PDU marked as deactivated for each.
+	 * Returns the number of entities that were being published.
+	 * @param EntityIDs - The Entity IDs to stop publishing.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Game Manager|Bulk Publish")
+		int32 StopPublishingEntities(const TArray<FEntityID>& EntityIDs);
+	/**
+	 * Stops publishing every entity, sending a final Entity State PDU marked as deactivated for each. Called on end play.
+	 * Returns the number of entities that were being published.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Game Manager|Bulk Publish")
+		int32 StopPublishingAllEntities();
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaTime) override;
 
 	UFUNCTION()
@@ -215,4 +284,5 @@ private:
 	void SpawnNewEntityFromEntityState(FEntityStatePDU EntityStatePDUIn);
 	UDISReceiveComponent* GetAssociatedDISComponent(FEntityID EntityIDIn);
 	AGeoReferencingSystem* GeoReferencingSystem;
+	FDISBulkPublisher BulkPublisher;
 };
\ No newline at end of file
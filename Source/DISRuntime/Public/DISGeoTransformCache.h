@@ -0,0 +1,217 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include "CoreMinimal.h"
+#include "DISEnumsAndStructs.h"
+#include "DISQuaternionConversions.h"
+#include "GeoReferencingSystem.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDISGeoTransformCache, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("DISGeoTransformCache_Game"), STATGROUP_DISGeoTransformCache, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Cached Conversions"), STAT_GeoTransformCacheHits, STATGROUP_DISGeoTransformCache);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Reference Conversions"), STAT_GeoTransformCacheFallbacks, STATGROUP_DISGeoTransformCache);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Tiles Built"), STAT_GeoTransformCacheTilesBuilt, STATGROUP_DISGeoTransformCache);
+
+/**
+ * Affine ECEF <-> engine transform valid over one tile of the level. Stored as a double precision 3x3 linear part plus translation
+ * (the upper 3 rows of a 4x4 affine matrix). Engine coordinates are in centimeters, ECEF in meters.
+ */
+struct FDISGeoTransformTile
+{
+	glm::dmat3 EngineToEcefLinear = glm::dmat3(1.);
+	glm::dvec3 EngineToEcefTranslation = glm::dvec3(0.);
+	glm::dmat3 EcefToEngineLinear = glm::dmat3(1.);
+	glm::dvec3 EcefToEngineTranslation = glm::dvec3(0.);
+	//Largest difference from the GeoReferencing System seen while validating the tile
+	double MaxErrorMeters = 0;
+	//False if the tile exceeded the error budget, conversions in it go through the GeoReferencing System
+	bool WithinErrorBudget = false;
+
+	FORCEINLINE glm::dvec3 EngineToEcef(const glm::dvec3& EngineLocation) const
+	{
+		return EngineToEcefLinear * EngineLocation + EngineToEcefTranslation;
+	}
+
+	FORCEINLINE glm::dvec3 EcefToEngine(const glm::dvec3& EcefLocation) const
+	{
+		return EcefToEngineLinear * EcefLocation + EcefToEngineTranslation;
+	}
+};
+
+/**
+ * Caches the ECEF <-> engine transforms and North, East, Down bases of a GeoReferencing System so the plugin conversions
+ * don't go through PROJ on every call.
+ *
+ * On creation the transform at the engine origin is fit against the GeoReferencing System and probed out to the edge of the
+ * validation radius. Round planet levels are affine everywhere, so a single transform is used for the whole level. Otherwise
+ * the level is split into cubic tiles that are fit and error checked against the GeoReferencing System the first time they are used.
+ * Tiles that exceed the error budget fall back to the GeoReferencing System.
+ *
+ * Flat planet levels can instead use a single transform and constant North, East, Down fit at the origin for the whole level
+ * (see SetConversionMode). Its error grows with distance from the origin, so it is checked over the exercise area when the cache is built.
+ *
+ * Caches are rebuilt when any of the GeoReferencing System's origin settings or the world origin change. Changes are detected once
+ * per frame, call Invalidate after changing the georeference mid frame.
+ */
+class DISRUNTIME_API FDISGeoTransformCache
+{
+public:
+	/**
+	 * Returns the cache for the given GeoReferencing System, building it if needed.
+	 * Returns null if the GeoReferencing System is invalid or caching is disabled through DIS.Geodetic.TransformCache.
+	 * Only the first call on each thread each frame takes a lock, but batches should still hold on to the result rather than call this per conversion.
+	 */
+	static TSharedPtr<FDISGeoTransformCache, ESPMode::ThreadSafe> Get(AGeoReferencingSystem* GeoReferencingSystem);
+
+	static void Invalidate(AGeoReferencingSystem* GeoReferencingSystem);
+	static void InvalidateAll();
+
+	/**
+	 * Sets how conversions for the given GeoReferencing System trade accuracy for speed on flat planet levels and rebuilds its cache.
+	 * @param Mode Exact keeps the tiled transforms, Flat Earth Affine always uses the single origin transform, Automatic uses it only when within the error budget
+	 * @param ExerciseAreaRadiusMeters Horizontal distance from the origin over which the flat earth transform is checked
+	 * @param MaxErrorMeters Largest position error allowed over the exercise area before warning (Flat Earth Affine) or falling back to Exact (Automatic)
+	 */
+	static void SetConversionMode(AGeoReferencingSystem* GeoReferencingSystem, EGeoReferencingConversionMode Mode, double ExerciseAreaRadiusMeters, double MaxErrorMeters);
+
+	/**
+	 * Conversions that go through the cache of the given GeoReferencing System, or straight to the GeoReferencing System when caching is disabled.
+	 * The GeoReferencing System must be valid.
+	 */
+	static void EngineToEcef(AGeoReferencingSystem* GeoReferencingSystem, const FVector& EngineLocation, FEarthCenteredEarthFixedDouble& OutEcef);
+	static void EcefToEngine(AGeoReferencingSystem* GeoReferencingSystem, const FEarthCenteredEarthFixedDouble& Ecef, FVector& OutEngineLocation);
+	static void GetNorthEastDownAtEngineLocation(AGeoReferencingSystem* GeoReferencingSystem, const FVector& EngineLocation, FNorthEastDown& OutNorthEastDown);
+	static void GetNorthEastDownAtEcefLocation(AGeoReferencingSystem* GeoReferencingSystem, const FEarthCenteredEarthFixedDouble& Ecef, FNorthEastDown& OutNorthEastDown);
+	static glm::dquat GetEcefToEngineRotationAtEcefLocation(AGeoReferencingSystem* GeoReferencingSystem, const FEarthCenteredEarthFixedDouble& Ecef);
+
+	void EngineToEcef(const FVector& EngineLocation, FEarthCenteredEarthFixedDouble& OutEcef);
+	void EcefToEngine(const FEarthCenteredEarthFixedDouble& Ecef, FVector& OutEngineLocation);
+
+	void GetNorthEastDownAtEngineLocation(const FVector& EngineLocation, FNorthEastDown& OutNorthEastDown);
+	void GetNorthEastDownAtEcefLocation(const FEarthCenteredEarthFixedDouble& Ecef, FNorthEastDown& OutNorthEastDown);
+
+	/**
+	 * Rotation from ECEF directions into the Y flipped engine frame at the given ECEF location. See DISQuaternionConversions.h.
+	 * Constant for round planet levels, otherwise built from the North, East, Down vectors at the location.
+	 */
+	glm::dquat GetEcefToEngineRotationAtEcefLocation(const FEarthCenteredEarthFixedDouble& Ecef);
+
+	/**
+	 * True if GetEcefToEngineRotationAtEcefLocation returns GetConstantEcefToEngineRotation everywhere in the level.
+	 */
+	bool HasConstantEcefToEngineRotation() const { return ConstantEcefToEngineRotationValid; }
+	const glm::dquat& GetConstantEcefToEngineRotation() const { return ConstantEcefToEngineRotation; }
+
+	/**
+	 * North, East, Down of the engine origin.
+	 */
+	const FNorthEastDown& GetOriginNorthEastDown() const { return OriginNorthEastDown; }
+
+	/**
+	 * The transform fit at the engine origin. Exact everywhere when IsGloballyAffine is true.
+	 */
+	const FDISGeoTransformTile& GetOriginTile() const { return OriginTile; }
+
+	bool IsGloballyAffine() const { return GloballyAffine; }
+
+	/**
+	 * True if the flat earth transform fit at the origin is used for the whole level. Position and orientation error
+	 * at the edge of the exercise area as measured against the GeoReferencing System.
+	 */
+	bool IsFlatEarthAffine() const { return FlatEarthAffine; }
+	double GetFlatEarthErrorMeters() const { return FlatEarthErrorMeters; }
+	double GetFlatEarthErrorDegrees() const { return FlatEarthErrorDegrees; }
+
+	/**
+	 * Largest position error in meters of any tile built so far, as measured against the GeoReferencing System.
+	 */
+	double GetMaxErrorMeters() const;
+
+	int32 GetNumTiles() const;
+
+private:
+	//How North, East, Down vectors are produced
+	enum class ENorthEastDownMode : uint8
+	{
+		//Computed from the geodetic latitude/longitude and rotated into the engine frame
+		Analytic,
+		//Same everywhere in the level (flat planet)
+		Constant,
+		//Neither of the above matched the GeoReferencing System, always ask it
+		Reference
+	};
+
+	/**
+	 * Every setting that changes the results of the GeoReferencing System conversions.
+	 */
+	struct FOriginSnapshot
+	{
+		EPlanetShape PlanetShape = EPlanetShape::RoundPlanet;
+		bool OriginAtPlanetCenter = false;
+		bool OriginLocationInProjectedCRS = false;
+		double OriginLatitude = 0;
+		double OriginLongitude = 0;
+		double OriginAltitude = 0;
+		double OriginProjectedCoordinatesEasting = 0;
+		double OriginProjectedCoordinatesNorthing = 0;
+		double OriginProjectedCoordinatesUp = 0;
+		FString ProjectedCRS;
+		FString GeographicCRS;
+		FIntVector WorldOriginLocation = FIntVector::ZeroValue;
+		float TileSizeMeters = 0;
+		float MaxErrorMeters = 0;
+		EGeoReferencingConversionMode ConversionMode = EGeoReferencingConversionMode::Exact;
+		double ExerciseAreaRadiusMeters = 0;
+		double FlatEarthMaxErrorMeters = 0;
+
+		FOriginSnapshot() = default;
+		FOriginSnapshot(AGeoReferencingSystem* GeoReferencingSystem);
+		bool operator==(const FOriginSnapshot& Other) const;
+	};
+
+	FDISGeoTransformCache(AGeoReferencingSystem* GeoReferencingSystem, const FOriginSnapshot& Snapshot);
+
+	/**
+	 * Fits an affine transform over the cube centered on the given engine location and checks its corners against the GeoReferencing System.
+	 */
+	void FitTile(const glm::dvec3& CenterEngineLocation, double HalfSizeCentimeters, FDISGeoTransformTile& OutTile) const;
+
+	/**
+	 * Copies the tile containing the given engine location into OutTile, building it if needed. Returns false if the tile exceeded the error budget.
+	 */
+	bool FindOrBuildTile(const glm::dvec3& EngineLocation, FDISGeoTransformTile& OutTile);
+
+	/**
+	 * North, East, Down at the given ECEF location computed from its geodetic latitude/longitude and rotated into the engine frame.
+	 */
+	void CalculateNorthEastDownAtEcef(const glm::dvec3& Ecef, FNorthEastDown& OutNorthEastDown) const;
+
+	/**
+	 * Checks the origin transform over the exercise area and switches to it for the whole level if the conversion mode allows.
+	 */
+	void ConfigureFlatEarthAffine(AGeoReferencingSystem* InGeoReferencingSystem);
+
+	TWeakObjectPtr<AGeoReferencingSystem> GeoReferencingSystem;
+	FOriginSnapshot Snapshot;
+	uint64 ValidatedFrame = 0;
+
+	FDISGeoTransformTile OriginTile;
+	bool GloballyAffine = false;
+	double TileSizeCentimeters = 0;
+
+	FNorthEastDown OriginNorthEastDown;
+	ENorthEastDownMode NorthEastDownMode = ENorthEastDownMode::Reference;
+	glm::dquat ConstantEcefToEngineRotation = glm::dquat(1., 0., 0., 0.);
+	bool ConstantEcefToEngineRotationValid = false;
+
+	bool FlatEarthAffine = false;
+	double FlatEarthErrorMeters = 0;
+	double FlatEarthErrorDegrees = 0;
+
+	mutable FRWLock TilesLock;
+	TMap<FIntVector, FDISGeoTransformTile> Tiles;
+	double MaxTileErrorMeters = 0;
+};
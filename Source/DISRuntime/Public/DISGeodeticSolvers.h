@@ -0,0 +1,128 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DISEnumsAndStructs.h"
+
+/**
+ * Inline ECEF to geodetic solvers shared by DIS_BPFL, the batch conversions, and the benchmarks.
+ * All solvers use the WGS84 ellipsoid and return latitude/longitude in radians and height in meters.
+ */
+namespace DISGeodetic
+{
+	constexpr double EarthEquitorialRadiusMeters = 6378137;
+	constexpr double EarthPolarRadiusMeters = 6356752.3142;
+	constexpr double EarthEquitorialRadiusMetersSquared = EarthEquitorialRadiusMeters * EarthEquitorialRadiusMeters;
+	constexpr double EarthPolarRadiusMetersSquared = EarthPolarRadiusMeters * EarthPolarRadiusMeters;
+	constexpr double ESquared = (EarthEquitorialRadiusMetersSquared - EarthPolarRadiusMetersSquared) / EarthEquitorialRadiusMetersSquared;
+	constexpr double EPrimeSquared = (EarthEquitorialRadiusMetersSquared - EarthPolarRadiusMetersSquared) / EarthPolarRadiusMetersSquared;
+	//Olson's series is sub-millimeter accurate down to about 800 km from the center of the Earth
+	constexpr double OlsonMinRadiusMeters = 1000000;
+
+	/**
+	 * Returns the solver selected through the DIS.Geodetic.EcefToGeodeticSolver console variable.
+	 */
+	DISRUNTIME_API EEcefToGeodeticSolver GetEcefToGeodeticSolver();
+
+	/**
+	 * Heikkinen's closed form solution. Undefined on the polar axis.
+	 */
+	FORCEINLINE void EcefToGeodeticHeikkinen(const double X, const double Y, const double Z, double& OutLatitudeRadians, double& OutLongitudeRadians, double& OutHeightMeters)
+	{
+		const double pSquared = X * X + Y * Y;
+		const double p = FMath::Sqrt(pSquared);
+		const double zSquared = Z * Z;
+		const double F = 54 * EarthPolarRadiusMetersSquared * zSquared;
+		const double G = pSquared + (1 - ESquared) * zSquared - ESquared * (EarthEquitorialRadiusMetersSquared - EarthPolarRadiusMetersSquared);
+		const double c = (ESquared * ESquared * F * pSquared) / (G * G * G);
+		const double s = FMath::Pow(1 + c + FMath::Sqrt(c * c + 2 * c), 1. / 3.);
+		const double k = s + 1 + 1 / s;
+		const double P = F / (3 * k * k * G * G);
+		const double Q = FMath::Sqrt(1 + 2 * ESquared * ESquared * P);
+		const double rNot = (-P * ESquared * p) / (1 + Q) + FMath::Sqrt(0.5 * EarthEquitorialRadiusMetersSquared * (1 + 1 / Q) - (P * (1 - ESquared) * zSquared) / (Q * (1 + Q)) - 0.5 * P * pSquared);
+		const double pMinusERNot = p - ESquared * rNot;
+		const double U = FMath::Sqrt(pMinusERNot * pMinusERNot + zSquared);
+		const double V = FMath::Sqrt(pMinusERNot * pMinusERNot + (1 - ESquared) * zSquared);
+		const double zNot = (EarthPolarRadiusMetersSquared * Z) / (EarthEquitorialRadiusMeters * V);
+
+		OutHeightMeters = U * (1 - EarthPolarRadiusMetersSquared / (EarthEquitorialRadiusMeters * V));
+		OutLatitudeRadians = FMath::Atan((Z + EPrimeSquared * zNot) / p);
+		OutLongitudeRadians = FMath::Atan2(Y, X);
+	}
+
+	/**
+	 * Olson's non-iterative solution (Olson, 1996, "Converting Earth-Centered, Earth-Fixed Coordinates to Geodetic Coordinates").
+	 * Uses a series approximation followed by a single Newton correction. Sub-millimeter accurate for points from 1000 km from the center of the Earth
+	 * out past geostationary orbit, valid at the poles, and roughly twice as fast as Heikkinen since it avoids the cube root and most square roots.
+	 * The series breaks down closer to the center, so those points fall back to Heikkinen, which leaves the center itself undefined.
+	 */
+	FORCEINLINE void EcefToGeodeticOlson(const double X, const double Y, const double Z, double& OutLatitudeRadians, double& OutLongitudeRadians, double& OutHeightMeters)
+	{
+		constexpr double a1 = EarthEquitorialRadiusMeters * ESquared;
+		constexpr double a2 = a1 * a1;
+		constexpr double a3 = a1 * ESquared / 2;
+		constexpr double a4 = 2.5 * a2;
+		constexpr double a5 = a1 + a3;
+		constexpr double a6 = 1 - ESquared;
+
+		const double zAbs = FMath::Abs(Z);
+		const double wSquared = X * X + Y * Y;
+		const double w = FMath::Sqrt(wSquared);
+		const double rSquared = wSquared + Z * Z;
+		if (rSquared < OlsonMinRadiusMeters * OlsonMinRadiusMeters)
+		{
+			EcefToGeodeticHeikkinen(X, Y, Z, OutLatitudeRadians, OutLongitudeRadians, OutHeightMeters);
+			return;
+		}
+		const double r = FMath::Sqrt(rSquared);
+
+		const double sSquared = Z * Z / rSquared;
+		const double cSquared = wSquared / rSquared;
+		double u = a2 / r;
+		double v = a3 - a4 / r;
+
+		double latitude, s, c, ss;
+		//Use the better conditioned of asin/acos depending on how close to the equator the point is
+		if (cSquared > 0.3)
+		{
+			s = (zAbs / r) * (1 + cSquared * (a1 + u + sSquared * v) / r);
+			latitude = FMath::Asin(s);
+			ss = s * s;
+			c = FMath::Sqrt(1 - ss);
+		}
+		else
+		{
+			c = (w / r) * (1 - sSquared * (a5 - u - cSquared * v) / r);
+			latitude = FMath::Acos(c);
+			ss = 1 - c * c;
+			s = FMath::Sqrt(ss);
+		}
+
+		const double g = 1 - ESquared * ss;
+		const double rg = EarthEquitorialRadiusMeters / FMath::Sqrt(g);
+		const double rf = a6 * rg;
+		u = w - rg * c;
+		v = zAbs - rf * s;
+		const double f = c * u + s * v;
+		const double m = c * v - s * u;
+		const double p = m / (rf / g + f);
+
+		latitude += p;
+		OutLatitudeRadians = Z < 0 ? -latitude : latitude;
+		OutLongitudeRadians = FMath::Atan2(Y, X);
+		OutHeightMeters = f + m * p / 2;
+	}
+
+	FORCEINLINE void EcefToGeodetic(const EEcefToGeodeticSolver Solver, const double X, const double Y, const double Z, double& OutLatitudeRadians, double& OutLongitudeRadians, double& OutHeightMeters)
+	{
+		if (Solver == EEcefToGeodeticSolver::Heikkinen)
+		{
+			EcefToGeodeticHeikkinen(X, Y, Z, OutLatitudeRadians, OutLongitudeRadians, OutHeightMeters);
+		}
+		else
+		{
+			EcefToGeodeticOlson(X, Y, Z, OutLatitudeRadians, OutLongitudeRadians, OutHeightMeters);
+		}
+	}
+}
@@ -0,0 +1,140 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DISCaptureLog.h"
+#include "DISCaptureReader.h"
+
+//Forward declarations
+class IFileHandle;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDISKeyframes, Log, All);
+
+/**
+ * Follows a stream of datagrams and keeps the ones needed to rebuild the exercise at the latest point in it:
+ * the last Entity State PDU of every active entity, any Entity State Update PDU after it, and the last Start/Resume and Stop/Freeze PDUs.
+ * Entities are dropped once deactivated. Only the first PDU of each datagram is looked at, as with the PDU Processor.
+ */
+class DISRUNTIME_API FDISExerciseStateTracker
+{
+public:
+	void AddDatagram(const FDISCaptureRecordHeader& Record, TArrayView<const uint8> Payload);
+	void Reset();
+
+	int32 GetNumEntities() const { return Entities.Num(); }
+	bool IsEmpty() const { return Entities.Num() == 0 && SimulationManagement.Num() == 0; }
+
+	/**
+	 * Calls the function with every kept datagram in the order they were received.
+	 */
+	void ForEachDatagram(TFunctionRef<void(const FDISCaptureRecordHeader&, TArrayView<const uint8>)> Function) const;
+
+	/**
+	 * Calls the function with a deactivated copy of the last Entity State PDU of every entity that is not in the other state, for removing them when moving to it.
+	 */
+	void ForEachDeactivatedDatagram(const FDISExerciseStateTracker& Other, TFunctionRef<void(const FDISCaptureRecordHeader&, TArrayView<const uint8>)> Function) const;
+
+	/**
+	 * Appends the kept datagrams as a keyframe to the given bytes.
+	 * @param Ticks - Time the keyframe describes the exercise at.
+	 * @param Position - Position in the capture of the first record after the keyframe.
+	 */
+	void AppendKeyframe(int64 Ticks, const FDISCaptureReader::FPosition& Position, TArray<uint8>& OutBytes) const;
+
+private:
+	struct FKeptDatagram
+	{
+		FDISCaptureRecordHeader Record;
+		TArray<uint8> Bytes;
+
+		void Set(const FDISCaptureRecordHeader& InRecord, TArrayView<const uint8> Payload);
+	};
+
+	struct FEntity
+	{
+		FKeptDatagram EntityState;
+		FKeptDatagram EntityStateUpdate;
+		bool HasEntityStateUpdate = false;
+	};
+
+	TMap<uint64, FEntity> Entities;
+	//Keyed by PDU type
+	TMap<uint8, FKeptDatagram> SimulationManagement;
+};
+
+/**
+ * Appends keyframes to a keyframe archive at a fixed interval of capture time while following the datagrams of a capture.
+ */
+class DISRUNTIME_API FDISKeyframeWriter
+{
+public:
+	~FDISKeyframeWriter();
+
+	bool Open(const FString& FilePath, float IntervalSeconds);
+	void Close();
+	bool IsOpen() const { return File != nullptr; }
+
+	/**
+	 * Adds the next datagram of the capture, writing a keyframe before it if the interval has passed.
+	 * @param Position - Position of the datagram's record in the capture.
+	 */
+	void AddDatagram(const FDISCaptureRecordHeader& Record, TArrayView<const uint8> Payload, const FDISCaptureReader::FPosition& Position);
+
+	int32 GetNumKeyframesWritten() const { return NumKeyframesWritten; }
+
+private:
+	IFileHandle* File = nullptr;
+	int64 IntervalTicks = 0;
+	int64 NextKeyframeTicks = 0;
+	int32 NumKeyframesWritten = 0;
+	FDISExerciseStateTracker State;
+	TArray<uint8> KeyframeBytes;
+};
+
+/**
+ * Reads keyframes back from a keyframe archive so replays can seek without replaying everything before the seek time.
+ * Only the keyframe headers are kept in memory, each keyframe is read from disk when loaded.
+ */
+class DISRUNTIME_API FDISKeyframeArchive
+{
+public:
+	~FDISKeyframeArchive();
+
+	/**
+	 * Opens the keyframe archive of a capture. Returns false if it has none.
+	 */
+	bool Open(const FString& Directory, const FString& CaptureName);
+	void Close();
+	bool IsOpen() const { return File != nullptr; }
+	int32 GetNumKeyframes() const { return Keyframes.Num(); }
+
+	/**
+	 * Loads the last keyframe at or before the given time. Returns false if there is none.
+	 * @param Ticks - Time to find the keyframe for.
+	 * @param OutState - Filled with the state at the keyframe.
+	 * @param OutPosition - Position in the capture to continue replaying from.
+	 * @param OutKeyframeTicks - Time of the keyframe.
+	 */
+	bool LoadKeyframe(int64 Ticks, FDISExerciseStateTracker& OutState, FDISCaptureReader::FPosition& OutPosition, int64& OutKeyframeTicks);
+
+	/**
+	 * Builds the keyframe archive of an existing capture, replacing any it already has.
+	 * @param Directory - Directory the capture was written to.
+	 * @param CaptureName - Name the segment files of the capture start with.
+	 * @param IntervalSeconds - Capture time between keyframes.
+	 */
+	static bool BuildFromCapture(const FString& Directory, const FString& CaptureName, float IntervalSeconds);
+
+private:
+	struct FKeyframe
+	{
+		FDISKeyframeHeader Header;
+		//Offset of the keyframe's records in the archive
+		int64 RecordsOffset;
+	};
+
+	IFileHandle* File = nullptr;
+	TArray<FKeyframe> Keyframes;
+	TArray<uint8> KeyframeBytes;
+};
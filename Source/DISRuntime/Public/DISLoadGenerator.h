@@ -0,0 +1,234 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HAL/ThreadSafeBool.h"
+#include "HAL/ThreadSafeCounter64.h"
+#include "DISEnumsAndStructs.h"
+#include "DISLoadGenerator.generated.h"
+
+//Forward declarations
+class FSocket;
+class FInternetAddr;
+class FRunnableThread;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDISLoadGenerator, Log, All);
+
+USTRUCT(BlueprintType)
+struct FDISLoadGeneratorSettings
+{
+	GENERATED_BODY()
+
+	/** Address to send to. Addresses from 224.0.0.0 to 239.255.255.255 are sent to as a multicast group, any other as unicast. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Load Generator|Structs")
+		FString Address = TEXT("127.0.0.1");
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Load Generator|Structs")
+		int32 Port = 3000;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", ClampMax = "255"), Category = "GRILL DIS|Load Generator|Structs")
+		int32 ExerciseID = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", ClampMax = "65535"), Category = "GRILL DIS|Load Generator|Structs")
+		int32 SiteID = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", ClampMax = "65535"), Category = "GRILL DIS|Load Generator|Structs")
+		int32 ApplicationID = 4242;
+
+	/** Number of simulated entities kept alive at once. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1", ClampMax = "65534"), Category = "GRILL DIS|Load Generator|Structs")
+		int32 NumEntities = 1000;
+
+	/** Packets sent per second across every PDU type. Entity updates take whatever the Fire, Detonation, and Emissions shares leave over, spread evenly across the entities. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1"), Category = "GRILL DIS|Load Generator|Structs")
+		float TargetPacketsPerSecond = 5000;
+
+	/** How long to generate for. Zero or less generates until stopped. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Load Generator|Structs")
+		float DurationSeconds = 0;
+
+	/** Dead reckoning algorithm every entity reports. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Load Generator|Structs")
+		EDeadReckoningAlgorithm DeadReckoningAlgorithm = EDeadReckoningAlgorithm::FPW;
+
+	/** Articulated parts on every entity, each of which changes with every update. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", ClampMax = "32"), Category = "GRILL DIS|Load Generator|Structs")
+		int32 NumArticulations = 0;
+
+	/** Share of entity updates sent as Entity State Update PDUs rather than Entity State PDUs. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", ClampMax = "1"), Category = "GRILL DIS|Load Generator|Structs")
+		float EntityStateUpdateShare = 0;
+
+	/** Share of all packets sent as Fire PDUs. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", ClampMax = "1"), Category = "GRILL DIS|Load Generator|Structs")
+		float FireShare = 0.01f;
+
+	/** Share of all packets sent as Detonation PDUs. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", ClampMax = "1"), Category = "GRILL DIS|Load Generator|Structs")
+		float DetonationShare = 0.01f;
+
+	/** Share of all packets sent as Electromagnetic Emissions PDUs. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", ClampMax = "1"), Category = "GRILL DIS|Load Generator|Structs")
+		float EmissionsShare = 0;
+
+	/** Entities deactivated and replaced by new ones with new entity IDs every second. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"), Category = "GRILL DIS|Load Generator|Structs")
+		float ChurnPerSecond = 0;
+
+	/** Share of churned entities that stop sending without being deactivated, leaving receivers to time them out. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0", ClampMax = "1"), Category = "GRILL DIS|Load Generator|Structs")
+		float TimeoutShare = 0;
+
+	/** Half the width of the square the entities drive around in, in meters. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "1"), Category = "GRILL DIS|Load Generator|Structs")
+		float AreaMeters = 20000;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"), Category = "GRILL DIS|Load Generator|Structs")
+		float SpeedMetersPerSecond = 15;
+
+	/** Seed for placing and moving entities, so runs with the same settings send the same traffic. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Load Generator|Structs")
+		int32 Seed = 46;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Load Generator|Structs")
+		int32 SendBufferBytes = 4 * 1024 * 1024;
+};
+
+USTRUCT(BlueprintType)
+struct FDISLoadGeneratorStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Load Generator|Structs")
+		float ElapsedSeconds = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Load Generator|Structs")
+		int64 PacketsSent = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Load Generator|Structs")
+		int64 BytesSent = 0;
+
+	/** Packets the socket would not take, usually because its send buffer was full. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Load Generator|Structs")
+		int64 SendFailures = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Load Generator|Structs")
+		int64 EntitiesChurned = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Load Generator|Structs")
+		float TargetPacketsPerSecond = 0;
+
+	/** Packets sent per second since the generator started. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Load Generator|Structs")
+		float AchievedPacketsPerSecond = 0;
+
+	/** Packets sent per second over the last second. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Load Generator|Structs")
+		float RecentPacketsPerSecond = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Load Generator|Structs")
+		float AchievedMegabitsPerSecond = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Load Generator|Structs")
+		bool Running = false;
+};
+
+//The load generator is a development tool and is compiled out of shipping builds, leaving only its settings and stats
+#if !UE_BUILD_SHIPPING
+/**
+ * Sends synthetic DIS traffic at a target rate on its own thread, for load testing the receive path.
+ * Entity State PDUs are encoded once per entity with the plugin's PDU encoders and then only have their changing fields rewritten on every update,
+ * so the generator can outrun the receiver it is testing. Fire, Detonation, and Electromagnetic Emissions PDUs are encoded as they are sent.
+ */
+class DISRUNTIME_API FDISLoadGenerator : public FRunnable
+{
+public:
+	explicit FDISLoadGenerator(const FDISLoadGeneratorSettings& InSettings);
+	virtual ~FDISLoadGenerator();
+
+	FDISLoadGenerator(const FDISLoadGenerator&) = delete;
+	FDISLoadGenerator& operator=(const FDISLoadGenerator&) = delete;
+
+	/**
+	 * Opens the socket and starts sending. Returns false if the address is invalid or the socket could not be opened.
+	 */
+	bool Start();
+	/**
+	 * Stops sending, deactivates every simulated entity, and waits for the thread to finish.
+	 */
+	void StopAndWait();
+
+	bool IsRunning() const { return Thread != nullptr && !Finished; }
+	FDISLoadGeneratorStats GetStats() const;
+	const FDISLoadGeneratorSettings& GetSettings() const { return Settings; }
+
+	/**
+	 * Reads settings from Key=Value pairs, as given to the DIS.LoadGen console command and the DISLoadGenerator commandlet.
+	 * Settings not mentioned are left unchanged.
+	 */
+	static void ParseSettings(const TCHAR* Params, FDISLoadGeneratorSettings& InOutSettings);
+
+	/**
+	 * Stops the generator started from the console, if any. Called on module shutdown.
+	 */
+	static void StopConsoleGenerator();
+
+	// Begin FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End FRunnable
+
+private:
+	struct FSimulatedEntity
+	{
+		FEntityID EntityID;
+		//Circle the entity drives around, in meters east and north of the origin
+		FVector2D Center;
+		double Radius;
+		double Phase;
+		double AngularSpeed;
+		//Entity State and Entity State Update PDUs encoded when the entity was spawned, rewritten on every update
+		TArray<uint8> EntityState;
+		TArray<uint8> EntityStateUpdate;
+		bool SentEntityState = false;
+	};
+
+	void SpawnEntity(FSimulatedEntity& OutEntity);
+	void SendEntityUpdate(FSimulatedEntity& Entity, double Seconds);
+	void SendDeactivation(FSimulatedEntity& Entity);
+	void SendFire(double Seconds);
+	void SendDetonation(double Seconds);
+	void SendEmissions(double Seconds);
+	bool Send(const TArray<uint8>& Bytes);
+
+	/**
+	 * Location, velocity, and heading of an entity at the given time since the generator started.
+	 */
+	void GetEntityMotion(const FSimulatedEntity& Entity, double Seconds, FVector& OutLocation, FVector& OutVelocity, float& OutHeading) const;
+
+	FDISLoadGeneratorSettings Settings;
+	FRandomStream RandomStream;
+	TArray<FSimulatedEntity> Entities;
+	int32 NextEntityNumber = 1;
+	int32 NextEventNumber = 1;
+
+	FSocket* Socket = nullptr;
+	TSharedPtr<FInternetAddr> Destination;
+	FRunnableThread* Thread = nullptr;
+	FThreadSafeBool StopRequested;
+	FThreadSafeBool Finished;
+	double StartSeconds = 0;
+	double EndSeconds = 0;
+	//Seconds past the UTC hour when the generator started, for DIS relative timestamps
+	double StartSecondsPastHour = 0;
+
+	FThreadSafeCounter64 PacketsSent;
+	FThreadSafeCounter64 BytesSent;
+	FThreadSafeCounter64 SendFailures;
+	FThreadSafeCounter64 EntitiesChurned;
+	FThreadSafeCounter64 RecentPacketsPerSecond;
+};
+
+#endif
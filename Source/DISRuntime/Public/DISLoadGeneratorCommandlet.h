@@ -0,0 +1,23 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DISLoadGeneratorCommandlet.generated.h"
+
+/**
+ * Runs the DIS load generator headless, logging the achieved rate every second and a report when done.
+ * Usage: UE4Editor-Cmd.exe <Project> -run=DISLoadGenerator [-Entities=1000] [-Rate=5000] [-Address=127.0.0.1] [-Port=3000] [-Duration=60] [-DR=FPW] [-Articulations=0]
+ *        [-ESU=0] [-Fire=0.01] [-Detonation=0.01] [-Emissions=0] [-Churn=0] [-Timeout=0] [-Seed=46]
+ */
+UCLASS()
+class UDISLoadGeneratorCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDISLoadGeneratorCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
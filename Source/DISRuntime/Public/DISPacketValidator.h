@@ -0,0 +1,43 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+//Only the core integer types, so the validator can also be built into the standalone fuzz target
+#include "CoreTypes.h"
+
+/**
+ * Why a datagram was turned away before being unmarshalled.
+ */
+enum class EDISPacketRejectReason : uint8
+{
+	None,
+	//Shorter than the 12 byte PDU header
+	TooShortForHeader,
+	//The length in the header is shorter than the header or longer than the datagram
+	LengthMismatch,
+	//A PDU type the PDU Processor does not decode
+	UnsupportedPDUType,
+	//The length in the header is shorter than the fixed fields of the PDU type
+	TooShortForPDU,
+	//The record counts describe more variable records than the length in the header holds
+	RecordsOverrun,
+	//A record count Open DIS cannot unmarshal faithfully even though the length holds the records
+	TooManyRecords,
+	Count
+};
+
+/**
+ * Checks a datagram against the layout of the PDU type in its header before it is handed to Open DIS.
+ * Open DIS reads past the end of short datagrams with bounds checked reads that throw, which takes the process down in modules built without exceptions.
+ * A datagram that passes is guaranteed to be unmarshalled without reading past the length in its header.
+ */
+class DISRUNTIME_API FDISPacketValidator
+{
+public:
+	/**
+	 * Returns why the datagram would fail to unmarshal, or None if the PDU Processor can decode it.
+	 * @param Bytes - The datagram.
+	 * @param NumBytes - Size of the datagram. Anything after the length in the header is ignored.
+	 */
+	static EDISPacketRejectReason Validate(const uint8* Bytes, int32 NumBytes);
+};
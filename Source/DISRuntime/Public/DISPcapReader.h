@@ -0,0 +1,169 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DISReplaySource.h"
+#include "DISPcapReader.generated.h"
+
+//Forward declarations
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDISPcap, Log, All);
+
+USTRUCT(BlueprintType)
+struct FDISPcapFilter
+{
+	GENERATED_BODY()
+
+	/** UDP destination ports to replay. Every port is replayed when empty. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Replay Subsystem|Structs")
+		TArray<int32> Ports;
+
+	/** IPv4 destination addresses to replay, such as multicast groups or broadcast addresses. Every address is replayed when empty. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Replay Subsystem|Structs")
+		TArray<FString> Addresses;
+};
+
+/**
+ * Streams the UDP payloads out of a pcap or pcapng file, such as one recorded with tcpdump or Wireshark, for replay.
+ *
+ * Supports Ethernet (with VLAN tags), Linux cooked, BSD loopback, and raw IP link types with IPv4. Fragmented datagrams are skipped.
+ * The file is read through a memory mapped window of fixed size, so memory use does not grow with the size of the file.
+ * Opening the file scans it once to find its time span and build a sparse time index for seeking.
+ */
+class DISRUNTIME_API FDISPcapReader : public IDISReplaySource
+{
+public:
+	FDISPcapReader() = default;
+	virtual ~FDISPcapReader();
+
+	FDISPcapReader(const FDISPcapReader&) = delete;
+	FDISPcapReader& operator=(const FDISPcapReader&) = delete;
+
+	/**
+	 * Opens a pcap or pcapng file. Returns false if the file could not be read or is neither format.
+	 * @param FilePath - The file to open.
+	 * @param Filter - The UDP datagrams to replay.
+	 */
+	bool Open(const FString& FilePath, const FDISPcapFilter& Filter);
+	void Close();
+
+	bool IsOpen() const { return Window.IsOpen(); }
+
+	/**
+	 * Counts from the scan done when opening.
+	 */
+	int64 GetNumMatchingPackets() const { return NumMatchingPackets; }
+	int64 GetNumSkippedPackets() const { return NumSkippedPackets; }
+	int64 GetNumFragmentedPackets() const { return NumFragmentedPackets; }
+
+	// Begin IDISReplaySource
+	virtual bool ReadNext(FDISCaptureRecordHeader& OutRecord, TArrayView<const uint8>& OutPayload) override;
+	virtual bool PeekNextTicks(int64& OutTicks) override;
+	virtual void SeekToTicks(int64 Ticks) override;
+	virtual void Rewind() override;
+	virtual int64 GetStartTicks() const override { return StartTicks; }
+	virtual int64 GetEndTicks() const override { return EndTicks; }
+	// End IDISReplaySource
+
+private:
+	/**
+	 * Fixed size view of a file that moves along it as it is read.
+	 */
+	class FFileWindow
+	{
+	public:
+		~FFileWindow();
+
+		bool Open(const FString& FilePath);
+		void Close();
+		bool IsOpen() const { return FileSize > 0; }
+		int64 GetFileSize() const { return FileSize; }
+
+		/**
+		 * Returns the given bytes of the file, or null if they run past its end. Only valid until the next call.
+		 */
+		const uint8* Get(int64 Offset, int64 NumBytes);
+
+	private:
+		static constexpr int64 WindowBytes = 64 * 1024 * 1024;
+
+		IMappedFileHandle* MappedFile = nullptr;
+		IMappedFileRegion* MappedRegion = nullptr;
+		//Used when the platform cannot map the file
+		IFileHandle* File = nullptr;
+		TArray<uint8> ReadBytes;
+
+		int64 FileSize = 0;
+		int64 ViewOffset = 0;
+		int64 ViewBytes = 0;
+		const uint8* ViewData = nullptr;
+	};
+
+	struct FInterface
+	{
+		uint32 LinkType = 0;
+		//Timestamp resolution, 10^-Exponent seconds or 2^-Exponent when binary
+		uint8 ResolutionExponent = 6;
+		bool BinaryResolution = false;
+	};
+
+	/**
+	 * Byte order and interfaces in effect from a point in the file on, so reading can resume there.
+	 */
+	struct FParseState
+	{
+		int64 Offset = 0;
+		bool PcapNg = false;
+		bool Swapped = false;
+		TArray<FInterface> Interfaces;
+	};
+
+	enum class EFrameResult : uint8
+	{
+		Matched,
+		Skipped,
+		Fragmented
+	};
+
+	/**
+	 * Moves past blocks and packets until one passes the filter. Returns false at the end of the file or at damaged data.
+	 * @param OutPacketOffset - Offset of the record or block holding the packet, where parsing can resume with the same state.
+	 */
+	bool ParseNextPacket(FParseState& InOutState, FDISCaptureRecordHeader& OutRecord, int64& OutPayloadOffset, int64& OutPacketOffset);
+	/**
+	 * Finds the UDP payload in a captured frame. Only matches whole, unfragmented IPv4 UDP datagrams that pass the filter.
+	 */
+	EFrameResult ParseFrame(const FInterface& Interface, const uint8* Frame, uint32 CapturedBytes, FDISCaptureRecordHeader& OutRecord, uint32& OutPayloadOffset) const;
+	static int64 TimestampToTicks(const FInterface& Interface, uint64 Timestamp);
+	static uint16 Read16(const uint8* Bytes, bool Swapped);
+	static uint32 Read32(const uint8* Bytes, bool Swapped);
+	/**
+	 * Parses the packet at the current position into the pending packet if it has not been already.
+	 */
+	bool ParsePending();
+
+	FFileWindow Window;
+	TSet<uint16> Ports;
+	TSet<uint32> Addresses;
+
+	FParseState FirstState;
+	FParseState State;
+	//Only set while scanning the file when it is opened
+	bool CountingPackets = false;
+	bool HasPending = false;
+	FDISCaptureRecordHeader PendingRecord;
+	int64 PendingPayloadOffset = 0;
+
+	//Parse states about a second of capture time apart, built when opening
+	TArray<TPair<int64, FParseState>> SeekPoints;
+
+	int64 StartTicks = 0;
+	int64 EndTicks = 0;
+	int64 NumMatchingPackets = 0;
+	int64 NumSkippedPackets = 0;
+	int64 NumFragmentedPackets = 0;
+};
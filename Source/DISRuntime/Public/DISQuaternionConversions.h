@@ -0,0 +1,96 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include "CoreMinimal.h"
+
+/**
+ * Inline quaternion conversions between the DIS body frame and Unreal rotations, shared by DIS_BPFL, the batch conversions, and the benchmarks.
+ *
+ * An entity orientation is composed as EngineQuat = FlipY(EcefToEngine * Body) * BodyToActorAxes where:
+ *  - Body is the Psi, Theta, Phi (Z-Y-X Euler) rotation of the entity relative to the ECEF axes.
+ *  - EcefToEngine rotates ECEF directions into the engine frame with its Y axis flipped, which makes it right handed.
+ *  - FlipY mirrors the result back into Unreal's left handed frame.
+ *  - BodyToActorAxes turns the DIS body axes (X forward, Y right, Z down) into actor axes (X forward, Y right, Z up).
+ */
+namespace DISQuaternion
+{
+	//180 degree rotation about X, glm quaternions are constructed as (w, x, y, z)
+	const glm::dquat BodyToActorAxes = glm::dquat(0., 1., 0., 0.);
+
+	/**
+	 * Rotation of the Psi, Theta, Phi Euler angles. Equal to Z(Psi) * Y(Theta) * X(Phi) without building the intermediate quaternions.
+	 */
+	FORCEINLINE glm::dquat FromPsiThetaPhiRadians(const double PsiRadians, const double ThetaRadians, const double PhiRadians)
+	{
+		const double sy = FMath::Sin(PsiRadians / 2), cy = FMath::Cos(PsiRadians / 2);
+		const double sp = FMath::Sin(ThetaRadians / 2), cp = FMath::Cos(ThetaRadians / 2);
+		const double sr = FMath::Sin(PhiRadians / 2), cr = FMath::Cos(PhiRadians / 2);
+
+		return glm::dquat(cr * cp * cy + sr * sp * sy,
+			sr * cp * cy - cr * sp * sy,
+			cr * sp * cy + sr * cp * sy,
+			cr * cp * sy - sr * sp * cy);
+	}
+
+	/**
+	 * Psi, Theta, Phi Euler angles of the given rotation. Theta is clamped to +-90 degrees.
+	 */
+	FORCEINLINE void ToPsiThetaPhiRadians(const glm::dquat& Rotation, double& OutPsiRadians, double& OutThetaRadians, double& OutPhiRadians)
+	{
+		const double w = Rotation.w, x = Rotation.x, y = Rotation.y, z = Rotation.z;
+
+		OutPsiRadians = FMath::Atan2(2 * (w * z + x * y), 1 - 2 * (y * y + z * z));
+		OutThetaRadians = FMath::Asin(FMath::Clamp(2 * (w * y - z * x), -1., 1.));
+		OutPhiRadians = FMath::Atan2(2 * (w * x + y * z), 1 - 2 * (x * x + y * y));
+	}
+
+	/**
+	 * Mirrors a rotation across the XZ plane, converting between Unreal's left handed frame and its right handed counterpart.
+	 */
+	FORCEINLINE glm::dquat FlipY(const glm::dquat& Rotation)
+	{
+		return glm::dquat(Rotation.w, -Rotation.x, Rotation.y, -Rotation.z);
+	}
+
+	/**
+	 * Rotation from ECEF into the Y flipped engine frame given the North, East, Down unit vectors at a location in both frames.
+	 * Both sets of vectors are the columns of their matrices.
+	 */
+	FORCEINLINE glm::dquat EcefToEngineFromNorthEastDown(const glm::dmat3& EngineNorthEastDown, const glm::dmat3& EcefNorthEastDown)
+	{
+		glm::dmat3 flippedEngineNorthEastDown = EngineNorthEastDown;
+		for (int32 column = 0; column < 3; column++)
+		{
+			flippedEngineNorthEastDown[column].y *= -1;
+		}
+		return glm::normalize(glm::quat_cast(flippedEngineNorthEastDown) * glm::conjugate(glm::quat_cast(EcefNorthEastDown)));
+	}
+
+	/**
+	 * North, East, Down unit vectors in ECEF at the given geodetic latitude/longitude, as the columns of the returned matrix.
+	 */
+	FORCEINLINE glm::dmat3 EcefNorthEastDown(const double LatitudeRadians, const double LongitudeRadians)
+	{
+		const double sLat = FMath::Sin(LatitudeRadians), cLat = FMath::Cos(LatitudeRadians);
+		const double sLon = FMath::Sin(LongitudeRadians), cLon = FMath::Cos(LongitudeRadians);
+
+		return glm::dmat3(glm::dvec3(-sLat * cLon, -sLat * sLon, cLat),
+			glm::dvec3(-sLon, cLon, 0),
+			glm::dvec3(-cLat * cLon, -cLat * sLon, -sLat));
+	}
+
+	FORCEINLINE FQuat ToUnrealQuat(const glm::dquat& EcefToEngine, const glm::dquat& Body)
+	{
+		const glm::dquat engine = FlipY(EcefToEngine * Body) * BodyToActorAxes;
+		return FQuat(engine.x, engine.y, engine.z, engine.w);
+	}
+
+	FORCEINLINE glm::dquat FromUnrealQuat(const glm::dquat& EcefToEngine, const FQuat& UnrealQuat)
+	{
+		const glm::dquat engine(UnrealQuat.W, UnrealQuat.X, UnrealQuat.Y, UnrealQuat.Z);
+		return glm::conjugate(EcefToEngine) * FlipY(engine * glm::conjugate(BodyToActorAxes));
+	}
+}
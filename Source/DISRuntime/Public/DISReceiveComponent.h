@@ -7,6 +7,7 @@
 #include "DISEnumsAndStructs.h"
 #include "PDUMasterInclude.h"
 #include "GeoReferencingSystem.h"
+#include "WorldCollision.h"
 #include "DISReceiveComponent.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogDISReceiveComponent, Log, All);
@@ -25,6 +26,11 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FGroundClampingUpdate, TArray<FTrans
 DECLARE_STATS_GROUP(TEXT("GRILLDIS_Game"), STATGROUP_DISComponent, STATCAT_Advanced);
 DECLARE_CYCLE_STAT(TEXT("DoDeadReckoning"), STAT_DoDeadReckoning, STATGROUP_DISComponent);
 DECLARE_CYCLE_STAT(TEXT("GroundClamping"), STAT_GroundClamping, STATGROUP_DISComponent);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Ground Clamp Traces Issued"), STAT_GroundClampTracesIssued, STATGROUP_DISComponent);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Ground Clamp Traces Reused"), STAT_GroundClampTracesReused, STATGROUP_DISComponent);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Ground Clamp Grid Lookups"), STAT_GroundClampGridLookups, STATGROUP_DISComponent);
+
+class UDISTerrainElevationGrid;
 
 /**
  * The DISReceiveComponent handles basic receiving DIS functionality.
@@ -220,6 +226,24 @@ public:
 	 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|DIS Receive Component|DIS Settings")
 		TEnumAsByte<ETraceTypeQuery> GoundClampingCollisionChannel = UEngineTypes::ConvertToTraceType(ECollisionChannel::ECC_Visibility);
+	/**
+	 * Whether ground clamping traces should be batched through the async trace system.
+	 * Async trace results are consumed on the following frame, the most recent clamp result is used until then.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|DIS Receive Component|DIS Settings")
+		bool UseAsyncGroundClampingTraces = true;
+	/**
+	 * The distance in Unreal units the entity has to move horizontally since its last ground clamp trace before a new trace is issued.
+	 * While within this distance the cached ground hit location and normal are reused. Set to 0 to trace every update.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|DIS Receive Component|DIS Settings", meta = (ClampMin = "0"))
+		float GroundClampingRetraceDistance = 50.0f;
+	/**
+	 * Optional pre-baked elevation grid to ground clamp against instead of tracing.
+	 * Traces are still used outside of the grid and for tiles that were baked with dynamic geometry.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|DIS Receive Component|DIS Settings")
+		UDISTerrainElevationGrid* GroundClampingElevationGrid = nullptr;
 	/**
 	 * To automatically apply entity states to the owner actor.
 	 */
@@ -238,7 +262,24 @@ private:
 	float DeltaTimeSinceLastPDU = 0;
 	int NumberEntityStatePDUsReceived = 0;
 
+	//Cached results of the most recent ground clamping trace
+	FTraceDelegate GroundClampTraceDelegate;
+	bool GroundClampTracePending = false;
+	FTraceHandle PendingGroundClampTraceHandle;
+	uint64 PendingGroundClampTraceFrame = 0;
+	FVector PendingGroundClampTraceOrigin;
+	FVector PendingGroundClampUpDirection = FVector::UpVector;
+	bool HasGroundClampHit = false;
+	FVector GroundClampTraceOrigin;
+	FVector GroundClampHitLocation;
+	FVector GroundClampHitNormal;
+	FVector GroundClampUpDirection = FVector::UpVector;
+	TArray<FTransform> GroundClampTransforms;
+
 	void UpdateCommonEntityStateInfo(FEntityStatePDU NewEntityStatePDU);
+	void IssueGroundClampTrace(FVector const& ActorLocation);
+	void OnGroundClampTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+	void ApplyGroundClamp(FVector const& ActorLocation);
 	FEntityStatePDU SmoothDeadReckoning(FEntityStatePDU DeadReckonPDUToSmooth);
 	void ApplyToOwnerIfActivated(FEntityStatePDU const& StatePDU);
 };
\ No newline at end of file
@@ -0,0 +1,42 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DISCaptureLog.h"
+
+/**
+ * A recording of received datagrams that the Replay Subsystem can replay, such as a capture log or a pcap file.
+ */
+class DISRUNTIME_API IDISReplaySource
+{
+public:
+	virtual ~IDISReplaySource() = default;
+
+	/**
+	 * Reads the datagram at the current position and moves past it. Returns false at the end of the recording.
+	 * OutPayload stays valid until the next call on the source.
+	 */
+	virtual bool ReadNext(FDISCaptureRecordHeader& OutRecord, TArrayView<const uint8>& OutPayload) = 0;
+
+	/**
+	 * Reads the timestamp of the datagram at the current position without moving past it. Returns false at the end of the recording.
+	 */
+	virtual bool PeekNextTicks(int64& OutTicks) = 0;
+
+	/**
+	 * Moves to the first datagram received at or after the given time, or to the end if every datagram is older.
+	 */
+	virtual void SeekToTicks(int64 Ticks) = 0;
+
+	/**
+	 * Moves back to the first datagram.
+	 */
+	virtual void Rewind() = 0;
+
+	/**
+	 * UTC FDateTime ticks of the first and last datagram in the recording.
+	 */
+	virtual int64 GetStartTicks() const = 0;
+	virtual int64 GetEndTicks() const = 0;
+};
@@ -0,0 +1,293 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "DISColumnarArchive.h"
+#include "DISKeyframeArchive.h"
+#include "DISPcapReader.h"
+#include "DISReplaySource.h"
+#include "DISReplaySubsystem.generated.h"
+
+//Forward declarations
+class UPDUProcessor;
+class UUDPSubsystem;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDISReplay, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("DISReplay_Game"), STATGROUP_DISReplay, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Replay Tick"), STAT_ReplayTick, STATGROUP_DISReplay);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Replayed Packets"), STAT_ReplayedPackets, STATGROUP_DISReplay);
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FDISReplayFinished);
+
+UENUM(BlueprintType)
+enum class EDISReplayTarget : uint8
+{
+	//Replayed datagrams go straight to Process DIS Packet on the PDU Processor
+	PDUProcessor,
+	//Replayed datagrams are broadcast through On Received Bytes on the UDP Subsystem, as if they had been received on a game thread receive socket
+	ReceivedBytes
+};
+
+USTRUCT(BlueprintType)
+struct FDISReplaySettings
+{
+	GENERATED_BODY()
+
+	/** Directory the capture was written to. Defaults to Saved/DISCaptures when empty. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Replay Subsystem|Structs")
+		FString Directory;
+
+	/** Where replayed datagrams are injected. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Replay Subsystem|Structs")
+		EDISReplayTarget Target = EDISReplayTarget::PDUProcessor;
+
+	/** Speed of the replay relative to the time the datagrams were captured. 1 replays in real time. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Replay Subsystem|Structs", Meta = (UIMin = 0.01, ClampMin = 0.01))
+		float PlaybackRate = 1.0f;
+
+	/** Ignores the capture timing and injects datagrams for the whole frame budget every frame. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Replay Subsystem|Structs")
+		bool AsFastAsPossible = false;
+
+	/** Longest time spent injecting datagrams each frame. A replay that cannot keep up falls behind rather than stalling the frame. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Replay Subsystem|Structs", Meta = (UIMin = 0.1, ClampMin = 0.1))
+		float FrameBudgetMilliseconds = 8.0f;
+
+	/** Opens the capture paused at its first datagram. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Replay Subsystem|Structs")
+		bool StartPaused = false;
+};
+
+USTRUCT(BlueprintType)
+struct FDISReplayStats
+{
+	GENERATED_BODY()
+
+	/** Position of the replay in seconds from the first captured datagram. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Replay Subsystem|Structs")
+		float CurrentSeconds = 0;
+
+	/** Time from the first to the last captured datagram. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Replay Subsystem|Structs")
+		float DurationSeconds = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Replay Subsystem|Structs")
+		int64 PacketsReplayed = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Replay Subsystem|Structs")
+		int64 BytesReplayed = 0;
+
+	/** Capture time replayed per second of wall time spent playing. Falls below the playback rate when the replay cannot keep up. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Replay Subsystem|Structs")
+		float AchievedRate = 0;
+
+	/** Datagrams replayed per second of wall time spent playing. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Replay Subsystem|Structs")
+		float PacketsPerSecond = 0;
+
+	/** Datagrams read and decoded per second of time spent injecting them, including everything bound to the PDU events. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Replay Subsystem|Structs")
+		float DecodePacketsPerSecond = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Replay Subsystem|Structs")
+		float DecodeMegabytesPerSecond = 0;
+
+	/** Time the last seek took, including rebuilding the exercise state from a keyframe. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Replay Subsystem|Structs")
+		float LastSeekMilliseconds = 0;
+
+	/** True once every datagram of the capture has been replayed. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Replay Subsystem|Structs")
+		bool Finished = false;
+};
+
+/**
+ * Replays capture logs written by the Capture Subsystem, or pcap files, into the plugin without the network, in real time, faster or slower, or as fast as possible.
+ * Datagrams are injected on the game thread during the subsystem's tick, so everything bound to the PDU Processor sees them as it would received ones.
+ */
+UCLASS()
+class DISRUNTIME_API UDISReplaySubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	// Begin USubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End USubsystem
+
+	// Begin FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override { return Source.IsValid() && !Paused; }
+	virtual TStatId GetStatId() const override { RETURN_QUICK_DECLARE_CYCLE_STAT(UDISReplaySubsystem, STATGROUP_Tickables); }
+	// End FTickableGameObject
+
+	/**
+	 * Opens a capture and starts replaying it from its first datagram. Stops any replay already running.
+	 * Returns whether or not the capture could be opened.
+	 * @param CaptureName - Name the segment files of the capture start with.
+	 * @param Settings - Where to inject the datagrams and how fast.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Replay Subsystem")
+		bool StartReplay(const FString& CaptureName, FDISReplaySettings Settings);
+
+	/**
+	 * Opens a pcap or pcapng file and starts replaying the UDP datagrams in it that pass the filter. Stops any replay already running.
+	 * Returns whether or not the file could be opened.
+	 * @param FilePath - The pcap or pcapng file to replay.
+	 * @param Filter - The destination ports and addresses to replay.
+	 * @param Settings - Where to inject the datagrams and how fast. The directory is not used.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Replay Subsystem")
+		bool StartPcapReplay(const FString& FilePath, FDISPcapFilter Filter, FDISReplaySettings Settings);
+
+	/**
+	 * Opens a columnar archive written by Archive Capture and starts replaying it. Stops any replay already running.
+	 * Returns whether or not the archive could be opened.
+	 * @param FilePath - The archive to replay.
+	 * @param Settings - Where to inject the datagrams and how fast. The directory is not used.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Replay Subsystem")
+		bool StartArchiveReplay(const FString& FilePath, FDISReplaySettings Settings);
+
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Replay Subsystem")
+		void StopReplay();
+
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Replay Subsystem")
+		void PauseReplay();
+
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Replay Subsystem")
+		void ResumeReplay();
+
+	/**
+	 * Pauses the replay and injects the next datagrams immediately. Returns how many were injected.
+	 * @param NumPackets - Number of datagrams to inject.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Replay Subsystem")
+		int32 StepReplay(int32 NumPackets = 1);
+
+	/**
+	 * Moves the replay to the first datagram at or after the given time.
+	 * Captures with a keyframe archive are brought to their exact state at that time: entities gone by then are deactivated,
+	 * the rest are injected from the last keyframe before it, followed by the datagrams between the keyframe and the time.
+	 * Otherwise the datagrams skipped over are not injected.
+	 * @param SecondsFromStart - Time in seconds from the first captured datagram.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Replay Subsystem")
+		void SeekReplay(float SecondsFromStart);
+
+	/**
+	 * Changes the speed of a running replay.
+	 * @param PlaybackRate - Speed relative to the time the datagrams were captured.
+	 * @param AsFastAsPossible - Ignores the capture timing when set.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Replay Subsystem")
+		void SetPlaybackRate(float PlaybackRate, bool AsFastAsPossible);
+
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Replay Subsystem")
+		bool IsReplaying() const { return Source.IsValid(); }
+
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Replay Subsystem")
+		bool IsReplayPaused() const { return Paused; }
+
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Replay Subsystem")
+		FDISReplayStats GetReplayStats() const;
+
+	/**
+	 * Decodes every datagram of a capture through the PDU Processor in one blocking call and returns the throughput.
+	 * Used as the decode benchmark, independent of any running replay.
+	 * @param CaptureName - Name the segment files of the capture start with.
+	 * @param Directory - Directory the capture was written to. Defaults to Saved/DISCaptures when empty.
+	 * @param Passes - Number of times to decode the whole capture.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Replay Subsystem")
+		FDISReplayStats RunDecodeBenchmark(const FString& CaptureName, const FString& Directory, int32 Passes = 1);
+
+	/**
+	 * Builds the keyframe archive of a capture written without one, or with a different interval. Blocks until done.
+	 * Returns whether or not the capture could be read and the archive written.
+	 * @param CaptureName - Name the segment files of the capture start with.
+	 * @param Directory - Directory the capture was written to. Defaults to Saved/DISCaptures when empty.
+	 * @param IntervalSeconds - Capture time between keyframes.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Replay Subsystem")
+		bool BuildKeyframes(const FString& CaptureName, const FString& Directory, float IntervalSeconds = 10.0f);
+
+	/**
+	 * Compacts a capture into a delta encoded columnar archive named <CaptureName>.disarc next to it for long term storage, then decodes it again to verify it.
+	 * Blocks until done. Returns the compression ratio and the encode and decode throughput.
+	 * @param CaptureName - Name the segment files of the capture start with.
+	 * @param Directory - Directory the capture was written to. Defaults to Saved/DISCaptures when empty.
+	 * @param Codec - Compression applied to the columns of the archive.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Replay Subsystem")
+		FDISArchiveStats ArchiveCapture(const FString& CaptureName, const FString& Directory, EDISArchiveCodec Codec = EDISArchiveCodec::LZ4);
+
+	/**
+	 * Called once every datagram of the capture has been replayed.
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "GRILL DIS|Replay Subsystem|Events")
+		FDISReplayFinished OnReplayFinished;
+
+	static FString GetCaptureDirectory(const FString& Directory);
+
+private:
+	/**
+	 * Takes over an opened source and starts replaying it.
+	 */
+	void BeginReplay(TUniquePtr<IDISReplaySource> InSource, const FDISReplaySettings& Settings, const FString& SourceName);
+	/**
+	 * Injects the next datagram of the source into the replay target. Returns false at the end of the recording.
+	 */
+	bool InjectNextPacket(IDISReplaySource& InSource, EDISReplayTarget Target, FDISCaptureRecordHeader& OutRecord);
+	/**
+	 * Injects the next datagram of the replay, following the exercise state when the capture has keyframes. Returns false at the end of the recording.
+	 */
+	bool ReplayNextPacket(FDISCaptureRecordHeader& OutRecord);
+	void InjectDatagram(const FDISCaptureRecordHeader& Record, TArrayView<const uint8> Payload, EDISReplayTarget Target);
+	/**
+	 * Brings the exercise to its state at the given time from the nearest keyframe before it.
+	 */
+	void SeekWithKeyframes(int64 SeekTicks);
+	/**
+	 * Anchors the replay clock at the current position and wall time.
+	 */
+	void AnchorClock();
+	void FinishReplay();
+
+	UPROPERTY()
+		UPDUProcessor* PDUProcessor = nullptr;
+	UPROPERTY()
+		UUDPSubsystem* UDPSubsystem = nullptr;
+
+	TUniquePtr<IDISReplaySource> Source;
+	//The source when replaying a capture log, for moving it to keyframe positions
+	FDISCaptureReader* CaptureReader = nullptr;
+	FDISKeyframeArchive Keyframes;
+	//Exercise state injected so far, only followed when the capture has keyframes
+	FDISExerciseStateTracker ReplayedState;
+	FDISReplaySettings ReplaySettings;
+	bool Paused = false;
+	bool Finished = false;
+
+	//Capture time reached by the replay, in UTC FDateTime ticks
+	int64 CurrentTicks = 0;
+	int64 AnchorTicks = 0;
+	double AnchorWallSeconds = 0;
+	double LastTickWallSeconds = 0;
+
+	int64 PacketsReplayed = 0;
+	int64 BytesReplayed = 0;
+	double PlayingWallSeconds = 0;
+	double ReplayedCaptureSeconds = 0;
+	double InjectSeconds = 0;
+	double LastSeekMilliseconds = 0;
+
+	//Reused for every injected datagram, since the PDU Processor takes an array
+	TArray<uint8> PacketBytes;
+};
@@ -7,15 +7,51 @@
 #include "DISEnumsAndStructs.h"
 #include "PDUMasterInclude.h"
 #include "UDPSubsystem.h"
+#include "Curves/CurveFloat.h"
 #include "Components/ActorComponent.h"
 #include "DISSendComponent.generated.h"
 
 //Forward declarations
 class ADISGameManager;
 class AGeoReferencingSystem;
+class UDISSendManager;
+class USceneComponent;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogDISSendComponent, Log, All);
 
+DECLARE_STATS_GROUP(TEXT("DISSendComponent_Game"), STATGROUP_DISSendComponent, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("UpdateKinematicSnapshot"), STAT_UpdateKinematicSnapshot, STATGROUP_DISSendComponent);
+DECLARE_DWORD_COUNTER_STAT(TEXT("KinematicSnapshotsCalculated"), STAT_KinematicSnapshotsCalculated, STATGROUP_DISSendComponent);
+DECLARE_DWORD_COUNTER_STAT(TEXT("KinematicSnapshotsReused"), STAT_KinematicSnapshotsReused, STATGROUP_DISSendComponent);
+DECLARE_DWORD_COUNTER_STAT(TEXT("ThresholdChecksSkipped"), STAT_ThresholdChecksSkipped, STATGROUP_DISSendComponent);
+DECLARE_DWORD_COUNTER_STAT(TEXT("StateChanges"), STAT_StateChanges, STATGROUP_DISSendComponent);
+DECLARE_DWORD_COUNTER_STAT(TEXT("StateChangePDUsSent"), STAT_StateChangePDUsSent, STATGROUP_DISSendComponent);
+
+/**
+ * Position and orientation of a sending actor in every convention the DIS Send Component uses, converted once per frame.
+ * Shared by the threshold checks, Entity State PDU forming, and the linear velocity calculations.
+ */
+struct DISRUNTIME_API FDISKinematicSnapshot
+{
+	uint64 FrameNumber = MAX_uint64;
+	//Whether the geospatial values were calculated. False when there is no GeoReferencing System.
+	bool GeoReferenced = false;
+
+	FVector UnrealLocation = FVector::ZeroVector;
+	FRotator UnrealRotation = FRotator::ZeroRotator;
+	FQuat UnrealQuat = FQuat::Identity;
+
+	FEarthCenteredEarthFixedDouble EcefLocation;
+	FLatLonHeightDouble LatLonHeightDegreesMeters;
+	FHeadingPitchRoll HeadingPitchRollDegrees;
+	FPsiThetaPhi PsiThetaPhiRadians;
+	//Psi, Theta, Phi as a quaternion, see UDeadReckoning_BPFL::GetEntityOrientationQuaternion
+	FQuat EntityOrientationQuaternion = FQuat::Identity;
+
+	//ECEF location of the Unreal world origin
+	FEarthCenteredEarthFixedDouble OriginEcefLocation;
+};
+
 /**
  * The DISSendComponent handles basic sending DIS functionality.
  * It should be attached to actors where sending DIS is desired.
@@ -29,30 +65,39 @@ class DISRUNTIME_API UDISSendComponent : public UActorComponent
 {
 	GENERATED_BODY()
 
+	//The send manager evaluates and sends on behalf of registered components
+	friend class UDISSendManager;
+
 public:
 	// Sets default values for this component's properties
 	UDISSendComponent();
 
 	/**
 	 * Updates the Capabilities that the entity has.
+	 * Changes made within a frame are sent together in one Entity State PDU at the end of the frame.
 	 * @param NewEntityCapabilities The new DIS capabilities that the entity has.
+	 * @param SendImmediately Send the Entity State PDU now instead of at the end of the frame.
 	*/
 	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|DIS Send Component")
-		void SetEntityCapabilities(int32 NewEntityCapabilities);
+		void SetEntityCapabilities(int32 NewEntityCapabilities, bool SendImmediately = false);
 
 	/**
 	 * Updates the appearance of the entity.
+	 * Changes made within a frame are sent together in one Entity State PDU at the end of the frame.
 	 * @param NewEntityAppearance The new appearance that the entity has.
+	 * @param SendImmediately Send the Entity State PDU now instead of at the end of the frame.
 	*/
 	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|DIS Send Component")
-		void SetEntityAppearance(int32 NewEntityAppearance);
+		void SetEntityAppearance(int32 NewEntityAppearance, bool SendImmediately = false);
 
 	/**
 	 * Updates the Dead Reckoning algorithm being used by the Send Component.
+	 * Changes made within a frame are sent together in one Entity State PDU at the end of the frame.
 	 * @param NewDeadReckoningAlgorithm The new dead reckoning algorithm to use.
+	 * @param SendImmediately Send the Entity State PDU now instead of at the end of the frame.
 	*/
 	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|DIS Send Component")
-		void SetDeadReckoningAlgorithm(EDeadReckoningAlgorithm NewDeadReckoningAlgorithm);
+		void SetDeadReckoningAlgorithm(EDeadReckoningAlgorithm NewDeadReckoningAlgorithm, bool SendImmediately = false);
 
 	/**
 	 * Compares the current Dead Reckoning location/orientation to the actual location/orientation of the entity.
@@ -113,6 +158,87 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|DIS Send Component")
 		FVector CalculateAngularVelocity();
 
+	/**
+	 * Returns the position threshold in meters after scaling by the distance to the nearest remote observer.
+	*/
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|DIS Send Component")
+		float GetScaledPositionThresholdMeters() const { return DeadReckoningPositionThresholdMeters * ObserverThresholdScale; }
+	/**
+	 * Returns the orientation threshold in degrees after scaling by the distance to the nearest remote observer.
+	*/
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|DIS Send Component")
+		float GetScaledOrientationThresholdDegrees() const { return DeadReckoningOrientationThresholdDegrees * ObserverThresholdScale; }
+	/**
+	 * Returns the heartbeat in seconds after scaling by the distance to the nearest remote observer, capped at MaximumScaledHeartbeatSeconds.
+	*/
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|DIS Send Component")
+		float GetScaledHeartbeatSeconds() const;
+	/**
+	 * Returns the most recent Entity State PDU dead reckoned to now, which is what remote simulations currently show for this entity.
+	 * Dead reckons on every call rather than reading MostRecentDeadReckonedEntityStatePDU, which is only refreshed by threshold checks.
+	*/
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|DIS Send Component")
+		FEntityStatePDU GetCurrentDeadReckonedEntityStatePDU() const;
+
+	/**
+	 * Returns the kinematic snapshot of the owning actor for the current frame.
+	 * Recalculated on the first call each frame, or when the actor has moved since the snapshot was taken.
+	*/
+	const FDISKinematicSnapshot& GetKinematicSnapshot();
+
+	/**
+	 * The position half of CheckDeadReckoningThreshold without the component state, so offline tools send on exactly the same test.
+	 * Returns whether the actual location differs from the dead reckoned one by more than the threshold along any ECEF axis.
+	 * @param DeadReckonedEntityStatePDU The most recent Entity State PDU dead reckoned to now.
+	 * @param ActualEcefLocation The actual location of the entity.
+	 * @param PositionThresholdMeters The position threshold, after any scaling.
+	*/
+	static bool IsPositionOutsideThreshold(const FEntityStatePDU& DeadReckonedEntityStatePDU, const FEarthCenteredEarthFixedDouble& ActualEcefLocation, float PositionThresholdMeters);
+
+	/**
+	 * The test of CheckOrientationQuaternionThreshold without the component state, so offline tools send on exactly the same test.
+	 * Returns whether the actual orientation differs from the dead reckoned one by more than the threshold.
+	 * @param SentEntityStatePDU The most recent Entity State PDU sent.
+	 * @param DeltaTimeSinceSent The time since it was sent.
+	 * @param ActualOrientationQuaternion The actual orientation of the entity, from UDeadReckoning_BPFL::GetEntityOrientationQuaternion.
+	 * @param OrientationThresholdDegrees The orientation threshold, after any scaling.
+	*/
+	static bool IsOrientationOutsideThreshold(const FEntityStatePDU& SentEntityStatePDU, float DeltaTimeSinceSent, const FQuat& ActualOrientationQuaternion, float OrientationThresholdDegrees);
+
+	/**
+	 * Sets the dead reckoning parameters and linear velocity FormEntityStatePDU sends, taking the ECEF or body velocities depending on the algorithm.
+	 * The entity location and orientation must already be set on the PDU.
+	*/
+	static void SetDeadReckoningParameters(FEntityStatePDU& EntityStatePDU, EDeadReckoningAlgorithm Algorithm, const FVector& AngularVelocity, const FVector& ECEFLinearVelocity,
+		const FVector& ECEFLinearAcceleration, const FVector& BodyLinearVelocity, const FVector& BodyLinearAcceleration);
+
+	/**
+	 * The angular velocity estimate of CalculateAngularVelocity without the component state, so offline tools estimate exactly the same way.
+	 * Returns the rotation from the previous to the current orientation as axis times angle over the interval, in the axes of the quaternions.
+	 * @param PreviousQuat The orientation at the last calculation.
+	 * @param CurrentQuat The orientation now.
+	 * @param DeltaSeconds The time since the last calculation. Must be greater than zero.
+	*/
+	static FVector CalculateAngularVelocityBetween(FQuat PreviousQuat, FQuat CurrentQuat, double DeltaSeconds);
+
+	/**
+	 * The body acceleration estimate of CalculateBodyLinearVelocityAndAcceleration without the component state, so offline tools estimate exactly the same way.
+	 * Returns the change in body velocity over the interval plus the body centripetal acceleration, which the body dead reckoning algorithms remove again.
+	 * @param BodyLinearVelocity The body velocity now.
+	 * @param PreviousBodyLinearVelocity The body velocity at the last calculation, in the body axes it was calculated in.
+	 * @param AngularVelocity The angular velocity in DIS body axes.
+	 * @param DeltaSeconds The time since the last calculation. Must be greater than zero.
+	*/
+	static FVector CalculateBodyLinearAccelerationBetween(const FVector& BodyLinearVelocity, const FVector& PreviousBodyLinearVelocity, const FVector& AngularVelocity, double DeltaSeconds);
+
+	/**
+	 * The scale UpdateObserverThresholdScale applies to the thresholds and heartbeat, without the component state.
+	 * @param ScaleCurve The multiplier by distance in meters to the nearest remote observer, as in ObserverDistanceThresholdScale.
+	 * @param SendManager The send manager tracking the remote observers.
+	 * @param EcefLocation The location of the entity.
+	*/
+	static float EvaluateObserverThresholdScale(const FRuntimeFloatCurve& ScaleCurve, const UDISSendManager& SendManager, const FEarthCenteredEarthFixedDouble& EcefLocation);
+
 	/**
 	 * The most recent Entity State PDU that has been received.
 	*/
@@ -121,6 +247,8 @@ public:
 
 	/**
 	 * The most recent Dead Reckoned Entity State PDU that has been calculated.
+	 * Only refreshed when a dead reckoning threshold check runs, so it lags behind while checks are scheduled out or the DIS Send Manager skips this entity.
+	 * Use Get Current Dead Reckoned Entity State PDU for the state remote simulations show now.
 	*/
 	UPROPERTY(BlueprintReadWrite, Category = "GRILL DIS|DIS Receive Component|DIS Info")
 		FEntityStatePDU MostRecentDeadReckonedEntityStatePDU;
@@ -199,6 +327,52 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|DIS Send Component|DIS Settings", Meta = (UIMin = 0, ClampMin = 0))
 		float DeadReckoningOrientationThresholdDegrees = 3;
 
+	/**
+	 * Whether to skip dead reckoning threshold checks until the earliest time the thresholds could be exceeded.
+	 * The time is estimated from the current error and bounds on the entity's acceleration and angular acceleration. Teleports and large jumps force a check.
+	 * Only applies to the world dead reckoning algorithms (Static, FPW, RPW, RVW, FVW).
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|DIS Send Component|DIS Settings")
+		bool ScheduleThresholdChecks = true;
+	/**
+	 * The smallest linear acceleration bound used when scheduling threshold checks. The peak observed acceleration is used when it is larger.
+	 * This value should be in meters per second squared.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|DIS Send Component|DIS Settings", Meta = (UIMin = 0, ClampMin = 0, EditCondition = "ScheduleThresholdChecks"))
+		float MinimumAccelerationBoundMetersPerSecondSquared = 10;
+	/**
+	 * The smallest angular acceleration bound used when scheduling threshold checks. The peak observed angular acceleration is used when it is larger.
+	 * This value should be in radians per second squared.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|DIS Send Component|DIS Settings", Meta = (UIMin = 0, ClampMin = 0, EditCondition = "ScheduleThresholdChecks"))
+		float MinimumAngularAccelerationBoundRadiansPerSecondSquared = 1;
+
+	/**
+	 * How many times past its threshold the dead reckoning error has to be for an update to be sent as high priority.
+	 * Lower priority updates may be deferred when the send sockets are over their bandwidth budget.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|DIS Send Component|DIS Settings", Meta = (UIMin = 1, ClampMin = 1))
+		float HighPriorityThresholdMultiple = 2;
+
+	/**
+	 * Whether to scale the dead reckoning thresholds and heartbeat by the distance to the nearest remote observer, so entities far from every remote viewer send less often.
+	 * Remote observers are the remote entities of the kinds set on the DIS Send Manager, tracked from their incoming Entity State PDUs.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|DIS Send Component|DIS Settings")
+		bool ScaleThresholdsByObserverDistance = false;
+	/**
+	 * Multiplier for the thresholds and heartbeat by distance in meters to the nearest remote observer. The last key's value is used beyond it and when there are no remote observers.
+	 * Defaults to no scaling within 1 km, rising to 10 times at 50 km.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|DIS Send Component|DIS Settings", Meta = (XAxisName = "Distance (m)", YAxisName = "Scale", EditCondition = "ScaleThresholdsByObserverDistance"))
+		FRuntimeFloatCurve ObserverDistanceThresholdScale;
+	/**
+	 * The longest the heartbeat can be scaled to. Should stay below the time remote simulations wait before timing out an entity.
+	 * Does not shorten a DIS Heartbeat Seconds that is already longer.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|DIS Send Component|DIS Settings", Meta = (UIMin = 0, ClampMin = 0, EditCondition = "ScaleThresholdsByObserverDistance"))
+		float MaximumScaledHeartbeatSeconds = 10;
+
 protected:
 	virtual void BeginPlay() override;
 	// Called every frame
@@ -213,11 +387,79 @@ protected:
 	/**
 	 * Takes in an Entity State PDU and emits it as an Entity State or Entity State Update PDU. Decides based on what EntityStatePDUSendingMode is set to.
 	 * @param pduToSend The Entity State PDU to emit.
+	 * @param Priority How urgently the PDU needs to go out when the send sockets are over their bandwidth budget.
+	*/
+	bool EmitAppropriatePDU(FEntityStatePDU pduToSend, EUDPSendPriority Priority = EUDPSendPriority::High);
+
+	/**
+	 * Forms a new Entity State PDU, emits it, and resets the heartbeat timer.
+	 * @param Priority How urgently the PDU needs to go out when the send sockets are over their bandwidth budget.
+	*/
+	void EmitEntityStatePDU(EUDPSendPriority Priority = EUDPSendPriority::High);
+
+	/**
+	 * Returns whether a heartbeat Entity State PDU is due within the given time.
+	 * @param LookaheadSeconds How far ahead to look.
+	*/
+	bool IsHeartbeatDue(float LookaheadSeconds = 0) const;
+
+	/**
+	 * Sets the time since the last PDU at which the dead reckoning thresholds next need checking.
+	 * @param PositionErrorMeters The current distance between the actual and dead reckoned positions.
+	 * @param OrientationErrorRadians The current angle between the actual and dead reckoned orientations.
+	*/
+	void ScheduleNextThresholdCheck(double PositionErrorMeters, double OrientationErrorRadians);
+	/**
+	 * Sets the time since the last PDU at which the dead reckoning thresholds next need checking. Measures the current errors against MostRecentDeadReckonedEntityStatePDU.
 	*/
-	bool EmitAppropriatePDU(FEntityStatePDU pduToSend);
+	void ScheduleNextThresholdCheck();
+
+	/**
+	 * Marks the entity's appearance, capabilities, or dead reckoning algorithm as changed and schedules an Entity State PDU for the end of the frame.
+	 * @param SendImmediately Send the Entity State PDU now instead.
+	*/
+	void MarkStateChanged(bool SendImmediately);
+	/**
+	 * Sends an Entity State PDU if a state change is pending.
+	*/
+	void EmitPendingStateChange();
+	void HandleWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+
+	/**
+	 * Measures the distance and angle between the actual state and MostRecentDeadReckonedEntityStatePDU.
+	 * Returns false if there is no GeoReference to measure against.
+	*/
+	bool MeasureDeadReckoningError(double& OutPositionErrorMeters, double& OutOrientationErrorRadians);
+	/**
+	 * Returns the send priority of an update sent for crossing the dead reckoning thresholds, High when the error is past HighPriorityThresholdMultiple of a threshold.
+	*/
+	EUDPSendPriority GetThresholdSendPriority(double PositionErrorMeters, double OrientationErrorRadians) const;
+
+	/**
+	 * Forces a threshold check when the owner teleports or jumps further than the position threshold in a single move.
+	*/
+	void HandleOwnerTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	/**
+	 * Updates ObserverThresholdScale from the distance to the nearest remote observer.
+	*/
+	void UpdateObserverThresholdScale();
 
 private:
 	float DeltaTimeSinceLastPDU = 0;
+	//Whether a state change is waiting to be sent, cleared by any Entity State PDU sent
+	bool StateChangePending = false;
+	FDelegateHandle PostActorTickHandle;
+	//Shortens the first heartbeat interval so entities spawned together do not heartbeat together, cleared once a PDU is sent
+	float HeartbeatPhaseOffsetSeconds = 0;
+	//Threshold checks are skipped until DeltaTimeSinceLastPDU reaches this
+	float NextThresholdCheckSeconds = 0;
+	//Multiplier for the thresholds and heartbeat from the distance to the nearest remote observer
+	float ObserverThresholdScale = 1;
+	//Peak accelerations seen by UpdateEntityStateCalculations, decaying over time
+	float ObservedPeakAccelerationMetersPerSecondSquared = 0;
+	float ObservedPeakAngularAccelerationRadiansPerSecondSquared = 0;
+	FVector LastTransformUpdateLocation;
 
 	FTimerHandle UpdateEntityStateCalculationsHandle;
 	float TimeOfLastParametersCalculation;
@@ -231,7 +473,10 @@ private:
 	FVector LastCalculatedBodyLinearAcceleration;
 	FVector LastCalculatedAngularVelocity;
 
+	FDISKinematicSnapshot KinematicSnapshot;
+
 	AGeoReferencingSystem* GeoReferencingSystem;
 	ADISGameManager* DISGameManager;
 	UUDPSubsystem* UDPSubsystem;
+	TWeakObjectPtr<UDISSendManager> SendManager;
 };
@@ -0,0 +1,211 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DISEnumsAndStructs.h"
+#include "BatchConversions_BPFL.h"
+#include "Components/ActorComponent.h"
+#include "DISSendManager.generated.h"
+
+//Forward declarations
+class UDISSendComponent;
+class AGeoReferencingSystem;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDISSendManager, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("DISSendManager_Game"), STATGROUP_DISSendManager, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("EvaluateSendComponents"), STAT_EvaluateSendComponents, STATGROUP_DISSendManager);
+DECLARE_CYCLE_STAT(TEXT("EvaluateDeadReckoningThresholds"), STAT_EvaluateDeadReckoningThresholds, STATGROUP_DISSendManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("RegisteredSendComponents"), STAT_RegisteredSendComponents, STATGROUP_DISSendManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("EntityStatePDUsSent"), STAT_EntityStatePDUsSent, STATGROUP_DISSendManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("EarlyHeartbeatsSent"), STAT_EarlyHeartbeatsSent, STATGROUP_DISSendManager);
+DECLARE_DWORD_COUNTER_STAT(TEXT("RemoteObservers"), STAT_RemoteObservers, STATGROUP_DISSendManager);
+
+/**
+ * Structure of arrays holding what the batched dead reckoning threshold test needs for each entity.
+ * Only entities using a world dead reckoning algorithm (Static, FPW, RPW, RVW, FVW) are evaluated in the batch,
+ * everything else is marked as not batched and left to UDISSendComponent::CheckDeadReckoningThreshold.
+ */
+struct DISRUNTIME_API FDISSendThresholdBatch
+{
+	//Gathered from the actors
+	TArray<FVector> UnrealLocations;
+	TArray<FRotator> UnrealRotations;
+	TArray<double> DeltaTimesSinceLastPDU;
+	TArray<double> PositionThresholdsMeters;
+	TArray<double> OrientationThresholdsDegrees;
+
+	//Taken from the most recently sent Entity State PDU
+	TArray<bool> Batched;
+	FDISVectorArrayDouble SentLocations;
+	FDISVectorArrayDouble SentLinearVelocities;
+	FDISVectorArrayDouble SentLinearAccelerations;
+	FDISVectorArrayDouble SentAngularVelocities;
+	TArray<FQuat> SentOrientations;
+
+	//Outputs
+	FDISVectorArrayDouble EcefLocations;
+	FDISVectorArrayDouble PsiThetaPhiRadians;
+	FDISVectorArrayDouble DeadReckonedLocations;
+	TArray<FQuat> DeadReckonedOrientations;
+	TArray<bool> OutsideThreshold;
+	//Distance and angle between the actual and dead reckoned state, used to schedule the next threshold check
+	TArray<double> PositionErrorsMeters;
+	TArray<double> OrientationErrorsRadians;
+
+	int32 Num() const { return UnrealLocations.Num(); }
+
+	void SetNumUninitialized(int32 NewNum);
+
+	/**
+	 * Fills the last sent state of the entity at Index from an Entity State PDU. Sets Batched based on its dead reckoning algorithm.
+	 */
+	void SetSentState(int32 Index, const FEntityStatePDU& EntityStatePDU);
+};
+
+/**
+ * Evaluates every registered DIS Send Component in one pass per frame.
+ *
+ * Send components register with the manager owned by the DIS Game Manager and stop ticking on their own. Each frame the manager gathers
+ * the actor transforms once, runs the heartbeat and dead reckoning threshold tests over all entities with the batch conversions, then
+ * forms and emits only the Entity State PDUs that are due. Entities whose next threshold check is scheduled later are left out of the pass.
+ */
+UCLASS(ClassGroup = (Custom), meta = (DisplayName = "DIS Send Manager"))
+class DISRUNTIME_API UDISSendManager : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UDISSendManager();
+
+	/**
+	 * Hands the given send component's Entity State PDU sending over to this manager and disables the component's tick.
+	 * Returns whether or not the component was registered.
+	 * @param SendComponent - The send component to register.
+	 */
+	bool RegisterSendComponent(UDISSendComponent* SendComponent);
+	/**
+	 * Stops managing the given send component.
+	 * @param SendComponent - The send component to unregister.
+	 */
+	void UnregisterSendComponent(UDISSendComponent* SendComponent);
+
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|DIS Send Manager")
+		int32 GetNumRegisteredSendComponents() const { return SendComponents.Num(); }
+
+	/**
+	 * Returns where in its heartbeat and calculation periods the next sending entity should start, as a fraction from 0 to 1.
+	 * Consecutive calls step through the period by the golden ratio so any number of entities spawned together end up evenly spread.
+	 * Returns 0 when SpreadHeartbeats is false.
+	 */
+	float AssignPhaseFraction();
+
+	/**
+	 * Tracks the sender of the given Entity State PDU as a remote observer if its entity kind is one of ObserverEntityKinds.
+	 * Deactivated entities stop being observers.
+	 */
+	void UpdateRemoteObserver(const FEntityStatePDU& EntityStatePDU);
+	/**
+	 * Moves an already tracked remote observer. Entity State Update PDUs carry no Entity Type, so entities not yet tracked are ignored.
+	 */
+	void UpdateRemoteObserverLocation(const FEntityID& EntityID, const TArray<double>& EcefLocation);
+	/**
+	 * Stops tracking the given remote observer.
+	 */
+	void RemoveRemoteObserver(const FEntityID& EntityID);
+	/**
+	 * Returns the distance in meters from the given ECEF location to the nearest remote observer. Returns false if there are none.
+	 */
+	bool GetNearestRemoteObserverDistanceMeters(const FEarthCenteredEarthFixedDouble& EcefLocation, double& OutDistanceMeters) const;
+
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|DIS Send Manager")
+		int32 GetNumRemoteObservers() const { return ObserverIDs.Num(); }
+
+	/**
+	 * Runs one pass over every registered send component, sending the Entity State PDUs that are due. Called every tick.
+	 * @param DeltaTime The time since the last pass.
+	 */
+	void EvaluateSendComponents(float DeltaTime);
+
+	/**
+	 * Runs the dead reckoning threshold test over every batched entity. UnrealLocations, UnrealRotations and the sent state must be filled in.
+	 * Fills in the ECEF locations, Psi, Theta, Phi, the dead reckoned state, the errors, and OutsideThreshold.
+	 */
+	static void EvaluateDeadReckoningThresholds(FDISSendThresholdBatch& Batch, AGeoReferencingSystem* InGeoReferencingSystem);
+
+	/**
+	 * Whether or not send components should register with the manager. When false they tick and send on their own.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GRILL DIS|DIS Send Manager")
+		bool UseSendManager = true;
+
+	/**
+	 * Whether to offset each sending entity's heartbeat and entity state calculation timer within their periods.
+	 * Keeps entities spawned in the same frame from sending their heartbeats in the same frame forever.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GRILL DIS|DIS Send Manager")
+		bool SpreadHeartbeats = true;
+
+	/**
+	 * The number of Entity State PDUs per frame to smooth towards. When above zero, heartbeats coming due within HeartbeatLookaheadSeconds
+	 * are sent early at an even rate while the frame is under this count. Heartbeats and threshold crossings that are due are always sent.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GRILL DIS|DIS Send Manager", Meta = (UIMin = 0, ClampMin = 0))
+		int32 TargetEntityStatePDUsPerFrame = 0;
+
+	/**
+	 * How far ahead of their deadline heartbeats may be sent early to smooth the per frame PDU count.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GRILL DIS|DIS Send Manager", Meta = (UIMin = 0, ClampMin = 0, EditCondition = "TargetEntityStatePDUsPerFrame > 0"))
+		float HeartbeatLookaheadSeconds = 1.0f;
+
+	/**
+	 * The DIS entity kinds of remote entities that count as observers for send components scaling their thresholds by observer distance.
+	 * Defaults to platforms (1) and life forms (3).
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GRILL DIS|DIS Send Manager")
+		TArray<int32> ObserverEntityKinds;
+	/**
+	 * How long a remote observer is kept without receiving an Entity State PDU or Entity State Update PDU for it.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GRILL DIS|DIS Send Manager", Meta = (UIMin = 0, ClampMin = 0))
+		float ObserverTimeoutSeconds = 30.0f;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/**
+	 * Sends the heartbeats of EarlyHeartbeatCandidates closest to their deadlines, as many as spreads them evenly over the lookahead window without going over the target.
+	 * Returns the number sent.
+	 * @param DeltaTime The length of this frame.
+	 * @param NumSentThisFrame The number of Entity State PDUs already sent this frame.
+	 */
+	int32 SendEarlyHeartbeats(float DeltaTime, int32 NumSentThisFrame);
+
+	/**
+	 * Drops remote observers that have not been updated within ObserverTimeoutSeconds.
+	 */
+	void RemoveStaleRemoteObservers();
+
+private:
+	TArray<TWeakObjectPtr<UDISSendComponent>> SendComponents;
+	//Components in the current pass, parallel to ThresholdBatch
+	TArray<UDISSendComponent*> PassComponents;
+	TArray<bool> HeartbeatDue;
+	//Components with a heartbeat coming due within the lookahead window that have not sent this frame
+	TArray<UDISSendComponent*> EarlyHeartbeatCandidates;
+	float NextPhaseFraction = 0;
+	FDISSendThresholdBatch ThresholdBatch;
+
+	void RemoveRemoteObserverAt(int32 Index);
+
+	//Remote observers as a structure of arrays for the nearest distance search
+	TMap<FEntityID, int32> ObserverIndices;
+	TArray<FEntityID> ObserverIDs;
+	FDISVectorArrayDouble ObserverLocations;
+	TArray<float> ObserverLastUpdateSeconds;
+
+	AGeoReferencingSystem* GeoReferencingSystem = nullptr;
+};
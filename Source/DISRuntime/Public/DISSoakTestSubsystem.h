@@ -0,0 +1,290 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "DISLoadGenerator.h"
+#include "DISSoakTestSubsystem.generated.h"
+
+//Forward declarations
+class ADISGameManager;
+class FDISSoakReceiveCounter;
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDISSoak, Log, All);
+
+USTRUCT(BlueprintType)
+struct FDISSoakSettings
+{
+	GENERATED_BODY()
+
+	/** Traffic sent to the plugin for the whole soak. Its duration is not used. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		FDISLoadGeneratorSettings Traffic;
+
+	/** How long to soak for. Not used by entity count sweeps, which run for one step per entity count. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Soak Test Subsystem|Structs", Meta = (ClampMin = 1))
+		float DurationSeconds = 3600;
+
+	/** Time between samples. Frame times are averaged over the interval. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Soak Test Subsystem|Structs", Meta = (ClampMin = 0.1))
+		float SampleIntervalSeconds = 10;
+
+	/** Samples taken before this time are recorded but not used for the drift checks, so that start up allocations and the first entities spawning are not counted as growth. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Soak Test Subsystem|Structs", Meta = (ClampMin = 0))
+		float WarmupSeconds = 120;
+
+	/** Largest growth in resident memory over the soak after warmup, taken from the fitted trend rather than the first and last samples. Zero or less disables the check. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		float MaxMemoryGrowthMegabytes = 256;
+
+	/** Largest growth in mean frame time over the soak after warmup, taken from the fitted trend. Zero or less disables the check. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		float MaxFrameTimeGrowthMilliseconds = 2;
+
+	/** Largest share of sent datagrams allowed to go missing. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Soak Test Subsystem|Structs", Meta = (ClampMin = 0, ClampMax = 1))
+		float MaxDroppedShare = 0.001f;
+
+	/** Entity counts to step through in an entity count sweep, in increasing order. Empty runs a soak instead. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		TArray<int32> SweepEntityCounts;
+
+	/** Time spent at each entity count of a sweep. The first quarter of each step is not measured, to let entities spawn. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Soak Test Subsystem|Structs", Meta = (ClampMin = 1))
+		float SweepStepSeconds = 60;
+
+	/** Entity updates each entity sends per second during a sweep, so that the packet rate grows with the entity count. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Soak Test Subsystem|Structs", Meta = (ClampMin = 0.01))
+		float SweepUpdatesPerEntityPerSecond = 5;
+
+	/** Mean frame time a sweep step may not exceed before it is counted as past the knee. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Soak Test Subsystem|Structs", Meta = (ClampMin = 0.1))
+		float FrameBudgetMilliseconds = 16.6f;
+
+	/** A sweep step whose frame time cost per added entity is this many times that of the first added entities is counted as past the knee. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Soak Test Subsystem|Structs", Meta = (ClampMin = 1))
+		float KneeFactor = 3;
+
+	/** Directory the samples are written to as CSV. Defaults to Saved/DISSoak when empty. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		FString Directory;
+
+	/** Exits the application when done, with exit code 0 if the run passed and 1 if it failed. For headless runs. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		bool ExitWhenFinished = false;
+};
+
+USTRUCT(BlueprintType)
+struct FDISSoakSample
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		float ElapsedSeconds = 0;
+
+	/** Entities the load generator was simulating. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		int32 GeneratedEntities = 0;
+
+	/** Mean time per frame over the sample interval, leaving out time the engine spent idling to hold its frame rate limit. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		float FrameMilliseconds = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		float MaxFrameMilliseconds = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		float ResidentMegabytes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		int32 ActorCount = 0;
+
+	/** Entities with an actor in the DIS Game Manager. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		int32 EntityMapSize = 0;
+
+	/** Received datagrams waiting to be broadcast on the game thread. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		int32 PendingGameThreadDatagrams = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		int64 DatagramsSent = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		int64 DatagramsReceived = 0;
+
+	/** Datagrams sent but not received by any receive socket. Includes those still in flight. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		int64 DatagramsDropped = 0;
+
+	/** UDP receive buffer overflows counted by the operating system since the run started. -1 where the platform does not report them. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		int64 ReceiveBufferErrors = -1;
+};
+
+USTRUCT(BlueprintType)
+struct FDISSweepStep
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		int32 Entities = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		float PacketsPerSecond = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		float FrameMilliseconds = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		float MaxFrameMilliseconds = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		float ResidentMegabytes = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		float DroppedShare = 0;
+
+	/** Frame time added per entity since the previous step. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		float MarginalMicrosecondsPerEntity = 0;
+};
+
+USTRUCT(BlueprintType)
+struct FDISSoakResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		bool Passed = false;
+
+	/** Why the run failed, empty if it passed. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		FString FailureReason;
+
+	/** Growth in resident memory after warmup, from the least squares trend of the samples. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		float MemoryGrowthMegabytes = 0;
+
+	/** Growth in mean frame time after warmup, from the least squares trend of the samples. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		float FrameTimeGrowthMilliseconds = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		float DroppedShare = 0;
+
+	/** Steps of an entity count sweep. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		TArray<FDISSweepStep> SweepSteps;
+
+	/** Largest entity count of the sweep before the knee. Zero if the first step was already past it, the last entity count if no step was. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		int32 KneeEntities = 0;
+
+	/** CSV file the samples were written to. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|Soak Test Subsystem|Structs")
+		FString SamplesFile;
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDISSoakFinished, const FDISSoakResult&, Result);
+
+/**
+ * Soaks the plugin on loopback: drives the game instance it lives in with a load generator and samples frame time, resident memory, actor count,
+ * entity map size, the receive queue, and dropped datagrams over time. Fails when memory or frame time drift past their thresholds or too many datagrams are dropped.
+ * Can instead sweep through entity counts to find where the frame cost per entity stops growing linearly.
+ * Meant to be run headless, e.g. -game -nullrhi -unattended -ExecCmds="DIS.Soak Start ... Exit".
+ */
+UCLASS()
+class DISRUNTIME_API UDISSoakTestSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	// Begin USubsystem
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	// End USubsystem
+
+	// Begin FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override { return IsSoaking(); }
+	virtual TStatId GetStatId() const override { RETURN_QUICK_DECLARE_CYCLE_STAT(UDISSoakTestSubsystem, STATGROUP_Tickables); }
+	// End FTickableGameObject
+
+	/**
+	 * Starts a soak, or an entity count sweep if the settings list entity counts. Stops any run already going.
+	 * Returns whether or not the load generator could be started.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Soak Test Subsystem")
+		bool StartSoak(FDISSoakSettings Settings);
+
+	/**
+	 * Stops the run early and evaluates the samples taken so far.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|Soak Test Subsystem")
+		void StopSoak();
+
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Soak Test Subsystem")
+		bool IsSoaking() const;
+
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Soak Test Subsystem")
+		TArray<FDISSoakSample> GetSamples() const { return Samples; }
+
+	/**
+	 * Result of the last finished run.
+	 */
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Soak Test Subsystem")
+		FDISSoakResult GetResult() const { return Result; }
+
+	UPROPERTY(BlueprintAssignable, Category = "GRILL DIS|Soak Test Subsystem|Events")
+		FDISSoakFinished OnSoakFinished;
+
+private:
+	TArray<FDISSoakSample> Samples;
+	FDISSoakResult Result;
+
+	//The soak is a development tool and is compiled out of shipping builds, where the subsystem is never created
+#if !UE_BUILD_SHIPPING
+	/**
+	 * Starts the load generator for the given sweep step, or for the soak when negative.
+	 */
+	bool StartGenerator(int32 StepIndex);
+	void TakeSample();
+	void FinishStep();
+	void Finish();
+	void EvaluateSoak();
+	void EvaluateSweep();
+	void WriteSample(const FDISSoakSample& Sample) const;
+
+	/**
+	 * UDP receive buffer overflows counted by the operating system, or -1 where the platform does not report them.
+	 */
+	static int64 ReadReceiveBufferErrors();
+
+	FDISSoakSettings Settings;
+	TUniquePtr<FDISLoadGenerator> Generator;
+	TSharedPtr<FDISSoakReceiveCounter, ESPMode::ThreadSafe> ReceiveCounter;
+	TWeakObjectPtr<ADISGameManager> GameManager;
+	FString SamplesFile;
+
+	double StartSeconds = 0;
+	double LastTickSeconds = 0;
+	double NextSampleSeconds = 0;
+	int64 StartReceiveBufferErrors = -1;
+
+	//Frame times since the last sample
+	double IntervalFrameSeconds = 0;
+	double IntervalMaxFrameSeconds = 0;
+	int32 IntervalFrames = 0;
+
+	//Sweep progress. Datagrams sent by the generators of finished steps, since every step starts a new generator
+	int32 StepIndex = INDEX_NONE;
+	double StepStartSeconds = 0;
+	int64 FinishedStepsDatagramsSent = 0;
+	int32 StepFirstSample = 0;
+#endif
+};
@@ -0,0 +1,141 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "Engine/EngineTypes.h"
+#include "Serialization/BulkData.h"
+#include "DISTerrainElevationGrid.generated.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogDISTerrainElevationGrid, Log, All);
+
+/**
+ * A single baked elevation sample. Normals are packed into signed bytes.
+ */
+struct FDISTerrainElevationSample
+{
+	float Height = 0.f;
+	int8 NormalX = 0;
+	int8 NormalY = 0;
+	int8 NormalZ = 127;
+	uint8 IsValid = 0;
+};
+
+/**
+ * Flags stored per baked tile.
+ */
+enum class EDISTerrainTileFlags : uint8
+{
+	None = 0,
+	//The tile has at least one baked sample
+	HasSamples = 1 << 0,
+	//The tile contains non-static geometry and should be ground clamped using traces instead
+	HasDynamicGeometry = 1 << 1
+};
+ENUM_CLASS_FLAGS(EDISTerrainTileFlags);
+
+/**
+ * Pre-baked elevation and normal grid of the level's ground collision. Used by the DIS Receive Component to ground clamp without physics traces.
+ *
+ * The grid is laid out along the engine X/Y axes with heights along engine Z, so it is intended for flat planet levels or areas near the georeference origin.
+ * Samples are stored in square tiles that share their border samples so that bilinear lookups never cross a tile boundary.
+ * Sample data lives in bulk data outside of the export so cooked builds can memory map it.
+ */
+UCLASS(BlueprintType)
+class DISRUNTIME_API UDISTerrainElevationGrid : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * The minimum engine X/Y corner of the area to bake.
+	 */
+	UPROPERTY(EditAnywhere, Category = "GRILL DIS|Bake Settings")
+		FVector2D BakeAreaMin = FVector2D(-100000.f, -100000.f);
+	/**
+	 * The maximum engine X/Y corner of the area to bake.
+	 */
+	UPROPERTY(EditAnywhere, Category = "GRILL DIS|Bake Settings")
+		FVector2D BakeAreaMax = FVector2D(100000.f, 100000.f);
+	/**
+	 * Distance in Unreal units between samples.
+	 */
+	UPROPERTY(EditAnywhere, Category = "GRILL DIS|Bake Settings", meta = (ClampMin = "1"))
+		float BakeSampleSpacing = 100.f;
+	/**
+	 * Number of sample cells along each edge of a tile.
+	 */
+	UPROPERTY(EditAnywhere, Category = "GRILL DIS|Bake Settings", meta = (ClampMin = "1", ClampMax = "1024"))
+		int32 BakeTileResolution = 64;
+	/**
+	 * Engine Z to start the downward bake traces from.
+	 */
+	UPROPERTY(EditAnywhere, Category = "GRILL DIS|Bake Settings")
+		float BakeTraceStartHeight = 1000000.f;
+	/**
+	 * Engine Z to end the downward bake traces at.
+	 */
+	UPROPERTY(EditAnywhere, Category = "GRILL DIS|Bake Settings")
+		float BakeTraceEndHeight = -1000000.f;
+	/**
+	 * The collision channel to sample. Should match the ground clamping collision channel of the receive components using this grid.
+	 */
+	UPROPERTY(EditAnywhere, Category = "GRILL DIS|Bake Settings")
+		TEnumAsByte<ETraceTypeQuery> BakeCollisionChannel = UEngineTypes::ConvertToTraceType(ECollisionChannel::ECC_Visibility);
+
+	/**
+	 * Engine X/Y location of the first sample of the baked grid.
+	 */
+	UPROPERTY(VisibleAnywhere, Category = "GRILL DIS|Baked Grid")
+		FVector2D GridOrigin = FVector2D::ZeroVector;
+	/**
+	 * Distance in Unreal units between baked samples.
+	 */
+	UPROPERTY(VisibleAnywhere, Category = "GRILL DIS|Baked Grid")
+		float GridSpacing = 100.f;
+	/**
+	 * Number of sample cells along each edge of a baked tile.
+	 */
+	UPROPERTY(VisibleAnywhere, Category = "GRILL DIS|Baked Grid")
+		int32 TileResolution = 0;
+	UPROPERTY(VisibleAnywhere, Category = "GRILL DIS|Baked Grid")
+		int32 NumTilesX = 0;
+	UPROPERTY(VisibleAnywhere, Category = "GRILL DIS|Baked Grid")
+		int32 NumTilesY = 0;
+	/**
+	 * Number of tiles that contain dynamic geometry and fall back to traces.
+	 */
+	UPROPERTY(VisibleAnywhere, Category = "GRILL DIS|Baked Grid")
+		int32 NumDynamicTiles = 0;
+
+	virtual void Serialize(FArchive& Ar) override;
+	virtual void BeginDestroy() override;
+
+	/**
+	 * Looks up the bilinearly interpolated ground height and normal below the given engine location.
+	 * Returns false if the location is outside of the grid, the tile is dynamic or not baked, or any of the surrounding samples missed the ground.
+	 */
+	bool SampleElevation(FVector const& EngineLocation, float& OutHeight, FVector& OutNormal) const;
+
+	/**
+	 * Replaces the baked grid. Tile samples are expected as (TileResolution + 1)^2 samples per tile, in tile order.
+	 * Tiles without samples should be passed with the HasSamples flag cleared and contribute no samples.
+	 */
+	void SetBakedData(FVector2D InGridOrigin, float InGridSpacing, int32 InTileResolution, int32 InNumTilesX, int32 InNumTilesY,
+		TArray<EDISTerrainTileFlags> const& InTileFlags, TArray<FDISTerrainElevationSample> const& InSamples);
+
+	/** Number of samples stored per tile including the shared border */
+	int32 GetSamplesPerTile() const { return (TileResolution + 1) * (TileResolution + 1); }
+
+private:
+	//Per tile flags and the first sample index of each tile, INDEX_NONE for tiles without samples
+	TArray<uint8> TileFlags;
+	TArray<int32> TileSampleOffsets;
+
+	FByteBulkData SampleBulkData;
+	mutable const FDISTerrainElevationSample* LockedSamples = nullptr;
+
+	const FDISTerrainElevationSample* GetSamples() const;
+	void ReleaseSamples();
+};
@@ -79,6 +79,15 @@ public:
 	 */
 	static void CalculateLatLonHeightFromEcefXYZ(const FEarthCenteredEarthFixedDouble Ecef, FLatLonHeightDouble& OutLatLonHeightDegreesMeters);
 
+	/**
+	 * Converts DIS X, Y, Z coordinates (ECEF) to Latitude, Longitude, and Height (LLH) all in double (64-bit) precision using the given solver.
+	 * The overload without a solver uses the one selected by the DIS.Geodetic.EcefToGeodeticSolver console variable.
+	 * @param Ecef The ECEF location
+	 * @param Solver The ECEF to geodetic solver to use
+	 * @param OutLatLonHeightDegreesMeters The converted latitude in degrees, longitude in degrees, and height in meters
+	 */
+	static void CalculateLatLonHeightFromEcefXYZ(const FEarthCenteredEarthFixedDouble Ecef, const EEcefToGeodeticSolver Solver, FLatLonHeightDouble& OutLatLonHeightDegreesMeters);
+
 	/**
 	 * Converts DIS X, Y, Z coordinates (ECEF) to Latitude, Longitude, and Height (LLH) all in double (32-bit) precision
 	 * @param Ecef The ECEF location
@@ -346,6 +355,30 @@ public:
 	UFUNCTION(BlueprintPure, Category = "GRILL DIS|Unit Conversions")
 		static void GetUnrealRotationFromEntityStatePdu(const FEntityStatePDU EntityStatePdu, AGeoReferencingSystem* GeoReferencingSystem, FRotator& UnrealRotation);
 
+	/**
+	 * Gets the Unreal rotation of a DIS Psi, Theta, Phi orientation at the given ECEF location by composing quaternions directly,
+	 * without going through heading, pitch, roll. Accounts for the curvature of the Earth between the world origin and the location.
+	 * @param PsiThetaPhiRadians The Psi, Theta, Phi rotation in radians
+	 * @param Ecef The ECEF location of the entity
+	 * @param GeoReferencingSystem The GeoReferencing Subsystem reference.
+	 * @param UnrealQuat The rotation of the entity in Unreal
+	 */
+	static void GetUnrealQuatFromPsiThetaPhiRadiansAtEcef(const FPsiThetaPhi PsiThetaPhiRadians, const FEarthCenteredEarthFixedDouble Ecef, AGeoReferencingSystem* GeoReferencingSystem, FQuat& UnrealQuat);
+
+	/**
+	 * Gets the DIS Psi, Theta, Phi orientation of an Unreal rotation at the given ECEF location. Inverse of GetUnrealQuatFromPsiThetaPhiRadiansAtEcef.
+	 * @param UnrealQuat The rotation in Unreal world space
+	 * @param Ecef The ECEF location of the entity
+	 * @param GeoReferencingSystem The GeoReferencing Subsystem reference.
+	 * @param PsiThetaPhiRadians The Psi, Theta, Phi rotation in radians
+	 */
+	static void GetPsiThetaPhiRadiansFromUnrealQuatAtEcef(const FQuat UnrealQuat, const FEarthCenteredEarthFixedDouble Ecef, AGeoReferencingSystem* GeoReferencingSystem, FPsiThetaPhi& PsiThetaPhiRadians);
+
+	/**
+	 * True if the rotation conversions should use the quaternion path, set through the DIS.Geodetic.QuaternionOrientation console variable.
+	 */
+	static bool UseQuaternionOrientation();
+
 	/**
 	 * Gets the Unreal X, Y, Z coordinates of the entity from the given ECEF values in the DIS entity state pdu. Values returned change depending on if GeoReferencing Subsystem is set to Flat Earth or Round Earth.
 	 * @param EntityStatePdu The DIS PDU struct indicating the current state of the DIS entity
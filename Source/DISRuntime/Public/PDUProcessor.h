@@ -6,6 +6,7 @@
 
 #include "CoreMinimal.h"
 #include "PDUMasterInclude.h"
+#include "DISPacketValidator.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "PDUProcessor.generated.h"
 
@@ -18,8 +19,44 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FStartResumePDUProcessed, FStartResu
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FStopFreezePDUProcessed, FStopFreezePDU, StopFreezePDU);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FElectromagneticEmissionsPDUProcessed, FElectromagneticEmissionsPDU, ElectromagneticEmissionsPDU);
 
+DECLARE_LOG_CATEGORY_EXTERN(LogPDUProcessor, Log, All);
+
 DECLARE_STATS_GROUP(TEXT("PDUProcessor_Game"), STATGROUP_PDUProcessor, STATCAT_Advanced);
 DECLARE_CYCLE_STAT(TEXT("ProcessDISPacket"), STAT_ProcessDISPacket, STATGROUP_PDUProcessor);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Malformed Packets"), STAT_MalformedPackets, STATGROUP_PDUProcessor);
+
+/**
+ * Datagrams the PDU Processor turned away before decoding them, by reason.
+ */
+USTRUCT(BlueprintType)
+struct FDISRejectedPacketCounts
+{
+	GENERATED_BODY()
+
+	/** Datagrams shorter than the 12 byte PDU header. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|PDU Processor|Structs")
+		int64 TooShortForHeader = 0;
+
+	/** Datagrams whose header length is shorter than the header or longer than the datagram. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|PDU Processor|Structs")
+		int64 LengthMismatch = 0;
+
+	/** Datagrams whose header length is shorter than the fixed fields of their PDU type. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|PDU Processor|Structs")
+		int64 TooShortForPDU = 0;
+
+	/** Datagrams whose record counts describe more records than their length holds. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|PDU Processor|Structs")
+		int64 RecordsOverrun = 0;
+
+	/** Datagrams with more records than Open DIS can unmarshal. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|PDU Processor|Structs")
+		int64 TooManyRecords = 0;
+
+	/** Well formed datagrams of PDU types the PDU Processor does not decode. Not counted as malformed. */
+	UPROPERTY(BlueprintReadOnly, Category = "GRILL DIS|PDU Processor|Structs")
+		int64 UnsupportedPDUType = 0;
+};
 
 UCLASS()
 class DISRUNTIME_API UPDUProcessor : public UGameInstanceSubsystem
@@ -39,6 +76,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|PDU Processor")
 		void ProcessDISPacket(const TArray<uint8>& InData);
 	
+	/**
+	 * Returns the number of datagrams turned away before decoding, by reason, since the processor started or the counts were last reset.
+	 */
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|PDU Processor")
+		FDISRejectedPacketCounts GetRejectedPacketCounts() const;
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|PDU Processor")
+		void ResetRejectedPacketCounts();
+
 	/**
 	 * Called after an Entity State PDU is processed.
 	 * Passes the Entity State PDU as a parameter.
@@ -93,6 +138,13 @@ protected:
 		void HandleOnReceivedUDPBytes(const TArray<uint8>& Bytes, const FString& IPAddress);
 
 private:
+	/**
+	 * Counts a datagram the validator turned away. Each reason is logged the first time it is seen, after that it is only counted.
+	 */
+	void RejectPacket(EDISPacketRejectReason Reason, int32 NumBytes);
+
 	DIS::Endian BigEndian = DIS::BIG;
 	const unsigned int PDU_TYPE_POSITION = 2;
+
+	int64 RejectedPacketCounts[static_cast<int32>(EDISPacketRejectReason::Count)] = {};
 };
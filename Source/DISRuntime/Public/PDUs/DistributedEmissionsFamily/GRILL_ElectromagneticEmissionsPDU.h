@@ -126,6 +126,7 @@ struct FElectromagneticEmissionsPDU : public FDistributedEmissionsFamilyPDU
 
 	FElectromagneticEmissionsPDU() : FDistributedEmissionsFamilyPDU(EPDUType::ElectromagneticEmission)
 	{
+		StateUpdateIndicator = 0;
 	}
 
 	void SetupFromOpenDIS(const DIS::ElectromagneticEmissionsPdu& ElectromagneticEmissionsPDUIn)
@@ -134,6 +135,7 @@ struct FElectromagneticEmissionsPDU : public FDistributedEmissionsFamilyPDU
 		
 		EmittingEntityID = FEntityID(ElectromagneticEmissionsPDUIn.getEmittingEntityID());
 		EventID = FEventID(ElectromagneticEmissionsPDUIn.getEventID());
+		StateUpdateIndicator = ElectromagneticEmissionsPDUIn.getStateUpdateIndicator();
 
 		Systems.Empty();
 		for (const auto& SystemIn : ElectromagneticEmissionsPDUIn.getSystems()) {
@@ -147,6 +149,11 @@ struct FElectromagneticEmissionsPDU : public FDistributedEmissionsFamilyPDU
 	void ToOpenDIS(DIS::ElectromagneticEmissionsPdu& ElectromagneticEmissionsPDUOut)
 	{
 		FDistributedEmissionsFamilyPDU::ToOpenDIS(ElectromagneticEmissionsPDUOut);
+
+		// Specific PDU setup
+		ElectromagneticEmissionsPDUOut.setEmittingEntityID(EmittingEntityID.ToOpenDIS());
+		ElectromagneticEmissionsPDUOut.setEventID(EventID.ToOpenDIS());
+		ElectromagneticEmissionsPDUOut.setStateUpdateIndicator(static_cast<unsigned char>(StateUpdateIndicator));
 	}
 
 	virtual TArray<uint8> ToBytes() override
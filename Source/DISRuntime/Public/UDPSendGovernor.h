@@ -0,0 +1,101 @@
+// Copyright 2022 Gaming Research Integration for Learning Lab. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UDPSendGovernor.generated.h"
+
+/**
+ * How urgently bytes need to go out when a send socket is over its bandwidth budget.
+ */
+UENUM(BlueprintType)
+enum class EUDPSendPriority : uint8
+{
+	//Can wait for budget, such as heartbeats that only restate the dead reckoned state
+	Low,
+	//Can wait for budget, but goes before Low
+	Normal,
+	//Always sent immediately, such as large dead reckoning errors, appearance changes, and simulation management
+	High
+};
+
+/**
+ * Token bucket budget for a single send socket, limiting bytes and packets per second.
+ * Bytes that do not fit the budget are queued, keeping only the newest bytes per merge key, and sent highest priority and oldest first once budget is available.
+ * High priority bytes are always sent and may run the buckets into debt, which holds back the queue until it is paid off.
+ */
+struct DISRUNTIME_API FUDPSendGovernor
+{
+	enum class EDeferResult : uint8
+	{
+		Queued,
+		//Replaced older queued bytes with the same merge key
+		Merged,
+		//The queue was full of bytes at least as important
+		Dropped
+	};
+
+	FUDPSendGovernor() = default;
+	/**
+	 * @param MaxBytesPerSecond - Byte budget. Zero or less for no byte limit.
+	 * @param MaxPacketsPerSecond - Packet budget. Zero or less for no packet limit.
+	 * @param BurstSeconds - How many seconds of budget can build up while idle.
+	 * @param NowSeconds - The current time.
+	 */
+	FUDPSendGovernor(double MaxBytesPerSecond, double MaxPacketsPerSecond, double BurstSeconds, double NowSeconds);
+
+	/**
+	 * Adds the budget accumulated since the last refill.
+	 */
+	void Refill(double NowSeconds);
+	/**
+	 * Returns whether bytes of the given size fit in the budget and nothing is queued ahead of them.
+	 */
+	bool CanSendNow(int32 NumBytes) const;
+	/**
+	 * Takes the budget for sending bytes of the given size.
+	 */
+	void Consume(int32 NumBytes);
+	/**
+	 * Queues bytes to send once there is budget.
+	 * @param MergeKey - Queued bytes with the same key are replaced. Zero to never merge.
+	 */
+	EDeferResult Defer(const TArray<uint8>& Bytes, EUDPSendPriority Priority, int64 MergeKey);
+	/**
+	 * Removes the queued bytes with the given merge key, as newer bytes for it were sent ahead of the queue. Returns whether any were removed.
+	 * @param MergeKey - Key of the queued bytes. Zero never matches.
+	 */
+	bool RemoveDeferred(int64 MergeKey);
+	/**
+	 * Sends queued bytes while the budget allows. Returns the number sent.
+	 */
+	int32 Flush(TFunctionRef<void(const TArray<uint8>&)> Send);
+
+	int32 NumDeferred() const { return Deferred.Num(); }
+
+	//Most bytes arrays kept in the queue
+	int32 MaxDeferred = 4096;
+
+private:
+	struct FDeferredSend
+	{
+		TArray<uint8> Bytes;
+		EUDPSendPriority Priority;
+		int64 MergeKey;
+		uint64 Sequence;
+	};
+
+	void RebuildMergeIndex();
+
+	double BytesPerSecond = 0;
+	double PacketsPerSecond = 0;
+	double ByteCapacity = 0;
+	double PacketCapacity = 0;
+	double ByteTokens = 0;
+	double PacketTokens = 0;
+	double LastRefillSeconds = 0;
+
+	TArray<FDeferredSend> Deferred;
+	TMap<int64, int32> MergeIndex;
+	uint64 NextSequence = 0;
+};
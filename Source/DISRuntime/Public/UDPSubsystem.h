@@ -8,6 +8,8 @@
 #include "Common/UdpSocketSender.h"
 
 #include "CoreMinimal.h"
+#include "UDPSendGovernor.h"
+#include "Containers/Ticker.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "UDPSubsystem.generated.h"
 
@@ -38,6 +40,18 @@ struct FSendSocketSettings
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|UDP Subsystem|Structs")
 		int32 BufferSize;
 
+	/** Most bytes per second to send over this socket before lower priority sends are deferred. Zero for no limit. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|UDP Subsystem|Structs", Meta = (UIMin = 0, ClampMin = 0))
+		float MaxBytesPerSecond;
+
+	/** Most packets per second to send over this socket before lower priority sends are deferred. Zero for no limit. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|UDP Subsystem|Structs", Meta = (UIMin = 0, ClampMin = 0))
+		float MaxPacketsPerSecond;
+
+	/** How many seconds of unused budget can build up for a burst of sends. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GRILL DIS|UDP Subsystem|Structs", Meta = (UIMin = 0, ClampMin = 0))
+		float BurstSeconds;
+
 	FSendSocketSettings()
 	{
 		SendSocketConnectionType = EConnectionType::Broadcast;
@@ -45,6 +59,10 @@ struct FSendSocketSettings
 		SocketDescription = FString(TEXT("UE4-DIS-Send-Socket"));
 
 		BufferSize = 2 * 1024 * 1024;	//default roughly 2mb
+
+		MaxBytesPerSecond = 0;
+		MaxPacketsPerSecond = 0;
+		BurstSeconds = 0.1f;
 	}
 };
 
@@ -122,6 +140,24 @@ struct FReceiveSocketMapValue
 	}
 };
 
+/**
+ * Sees every datagram that passes a receive socket's loopback filter, on that socket's receive thread and before it is handed to the game thread.
+ * Implementations must be thread safe, since each receive socket has its own thread, and must return quickly.
+ */
+class DISRUNTIME_API IUDPReceiveTap
+{
+public:
+	virtual ~IUDPReceiveTap() = default;
+
+	/**
+	 * @param Bytes - The datagram. Only valid for the duration of the call.
+	 * @param Sender - The endpoint the datagram came from.
+	 * @param Receiver - The address and port the receive socket listens on, the group address for multicast sockets.
+	 * @param ReceiveSocketID - The ID of the receive socket that received the datagram.
+	 */
+	virtual void OnDatagramReceived(TArrayView<const uint8> Bytes, const FIPv4Endpoint& Sender, const FIPv4Endpoint& Receiver, int32 ReceiveSocketID) = 0;
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FUDPReceiveSocketStateSignature, int32, ReceiveSocketID, FString, IpListeningOn, int32, PortListeningOn);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_FiveParams(FUDPSendSocketStateSignature, int32, SendSocketID, FString, LocalIp, int32, LocalPort, FString, PeerIp, int32, PeerPort);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FUDPMessageSignature, const TArray<uint8>&, Bytes, const FString&, IPAddress);
@@ -129,6 +165,11 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FUDPMessageSignature, const TArray<
 DECLARE_STATS_GROUP(TEXT("UDPSubsystem_Game"), STATGROUP_UDPSubsystem, STATCAT_Advanced);
 DECLARE_CYCLE_STAT(TEXT("ReceiveBytes"), STAT_ReceiveBytes, STATGROUP_UDPSubsystem);
 DECLARE_CYCLE_STAT(TEXT("SendBytes"), STAT_SendBytes, STATGROUP_UDPSubsystem);
+DECLARE_CYCLE_STAT(TEXT("FlushDeferredBytes"), STAT_FlushDeferredBytes, STATGROUP_UDPSubsystem);
+DECLARE_DWORD_COUNTER_STAT(TEXT("SendsDeferred"), STAT_SendsDeferred, STATGROUP_UDPSubsystem);
+DECLARE_DWORD_COUNTER_STAT(TEXT("SendsMerged"), STAT_SendsMerged, STATGROUP_UDPSubsystem);
+DECLARE_DWORD_COUNTER_STAT(TEXT("SendsDropped"), STAT_SendsDropped, STATGROUP_UDPSubsystem);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("DeferredSendsQueued"), STAT_DeferredSendsQueued, STATGROUP_UDPSubsystem);
 
 UCLASS(ClassGroup = "Networking", meta = (BlueprintSpawnableComponent))
 class DISRUNTIME_API UUDPSubsystem : public UGameInstanceSubsystem
@@ -207,6 +248,16 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|UDP Subsystem")
 		bool EmitBytes(const TArray<uint8>& Bytes);
+	/**
+	 * Sends bytes over the opened send sockets, deferring them on sockets that are over their bandwidth budget unless they are high priority.
+	 * Deferred bytes are sent highest priority first once budget is available, and only the newest bytes per merge key are kept.
+	 * Returns whether or not the sending or deferring was successful for every opened socket.
+	 * @param Bytes - The bytes to send over UDP.
+	 * @param Priority - How urgently the bytes need to go out.
+	 * @param MergeKey - Identifies what the bytes describe, such as an entity, so deferred bytes can be replaced by newer ones. Zero to never merge.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|UDP Subsystem")
+		bool EmitBytesWithPriority(const TArray<uint8>& Bytes, EUDPSendPriority Priority, int64 MergeKey = 0);
 	/**
 	 * Closes all opened receive sockets.
 	 * Returns whether or not all of the receive sockets were closed successfully. If none are opened, returns true.
@@ -238,11 +289,42 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "GRILL DIS|UDP Subsystem")
 		bool AnyConnectedSockets();
 
+	/**
+	 * Starts passing every received datagram to the given tap on the receive threads.
+	 */
+	void AddReceiveTap(const TSharedRef<IUDPReceiveTap, ESPMode::ThreadSafe>& Tap);
+	/**
+	 * Stops passing received datagrams to the given tap. Once this returns the tap is no longer being called on any receive thread.
+	 */
+	void RemoveReceiveTap(const TSharedRef<IUDPReceiveTap, ESPMode::ThreadSafe>& Tap);
+
+	/**
+	 * Returns the number of received datagrams waiting to be broadcast on the game thread.
+	 */
+	UFUNCTION(BlueprintPure, Category = "GRILL DIS|UDP Subsystem")
+		int32 GetNumPendingGameThreadDatagrams() const { return PendingGameThreadDatagrams.GetValue(); }
+
 protected:
+	/**
+	 * Sends the deferred bytes of every send socket that has budget again.
+	 */
+	bool FlushDeferredBytes(float DeltaTime);
+
 	ISocketSubsystem* SocketSubsystem;
 
 	TMap<int32, FSocket*> AllSendSockets;
 	TMap<int32, FReceiveSocketMapValue> AllReceiveSockets;
+	//Bandwidth budgets of the send sockets opened with a byte or packet limit
+	TMap<int32, FUDPSendGovernor> SendGovernors;
+
+	FDelegateHandle FlushDeferredBytesHandle;
+
+	//Guards ReceiveTaps, read by every receive thread
+	FRWLock ReceiveTapsLock;
+	TArray<TSharedRef<IUDPReceiveTap, ESPMode::ThreadSafe>> ReceiveTaps;
+
+	//Datagrams handed from the receive threads to the game thread and not yet broadcast
+	FThreadSafeCounter PendingGameThreadDatagrams;
 
 private:
 	int TotalSendSocketIterator = 0;